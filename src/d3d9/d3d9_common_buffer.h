@@ -214,7 +214,10 @@ namespace dxvk {
       DxvkBufferSlice slice;
       uint32_t min, max;
     };
-    using RemixIboMemoizer = MemoryRegionMemoizer<RemixIndexBufferMemoizationData>;
+    struct RemixIndexBufferPageSummary {
+      uint32_t min, max;
+    };
+    using RemixIboMemoizer = MemoryRegionMemoizer<RemixIndexBufferMemoizationData, RemixIndexBufferPageSummary>;
     RemixIboMemoizer remixMemoization;
     // NV-DXVK end
 
@@ -95,9 +95,14 @@ namespace dxvk {
 
     // Release this texture from ImGUI 
     if (m_image != nullptr) {
-      if (m_image->getHash() != 0) {
+      // NV-DXVK start: asynchronous texture hashing
+      // Note: a texture still waiting on its hash was never added, and isn't worth waiting for
+      if (m_imguiOnceHashed != nullptr) {
+        m_imguiOnceHashed->release();
+      } else if (m_image->getHash() != 0) {
         ImGUI::ReleaseTexture(m_image->getHash());
       }
+      // NV-DXVK end
       if (m_image->getDescriptorHash() != 0) {
         ImGUI::ReleaseTexture(m_image->getDescriptorHash());
       }
@@ -658,10 +663,12 @@ namespace dxvk {
     if (m_type != D3DRTYPE_TEXTURE || (m_desc.Usage & D3DUSAGE_DEPTHSTENCIL))
       return;
 
-    if (m_image->getHash() != 0) {
+    // NV-DXVK start: asynchronous texture hashing
+    if (m_image->hasHash()) {
       // Already setup.
       return;
     }
+    // NV-DXVK end
 
     // Use subresource 0 for hashing
     constexpr uint32_t subresource = 0;
@@ -674,19 +681,35 @@ namespace dxvk {
     const bool useObsoleteHashMethod = NeedsUpload(subresource) &&
       RtxOptions::useObsoleteHashOnTextureUpload();
 
+    // NV-DXVK start: asynchronous texture hashing
+    TextureHashMethod hashMethod = TextureHashMethod::Xxh3;
+    if (unlikely(useObsoleteHashMethod)) {
+      hashMethod = TextureHashMethod::Xxh64;
+    } else if (D3D9Rtx::useTreeTextureHash()) {
+      hashMethod = TextureHashMethod::Tree;
+    }
+
     // Generate hash from CPU buffer
-    XXH64_hash_t imageHash;
+    if (TextureHasher* pHasher = m_device->RTX().GetTextureHasher()) {
+      Rc<PendingTextureHash> pendingHash = pHasher->schedule(buffer->mapPtr(0), buffer->info().size, hashMethod, buffer.ptr());
 
-    if (unlikely(useObsoleteHashMethod)) {
-      imageHash = XXH64(buffer->mapPtr(0), buffer->info().size, 0);
+      // The source data must not change until it is hashed
+      source->m_pendingHashRead = pendingHash;
+
+      // save hash to dxvkImage, ImGUI learns about this texture once it is hashed
+      m_image->setPendingHash(pendingHash);
+      m_imguiOnceHashed = m_device->RTX().AddTextureToImGuiOnceHashed(pendingHash, m_sampleView.Color);
     } else {
-      imageHash = XXH3_64bits(buffer->mapPtr(0), buffer->info().size);
+      const XXH64_hash_t imageHash = TextureHasher::hash(buffer->mapPtr(0), buffer->info().size, hashMethod);
+
+      // save hash to dxvkImage
+      m_image->setHash(imageHash);
+
+      // Let ImGUI know about this texture
+      ImGUI::AddTexture(imageHash, m_sampleView.Color, ImGUI::kTextureFlagsDefault);
     }
-    // save hash to dxvkImage
-    m_image->setHash(imageHash);
+    // NV-DXVK end
 
-    // Let ImGUI know about this texture
-    ImGUI::AddTexture(imageHash, m_sampleView.Color, ImGUI::kTextureFlagsDefault);
     if (IsRenderTarget()) {
       // Generate descriptor hash from the image properties (not including actual pixel data)
       XXH64_hash_t descriptorHash = m_desc.CalculateHash();
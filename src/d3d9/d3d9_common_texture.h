@@ -5,12 +5,18 @@
 #include "d3d9_caps.h"
 
 #include "../dxvk/dxvk_device.h"
+// NV-DXVK start: asynchronous texture hashing
+#include "../dxvk/rtx_render/rtx_texture_hasher.h"
+// NV-DXVK end
 
 #include "../util/util_bit.h"
 
 namespace dxvk {
 
     class D3D9DeviceEx;
+    // NV-DXVK start: asynchronous texture hashing
+    class D3D9ImGuiTextureOnceHashed;
+    // NV-DXVK end
 
   /**
    * \brief Image memory mapping mode
@@ -409,6 +415,20 @@ namespace dxvk {
 
     void SetupForRtx();
     void SetupForRtxFrom(const D3D9CommonTexture* source);
+
+    // NV-DXVK start: asynchronous texture hashing
+    /**
+     * \brief Waits for the texture hashes reading this texture's data
+     *
+     * To be called before the data is written again.
+     */
+    void WaitForPendingHashRead() {
+      if (unlikely(m_pendingHashRead != nullptr)) {
+        m_pendingHashRead->get();
+        m_pendingHashRead = nullptr;
+      }
+    }
+    // NV-DXVK end
     
     void AddDirtyBox(CONST D3DBOX* pDirtyBox, uint32_t layer) {
       if (pDirtyBox) {
@@ -523,6 +543,13 @@ namespace dxvk {
 
     std::array<D3DBOX, 6>         m_dirtyBoxes;
 
+    // NV-DXVK start: asynchronous texture hashing
+    // Hash being computed from this texture's data, possibly for another texture (see SetupForRtxFrom)
+    mutable Rc<PendingTextureHash> m_pendingHashRead;
+    // Set while this texture is added to ImGUI once its hash is ready, see D3D9Rtx::AddTextureToImGuiOnceHashed
+    Rc<D3D9ImGuiTextureOnceHashed> m_imguiOnceHashed;
+    // NV-DXVK end
+
     /**
      * \brief Mip level
      * \returns Size of packed mip level in bytes
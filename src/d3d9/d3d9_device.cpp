@@ -103,6 +103,12 @@ namespace dxvk {
     if (canSWVP)
       Logger::info("D3D9DeviceEx: Using extended constant set for software vertex processing.");
 
+    // NV-DXVK start: shader disk cache
+    // Created early so the cache file is read while the rest of the device comes up
+    if (m_d3d9Options.shaderCache)
+      m_shaderCache = std::make_unique<DxsoShaderCache>(DxsoShaderCache::getDefaultFilePath(), GetShaderCacheVersionStamp());
+    // NV-DXVK end
+
     m_initializer      = new D3D9Initializer(m_dxvkDevice);
     m_converter        = new D3D9FormatHelper(m_dxvkDevice);
 
@@ -156,6 +162,16 @@ namespace dxvk {
     // NV-DXVK start: Consolidate RTX state
     m_rtx.Initialize();
     // NV-DXVK
+
+    // NV-DXVK start: asynchronous fixed function shaders
+    if (m_d3d9Options.asyncFixedFunctionShaders)
+      m_ffModules.StartWorkers(this, std::clamp(dxvk::thread::hardware_concurrency() / 4u, 1u, 2u));
+    // NV-DXVK end
+
+    // NV-DXVK start: SWVP module cache
+    if (m_shaderCache != nullptr && canSWVP)
+      m_swvpEmulator.StartPrewarm(this);
+    // NV-DXVK end
   }
 
 
@@ -163,6 +179,19 @@ namespace dxvk {
     Flush();
     SynchronizeCsThread();
 
+    // NV-DXVK start: asynchronous fixed function shaders
+    // The workers use the shader cache, which is destroyed before the module set
+    m_ffModules.StopWorkers();
+
+    const D3D9FFShaderStats ffStats = m_ffModules.GetStats();
+    Logger::info(str::format("D3D9: Fixed function shaders: ", ffStats.hits, " hits, ",
+      ffStats.cacheLoads, " loaded from cache, ", ffStats.compiles, " compiled, ", ffStats.fallbacks, " fallbacks"));
+    // NV-DXVK end
+
+    // NV-DXVK start: SWVP module cache
+    m_swvpEmulator.StopPrewarm();
+    // NV-DXVK end
+
     delete m_initializer;
     delete m_converter;
 
@@ -993,6 +1022,12 @@ namespace dxvk {
     if (dstTexInfo->Desc()->Pool == D3DPOOL_DEFAULT)
       return this->StretchRect(pRenderTarget, nullptr, pDestSurface, nullptr, D3DTEXF_NONE);
 
+    // NV-DXVK start: asynchronous texture hashing
+    if (dst->GetSubresource() == 0) {
+      dstTexInfo->WaitForPendingHashRead();
+    }
+    // NV-DXVK end
+
     Rc<DxvkBuffer> dstBuffer = dstTexInfo->GetBuffer(dst->GetSubresource());
 
     Rc<DxvkImage>  srcImage                 = srcTexInfo->GetImage();
@@ -4575,6 +4610,13 @@ namespace dxvk {
 
     auto& desc = *(pResource->Desc());
 
+    // NV-DXVK start: asynchronous texture hashing
+    // The data of subresource 0 may still be read to hash a texture
+    if (Subresource == 0 && !(Flags & D3DLOCK_READONLY)) {
+      pResource->WaitForPendingHashRead();
+    }
+    // NV-DXVK end
+
     bool alloced = pResource->CreateBufferSubresource(Subresource);
 
     const Rc<DxvkBuffer> mappedBuffer = pResource->GetBuffer(Subresource);
@@ -5070,6 +5112,7 @@ namespace dxvk {
       pResource->GPUReadingRange().Clear();
 
       // NV-DXVK start: Implement memoization for some expensive CPU operations
+      // Note: cached ranges are re-verified against their page hashes on next use, as the data is often re-uploaded unchanged
       pResource->remixMemoization.invalidateAll();
       // NV-DXVK end
     }
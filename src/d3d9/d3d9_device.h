@@ -19,6 +19,7 @@
 #include "../dxso/dxso_util.h"
 #include "../dxso/dxso_options.h"
 #include "../dxso/dxso_modinfo.h"
+#include "../dxso/dxso_shader_cache.h"
 
 #include "d3d9_sampler.h"
 #include "d3d9_fixed_function.h"
@@ -896,6 +897,12 @@ namespace dxvk {
       return &m_d3d9Options;
     }
 
+    // NV-DXVK start: shader disk cache
+    DxsoShaderCache* GetShaderCache() const {
+      return m_shaderCache.get();
+    }
+    // NV-DXVK end
+
     Direct3DState9* GetRawState() {
       return &m_state;
     }
@@ -1197,6 +1204,9 @@ namespace dxvk {
     Com<D3D9StateBlock, false>      m_recorder;
 
     Rc<D3D9ShaderModuleSet>         m_shaderModules;
+    // NV-DXVK start: shader disk cache
+    std::unique_ptr<DxsoShaderCache> m_shaderCache;
+    // NV-DXVK end
 
     Rc<DxvkBuffer>                  m_vsClipPlanes;
 
@@ -1,6 +1,7 @@
 #include "d3d9_fixed_function.h"
 
 #include "d3d9_device.h"
+#include "d3d9_shader.h"
 #include "d3d9_util.h"
 #include "d3d9_spec_constants.h"
 
@@ -2737,13 +2738,21 @@ namespace dxvk {
 
     std::string name = str::format("FF_", shaderKey.toString());
 
-    D3D9FFShaderCompiler compiler(
-      pDevice->GetDXVKDevice(),
-      Key, name,
-      pDevice->GetOptions());
+    // NV-DXVK start: shader disk cache
+    m_loadedFromCache = LoadFromCache(pDevice, Key);
 
-    m_shader = compiler.compile();
-    m_isgn   = compiler.isgn();
+    if (!m_loadedFromCache) {
+      D3D9FFShaderCompiler compiler(
+        pDevice->GetDXVKDevice(),
+        Key, name,
+        pDevice->GetOptions());
+
+      m_shader = compiler.compile();
+      m_isgn   = compiler.isgn();
+
+      StoreToCache(pDevice, Key);
+    }
+    // NV-DXVK end
 
     Dump(Key, name);
 
@@ -2760,13 +2769,21 @@ namespace dxvk {
 
     std::string name = str::format("FF_", shaderKey.toString());
 
-    D3D9FFShaderCompiler compiler(
-      pDevice->GetDXVKDevice(),
-      Key, name,
-      pDevice->GetOptions());
+    // NV-DXVK start: shader disk cache
+    m_loadedFromCache = LoadFromCache(pDevice, Key);
 
-    m_shader = compiler.compile();
-    m_isgn   = compiler.isgn();
+    if (!m_loadedFromCache) {
+      D3D9FFShaderCompiler compiler(
+        pDevice->GetDXVKDevice(),
+        Key, name,
+        pDevice->GetOptions());
+
+      m_shader = compiler.compile();
+      m_isgn   = compiler.isgn();
+
+      StoreToCache(pDevice, Key);
+    }
+    // NV-DXVK end
 
     Dump(Key, name);
 
@@ -2774,6 +2791,58 @@ namespace dxvk {
     pDevice->GetDXVKDevice()->registerShader(m_shader);
   }
 
+  // NV-DXVK start: shader disk cache
+  template <typename T>
+  XXH64_hash_t D3D9FFShader::GetCacheKey(D3D9DeviceEx* pDevice, const T& Key) {
+    constexpr VkShaderStageFlagBits stage = std::is_same_v<T, D3D9FFShaderKeyVS>
+      ? VK_SHADER_STAGE_VERTEX_BIT
+      : VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // FF keys are zero-initialized before being filled in, so hashing the raw bytes is stable
+    XXH64_hash_t key = XXH3_64bits(&Key, sizeof(Key));
+    key = HashShaderCacheValue(stage, key);
+    key = HashShaderCacheValue(pDevice->GetOptions()->invariantPosition, key);
+    key = HashShaderCacheValue(TerrainBaker::Material::replacementSupportInPS_fixedFunction(), key);
+    return HashShaderCacheValue(GetVertexCaptureCacheKey(), key);
+  }
+
+
+  template <typename T>
+  bool D3D9FFShader::LoadFromCache(D3D9DeviceEx* pDevice, const T& Key) {
+    DxsoShaderCache* pShaderCache = pDevice->GetShaderCache();
+    DxsoCachedModule module;
+
+    if (pShaderCache == nullptr || !pShaderCache->lookup(GetCacheKey(pDevice, Key), module))
+      return false;
+
+    if (module.shaders.size() != 1 || !module.shaders[0])
+      return false;
+
+    m_shader = FromCachedShader(*module.shaders[0]);
+    m_isgn   = module.isgn;
+    return true;
+  }
+
+
+  template <typename T>
+  void D3D9FFShader::StoreToCache(D3D9DeviceEx* pDevice, const T& Key) const {
+    DxsoShaderCache* pShaderCache = pDevice->GetShaderCache();
+
+    if (pShaderCache == nullptr)
+      return;
+
+    DxsoCachedModule module;
+    module.isgn = m_isgn;
+    module.shaders.emplace_back(ToCachedShader(m_shader));
+
+    // The key is stored so that the shader can be preloaded on the next run
+    module.inputs.resize(sizeof(Key));
+    std::memcpy(module.inputs.data(), &Key, sizeof(Key));
+
+    pShaderCache->insert(GetCacheKey(pDevice, Key), module);
+  }
+  // NV-DXVK end
+
   template <typename T>
   void D3D9FFShader::Dump(const T& Key, const std::string& Name) {
     const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
@@ -2788,19 +2857,129 @@ namespace dxvk {
   }
 
 
-  D3D9FFShader D3D9FFShaderModuleSet::GetShaderModule(
+  // NV-DXVK start: asynchronous fixed function shaders
+  D3D9FFShaderKeyVS GetFallbackShaderKey(const D3D9FFShaderKeyVS& Key) {
+    const auto& src = Key.Data.Contents;
+
+    D3D9FFShaderKeyVS fallback;
+    auto& dst = fallback.Data.Contents;
+
+    // Vertex inputs and shader outputs
+    dst.HasPositionT     = src.HasPositionT;
+    dst.HasColor0        = src.HasColor0;
+    dst.HasColor1        = src.HasColor1;
+    dst.HasPointSize     = src.HasPointSize;
+    dst.TexcoordDeclMask = src.TexcoordDeclMask;
+    dst.VertexClipping   = src.VertexClipping;
+
+    // Fog changes colors too much to be dropped even briefly
+    dst.HasFog           = src.HasFog;
+    dst.RangeFog         = src.RangeFog;
+
+    // Texture coordinates are passed through, without generation or transforms
+    dst.TexcoordIndices  = src.TexcoordIndices;
+
+    // Vertex positions
+    dst.VertexBlendMode    = src.VertexBlendMode;
+    dst.VertexBlendIndexed = src.VertexBlendIndexed;
+    dst.VertexBlendCount   = src.VertexBlendCount;
+
+    return fallback;
+  }
+
+
+  D3D9FFShaderKeyFS GetFallbackShaderKey(const D3D9FFShaderKeyFS& Key) {
+    const auto& src = Key.Stages[0].Contents;
+
+    D3D9FFShaderKeyFS fallback;
+    auto& dst = fallback.Stages[0].Contents;
+
+    dst.GlobalSpecularEnable = src.GlobalSpecularEnable;
+    dst.GlobalFlatShade      = src.GlobalFlatShade;
+
+    if (src.ColorOp == D3DTOP_DISABLE)
+      return fallback;
+
+    auto isTexture = [] (uint32_t arg) {
+      return (arg & D3DTA_SELECTMASK) == D3DTA_TEXTURE;
+    };
+
+    const bool readsTexture =
+      isTexture(src.ColorArg0) || isTexture(src.ColorArg1) || isTexture(src.ColorArg2) ||
+      isTexture(src.AlphaArg0) || isTexture(src.AlphaArg1) || isTexture(src.AlphaArg2);
+
+    if (readsTexture) {
+      // The texture modulated with the diffuse color, what most first stages come down to
+      dst.ColorOp   = D3DTOP_MODULATE;
+      dst.ColorArg1 = D3DTA_TEXTURE;
+      dst.ColorArg2 = D3DTA_DIFFUSE;
+      dst.AlphaOp   = D3DTOP_MODULATE;
+      dst.AlphaArg1 = D3DTA_TEXTURE;
+      dst.AlphaArg2 = D3DTA_DIFFUSE;
+      dst.Type      = src.Type;
+    } else {
+      dst.ColorOp   = D3DTOP_SELECTARG1;
+      dst.ColorArg1 = D3DTA_DIFFUSE;
+      dst.AlphaOp   = D3DTOP_SELECTARG1;
+      dst.AlphaArg1 = D3DTA_DIFFUSE;
+    }
+
+    return fallback;
+  }
+
+
+  D3D9FFShaderModuleSet::~D3D9FFShaderModuleSet() {
+    StopWorkers();
+  }
+
+
+  void D3D9FFShaderModuleSet::StartWorkers(
           D3D9DeviceEx*         pDevice,
-    const D3D9FFShaderKeyVS&    ShaderKey) {
-    // Use the shader's unique key for the lookup
-    auto entry = m_vsModules.find(ShaderKey);
-    if (entry != m_vsModules.end())
-      return entry->second;
-    
-    D3D9FFShader shader(
-      pDevice, ShaderKey);
+          uint32_t              NumThreads) {
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    m_device = pDevice;
+
+    if (pDevice->GetShaderCache() != nullptr)
+      m_jobs.push_back(std::monostate());
+
+    for (uint32_t i = 0; i < NumThreads; i++)
+      m_workers.emplace_back([this] () { WorkerFunc(); });
+  }
+
+
+  void D3D9FFShaderModuleSet::StopWorkers() {
+    std::vector<dxvk::thread> workers;
+
+    // Shaders left compiling are compiled on request from now on
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_stopWorkers = true;
+      m_jobs.clear();
+      workers = std::move(m_workers);
+    }
 
-    m_vsModules.insert({ShaderKey, shader});
+    m_cond.notify_all();
 
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+
+  D3D9FFShaderStats D3D9FFShaderModuleSet::GetStats() const {
+    D3D9FFShaderStats stats;
+    stats.hits       = m_hits.load();
+    stats.cacheLoads = m_cacheLoads.load();
+    stats.compiles   = m_compiles.load();
+    stats.fallbacks  = m_fallbacks.load();
+    return stats;
+  }
+
+
+  D3D9FFShader D3D9FFShaderModuleSet::GetShaderModule(
+          D3D9DeviceEx*         pDevice,
+    const D3D9FFShaderKeyVS&    ShaderKey) {
+    D3D9FFShader shader = GetShaderModuleInternal(pDevice, ShaderKey);
+    PublishStats(pDevice);
     return shader;
   }
 
@@ -2808,20 +2987,171 @@ namespace dxvk {
   D3D9FFShader D3D9FFShaderModuleSet::GetShaderModule(
           D3D9DeviceEx*         pDevice,
     const D3D9FFShaderKeyFS&    ShaderKey) {
+    D3D9FFShader shader = GetShaderModuleInternal(pDevice, ShaderKey);
+    PublishStats(pDevice);
+    return shader;
+  }
+
+
+  template <typename T>
+  D3D9FFShaderModuleSet::ModuleMap<T>& D3D9FFShaderModuleSet::GetModules() {
+    if constexpr (std::is_same_v<T, D3D9FFShaderKeyVS>)
+      return m_vsModules;
+    else
+      return m_fsModules;
+  }
+
+
+  template <typename T>
+  D3D9FFShader D3D9FFShaderModuleSet::GetShaderModuleInternal(
+          D3D9DeviceEx*         pDevice,
+    const T&                    ShaderKey) {
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
     // Use the shader's unique key for the lookup
-    auto entry = m_fsModules.find(ShaderKey);
-    if (entry != m_fsModules.end())
-      return entry->second;
-    
+    auto& modules = GetModules<T>();
+    auto entry = modules.find(ShaderKey);
+
+    if (entry != modules.end() && entry->second) {
+      m_hits += 1;
+      return *entry->second;
+    }
+
+    // Without workers, or when the key is its own fallback, there is nothing to wait on
+    const T fallbackKey = GetFallbackShaderKey(ShaderKey);
+
+    if (m_workers.empty() || fallbackKey == ShaderKey) {
+      lock.unlock();
+      return CreateShaderModule(pDevice, ShaderKey);
+    }
+
+    if (entry == modules.end()) {
+      modules.emplace(ShaderKey, std::nullopt);
+      m_jobs.push_back(ShaderKey);
+      m_cond.notify_one();
+    }
+
+    m_fallbacks += 1;
+
+    auto fallback = modules.find(fallbackKey);
+
+    if (fallback != modules.end() && fallback->second)
+      return *fallback->second;
+
+    // Fallbacks are shared by many keys and cheap to compile, so this is rare
+    lock.unlock();
+    return CreateShaderModule(pDevice, fallbackKey);
+  }
+
+
+  template <typename T>
+  D3D9FFShader D3D9FFShaderModuleSet::CreateShaderModule(
+          D3D9DeviceEx*         pDevice,
+    const T&                    ShaderKey) {
     D3D9FFShader shader(
       pDevice, ShaderKey);
 
-    m_fsModules.insert({ShaderKey, shader});
+    if (shader.IsLoadedFromCache())
+      m_cacheLoads += 1;
+    else
+      m_compiles += 1;
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+    GetModules<T>()[ShaderKey] = shader;
 
     return shader;
   }
 
 
+  template <typename T>
+  bool D3D9FFShaderModuleSet::QueuePreload(
+          D3D9DeviceEx*         pDevice,
+          XXH64_hash_t          CacheKey,
+    const std::vector<uint8_t>& Inputs) {
+    if (Inputs.size() != sizeof(T))
+      return false;
+
+    T key;
+    std::memcpy(&key, Inputs.data(), sizeof(T));
+
+    // Also tells vertex and pixel shader keys apart, and skips entries
+    // written with different options, which would not be looked up
+    if (D3D9FFShader::GetCacheKey(pDevice, key) != CacheKey)
+      return false;
+
+    if (GetModules<T>().emplace(key, std::nullopt).second)
+      m_jobs.push_back(key);
+
+    return true;
+  }
+
+
+  void D3D9FFShaderModuleSet::Preload(
+          D3D9DeviceEx*         pDevice) {
+    // Waits for the cache file to be read
+    const auto storedInputs = pDevice->GetShaderCache()->getStoredInputs();
+
+    uint32_t numPreloaded = 0;
+
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+      if (m_stopWorkers)
+        return;
+
+      for (const auto& [cacheKey, inputs] : storedInputs) {
+        if (QueuePreload<D3D9FFShaderKeyVS>(pDevice, cacheKey, inputs)
+         || QueuePreload<D3D9FFShaderKeyFS>(pDevice, cacheKey, inputs))
+          numPreloaded += 1;
+      }
+    }
+
+    m_cond.notify_all();
+
+    Logger::info(str::format("D3D9: Preloading ", numPreloaded, " fixed function shaders"));
+  }
+
+
+  void D3D9FFShaderModuleSet::PublishStats(
+          D3D9DeviceEx*         pDevice) const {
+    // Stat counters are only written by the CS thread
+    DxvkStatCounters& counters = pDevice->GetDXVKDevice()->statCounters();
+    counters.setCtr(DxvkStatCounter::RtxFFShaderHits,       m_hits.load());
+    counters.setCtr(DxvkStatCounter::RtxFFShaderCacheLoads, m_cacheLoads.load());
+    counters.setCtr(DxvkStatCounter::RtxFFShaderCompiles,   m_compiles.load());
+    counters.setCtr(DxvkStatCounter::RtxFFShaderFallbacks,  m_fallbacks.load());
+  }
+
+
+  void D3D9FFShaderModuleSet::WorkerFunc() {
+    env::setThreadName("dxvk-ff-shader");
+
+    while (true) {
+      Job job;
+
+      { std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+        m_cond.wait(lock, [this] () {
+          return m_stopWorkers || !m_jobs.empty();
+        });
+
+        if (m_stopWorkers)
+          break;
+
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+      }
+
+      std::visit([this] (const auto& key) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(key)>, std::monostate>)
+          Preload(m_device);
+        else
+          CreateShaderModule(m_device, key);
+      }, job);
+    }
+  }
+  // NV-DXVK end
+
+
   size_t D3D9FFShaderKeyHash::operator () (const D3D9FFShaderKeyVS& key) const {
     DxvkHashState state;
 
@@ -8,6 +8,16 @@
 
 #include "../dxso/dxso_isgn.h"
 
+#include "../util/xxHash/xxhash.h"
+
+// NV-DXVK start: asynchronous fixed function shaders
+#include "../util/thread.h"
+
+#include <atomic>
+#include <deque>
+#include <optional>
+#include <variant>
+// NV-DXVK end
 #include <unordered_map>
 #include <bitset>
 
@@ -209,6 +219,21 @@ namespace dxvk {
     template <typename T>
     void Dump(const T& Key, const std::string& Name);
 
+    // NV-DXVK start: shader disk cache
+    template <typename T>
+    static XXH64_hash_t GetCacheKey(D3D9DeviceEx* pDevice, const T& Key);
+
+    template <typename T>
+    bool LoadFromCache(D3D9DeviceEx* pDevice, const T& Key);
+
+    template <typename T>
+    void StoreToCache(D3D9DeviceEx* pDevice, const T& Key) const;
+
+    bool IsLoadedFromCache() const {
+      return m_loadedFromCache;
+    }
+    // NV-DXVK end
+
     Rc<DxvkShader> GetShader() const {
       return m_shader;
     }
@@ -219,13 +244,72 @@ namespace dxvk {
 
     DxsoIsgn       m_isgn;
 
+    // NV-DXVK start: shader disk cache
+    bool           m_loadedFromCache = false;
+    // NV-DXVK end
+
   };
 
 
+  // NV-DXVK start: asynchronous fixed function shaders
+  /**
+   * \brief Fixed function shader statistics
+   *
+   * Cumulative since device creation.
+   */
+  struct D3D9FFShaderStats {
+    uint64_t hits       = 0; ///< Requests served by a shader in memory
+    uint64_t cacheLoads = 0; ///< Shaders loaded from the shader disk cache, including preloaded ones
+    uint64_t compiles   = 0; ///< Shaders compiled because the disk cache missed
+    uint64_t fallbacks  = 0; ///< Requests served by a fallback shader while theirs was compiling
+  };
+
+  /**
+   * \brief Derives the fallback key of a fixed function shader
+   *
+   * The fallback keeps what the shader interface, vertex positions
+   * and fog depend on, and drops lighting, texture coordinate generation
+   * and all but a basic first texture stage. Many keys share the same
+   * fallback, so it is usually compiled already.
+   */
+  D3D9FFShaderKeyVS GetFallbackShaderKey(const D3D9FFShaderKeyVS& Key);
+  D3D9FFShaderKeyFS GetFallbackShaderKey(const D3D9FFShaderKeyFS& Key);
+  // NV-DXVK end
+
+
   class D3D9FFShaderModuleSet : public RcObject {
 
   public:
 
+    // NV-DXVK start: asynchronous fixed function shaders
+    ~D3D9FFShaderModuleSet();
+
+    /**
+     * \brief Starts compiling shaders on worker threads
+     *
+     * Shaders requested afterwards are compiled in the background,
+     * and the shader of their fallback key is returned until they
+     * are ready. Shaders recorded in the shader disk cache are
+     * loaded ahead of their first use.
+     * \param [in] pDevice The device, must outlive the workers
+     * \param [in] NumThreads Number of worker threads
+     */
+    void StartWorkers(
+            D3D9DeviceEx*         pDevice,
+            uint32_t              NumThreads);
+
+    /**
+     * \brief Stops the worker threads
+     *
+     * Must be called before the device's shader
+     * disk cache is destroyed. Pending compiles
+     * are dropped.
+     */
+    void StopWorkers();
+
+    D3D9FFShaderStats GetStats() const;
+    // NV-DXVK end
+
     D3D9FFShader GetShaderModule(
             D3D9DeviceEx*         pDevice,
       const D3D9FFShaderKeyVS&    ShaderKey);
@@ -236,15 +320,60 @@ namespace dxvk {
 
   private:
 
-    std::unordered_map<
-      D3D9FFShaderKeyVS,
-      D3D9FFShader,
-      D3D9FFShaderKeyHash, D3D9FFShaderKeyEq> m_vsModules;
+    // NV-DXVK start: asynchronous fixed function shaders
+    // Empty while the shader is compiled by a worker
+    template <typename T>
+    using ModuleMap = std::unordered_map<
+      T,
+      std::optional<D3D9FFShader>,
+      D3D9FFShaderKeyHash, D3D9FFShaderKeyEq>;
+
+    // Compiles a shader, or preloads the shader disk cache (std::monostate)
+    using Job = std::variant<std::monostate, D3D9FFShaderKeyVS, D3D9FFShaderKeyFS>;
+
+    dxvk::mutex                  m_mutex;
+    dxvk::condition_variable     m_cond;
+
+    ModuleMap<D3D9FFShaderKeyVS> m_vsModules;
+    ModuleMap<D3D9FFShaderKeyFS> m_fsModules;
+
+    D3D9DeviceEx*                m_device = nullptr;
+    std::deque<Job>              m_jobs;
+    bool                         m_stopWorkers = false;
+    std::vector<dxvk::thread>    m_workers;
+
+    std::atomic<uint64_t>        m_hits       = { 0ull };
+    std::atomic<uint64_t>        m_cacheLoads = { 0ull };
+    std::atomic<uint64_t>        m_compiles   = { 0ull };
+    std::atomic<uint64_t>        m_fallbacks  = { 0ull };
+
+    template <typename T>
+    ModuleMap<T>& GetModules();
+
+    template <typename T>
+    D3D9FFShader GetShaderModuleInternal(
+            D3D9DeviceEx*         pDevice,
+      const T&                    ShaderKey);
+
+    template <typename T>
+    D3D9FFShader CreateShaderModule(
+            D3D9DeviceEx*         pDevice,
+      const T&                    ShaderKey);
+
+    template <typename T>
+    bool QueuePreload(
+            D3D9DeviceEx*         pDevice,
+            XXH64_hash_t          CacheKey,
+      const std::vector<uint8_t>& Inputs);
+
+    void Preload(
+            D3D9DeviceEx*         pDevice);
+
+    void PublishStats(
+            D3D9DeviceEx*         pDevice) const;
 
-    std::unordered_map<
-      D3D9FFShaderKeyFS,
-      D3D9FFShader,
-      D3D9FFShaderKeyHash, D3D9FFShaderKeyEq> m_fsModules;
+    void WorkerFunc();
+    // NV-DXVK end
 
   };
 
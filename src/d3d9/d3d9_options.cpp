@@ -103,6 +103,12 @@ namespace dxvk {
     this->apitraceMode                  = config.getOption<bool>        ("d3d9.apitraceMode",                  false);
     this->deviceLocalConstantBuffers    = config.getOption<bool>        ("d3d9.deviceLocalConstantBuffers",    false);
     this->maxEnabledLights              = config.getOption<int32_t>     ("d3d9.maxEnabledLights",              caps::MaxEnabledLights);
+    // NV-DXVK start: shader disk cache
+    this->shaderCache                   = config.getOption<bool>        ("d3d9.shaderCache",                   true, "DXVK_D3D9_SHADER_CACHE");
+    // NV-DXVK end
+    // NV-DXVK start: asynchronous fixed function shaders
+    this->asyncFixedFunctionShaders     = config.getOption<bool>        ("d3d9.asyncFixedFunctionShaders",     true);
+    // NV-DXVK end
     // NV-DXVK start: adapter override conf
     this->adapterOverride = config.getOption<int32_t>("d3d9.adapterOverride", -1);
     // NV-DXVK end
@@ -193,6 +193,17 @@ namespace dxvk {
     /// Use device local memory for constant buffers.
     bool deviceLocalConstantBuffers;
 
+    // NV-DXVK start: shader disk cache
+    /// Store compiled shader modules on disk and reuse them on the next run
+    bool shaderCache;
+    // NV-DXVK end
+
+    // NV-DXVK start: asynchronous fixed function shaders
+    /// Compile new fixed function shaders on worker threads, using a simpler
+    /// shader until they are ready, and preload those seen in earlier runs
+    bool asyncFixedFunctionShaders;
+    // NV-DXVK end
+
     // NV-DXVK start: adapter override conf
     /// Override the adapter/GPU used for D3D9 (-1 = use application defined)
     int adapterOverride;
@@ -14,6 +14,7 @@
 #include "d3d9_rtx_utils.h"
 #include "d3d9_texture.h"
 #include "../dxvk/rtx_render/rtx_terrain_baker.h"
+#include "../dxvk/imgui/dxvk_imgui.h"
 
 namespace dxvk {
   static const bool s_isDxvkResolutionEnvVarSet = (env::getEnvVar("DXVK_RESOLUTION_WIDTH") != "") || (env::getEnvVar("DXVK_RESOLUTION_HEIGHT") != "");
@@ -28,7 +29,8 @@ namespace dxvk {
     : m_rtStagingData(d3d9Device->GetDXVKDevice(), "RtxStagingDataAlloc: D3D9", (VkMemoryPropertyFlagBits) (VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
     , m_parent(d3d9Device)
     , m_enableDrawCallConversion(enableDrawCallConversion)
-    , m_pGeometryWorkers(enableDrawCallConversion ? std::make_unique<GeometryProcessor>(numGeometryProcessingThreads(), "geometry-processing") : nullptr) {
+    , m_pGeometryWorkers(enableDrawCallConversion ? std::make_unique<GeometryProcessor>(numGeometryProcessingThreads(), "geometry-processing") : nullptr)
+    , m_textureHasher(asyncTextureHashing() ? std::make_unique<TextureHasher>(std::clamp(numTextureHashingThreads(), 1u, dxvk::thread::hardware_concurrency())) : nullptr) {
 
     // Add space for 256 objects skinned with 256 bones each.
     m_stagedBones.resize(256 * 256);
@@ -77,6 +79,69 @@ namespace dxvk {
     }
   }
 
+  template<typename T>
+  DxvkBufferSlice D3D9Rtx::processMemoizedIndexBuffer(const uint32_t indexCount, const size_t indexOffset, const IndexContext& indexCtx, uint32_t& minIndex, uint32_t& maxIndex) {
+    ScopedCpuProfileZone();
+
+    D3D9CommonBuffer::RemixIboMemoizer& memoization = indexCtx.ibo->remixMemoization;
+
+    const uint8_t* pBuffer = (const uint8_t*) indexCtx.indexBuffer.mapPtr;
+    const size_t numIndexBytes = indexCount * sizeof(T);
+
+    const auto* pCached = memoization.find(pBuffer, indexOffset, numIndexBytes);
+    if (pCached != nullptr && pCached->start == indexOffset && pCached->end == indexOffset + numIndexBytes) {
+      minIndex = pCached->result.min;
+      maxIndex = pCached->result.max;
+      return pCached->result.slice;
+    }
+
+    // Min/max of the pages not covered by cached ranges
+    {
+      ScopedCpuProfileZoneN("Find min/max");
+
+      auto summarize = [](const uint8_t* pData, const size_t size) {
+        D3D9CommonBuffer::RemixIndexBufferPageSummary summary;
+        fast::findMinMax<T>(static_cast<uint32_t>(size / sizeof(T)), (const T*) pData, summary.min, summary.max);
+        return summary;
+      };
+      memoization.summarizePages(pBuffer, indexOffset, numIndexBytes, summarize, m_indexPageSummaries);
+
+      minIndex = UINT32_MAX;
+      maxIndex = 0;
+      for (const auto& summary : m_indexPageSummaries) {
+        minIndex = std::min(minIndex, summary.min);
+        maxIndex = std::max(maxIndex, summary.max);
+      }
+    }
+
+    // The copy of a cached range containing this one holds the same indices if both were rebased to the same min index
+    if (pCached != nullptr && pCached->result.min == minIndex) {
+      return pCached->result.slice.subSlice(indexOffset - pCached->start, numIndexBytes);
+    }
+
+    D3D9CommonBuffer::RemixIndexBufferMemoizationData result;
+    result.slice = m_rtStagingData.alloc(CACHE_LINE_SIZE, numIndexBytes);
+    result.min = minIndex;
+    result.max = maxIndex;
+
+    // Acquire prevents the staging allocator from re-using this memory
+    result.slice.buffer()->acquire(DxvkAccess::Read);
+
+    {
+      ScopedCpuProfileZoneN("Copy indices");
+
+      const T* pIndices = (const T*) (pBuffer + indexOffset);
+      T* pIndicesDst = (T*) result.slice.mapPtr(0);
+      if (minIndex != 0) {
+        fast::copySubtract<T>(pIndicesDst, pIndices, indexCount, (T) minIndex);
+      } else {
+        memcpy(pIndicesDst, pIndices, numIndexBytes);
+      }
+    }
+
+    return memoization.insert(pBuffer, indexOffset, numIndexBytes, std::move(result), m_indexPageSummaries).result.slice;
+  }
+
   template<typename T>
   DxvkBufferSlice D3D9Rtx::processIndexBuffer(const uint32_t indexCount, const uint32_t startIndex, const IndexContext& indexCtx, uint32_t& minIndex, uint32_t& maxIndex) {
     ScopedCpuProfileZone();
@@ -105,11 +170,7 @@ namespace dxvk {
 
     if (enableIndexBufferMemoization() && indexCtx.ibo != nullptr) {
       // If we have an index buffer, we can utilize memoization
-      D3D9CommonBuffer::RemixIboMemoizer& memoization = indexCtx.ibo->remixMemoization;
-      const auto result = memoization.memoize(indexOffset, numIndexBytes, processing);
-      minIndex = result.min;
-      maxIndex = result.max;
-      return result.slice;
+      return processMemoizedIndexBuffer<T>(indexCount, indexOffset, indexCtx, minIndex, maxIndex);
     }
 
     // No index buffer (so no memoization) - this could be a DrawPrimitiveUP call (where IB data is passed inline)
@@ -119,18 +180,24 @@ namespace dxvk {
     return result.slice;
   }
 
-  DxvkBufferSlice allocVertexCaptureBuffer(DxvkDevice* pDevice, const VkDeviceSize size) {
+  DxvkBufferSlice allocVertexCaptureBuffer(DxvkDevice* pDevice, const VkDeviceSize size, const VkMemoryPropertyFlags memFlags) {
     DxvkBufferCreateInfo info;
     info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
     info.access = VK_ACCESS_TRANSFER_READ_BIT;
     info.stages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
     info.size = size;
-    return DxvkBufferSlice(pDevice->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::AppBuffer, "Vertex Capture Buffer"));
+    return DxvkBufferSlice(pDevice->createBuffer(info, memFlags, DxvkMemoryStats::Category::AppBuffer, "Vertex Capture Buffer"));
   }
 
-  void D3D9Rtx::prepareVertexCapture(const int vertexIndexOffset) {
-    ScopedCpuProfileZone();
+  void D3D9Rtx::computeVertexCaptureTransforms(const int vertexIndexOffset, D3D9RtxVertexCaptureData& data) const {
+    data.invProj = inverse(m_activeDrawCallState.transformData.viewToProjection);
+    data.viewToWorld = inverseAffine(m_activeDrawCallState.transformData.worldToView);
+    data.worldToObject = inverseAffine(m_activeDrawCallState.transformData.objectToWorld);
+    data.normalTransform = m_activeDrawCallState.transformData.objectToWorld;
+    data.baseVertex = (uint32_t)std::max(0, vertexIndexOffset);
+  }
 
+  void D3D9Rtx::assignVertexCaptureBuffers(const DxvkBufferSlice& slice) {
     static_assert(sizeof CapturedVertex == 48, "The injected shader code is expecting this exact structure size to work correctly, see emitVertexCaptureWrite in dxso_compiler.cpp");
 
     auto BoundShaderHas = [&](const D3D9CommonShader* shader, DxsoUsage usage, bool inOut)-> bool {
@@ -153,9 +220,6 @@ namespace dxvk {
 
     // Known stride for vertex capture buffers
     const uint32_t stride = sizeof(CapturedVertex);
-    const size_t vertexCaptureDataSize = align(geoData.vertexCount * stride, CACHE_LINE_SIZE);
-
-    DxvkBufferSlice slice = allocVertexCaptureBuffer(m_parent->GetDXVKDevice().ptr(), vertexCaptureDataSize);
 
     geoData.positionBuffer = RasterBuffer(slice, 0, stride, VK_FORMAT_R32G32B32A32_SFLOAT);
     assert(geoData.positionBuffer.offset() % 4 == 0);
@@ -183,16 +247,36 @@ namespace dxvk {
       geoData.color0Buffer = RasterBuffer(slice, colorOffset, stride, VK_FORMAT_B8G8R8A8_UNORM);
       assert(geoData.color0Buffer.offset() % 4 == 0);
     }
+  }
+
+  void D3D9Rtx::prepareVertexCapture(const VertexContext vertexContext[caps::MaxStreams], const int vertexIndexOffset) {
+    ScopedCpuProfileZone();
+
+    RasterGeometry& geoData = m_activeDrawCallState.geometryData;
+
+    const size_t vertexCaptureDataSize = align(geoData.vertexCount * sizeof(CapturedVertex), CACHE_LINE_SIZE);
+
+    // Draw calls recorded as fixtures are captured into host visible memory, so the vertices can be read back
+    const bool recordFixture = !vertexCaptureFixturePath().empty() && prepareVertexCaptureFixture(vertexContext, vertexIndexOffset);
+    const VkMemoryPropertyFlags memFlags = recordFixture
+      ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT
+      : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    DxvkBufferSlice slice = allocVertexCaptureBuffer(m_parent->GetDXVKDevice().ptr(), vertexCaptureDataSize, memFlags);
+
+    if (recordFixture) {
+      // Vertices the draw call doesn't reference are never written to
+      memset(slice.mapPtr(0), 0xFF, vertexCaptureDataSize);
+      m_pendingVertexCaptureFixtures.back().captureBuffer = slice;
+    }
+
+    assignVertexCaptureBuffers(slice);
 
     auto constants = m_vsVertexCaptureData->allocSlice();
 
     // Upload
     auto& data = *reinterpret_cast<D3D9RtxVertexCaptureData*>(constants.mapPtr);
-    data.invProj = inverse(m_activeDrawCallState.transformData.viewToProjection);
-    data.viewToWorld = inverseAffine(m_activeDrawCallState.transformData.worldToView);
-    data.worldToObject = inverseAffine(m_activeDrawCallState.transformData.objectToWorld);
-    data.normalTransform = m_activeDrawCallState.transformData.objectToWorld;
-    data.baseVertex = (uint32_t)std::max(0, vertexIndexOffset);
+    computeVertexCaptureTransforms(vertexIndexOffset, data);
 
     m_parent->EmitCs([cVertexDataSlice = slice,
                       cConstantBuffer = m_vsVertexCaptureData,
@@ -657,8 +741,14 @@ namespace dxvk {
 
     // For shader based drawcalls we also want to capture the vertex shader output
     const bool needVertexCapture = m_parent->UseProgrammableVS() && useVertexCapture();
+    bool needGpuVertexCapture = needVertexCapture;
     if (needVertexCapture) {
-      prepareVertexCapture(vertexIndexOffset);
+      // Small draws with simple shaders can be evaluated on the CPU, which doesn't require the original draw call
+      if (prepareCpuVertexCapture(vertexContext, vertexIndexOffset)) {
+        needGpuVertexCapture = false;
+      } else {
+        prepareVertexCapture(vertexContext, vertexIndexOffset);
+      }
     }
 
     m_activeDrawCallState.usesVertexShader = m_parent->UseProgrammableVS();
@@ -696,7 +786,7 @@ namespace dxvk {
 
     assert(status == RtxGeometryStatus::RayTraced);
 
-    const bool preserveOriginalDraw = needVertexCapture;
+    const bool preserveOriginalDraw = needGpuVertexCapture;
 
     return
       PrepareDrawFlag::CommitToRayTracing |
@@ -1226,12 +1316,73 @@ namespace dxvk {
       static_cast<RtxContext*>(ctx)->endFrame(currentReflexFrameId, targetImage, callInjectRtx); 
     });
 
+    saveVertexCaptureFixtures();
+
     // Reset for the next frame
     m_rtxInjectTriggered = false;
     m_drawCallID = 0;
     m_seenCameraPositionsPrev = std::move(m_seenCameraPositions);
 
     m_stagedBonesCount = 0;
+
+    addHashedTexturesToImGui();
+  }
+
+  void D3D9Rtx::saveVertexCaptureFixtures() {
+    for (auto it = m_pendingVertexCaptureFixtures.begin(); it != m_pendingVertexCaptureFixtures.end(); ) {
+      // Don't stall on the GPU, fixtures still being captured are saved at the end of a later frame
+      if (!m_parent->WaitForResource(it->captureBuffer.buffer(), D3DLOCK_DONOTWAIT)) {
+        ++it;
+        continue;
+      }
+
+      DxsoVertexCaptureFixture& fixture = it->fixture;
+      memcpy(fixture.capturedVertices.data(), it->captureBuffer.mapPtr(0), fixture.capturedVertices.size() * sizeof(CapturedVertex));
+
+      if (fixture.save(it->filePath)) {
+        Logger::info(str::format("[RTX] Recorded vertex capture fixture ", it->filePath));
+      }
+
+      it = m_pendingVertexCaptureFixtures.erase(it);
+    }
+  }
+
+  bool D3D9ImGuiTextureOnceHashed::addIfHashed() {
+    if (!m_hash->isReady()) {
+      return false;
+    }
+
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    if (!m_released) {
+      ImGUI::AddTexture(m_hash->get(), m_view, ImGUI::kTextureFlagsDefault);
+      m_added = true;
+    }
+    return true;
+  }
+
+  void D3D9ImGuiTextureOnceHashed::release() {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    if (m_added) {
+      ImGUI::ReleaseTexture(m_hash->get());
+    }
+    m_released = true;
+    // Don't keep the image alive until the hash is ready
+    m_view = nullptr;
+  }
+
+  Rc<D3D9ImGuiTextureOnceHashed> D3D9Rtx::AddTextureToImGuiOnceHashed(const Rc<PendingTextureHash>& hash, const Rc<DxvkImageView>& view) {
+    Rc<D3D9ImGuiTextureOnceHashed> texture = new D3D9ImGuiTextureOnceHashed(hash, view);
+
+    std::lock_guard<dxvk::mutex> lock(m_imguiTexturesOnceHashedMutex);
+    m_imguiTexturesOnceHashed.push_back(texture);
+    return texture;
+  }
+
+  void D3D9Rtx::addHashedTexturesToImGui() {
+    std::lock_guard<dxvk::mutex> lock(m_imguiTexturesOnceHashedMutex);
+    auto end = std::remove_if(m_imguiTexturesOnceHashed.begin(), m_imguiTexturesOnceHashed.end(),
+                              [](const Rc<D3D9ImGuiTextureOnceHashed>& texture) { return texture->addIfHashed(); });
+    m_imguiTexturesOnceHashed.erase(end, m_imguiTexturesOnceHashed.end());
   }
 
   void D3D9Rtx::OnPresent(const Rc<DxvkImage>& targetImage) {
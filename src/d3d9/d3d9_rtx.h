@@ -2,10 +2,14 @@
 
 #include "d3d9_state.h"
 #include "../dxvk/dxvk_buffer.h"
+#include "../dxvk/dxvk_image.h"
 #include "../util/util_threadpool.h"
+#include "../dxvk/rtx_render/rtx_texture_hasher.h"
+#include "../dxso/dxso_cpu_fixture.h"
 
 #include <vector>
 #include <optional>
+#include <unordered_set>
 
 namespace dxvk {
   struct D3D9BufferSlice;
@@ -18,6 +22,29 @@ namespace dxvk {
 
   using D3D9RtxFlags = Flags<D3D9RtxFlag>;
 
+  /**
+    * \brief: Game texture added to ImGUI once its content hash is ready. Shared by the texture, which releases it when
+    * destroyed, and D3D9Rtx, which adds it at the end of a frame once hashed. Neither needs the other to be alive.
+    */
+  class D3D9ImGuiTextureOnceHashed : public RcObject {
+  public:
+    D3D9ImGuiTextureOnceHashed(const Rc<PendingTextureHash>& hash, const Rc<DxvkImageView>& view)
+      : m_hash(hash), m_view(view) { }
+
+    // Adds the texture to ImGUI if it was hashed and not released yet, returns false while still waiting on the hash
+    bool addIfHashed();
+
+    // Removes the texture from ImGUI if it was added
+    void release();
+
+  private:
+    dxvk::mutex m_mutex;
+    Rc<PendingTextureHash> m_hash;
+    Rc<DxvkImageView> m_view;
+    bool m_added = false;
+    bool m_released = false;
+  };
+
   namespace PrepareDrawFlag {
     enum {
       Ignore                      = 0,
@@ -38,10 +65,16 @@ namespace dxvk {
     RTX_OPTION("rtx", bool, orthographicIsUI, true, "When enabled, draw calls that are orthographic will be considered as UI.");
     RTX_OPTION("rtx", bool, allowCubemaps, false, "When enabled, cubemaps from the game are processed through Remix, but they may not render correctly.");
     RTX_OPTION("rtx", bool, useVertexCapture, true, "When enabled, injects code into the original vertex shader to capture final shaded vertex positions.  Is useful for games using simple vertex shaders, that still also set the fixed function transform matrices.");
+    RTX_OPTION("rtx", bool, useCpuVertexCapture, false, "When enabled, small shader based draw calls are vertex captured by evaluating the vertex shader on the CPU instead of injecting capture code into the GPU shader.  Only shaders without flow control or texture fetches can be evaluated, all other draw calls keep using GPU vertex capture.");
+    RTX_OPTION("rtx", uint32_t, cpuVertexCaptureMaxVertices, 1024, "The maximum number of vertices a draw call may have to be vertex captured on the CPU, see rtx.useCpuVertexCapture.  Larger draw calls use GPU vertex capture.");
+    RTX_OPTION("rtx", std::string, vertexCaptureFixturePath, "", "When set, draw calls vertex captured on the GPU are recorded to this directory as fixtures for the CPU vertex capture unit test, one draw call per vertex shader the CPU evaluator supports.  A fixture holds the shader, its inputs and constants, and the vertices GPU vertex capture wrote, so that CPU vertex capture can be checked against it.");
     RTX_OPTION("rtx", bool, useVertexCapturedNormals, true, "When enabled, vertex normals are read from the input assembler and used in raytracing.  This doesn't always work as normals can be in any coordinate space, but can help sometimes.");
     RTX_OPTION("rtx", bool, useWorldMatricesForShaders, true, "When enabled, Remix will utilize the world matrices being passed from the game via D3D9 fixed function API, even when running with shaders.  Sometimes games pass these matrices and they are useful, however for some games they are very unreliable, and should be filtered out.  If you're seeing precision related issues with shader vertex capture, try disabling this setting.");
     RTX_OPTION("rtx", bool, enableIndexBufferMemoization, true, "CPU performance optimization, should generally be enabled.  Will reduce main thread time by caching processIndexBuffer operations and reusing when possible, this will come at the expense of some CPU RAM.");
     RTX_OPTION("rtx", uint32_t, numGeometryProcessingThreads, 2, "The desired number of CPU threads to dedicate to geometry processing  Will be limited by the number of CPU cores.  There may be some advantage to lowering this number in games which are fairly simple and use a low number of draw calls per frame.  The default was determined by looking at a game with around 2000 draw calls per frame, and with a reasonably high average triangle count per draw.");
+    RTX_OPTION("rtx", bool, asyncTextureHashing, true, "When enabled, the content hashes identifying game textures are computed on worker threads rather than on the thread uploading the textures, and waited for when a draw call first uses the texture.  Reduces stalls when games create many textures at once, i.e. during level loads.  Each texture is still hashed whole by a single thread unless rtx.useTreeTextureHash is enabled, so the hashing of a single large texture is only spread across the threads with it.  Takes effect on device creation.");
+    RTX_OPTION("rtx", uint32_t, numTextureHashingThreads, 2, "The number of CPU threads hashing texture contents when rtx.asyncTextureHashing is enabled.  Will be limited by the number of CPU cores.  Takes effect on device creation.");
+    RTX_OPTION("rtx", bool, useTreeTextureHash, false, "When enabled, textures larger than 256KB are hashed in chunks on several threads, combined into a tree hash, rather than with a single XXH3 hash.  This changes the hashes of those textures, so texture replacements and texture lists of existing mods and configs no longer match them.  Textures up to 256KB keep their hash.");
 
     // Copy of the parameters issued to D3D9 on DrawXXX
     struct DrawContext {
@@ -171,15 +204,37 @@ namespace dxvk {
       return m_reflexFrameId;
     }
 
+    /**
+      * \brief: Gets the texture content hashing workers, null when textures are hashed on the uploading thread.
+      */
+    TextureHasher* GetTextureHasher() const {
+      return m_textureHasher.get();
+    }
+
+    /**
+      * \brief: Adds a texture to ImGUI at the end of the first frame its content hash is ready by.
+      *
+      * \param [in] hash: The pending content hash of the texture.
+      * \param [in] view: The view ImGUI shows the texture with.
+      * \return The registration, to be released when the texture is destroyed.
+      */
+    Rc<D3D9ImGuiTextureOnceHashed> AddTextureToImGuiOnceHashed(const Rc<PendingTextureHash>& hash, const Rc<DxvkImageView>& view);
+
   private: 
     inline static const uint32_t kMaxConcurrentDraws = 6 * 1024; // some games issuing >3000 draw calls per frame...  account for some consumer thread lag with x2
     using GeometryProcessor = WorkerThreadPool<kMaxConcurrentDraws>;
     const std::unique_ptr<GeometryProcessor> m_pGeometryWorkers;
     AtomicQueue<DrawCallState, kMaxConcurrentDraws> m_drawCallStateQueue;
+    const std::unique_ptr<TextureHasher> m_textureHasher;
+    // Textures waiting on their hash to be added to ImGUI
+    std::vector<Rc<D3D9ImGuiTextureOnceHashed>> m_imguiTexturesOnceHashed;
+    dxvk::mutex m_imguiTexturesOnceHashedMutex;
 
     DrawCallState m_activeDrawCallState;
 
     RtxStagingDataAlloc m_rtStagingData;
+    // Scratch page summaries for memoized index buffer processing
+    std::vector<D3D9CommonBuffer::RemixIndexBufferPageSummary> m_indexPageSummaries;
     D3D9DeviceEx* m_parent;
 
     std::optional<D3DPRESENT_PARAMETERS> m_activePresentParams;
@@ -205,6 +260,18 @@ namespace dxvk {
 
     Rc<DxvkBuffer> m_vsVertexCaptureData;
 
+    struct PendingVertexCaptureFixture {
+      DxsoVertexCaptureFixture fixture;
+      DxvkBufferSlice captureBuffer;
+      std::string filePath;
+    };
+
+    // Fixtures recorded while rtx.vertexCaptureFixturePath is set, waiting on the GPU to capture their vertices
+    std::vector<PendingVertexCaptureFixture> m_pendingVertexCaptureFixtures;
+    // Bytecode hashes of the vertex shaders a fixture was recorded for, in m_vertexCaptureFixtureDirectory
+    std::unordered_set<XXH64_hash_t> m_vertexCaptureFixtureShaders;
+    std::string m_vertexCaptureFixtureDirectory;
+
     fast_unordered_cache<Rc<DxvkSampler>> m_samplerCache;
 
     // NOTE: to avoid calculating matrix inverse,
@@ -237,10 +304,28 @@ namespace dxvk {
     template<typename T>
     static void copyIndices(const uint32_t indexCount, T*& pIndicesDst, T* pIndices, uint32_t& minIndex, uint32_t& maxIndex);
 
+    template<typename T>
+    DxvkBufferSlice processMemoizedIndexBuffer(const uint32_t indexCount, const size_t indexOffset, const IndexContext& indexCtx, uint32_t& minIndex, uint32_t& maxIndex);
+
     template<typename T>
     DxvkBufferSlice processIndexBuffer(const uint32_t indexCount, const uint32_t startIndex, const IndexContext& indexCtx, uint32_t& minIndex, uint32_t& maxIndex);
 
-    void prepareVertexCapture(const int vertexIndexOffset);
+    void computeVertexCaptureTransforms(const int vertexIndexOffset, D3D9RtxVertexCaptureData& data) const;
+
+    void assignVertexCaptureBuffers(const DxvkBufferSlice& slice);
+
+    void prepareVertexCapture(const VertexContext vertexContext[caps::MaxStreams], const int vertexIndexOffset);
+
+    bool findCpuVertexCaptureInputs(const VertexContext vertexContext[caps::MaxStreams], const int vertexIndexOffset, const DxsoCpuShader& cpuShader,
+                                    const D3DVERTEXELEMENT9* inputElements[caps::InputRegisterCount], uint32_t& usedStreams) const;
+
+    uint32_t getCpuVertexCaptureConstantCount(const DxsoCpuShader& cpuShader) const;
+
+    bool prepareCpuVertexCapture(const VertexContext vertexContext[caps::MaxStreams], const int vertexIndexOffset);
+
+    bool prepareVertexCaptureFixture(const VertexContext vertexContext[caps::MaxStreams], const int vertexIndexOffset);
+
+    void saveVertexCaptureFixtures();
 
     void processVertices(const VertexContext vertexContext[caps::MaxStreams], int vertexIndexOffset, RasterGeometry& geoData);
 
@@ -271,5 +356,7 @@ namespace dxvk {
     Future<GeometryHashes> computeHash(const RasterGeometry& geoData, const uint32_t maxIndexValue);
 
     void submitActiveDrawCallState();
+
+    void addHashedTexturesToImGui();
   };
 }
@@ -5,6 +5,7 @@
 #include "d3d9_state.h"
 #include "../dxvk/dxvk_buffer.h"
 #include "../dxvk/rtx_render/rtx_hashing.h"
+#include "../dxvk/rtx_render/rtx_utils.h"
 #include "../util/util_fastops.h"
 
 namespace dxvk {
@@ -238,27 +239,241 @@ namespace dxvk {
     return m_pGeometryWorkers->Schedule([pVertexData, vertexCount, vertexStride, vertexBuffer]()->AxisAlignedBoundingBox {
       ScopedCpuProfileZone();
 
-      __m128 minPos = _mm_set_ps1(FLT_MAX);
-      __m128 maxPos = _mm_set_ps1(-FLT_MAX);
+      const AxisAlignedBoundingBox boundingBox = AxisAlignedBoundingBox::fromPositions(pVertexData, vertexCount, vertexStride);
 
-      const uint8_t* pVertex = static_cast<const uint8_t*>(pVertexData);
-      for (uint32_t vertexIdx = 0; vertexIdx < vertexCount; ++vertexIdx) {
-        const Vector3* const pVertexPos = reinterpret_cast<const Vector3* const>(pVertex);
-        __m128 vertexPos = _mm_set_ps(0.0f, pVertexPos->z, pVertexPos->y, pVertexPos->x);
-        minPos = _mm_min_ps(minPos, vertexPos);
-        maxPos = _mm_max_ps(maxPos, vertexPos);
+      vertexBuffer->decRef();
+
+      return boundingBox;
+    });
+  }
+
+  static DxsoCpuInputFormat getCpuInputFormat(D3DDECLTYPE type) {
+    switch (type) {
+    case D3DDECLTYPE_FLOAT1:    return DxsoCpuInputFormat::Float1;
+    case D3DDECLTYPE_FLOAT2:    return DxsoCpuInputFormat::Float2;
+    case D3DDECLTYPE_FLOAT3:    return DxsoCpuInputFormat::Float3;
+    case D3DDECLTYPE_FLOAT4:    return DxsoCpuInputFormat::Float4;
+    case D3DDECLTYPE_D3DCOLOR:  return DxsoCpuInputFormat::Color;
+    case D3DDECLTYPE_UBYTE4:    return DxsoCpuInputFormat::UByte4;
+    case D3DDECLTYPE_UBYTE4N:   return DxsoCpuInputFormat::UByte4N;
+    case D3DDECLTYPE_SHORT2:    return DxsoCpuInputFormat::Short2;
+    case D3DDECLTYPE_SHORT4:    return DxsoCpuInputFormat::Short4;
+    case D3DDECLTYPE_SHORT2N:   return DxsoCpuInputFormat::Short2N;
+    case D3DDECLTYPE_SHORT4N:   return DxsoCpuInputFormat::Short4N;
+    case D3DDECLTYPE_USHORT2N:  return DxsoCpuInputFormat::UShort2N;
+    case D3DDECLTYPE_USHORT4N:  return DxsoCpuInputFormat::UShort4N;
+    case D3DDECLTYPE_FLOAT16_2: return DxsoCpuInputFormat::Half2;
+    case D3DDECLTYPE_FLOAT16_4: return DxsoCpuInputFormat::Half4;
+    default:                    return DxsoCpuInputFormat::Unsupported;
+    }
+  }
+
+  bool D3D9Rtx::findCpuVertexCaptureInputs(const VertexContext vertexContext[caps::MaxStreams], const int vertexIndexOffset, const DxsoCpuShader& cpuShader,
+                                           const D3DVERTEXELEMENT9* inputElements[caps::InputRegisterCount], uint32_t& usedStreams) const {
+    const std::vector<DxsoSemantic>& inputs = cpuShader.inputs();
+    if (!cpuShader.hasOutput({ DxsoUsage::Position, 0 }) || inputs.size() > caps::InputRegisterCount || d3d9State().vertexDecl == nullptr)
+      return false;
+
+    // Every shader input must come from mapped, per-vertex data in a format the evaluator can fetch
+    usedStreams = 0;
+
+    for (uint32_t i = 0; i < inputs.size(); i++) {
+      inputElements[i] = nullptr;
 
-        pVertex += vertexStride;
+      for (const auto& element : d3d9State().vertexDecl->GetElements()) {
+        if (element.Usage == uint32_t(inputs[i].usage) && element.UsageIndex == inputs[i].usageIndex) {
+          inputElements[i] = &element;
+          break;
+        }
       }
 
-      AxisAlignedBoundingBox boundingBox{
-        Vector3{ minPos.m128_f32[0], minPos.m128_f32[1], minPos.m128_f32[2] },
-        Vector3{ maxPos.m128_f32[0], maxPos.m128_f32[1], maxPos.m128_f32[2] }
-      };
+      if (inputElements[i] == nullptr || getCpuInputFormat(D3DDECLTYPE(inputElements[i]->Type)) == DxsoCpuInputFormat::Unsupported)
+        return false;
 
-      vertexBuffer->decRef();
+      const uint32_t stream = inputElements[i]->Stream;
+      if (vertexContext[stream].mappedSlice.mapPtr == nullptr || (d3d9State().streamFreq[stream] & D3DSTREAMSOURCE_INSTANCEDATA))
+        return false;
 
-      return boundingBox;
-    });
+      usedStreams |= 1u << stream;
+    }
+
+    const uint32_t vertexCount = m_activeDrawCallState.geometryData.vertexCount;
+
+    for (uint32_t stream : bit::BitMask(usedStreams)) {
+      const VertexContext& ctx = vertexContext[stream];
+
+      const int64_t vertexOffset = int64_t(ctx.offset) + int64_t(ctx.stride) * vertexIndexOffset;
+      if (vertexOffset < 0 || ctx.mappedSlice.length < uint64_t(vertexOffset) + ctx.stride * vertexCount)
+        return false;
+    }
+
+    return true;
+  }
+
+  uint32_t D3D9Rtx::getCpuVertexCaptureConstantCount(const DxsoCpuShader& cpuShader) const {
+    const D3D9ConstantSets& cb = m_parent->m_consts[DxsoProgramTypes::VertexShader];
+    const uint32_t shaderConstantCount = cpuShader.maxConstantIndex() == UINT32_MAX ? UINT32_MAX : cpuShader.maxConstantIndex() + 1;
+    return std::min({ shaderConstantCount, m_parent->m_vsFloatConstsCount, cb.meta.maxConstIndexF });
+  }
+
+  bool D3D9Rtx::prepareCpuVertexCapture(const VertexContext vertexContext[caps::MaxStreams], const int vertexIndexOffset) {
+    RasterGeometry& geoData = m_activeDrawCallState.geometryData;
+
+    if (!useCpuVertexCapture() || geoData.vertexCount > cpuVertexCaptureMaxVertices())
+      return false;
+
+    const std::shared_ptr<DxsoCpuShader>& cpuShader = d3d9State().vertexShader->GetCommonShader()->GetCpuShader();
+    if (cpuShader == nullptr)
+      return false;
+
+    ScopedCpuProfileZone();
+
+    const D3DVERTEXELEMENT9* inputElements[caps::InputRegisterCount];
+    uint32_t usedStreams = 0;
+
+    if (!findCpuVertexCaptureInputs(vertexContext, vertexIndexOffset, *cpuShader, inputElements, usedStreams))
+      return false;
+
+    // Snapshot everything the evaluation reads, since the app is free to modify the source data once the draw returns
+    const std::vector<DxsoSemantic>& inputs = cpuShader->inputs();
+    const uint32_t constantCount = getCpuVertexCaptureConstantCount(*cpuShader);
+    const uint32_t vertexCount = geoData.vertexCount;
+
+    const size_t inputsOffset = 0;
+    const size_t transformsOffset = align(inputsOffset + inputs.size() * sizeof(DxsoCpuInputStream), 16);
+    const size_t constantsOffset = align(transformsOffset + sizeof(D3D9RtxVertexCaptureData), 16);
+    size_t streamsOffset[caps::MaxStreams];
+    size_t snapshotSize = align(constantsOffset + constantCount * sizeof(Vector4), 16);
+
+    for (uint32_t stream : bit::BitMask(usedStreams)) {
+      streamsOffset[stream] = snapshotSize;
+      snapshotSize = align(snapshotSize + vertexContext[stream].stride * vertexCount, 16);
+    }
+
+    DxvkBufferSlice snapshot = m_rtStagingData.alloc(CACHE_LINE_SIZE, snapshotSize);
+    uint8_t* pSnapshot = reinterpret_cast<uint8_t*>(snapshot.mapPtr(0));
+
+    for (uint32_t stream : bit::BitMask(usedStreams)) {
+      const VertexContext& ctx = vertexContext[stream];
+      const int32_t vertexOffset = ctx.offset + ctx.stride * vertexIndexOffset;
+      memcpy(pSnapshot + streamsOffset[stream], (uint8_t*) ctx.mappedSlice.mapPtr + vertexOffset, ctx.stride * vertexCount);
+    }
+
+    DxsoCpuInputStream* pInputs = reinterpret_cast<DxsoCpuInputStream*>(pSnapshot + inputsOffset);
+    for (uint32_t i = 0; i < inputs.size(); i++) {
+      const D3DVERTEXELEMENT9& element = *inputElements[i];
+      pInputs[i].data = pSnapshot + streamsOffset[element.Stream] + element.Offset;
+      pInputs[i].stride = vertexContext[element.Stream].stride;
+      pInputs[i].format = getCpuInputFormat(D3DDECLTYPE(element.Type));
+    }
+
+    computeVertexCaptureTransforms(vertexIndexOffset, *reinterpret_cast<D3D9RtxVertexCaptureData*>(pSnapshot + transformsOffset));
+    memcpy(pSnapshot + constantsOffset, &d3d9State().vsConsts.fConsts[0], constantCount * sizeof(Vector4));
+
+    // Captured vertices are written straight into host visible memory, in the layout GPU vertex capture produces
+    DxvkBufferSlice slice = m_rtStagingData.alloc(CACHE_LINE_SIZE, align(vertexCount * sizeof(CapturedVertex), CACHE_LINE_SIZE));
+
+    // Acquire prevents the staging allocator from re-using this memory
+    slice.buffer()->acquire(DxvkAccess::Read);
+
+    assignVertexCaptureBuffers(slice);
+
+    // Hold on to the snapshot while the capture is in flight
+    snapshot.buffer()->acquire(DxvkAccess::Read);
+    snapshot.buffer()->incRef();
+
+    auto captureVertices = [cpuShader, snapshotRef = snapshot.buffer().ptr(), pSnapshot,
+                            pVertices = reinterpret_cast<CapturedVertex*>(slice.mapPtr(0)),
+                            transformsOffset, constantsOffset,
+                            constantCount, vertexCount]() {
+      ScopedCpuProfileZoneN("CPU Vertex Capture");
+
+      const DxsoCpuInputStream* pInputs = reinterpret_cast<const DxsoCpuInputStream*>(pSnapshot);
+      const D3D9RtxVertexCaptureData& data = *reinterpret_cast<const D3D9RtxVertexCaptureData*>(pSnapshot + transformsOffset);
+      const Vector4* pConstants = reinterpret_cast<const Vector4*>(pSnapshot + constantsOffset);
+
+      cpuShader->captureVertices(vertexCount, pInputs, pConstants, constantCount, data, pVertices);
+
+      // Release this memory back to the staging allocator
+      snapshotRef->release(DxvkAccess::Read);
+      snapshotRef->decRef();
+    };
+
+    // Note: the lambda is only moved from when the task was actually queued
+    geoData.futureVertexCapture = m_pGeometryWorkers->Schedule(std::move(captureVertices));
+
+    // Worker queue is full, capture on this thread instead
+    if (!geoData.futureVertexCapture.valid()) {
+      captureVertices();
+    }
+
+    return true;
+  }
+
+  bool D3D9Rtx::prepareVertexCaptureFixture(const VertexContext vertexContext[caps::MaxStreams], const int vertexIndexOffset) {
+    const RasterGeometry& geoData = m_activeDrawCallState.geometryData;
+    const D3D9CommonShader* vertexShader = d3d9State().vertexShader->GetCommonShader();
+    const std::shared_ptr<DxsoCpuShader>& cpuShader = vertexShader->GetCpuShader();
+
+    if (cpuShader == nullptr || geoData.vertexCount > cpuVertexCaptureMaxVertices())
+      return false;
+
+    // Start over when pointed at another directory
+    if (m_vertexCaptureFixtureDirectory != vertexCaptureFixturePath()) {
+      m_vertexCaptureFixtureDirectory = vertexCaptureFixturePath();
+      m_vertexCaptureFixtureShaders.clear();
+
+      // Fails when the directory already exists, any other error shows once a fixture is saved
+      env::createDirectory(m_vertexCaptureFixtureDirectory);
+    }
+
+    // One draw call per shader, the fixtures are meant to cover many different shaders rather than many draw calls
+    const std::vector<uint8_t>& bytecode = vertexShader->GetBytecode();
+    const XXH64_hash_t shaderHash = XXH3_64bits(bytecode.data(), bytecode.size());
+    if (m_vertexCaptureFixtureShaders.count(shaderHash) != 0)
+      return false;
+
+    const D3DVERTEXELEMENT9* inputElements[caps::InputRegisterCount];
+    uint32_t usedStreams = 0;
+
+    if (!findCpuVertexCaptureInputs(vertexContext, vertexIndexOffset, *cpuShader, inputElements, usedStreams))
+      return false;
+
+    ScopedCpuProfileZone();
+
+    m_vertexCaptureFixtureShaders.insert(shaderHash);
+
+    PendingVertexCaptureFixture pending;
+    pending.filePath = str::format(m_vertexCaptureFixtureDirectory, "/", hashToString(shaderHash), ".dxvc");
+
+    DxsoVertexCaptureFixture& fixture = pending.fixture;
+    fixture.bytecode = bytecode;
+    fixture.options = cpuShader->options();
+
+    uint32_t streamsOffset[caps::MaxStreams];
+
+    for (uint32_t stream : bit::BitMask(usedStreams)) {
+      const VertexContext& ctx = vertexContext[stream];
+      const uint8_t* pVertexData = (const uint8_t*) ctx.mappedSlice.mapPtr + ctx.offset + ctx.stride * vertexIndexOffset;
+
+      streamsOffset[stream] = uint32_t(fixture.vertexData.size());
+      fixture.vertexData.insert(fixture.vertexData.end(), pVertexData, pVertexData + ctx.stride * geoData.vertexCount);
+    }
+
+    for (uint32_t i = 0; i < cpuShader->inputs().size(); i++) {
+      const D3DVERTEXELEMENT9& element = *inputElements[i];
+      fixture.inputs.push_back({ streamsOffset[element.Stream] + element.Offset, vertexContext[element.Stream].stride, getCpuInputFormat(D3DDECLTYPE(element.Type)) });
+    }
+
+    const Vector4* pConstants = &d3d9State().vsConsts.fConsts[0];
+    fixture.constants.assign(pConstants, pConstants + getCpuVertexCaptureConstantCount(*cpuShader));
+
+    computeVertexCaptureTransforms(vertexIndexOffset, fixture.transforms);
+
+    // Filled in once the GPU has captured the vertices, see saveVertexCaptureFixtures
+    fixture.capturedVertices.resize(geoData.vertexCount);
+
+    m_pendingVertexCaptureFixtures.push_back(std::move(pending));
+    return true;
   }
 }
@@ -0,0 +1,77 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include "../util/util_matrix.h"
+#include "../util/util_vector.h"
+
+namespace dxvk {
+
+  // Layouts shared by the vertex capture code injected into vertex shaders (see emitVertexCaptureWrite
+  // in dxso_compiler.cpp) and CPU vertex capture. Kept free of D3D9 headers so tests can use them.
+
+  // NOTE: Padding exists to ensure we get vectorized loads for these attributes
+  struct CapturedVertex {
+    Vector3 position;
+    uint32_t pad0;
+    Vector2 texcoord0;
+    uint32_t pad1;
+    uint32_t pad2;
+    Vector3 normal0;
+    uint32_t color0;
+  };
+
+  enum class CapturedVertexMembers {
+    Position = 0,
+    Texcoord0,
+    Normal0,
+    Color0,
+
+    MemberCount
+  };
+
+  struct D3D9RtxVertexCaptureData {
+    Matrix4 normalTransform;
+    Matrix4 customWorldToProjection;
+    Matrix4 invProj;
+    Matrix4 viewToWorld;
+    Matrix4 worldToObject;
+    uint32_t baseVertex = 0;
+    float jitterX;
+    float jitterY;
+    uint32_t padding;
+  };
+
+  enum class D3D9RtxVertexCaptureMembers {
+    NormalTransform = 0,
+    CustomWorldToProjection,
+    InvProj,
+    ViewToWorld,
+    WorldToObject,
+    BaseVertex,
+    JitterX,
+    JitterY,
+
+    MemberCount
+  };
+
+}
@@ -4,6 +4,9 @@
 #include "d3d9_device.h"
 #include "d3d9_util.h"
 #include "../dxvk/dxvk_scoped_annotation.h"
+#include "../dxvk/rtx_render/rtx_terrain_baker.h"
+
+#include <version.h>
 
 
 namespace dxvk {
@@ -58,12 +61,31 @@ namespace dxvk {
     const D3D9ConstantLayout& constantLayout = ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
       ? pDevice->GetVertexConstantLayout()
       : pDevice->GetPixelConstantLayout();
-    m_shaders      = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout);
-    m_isgn         = pModule->isgn();
-    // NV-DXVK start: expose shader outputs for vertex capture
-    m_osgn = pModule->osgn();
+
+    // NV-DXVK start: shader disk cache
+    DxsoShaderCache* pShaderCache = pDevice->GetShaderCache();
+    const XXH64_hash_t cacheKey = pShaderCache != nullptr
+      ? ComputeShaderCacheKey(ShaderStage, pShaderBytecode, bytecodeLength, pDxsoModuleInfo->options, constantLayout)
+      : 0;
+
+    DxsoCachedModule cachedModule;
+
+    if (pShaderCache != nullptr && pShaderCache->lookup(cacheKey, cachedModule) && RestoreFromCache(cachedModule)) {
+      Logger::debug(str::format("Loaded shader ", name, " from cache"));
+    } else {
+      m_shaders      = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout);
+      m_isgn         = pModule->isgn();
+      m_osgn         = pModule->osgn();
+      m_usedSamplers = pModule->usedSamplers();
+      m_usedRTs      = pModule->usedRTs();
+      m_meta         = pModule->meta();
+      m_constants    = pModule->constants();
+      m_maxDefinedConst = pModule->maxDefinedConstant();
+
+      if (pShaderCache != nullptr)
+        pShaderCache->insert(cacheKey, StoreToCache());
+    }
     // NV-DXVK end
-    m_usedSamplers = pModule->usedSamplers();
 
     // Shift up these sampler bits so we can just
     // do an or per-draw in the device.
@@ -71,12 +93,21 @@ namespace dxvk {
     if (ShaderStage == VK_SHADER_STAGE_VERTEX_BIT)
       m_usedSamplers <<= caps::MaxTexturesPS + 1;
 
-    m_usedRTs      = pModule->usedRTs();
-
     m_info      = pModule->info();
-    m_meta      = pModule->meta();
-    m_constants = pModule->constants();
-    m_maxDefinedConst = pModule->maxDefinedConstant();
+
+    // NV-DXVK start: CPU vertex capture
+    if (ShaderStage == VK_SHADER_STAGE_VERTEX_BIT) {
+      const DxsoOptions& options = pDxsoModuleInfo->options;
+
+      DxsoCpuShaderOptions cpuOptions;
+      cpuOptions.mulZeroIsZero   = options.d3d9FloatEmulation == D3D9FloatEmulation::Strict;
+      cpuOptions.clampInfinities = options.d3d9FloatEmulation == D3D9FloatEmulation::Enabled;
+      cpuOptions.strictPow       = options.strictPow && options.d3d9FloatEmulation != D3D9FloatEmulation::Disabled;
+
+      // Not every shader can be evaluated on the CPU, those keep using GPU vertex capture
+      m_cpuShader = DxsoCpuShader::create(pShaderBytecode, cpuOptions);
+    }
+    // NV-DXVK end
 
     m_shaders[0]->setShaderKey(Key);
 
@@ -100,6 +131,123 @@ namespace dxvk {
   }
 
 
+  // NV-DXVK start: shader disk cache
+  bool D3D9CommonShader::RestoreFromCache(const DxsoCachedModule& Module) {
+    if (Module.shaders.size() != m_shaders.size() || !Module.shaders[D3D9ShaderPermutations::None])
+      return false;
+
+    for (uint32_t i = 0; i < m_shaders.size(); i++) {
+      if (Module.shaders[i])
+        m_shaders[i] = FromCachedShader(*Module.shaders[i]);
+    }
+
+    m_isgn            = Module.isgn;
+    m_osgn            = Module.osgn;
+    m_usedSamplers    = Module.usedSamplers;
+    m_usedRTs         = Module.usedRTs;
+    m_meta            = Module.meta;
+    m_constants       = Module.constants;
+    m_maxDefinedConst = Module.maxDefinedConst;
+    return true;
+  }
+
+
+  DxsoCachedModule D3D9CommonShader::StoreToCache() const {
+    DxsoCachedModule module;
+    module.isgn            = m_isgn;
+    module.osgn            = m_osgn;
+    module.meta            = m_meta;
+    module.constants       = m_constants;
+    module.maxDefinedConst = m_maxDefinedConst;
+    module.usedSamplers    = m_usedSamplers;
+    module.usedRTs         = m_usedRTs;
+
+    module.shaders.resize(m_shaders.size());
+
+    for (uint32_t i = 0; i < m_shaders.size(); i++) {
+      if (m_shaders[i] != nullptr)
+        module.shaders[i] = ToCachedShader(m_shaders[i]);
+    }
+
+    return module;
+  }
+
+
+  XXH64_hash_t ComputeShaderCacheKey(
+          VkShaderStageFlagBits ShaderStage,
+    const void*                 pShaderBytecode,
+          size_t                BytecodeLength,
+    const DxsoOptions&          Options,
+    const D3D9ConstantLayout&   Layout) {
+    XXH64_hash_t key = XXH3_64bits(pShaderBytecode, BytecodeLength);
+    key = HashShaderCacheValue(ShaderStage, key);
+
+    // Hash option by option, the struct itself has padding
+    key = HashShaderCacheValue(Options.useDemoteToHelperInvocation, key);
+    key = HashShaderCacheValue(Options.useSubgroupOpsForEarlyDiscard, key);
+    key = HashShaderCacheValue(Options.strictConstantCopies, key);
+    key = HashShaderCacheValue(Options.d3d9FloatEmulation, key);
+    key = HashShaderCacheValue(Options.strictPow, key);
+    key = HashShaderCacheValue(Options.shaderModel, key);
+    key = HashShaderCacheValue(Options.invariantPosition, key);
+    key = HashShaderCacheValue(Options.forceSamplerTypeSpecConstants, key);
+    key = HashShaderCacheValue(Options.vertexFloatConstantBufferAsSSBO, key);
+    key = HashShaderCacheValue(Options.longMad, key);
+    key = HashShaderCacheValue(Options.alphaTestWiggleRoom, key);
+    key = HashShaderCacheValue(Options.robustness2Supported, key);
+
+    key = HashShaderCacheValue(Layout.floatCount, key);
+    key = HashShaderCacheValue(Layout.intCount, key);
+    key = HashShaderCacheValue(Layout.boolCount, key);
+    key = HashShaderCacheValue(Layout.bitmaskCount, key);
+
+    // Texture reads are patched when terrain baking replaces their textures
+    key = HashShaderCacheValue(TerrainBaker::Material::replacementSupportInPS_programmableShaders(), key);
+
+    return HashShaderCacheValue(GetVertexCaptureCacheKey(), key);
+  }
+
+
+  XXH64_hash_t GetVertexCaptureCacheKey() {
+    // Vertex capture code is injected into every vertex shader, so
+    // any change to the data it writes must miss in the cache
+    XXH64_hash_t key = HashShaderCacheValue(sizeof(CapturedVertex), 0);
+    key = HashShaderCacheValue(sizeof(D3D9RtxVertexCaptureData), key);
+    key = HashShaderCacheValue(getVertexCaptureBufferSlot(), key);
+    return key;
+  }
+
+
+  uint64_t GetShaderCacheVersionStamp() {
+    // Bump when shader generation changes without a version change, e.g. in local builds
+    constexpr uint32_t ShaderCacheRevision = 1;
+    return HashShaderCacheValue(ShaderCacheRevision, XXH3_64bits(DXVK_VERSION, sizeof(DXVK_VERSION)));
+  }
+
+
+  DxsoCachedShader ToCachedShader(const Rc<DxvkShader>& Shader) {
+    DxsoCachedShader cached;
+    cached.stage          = Shader->stage();
+    cached.slots          = Shader->resourceSlots();
+    cached.interfaceSlots = Shader->interfaceSlots();
+    cached.code           = Shader->compressedCode();
+    return cached;
+  }
+
+
+  Rc<DxvkShader> FromCachedShader(const DxsoCachedShader& Shader) {
+    return new DxvkShader(
+      Shader.stage,
+      Shader.slots.size(),
+      Shader.slots.data(),
+      Shader.interfaceSlots,
+      Shader.code.decompress(),
+      DxvkShaderOptions(),
+      DxvkShaderConstData());
+  }
+  // NV-DXVK end
+
+
   void D3D9ShaderModuleSet::GetShaderModule(
             D3D9DeviceEx*         pDevice,
             D3D9CommonShader*     pShaderModule,
@@ -2,6 +2,8 @@
 
 #include "d3d9_resource.h"
 #include "../dxso/dxso_module.h"
+#include "../dxso/dxso_cpu_evaluator.h"
+#include "../dxso/dxso_shader_cache.h"
 #include "d3d9_shader_permutations.h"
 #include "d3d9_util.h"
 
@@ -64,6 +66,10 @@ namespace dxvk {
 
     uint32_t GetMaxDefinedConstant() const { return m_maxDefinedConst; }
 
+    // NV-DXVK start: CPU vertex capture
+    const std::shared_ptr<DxsoCpuShader>& GetCpuShader() const { return m_cpuShader; }
+    // NV-DXVK end
+
   private:
 
     DxsoIsgn              m_isgn;
@@ -82,6 +88,16 @@ namespace dxvk {
 
     std::vector<uint8_t>  m_bytecode;
 
+    // NV-DXVK start: CPU vertex capture
+    std::shared_ptr<DxsoCpuShader> m_cpuShader;
+    // NV-DXVK end
+
+    // NV-DXVK start: shader disk cache
+    bool RestoreFromCache(const DxsoCachedModule& Module);
+
+    DxsoCachedModule StoreToCache() const;
+    // NV-DXVK end
+
   };
 
   /**
@@ -200,6 +216,40 @@ namespace dxvk {
     
   };
 
+  // NV-DXVK start: shader disk cache
+  template<typename T>
+  XXH64_hash_t HashShaderCacheValue(const T& Value, XXH64_hash_t Seed) {
+    return XXH3_64bits_withSeed(&Value, sizeof(Value), Seed);
+  }
+
+  /**
+   * \brief Computes the disk cache key of a DXSO shader
+   *
+   * Covers the bytecode and everything else that changes
+   * the generated SPIR-V for it.
+   */
+  XXH64_hash_t ComputeShaderCacheKey(
+          VkShaderStageFlagBits ShaderStage,
+    const void*                 pShaderBytecode,
+          size_t                BytecodeLength,
+    const DxsoOptions&          Options,
+    const D3D9ConstantLayout&   Layout);
+
+  XXH64_hash_t GetVertexCaptureCacheKey();
+
+  /**
+   * \brief Version stamp of the shader disk cache
+   *
+   * Derived from the build version, so cached SPIR-V
+   * never outlives the compiler that produced it.
+   */
+  uint64_t GetShaderCacheVersionStamp();
+
+  DxsoCachedShader ToCachedShader(const Rc<DxvkShader>& Shader);
+
+  Rc<DxvkShader> FromCachedShader(const DxsoCachedShader& Shader);
+  // NV-DXVK end
+
   template<typename T>
   const D3D9CommonShader* GetCommonShader(const T& pShader) {
     return pShader != nullptr ? pShader->GetCommonShader() : nullptr;
@@ -9,6 +9,9 @@
 #include "d3d9_shader.h"
 #include "d3d9_vertex_declaration.h"
 #include "d3d9_buffer.h"
+// NV-DXVK start: vertex shader data capture implementation
+#include "d3d9_rtx_vertex_capture.h"
+// NV-DXVK end
 
 #include <array>
 #include <bitset>
@@ -30,53 +33,6 @@ namespace dxvk {
     float coeff[4];
   };
 
-  // NV-DXVK start: vertex shader data capture implementation
-  // NOTE: Padding exists to ensure we get vectorized loads for these attributes
-  struct CapturedVertex {
-    Vector3 position;
-    uint32_t pad0;
-    Vector2 texcoord0;
-    uint32_t pad1;
-    uint32_t pad2;
-    Vector3 normal0;
-    uint32_t color0;
-  };
-
-  enum class CapturedVertexMembers {
-    Position = 0,
-    Texcoord0,
-    Normal0,
-    Color0,
-
-    MemberCount
-  };
-
-  struct D3D9RtxVertexCaptureData {
-    Matrix4 normalTransform;
-    Matrix4 customWorldToProjection;
-    Matrix4 invProj;
-    Matrix4 viewToWorld;
-    Matrix4 worldToObject;
-    uint32_t baseVertex = 0;
-    float jitterX;
-    float jitterY;
-    uint32_t padding;
-  };
-
-  enum class D3D9RtxVertexCaptureMembers {
-    NormalTransform = 0,
-    CustomWorldToProjection,
-    InvProj,
-    ViewToWorld,
-    WorldToObject,
-    BaseVertex,
-    JitterX,
-    JitterY,
-
-    MemberCount
-  };
-  // NV-DXVK end
-
   struct D3D9RenderStateInfo {
     std::array<float, 3> fogColor = { };
     float fogScale = 0.0f;
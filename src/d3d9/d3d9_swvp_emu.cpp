@@ -2,6 +2,9 @@
 
 #include "d3d9_device.h"
 #include "d3d9_vertex_declaration.h"
+// NV-DXVK start: SWVP module cache
+#include "d3d9_shader.h"
+// NV-DXVK end
 
 #include "../spirv/spirv_module.h"
 #include "../dxvk/dxvk_scoped_annotation.h"
@@ -308,54 +311,200 @@ namespace dxvk {
 
   };
 
+  // NV-DXVK start: SWVP module cache
+  namespace {
+    // The generated code only depends on the declaration and the buffer slot,
+    // compiler changes are covered by the version stamp of the cache file
+    XXH64_hash_t GetSWVPCacheKey(const D3D9VertexElements& elements) {
+      XXH64_hash_t key = XXH3_64bits(elements.data(), elements.size() * sizeof(elements[0]));
+      key = HashShaderCacheValue(VK_SHADER_STAGE_GEOMETRY_BIT, key);
+      return HashShaderCacheValue(getSWVPBufferSlot(), key);
+    }
+  }
+
+
+  D3D9SWVPEmulator::~D3D9SWVPEmulator() {
+    StopPrewarm();
+
+    for (auto& bucket : m_buckets) {
+      const Module* module = bucket.load();
+
+      while (module != nullptr) {
+        const Module* next = module->next;
+        delete module;
+        module = next;
+      }
+    }
+  }
+
+
+  void D3D9SWVPEmulator::StartPrewarm(D3D9DeviceEx* pDevice) {
+    m_prewarmThread = dxvk::thread([this, pDevice] () { Prewarm(pDevice); });
+  }
+
+
+  void D3D9SWVPEmulator::StopPrewarm() {
+    m_stopPrewarm = true;
+
+    if (m_prewarmThread.joinable())
+      m_prewarmThread.join();
+  }
+  // NV-DXVK end
+
+
   Rc<DxvkShader> D3D9SWVPEmulator::GetShaderModule(D3D9DeviceEx* pDevice, const D3D9VertexDecl* pDecl) {
     ScopedCpuProfileZone();
     auto& elements = pDecl->GetElements();
 
+    // NV-DXVK start: SWVP module cache
+    const size_t bucket = D3D9VertexDeclHash()(elements) % BucketCount;
+
     // Use the shader's unique key for the lookup
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      
-      auto entry = m_modules.find(elements);
-      if (entry != m_modules.end())
-        return entry->second;
-    }
+    if (const Module* module = FindModule(elements, bucket))
+      return module->shader;
 
-    Sha1Hash hash = Sha1Hash::compute(
-      elements.data(), elements.size() * sizeof(elements[0]));
+    Rc<DxvkShader> shader = LoadFromCache(pDevice, elements);
 
-    DxvkShaderKey key = { VK_SHADER_STAGE_GEOMETRY_BIT , hash };
-    std::string name = str::format("SWVP_", key.toString());
-    
-    // This shader has not been compiled yet, so we have to create a
-    // new module. This takes a while, so we won't lock the structure.
-    D3D9SWVPEmulatorGenerator generator(name);
-    generator.compile(pDecl);
-    Rc<DxvkShader> shader = generator.finalize();
+    if (shader == nullptr) {
+      Sha1Hash hash = Sha1Hash::compute(
+        elements.data(), elements.size() * sizeof(elements[0]));
 
-    shader->setShaderKey(key);
-    pDevice->GetDXVKDevice()->registerShader(shader);
+      DxvkShaderKey key = { VK_SHADER_STAGE_GEOMETRY_BIT , hash };
+      std::string name = str::format("SWVP_", key.toString());
+
+      // This shader has not been compiled yet, so we have to create a
+      // new module. This takes a while, so we won't lock the structure.
+      D3D9SWVPEmulatorGenerator generator(name);
+      generator.compile(pDecl);
+      shader = generator.finalize();
 
-    const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
+      const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
 
-    if (dumpPath.size() != 0) {
-      std::ofstream dumpStream(
-        str::format(dumpPath, "/", name, ".spv"),
-        std::ios_base::binary | std::ios_base::trunc);
+      if (dumpPath.size() != 0) {
+        std::ofstream dumpStream(
+          str::format(dumpPath, "/", name, ".spv"),
+          std::ios_base::binary | std::ios_base::trunc);
 
-      shader->dump(dumpStream);
+        shader->dump(dumpStream);
+      }
+
+      StoreToCache(pDevice, elements, shader);
     }
-    
+
+    RegisterShader(pDevice, elements, shader);
+
     // Insert the new module into the lookup table. If another thread
     // has compiled the same shader in the meantime, we should return
     // that object instead and discard the newly created module.
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      
-      auto status = m_modules.insert({ elements, shader });
-      if (!status.second)
-        return status.first->second;
-    }
+    return InsertModule(elements, bucket, shader);
+    // NV-DXVK end
+  }
+
+
+  // NV-DXVK start: SWVP module cache
+  const D3D9SWVPEmulator::Module* D3D9SWVPEmulator::FindModule(const D3D9VertexElements& elements, size_t bucket) const {
+    // Modules are fully written before they are published, and never change afterwards
+    const Module* module = m_buckets[bucket].load(std::memory_order_acquire);
+
+    while (module != nullptr && !D3D9VertexDeclEq()(module->elements, elements))
+      module = module->next;
+
+    return module;
+  }
+
+
+  Rc<DxvkShader> D3D9SWVPEmulator::InsertModule(const D3D9VertexElements& elements, size_t bucket, const Rc<DxvkShader>& shader) {
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
 
+    if (const Module* module = FindModule(elements, bucket))
+      return module->shader;
+
+    const Module* module = new Module { elements, shader, m_buckets[bucket].load(std::memory_order_relaxed) };
+    m_buckets[bucket].store(module, std::memory_order_release);
     return shader;
   }
 
-}
\ No newline at end of file
+
+  Rc<DxvkShader> D3D9SWVPEmulator::LoadFromCache(D3D9DeviceEx* pDevice, const D3D9VertexElements& elements) {
+    DxsoShaderCache* pShaderCache = pDevice->GetShaderCache();
+    DxsoCachedModule module;
+
+    if (pShaderCache == nullptr || !pShaderCache->lookup(GetSWVPCacheKey(elements), module))
+      return nullptr;
+
+    if (module.shaders.size() != 1 || !module.shaders[0] || module.shaders[0]->stage != VK_SHADER_STAGE_GEOMETRY_BIT)
+      return nullptr;
+
+    return FromCachedShader(*module.shaders[0]);
+  }
+
+
+  void D3D9SWVPEmulator::StoreToCache(D3D9DeviceEx* pDevice, const D3D9VertexElements& elements, const Rc<DxvkShader>& shader) {
+    DxsoShaderCache* pShaderCache = pDevice->GetShaderCache();
+
+    if (pShaderCache == nullptr)
+      return;
+
+    DxsoCachedModule module;
+    module.shaders.emplace_back(ToCachedShader(shader));
+
+    // The declaration is stored so that the module can be prewarmed on the next run
+    module.inputs.resize(elements.size() * sizeof(elements[0]));
+    std::memcpy(module.inputs.data(), elements.data(), module.inputs.size());
+
+    pShaderCache->insert(GetSWVPCacheKey(elements), module);
+  }
+
+
+  void D3D9SWVPEmulator::RegisterShader(D3D9DeviceEx* pDevice, const D3D9VertexElements& elements, const Rc<DxvkShader>& shader) {
+    Sha1Hash hash = Sha1Hash::compute(
+      elements.data(), elements.size() * sizeof(elements[0]));
+
+    shader->setShaderKey({ VK_SHADER_STAGE_GEOMETRY_BIT, hash });
+    pDevice->GetDXVKDevice()->registerShader(shader);
+  }
+
+
+  void D3D9SWVPEmulator::Prewarm(D3D9DeviceEx* pDevice) {
+    env::setThreadName("dxvk-swvp-prewarm");
+
+    // Waits for the cache file to be read
+    const auto storedInputs = pDevice->GetShaderCache()->getStoredInputs();
+
+    uint32_t numLoaded = 0;
+
+    for (const auto& [cacheKey, inputs] : storedInputs) {
+      if (m_stopPrewarm)
+        return;
+
+      if (inputs.empty() || inputs.size() % sizeof(D3DVERTEXELEMENT9))
+        continue;
+
+      D3D9VertexElements elements(inputs.size() / sizeof(D3DVERTEXELEMENT9));
+      std::memcpy(elements.data(), inputs.data(), inputs.size());
+
+      // Also skips the inputs of other kinds of modules, i.e. fixed function shader keys
+      if (GetSWVPCacheKey(elements) != cacheKey)
+        continue;
+
+      const size_t bucket = D3D9VertexDeclHash()(elements) % BucketCount;
+
+      if (FindModule(elements, bucket))
+        continue;
+
+      Rc<DxvkShader> shader = LoadFromCache(pDevice, elements);
+
+      if (shader == nullptr)
+        continue;
+
+      RegisterShader(pDevice, elements, shader);
+      InsertModule(elements, bucket, shader);
+      numLoaded += 1;
+    }
+
+    if (numLoaded != 0)
+      Logger::info(str::format("D3D9: Prewarmed ", numLoaded, " SWVP emulation modules"));
+  }
+  // NV-DXVK end
+
+}
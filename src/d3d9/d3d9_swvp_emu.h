@@ -1,6 +1,10 @@
 #pragma once
 
 #include <unordered_map>
+// NV-DXVK start: SWVP module cache
+#include <array>
+#include <atomic>
+// NV-DXVK end
 
 #include "d3d9_include.h"
 
@@ -23,15 +27,62 @@ namespace dxvk {
 
   public:
 
+    // NV-DXVK start: SWVP module cache
+    ~D3D9SWVPEmulator();
+
+    /**
+     * \brief Loads the modules stored in the shader disk cache
+     *
+     * Runs on a worker thread, so that the first draws
+     * using each vertex declaration skip compilation.
+     * \param [in] pDevice The device, must outlive the thread
+     */
+    void StartPrewarm(D3D9DeviceEx* pDevice);
+
+    /**
+     * \brief Stops loading modules
+     *
+     * Must be called before the device's
+     * shader disk cache is destroyed.
+     */
+    void StopPrewarm();
+    // NV-DXVK end
+
     Rc<DxvkShader> GetShaderModule(D3D9DeviceEx* pDevice, const D3D9VertexDecl* pDecl);
 
   private:
 
+    // NV-DXVK start: SWVP module cache
+    struct Module {
+      D3D9VertexElements elements;
+      Rc<DxvkShader>     shader;
+      const Module*      next;
+    };
+
+    static constexpr size_t BucketCount = 256;
+
+    // Append-only hash table. Modules are inserted under m_mutex and looked
+    // up without it, so draws on several threads don't serialize on lookups.
+    // They are only freed with the emulator.
+    std::array<std::atomic<const Module*>, BucketCount> m_buckets = { };
+
     dxvk::mutex                               m_mutex;
 
-    std::unordered_map<
-      D3D9VertexElements, Rc<DxvkShader>,
-      D3D9VertexDeclHash, D3D9VertexDeclEq>   m_modules;
+    std::atomic<bool>                         m_stopPrewarm = { false };
+    dxvk::thread                              m_prewarmThread;
+
+    const Module* FindModule(const D3D9VertexElements& elements, size_t bucket) const;
+
+    Rc<DxvkShader> InsertModule(const D3D9VertexElements& elements, size_t bucket, const Rc<DxvkShader>& shader);
+
+    Rc<DxvkShader> LoadFromCache(D3D9DeviceEx* pDevice, const D3D9VertexElements& elements);
+
+    void StoreToCache(D3D9DeviceEx* pDevice, const D3D9VertexElements& elements, const Rc<DxvkShader>& shader);
+
+    void RegisterShader(D3D9DeviceEx* pDevice, const D3D9VertexElements& elements, const Rc<DxvkShader>& shader);
+
+    void Prewarm(D3D9DeviceEx* pDevice);
+    // NV-DXVK end
 
   };
 
@@ -0,0 +1,119 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace dxvk {
+
+  /**
+   * \brief Appends plain data to a byte buffer
+   *
+   * Used for the files written by the DXSO frontend,
+   * which are only ever read back on the same platform.
+   */
+  class DxsoBinaryWriter {
+
+  public:
+
+    DxsoBinaryWriter(std::vector<uint8_t>& data)
+    : m_data(data) { }
+
+    template<typename T>
+    void write(const T& value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      write(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void writeArray(const std::vector<T>& values) {
+      write(uint32_t(values.size()));
+      write(values.data(), values.size() * sizeof(T));
+    }
+
+  private:
+
+    std::vector<uint8_t>& m_data;
+
+    void write(const void* data, size_t size) {
+      const size_t offset = m_data.size();
+      m_data.resize(offset + size);
+      std::memcpy(m_data.data() + offset, data, size);
+    }
+
+  };
+
+
+  /**
+   * \brief Reads data written by \ref DxsoBinaryWriter
+   *
+   * All reads are bounds checked, so damaged
+   * data makes reads fail instead of crashing.
+   */
+  class DxsoBinaryReader {
+
+  public:
+
+    DxsoBinaryReader(const std::vector<uint8_t>& data)
+    : m_data(data) { }
+
+    template<typename T>
+    bool read(T& value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      return read(&value, sizeof(T));
+    }
+
+    template<typename T>
+    bool readArray(std::vector<T>& values) {
+      uint32_t count = 0;
+
+      if (!read(count) || count > (m_data.size() - m_offset) / sizeof(T))
+        return false;
+
+      values.resize(count);
+      return read(values.data(), count * sizeof(T));
+    }
+
+    bool eof() const {
+      return m_offset == m_data.size();
+    }
+
+  private:
+
+    const std::vector<uint8_t>& m_data;
+    size_t                      m_offset = 0;
+
+    bool read(void* data, size_t size) {
+      if (m_offset + size > m_data.size())
+        return false;
+
+      std::memcpy(data, m_data.data() + m_offset, size);
+      m_offset += size;
+      return true;
+    }
+
+  };
+
+}
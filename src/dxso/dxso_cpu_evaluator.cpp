@@ -0,0 +1,1028 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "dxso_cpu_evaluator.h"
+
+#include "dxso_reader.h"
+#include "dxso_header.h"
+#include "dxso_code.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include <emmintrin.h>
+
+namespace dxvk {
+
+  namespace {
+
+    // One DXSO register for four vertices, component-major
+    struct Vec {
+      __m128 c[4];
+    };
+
+    constexpr uint32_t LaneCount = 4;
+
+    inline __m128 mulOperands(__m128 a, __m128 b, bool mulZeroIsZero) {
+      __m128 product = _mm_mul_ps(a, b);
+
+      if (!mulZeroIsZero)
+        return product;
+
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 anyZero = _mm_or_ps(_mm_cmpeq_ps(a, zero), _mm_cmpeq_ps(b, zero));
+      return _mm_andnot_ps(anyZero, product);
+    }
+
+    inline __m128 saturate(__m128 v) {
+      // max(0, v) first so that NaN collapses to 0 like SPIR-V NClamp
+      return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    }
+
+    inline __m128 absolute(__m128 v) {
+      return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+    }
+
+    inline __m128 negate(__m128 v) {
+      return _mm_xor_ps(_mm_set1_ps(-0.0f), v);
+    }
+
+    template<typename Fn>
+    inline __m128 perLane(__m128 v, Fn fn) {
+      alignas(16) float lanes[LaneCount];
+      _mm_store_ps(lanes, v);
+      for (uint32_t i = 0; i < LaneCount; i++)
+        lanes[i] = fn(lanes[i]);
+      return _mm_load_ps(lanes);
+    }
+
+    template<typename Fn>
+    inline __m128 perLane(__m128 a, __m128 b, Fn fn) {
+      alignas(16) float la[LaneCount];
+      alignas(16) float lb[LaneCount];
+      _mm_store_ps(la, a);
+      _mm_store_ps(lb, b);
+      for (uint32_t i = 0; i < LaneCount; i++)
+        la[i] = fn(la[i], lb[i]);
+      return _mm_load_ps(la);
+    }
+
+    inline float halfToFloat(uint16_t h) {
+      const uint32_t sign = uint32_t(h & 0x8000) << 16;
+      const uint32_t exponent = (h >> 10) & 0x1f;
+      const uint32_t mantissa = h & 0x3ff;
+
+      uint32_t bits;
+      if (exponent == 0) {
+        // Zero or denormal, both are exactly representable in fp32
+        float f = std::ldexp(float(mantissa), -24);
+        std::memcpy(&bits, &f, sizeof(bits));
+        bits |= sign;
+      } else if (exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+      } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+      }
+
+      float result;
+      std::memcpy(&result, &bits, sizeof(result));
+      return result;
+    }
+
+    template<typename T>
+    inline T readUnaligned(const uint8_t* ptr) {
+      T value;
+      std::memcpy(&value, ptr, sizeof(T));
+      return value;
+    }
+
+    Vector4 fetchAttribute(const uint8_t* ptr, DxsoCpuInputFormat format) {
+      Vector4 v(0.0f, 0.0f, 0.0f, 1.0f);
+
+      switch (format) {
+        case DxsoCpuInputFormat::Float4: v.w = readUnaligned<float>(ptr + 12); // fall through
+        case DxsoCpuInputFormat::Float3: v.z = readUnaligned<float>(ptr + 8);  // fall through
+        case DxsoCpuInputFormat::Float2: v.y = readUnaligned<float>(ptr + 4);  // fall through
+        case DxsoCpuInputFormat::Float1: v.x = readUnaligned<float>(ptr);
+          break;
+        case DxsoCpuInputFormat::Color:
+          // D3DCOLOR is stored as BGRA in memory
+          v.x = float(ptr[2]) / 255.0f;
+          v.y = float(ptr[1]) / 255.0f;
+          v.z = float(ptr[0]) / 255.0f;
+          v.w = float(ptr[3]) / 255.0f;
+          break;
+        case DxsoCpuInputFormat::UByte4:
+          v = Vector4(float(ptr[0]), float(ptr[1]), float(ptr[2]), float(ptr[3]));
+          break;
+        case DxsoCpuInputFormat::UByte4N:
+          v = Vector4(float(ptr[0]) / 255.0f, float(ptr[1]) / 255.0f, float(ptr[2]) / 255.0f, float(ptr[3]) / 255.0f);
+          break;
+        case DxsoCpuInputFormat::Short4:
+          v.z = float(readUnaligned<int16_t>(ptr + 4));
+          v.w = float(readUnaligned<int16_t>(ptr + 6)); // fall through
+        case DxsoCpuInputFormat::Short2:
+          v.x = float(readUnaligned<int16_t>(ptr + 0));
+          v.y = float(readUnaligned<int16_t>(ptr + 2));
+          break;
+        case DxsoCpuInputFormat::Short4N:
+          v.z = std::max(float(readUnaligned<int16_t>(ptr + 4)) / 32767.0f, -1.0f);
+          v.w = std::max(float(readUnaligned<int16_t>(ptr + 6)) / 32767.0f, -1.0f); // fall through
+        case DxsoCpuInputFormat::Short2N:
+          v.x = std::max(float(readUnaligned<int16_t>(ptr + 0)) / 32767.0f, -1.0f);
+          v.y = std::max(float(readUnaligned<int16_t>(ptr + 2)) / 32767.0f, -1.0f);
+          break;
+        case DxsoCpuInputFormat::UShort4N:
+          v.z = float(readUnaligned<uint16_t>(ptr + 4)) / 65535.0f;
+          v.w = float(readUnaligned<uint16_t>(ptr + 6)) / 65535.0f; // fall through
+        case DxsoCpuInputFormat::UShort2N:
+          v.x = float(readUnaligned<uint16_t>(ptr + 0)) / 65535.0f;
+          v.y = float(readUnaligned<uint16_t>(ptr + 2)) / 65535.0f;
+          break;
+        case DxsoCpuInputFormat::Half4:
+          v.z = halfToFloat(readUnaligned<uint16_t>(ptr + 4));
+          v.w = halfToFloat(readUnaligned<uint16_t>(ptr + 6)); // fall through
+        case DxsoCpuInputFormat::Half2:
+          v.x = halfToFloat(readUnaligned<uint16_t>(ptr + 0));
+          v.y = halfToFloat(readUnaligned<uint16_t>(ptr + 2));
+          break;
+        default:
+          break;
+      }
+
+      return v;
+    }
+
+  }
+
+
+  struct DxsoCpuShader::Lanes {
+    Vec     temps[DxsoMaxTempRegs];
+    Vec     inputs[DxsoMaxInterfaceRegs];
+    Vec     outputs[MaxOutputs];
+    int32_t addr[4][LaneCount];
+  };
+
+
+  DxsoCpuShader::DxsoCpuShader(const DxsoProgramInfo& info, const DxsoCpuShaderOptions& options)
+    : m_info(info), m_options(options) {
+    m_outputSemantics.fill(DxsoSemantic{ DxsoUsage::Position, 0 });
+  }
+
+
+  std::shared_ptr<DxsoCpuShader> DxsoCpuShader::create(
+    const void*                 pBytecode,
+    const DxsoCpuShaderOptions& options) {
+    DxsoReader reader(reinterpret_cast<const char*>(pBytecode));
+
+    DxsoHeader header(reader);
+
+    if (header.info().type() != DxsoProgramTypes::VertexShader)
+      return nullptr;
+
+    DxsoCode code(reader);
+
+    std::shared_ptr<DxsoCpuShader> shader(new DxsoCpuShader(header.info(), options));
+
+    DxsoDecodeContext decoder(header.info());
+    DxsoCodeIter iter = code.iter();
+
+    while (decoder.decodeInstruction(iter)) {
+      if (!shader->processInstruction(decoder.getInstructionContext()))
+        return nullptr;
+    }
+
+    return shader;
+  }
+
+
+  bool DxsoCpuShader::hasInput(DxsoSemantic semantic) const {
+    return findInput(semantic) >= 0;
+  }
+
+
+  bool DxsoCpuShader::hasOutput(DxsoSemantic semantic) const {
+    return findOutput(semantic) >= 0;
+  }
+
+
+  int32_t DxsoCpuShader::findInput(DxsoSemantic semantic) const {
+    for (uint32_t i = 0; i < m_inputSemantics.size(); i++) {
+      if (m_inputSemantics[i] == semantic)
+        return int32_t(i);
+    }
+
+    return -1;
+  }
+
+
+  int32_t DxsoCpuShader::findOutput(DxsoSemantic semantic) const {
+    for (uint32_t i = 0; i < MaxOutputs; i++) {
+      if ((m_outputMask & (1u << i)) && m_outputSemantics[i] == semantic)
+        return int32_t(i);
+    }
+
+    return -1;
+  }
+
+
+  int32_t DxsoCpuShader::mapOutput(DxsoRegisterId id) const {
+    // SM3 declares its outputs, older models have fixed
+    // register files which we pack into a single array:
+    // [0..2] oPos/oFog/oPts, [3..4] oD#, [5..12] oT#
+    if (m_info.majorVersion() >= 3) {
+      if (id.type == DxsoRegisterType::Output && id.num < MaxOutputs)
+        return int32_t(id.num);
+      return -1;
+    }
+
+    switch (id.type) {
+      case DxsoRegisterType::RasterizerOut:
+        return id.num <= RasterOutPointSize ? int32_t(id.num) : -1;
+      case DxsoRegisterType::AttributeOut:
+        return id.num < 2 ? int32_t(3 + id.num) : -1;
+      case DxsoRegisterType::TexcoordOut:
+        return id.num < 8 ? int32_t(5 + id.num) : -1;
+      default:
+        return -1;
+    }
+  }
+
+
+  bool DxsoCpuShader::processDeclaration(const DxsoInstructionContext& ctx) {
+    const DxsoRegisterId id = ctx.dst.id;
+    const DxsoSemantic semantic = ctx.dcl.semantic;
+
+    if (id.type == DxsoRegisterType::Input) {
+      if (id.num >= DxsoMaxInterfaceRegs || m_inputSemantics.size() >= DxsoMaxInterfaceRegs)
+        return false;
+
+      m_inputSemantics.push_back(semantic);
+      m_inputRegisters.push_back(uint16_t(id.num));
+      return true;
+    }
+
+    if (m_info.majorVersion() >= 3 && id.type == DxsoRegisterType::Output) {
+      const int32_t slot = mapOutput(id);
+
+      if (slot < 0)
+        return false;
+
+      m_outputSemantics[slot] = semantic;
+      return true;
+    }
+
+    // Sampler declarations et al. imply texture fetches
+    return false;
+  }
+
+
+  bool DxsoCpuShader::translateSource(const DxsoRegister& reg, Operand& operand) {
+    switch (reg.modifier) {
+      case DxsoRegModifier::None:
+      case DxsoRegModifier::Neg:
+      case DxsoRegModifier::Abs:
+      case DxsoRegModifier::AbsNeg:
+        break;
+      default:
+        return false;
+    }
+
+    operand.modifier = reg.modifier;
+
+    for (uint32_t i = 0; i < 4; i++)
+      operand.swizzle[i] = uint8_t(reg.swizzle[i]);
+
+    switch (reg.id.type) {
+      case DxsoRegisterType::Temp:
+        if (reg.id.num >= DxsoMaxTempRegs)
+          return false;
+        operand.file = RegFile::Temp;
+        m_maxTempIndex = std::max(m_maxTempIndex, reg.id.num);
+        break;
+      case DxsoRegisterType::Input:
+        if (reg.id.num >= DxsoMaxInterfaceRegs)
+          return false;
+        operand.file = RegFile::Input;
+        break;
+      case DxsoRegisterType::Const:
+        operand.file = RegFile::Const;
+        m_maxConstantIndex = std::max(m_maxConstantIndex, reg.id.num);
+        break;
+      default:
+        return false;
+    }
+
+    operand.index = uint16_t(reg.id.num);
+
+    if (reg.hasRelative) {
+      // Only constants can be indexed in vertex shaders
+      // without loops, and only through a0.
+      if (operand.file != RegFile::Const || reg.relative.id.type != DxsoRegisterType::Addr)
+        return false;
+
+      operand.relative = true;
+      operand.relativeComponent = uint8_t(reg.relative.swizzle[0]);
+      m_usesRelativeConstants = true;
+    }
+
+    return true;
+  }
+
+
+  bool DxsoCpuShader::translateDestination(const DxsoRegister& reg, Destination& dst) {
+    if (reg.hasRelative || reg.shift != 0)
+      return false;
+
+    dst.saturate = reg.saturate;
+    dst.index    = uint16_t(reg.id.num);
+
+    uint8_t mask = 0;
+    for (uint32_t i = 0; i < 4; i++)
+      mask |= reg.mask[i] ? (1u << i) : 0u;
+    dst.mask = mask;
+
+    if (reg.id.type == DxsoRegisterType::Temp) {
+      if (reg.id.num >= DxsoMaxTempRegs)
+        return false;
+      dst.file = RegFile::Temp;
+      m_maxTempIndex = std::max(m_maxTempIndex, reg.id.num);
+      return true;
+    }
+
+    if (reg.id.type == DxsoRegisterType::Addr) {
+      if (reg.id.num != 0)
+        return false;
+      dst.file = RegFile::Addr;
+      return true;
+    }
+
+    const int32_t slot = mapOutput(reg.id);
+
+    if (slot < 0)
+      return false;
+
+    dst.file  = RegFile::Output;
+    dst.index = uint16_t(slot);
+
+    // Fog and point size are scalar registers
+    if (m_info.majorVersion() < 3 && reg.id.type == DxsoRegisterType::RasterizerOut && reg.id.num != RasterOutPosition)
+      dst.mask = 0x1;
+
+    if (m_info.majorVersion() < 3) {
+      static const DxsoSemantic s_rasterSemantics[] = {
+        { DxsoUsage::Position,  0 },
+        { DxsoUsage::Fog,       0 },
+        { DxsoUsage::PointSize, 0 },
+      };
+
+      if (reg.id.type == DxsoRegisterType::RasterizerOut)
+        m_outputSemantics[slot] = s_rasterSemantics[reg.id.num];
+      else if (reg.id.type == DxsoRegisterType::AttributeOut)
+        m_outputSemantics[slot] = { DxsoUsage::Color, reg.id.num };
+      else
+        m_outputSemantics[slot] = { DxsoUsage::Texcoord, reg.id.num };
+    }
+
+    m_outputMask |= 1u << slot;
+    return true;
+  }
+
+
+  bool DxsoCpuShader::processInstruction(const DxsoInstructionContext& ctx) {
+    const DxsoOpcode opcode = ctx.instruction.opcode;
+
+    if (ctx.instruction.predicated || ctx.instruction.coissue)
+      return false;
+
+    uint32_t srcCount = 0;
+
+    switch (opcode) {
+      case DxsoOpcode::Nop:
+      case DxsoOpcode::Comment:
+        return true;
+
+      case DxsoOpcode::Dcl:
+        return processDeclaration(ctx);
+
+      case DxsoOpcode::Def: {
+        const uint32_t index = ctx.dst.id.num;
+
+        if (index >= m_immediateSlots.size())
+          m_immediateSlots.resize(index + 1, -1);
+
+        m_immediateSlots[index] = int32_t(m_immediates.size());
+        m_immediates.push_back(Vector4(ctx.def.float32));
+        return true;
+      }
+
+      case DxsoOpcode::Mov:
+      case DxsoOpcode::Mova:
+      case DxsoOpcode::Rcp:
+      case DxsoOpcode::Rsq:
+      case DxsoOpcode::Exp:
+      case DxsoOpcode::ExpP:
+      case DxsoOpcode::Log:
+      case DxsoOpcode::LogP:
+      case DxsoOpcode::Lit:
+      case DxsoOpcode::Frc:
+      case DxsoOpcode::Abs:
+      case DxsoOpcode::Sgn:
+      case DxsoOpcode::Nrm:
+        srcCount = 1;
+        break;
+
+      case DxsoOpcode::SinCos:
+        // SM2 carries two extra constant operands we don't need
+        srcCount = 1;
+        break;
+
+      case DxsoOpcode::Add:
+      case DxsoOpcode::Sub:
+      case DxsoOpcode::Mul:
+      case DxsoOpcode::Dp3:
+      case DxsoOpcode::Dp4:
+      case DxsoOpcode::Min:
+      case DxsoOpcode::Max:
+      case DxsoOpcode::Slt:
+      case DxsoOpcode::Sge:
+      case DxsoOpcode::Dst:
+      case DxsoOpcode::Pow:
+      case DxsoOpcode::Crs:
+      case DxsoOpcode::M4x4:
+      case DxsoOpcode::M4x3:
+      case DxsoOpcode::M3x4:
+      case DxsoOpcode::M3x3:
+      case DxsoOpcode::M3x2:
+        srcCount = 2;
+        break;
+
+      case DxsoOpcode::Mad:
+      case DxsoOpcode::Lrp:
+        srcCount = 3;
+        break;
+
+      default:
+        // Flow control, texture ops, integer/bool constants, ...
+        return false;
+    }
+
+    Instruction instruction;
+    instruction.opcode = opcode;
+
+    if (!translateDestination(ctx.dst, instruction.dst))
+      return false;
+
+    for (uint32_t i = 0; i < srcCount; i++) {
+      if (!translateSource(ctx.src[i], instruction.src[i]))
+        return false;
+    }
+
+    m_instructions.push_back(instruction);
+    return true;
+  }
+
+
+  void DxsoCpuShader::execute(Lanes& lanes, const Vector4* pConstants, uint32_t constantCount) const {
+    const bool mulZeroIsZero = m_options.mulZeroIsZero;
+    const bool clampInfinities = m_options.clampInfinities;
+    const bool floorAddress = m_info.majorVersion() < 2 && m_info.minorVersion() < 2;
+
+    const __m128 one  = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 fltMax = _mm_set1_ps(FLT_MAX);
+
+    auto broadcast = [] (const Vector4& v, Vec& out) {
+      for (uint32_t c = 0; c < 4; c++)
+        out.c[c] = _mm_set1_ps(v[c]);
+    };
+
+    auto loadRegister = [&] (const Operand& op, uint32_t row, Vec& reg) {
+      const uint32_t index = op.index + row;
+
+      switch (op.file) {
+        case RegFile::Temp:
+          reg = lanes.temps[std::min<uint32_t>(index, DxsoMaxTempRegs - 1)];
+          return;
+        case RegFile::Input:
+          reg = lanes.inputs[std::min<uint32_t>(index, DxsoMaxInterfaceRegs - 1)];
+          return;
+        case RegFile::Const:
+          break;
+        default:
+          reg = Vec{ { zero, zero, zero, zero } };
+          return;
+      }
+
+      if (!op.relative) {
+        if (index < m_immediateSlots.size() && m_immediateSlots[index] >= 0)
+          broadcast(m_immediates[m_immediateSlots[index]], reg);
+        else if (index < constantCount)
+          broadcast(pConstants[index], reg);
+        else
+          reg = Vec{ { zero, zero, zero, zero } };
+        return;
+      }
+
+      // Relative reads go through the constant buffer only, out of
+      // bounds reads return zero just like robust buffer access.
+      alignas(16) float gathered[4][LaneCount];
+
+      for (uint32_t l = 0; l < LaneCount; l++) {
+        const int32_t i = int32_t(index) + lanes.addr[op.relativeComponent][l];
+        const bool inBounds = i >= 0 && uint32_t(i) < constantCount;
+
+        for (uint32_t c = 0; c < 4; c++)
+          gathered[c][l] = inBounds ? pConstants[i][c] : 0.0f;
+      }
+
+      for (uint32_t c = 0; c < 4; c++)
+        reg.c[c] = _mm_load_ps(gathered[c]);
+    };
+
+    auto load = [&] (const Operand& op, uint32_t row = 0) {
+      Vec reg;
+      loadRegister(op, row, reg);
+
+      Vec result;
+      for (uint32_t c = 0; c < 4; c++)
+        result.c[c] = reg.c[op.swizzle[c]];
+
+      switch (op.modifier) {
+        case DxsoRegModifier::Neg:
+          for (uint32_t c = 0; c < 4; c++)
+            result.c[c] = negate(result.c[c]);
+          break;
+        case DxsoRegModifier::Abs:
+          for (uint32_t c = 0; c < 4; c++)
+            result.c[c] = absolute(result.c[c]);
+          break;
+        case DxsoRegModifier::AbsNeg:
+          for (uint32_t c = 0; c < 4; c++)
+            result.c[c] = negate(absolute(result.c[c]));
+          break;
+        default:
+          break;
+      }
+
+      return result;
+    };
+
+    auto dot = [&] (const Vec& a, const Vec& b, uint32_t count) {
+      __m128 sum = mulOperands(a.c[0], b.c[0], mulZeroIsZero);
+      for (uint32_t c = 1; c < count; c++)
+        sum = _mm_add_ps(sum, mulOperands(a.c[c], b.c[c], mulZeroIsZero));
+      return sum;
+    };
+
+    auto splat = [] (__m128 v) {
+      return Vec{ { v, v, v, v } };
+    };
+
+    for (const Instruction& ins : m_instructions) {
+      Vec r;
+
+      switch (ins.opcode) {
+        case DxsoOpcode::Mov:
+        case DxsoOpcode::Mova:
+          r = load(ins.src[0]);
+          break;
+
+        case DxsoOpcode::Add: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_add_ps(a.c[c], b.c[c]);
+          break;
+        }
+
+        case DxsoOpcode::Sub: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_sub_ps(a.c[c], b.c[c]);
+          break;
+        }
+
+        case DxsoOpcode::Mul: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = mulOperands(a.c[c], b.c[c], mulZeroIsZero);
+          break;
+        }
+
+        case DxsoOpcode::Mad: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]), d = load(ins.src[2]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_add_ps(mulOperands(a.c[c], b.c[c], mulZeroIsZero), d.c[c]);
+          break;
+        }
+
+        case DxsoOpcode::Rcp: {
+          Vec a = load(ins.src[0]);
+          for (uint32_t c = 0; c < 4; c++) {
+            r.c[c] = _mm_div_ps(one, a.c[c]);
+            if (clampInfinities)
+              r.c[c] = _mm_min_ps(r.c[c], fltMax);
+          }
+          break;
+        }
+
+        case DxsoOpcode::Rsq: {
+          Vec a = load(ins.src[0]);
+          for (uint32_t c = 0; c < 4; c++) {
+            r.c[c] = _mm_div_ps(one, _mm_sqrt_ps(absolute(a.c[c])));
+            if (clampInfinities)
+              r.c[c] = _mm_min_ps(r.c[c], fltMax);
+          }
+          break;
+        }
+
+        case DxsoOpcode::Dp3: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          r = splat(dot(a, b, 3));
+          break;
+        }
+
+        case DxsoOpcode::Dp4: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          r = splat(dot(a, b, 4));
+          break;
+        }
+
+        case DxsoOpcode::Min: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_min_ps(a.c[c], b.c[c]);
+          break;
+        }
+
+        case DxsoOpcode::Max: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_max_ps(a.c[c], b.c[c]);
+          break;
+        }
+
+        case DxsoOpcode::Slt: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_and_ps(_mm_cmplt_ps(a.c[c], b.c[c]), one);
+          break;
+        }
+
+        case DxsoOpcode::Sge: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_and_ps(_mm_cmpge_ps(a.c[c], b.c[c]), one);
+          break;
+        }
+
+        case DxsoOpcode::ExpP:
+          if (m_info.majorVersion() < 2) {
+            const __m128 x = load(ins.src[0]).c[0];
+            const __m128 fl = perLane(x, [] (float v) { return std::floor(v); });
+            r.c[0] = perLane(fl, [] (float v) { return std::exp2(v); });
+            r.c[1] = _mm_sub_ps(x, fl);
+            r.c[2] = perLane(x, [] (float v) { return std::exp2(v); });
+            r.c[3] = one;
+            break;
+          }
+          // fall through
+        case DxsoOpcode::Exp: {
+          Vec a = load(ins.src[0]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = perLane(a.c[c], [] (float v) { return std::exp2(v); });
+          break;
+        }
+
+        case DxsoOpcode::Log:
+        case DxsoOpcode::LogP: {
+          Vec a = load(ins.src[0]);
+          for (uint32_t c = 0; c < 4; c++) {
+            r.c[c] = perLane(absolute(a.c[c]), [] (float v) { return std::log2(v); });
+            if (clampInfinities)
+              r.c[c] = _mm_max_ps(r.c[c], _mm_set1_ps(-FLT_MAX));
+          }
+          break;
+        }
+
+        case DxsoOpcode::Pow: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          const bool strictPow = m_options.strictPow;
+          for (uint32_t c = 0; c < 4; c++) {
+            r.c[c] = perLane(absolute(a.c[c]), b.c[c], [] (float x, float y) { return std::pow(x, y); });
+            if (strictPow) {
+              const __m128 exponentZero = _mm_cmpeq_ps(b.c[c], zero);
+              r.c[c] = _mm_or_ps(_mm_and_ps(exponentZero, one), _mm_andnot_ps(exponentZero, r.c[c]));
+            }
+          }
+          break;
+        }
+
+        case DxsoOpcode::Lit: {
+          Vec a = load(ins.src[0]);
+          const __m128 power = _mm_min_ps(_mm_max_ps(a.c[3], _mm_set1_ps(-127.9961f)), _mm_set1_ps(127.9961f));
+          const __m128 y = _mm_max_ps(a.c[1], zero);
+          const __m128 zTest = _mm_and_ps(_mm_cmpge_ps(a.c[0], zero), _mm_cmpge_ps(a.c[1], zero));
+          r.c[0] = one;
+          r.c[1] = _mm_max_ps(a.c[0], zero);
+          r.c[2] = _mm_and_ps(zTest, perLane(y, power, [] (float x, float p) { return std::pow(x, p); }));
+          r.c[3] = one;
+          break;
+        }
+
+        case DxsoOpcode::Dst: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          r.c[0] = one;
+          r.c[1] = mulOperands(a.c[1], b.c[1], mulZeroIsZero);
+          r.c[2] = a.c[2];
+          r.c[3] = b.c[3];
+          break;
+        }
+
+        case DxsoOpcode::Lrp: {
+          // mix(src2, src1, src0)
+          Vec t = load(ins.src[0]), a = load(ins.src[1]), b = load(ins.src[2]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_add_ps(b.c[c], _mm_mul_ps(t.c[c], _mm_sub_ps(a.c[c], b.c[c])));
+          break;
+        }
+
+        case DxsoOpcode::Frc: {
+          Vec a = load(ins.src[0]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_sub_ps(a.c[c], perLane(a.c[c], [] (float v) { return std::floor(v); }));
+          break;
+        }
+
+        case DxsoOpcode::Abs: {
+          Vec a = load(ins.src[0]);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = absolute(a.c[c]);
+          break;
+        }
+
+        case DxsoOpcode::Sgn: {
+          Vec a = load(ins.src[0]);
+          for (uint32_t c = 0; c < 4; c++) {
+            const __m128 pos = _mm_and_ps(_mm_cmpgt_ps(a.c[c], zero), one);
+            const __m128 neg = _mm_and_ps(_mm_cmplt_ps(a.c[c], zero), one);
+            r.c[c] = _mm_sub_ps(pos, neg);
+          }
+          break;
+        }
+
+        case DxsoOpcode::Crs: {
+          Vec a = load(ins.src[0]), b = load(ins.src[1]);
+          r.c[0] = _mm_sub_ps(mulOperands(a.c[1], b.c[2], mulZeroIsZero), mulOperands(a.c[2], b.c[1], mulZeroIsZero));
+          r.c[1] = _mm_sub_ps(mulOperands(a.c[2], b.c[0], mulZeroIsZero), mulOperands(a.c[0], b.c[2], mulZeroIsZero));
+          r.c[2] = _mm_sub_ps(mulOperands(a.c[0], b.c[1], mulZeroIsZero), mulOperands(a.c[1], b.c[0], mulZeroIsZero));
+          r.c[3] = zero;
+          break;
+        }
+
+        case DxsoOpcode::Nrm: {
+          Vec a = load(ins.src[0]);
+          __m128 scale = _mm_div_ps(one, _mm_sqrt_ps(dot(a, a, 3)));
+          if (clampInfinities)
+            scale = _mm_min_ps(scale, fltMax);
+          for (uint32_t c = 0; c < 4; c++)
+            r.c[c] = _mm_mul_ps(a.c[c], scale);
+          break;
+        }
+
+        case DxsoOpcode::SinCos: {
+          const __m128 x = load(ins.src[0]).c[0];
+          r.c[0] = perLane(x, [] (float v) { return std::cos(v); });
+          r.c[1] = perLane(x, [] (float v) { return std::sin(v); });
+          r.c[2] = zero;
+          r.c[3] = zero;
+          break;
+        }
+
+        case DxsoOpcode::M4x4:
+        case DxsoOpcode::M4x3:
+        case DxsoOpcode::M3x4:
+        case DxsoOpcode::M3x3:
+        case DxsoOpcode::M3x2: {
+          const uint32_t dotCount = (ins.opcode == DxsoOpcode::M4x4 || ins.opcode == DxsoOpcode::M4x3) ? 4 : 3;
+          const uint32_t componentCount =
+            (ins.opcode == DxsoOpcode::M4x4 || ins.opcode == DxsoOpcode::M3x4) ? 4 :
+            (ins.opcode == DxsoOpcode::M3x2) ? 2 : 3;
+
+          Vec a = load(ins.src[0]);
+
+          // The n-th enabled component receives the n-th row
+          uint32_t row = 0;
+          for (uint32_t c = 0; c < 4; c++) {
+            r.c[c] = zero;
+
+            if ((ins.dst.mask & (1u << c)) && row < componentCount)
+              r.c[c] = dot(a, load(ins.src[1], row++), dotCount);
+          }
+          break;
+        }
+
+        default:
+          continue;
+      }
+
+      const Destination& dst = ins.dst;
+
+      if (dst.file == RegFile::Addr) {
+        for (uint32_t c = 0; c < 4; c++) {
+          if (!(dst.mask & (1u << c)))
+            continue;
+
+          alignas(16) float values[LaneCount];
+          _mm_store_ps(values, r.c[c]);
+
+          for (uint32_t l = 0; l < LaneCount; l++)
+            lanes.addr[c][l] = int32_t(floorAddress ? std::floor(values[l]) : std::round(values[l]));
+        }
+        continue;
+      }
+
+      Vec& target = dst.file == RegFile::Output
+        ? lanes.outputs[dst.index]
+        : lanes.temps[dst.index];
+
+      for (uint32_t c = 0; c < 4; c++) {
+        if (dst.mask & (1u << c))
+          target.c[c] = dst.saturate ? saturate(r.c[c]) : r.c[c];
+      }
+    }
+  }
+
+
+  void DxsoCpuShader::evaluate(
+          uint32_t             vertexCount,
+    const DxsoCpuInputStream*  pInputs,
+    const Vector4*             pConstants,
+          uint32_t             constantCount,
+    const DxsoCpuOutputStream* pOutputs,
+          uint32_t             outputCount) const {
+    // Resolve output destinations to register slots once
+    std::array<int32_t, MaxOutputs> sources;
+
+    outputCount = std::min(outputCount, MaxOutputs);
+
+    for (uint32_t o = 0; o < outputCount; o++) {
+      sources[o] = pOutputs[o].fromInput
+        ? findInput(pOutputs[o].semantic)
+        : findOutput(pOutputs[o].semantic);
+    }
+
+    Lanes lanes;
+
+    const Vec zeroVec = { { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() } };
+
+    for (uint32_t base = 0; base < vertexCount; base += LaneCount) {
+      const uint32_t count = std::min(LaneCount, vertexCount - base);
+
+      for (uint32_t t = 0; t <= m_maxTempIndex; t++)
+        lanes.temps[t] = zeroVec;
+
+      for (uint32_t o = 0; o < MaxOutputs; o++)
+        lanes.outputs[o] = zeroVec;
+
+      std::memset(lanes.addr, 0, sizeof(lanes.addr));
+
+      // Fetch and transpose inputs. Unused lanes replicate the
+      // last vertex so that they never read past the streams.
+      for (uint32_t i = 0; i < m_inputRegisters.size(); i++) {
+        const DxsoCpuInputStream& stream = pInputs[i];
+
+        alignas(16) Vector4 v[LaneCount];
+        for (uint32_t l = 0; l < LaneCount; l++) {
+          const uint32_t vertex = base + std::min(l, count - 1);
+          v[l] = fetchAttribute(stream.data + size_t(vertex) * stream.stride, stream.format);
+        }
+
+        Vec& reg = lanes.inputs[m_inputRegisters[i]];
+        reg.c[0] = _mm_loadu_ps(v[0].data);
+        reg.c[1] = _mm_loadu_ps(v[1].data);
+        reg.c[2] = _mm_loadu_ps(v[2].data);
+        reg.c[3] = _mm_loadu_ps(v[3].data);
+        _MM_TRANSPOSE4_PS(reg.c[0], reg.c[1], reg.c[2], reg.c[3]);
+      }
+
+      execute(lanes, pConstants, constantCount);
+
+      for (uint32_t o = 0; o < outputCount; o++) {
+        const DxsoCpuOutputStream& stream = pOutputs[o];
+
+        Vec reg = zeroVec;
+        if (sources[o] >= 0) {
+          reg = stream.fromInput
+            ? lanes.inputs[m_inputRegisters[sources[o]]]
+            : lanes.outputs[sources[o]];
+        }
+
+        _MM_TRANSPOSE4_PS(reg.c[0], reg.c[1], reg.c[2], reg.c[3]);
+
+        uint8_t* dst = reinterpret_cast<uint8_t*>(stream.data) + size_t(base) * stream.stride;
+        for (uint32_t l = 0; l < count; l++)
+          _mm_storeu_ps(reinterpret_cast<float*>(dst + size_t(l) * stream.stride), reg.c[l]);
+      }
+    }
+  }
+
+
+  static uint32_t packCapturedColor(const Vector4& color) {
+    // Matches the UNORM conversion in DxsoCompiler::emitVertexCaptureOp
+    auto toUnorm8 = [](float value) -> uint32_t {
+      return uint32_t(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return (toUnorm8(color.w) << 24) | (toUnorm8(color.x) << 16) | (toUnorm8(color.y) << 8) | toUnorm8(color.z);
+  }
+
+  void DxsoCpuShader::captureVertices(
+          uint32_t                  vertexCount,
+    const DxsoCpuInputStream*       pInputs,
+    const Vector4*                  pConstants,
+          uint32_t                  constantCount,
+    const D3D9RtxVertexCaptureData& transforms,
+          CapturedVertex*           pVertices) const {
+    const bool hasTexcoord = hasOutput({ DxsoUsage::Texcoord, 0 });
+    const bool hasColor = hasOutput({ DxsoUsage::Color, 0 });
+    const bool hasOutputNormal = hasOutput({ DxsoUsage::Normal, 0 });
+    const bool hasNormal = hasOutputNormal || hasInput({ DxsoUsage::Normal, 0 });
+
+    constexpr uint32_t kBatchSize = 64;
+    Vector4 position[kBatchSize];
+    Vector4 texcoord[kBatchSize];
+    Vector4 normal[kBatchSize];
+    Vector4 color[kBatchSize];
+
+    uint32_t outputCount = 0;
+    DxsoCpuOutputStream outputs[4];
+    outputs[outputCount++] = { { DxsoUsage::Position, 0 }, false, position };
+    if (hasTexcoord)
+      outputs[outputCount++] = { { DxsoUsage::Texcoord, 0 }, false, texcoord };
+    if (hasNormal)
+      outputs[outputCount++] = { { DxsoUsage::Normal, 0 }, !hasOutputNormal, normal };
+    if (hasColor)
+      outputs[outputCount++] = { { DxsoUsage::Color, 0 }, false, color };
+
+    const uint32_t inputCount = uint32_t(m_inputSemantics.size());
+    std::array<DxsoCpuInputStream, DxsoMaxInterfaceRegs> batchInputs;
+
+    for (uint32_t first = 0; first < vertexCount; first += kBatchSize) {
+      const uint32_t count = std::min(kBatchSize, vertexCount - first);
+
+      for (uint32_t i = 0; i < inputCount; i++) {
+        batchInputs[i] = pInputs[i];
+        batchInputs[i].data += size_t(pInputs[i].stride) * first;
+      }
+
+      evaluate(count, batchInputs.data(), pConstants, constantCount, outputs, outputCount);
+
+      // Same transform chain as DxsoCompiler::emitVertexCaptureOp, clip space back to object space
+      for (uint32_t j = 0; j < count; j++) {
+        CapturedVertex& vertex = pVertices[first + j];
+
+        const Vector4 view = transforms.invProj * position[j];
+        const Vector4 world = transforms.viewToWorld * Vector4(view.xyz(), 1.0f);
+        const Vector4 object = transforms.worldToObject * Vector4(world.xyz(), 1.0f);
+
+        vertex.position = object.xyz();
+        vertex.pad0 = 0;
+        vertex.texcoord0 = hasTexcoord ? Vector2(texcoord[j].x, texcoord[j].y) : Vector2(0.0f, 0.0f);
+        vertex.pad1 = 0;
+        vertex.pad2 = 0;
+
+        if (hasNormal) {
+          const Vector3& n = normal[j].xyz();
+          vertex.normal0 = Vector3(dot(transforms.normalTransform[0].xyz(), n),
+                                   dot(transforms.normalTransform[1].xyz(), n),
+                                   dot(transforms.normalTransform[2].xyz(), n));
+        } else {
+          vertex.normal0 = Vector3(0.0f);
+        }
+
+        vertex.color0 = hasColor ? packCapturedColor(color[j]) : 0xFFFFFFFF;
+      }
+    }
+  }
+
+}
@@ -0,0 +1,269 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include "dxso_decoder.h"
+
+#include "../d3d9/d3d9_rtx_vertex_capture.h"
+#include "../util/util_vector.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace dxvk {
+
+  /**
+   * \brief Vertex attribute formats understood by the CPU evaluator
+   *
+   * Mirrors the subset of D3DDECLTYPE that can be fetched without
+   * any format conversion tables. Anything else makes the draw
+   * fall back to GPU vertex capture.
+   */
+  enum class DxsoCpuInputFormat : uint32_t {
+    Float1,
+    Float2,
+    Float3,
+    Float4,
+    Color,    // D3DCOLOR, BGRA8 UNORM
+    UByte4,
+    UByte4N,
+    Short2,
+    Short4,
+    Short2N,
+    Short4N,
+    UShort2N,
+    UShort4N,
+    Half2,
+    Half4,
+    Unsupported
+  };
+
+  /**
+   * \brief Vertex attribute source
+   *
+   * One per shader input, in the order returned
+   * by \ref DxsoCpuShader::inputs. The pointer
+   * addresses the attribute of the first vertex.
+   */
+  struct DxsoCpuInputStream {
+    const uint8_t*     data   = nullptr;
+    uint32_t           stride = 0;
+    DxsoCpuInputFormat format = DxsoCpuInputFormat::Unsupported;
+  };
+
+  /**
+   * \brief Evaluated attribute destination
+   *
+   * Receives a float4 per vertex for the output register declared
+   * with the given semantic. If \c fromInput is set, the value of
+   * the matching input register is written instead, which is used
+   * to pass through attributes the shader does not output itself.
+   */
+  struct DxsoCpuOutputStream {
+    DxsoSemantic semantic  = { DxsoUsage::Position, 0 };
+    bool         fromInput = false;
+    Vector4*     data      = nullptr;
+    uint32_t     stride    = sizeof(Vector4);
+  };
+
+  struct DxsoCpuShaderOptions {
+    /// Zero the product whenever either multiply operand is zero (D3D9FloatEmulation::Strict)
+    bool mulZeroIsZero   = false;
+    /// Clamp infinities produced by rcp/rsq/nrm/log (D3D9FloatEmulation::Enabled)
+    bool clampInfinities = false;
+    /// pow(x, 0) always returns 1
+    bool strictPow       = false;
+  };
+
+  /**
+   * \brief CPU evaluator for straight-line DXSO vertex shaders
+   *
+   * Decodes the shader once into a compact instruction list and
+   * interprets it four vertices at a time using SSE registers in
+   * SoA layout. Only shaders without flow control, predication,
+   * texture fetches or integer/bool constants are accepted, which
+   * covers the bulk of legacy transform and skinning shaders.
+   *
+   * Results match the SPIR-V generated by \ref DxsoCompiler for
+   * the same float emulation settings, so the evaluator can stand
+   * in for GPU vertex capture on small draws.
+   */
+  class DxsoCpuShader {
+
+  public:
+
+    /**
+     * \brief Builds the CPU program for a shader
+     *
+     * \param [in] pBytecode DXSO token stream, starting at the version token
+     * \param [in] options Float behaviour to mirror
+     * \returns The program, or \c nullptr if the shader uses
+     *          features the evaluator does not implement
+     */
+    static std::shared_ptr<DxsoCpuShader> create(
+      const void*                 pBytecode,
+      const DxsoCpuShaderOptions& options);
+
+    /**
+     * \brief Declared input semantics
+     *
+     * One \ref DxsoCpuInputStream must be provided
+     * per entry when calling \ref evaluate.
+     */
+    const std::vector<DxsoSemantic>& inputs() const {
+      return m_inputSemantics;
+    }
+
+    const DxsoCpuShaderOptions& options() const {
+      return m_options;
+    }
+
+    bool hasInput(DxsoSemantic semantic) const;
+
+    bool hasOutput(DxsoSemantic semantic) const;
+
+    /**
+     * \brief Number of float constants the shader may read
+     *
+     * Relative addressing makes the whole constant file
+     * reachable, in which case this returns \c UINT32_MAX.
+     */
+    uint32_t maxConstantIndex() const {
+      return m_usesRelativeConstants ? UINT32_MAX : m_maxConstantIndex;
+    }
+
+    /**
+     * \brief Runs the shader over a range of vertices
+     *
+     * \param [in] vertexCount Number of vertices to process
+     * \param [in] pInputs One stream per entry in \ref inputs
+     * \param [in] pConstants Float constant registers
+     * \param [in] constantCount Number of valid constant registers
+     * \param [in] pOutputs Destinations to fill
+     * \param [in] outputCount Number of destinations
+     */
+    void evaluate(
+            uint32_t             vertexCount,
+      const DxsoCpuInputStream*  pInputs,
+      const Vector4*             pConstants,
+            uint32_t             constantCount,
+      const DxsoCpuOutputStream* pOutputs,
+            uint32_t             outputCount) const;
+
+    /**
+     * \brief Vertex captures a range of vertices
+     *
+     * Evaluates the shader and converts the results to the
+     * layout and space the capture code injected into the
+     * GPU shader produces, see \ref DxsoCompiler.
+     *
+     * \param [in] vertexCount Number of vertices to process
+     * \param [in] pInputs One stream per entry in \ref inputs
+     * \param [in] pConstants Float constant registers
+     * \param [in] constantCount Number of valid constant registers
+     * \param [in] transforms Vertex capture constants of the draw
+     * \param [out] pVertices Receives \c vertexCount vertices
+     */
+    void captureVertices(
+            uint32_t                  vertexCount,
+      const DxsoCpuInputStream*       pInputs,
+      const Vector4*                  pConstants,
+            uint32_t                  constantCount,
+      const D3D9RtxVertexCaptureData& transforms,
+            CapturedVertex*           pVertices) const;
+
+  private:
+
+    enum class RegFile : uint8_t {
+      Temp,
+      Input,
+      Const,
+      Immediate,
+      Addr,
+      Output,
+    };
+
+    struct Operand {
+      RegFile         file      = RegFile::Temp;
+      uint16_t        index     = 0;
+      uint8_t         swizzle[4] = { 0, 1, 2, 3 };
+      DxsoRegModifier modifier  = DxsoRegModifier::None;
+      bool            relative  = false;
+      uint8_t         relativeComponent = 0;
+    };
+
+    struct Destination {
+      RegFile  file     = RegFile::Temp;
+      uint16_t index    = 0;
+      uint8_t  mask     = 0xf;
+      bool     saturate = false;
+    };
+
+    struct Instruction {
+      DxsoOpcode             opcode;
+      Destination            dst;
+      std::array<Operand, 3> src;
+    };
+
+    struct Lanes;
+
+    static constexpr uint32_t MaxOutputs = 16;
+
+    DxsoCpuShader(const DxsoProgramInfo& info, const DxsoCpuShaderOptions& options);
+
+    bool processInstruction(const DxsoInstructionContext& ctx);
+
+    bool processDeclaration(const DxsoInstructionContext& ctx);
+
+    bool translateSource(const DxsoRegister& reg, Operand& operand);
+
+    bool translateDestination(const DxsoRegister& reg, Destination& dst);
+
+    int32_t mapOutput(DxsoRegisterId id) const;
+
+    int32_t findInput(DxsoSemantic semantic) const;
+
+    int32_t findOutput(DxsoSemantic semantic) const;
+
+    void execute(Lanes& lanes, const Vector4* pConstants, uint32_t constantCount) const;
+
+    DxsoProgramInfo             m_info;
+    DxsoCpuShaderOptions        m_options;
+
+    std::vector<Instruction>    m_instructions;
+    std::vector<Vector4>        m_immediates;
+    std::vector<int32_t>        m_immediateSlots;
+
+    std::vector<DxsoSemantic>   m_inputSemantics;
+    std::vector<uint16_t>       m_inputRegisters;
+
+    std::array<DxsoSemantic, MaxOutputs> m_outputSemantics;
+    uint32_t                    m_outputMask = 0;
+
+    uint32_t                    m_maxTempIndex = 0;
+    uint32_t                    m_maxConstantIndex = 0;
+    bool                        m_usesRelativeConstants = false;
+
+  };
+
+}
@@ -0,0 +1,186 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <fstream>
+
+#include "dxso_binary_io.h"
+#include "dxso_cpu_fixture.h"
+
+#include "../util/log/log.h"
+#include "../util/util_string.h"
+#include "../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+  struct DxsoVertexCaptureFixtureHeader {
+    char         magic[4]      = { 'D', 'X', 'V', 'C' };
+    uint32_t     formatVersion = 1;
+    XXH64_hash_t checksum      = 0; // Of everything after the header
+  };
+
+  static_assert(sizeof(DxsoVertexCaptureFixtureHeader) == 16);
+
+  // Fixtures are recorded from small draws, anything larger is treated as corruption
+  constexpr size_t MaxFixtureSize = 256 << 20;
+
+
+  static uint32_t getInputFormatSize(DxsoCpuInputFormat format) {
+    switch (format) {
+      case DxsoCpuInputFormat::Float1:   return 4;
+      case DxsoCpuInputFormat::Float2:   return 8;
+      case DxsoCpuInputFormat::Float3:   return 12;
+      case DxsoCpuInputFormat::Float4:   return 16;
+      case DxsoCpuInputFormat::Color:
+      case DxsoCpuInputFormat::UByte4:
+      case DxsoCpuInputFormat::UByte4N:
+      case DxsoCpuInputFormat::Short2:
+      case DxsoCpuInputFormat::Short2N:
+      case DxsoCpuInputFormat::UShort2N:
+      case DxsoCpuInputFormat::Half2:    return 4;
+      case DxsoCpuInputFormat::Short4:
+      case DxsoCpuInputFormat::Short4N:
+      case DxsoCpuInputFormat::UShort4N:
+      case DxsoCpuInputFormat::Half4:    return 8;
+      default:                           return 0;
+    }
+  }
+
+
+  bool DxsoVertexCaptureFixture::getInputStreams(std::vector<DxsoCpuInputStream>& streams) const {
+    streams.clear();
+
+    for (const Input& input : inputs) {
+      const uint32_t size = getInputFormatSize(input.format);
+      const uint64_t end = uint64_t(input.offset) + uint64_t(input.stride) * (vertexCount() > 0 ? vertexCount() - 1 : 0) + size;
+
+      if (size == 0 || end > vertexData.size())
+        return false;
+
+      streams.push_back({ vertexData.data() + input.offset, input.stride, input.format });
+    }
+
+    return true;
+  }
+
+
+  bool DxsoVertexCaptureFixture::save(const std::string& filePath) const {
+    std::vector<uint8_t> file;
+    serialize(*this, file);
+
+    std::ofstream stream(str::tows(filePath.c_str()).c_str(), std::ios_base::binary | std::ios_base::trunc);
+    stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+
+    if (!stream) {
+      Logger::err(str::format("DXSO: Failed to write vertex capture fixture ", filePath));
+      return false;
+    }
+
+    return true;
+  }
+
+
+  bool DxsoVertexCaptureFixture::load(const std::string& filePath) {
+    std::ifstream stream(str::tows(filePath.c_str()).c_str(), std::ios_base::binary | std::ios_base::ate);
+
+    if (!stream) {
+      Logger::err(str::format("DXSO: Failed to open vertex capture fixture ", filePath));
+      return false;
+    }
+
+    const size_t size = size_t(stream.tellg());
+
+    std::vector<uint8_t> file(std::min(size, MaxFixtureSize));
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(file.data()), file.size());
+
+    if (!stream || size > MaxFixtureSize || !deserialize(file, *this)) {
+      Logger::err(str::format("DXSO: ", filePath, " is not a valid vertex capture fixture"));
+      return false;
+    }
+
+    return true;
+  }
+
+
+  void DxsoVertexCaptureFixture::serialize(const DxsoVertexCaptureFixture& fixture, std::vector<uint8_t>& file) {
+    file.resize(sizeof(DxsoVertexCaptureFixtureHeader));
+
+    DxsoBinaryWriter writer(file);
+    writer.writeArray(fixture.bytecode);
+    writer.write(uint8_t(fixture.options.mulZeroIsZero));
+    writer.write(uint8_t(fixture.options.clampInfinities));
+    writer.write(uint8_t(fixture.options.strictPow));
+    writer.writeArray(fixture.inputs);
+    writer.writeArray(fixture.vertexData);
+    writer.writeArray(fixture.constants);
+    writer.write(fixture.transforms);
+    writer.writeArray(fixture.capturedVertices);
+
+    DxsoVertexCaptureFixtureHeader header;
+    header.checksum = XXH3_64bits(file.data() + sizeof(header), file.size() - sizeof(header));
+    std::memcpy(file.data(), &header, sizeof(header));
+  }
+
+
+  bool DxsoVertexCaptureFixture::deserialize(const std::vector<uint8_t>& file, DxsoVertexCaptureFixture& fixture) {
+    fixture = DxsoVertexCaptureFixture();
+
+    const DxsoVertexCaptureFixtureHeader expected;
+    DxsoVertexCaptureFixtureHeader header;
+
+    if (file.size() < sizeof(header))
+      return false;
+
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic))
+     || header.formatVersion != expected.formatVersion
+     || header.checksum != XXH3_64bits(file.data() + sizeof(header), file.size() - sizeof(header)))
+      return false;
+
+    const std::vector<uint8_t> payload(file.begin() + sizeof(header), file.end());
+    DxsoBinaryReader reader(payload);
+
+    uint8_t mulZeroIsZero = 0;
+    uint8_t clampInfinities = 0;
+    uint8_t strictPow = 0;
+
+    if (!reader.readArray(fixture.bytecode)
+     || !reader.read(mulZeroIsZero)
+     || !reader.read(clampInfinities)
+     || !reader.read(strictPow)
+     || !reader.readArray(fixture.inputs)
+     || !reader.readArray(fixture.vertexData)
+     || !reader.readArray(fixture.constants)
+     || !reader.read(fixture.transforms)
+     || !reader.readArray(fixture.capturedVertices)
+     || !reader.eof())
+      return false;
+
+    fixture.options.mulZeroIsZero = mulZeroIsZero != 0;
+    fixture.options.clampInfinities = clampInfinities != 0;
+    fixture.options.strictPow = strictPow != 0;
+
+    std::vector<DxsoCpuInputStream> streams;
+    return fixture.getInputStreams(streams);
+  }
+
+}
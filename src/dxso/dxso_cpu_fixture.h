@@ -0,0 +1,84 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "dxso_cpu_evaluator.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Vertex shader draw captured on the GPU
+   *
+   * Everything the CPU evaluator needs to vertex capture the
+   * same draw again, along with the vertices GPU vertex capture
+   * wrote for it. Recorded by the D3D9 frontend while
+   * \c rtx.vertexCaptureFixturePath is set, and replayed by
+   * the unit tests to check the CPU path against the GPU one.
+   */
+  struct DxsoVertexCaptureFixture {
+    /// Vertices are captured into memory filled with this pattern,
+    /// members the GPU did not write to keep it. This is the case
+    /// for vertices the draw doesn't reference and for normals of
+    /// shaders without a normal output.
+    static constexpr uint32_t UnwrittenPattern = 0xFFFFFFFFu;
+
+    struct Input {
+      uint32_t           offset = 0; // Of the first vertex in vertexData
+      uint32_t           stride = 0;
+      DxsoCpuInputFormat format = DxsoCpuInputFormat::Unsupported;
+    };
+
+    std::vector<uint8_t>        bytecode;
+    DxsoCpuShaderOptions        options;
+    std::vector<Input>          inputs;   // One per shader input
+    std::vector<uint8_t>        vertexData;
+    std::vector<Vector4>        constants;
+    D3D9RtxVertexCaptureData    transforms = { };
+    std::vector<CapturedVertex> capturedVertices;
+
+    uint32_t vertexCount() const {
+      return uint32_t(capturedVertices.size());
+    }
+
+    /**
+     * \brief Input streams addressing \c vertexData
+     *
+     * Fails if an input reads past the end of the
+     * vertex data, which is checked when loading.
+     */
+    bool getInputStreams(std::vector<DxsoCpuInputStream>& streams) const;
+
+    bool save(const std::string& filePath) const;
+
+    bool load(const std::string& filePath);
+
+    // File contents, exposed for testing
+    static void serialize(const DxsoVertexCaptureFixture& fixture, std::vector<uint8_t>& file);
+
+    // Fails if the data is damaged or from a different format version
+    static bool deserialize(const std::vector<uint8_t>& file, DxsoVertexCaptureFixture& fixture);
+  };
+
+}
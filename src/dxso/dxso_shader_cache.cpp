@@ -0,0 +1,380 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <fstream>
+
+#include "dxso_binary_io.h"
+#include "dxso_shader_cache.h"
+
+#include "../util/log/log.h"
+#include "../util/util_env.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+
+  struct DxsoShaderCacheHeader {
+    char     magic[4]      = { 'D', 'X', 'S', 'O' };
+    uint32_t formatVersion = 2;
+    uint64_t versionStamp  = 0;
+  };
+
+  static_assert(sizeof(DxsoShaderCacheHeader) == 16);
+
+  struct DxsoShaderCacheEntryHeader {
+    XXH64_hash_t key      = 0;
+    XXH64_hash_t checksum = 0;
+    uint32_t     size     = 0;
+    uint32_t     reserved = 0;
+  };
+
+  static_assert(sizeof(DxsoShaderCacheEntryHeader) == 24);
+
+  // Entries larger than this are treated as corruption
+  constexpr uint32_t MaxEntrySize = 16 << 20;
+
+
+  DxsoShaderCache::DxsoShaderCache(
+          std::string   filePath,
+          uint64_t      versionStamp)
+  : m_filePath    (std::move(filePath)),
+    m_versionStamp(versionStamp),
+    m_thread      ([this] () { threadFunc(); }) {
+  }
+
+
+  DxsoShaderCache::~DxsoShaderCache() {
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_stopThread = true;
+    }
+
+    m_cond.notify_all();
+    m_thread.join();
+  }
+
+
+  bool DxsoShaderCache::lookup(
+          XXH64_hash_t      key,
+          DxsoCachedModule& module) {
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    m_cond.wait(lock, [this] () {
+      return m_prefetched;
+    });
+
+    auto entry = m_entries.find(key);
+
+    if (entry == m_entries.end())
+      return false;
+
+    if (!deserialize(entry->second, module)) {
+      m_entries.erase(entry);
+      return false;
+    }
+
+    return true;
+  }
+
+
+  void DxsoShaderCache::insert(
+          XXH64_hash_t            key,
+    const DxsoCachedModule&       module) {
+    Entry entry = serialize(module);
+
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+      if (!m_entries.insert({ key, std::move(entry) }).second)
+        return;
+
+      m_writerQueue.push(key);
+    }
+
+    m_cond.notify_all();
+  }
+
+
+  std::vector<std::pair<XXH64_hash_t, std::vector<uint8_t>>> DxsoShaderCache::getStoredInputs() {
+    std::vector<std::pair<XXH64_hash_t, std::vector<uint8_t>>> result;
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    m_cond.wait(lock, [this] () {
+      return m_prefetched;
+    });
+
+    for (const auto& entry : m_entries) {
+      // Inputs come first, so the rest of the entry does not need to be parsed
+      DxsoBinaryReader reader(entry.second);
+      std::vector<uint8_t> inputs;
+
+      if (reader.readArray(inputs) && !inputs.empty())
+        result.emplace_back(entry.first, std::move(inputs));
+    }
+
+    return result;
+  }
+
+
+  std::string DxsoShaderCache::getDefaultFilePath() {
+    std::string path = env::getEnvVar("DXVK_STATE_CACHE_PATH");
+
+    if (!path.empty() && *path.rbegin() != '/')
+      path += '/';
+
+    return path + env::getExeBaseName() + ".dxso-cache";
+  }
+
+
+  void DxsoShaderCache::threadFunc() {
+    env::setThreadName("dxso-cache");
+
+    const bool upToDate = readCacheFile();
+
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_prefetched = true;
+    }
+
+    m_cond.notify_all();
+
+    // Outdated or damaged files are rewritten from whatever could be loaded
+    if (!upToDate)
+      writeCacheFile();
+
+    std::ofstream file;
+
+    while (true) {
+      XXH64_hash_t key;
+      Entry entry;
+
+      { std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+        m_cond.wait(lock, [this] () {
+          return !m_writerQueue.empty() || m_stopThread;
+        });
+
+        if (m_writerQueue.empty())
+          break;
+
+        key = m_writerQueue.front();
+        m_writerQueue.pop();
+
+        entry = m_entries[key];
+      }
+
+      if (!file.is_open()) {
+        file = std::ofstream(str::tows(m_filePath.c_str()).c_str(),
+          std::ios_base::binary | std::ios_base::app);
+      }
+
+      DxsoShaderCacheEntryHeader header;
+      header.key      = key;
+      header.checksum = XXH3_64bits(entry.data(), entry.size());
+      header.size     = uint32_t(entry.size());
+
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      file.write(reinterpret_cast<const char*>(entry.data()), entry.size());
+    }
+  }
+
+
+  bool DxsoShaderCache::readCacheFile() {
+    std::ifstream file(str::tows(m_filePath.c_str()).c_str(), std::ios_base::binary);
+
+    if (!file)
+      return false;
+
+    DxsoShaderCacheHeader expected;
+    expected.versionStamp = m_versionStamp;
+
+    DxsoShaderCacheHeader header;
+
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+     || std::memcmp(header.magic, expected.magic, sizeof(header.magic))
+     || header.formatVersion != expected.formatVersion
+     || header.versionStamp  != expected.versionStamp) {
+      Logger::info("DXSO: Shader cache version changed, discarding");
+      return false;
+    }
+
+    uint32_t numEntries = 0;
+    bool     valid      = true;
+
+    while (true) {
+      DxsoShaderCacheEntryHeader entryHeader;
+
+      if (!file.read(reinterpret_cast<char*>(&entryHeader), sizeof(entryHeader))) {
+        // A partial header means the file was cut off while writing
+        valid = file.gcount() == 0;
+        break;
+      }
+
+      Entry entry;
+
+      if (entryHeader.size <= MaxEntrySize) {
+        entry.resize(entryHeader.size);
+        file.read(reinterpret_cast<char*>(entry.data()), entry.size());
+      }
+
+      if (!file || entryHeader.size > MaxEntrySize
+       || XXH3_64bits(entry.data(), entry.size()) != entryHeader.checksum) {
+        valid = false;
+        break;
+      }
+
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+      if (m_entries.insert({ entryHeader.key, std::move(entry) }).second)
+        numEntries += 1;
+    }
+
+    if (!valid)
+      Logger::warn("DXSO: Shader cache file is damaged, rewriting");
+
+    Logger::info(str::format("DXSO: Read ", numEntries, " shaders from cache"));
+    return valid;
+  }
+
+
+  void DxsoShaderCache::writeCacheFile() {
+    std::ofstream file(str::tows(m_filePath.c_str()).c_str(),
+      std::ios_base::binary | std::ios_base::trunc);
+
+    if (!file) {
+      const size_t separator = m_filePath.find_last_of("/\\");
+
+      if (separator != std::string::npos && env::createDirectory(m_filePath.substr(0, separator))) {
+        file = std::ofstream(str::tows(m_filePath.c_str()).c_str(),
+          std::ios_base::binary | std::ios_base::trunc);
+      }
+    }
+
+    if (!file) {
+      Logger::warn(str::format("DXSO: Failed to create shader cache file ", m_filePath));
+      return;
+    }
+
+    DxsoShaderCacheHeader header;
+    header.versionStamp = m_versionStamp;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Everything in memory goes into the new file, including entries
+    // that were queued up while the old file was being read
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    m_writerQueue = { };
+
+    for (const auto& entry : m_entries) {
+      DxsoShaderCacheEntryHeader entryHeader;
+      entryHeader.key      = entry.first;
+      entryHeader.checksum = XXH3_64bits(entry.second.data(), entry.second.size());
+      entryHeader.size     = uint32_t(entry.second.size());
+
+      file.write(reinterpret_cast<const char*>(&entryHeader), sizeof(entryHeader));
+      file.write(reinterpret_cast<const char*>(entry.second.data()), entry.second.size());
+    }
+  }
+
+
+  DxsoShaderCache::Entry DxsoShaderCache::serialize(const DxsoCachedModule& module) {
+    Entry entry;
+    DxsoBinaryWriter writer(entry);
+
+    writer.writeArray(module.inputs);
+    writer.write(module.isgn);
+    writer.write(module.osgn);
+    writer.write(module.meta);
+    writer.writeArray(module.constants);
+    writer.write(module.maxDefinedConst);
+    writer.write(module.usedSamplers);
+    writer.write(module.usedRTs);
+
+    writer.write(uint32_t(module.shaders.size()));
+
+    for (const auto& shader : module.shaders) {
+      writer.write(uint8_t(shader.has_value()));
+
+      if (!shader)
+        continue;
+
+      // SPIR-V is stored in its compressed form as-is
+      writer.write(shader->stage);
+      writer.writeArray(shader->slots);
+      writer.write(shader->interfaceSlots);
+      writer.write(shader->code.getSize());
+      writer.writeArray(shader->code.getMask());
+      writer.writeArray(shader->code.getCode());
+    }
+
+    return entry;
+  }
+
+
+  bool DxsoShaderCache::deserialize(const Entry& entry, DxsoCachedModule& module) {
+    DxsoBinaryReader reader(entry);
+
+    uint32_t shaderCount = 0;
+
+    if (!reader.readArray(module.inputs)
+     || !reader.read(module.isgn)
+     || !reader.read(module.osgn)
+     || !reader.read(module.meta)
+     || !reader.readArray(module.constants)
+     || !reader.read(module.maxDefinedConst)
+     || !reader.read(module.usedSamplers)
+     || !reader.read(module.usedRTs)
+     || !reader.read(shaderCount))
+      return false;
+
+    module.shaders.clear();
+    module.shaders.resize(std::min(shaderCount, 16u));
+
+    for (uint32_t i = 0; i < module.shaders.size(); i++) {
+      uint8_t present = 0;
+
+      if (!reader.read(present))
+        return false;
+
+      if (!present)
+        continue;
+
+      DxsoCachedShader shader;
+      uint32_t size = 0;
+      std::vector<uint64_t> mask;
+      std::vector<uint64_t> code;
+
+      if (!reader.read(shader.stage)
+       || !reader.readArray(shader.slots)
+       || !reader.read(shader.interfaceSlots)
+       || !reader.read(size)
+       || !reader.readArray(mask)
+       || !reader.readArray(code))
+        return false;
+
+      if (mask.size() != (size + 31) / 32 || code.size() > size)
+        return false;
+
+      shader.code = SpirvCompressedBuffer(size, std::move(mask), std::move(code));
+      module.shaders[i] = std::move(shader);
+    }
+
+    return reader.eof() && module.shaders.size() == shaderCount;
+  }
+
+}
@@ -0,0 +1,169 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dxso_isgn.h"
+
+#include "../dxvk/dxvk_pipelayout.h"
+#include "../dxvk/dxvk_shader.h"
+#include "../spirv/spirv_compression.h"
+#include "../util/thread.h"
+#include "../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Compiled shader stored in the cache
+   *
+   * Everything needed to re-create a \c DxvkShader
+   * without running the shader compiler again.
+   */
+  struct DxsoCachedShader {
+    VkShaderStageFlagBits         stage = VK_SHADER_STAGE_VERTEX_BIT;
+    std::vector<DxvkResourceSlot> slots;
+    DxvkInterfaceSlots            interfaceSlots;
+    SpirvCompressedBuffer         code;
+  };
+
+  /**
+   * \brief Shader cache entry
+   *
+   * All shader permutations produced for one set of inputs,
+   * along with the reflection data the D3D9 frontend needs.
+   * Fixed function shaders only use \c isgn and one shader.
+   */
+  struct DxsoCachedModule {
+    /// Inputs the module is generated from when they are self-contained,
+    /// i.e. fixed function shader keys, so that the module can be created
+    /// before the application asks for it. Empty for DXSO shaders.
+    std::vector<uint8_t> inputs;
+
+    DxsoIsgn             isgn;
+    DxsoIsgn             osgn;
+    DxsoShaderMetaInfo   meta;
+    DxsoDefinedConstants constants;
+    uint32_t             maxDefinedConst = 0;
+    uint32_t             usedSamplers    = 0;
+    uint32_t             usedRTs         = 0;
+
+    std::vector<std::optional<DxsoCachedShader>> shaders;
+  };
+
+  /**
+   * \brief Persistent cache of compiled shader modules
+   *
+   * Content addressed: entries are looked up by a hash of
+   * everything that affects the generated SPIR-V, which the
+   * caller computes. The file is read on a background thread
+   * as soon as the cache is created, and new entries are
+   * appended by the same thread once that is done.
+   *
+   * The whole file is discarded when its version stamp does
+   * not match, so the stamp must change whenever the shader
+   * compilers change their output.
+   */
+  class DxsoShaderCache {
+
+  public:
+
+    DxsoShaderCache(
+            std::string   filePath,
+            uint64_t      versionStamp);
+
+    ~DxsoShaderCache();
+
+    /**
+     * \brief Looks up a cached module
+     *
+     * Waits for the initial file read to complete.
+     * \param [in] key Content hash of the module
+     * \param [out] module The cached module
+     * \returns \c true if the module was found
+     */
+    bool lookup(
+            XXH64_hash_t      key,
+            DxsoCachedModule& module);
+
+    /**
+     * \brief Adds a module to the cache
+     *
+     * The module is written to disk asynchronously.
+     * \param [in] key Content hash of the module
+     * \param [in] module The compiled module
+     */
+    void insert(
+            XXH64_hash_t            key,
+      const DxsoCachedModule&       module);
+
+    /**
+     * \brief Enumerates the inputs stored with cached modules
+     *
+     * Waits for the initial file read to complete.
+     * \returns Key and inputs of every cached module
+     *   that was inserted with non-empty \c inputs
+     */
+    std::vector<std::pair<XXH64_hash_t, std::vector<uint8_t>>> getStoredInputs();
+
+    /**
+     * \brief Default cache file location
+     *
+     * Same directory as the DXVK state cache,
+     * named after the executable.
+     */
+    static std::string getDefaultFilePath();
+
+  private:
+
+    using Entry = std::vector<uint8_t>;
+
+    const std::string m_filePath;
+    const uint64_t    m_versionStamp;
+
+    dxvk::mutex                   m_mutex;
+    dxvk::condition_variable      m_cond;
+    bool                          m_prefetched = false;
+    bool                          m_stopThread = false;
+    std::unordered_map<XXH64_hash_t, Entry> m_entries;
+    std::queue<XXH64_hash_t>      m_writerQueue;
+
+    dxvk::thread                  m_thread;
+
+    void threadFunc();
+
+    bool readCacheFile();
+
+    void writeCacheFile();
+
+    static Entry serialize(const DxsoCachedModule& module);
+
+    static bool deserialize(const Entry& entry, DxsoCachedModule& module);
+
+  };
+
+}
@@ -115,11 +115,10 @@ namespace dxvk {
   
   
   DxvkCsThread::~DxvkCsThread() {
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      m_stopped.store(true);
-    }
-    
-    m_condOnAdd.notify_one();
+    // NV-DXVK start: lock-free chunk queue
+    m_stopped.store(true);
+    m_chunksQueued.stop();
+    // NV-DXVK end
     m_thread.join();
   }
   
@@ -127,15 +126,9 @@ namespace dxvk {
   uint64_t DxvkCsThread::dispatchChunk(DxvkCsChunkRef&& chunk) {
     ScopedCpuProfileZone();
 
-    uint64_t seq;
-
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      seq = ++m_chunksDispatched;
-      m_chunksQueued.push(std::move(chunk));
-    }
-    
-    m_condOnAdd.notify_one();
-    return seq;
+    // NV-DXVK start: lock-free chunk queue
+    return m_chunksQueued.push(std::move(chunk)) + 1;
+    // NV-DXVK end
   }
   
   
@@ -145,10 +138,16 @@ namespace dxvk {
     // Avoid locking if we know the sync is a no-op, may
     // reduce overhead if this is being called frequently
     if (seq > m_chunksExecuted.load(std::memory_order_acquire)) {
+      // NV-DXVK start: lock-free chunk queue
+      if (seq == SynchronizeAll)
+        seq = m_chunksQueued.pushCount();
+
       std::unique_lock<dxvk::mutex> lock(m_mutex);
 
-      if (seq == SynchronizeAll)
-        seq = m_chunksDispatched.load();
+      // The CS thread only notifies when there are waiters. Registering before
+      // checking the executed count pairs with it checking the waiter count
+      // after incrementing the executed count, so one of them sees the other.
+      m_syncWaiters++;
 
       auto t0 = dxvk::high_resolution_clock::now();
       m_condOnSync.wait(lock, [this, seq] {
@@ -157,6 +156,9 @@ namespace dxvk {
       auto t1 = dxvk::high_resolution_clock::now();
       auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
 
+      m_syncWaiters--;
+      // NV-DXVK end
+
       m_device->addStatCtr(DxvkStatCounter::CsSyncCount, 1);
       m_device->addStatCtr(DxvkStatCounter::CsSyncTicks, ticks.count());
     }
@@ -174,25 +176,22 @@ namespace dxvk {
       while (!m_stopped.load()) {
         { 
           ScopedCpuProfileZoneN("waiting for work");
-          std::unique_lock<dxvk::mutex> lock(m_mutex);
+          // NV-DXVK start: lock-free chunk queue
           if (chunk) {
             m_chunksExecuted++;
-            m_condOnSync.notify_one();
+
+            if (m_syncWaiters.load() != 0) {
+              // Taking the lock makes sure a waiter either did not check the executed count yet, or is already waiting
+              { std::unique_lock<dxvk::mutex> lock(m_mutex); }
+              m_condOnSync.notify_all();
+            }
             
             chunk = DxvkCsChunkRef();
           }
           
-          if (m_chunksQueued.size() == 0) {
-            m_condOnAdd.wait(lock, [this] {
-              return (m_chunksQueued.size() != 0)
-                  || (m_stopped.load());
-            });
-          }
-          
-          if (m_chunksQueued.size() != 0) {
-            chunk = std::move(m_chunksQueued.front());
-            m_chunksQueued.pop();
-          }
+          if (!m_chunksQueued.pop(chunk))
+            chunk = DxvkCsChunkRef();
+          // NV-DXVK end
         }
         
         if (chunk) {
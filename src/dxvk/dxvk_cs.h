@@ -6,6 +6,9 @@
 #include <queue>
 
 #include "../util/thread.h"
+// NV-DXVK start: lock-free chunk queue
+#include "../util/util_mpsc_queue.h"
+// NV-DXVK end
 
 #include "dxvk_device.h"
 #include "dxvk_context.h"
@@ -427,14 +430,20 @@ namespace dxvk {
     Rc<DxvkDevice>              m_device;
     Rc<DxvkContext>             m_context;
 
-    std::atomic<uint64_t>       m_chunksDispatched = { 0ull };
+    // NV-DXVK start: lock-free chunk queue
+    // Remix dispatches many chunks per frame from several threads, so chunks are
+    // queued without a lock. The sequence number of a chunk is its position in the
+    // queue plus one, and the mutex is only taken to wake threads that are waiting.
+    static constexpr uint32_t MaxChunksInFlight = 4096;
+
     std::atomic<uint64_t>       m_chunksExecuted   = { 0ull };
-    
+    std::atomic<uint32_t>       m_syncWaiters      = { 0u };
+
     std::atomic<bool>           m_stopped = { false };
     dxvk::mutex                 m_mutex;
-    dxvk::condition_variable    m_condOnAdd;
     dxvk::condition_variable    m_condOnSync;
-    std::queue<DxvkCsChunkRef>  m_chunksQueued;
+    MpscQueue<DxvkCsChunkRef, MaxChunksInFlight> m_chunksQueued;
+    // NV-DXVK end
     dxvk::thread                m_thread;
     
     void threadFunc();
@@ -2,6 +2,10 @@
 
 #include "dxvk_device.h"
 
+// NV-DXVK start: Hashes to identify textures.
+#include "rtx_render/rtx_texture_hasher.h"
+// NV-DXVK end
+
 namespace dxvk {
   
   std::atomic<uint64_t> DxvkImageView::s_cookie = { 0ull };
@@ -197,6 +201,18 @@ namespace dxvk {
   }
 
 
+  // NV-DXVK start: Hashes to identify textures.
+  void DxvkImage::setPendingHash(const Rc<PendingTextureHash>& pendingHash) {
+    m_pendingHash = pendingHash;
+  }
+
+
+  XXH64_hash_t DxvkImage::getPendingHash() const {
+    return m_pendingHash->get();
+  }
+  // NV-DXVK end
+
+
   bool DxvkImage::canShareImage(const VkImageCreateInfo&  createInfo, const DxvkSharedHandleInfo& sharingInfo) const {
     if (sharingInfo.mode == DxvkSharedHandleMode::None)
       return false;
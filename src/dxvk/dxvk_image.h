@@ -12,6 +12,9 @@
 namespace dxvk {
 
   class DxvkImageView;
+  // NV-DXVK start: Hashes to identify textures.
+  class PendingTextureHash;
+  // NV-DXVK end
   
   /**
    * \brief Image create info
@@ -352,10 +355,21 @@ namespace dxvk {
       m_hash = hash;
     }
 
+    // The hash is being computed asynchronously, getHash() waits for it
+    void setPendingHash(const Rc<PendingTextureHash>& pendingHash);
+
     XXH64_hash_t getHash() const {
+      if (unlikely(m_pendingHash != nullptr)) {
+        return getPendingHash();
+      }
       return m_hash;
     }
 
+    // Whether the image has a hash, or one on its way. Doesn't wait for a pending hash.
+    bool hasHash() const {
+      return m_hash != 0 || m_pendingHash != nullptr;
+    }
+
     void setDescriptorHash(XXH64_hash_t hash) {
       m_descriptorHash = hash;
     }
@@ -400,6 +414,9 @@ namespace dxvk {
     // NV-DXVK start: Hashes to identify textures.
     XXH64_hash_t          m_hash = 0;
     XXH64_hash_t          m_descriptorHash = 0;
+    Rc<PendingTextureHash> m_pendingHash;
+
+    XXH64_hash_t getPendingHash() const;
     // NV-DXVK end
     bool m_shared = false;
 
@@ -209,6 +209,24 @@ namespace dxvk {
       return m_interface;
     }
 
+    // NV-DXVK start: shader disk cache
+    /**
+     * \brief Resource slots used by the shader
+     * \returns Resource slot infos
+     */
+    const std::vector<DxvkResourceSlot>& resourceSlots() const {
+      return m_slots;
+    }
+
+    /**
+     * \brief Compressed SPIR-V code
+     * \returns Code as passed to the constructor
+     */
+    const SpirvCompressedBuffer& compressedCode() const {
+      return m_code;
+    }
+    // NV-DXVK end
+
     /**
      * \brief Shader options
      * \returns Shader options
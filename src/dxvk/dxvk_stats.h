@@ -40,6 +40,17 @@ namespace dxvk {
     RtxSamplers,                       ///< Number of samplers currently present in the scene
     RtxTexturesInFlight,               ///< Number of texture currently being loaded
     RtxLastTextureBatchDuration,       ///< Duration in ms of the last processed texture batch
+    RtxCameraCacheHitRate,             ///< Percentage of draws in the last frame whose camera was resolved from the cache
+    RtxMergedBlasBuilt,                ///< Number of merged BLAS's built in the last frame
+    RtxMergedBlasRefit,                ///< Number of merged BLAS's refit in the last frame
+    RtxMergedBlasReused,               ///< Number of merged BLAS's reused without a build in the last frame
+    RtxMergedBlasSurfaceArea,          ///< Sum of the surface areas of the merged BLAS's world bounds in the last frame
+    RtxSkinningJobs,                   ///< Number of GPU skinning jobs in the last frame
+    RtxSkinningPalettes,               ///< Number of unique bone palettes uploaded for GPU skinning in the last frame
+    RtxFFShaderHits,                   ///< Number of fixed function shader requests served from memory
+    RtxFFShaderCacheLoads,             ///< Number of fixed function shaders loaded from the shader disk cache
+    RtxFFShaderCompiles,               ///< Number of fixed function shaders compiled on a disk cache miss
+    RtxFFShaderFallbacks,              ///< Number of fixed function shader requests served by a fallback shader
     // NV-DXVK end
 
     NumCounters,              ///< Number of counters available
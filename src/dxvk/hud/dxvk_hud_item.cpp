@@ -824,7 +824,18 @@ namespace dxvk::hud {
                                    "# Lights:",
                                    "# Samplers:",
                                    "# Textures in-flight:",
-                                   "# Last tex. batch (ms):"}; 
+                                   "# Last tex. batch (ms):",
+                                   "# Camera cache hit rate (%):",
+                                   "# Merged BLAS built:",
+                                   "# Merged BLAS refit:",
+                                   "# Merged BLAS reused:",
+                                   "# Merged BLAS area:",
+                                   "# Skinning jobs:",
+                                   "# Skinning palettes:",
+                                   "# FF shader hits:",
+                                   "# FF shader cache loads:",
+                                   "# FF shader compiles:",
+                                   "# FF shader fallbacks:"}; 
     const uint64_t values[] = { counters.getCtr(DxvkStatCounter::QueuePresentCount),
                                 counters.getCtr(DxvkStatCounter::RtxBlasCount),
                                 counters.getCtr(DxvkStatCounter::RtxBufferCount),
@@ -836,7 +847,18 @@ namespace dxvk::hud {
                                 counters.getCtr(DxvkStatCounter::RtxLightCount),
                                 counters.getCtr(DxvkStatCounter::RtxSamplers),
                                 counters.getCtr(DxvkStatCounter::RtxTexturesInFlight),
-                                counters.getCtr(DxvkStatCounter::RtxLastTextureBatchDuration)};
+                                counters.getCtr(DxvkStatCounter::RtxLastTextureBatchDuration),
+                                counters.getCtr(DxvkStatCounter::RtxCameraCacheHitRate),
+                                counters.getCtr(DxvkStatCounter::RtxMergedBlasBuilt),
+                                counters.getCtr(DxvkStatCounter::RtxMergedBlasRefit),
+                                counters.getCtr(DxvkStatCounter::RtxMergedBlasReused),
+                                counters.getCtr(DxvkStatCounter::RtxMergedBlasSurfaceArea),
+                                counters.getCtr(DxvkStatCounter::RtxSkinningJobs),
+                                counters.getCtr(DxvkStatCounter::RtxSkinningPalettes),
+                                counters.getCtr(DxvkStatCounter::RtxFFShaderHits),
+                                counters.getCtr(DxvkStatCounter::RtxFFShaderCacheLoads),
+                                counters.getCtr(DxvkStatCounter::RtxFFShaderCompiles),
+                                counters.getCtr(DxvkStatCounter::RtxFFShaderFallbacks)};
 
     const uint32_t kNumLabels = sizeof(labels) / sizeof(labels[0]);
     static_assert(kNumLabels == sizeof(values) / sizeof(values[0]));
@@ -49,7 +49,8 @@ class Add : public RtRegisteredComponentBatch<Add<aPropertyType, bPropertyType,
     /* the doc string */     "Adds two numbers or vectors together.\n\n" \
       "Vector + Number will add the number to all components of the vector. Vector + Vector will add each piece separately, to create (a.x + b.x, a.y + b.y, ...). Vector + Vector will error if the vectors aren't the same size.",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
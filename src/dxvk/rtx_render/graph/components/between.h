@@ -45,7 +45,8 @@ REMIX_COMPONENT(
     "Returns true if the value is >= Min Value AND <= Max Value. " \
     "Combines greater-than-or-equal, less-than-or-equal, and boolean AND into a single component.",
   /* the version number */ 1,
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS)
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+  spec.pure = true)
 
 #undef LIST_INPUTS
 #undef LIST_STATES
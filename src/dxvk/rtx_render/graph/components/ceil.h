@@ -43,7 +43,8 @@ REMIX_COMPONENT(
   /* the doc string */     "Rounds a value up to the next integer.\n\n" \
     "Returns the smallest integer greater than or equal to the input. For example: 1.1 becomes 2.0, 1.9 becomes 2.0, -1.1 becomes -1.0.",
   /* the version number */ 1,
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS)
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+  spec.pure = true)
 
 #undef LIST_INPUTS
 #undef LIST_STATES
@@ -56,7 +56,8 @@ private:
       "If the value is greater than Max Value, returns Max Value. " \
       "Otherwise, returns the value unchanged. Applies to each component of a vector individually.",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void Clamp::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
@@ -42,7 +42,8 @@ REMIX_COMPONENT( \
   /* the doc string */     "Provides a constant true or false value that you can set.\n\n" \
     "Use this to provide fixed on/off, yes/no, or enabled/disabled values to other components.", \
   /* the version number */ 1, \
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS);
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS, \
+  spec.pure = true);
 
 #undef LIST_INPUTS
 #undef LIST_STATES
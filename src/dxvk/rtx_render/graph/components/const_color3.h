@@ -42,7 +42,8 @@ REMIX_COMPONENT( \
   /* the doc string */     "Provides a constant RGB color (Red, Green, Blue) that you can set.\n\n" \
     "Use this to provide fixed colors to materials, lights, or other components. Each channel ranges from 0.0 to 1.0.", \
   /* the version number */ 1, \
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS);
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS, \
+  spec.pure = true);
 
 #undef LIST_INPUTS
 #undef LIST_STATES
@@ -42,7 +42,8 @@ REMIX_COMPONENT( \
   /* the doc string */     "Provides a constant RGBA color (Red, Green, Blue, Alpha) that you can set.\n\n" \
     "Use this for fixed colors with transparency. Each channel ranges from 0.0 to 1.0.", \
   /* the version number */ 1, \
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS);
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS, \
+  spec.pure = true);
 
 #undef LIST_INPUTS
 #undef LIST_STATES
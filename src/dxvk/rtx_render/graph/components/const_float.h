@@ -42,7 +42,8 @@ REMIX_COMPONENT( \
   /* the doc string */     "Provides a constant decimal number that you can set.\n\n" \
     "Use this to provide fixed values like 0.5, 3.14, or 100.0 to other components.", \
   /* the version number */ 1, \
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS);
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS, \
+  spec.pure = true);
 
 #undef LIST_INPUTS
 #undef LIST_STATES
@@ -42,7 +42,8 @@ REMIX_COMPONENT( \
   /* the doc string */     "Provides a constant 2D vector (two numbers: X and Y) that you can set.\n\n" \
     "Use this for fixed 2D coordinates, texture coordinates, or any pair of values.", \
   /* the version number */ 1, \
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS);
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS, \
+  spec.pure = true);
 
 #undef LIST_INPUTS
 #undef LIST_STATES
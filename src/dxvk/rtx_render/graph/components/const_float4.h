@@ -41,7 +41,8 @@ REMIX_COMPONENT( \
   /* the UI categories */  "Constants", \
   /* the doc string */     "Provides a constant 4D vector (four numbers: X, Y, Z, W) that you can set.", \
   /* the version number */ 1, \
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS);
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS, \
+  spec.pure = true);
 
 #undef LIST_INPUTS
 #undef LIST_STATES
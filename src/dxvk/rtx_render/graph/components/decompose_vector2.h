@@ -42,7 +42,8 @@ REMIX_COMPONENT( \
   /* the UI categories */  "Transform", \
   /* the doc string */     "Splits a Vector2 into two separate numbers.", \
   /* the version number */ 1, \
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS)
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS, \
+  spec.pure = true)
 
 #undef LIST_INPUTS
 #undef LIST_STATES
@@ -43,7 +43,8 @@ REMIX_COMPONENT( \
   /* the UI categories */  "Transform", \
   /* the doc string */     "Splits a Vector3 into three separate numbers.", \
   /* the version number */ 1, \
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS)
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS, \
+  spec.pure = true)
 
 #undef LIST_INPUTS
 #undef LIST_STATES
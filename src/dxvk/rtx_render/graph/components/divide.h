@@ -50,7 +50,8 @@ class Divide : public RtRegisteredComponentBatch<Divide<aPropertyType, bProperty
       "Vector / Number will divide all components of the vector by the number. Vector / vector will divide each piece separately, to create (a.x / b.x, a.y / b.y, ...). Vector / Vector will error if the vectors aren't the same size.\n\n" \
       "Note: Division by zero will produce infinity or NaN.",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
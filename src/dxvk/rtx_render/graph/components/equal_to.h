@@ -62,7 +62,8 @@ private:
     /* the doc string */     "Returns true if A is equal to B, false otherwise.\n\n" \
       "For floating point values, this performs exact equality comparison. Vector == Vector compares all components.",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
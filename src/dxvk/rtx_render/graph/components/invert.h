@@ -48,7 +48,8 @@ private:
     /* the doc string */     "Outputs 1 minus the input value.\n\n" \
       "Calculates 1 - input. Useful for inverting normalized values (e.g., turning 0.2 into 0.8).",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void Invert::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
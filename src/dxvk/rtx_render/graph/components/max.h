@@ -52,7 +52,8 @@ private:
     /* the doc string */     "Returns the larger of two values.\n\n" \
       "Outputs the maximum value between A and B.",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void Max::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
@@ -24,6 +24,7 @@
 
 #include "../rtx_graph_component_macros.h"
 #include "../rtx_graph_batch.h"
+#include "../rtx_graph_mesh_bvh_cache.h"
 #include "../../rtx_scene_manager.h"
 #include "../../rtx_types.h"
 #include "../../../../util/util_math.h"
@@ -35,6 +36,16 @@
 namespace dxvk {
 namespace components {
 
+enum class ProximityType : uint32_t {
+  BoundingBox = 0,
+  Mesh = 1,
+};
+
+inline const auto kProximityTypeEnumValues = RtComponentPropertySpec::EnumPropertyMap{
+  {"Bounding Box", {ProximityType::BoundingBox, "Measure the distance to the mesh's axis-aligned bounding box."}},
+  {"Mesh", {ProximityType::Mesh, "Measure the distance to the mesh's triangles. The distance is negative inside of closed meshes. Falls back to the bounding box if the mesh's vertices are not accessible on the CPU, i.e. for skinned meshes."}}
+};
+
 #define LIST_INPUTS(X) \
   X(RtComponentPropertyType::Prim, kInvalidPrimTarget, target, "Target", \
     "The mesh prim to get bounding box from. Must be a UsdGeomMesh prim (the actual geometry).", \
@@ -53,7 +64,11 @@ namespace components {
   X(RtComponentPropertyType::Enum, static_cast<uint32_t>(InterpolationType::Linear), easingType, "Easing Type", \
     "The type of easing to apply to the `Activation Strength` output.  ", \
     property.optional = true, \
-    property.enumValues = kInterpolationTypeEnumValues)
+    property.enumValues = kInterpolationTypeEnumValues) \
+  X(RtComponentPropertyType::Enum, static_cast<uint32_t>(ProximityType::BoundingBox), proximityType, "Proximity Type", \
+    "What to measure the distance to.", \
+    property.optional = true, \
+    property.enumValues = kProximityTypeEnumValues)
 
 #define LIST_STATES(X)
 
@@ -108,6 +123,10 @@ static float calculateSignedDistanceToAABB(const Vector3& point, const AxisAlign
 }
 
 void MeshProximity::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
+  RtxContext* rtxContext = static_cast<RtxContext*>(context.ptr());
+  MeshBvhCache& bvhCache = rtxContext->getSceneManager().getGraphManager().getMeshBvhCache();
+  const uint32_t frameId = context->getDevice()->getCurrentFrameId();
+
   for (size_t i = start; i < end; i++) {
     const Vector3& testPoint = m_worldPosition[i];
     
@@ -140,7 +159,18 @@ void MeshProximity::updateRange(const Rc<DxvkContext>& context, const size_t sta
             Vector3 objectSpacePoint = (worldToObject * Vector4(testPoint, 1.0f)).xyz();
             
             // Calculate the signed distance in object space
-            signedDistance = calculateSignedDistanceToAABB(objectSpacePoint, objectSpaceBoundingBox);
+            const MeshBvh* bvh = nullptr;
+            if (static_cast<ProximityType>(m_proximityType[i]) == ProximityType::Mesh) {
+              bvh = bvhCache.get(blasEntry->input.getGeometryData(), frameId);
+
+              if (bvh == nullptr) {
+                ONCE(Logger::warn("MeshProximity: Mesh vertices are not accessible on the CPU, falling back to the bounding box."));
+              }
+            }
+
+            signedDistance = bvh != nullptr
+              ? bvh->calculateSignedDistance(objectSpacePoint)
+              : calculateSignedDistanceToAABB(objectSpacePoint, objectSpaceBoundingBox);
           }
         }
       }
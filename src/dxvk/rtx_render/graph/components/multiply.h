@@ -49,7 +49,8 @@ class Multiply : public RtRegisteredComponentBatch<Multiply<aPropertyType, bProp
     /* the doc string */     "Multiplies two values together.\n\n" \
       "Vector * Number will multiply all components of the vector by the number. Vector * Vector will multiply each piece separately, to create (a.x * b.x, a.y * b.y, ...). Vector * Vector will error if the vectors aren't the same size.",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
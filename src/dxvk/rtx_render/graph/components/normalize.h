@@ -51,7 +51,8 @@ private:
       "Divides the vector by its length to produce a unit vector (length 1) in the same direction. " \
       "If the input vector has zero length, returns a default vector to avoid division by zero.",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void Normalize::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
@@ -24,6 +24,7 @@
 
 #include "../rtx_graph_component_macros.h"
 #include "../rtx_graph_batch.h"
+#include "../rtx_graph_mesh_bvh_cache.h"
 #include "../../rtx_scene_manager.h"
 #include "../../rtx_types.h"
 #include "../../../../util/util_math.h"
@@ -35,10 +36,12 @@ namespace components {
 
 enum class IntersectionType : uint32_t {
   BoundingBox = 0,
+  Mesh = 1,
 };
 
 inline const auto kIntersectionTypeEnumValues = RtComponentPropertySpec::EnumPropertyMap{
-  {"Bounding Box", {IntersectionType::BoundingBox, "Test intersection against the mesh's axis-aligned bounding box."}}
+  {"Bounding Box", {IntersectionType::BoundingBox, "Test intersection against the mesh's axis-aligned bounding box."}},
+  {"Mesh", {IntersectionType::Mesh, "Test intersection against the mesh's triangles. Falls back to the bounding box if the mesh's vertices are not accessible on the CPU, i.e. for skinned meshes."}}
 };
 
 #define LIST_INPUTS(X) \
@@ -61,8 +64,8 @@ REMIX_COMPONENT( \
   /* the UI name */        "Ray Mesh Intersection", \
   /* the UI categories */  "Sense", \
   /* the doc string */     "Tests if a ray intersects with a mesh.\n\n" \
-    "Performs a ray-mesh intersection test. Currently supports bounding box intersection tests. " \
-    "Returns true if the ray intersects the mesh's bounding box.", \
+    "Performs a ray-mesh intersection test against either the mesh's bounding box or its triangles. " \
+    "Returns true if the ray intersects the mesh.", \
   /* the version number */ 1, \
   LIST_INPUTS, LIST_STATES, LIST_OUTPUTS);
 
@@ -109,6 +112,18 @@ static bool rayIntersectsAABB(const Vector3& rayOrigin, const Vector3& rayDirect
 }
 
 void RayMeshIntersection::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
+  RtxContext* rtxContext = static_cast<RtxContext*>(context.ptr());
+  MeshBvhCache& bvhCache = rtxContext->getSceneManager().getGraphManager().getMeshBvhCache();
+  const uint32_t frameId = context->getDevice()->getCurrentFrameId();
+
+  // Triangle tests are gathered per mesh so that they can be traced in packets
+  struct MeshRays {
+    std::vector<size_t> instances;
+    std::vector<Vector3> origins;
+    std::vector<Vector3> directions;
+  };
+  std::unordered_map<const MeshBvh*, MeshRays> raysPerMesh;
+
   for (size_t i = start; i < end; i++) {
     bool intersects = false;
     
@@ -135,10 +150,23 @@ void RayMeshIntersection::updateRange(const Rc<DxvkContext>& context, const size
             // Normalize the direction after transformation
             objectSpaceRayDirection = normalize(objectSpaceRayDirection);
             
-            // Perform intersection test based on type
+            // Perform intersection test based on type.
+            // The bounding box test also serves as an early out for the triangle test
             IntersectionType intersectionType = static_cast<IntersectionType>(m_intersectionType[i]);
-            if (intersectionType == IntersectionType::BoundingBox) {
-              intersects = rayIntersectsAABB(objectSpaceRayOrigin, objectSpaceRayDirection, objectSpaceBoundingBox);
+            intersects = rayIntersectsAABB(objectSpaceRayOrigin, objectSpaceRayDirection, objectSpaceBoundingBox);
+
+            if (intersects && intersectionType == IntersectionType::Mesh) {
+              const MeshBvh* bvh = bvhCache.get(blasEntry->input.getGeometryData(), frameId);
+
+              if (bvh != nullptr) {
+                MeshRays& rays = raysPerMesh[bvh];
+                rays.instances.push_back(i);
+                rays.origins.push_back(objectSpaceRayOrigin);
+                rays.directions.push_back(objectSpaceRayDirection);
+                intersects = false;
+              } else {
+                ONCE(Logger::warn("RayMeshIntersection: Mesh vertices are not accessible on the CPU, falling back to a bounding box test."));
+              }
             }
           }
         }
@@ -147,6 +175,16 @@ void RayMeshIntersection::updateRange(const Rc<DxvkContext>& context, const size
     
     m_intersects[i] = intersects;
   }
+
+  std::vector<MeshBvh::RayHit> hits;
+  for (const auto& [bvh, rays] : raysPerMesh) {
+    hits.resize(rays.instances.size());
+    bvh->intersect(static_cast<uint32_t>(rays.instances.size()), rays.origins.data(), rays.directions.data(), FLT_MAX, hits.data());
+
+    for (size_t j = 0; j < rays.instances.size(); j++) {
+      m_intersects[rays.instances[j]] = hits[j].isHit();
+    }
+  }
 }
 
 }  // namespace components
@@ -70,7 +70,8 @@ private:
       "Inverted ranges (max < min) are supported.",
     /* the version number */ 1,
     LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
-    spec.oldNames = {"InterpolateFloat"} // TODO: remove this after new versions of the demo are shared.
+    spec.oldNames = {"InterpolateFloat"}; // TODO: remove this after new versions of the demo are shared.
+    spec.pure = true
   )
   void Remap::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
@@ -43,7 +43,8 @@ REMIX_COMPONENT(
   /* the doc string */     "Rounds a value to the nearest integer.\n\n" \
     "Rounds to the nearest whole number. For example: 1.4 becomes 1.0, 1.5 becomes 2.0, 1.6 becomes 2.0.",
   /* the version number */ 1,
-  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS)
+  LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+  spec.pure = true)
 
 #undef LIST_INPUTS
 #undef LIST_STATES
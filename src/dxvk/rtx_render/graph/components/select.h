@@ -53,7 +53,8 @@ private:
       "If the condition is true, outputs Input A. If the condition is false, outputs Input B. " \
       "Acts like a ternary operator or if-else statement.",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void Select::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
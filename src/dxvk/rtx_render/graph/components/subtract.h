@@ -49,7 +49,8 @@ class Subtract : public RtRegisteredComponentBatch<Subtract<aPropertyType, bProp
     /* the doc string */     "Subtracts one number or vector from another.\n\n" \
       "Vector - Number will subtract the number from all components of the vector. Vector - Vector will error if the vectors aren't the same size.",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
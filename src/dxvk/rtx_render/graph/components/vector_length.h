@@ -50,7 +50,8 @@ private:
     /* the doc string */     "Calculates the length (magnitude) of a vector.\n\n" \
       "Computes the Euclidean length of the vector using the formula: sqrt(x² + y² + z² + ...).",
     /* the version number */ 1,
-    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS
+    LIST_INPUTS, LIST_STATES, LIST_OUTPUTS,
+    spec.pure = true
   )
   void VectorLength::updateRange(const Rc<DxvkContext>& context, const size_t start, const size_t end) {
     for (size_t i = start; i < end; i++) {
@@ -95,7 +95,7 @@ namespace {
   }
 }
 
-void RtGraphBatch::Initialize(const RtGraphTopology& topology) {
+void RtGraphBatch::Initialize(const RtGraphTopology& topology, bool fusePureComponents) {
   // NOTE: need to do this separate from the constructor, because the address of `this` changes when it's moved.
   ScopedCpuProfileZone();
 
@@ -118,6 +118,24 @@ void RtGraphBatch::Initialize(const RtGraphTopology& topology) {
     }
   }
   m_graphHash = topology.graphHash;
+
+  // Group the components into segments.  Pure components only touch their own properties at the index
+  // being updated, so a run of them can be updated block by block, with each block of properties passing
+  // through the whole run while it is still in cache.  Every component still reads exactly the values it
+  // would have read when updating the components one after another, so the results are identical.
+  for (size_t i = 0; i < m_componentBatches.size(); i++) {
+    const bool pure = fusePureComponents && m_componentBatches[i]->getSpec()->pure;
+    if (pure && !m_updateSegments.empty() && m_updateSegments.back().fused) {
+      m_updateSegments.back().numBatches++;
+    } else {
+      m_updateSegments.push_back({ i, 1, pure });
+    }
+  }
+
+  // A single component gains nothing from being blocked
+  for (UpdateSegment& segment : m_updateSegments) {
+    segment.fused = segment.fused && segment.numBatches > 1;
+  }
 }
 
 bool RtGraphBatch::addInstance(Rc<DxvkContext> context, const RtGraphState& initialGraphState, GraphInstance* graphInstance) {
@@ -224,8 +242,22 @@ void RtGraphBatch::update(Rc<DxvkContext> context) {
 
 void RtGraphBatch::updateRange(Rc<DxvkContext> context, size_t start, size_t end) {
   ScopedCpuProfileZone();
-  for (auto& componentBatch : m_componentBatches) {
-    componentBatch->updateRange(context, start, end);
+  for (const UpdateSegment& segment : m_updateSegments) {
+    const size_t segmentEnd = segment.firstBatch + segment.numBatches;
+
+    if (!segment.fused) {
+      for (size_t batch = segment.firstBatch; batch < segmentEnd; batch++) {
+        m_componentBatches[batch]->updateRange(context, start, end);
+      }
+      continue;
+    }
+
+    for (size_t blockStart = start; blockStart < end; blockStart += kFusedBlockSize) {
+      const size_t blockEnd = std::min(blockStart + kFusedBlockSize, end);
+      for (size_t batch = segment.firstBatch; batch < segmentEnd; batch++) {
+        m_componentBatches[batch]->updateRange(context, blockStart, blockEnd);
+      }
+    }
   }
 }
 
@@ -42,7 +42,12 @@ public:
   RtGraphBatch(RtGraphBatch&&) = default;
   RtGraphBatch& operator=(RtGraphBatch&&) = default;
 
-  void Initialize(const RtGraphTopology& topology);
+  // Number of instances updated at a time by fused segments of pure components.
+  static constexpr size_t kFusedBlockSize = 64;
+
+  // When fusePureComponents is set, consecutive pure components are updated in interleaved blocks of
+  // instances rather than one after another over all instances, see RtComponentSpec::pure.
+  void Initialize(const RtGraphTopology& topology, bool fusePureComponents = true);
   
   bool addInstance(Rc<DxvkContext> context, const RtGraphState& graphState, GraphInstance* replacementInstance);
 
@@ -91,6 +96,15 @@ public:
     return m_componentBatches;
   }
 
+  // Number of components updated as part of a fused segment
+  size_t getNumFusedComponents() const {
+    size_t count = 0;
+    for (const UpdateSegment& segment : m_updateSegments) {
+      count += segment.fused ? segment.numBatches : 0;
+    }
+    return count;
+  }
+
   const std::vector<RtComponentPropertyVector>& getProperties() const {
     return m_properties;
   }
@@ -121,11 +135,19 @@ public:
   }
 
 private:
+  // A run of consecutive component batches in update order
+  struct UpdateSegment {
+    size_t firstBatch;
+    size_t numBatches;
+    bool fused;
+  };
+
   XXH64_hash_t m_graphHash;
   const RtGraphTopology* m_topology = nullptr;
   std::vector<std::unique_ptr<RtComponentBatch>> m_componentBatches;
   std::vector<uint32_t> m_batchesWithSceneOverrides;
   std::vector<RtComponentPropertyVector> m_properties;
+  std::vector<UpdateSegment> m_updateSegments;
 
   std::vector<GraphInstance*> m_graphInstances;
 
@@ -25,6 +25,7 @@
 #include "dxvk_context.h"
 #include "dxvk_scoped_annotation.h"
 #include "rtx_graph_batch.h"
+#include "rtx_graph_mesh_bvh_cache.h"
 #include "rtx_graph_ogn_writer.h"
 #include "rtx_graph_types.h"
 #include "rtx_render/rtx_asset_replacer.h"
@@ -41,6 +42,7 @@ class GraphManager {
 public:
   RTX_OPTION("rtx.graph", bool, enable, true, "Enable graph loading.  If disabled, all graphs will be unloaded, losing any state.");
   RTX_OPTION("rtx.graph", bool, pauseGraphUpdates, false, "Pause graph updating.  If enabled, graphs logic will not be updated, but graph state will be retained.");
+  RTX_OPTION("rtx.graph", bool, fusePureComponents, true, "Update chains of pure components (math and logic) in interleaved blocks of instances, keeping their values in cache between components.  Produces identical results, only applied to graphs loaded after changing it.");
 
   GraphManager() {
     static std::once_flag schemaWriteFlag;
@@ -68,7 +70,7 @@ public:
     auto iter = m_batches.find(graphState.topology.graphHash);
     if (iter == m_batches.end()) {
       iter = m_batches.emplace(graphState.topology.graphHash, RtGraphBatch()).first;
-      iter->second.Initialize(graphState.topology);
+      iter->second.Initialize(graphState.topology, fusePureComponents());
     }
     uint64_t instanceId = m_nextInstanceId++;
     auto pair = m_graphInstances.try_emplace(instanceId, this, graphState.topology.graphHash, 0, instanceId, graphState);
@@ -115,6 +117,7 @@ public:
   void clear() {
     m_batches.clear();
     m_graphInstances.clear();
+    m_meshBvhCache.clear();
   }
 
   void update(Rc<DxvkContext>& context) {
@@ -146,6 +149,8 @@ public:
     for (auto& batch : m_batches) {
       batch.second.update(context);
     }
+
+    m_meshBvhCache.garbageCollect(context->getDevice()->getCurrentFrameId());
   }
 
   void applySceneOverrides(Rc<DxvkContext> context) {
@@ -167,6 +172,11 @@ public:
     return m_batches;
   }
 
+  // CPU BVHs of meshes used by mesh query components
+  MeshBvhCache& getMeshBvhCache() {
+    return m_meshBvhCache;
+  }
+
 private:
   Rc<DxvkContext> m_context;
 
@@ -175,6 +185,8 @@ private:
   std::unordered_map<uint64_t, GraphInstance> m_graphInstances;
 
   uint64_t m_nextInstanceId = 1;
+
+  MeshBvhCache m_meshBvhCache;
   
   mutable std::mutex m_instanceResetMutex;
   mutable bool m_resetPending = false;
@@ -0,0 +1,170 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "../rtx_types.h"
+#include "../../../util/util_fast_cache.h"
+#include "../../../util/util_mesh_bvh.h"
+
+namespace dxvk {
+
+// CPU BVHs of meshes queried by graph components, shared by all graph instances.
+// Hierarchies are built on first use and released once no component has queried them for a while.
+class MeshBvhCache {
+public:
+  static constexpr uint32_t kNumFramesToRetain = 60;
+
+  // Returns the hierarchy for a mesh, or null if its geometry is not accessible on the CPU
+  const MeshBvh* get(const RasterGeometry& geometry, uint32_t frameId) {
+    const XXH64_hash_t key = calculateKey(geometry);
+
+    auto iter = m_entries.find(key);
+    if (iter == m_entries.end()) {
+      Entry entry;
+      entry.bvh = build(geometry);
+      iter = m_entries.emplace(key, std::move(entry)).first;
+    }
+
+    iter->second.lastUsedFrameId = frameId;
+    return iter->second.bvh.get();
+  }
+
+  void garbageCollect(uint32_t frameId) {
+    for (auto iter = m_entries.begin(); iter != m_entries.end();) {
+      if (frameId - iter->second.lastUsedFrameId > kNumFramesToRetain) {
+        iter = m_entries.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+  void clear() {
+    m_entries.clear();
+  }
+
+  size_t size() const {
+    return m_entries.size();
+  }
+
+private:
+  struct Entry {
+    std::unique_ptr<MeshBvh> bvh;  // Null when the geometry could not be read, so that it is not retried every frame
+    uint32_t lastUsedFrameId = 0;
+  };
+
+  static XXH64_hash_t calculateKey(const RasterGeometry& geometry) {
+    const XXH64_hash_t data[] = {
+      geometry.hashes[HashComponents::VertexPosition],
+      geometry.hashes[HashComponents::Indices],
+      geometry.vertexCount,
+      geometry.indexCount,
+      static_cast<XXH64_hash_t>(geometry.topology)
+    };
+
+    return XXH3_64bits(data, sizeof(data));
+  }
+
+  static std::unique_ptr<MeshBvh> build(const RasterGeometry& geometry) {
+    const RasterBuffer& positionBuffer = geometry.positionBuffer;
+
+    if (!positionBuffer.defined() || geometry.vertexCount == 0 ||
+        (positionBuffer.vertexFormat() != VK_FORMAT_R32G32B32_SFLOAT && positionBuffer.vertexFormat() != VK_FORMAT_R32G32B32A32_SFLOAT)) {
+      return nullptr;
+    }
+
+    // Device local buffers, i.e. of skinned replacement meshes, are not mapped
+    const uint8_t* pVertexData = static_cast<const uint8_t*>(positionBuffer.mapPtr(positionBuffer.offsetFromSlice()));
+    if (pVertexData == nullptr) {
+      return nullptr;
+    }
+
+    std::vector<Vector3> positions(geometry.vertexCount);
+    for (uint32_t i = 0; i < geometry.vertexCount; i++) {
+      memcpy(&positions[i], pVertexData + i * positionBuffer.stride(), sizeof(Vector3));
+    }
+
+    // Fetch the primitive's vertex indices, topology is resolved below
+    std::vector<uint32_t> vertexIndices;
+    const RasterBuffer& indexBuffer = geometry.indexBuffer;
+
+    if (indexBuffer.defined() && geometry.indexCount > 0) {
+      const void* pIndexData = indexBuffer.mapPtr(indexBuffer.offsetFromSlice());
+      if (pIndexData == nullptr) {
+        return nullptr;
+      }
+
+      vertexIndices.resize(geometry.indexCount);
+      if (indexBuffer.indexType() == VK_INDEX_TYPE_UINT16) {
+        const uint16_t* pIndices = static_cast<const uint16_t*>(pIndexData);
+        for (uint32_t i = 0; i < geometry.indexCount; i++) {
+          vertexIndices[i] = pIndices[i];
+        }
+      } else {
+        memcpy(vertexIndices.data(), pIndexData, geometry.indexCount * sizeof(uint32_t));
+      }
+    } else {
+      vertexIndices.resize(geometry.vertexCount);
+      for (uint32_t i = 0; i < geometry.vertexCount; i++) {
+        vertexIndices[i] = i;
+      }
+    }
+
+    std::vector<uint32_t> triangleList;
+
+    switch (geometry.topology) {
+    case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST:
+      triangleList = std::move(vertexIndices);
+      break;
+    case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+      for (uint32_t i = 2; i < vertexIndices.size(); i++) {
+        // Winding doesn't matter, triangles are two-sided
+        triangleList.insert(triangleList.end(), { vertexIndices[i - 2], vertexIndices[i - 1], vertexIndices[i] });
+      }
+      break;
+    case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN:
+      for (uint32_t i = 2; i < vertexIndices.size(); i++) {
+        triangleList.insert(triangleList.end(), { vertexIndices[0], vertexIndices[i - 1], vertexIndices[i] });
+      }
+      break;
+    default:
+      return nullptr;
+    }
+
+    auto bvh = std::make_unique<MeshBvh>();
+    bvh->build(positions.data(), geometry.vertexCount, triangleList.data(), static_cast<uint32_t>(triangleList.size()));
+
+    if (bvh->empty()) {
+      return nullptr;
+    }
+
+    return bvh;
+  }
+
+  fast_unordered_cache<Entry> m_entries;
+};
+
+}
@@ -423,6 +423,11 @@ struct RtComponentSpec {
   // Called before the instance is removed from the batch. No context is available during cleanup.
   CleanupFunc cleanup = nullptr;
 
+  // Set for components whose updateRange only reads and writes the component's own properties at the
+  // index being updated, and has no other side effects (i.e. math and logic components).
+  // Consecutive pure components may be updated in interleaved blocks of instances, see RtGraphBatch.
+  bool pure = false;
+
   ///////////////////////////////////////////////////////////////////////////////////////////////////////////
   // END OF OPTIONAL VALUES FOR COMPONENT SPECS
   ///////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -21,6 +21,7 @@
 */
 #include <mutex>
 #include <vector>
+#include <algorithm>
 #include <assert.h>
 
 #include "rtx.h"
@@ -58,6 +59,7 @@ namespace dxvk {
   }
 
   void AccelManager::clear() {
+    m_blasBucketPlanner.clear([](BlasBucket&) { });
     m_blasPool.clear();
   }
 
@@ -123,34 +125,21 @@ namespace dxvk {
     return uint32_t(std::max(g_blasCount, 0));
   }
 
-  bool AccelManager::BlasBucket::tryAddInstance(RtInstance* instance) {
-    const uint8_t geometryInstanceMask = instance->getVkInstance().mask;
-    const uint32_t geometryCustomIndexFlags = instance->getVkInstance().instanceCustomIndex & ~uint32_t(CUSTOM_INDEX_SURFACE_MASK);
-    const bool geometryUsesUnorderedApproximations = instance->usesUnorderedApproximations();
-    const VkGeometryInstanceFlagsKHR geometryInstanceFlags = instance->getVkInstance().flags;
-    const uint32_t geometryInstanceShaderBindingTableRecordOffset = instance->getVkInstance().instanceShaderBindingTableRecordOffset;
+  XXH64_hash_t AccelManager::BlasBucket::getCompatibilityKey(const RtInstance& instance) {
+    const VkAccelerationStructureInstanceKHR& vkInstance = instance.getVkInstance();
+    const uint64_t key[] = {
+      vkInstance.mask,
+      vkInstance.instanceShaderBindingTableRecordOffset,
+      vkInstance.instanceCustomIndex & ~uint32_t(CUSTOM_INDEX_SURFACE_MASK),
+      vkInstance.flags,
+      instance.usesUnorderedApproximations(),
+      instance.isSubsurface()
+    };
 
-    if (!geometries.empty()) {
-      if (instanceMask != geometryInstanceMask) {
-        return false;
-      }
-      if (instanceShaderBindingTableRecordOffset != geometryInstanceShaderBindingTableRecordOffset) {
-        return false;
-      }
-      if (customIndexFlags != geometryCustomIndexFlags) {
-        return false;
-      }
-      if (instanceFlags != geometryInstanceFlags) {
-        return false;
-      }
-      if (usesUnorderedApproximations != geometryUsesUnorderedApproximations) {
-        return false;
-      }
-      if (hasSssInstances != instance->isSubsurface()) {
-        return false;
-      }
-    }
+    return XXH3_64bits(key, sizeof(key));
+  }
 
+  void AccelManager::BlasBucket::addInstance(RtInstance* instance) {
     BlasEntry* blasEntry = instance->getBlas();
 
     geometries.insert(geometries.end(), blasEntry->buildGeometries.begin(), blasEntry->buildGeometries.end());
@@ -163,13 +152,65 @@ namespace dxvk {
     instanceBillboardIndices.insert(instanceBillboardIndices.end(), instance->billboardIndices.begin(), instance->billboardIndices.end());
     indexOffsets.insert(indexOffsets.end(), instance->indexOffsets.begin(), instance->indexOffsets.end());
 
-    instanceShaderBindingTableRecordOffset = geometryInstanceShaderBindingTableRecordOffset;
-    instanceMask = geometryInstanceMask;
-    customIndexFlags = geometryCustomIndexFlags;
-    instanceFlags = geometryInstanceFlags;
-    usesUnorderedApproximations = geometryUsesUnorderedApproximations;
+    instanceShaderBindingTableRecordOffset = instance->getVkInstance().instanceShaderBindingTableRecordOffset;
+    instanceMask = instance->getVkInstance().mask;
+    customIndexFlags = instance->getVkInstance().instanceCustomIndex & ~uint32_t(CUSTOM_INDEX_SURFACE_MASK);
+    instanceFlags = instance->getVkInstance().flags;
+    usesUnorderedApproximations = instance->usesUnorderedApproximations();
     hasSssInstances = instance->isSubsurface();
-    return true;
+  }
+
+  void AccelManager::BlasBucket::clear() {
+    geometries.clear();
+    ranges.clear();
+    originalInstances.clear();
+    primitiveCounts.clear();
+    instanceBillboardIndices.clear();
+    indexOffsets.clear();
+    reorderedSurfacesOffset = UINT32_MAX;
+    hasOmmInstances = false;
+  }
+
+  // Hash of everything in an instance's merged geometries which can only change with a BLAS rebuild
+  static XXH64_hash_t getMergedBlasLayoutHash(const BlasEntry& blasEntry) {
+    XXH64_hash_t hash = kEmptyHash;
+
+    for (uint32_t i = 0; i < blasEntry.buildGeometries.size(); i++) {
+      const VkAccelerationStructureGeometryKHR& geometry = blasEntry.buildGeometries[i];
+      const VkAccelerationStructureGeometryTrianglesDataKHR& triangles = geometry.geometry.triangles;
+      const uint64_t layout[] = {
+        geometry.flags,
+        triangles.vertexFormat,
+        triangles.vertexStride,
+        triangles.maxVertex,
+        triangles.indexType,
+        blasEntry.buildRanges[i].primitiveCount
+      };
+
+      hash = XXH3_64bits_withSeed(layout, sizeof(layout), hash);
+    }
+
+    return hash;
+  }
+
+  // Hash of everything in an instance's merged geometries which a BLAS refit can pick up
+  static XXH64_hash_t getMergedBlasContentHash(const BlasEntry& blasEntry, const RtInstance& instance) {
+    XXH64_hash_t hash = XXH3_64bits(&instance.getVkInstance().transform, sizeof(VkTransformMatrixKHR));
+
+    for (uint32_t i = 0; i < blasEntry.buildGeometries.size(); i++) {
+      const VkAccelerationStructureGeometryTrianglesDataKHR& triangles = blasEntry.buildGeometries[i].geometry.triangles;
+      const VkAccelerationStructureBuildRangeInfoKHR& range = blasEntry.buildRanges[i];
+      const uint64_t content[] = {
+        triangles.vertexData.deviceAddress,
+        triangles.indexData.deviceAddress,
+        range.primitiveOffset,
+        range.firstVertex
+      };
+
+      hash = XXH3_64bits_withSeed(content, sizeof(content), hash);
+    }
+
+    return hash;
   }
 
   static void fillGeometryInfoFromBlasEntry(BlasEntry& blasEntry, RtInstance& instance, const OpacityMicromapManager* opacityMicromapManager) {
@@ -393,6 +434,53 @@ namespace dxvk {
     execBarriers.recordCommands(ctx->getCommandList());
   }
 
+  bool AccelManager::usesDynamicBlas(const BlasEntry& blasEntry, const RtInstance& instance) {
+    const uint32_t minPrimsInDynamicBLAS = std::max(RtxOptions::minPrimsInDynamicBLAS(), 100u);
+    const uint32_t maxPrimsForMergedBLAS = RtxOptions::maxPrimsInMergedBLAS();
+    const uint32_t blasPrims = blasEntry.modifiedGeometryData.calculatePrimitiveCount();
+
+    // Figure out if this blas should be a dynamic one
+    const bool requestDynamicBlas = instance.surface.instancesToObject != nullptr ||    // Point instancer geometry is replicated many times in a scene, we want to reuse the BLAS memory for these objects
+                                    blasEntry.input.getSkinningState().numBones != 0 || // Skinned meshes are always desirable to give a dynamic BLAS, since we'll want to make use of BVH update for performance reasons
+                                    blasEntry.getLinkedInstances().size() > 1  ||       // Meshes that are used in instances multiple times should benefit from BLAS reuse
+                                    blasEntry.dynamicBlas != nullptr ||                 // If we already have a dynamic BLAS, keep using it.
+                                    blasPrims > maxPrimsForMergedBLAS ||                // Avoid large meshes ending up in the merged BLAS which is built every frame.  # prims is proportional to build cost.
+                                    RtxOptions::minimizeBlasMerging();                  // Option to attempt putting as many objects into dynamic BLAS as possible.
+
+    const bool forceMergedBlas = (blasEntry.buildGeometries.size() > 1 ||                                        // Currently we use multiple build geometries for particle billboards, which we prefer to merge into large BLAS
+                                  (!RtxOptions::minimizeBlasMerging() && blasPrims < minPrimsInDynamicBLAS) ||   // Avoid creating lots of small dynamic BLAS
+                                  RtxOptions::forceMergeAllMeshes()) &&                                          // Setting to force all meshes into the merged BLAS
+                                    instance.surface.instancesToObject == nullptr;                               // Never merge point instancer geometry
+
+    return requestDynamicBlas && !forceMergedBlas;
+  }
+
+  AccelManager::BucketPlanner::Member AccelManager::getBlasBucketMember(const BlasEntry& blasEntry, const RtInstance& instance, uint32_t currentFrame) {
+    BucketPlanner::Member member;
+    member.instanceId = instance.getId();
+    member.compatibilityKey = BlasBucket::getCompatibilityKey(instance);
+    member.layoutHash = getMergedBlasLayoutHash(blasEntry);
+    member.contentHash = getMergedBlasContentHash(blasEntry, instance);
+    member.contentUpdated = blasEntry.frameLastUpdated == currentFrame;
+    member.worldBounds = blasEntry.input.getGeometryData().boundingBox.transform(instance.surface.objectToWorld);
+    member.primitiveCount = blasEntry.modifiedGeometryData.calculatePrimitiveCount();
+    return member;
+  }
+
+  void AccelManager::planBlasBuckets(BucketPlanner& planner, std::vector<Rc<PooledBlas>>& blasPool) {
+    BucketPlanner::SpatialSettings spatialSettings;
+    spatialSettings.enable = RtxOptions::enableSpatialBlasBucketing();
+    spatialSettings.maxExtent = RtxOptions::spatialBlasBucketMaxExtent();
+    spatialSettings.maxPrimitives = RtxOptions::spatialBlasBucketMaxPrims();
+    planner.setSpatialSettings(spatialSettings);
+
+    planner.plan([&blasPool](BlasBucket& bucket) {
+      if (bucket.blas != nullptr) {
+        blasPool.push_back(std::move(bucket.blas));
+      }
+    });
+  }
+
   void AccelManager::mergeInstancesIntoBlas(Rc<DxvkContext> ctx, 
                                             DxvkBarrierSet& execBarriers, 
                                             const std::vector<TextureRef>& textures,
@@ -417,11 +505,14 @@ namespace dxvk {
       Logger::debug("DxvkRaytrace: Vulkan Transform Buffer Realloc");
     }
 
-    std::vector<VkTransformMatrixKHR> instanceTransforms;
+    // Start a new frame for the scratch containers, the ones acquired last frame are no longer used
+    m_frameScratch.reset();
+
+    auto& instanceTransforms = m_frameScratch.acquire<VkTransformMatrixKHR>();
     instanceTransforms.reserve(instances.size());
 
-    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> blasToBuild;
-    std::vector<VkAccelerationStructureBuildRangeInfoKHR*> blasRangesToBuild;
+    auto& blasToBuild = m_frameScratch.acquire<VkAccelerationStructureBuildGeometryInfoKHR>();
+    auto& blasRangesToBuild = m_frameScratch.acquire<VkAccelerationStructureBuildRangeInfoKHR*>();
 
     blasToBuild.reserve(instances.size());
     blasRangesToBuild.reserve(instances.size());
@@ -447,13 +538,13 @@ namespace dxvk {
       opacityMicromapManager->onFrameStart(ctx);
     }
 
-    std::vector<std::unique_ptr<BlasBucket>> blasBuckets;
-    blasBuckets.reserve(instances.size());
+    m_blasBucketPlanner.clearMembers();
+    m_blasBucketMemberInstances.clear();
 
     size_t totalScratchMemory = 0;
 
     // NOTE: Would like to use the BLAS Linked instances here, but that misses viewmodel and virtual instances
-    std::unordered_map<BlasEntry*, std::vector<RtInstance*>> uniqueBlas;
+    m_dynamicBlasInstances.clear();
 
     for (RtInstance* instance : instances) {
       if (instance->isHidden()) {
@@ -494,31 +585,10 @@ namespace dxvk {
 
       fillGeometryInfoFromBlasEntry(*blasEntry, *instance, opacityMicromapManager);
 
-      const uint32_t minPrimsInDynamicBLAS = std::max(RtxOptions::minPrimsInDynamicBLAS(), 100u);
-      const uint32_t maxPrimsForMergedBLAS = RtxOptions::maxPrimsInMergedBLAS();
-      const uint32_t blasPrims = blasEntry->modifiedGeometryData.calculatePrimitiveCount();
-
-      // Figure out if this blas should be a dynamic one
-      const bool requestDynamicBlas = instance->surface.instancesToObject != nullptr ||    // Point instancer geometry is replicated many times in a scene, we want to reuse the BLAS memory for these objects
-                                      blasEntry->input.getSkinningState().numBones != 0 || // Skinned meshes are always desirable to give a dynamic BLAS, since we'll want to make use of BVH update for performance reasons
-                                      blasEntry->getLinkedInstances().size() > 1  ||       // Meshes that are used in instances multiple times should benefit from BLAS reuse
-                                      blasEntry->dynamicBlas != nullptr ||                 // If we already have a dynamic BLAS, keep using it.
-                                      blasPrims > maxPrimsForMergedBLAS ||                 // Avoid large meshes ending up in the merged BLAS which is built every frame.  # prims is proportional to build cost.
-                                      RtxOptions::minimizeBlasMerging();                   // Option to attempt putting as many objects into dynamic BLAS as possible.
-
-      const bool forceMergedBlas = (blasEntry->buildGeometries.size() > 1 ||                                       // Currently we use multiple build geometries for particle billboards, which we prefer to merge into large BLAS
-                                    (!RtxOptions::minimizeBlasMerging() && blasPrims < minPrimsInDynamicBLAS) ||   // Avoid creating lots of small dynamic BLAS
-                                    RtxOptions::forceMergeAllMeshes()) &&                                          // Setting to force all meshes into the merged BLAS
-                                      instance->surface.instancesToObject == nullptr;                              // Never merge point instancer geometry
-
-      if (requestDynamicBlas && !forceMergedBlas) {
+      if (usesDynamicBlas(*blasEntry, *instance)) {
         // Since this loop is iterating over instances, and instances can share BLAS, we will build these later after identifying unique ones.
-        uniqueBlas[blasEntry].push_back(instance);
+        m_dynamicBlasInstances.emplace_back(blasEntry, instance);
       } else {
-        // Make sure we don't double up on blas entries, this should only happen if theres a bug
-        // TODO (REMIX-3996) will break the assumptions we make here about all instances in a BlasEntry having the same instancesToObject array
-        assert(uniqueBlas.find(blasEntry) == uniqueBlas.end());
-
         if (blasEntry->dynamicBlas != nullptr) {
           // Move the BLAS used by this geometry to the common pool.
           // This also ensures the dynamic blas resource that's still being used by previous TLAS is properly tracked for the next frame
@@ -535,35 +605,41 @@ namespace dxvk {
           geometry.geometry.triangles.transformData.deviceAddress = transformDeviceAddress;
         }
 
-        // Try to merge the instance into one of the blasBuckets
-        bool merged = false;
-        for (auto& bucket : blasBuckets) {
-          if (bucket->tryAddInstance(instance)) {
-            merged = true;
-            break;
-          }
-        }
-
-        // The instance couldn't be merged into any bucket - make a new one
-        if (!merged) {
-          auto newBucket = std::make_unique<BlasBucket>();
-          merged = newBucket->tryAddInstance(instance);
-          assert(merged);
-
-          blasBuckets.push_back(std::move(newBucket));
-        }
+        // Register the instance for merging, the buckets are assigned once all instances are known.
+        // Note: the transform address is not part of the content hash, it only depends on the instance's position in the table
+        // and is only read by builds, which happen whenever the transform itself changes.
+        m_blasBucketPlanner.addMember(getBlasBucketMember(*blasEntry, *instance, currentFrame));
+        m_blasBucketMemberInstances.push_back(instance);
 
         // Track the lifetime and states of the source geometry buffers
         trackBlasBuildResources(ctx, execBarriers, blasEntry);
       }
     }
 
+    // Group the instances by their dynamic BLAS, keeping the instance table order within a group
+    std::stable_sort(m_dynamicBlasInstances.begin(), m_dynamicBlasInstances.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+#ifndef NDEBUG
+    // Make sure we don't double up on blas entries, this should only happen if theres a bug
+    // TODO (REMIX-3996) will break the assumptions we make here about all instances in a BlasEntry having the same instancesToObject array
+    for (RtInstance* instance : m_blasBucketMemberInstances) {
+      const auto iter = std::lower_bound(m_dynamicBlasInstances.begin(), m_dynamicBlasInstances.end(), instance->getBlas(),
+                                         [](const auto& entry, BlasEntry* blasEntry) { return entry.first < blasEntry; });
+      assert(iter == m_dynamicBlasInstances.end() || iter->first != instance->getBlas());
+    }
+#endif
+
     // Build/Update the dynamic BLAS
-    for (const std::pair<BlasEntry*, std::vector<RtInstance*>> pair : uniqueBlas) {
-      BlasEntry* blasEntry = pair.first;
-      if (pair.second.size() == 0) {
-        continue;
+    for (uint32_t groupStart = 0, groupEnd = 0; groupStart < m_dynamicBlasInstances.size(); groupStart = groupEnd) {
+      BlasEntry* blasEntry = m_dynamicBlasInstances[groupStart].first;
+
+      m_dynamicBlasLinkedInstances.clear();
+      for (groupEnd = groupStart; groupEnd < m_dynamicBlasInstances.size() && m_dynamicBlasInstances[groupEnd].first == blasEntry; groupEnd++) {
+        m_dynamicBlasLinkedInstances.push_back(m_dynamicBlasInstances[groupEnd].second);
       }
+
+      const std::vector<RtInstance*>& linkedInstances = m_dynamicBlasLinkedInstances;
       assert(blasEntry->buildGeometries.size() == 1); // dynamic BLAS should always have this
       assert(blasEntry->buildRanges.size() == 1); // dynamic BLAS should always have this
 
@@ -573,10 +649,10 @@ namespace dxvk {
         // Check validity of a built BLAS, only if:
         // We can only support OMM on dynamic BLAS whos surface is unique to that BLAS.  This is so we can benefit from instancing BLAS memory.  
         // In cases where there are multiple linked instances each with different surfaces OMM would break.
-        bool ommsCompatible = pair.second.size() == 1;
-        const XXH64_hash_t firstOmmHash = OpacityMicromapManager::getOpacityMicromapHash(*pair.second[0]);
-        for (uint32_t i = 1; i < pair.second.size(); i++) {
-          const XXH64_hash_t thisOmmHash = OpacityMicromapManager::getOpacityMicromapHash(*pair.second[i]);
+        bool ommsCompatible = linkedInstances.size() == 1;
+        const XXH64_hash_t firstOmmHash = OpacityMicromapManager::getOpacityMicromapHash(*linkedInstances[0]);
+        for (uint32_t i = 1; i < linkedInstances.size(); i++) {
+          const XXH64_hash_t thisOmmHash = OpacityMicromapManager::getOpacityMicromapHash(*linkedInstances[i]);
           if (thisOmmHash != firstOmmHash) {
             ommsCompatible = false;
             break;
@@ -584,7 +660,7 @@ namespace dxvk {
         }
 
         if (ommsCompatible) {
-          RtInstance* exemplarInstance = pair.second[0];
+          RtInstance* exemplarInstance = linkedInstances[0];
 
           // Bind opacity micromap
           // Opacity micromaps must be bound before acceleration sizes are calculated
@@ -668,7 +744,7 @@ namespace dxvk {
         copyAccelerationStructureBuildGeometryInfo(buildInfo, selectedBlas->buildInfo);
       }
 
-      for (RtInstance* rtInstance : pair.second) {
+      for (RtInstance* rtInstance : linkedInstances) {
         // Append an instance of this merged BLAS to the merged instance list
         if (rtInstance->surface.instancesToObject == nullptr) {
           addBlas(rtInstance, blasEntry, nullptr);
@@ -701,20 +777,33 @@ namespace dxvk {
       VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
       VK_ACCESS_SHADER_READ_BIT);
 
+    // Assign the merged instances to buckets, BLASes of buckets which are gone go back to the pool
+    planBlasBuckets(m_blasBucketPlanner, m_blasPool);
+
     // Collect all the surfaces
-    for (const auto& blasBucket : blasBuckets) {
+    for (uint32_t i = 0; i < m_blasBucketPlanner.getBucketCount(); i++) {
+      auto& bucket = m_blasBucketPlanner.getBucket(i);
+      BlasBucket& blasBucket = bucket.data;
+
+      // Fill the bucket in the planned order, which stays the same while the bucket's members do
+      blasBucket.clear();
+      for (uint32_t member : bucket.getMembers()) {
+        blasBucket.addInstance(m_blasBucketMemberInstances[member]);
+      }
+
       // Store the offset to use it later during blas instance creation
-      blasBucket->reorderedSurfacesOffset = static_cast<uint32_t>(m_reorderedSurfaces.size());
+      blasBucket.reorderedSurfacesOffset = static_cast<uint32_t>(m_reorderedSurfaces.size());
 
       // Append the bucket's instances to the reordered surface list
-      m_reorderedSurfaces.insert(m_reorderedSurfaces.end(), blasBucket->originalInstances.begin(), blasBucket->originalInstances.end());
-      m_reorderedSurfacesFirstIndexOffset.insert(m_reorderedSurfacesFirstIndexOffset.end(), blasBucket->indexOffsets.begin(), blasBucket->indexOffsets.end());
+      m_reorderedSurfaces.insert(m_reorderedSurfaces.end(), blasBucket.originalInstances.begin(), blasBucket.originalInstances.end());
+      m_reorderedSurfacesFirstIndexOffset.insert(m_reorderedSurfacesFirstIndexOffset.end(), blasBucket.indexOffsets.begin(), blasBucket.indexOffsets.end());
     }
 
     // Build prefix sum array
     // Collect primitive count for each surface object
     // Because we use exclusive prefix sum here, we add one more element to record the scene's total primitive count
-    m_reorderedSurfacesPrimitiveIDPrefixSumLastFrame = m_reorderedSurfacesPrimitiveIDPrefixSum;
+    // Note: swapping keeps both allocations around, instead of reallocating the last frame's array when it was smaller
+    std::swap(m_reorderedSurfacesPrimitiveIDPrefixSumLastFrame, m_reorderedSurfacesPrimitiveIDPrefixSum);
     m_reorderedSurfacesPrimitiveIDPrefixSum.resize(m_reorderedSurfaces.size() + 1);
     m_reorderedSurfacesPrimitiveIDPrefixSum[0] = 0;
     for (uint32_t i = 0; i < m_reorderedSurfaces.size(); i++) {
@@ -743,7 +832,7 @@ namespace dxvk {
     }
 
     buildBlases(ctx, execBarriers, cameraManager, opacityMicromapManager, instanceManager, 
-                textures, instances, blasBuckets, blasToBuild, blasRangesToBuild, totalScratchMemory);
+                textures, instances, m_blasBucketPlanner, blasToBuild, blasRangesToBuild, totalScratchMemory);
   }
 
   void AccelManager::addBlas(RtInstance* instance, BlasEntry* blasEntry, const Matrix4* instanceToObject) {
@@ -782,83 +871,113 @@ namespace dxvk {
   }
 
   void AccelManager::createBlasBuffersAndInstances(Rc<DxvkContext> ctx, 
-                                                   const std::vector<std::unique_ptr<BlasBucket>>& blasBuckets,
+                                                   BucketPlanner& blasBuckets,
                                                    std::vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
                                                    std::vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
                                                    size_t& totalScratchMemory) {
 
     const uint32_t currentFrame = m_device->getCurrentFrameId();
 
-    // Create or find a matching BLAS for each bucket, then build it
-    for (const auto& bucket : blasBuckets) {
-      // Fill out the build info
-      VkAccelerationStructureBuildGeometryInfoKHR buildInfo {};
-      buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
-      buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-      buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR | additionalAccelerationStructureFlags();
-      buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-      buildInfo.geometryCount = bucket->geometries.size();
-      buildInfo.pGeometries = bucket->geometries.data();
+    // Build, refit or reuse the BLAS of each bucket
+    for (uint32_t bucketIndex = 0; bucketIndex < blasBuckets.getBucketCount(); bucketIndex++) {
+      auto& plannedBucket = blasBuckets.getBucket(bucketIndex);
+      BlasBucket* bucket = &plannedBucket.data;
 
-      // Calculate the build sizes for this bucket
-      VkAccelerationStructureBuildSizesInfoKHR sizeInfo {};
-      sizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-      m_device->vkd()->vkGetAccelerationStructureBuildSizesKHR(m_device->handle(), VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
-                                                               &buildInfo, bucket->primitiveCounts.data(), &sizeInfo);
-
-      // Try to find an existing BLAS that is minimally sufficient to fit this bucket of geometries
-      PooledBlas* selectedBlas = nullptr;
-      for (const auto& blas : m_blasPool) {
-        size_t bufferSize = blas->accelStructure->info().size;
-        uint32_t paddedLastTouched = blas->frameLastTouched + 1 + (RtxOptions::enablePreviousTLAS() ? 1u : 0u); /* note: +2 because frameLastTouched is unsigned and init'd with UINT32_MAX, and keep the BLAS'es for one extra frame for previous TLAS access */
-        if (bufferSize >= sizeInfo.accelerationStructureSize &&
-            (!selectedBlas || bufferSize < selectedBlas->accelStructure->info().size) &&
-            paddedLastTouched <= currentFrame) {
-          selectedBlas = blas.ptr();
-        }
+      if (bucket->blas == nullptr) {
+        blasBuckets.forceBuild(plannedBucket);
       }
 
-      // Must ensure that if we are updating an existing blas, rather than rebuilding, the blas is compatible with our new build info
-      // Cannot update a blas that contains OMM instances, this leads to sporadic device lost errors
-      if (!bucket->hasOmmInstances && selectedBlas && validateUpdateMode(selectedBlas->buildInfo, buildInfo) && selectedBlas->primitiveCounts == bucket->primitiveCounts) {
-        buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
-      }
+      if (plannedBucket.getAction() != BucketPlanner::Action::Reuse) {
+        // Fill out the build info
+        VkAccelerationStructureBuildGeometryInfoKHR buildInfo {};
+        buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+        buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+        buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR | additionalAccelerationStructureFlags();
+        buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+        buildInfo.geometryCount = bucket->geometries.size();
+        buildInfo.pGeometries = bucket->geometries.data();
+
+        // Calculate the build sizes for this bucket
+        VkAccelerationStructureBuildSizesInfoKHR sizeInfo {};
+        sizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+        m_device->vkd()->vkGetAccelerationStructureBuildSizesKHR(m_device->handle(), VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                                                 &buildInfo, bucket->primitiveCounts.data(), &sizeInfo);
+
+        // Must ensure that if we are updating the bucket's blas, rather than rebuilding, the blas is compatible with our new build info
+        if (plannedBucket.getAction() == BucketPlanner::Action::Refit &&
+            (!validateUpdateMode(bucket->blas->buildInfo, buildInfo) || bucket->blas->primitiveCounts != bucket->primitiveCounts)) {
+          blasBuckets.forceBuild(plannedBucket);
+        }
+
+        const bool update = plannedBucket.getAction() == BucketPlanner::Action::Refit;
+        Rc<PooledBlas> previousBlas = std::move(bucket->blas);
+
+        // The previous TLAS may still reference the bucket's BLAS, in which case it must not be written to.
+        // Updates then read from the previous BLAS and write to another one of the same size.
+        if (update && !RtxOptions::enablePreviousTLAS()) {
+          bucket->blas = std::move(previousBlas);
+        } else {
+          if (previousBlas != nullptr) {
+            // Move the BLAS to the common pool, so that it is kept alive while the previous TLAS uses it
+            m_blasPool.push_back(previousBlas);
+          }
 
-      // There is no such BLAS - create one and put it into the pool
-      if (!selectedBlas) {
-        auto newBlas = createPooledBlas(sizeInfo.accelerationStructureSize, "BLAS Merged");
+          // Try to find an existing BLAS that is minimally sufficient to fit this bucket of geometries
+          uint32_t selectedIndex = UINT32_MAX;
+          for (uint32_t i = 0; i < m_blasPool.size(); i++) {
+            const Rc<PooledBlas>& blas = m_blasPool[i];
+            size_t bufferSize = blas->accelStructure->info().size;
+            uint32_t paddedLastTouched = blas->frameLastTouched + 1 + (RtxOptions::enablePreviousTLAS() ? 1u : 0u); /* note: +2 because frameLastTouched is unsigned and init'd with UINT32_MAX, and keep the BLAS'es for one extra frame for previous TLAS access */
+            if (bufferSize >= sizeInfo.accelerationStructureSize &&
+                (selectedIndex == UINT32_MAX || bufferSize < m_blasPool[selectedIndex]->accelStructure->info().size) &&
+                paddedLastTouched <= currentFrame) {
+              selectedIndex = i;
+            }
+          }
 
-        selectedBlas = newBlas.ptr();
+          if (selectedIndex != UINT32_MAX) {
+            // Take the BLAS out of the pool, it is owned by the bucket from now on
+            bucket->blas = std::move(m_blasPool[selectedIndex]);
+            std::swap(m_blasPool[selectedIndex], m_blasPool.back());
+            m_blasPool.pop_back();
+          } else {
+            // There is no such BLAS - create one
+            bucket->blas = createPooledBlas(sizeInfo.accelerationStructureSize, "BLAS Merged");
+          }
+        }
 
-        m_blasPool.push_back(std::move(newBlas));
-      }
-      assert(selectedBlas);
-      selectedBlas->frameLastTouched = currentFrame;
+        PooledBlas* selectedBlas = bucket->blas.ptr();
+        assert(selectedBlas);
 
-      // Use the selected BLAS for the build
-      buildInfo.dstAccelerationStructure = selectedBlas->accelStructure->getAccelStructure();
+        // Use the selected BLAS for the build
+        buildInfo.dstAccelerationStructure = selectedBlas->accelStructure->getAccelStructure();
 
-      if (buildInfo.mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR) {
-        // Set the src to the dst if we're updating
-        buildInfo.srcAccelerationStructure = buildInfo.dstAccelerationStructure;
-      }
+        if (update) {
+          buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+          buildInfo.srcAccelerationStructure = previousBlas != nullptr ? previousBlas->accelStructure->getAccelStructure() : buildInfo.dstAccelerationStructure;
+        }
+
+        copyAccelerationStructureBuildGeometryInfo(buildInfo, selectedBlas->buildInfo);
+        selectedBlas->primitiveCounts = bucket->primitiveCounts;
 
-      copyAccelerationStructureBuildGeometryInfo(buildInfo, selectedBlas->buildInfo);
-      selectedBlas->primitiveCounts = bucket->primitiveCounts;
+        // Allocate a scratch buffer slice
+        const size_t requiredScratchAllocSize = align(sizeInfo.buildScratchSize + m_scratchAlignment, m_scratchAlignment);
+        buildInfo.scratchData.deviceAddress = totalScratchMemory;
+        totalScratchMemory += requiredScratchAllocSize;
 
-      // Allocate a scratch buffer slice
-      const size_t requiredScratchAllocSize = align(sizeInfo.buildScratchSize + m_scratchAlignment, m_scratchAlignment);
-      buildInfo.scratchData.deviceAddress = totalScratchMemory;
-      totalScratchMemory += requiredScratchAllocSize;
+        assert(buildInfo.scratchData.deviceAddress % m_scratchAlignment == 0); // Note: Required by the Vulkan specification.
 
-      assert(buildInfo.scratchData.deviceAddress % m_scratchAlignment == 0); // Note: Required by the Vulkan specification.
+        // Track the lifetime of the BLAS buffers
+        ctx->getCommandList()->trackResource<DxvkAccess::Write>(selectedBlas->accelStructure);
 
-      // Track the lifetime of the BLAS buffers
-      ctx->getCommandList()->trackResource<DxvkAccess::Write>(selectedBlas->accelStructure);
+        // Put the merged BLAS into the build queue
+        blasToBuild.push_back(buildInfo);
+        blasRangesToBuild.push_back(bucket->ranges.data());
+      }
 
-      // Put the merged BLAS into the build queue
-      blasToBuild.push_back(buildInfo);
-      blasRangesToBuild.push_back(bucket->ranges.data());
+      PooledBlas* selectedBlas = bucket->blas.ptr();
+      selectedBlas->frameLastTouched = currentFrame;
+      ctx->getCommandList()->trackResource<DxvkAccess::Read>(selectedBlas->accelStructure);
 
       static float identityTransform[3][4] = {
         { 1.f, 0.f, 0.f, 0.f },
@@ -886,6 +1005,12 @@ namespace dxvk {
         }
       }
     }
+
+    const BucketPlanner::Stats& stats = blasBuckets.getStats();
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxMergedBlasBuilt, stats.built);
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxMergedBlasRefit, stats.refit);
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxMergedBlasReused, stats.reused);
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxMergedBlasSurfaceArea, static_cast<uint64_t>(stats.boundsSurfaceArea));
   }
 
   void AccelManager::prepareSceneData(Rc<DxvkContext> ctx, DxvkBarrierSet& execBarriers, InstanceManager& instanceManager) {
@@ -905,7 +1030,7 @@ namespace dxvk {
     createAndBuildIntersectionBlas(ctx, execBarriers);
 
     // Prepare billboard data and instances
-    std::vector<MemoryBillboard> memoryBillboards;
+    auto& memoryBillboards = m_frameScratch.acquire<MemoryBillboard>();
     uint32_t numActiveBillboards = 0;
 
     // Check the enablement here - because the instance manager needs to run the billboard analysis all the time
@@ -1062,7 +1187,7 @@ namespace dxvk {
 
     // Build surface index mapping for particle objects.
     surfaceInfoLists[currIndex].resize(m_reorderedSurfaces.size());
-    std::unordered_map<uint32_t, std::vector<int>> curMaterialHashToSurfaceMap;
+    auto& curMaterialSurfaces = m_frameScratch.acquire<MaterialSurface>();
     for (uint32_t surfaceIndex = 0; surfaceIndex < m_reorderedSurfaces.size(); surfaceIndex++) {
       RtInstance& surface = *m_reorderedSurfaces[surfaceIndex];
 
@@ -1080,13 +1205,19 @@ namespace dxvk {
           geometryData.boundingBox.getTransformedCentroid(surface.getTransform()) };
 
         if (surface.getBlas()->buildRanges.size() > 0 && surface.getBlas()->buildGeometries.size() > 0) {
-          curMaterialHashToSurfaceMap[surface.surface.surfaceMaterialIndex].push_back(surfaceIndex);
+          curMaterialSurfaces.push_back({ surface.surface.surfaceMaterialIndex, surfaceIndex });
         }
       } else {
         surfaceInfoLists[currIndex][surfaceIndex].surfaceMaterialIndex = kSurfaceInvalidSurfaceMaterialIndex;
       }
     }
 
+    // Group the candidates by material, keeping them in surface order within a material.
+    // Note: a sorted array instead of a map of lists, so that the lookup doesn't allocate memory every frame.
+    std::sort(curMaterialSurfaces.begin(), curMaterialSurfaces.end(), [](const MaterialSurface& a, const MaterialSurface& b) {
+      return a.surfaceMaterialIndex != b.surfaceMaterialIndex ? a.surfaceMaterialIndex < b.surfaceMaterialIndex : a.surfaceIndex < b.surfaceIndex;
+    });
+
     // Fix missed surface mapping by searching among objects with the same hash value, and choose the closest one.
     for (int i = 0; i < surfaceIndexMapping.size(); i++) {
       // Skip objects that have surface mapping
@@ -1100,18 +1231,18 @@ namespace dxvk {
 
       // Skip objects with different materials
       auto lastInfo = surfaceInfoLists[prevIndex][i];
-      auto pCandidateList = curMaterialHashToSurfaceMap.find(lastInfo.surfaceMaterialIndex);
-      if (pCandidateList == curMaterialHashToSurfaceMap.end()) {
+      const auto candidates = std::equal_range(curMaterialSurfaces.begin(), curMaterialSurfaces.end(), MaterialSurface { lastInfo.surfaceMaterialIndex, 0 },
+                                               [](const MaterialSurface& a, const MaterialSurface& b) { return a.surfaceMaterialIndex < b.surfaceMaterialIndex; });
+      if (candidates.first == candidates.second) {
         continue;
       }
 
-      auto& candidateList = pCandidateList->second;
       float minDistanceSq = FLT_MAX;
       int bestSurfaceID = -1;
 
       // Iterate through the candidate list and find the closest one
-      for (int ithCandidate = 0; ithCandidate < candidateList.size(); ithCandidate++) {
-        int curSurfaceID = candidateList[ithCandidate];
+      for (auto candidate = candidates.first; candidate != candidates.second; ++candidate) {
+        int curSurfaceID = candidate->surfaceIndex;
         RtInstance& surface = *m_reorderedSurfaces[curSurfaceID];
         if (surface.getBlas()->buildGeometries.size() == 0) {
           continue;
@@ -1136,7 +1267,7 @@ namespace dxvk {
     std::swap(currIndex, prevIndex);
   }
 
-  void AccelManager::uploadSurfaceData(Rc<DxvkContext> ctx) {
+  void AccelManager::uploadSurfaceData(Rc<DxvkContext> ctx, InstanceHotState& instanceHotState) {
     ScopedCpuProfileZone();
     if (m_reorderedSurfaces.empty()) {
       return;
@@ -1145,6 +1276,8 @@ namespace dxvk {
     // Simplify syntax for accessing the persistent containers
     auto& surfacesGPUData = uploadSurfaceDataFuncState.surfacesGPUData;
     auto& surfaceIndexMapping = uploadSurfaceDataFuncState.surfaceIndexMapping;
+    auto& instanceSlots = uploadSurfaceDataFuncState.instanceSlots;
+    auto& mappingTypes = uploadSurfaceDataFuncState.mappingTypes;
 
     // Surface buffer
     const auto surfacesGPUSize = m_reorderedSurfaces.size() * kSurfaceGPUSize;
@@ -1167,6 +1300,8 @@ namespace dxvk {
     // Write surface data
     std::size_t dataOffset = 0;
     surfacesGPUData.resize(surfacesGPUSize);
+    instanceSlots.resize(m_reorderedSurfaces.size());
+    mappingTypes.resize(m_reorderedSurfaces.size());
 
     for (uint32_t i = 0; i < m_reorderedSurfaces.size(); ++i) {
       const auto& currentInstance = *m_reorderedSurfaces[i];
@@ -1183,10 +1318,20 @@ namespace dxvk {
         currentSurface.firstIndex -= m_reorderedSurfacesFirstIndexOffset[i];
       }
 
+      // Gather what the surface index mapping pass below needs, so that it only reads dense arrays
+      instanceSlots[i] = currentInstance.getVectorIdx();
+      if (currentSurface.instancesToObject) {
+        mappingTypes[i] = SurfaceMappingType::PointInstancer;
+      } else if (currentInstance.getBillboardCount() > 0) {
+        mappingTypes[i] = SurfaceMappingType::Billboard;
+      } else {
+        mappingTypes[i] = SurfaceMappingType::Regular;
+      }
+
       // Find the size of the surface mapping buffer
       // Skip SURFACE_INDEX_INVALID (new instances with no previous-frame data) to avoid
       // oversizing the mapping vector 
-      const uint32_t prevIdx = currentInstance.getPreviousSurfaceIndex();
+      const uint32_t prevIdx = instanceHotState.getPreviousSurfaceIndex(instanceSlots[i]);
       if (prevIdx != SURFACE_INDEX_INVALID) {
         maxPreviousSurfaceIndex = std::max(maxPreviousSurfaceIndex, prevIdx);
       }
@@ -1214,27 +1359,29 @@ namespace dxvk {
     // entered m_reorderedSurfaces via addBlas or bucket insertion rather than the
     // early setSurfaceIndex path for zero-mask OMM/billboard instances).
     // Also populate the previous-->current frame surface index mapping.
+    auto mapPreviousSurfaceIndex = [&](uint32_t slot, uint32_t surfaceIndex) {
+      const uint32_t previousSurfaceIndex = instanceHotState.getPreviousSurfaceIndex(slot);
+      if (previousSurfaceIndex != SURFACE_INDEX_INVALID) {
+        surfaceIndexMapping[previousSurfaceIndex] = surfaceIndex;
+      }
+      instanceHotState.setPreviousSurfaceIndex(slot, surfaceIndex);
+    };
+
     for (uint32_t surfaceIndex = 0; surfaceIndex < m_reorderedSurfaces.size(); surfaceIndex++) {
-      RtInstance& surface = *m_reorderedSurfaces[surfaceIndex];
+      const uint32_t slot = instanceSlots[surfaceIndex];
 
-      if (surface.getSurfaceIndex() == SURFACE_INDEX_INVALID) {
-        surface.setSurfaceIndex(surfaceIndex);
+      if (instanceHotState.getSurfaceIndex(slot) == SURFACE_INDEX_INVALID) {
+        instanceHotState.setSurfaceIndex(slot, surfaceIndex);
 
         // For PointInstancers, all instances share a single surface entry
-        if (surface.surface.instancesToObject) {
-          assert(surfaceIndex == surface.surface.surfaceIndexOfFirstInstance);
-          if (surface.getPreviousSurfaceIndex() != SURFACE_INDEX_INVALID) {
-            surfaceIndexMapping[surface.getPreviousSurfaceIndex()] = surfaceIndex;
-          }
-          surface.setPreviousSurfaceIndex(surfaceIndex);
+        if (mappingTypes[surfaceIndex] == SurfaceMappingType::PointInstancer) {
+          assert(surfaceIndex == m_reorderedSurfaces[surfaceIndex]->surface.surfaceIndexOfFirstInstance);
+          mapPreviousSurfaceIndex(slot, surfaceIndex);
         }
       }
 
-      if (surface.getBillboardCount() == 0 && !surface.surface.instancesToObject) {
-        if (surface.getPreviousSurfaceIndex() != SURFACE_INDEX_INVALID) {
-          surfaceIndexMapping[surface.getPreviousSurfaceIndex()] = surfaceIndex;
-        }
-        surface.setPreviousSurfaceIndex(surfaceIndex);
+      if (mappingTypes[surfaceIndex] == SurfaceMappingType::Regular) {
+        mapPreviousSurfaceIndex(slot, surfaceIndex);
       }
     }
 
@@ -1273,33 +1420,57 @@ namespace dxvk {
                                  DxvkBarrierSet& execBarriers,
                                  const CameraManager& cameraManager,
                                  OpacityMicromapManager* opacityMicromapManager,
-                                 const InstanceManager& instanceManager,
+                                 InstanceManager& instanceManager,
                                  const std::vector<TextureRef>& textures,
                                  const std::vector<RtInstance*>& instances,
-                                 const std::vector<std::unique_ptr<BlasBucket>>& blasBuckets,
+                                 BucketPlanner& blasBuckets,
                                  std::vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
                                  std::vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
                                  size_t& totalScratchMemory) {
     ScopedGpuProfileZone(ctx, "buildBLAS");
     // Upload surfaces before opacity micromap generation which reads the surface data on the GPU
-    uploadSurfaceData(ctx);
+    uploadSurfaceData(ctx, instanceManager.getHotState());
 
     // Build and bind opacity micromaps
     if (opacityMicromapManager && opacityMicromapManager->isActive()) {
       opacityMicromapManager->buildOpacityMicromaps(ctx, textures, cameraManager.getLastCameraCutFrameId());
 
       // Bind opacity micromaps
-      for (auto& blasBucket : blasBuckets) {
-        for (uint32_t i = 0; i < blasBucket->geometries.size(); i++) {
-          auto ommSourceHash = opacityMicromapManager->tryBindOpacityMicromap(ctx, *blasBucket->originalInstances[i], blasBucket->instanceBillboardIndices[i],
-                                                         blasBucket->geometries[i], instanceManager);
+      for (uint32_t bucketIndex = 0; bucketIndex < blasBuckets.getBucketCount(); bucketIndex++) {
+        auto& bucket = blasBuckets.getBucket(bucketIndex);
+        BlasBucket& blasBucket = bucket.data;
+        XXH64_hash_t opacityMicromapHash = kEmptyHash;
+
+        for (uint32_t i = 0; i < blasBucket.geometries.size(); i++) {
+          auto ommSourceHash = opacityMicromapManager->tryBindOpacityMicromap(ctx, *blasBucket.originalInstances[i], blasBucket.instanceBillboardIndices[i],
+                                                         blasBucket.geometries[i], instanceManager);
           if (ommSourceHash != kEmptyHash) {
-            blasBucket->hasOmmInstances = true;
+            blasBucket.hasOmmInstances = true;
+
+            const XXH64_hash_t boundOmm[] = { i, ommSourceHash };
+            opacityMicromapHash = XXH64(boundOmm, sizeof(boundOmm), opacityMicromapHash);
           }
         }
+
+        // A BLAS needs to be rebuilt when its opacity micromaps changed.
+        // BLASes with OMM instances can't be refit either, this leads to sporadic device lost errors.
+        if (opacityMicromapHash != blasBucket.opacityMicromapHash ||
+            (blasBucket.hasOmmInstances && bucket.getAction() == BucketPlanner::Action::Refit)) {
+          blasBuckets.forceBuild(bucket);
+        }
+        blasBucket.opacityMicromapHash = opacityMicromapHash;
       }
 
       opacityMicromapManager->onBlasBuild(ctx);
+    } else {
+      // Rebuild BLASes which were built with opacity micromaps that are no longer bound
+      for (uint32_t bucketIndex = 0; bucketIndex < blasBuckets.getBucketCount(); bucketIndex++) {
+        auto& bucket = blasBuckets.getBucket(bucketIndex);
+        if (bucket.data.opacityMicromapHash != kEmptyHash) {
+          blasBuckets.forceBuild(bucket);
+          bucket.data.opacityMicromapHash = kEmptyHash;
+        }
+      }
     }
 
     // Blas buffers must be created after opacity micromaps were generated to calculate correct acceleration structure sizes
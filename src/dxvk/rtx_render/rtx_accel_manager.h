@@ -30,6 +30,11 @@
 #include "rtx_common_object.h"
 #include "rtx_staging.h"
 #include "rtx_point_instancer_system.h"
+#include "rtx_instance_hot_state.h"
+#include "rtx_blas_bucket_planner.h"
+#include "rtx_frame_scratch.h"
+#include "rtx/utility/shader_types.h"
+#include "rtx/concept/billboard.h"
 #include "../util/util_vector.h"
 #include "../util/util_matrix.h"
 
@@ -59,14 +64,24 @@ class AccelManager : public CommonDeviceObject {
     uint32_t reorderedSurfacesOffset = UINT32_MAX;
     bool hasOmmInstances = false;
     bool hasSssInstances = false;
-    
-    // Tries to add a geometry instance to the bucket. The addition is successful if either:
-    //   a) the bucket is empty,
-    //   b) the instance has the same mask etc. as all other instances in the bucket.
-    bool tryAddInstance(RtInstance* instance);
+
+    // Merged BLAS of the bucket, kept across frames so that it can be refit or reused while the bucket's members don't change
+    Rc<PooledBlas> blas;
+    XXH64_hash_t opacityMicromapHash = kEmptyHash; // Combined source hash of the opacity micromaps bound to the bucket's geometries
+
+    // Appends a geometry instance to the bucket. All instances in a bucket must have the same mask etc.,
+    // which is guaranteed by the planner assigning buckets by getCompatibilityKey().
+    void addInstance(RtInstance* instance);
+
+    // Removes all instances from the bucket, the BLAS and the allocations are kept
+    void clear();
+
+    static XXH64_hash_t getCompatibilityKey(const RtInstance& instance);
   };
 
 public:
+  using BucketPlanner = BlasBucketPlanner<BlasBucket>;
+
   AccelManager(AccelManager const&) = delete;
   AccelManager& operator=(AccelManager const&) = delete;
 
@@ -97,7 +112,7 @@ public:
   void prepareSceneData(Rc<DxvkContext> ctx, class DxvkBarrierSet& execBarriers, InstanceManager& instanceManager);
 
   // Uploads instances' surface data to the GPU
-  void uploadSurfaceData(Rc<DxvkContext> ctx);
+  void uploadSurfaceData(Rc<DxvkContext> ctx, InstanceHotState& instanceHotState);
 
   // Merges the RtInstance's into a set of BLAS. Some of the BLAS will contain multiple geometries/instances,
   // and some other BLAS will be dedicated to instances with static geometries.
@@ -116,9 +131,23 @@ public:
   // Returns the number of live BLAS objects
   static uint32_t getBlasCount();
 
+  // Returns how many merged BLASes were built, refit and reused this frame
+  const BucketPlanner::Stats& getBlasBucketStats() const { return m_blasBucketPlanner.getStats(); }
+
   uint32_t getSurfaceCount() const { return m_reorderedSurfaces.size(); }
   const std::vector<RtInstance*>& getOrderedInstances() const { return m_reorderedSurfaces; }
 
+  // The CPU side of merged BLAS planning done by mergeInstancesIntoBlas(), usable without a device (i.e. in benchmarks).
+  // The BLAS entry's build geometries and ranges must be filled in for the instance.
+
+  // Returns true if the instance gets a BLAS of its own instead of going into a merged one
+  static bool usesDynamicBlas(const BlasEntry& blasEntry, const RtInstance& instance);
+
+  static BucketPlanner::Member getBlasBucketMember(const BlasEntry& blasEntry, const RtInstance& instance, uint32_t currentFrame);
+
+  // Assigns the planner's members to buckets with the current spatial bucketing options, BLASes of removed buckets go to blasPool
+  static void planBlasBuckets(BucketPlanner& planner, std::vector<Rc<PooledBlas>>& blasPool);
+
 private:
   struct SurfaceInfo {
     uint32_t surfaceMaterialIndex;
@@ -132,17 +161,26 @@ private:
     uint32_t prevIndex = 1;
   } buildParticleSurfaceMappingFuncState;
 
+  // How an instance's previous frame surface index is remapped to the current frame
+  enum class SurfaceMappingType : uint8_t {
+    Regular,
+    PointInstancer, // Mapped once, by the surface entry of the first instance
+    Billboard       // Mapped per billboard by buildParticleSurfaceMapping()
+  };
+
   // Persistent containers to reduce frame to frame reallocations in ::uploadSurfaceData()
   struct {
     std::vector<unsigned char> surfacesGPUData;
     std::vector<uint32_t> surfaceIndexMapping;
+    std::vector<uint32_t> instanceSlots;                // Instance hot state slot of each reordered surface
+    std::vector<SurfaceMappingType> mappingTypes;
     uint32_t previousFrameSurfaceCount = 0; // Tracks last frame's surface count for mapping coverage
   } uploadSurfaceDataFuncState;
 
   void buildBlases(Rc<DxvkContext> ctx, DxvkBarrierSet& execBarriers,
-                   const CameraManager& cameraManager, OpacityMicromapManager* opacityMicromapManager, const InstanceManager& instanceManager,
+                   const CameraManager& cameraManager, OpacityMicromapManager* opacityMicromapManager, InstanceManager& instanceManager,
                    const std::vector<TextureRef>& textures, const std::vector<RtInstance*>& instances,
-                   const std::vector<std::unique_ptr<BlasBucket>>& blasBuckets, 
+                   BucketPlanner& blasBuckets,
                    std::vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
                    std::vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
                    size_t& currentScratchOffset);
@@ -151,7 +189,7 @@ private:
   void addPointInstancerBlas(RtInstance* rtInstance, BlasEntry* blasEntry);
 
   void createBlasBuffersAndInstances(Rc<DxvkContext> ctx, 
-                                     const std::vector<std::unique_ptr<BlasBucket>>& blasBuckets,
+                                     BucketPlanner& blasBuckets,
                                      std::vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
                                      std::vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
                                      size_t& currentScratchOffset);
@@ -160,6 +198,20 @@ private:
 
   void buildParticleSurfaceMapping(std::vector<uint32_t>& surfaceIndexMapping);
 
+  // Surface index of a particle object, sorted by material to find the candidates for a missed surface mapping
+  struct MaterialSurface {
+    uint32_t surfaceMaterialIndex;
+    uint32_t surfaceIndex;
+  };
+
+  // Containers for data only needed while building the acceleration structures, reset at the start of every frame
+  // in ::mergeInstancesIntoBlas() and kept allocated, so that steady frames don't allocate memory
+  FrameScratchArena<VkTransformMatrixKHR,
+                    VkAccelerationStructureBuildGeometryInfoKHR,
+                    VkAccelerationStructureBuildRangeInfoKHR*,
+                    MemoryBillboard,
+                    MaterialSurface> m_frameScratch;
+
   bool validateUpdateMode(const VkAccelerationStructureBuildGeometryInfoKHR& oldInfo, const VkAccelerationStructureBuildGeometryInfoKHR& newInfo);
 
   std::vector<RtInstance*> m_reorderedSurfaces;
@@ -169,6 +221,12 @@ private:
   std::vector<VkAccelerationStructureInstanceKHR> m_mergedInstances[Tlas::Count];
   std::vector<Rc<PooledBlas>> m_blasPool;
 
+  // Buckets of the instances merged into shared BLASes, persistent so that unchanged buckets are not rebuilt every frame
+  BucketPlanner m_blasBucketPlanner;
+  std::vector<RtInstance*> m_blasBucketMemberInstances;                 // Instance of each planner member
+  std::vector<std::pair<BlasEntry*, RtInstance*>> m_dynamicBlasInstances; // Instances using a dynamic BLAS, grouped by BLAS entry
+  std::vector<RtInstance*> m_dynamicBlasLinkedInstances;
+
   // GPU-driven PointInstancer culling batches, recorded per frame in mergeInstancesIntoBlas
   std::vector<PointInstancerBatch> m_pointInstancerBatches;
 
@@ -0,0 +1,435 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../../util/util_bounding_box.h"
+#include "../../util/util_fast_cache.h"
+#include "../../util/xxHash/xxhash.h"
+#include "rtx_constants.h"
+
+namespace dxvk {
+
+// Assigns the instances going into merged BLASes to buckets and decides how each bucket's BLAS is brought up to date.
+// Instances which can share a BLAS (same mask, flags, etc., summarized by a compatibility key) share a bucket.
+// Buckets persist across frames: a bucket keeps its geometry order as long as its members stay the same, which
+// lets its BLAS be refit when only the members' contents (transforms, vertex data) changed, or be reused as is
+// when nothing changed at all. Only buckets whose member set or geometry layout changed are rebuilt.
+// With spatial bucketing enabled, compatible instances are additionally ordered along a Morton curve of their
+// world bounds and split into buckets of limited extent and primitive count, so that merged BLASes overlap less.
+// Independent of Vulkan so that it can be tested on the CPU, BucketData is stored per bucket for the caller.
+template<typename BucketData>
+class BlasBucketPlanner {
+public:
+  struct Member {
+    uint64_t instanceId;
+    XXH64_hash_t compatibilityKey;
+    XXH64_hash_t layoutHash;    // Everything which requires a rebuild when changed (geometry counts, formats, flags)
+    XXH64_hash_t contentHash;   // Everything which can be refit (buffer addresses, transform)
+    bool contentUpdated;        // Geometry data was rewritten in place this frame
+    AxisAlignedBoundingBox worldBounds;
+    uint32_t primitiveCount;
+  };
+
+  struct SpatialSettings {
+    bool enable = false;
+    float maxExtent = 0.f;      // Maximum size of a bucket's bounds along any axis, in world units
+    uint32_t maxPrimitives = 0; // Maximum number of primitives in a bucket, 0 for no limit
+  };
+
+  enum class Action : uint8_t {
+    Build,
+    Refit,
+    Reuse
+  };
+
+  struct Stats {
+    uint32_t built = 0;
+    uint32_t refit = 0;
+    uint32_t reused = 0;
+    // Sum of the surface areas of all buckets' bounds, a proxy for the traversal cost of overlapping merged BLASes
+    double boundsSurfaceArea = 0.0;
+  };
+
+  class Bucket {
+  public:
+    BucketData data;
+
+    XXH64_hash_t getCompatibilityKey() const { return m_compatibilityKey; }
+
+    // World bounds of this frame's members
+    const AxisAlignedBoundingBox& getBounds() const { return m_bounds; }
+
+    // Indices of this frame's members, in the order their geometries go into the BLAS
+    const std::vector<uint32_t>& getMembers() const { return m_members; }
+
+    Action getAction() const { return m_action; }
+
+  private:
+    friend class BlasBucketPlanner;
+
+    XXH64_hash_t m_key = 0;
+    XXH64_hash_t m_compatibilityKey = 0;
+    AxisAlignedBoundingBox m_bounds;
+    XXH64_hash_t m_membershipHash = 0;
+    XXH64_hash_t m_contentHash = 0;
+    bool m_isNew = true;
+    Action m_action = Action::Build;
+    std::vector<uint32_t> m_members;
+    std::vector<uint64_t> m_memberIds;                            // Instance ids of the members in geometry order
+    std::vector<std::pair<uint64_t, uint32_t>> m_sortedMemberIds; // Instance id and position of the members, sorted by id
+  };
+
+  void clearMembers() {
+    m_members.clear();
+  }
+
+  // Adds an instance for this frame's plan, returns its member index
+  uint32_t addMember(const Member& member) {
+    m_members.push_back(member);
+    return static_cast<uint32_t>(m_members.size() - 1);
+  }
+
+  const Member& getMember(uint32_t index) const {
+    return m_members[index];
+  }
+
+  // Takes effect with the next plan(). Changing the settings regroups the instances, and so rebuilds affected buckets.
+  void setSpatialSettings(const SpatialSettings& settings) {
+    m_spatialSettings = settings;
+  }
+
+  // Assigns this frame's members to buckets and picks each bucket's action.
+  // onRemove(BucketData&) is invoked for buckets which no longer have any members, right before they are destroyed.
+  template<typename OnRemove>
+  void plan(OnRemove onRemove) {
+    for (Bucket& bucket : m_buckets) {
+      bucket.m_members.clear();
+    }
+
+    if (m_spatialSettings.enable) {
+      assignSpatialBuckets();
+    } else {
+      for (uint32_t i = 0; i < m_members.size(); i++) {
+        addToBucket(m_members[i].compatibilityKey, i);
+      }
+    }
+
+    // Remove the buckets which lost all of their members. Iterating backwards, buckets moved into the
+    // place of a removed one were visited already.
+    for (uint32_t i = static_cast<uint32_t>(m_buckets.size()); i-- > 0;) {
+      if (!m_buckets[i].m_members.empty()) {
+        continue;
+      }
+
+      onRemove(m_buckets[i].data);
+      m_bucketIndices.erase(m_buckets[i].m_key);
+
+      if (i != m_buckets.size() - 1) {
+        m_buckets[i] = std::move(m_buckets.back());
+        m_bucketIndices[m_buckets[i].m_key] = i;
+      }
+
+      m_buckets.pop_back();
+    }
+
+    m_stats = Stats();
+
+    for (Bucket& bucket : m_buckets) {
+      planBucket(bucket);
+    }
+  }
+
+  uint32_t getBucketCount() const {
+    return static_cast<uint32_t>(m_buckets.size());
+  }
+
+  Bucket& getBucket(uint32_t index) {
+    return m_buckets[index];
+  }
+
+  const Bucket& getBucket(uint32_t index) const {
+    return m_buckets[index];
+  }
+
+  // Upgrades a bucket's action to a full build, i.e. when its BLAS turned out not to be updatable
+  void forceBuild(Bucket& bucket) {
+    if (bucket.m_action == Action::Build) {
+      return;
+    }
+
+    if (bucket.m_action == Action::Refit) {
+      m_stats.refit--;
+    } else {
+      m_stats.reused--;
+    }
+
+    m_stats.built++;
+    bucket.m_action = Action::Build;
+  }
+
+  const Stats& getStats() const {
+    return m_stats;
+  }
+
+  template<typename OnRemove>
+  void clear(OnRemove onRemove) {
+    for (Bucket& bucket : m_buckets) {
+      onRemove(bucket.data);
+    }
+
+    m_buckets.clear();
+    m_bucketIndices.clear();
+    m_members.clear();
+    m_stats = Stats();
+  }
+
+  // Interleaves the lower 21 bits of each coordinate, x in the lowest bit
+  static uint64_t getMortonCode(uint32_t x, uint32_t y, uint32_t z) {
+    return spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2);
+  }
+
+  static double getSurfaceArea(const AxisAlignedBoundingBox& bounds) {
+    if (!bounds.isValid()) {
+      return 0.0;
+    }
+
+    const Vector3 size = bounds.maxPos - bounds.minPos;
+    return 2.0 * (double(size.x) * size.y + double(size.y) * size.z + double(size.z) * size.x);
+  }
+
+private:
+  static uint64_t spreadBits(uint32_t value) {
+    uint64_t x = value & 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffull;
+    x = (x | x << 16) & 0x1f0000ff0000ffull;
+    x = (x | x << 8) & 0x100f00f00f00f00full;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+    x = (x | x << 2) & 0x1249249249249249ull;
+    return x;
+  }
+
+  void addToBucket(XXH64_hash_t key, uint32_t member) {
+    auto iter = m_bucketIndices.find(key);
+    if (iter == m_bucketIndices.end()) {
+      iter = m_bucketIndices.emplace(key, static_cast<uint32_t>(m_buckets.size())).first;
+
+      Bucket& bucket = m_buckets.emplace_back();
+      bucket.m_key = key;
+      bucket.m_compatibilityKey = m_members[member].compatibilityKey;
+    }
+
+    m_buckets[iter->second].m_members.push_back(member);
+  }
+
+  // Morton code of a member's bounds center on a fixed world grid, so that codes of static instances don't change
+  uint64_t getMemberMortonCode(const Member& member) const {
+    if (!member.worldBounds.isValid()) {
+      return 0;
+    }
+
+    // A few cells per maximum bucket extent to order instances within a bucket sized region as well
+    constexpr float kCellsPerExtent = 4.f;
+    constexpr int64_t kGridOffset = 1 << 20;
+    const float cellSize = m_spatialSettings.maxExtent > 0.f ? m_spatialSettings.maxExtent / kCellsPerExtent : 1.f;
+    const Vector3 center = member.worldBounds.getCentroid();
+
+    uint32_t cell[3];
+    for (uint32_t i = 0; i < 3; i++) {
+      const float coordinate = std::clamp(std::floor(center[i] / cellSize), -float(kGridOffset), float(kGridOffset - 1));
+      cell[i] = static_cast<uint32_t>(static_cast<int64_t>(coordinate) + kGridOffset);
+    }
+
+    return getMortonCode(cell[0], cell[1], cell[2]);
+  }
+
+  // Walks the compatible members along the Morton curve and starts a new bucket whenever the current one would
+  // exceed the extent or primitive limits. Ties are broken by instance id, so the grouping only depends on the
+  // set of members and not on their order in the instance table. A bucket is identified by its compatibility key
+  // and its first member, which keeps buckets stable while the instances in front of them don't change.
+  void assignSpatialBuckets() {
+    m_scratchSpatial.clear();
+    for (uint32_t i = 0; i < m_members.size(); i++) {
+      const Member& member = m_members[i];
+      m_scratchSpatial.push_back({ member.compatibilityKey, getMemberMortonCode(member), member.instanceId, i });
+    }
+    std::sort(m_scratchSpatial.begin(), m_scratchSpatial.end());
+
+    const float maxExtent = m_spatialSettings.maxExtent > 0.f ? m_spatialSettings.maxExtent : FLT_MAX;
+    const uint32_t maxPrimitives = m_spatialSettings.maxPrimitives > 0 ? m_spatialSettings.maxPrimitives : UINT32_MAX;
+
+    XXH64_hash_t bucketKey = kEmptyHash;
+    AxisAlignedBoundingBox bucketBounds;
+    uint32_t bucketPrimitives = 0;
+
+    for (uint32_t i = 0; i < m_scratchSpatial.size(); i++) {
+      const SpatialEntry& entry = m_scratchSpatial[i];
+      const Member& member = m_members[entry.member];
+
+      bool startBucket = i == 0 || entry.compatibilityKey != m_scratchSpatial[i - 1].compatibilityKey;
+
+      if (!startBucket) {
+        AxisAlignedBoundingBox bounds = bucketBounds;
+        if (member.worldBounds.isValid()) {
+          bounds.unionWith(member.worldBounds);
+        }
+
+        const Vector3 size = bounds.isValid() ? bounds.maxPos - bounds.minPos : Vector3(0.f);
+        startBucket = std::max({ size.x, size.y, size.z }) > maxExtent ||
+                      uint64_t(bucketPrimitives) + member.primitiveCount > maxPrimitives;
+      }
+
+      if (startBucket) {
+        const uint64_t key[] = { entry.compatibilityKey, entry.instanceId };
+        bucketKey = XXH64(key, sizeof(key), kEmptyHash);
+        bucketBounds.invalidate();
+        bucketPrimitives = 0;
+      }
+
+      if (member.worldBounds.isValid()) {
+        bucketBounds.unionWith(member.worldBounds);
+      }
+      bucketPrimitives += member.primitiveCount;
+
+      addToBucket(bucketKey, entry.member);
+    }
+  }
+
+  void planBucket(Bucket& bucket) {
+    std::vector<uint32_t>& members = bucket.m_members;
+
+    bool sameSequence = !bucket.m_isNew && members.size() == bucket.m_memberIds.size();
+    for (uint32_t i = 0; sameSequence && i < members.size(); i++) {
+      sameSequence = m_members[members[i]].instanceId == bucket.m_memberIds[i];
+    }
+
+    // Instance table order is not stable (i.e. instances are swap removed), so restore the previous
+    // geometry order: members from the last frame keep their relative order, new ones follow them.
+    if (!sameSequence && !bucket.m_isNew) {
+      m_scratchIds.clear();
+      for (uint32_t i = 0; i < members.size(); i++) {
+        m_scratchIds.emplace_back(m_members[members[i]].instanceId, i);
+      }
+      std::sort(m_scratchIds.begin(), m_scratchIds.end());
+
+      const uint32_t previousCount = static_cast<uint32_t>(bucket.m_memberIds.size());
+      auto previous = bucket.m_sortedMemberIds.begin();
+
+      m_scratchOrder.clear();
+      for (const auto& [instanceId, index] : m_scratchIds) {
+        while (previous != bucket.m_sortedMemberIds.end() && previous->first < instanceId) {
+          ++previous;
+        }
+
+        const bool wasMember = previous != bucket.m_sortedMemberIds.end() && previous->first == instanceId;
+        m_scratchOrder.emplace_back(wasMember ? previous->second : previousCount + index, members[index]);
+      }
+      std::sort(m_scratchOrder.begin(), m_scratchOrder.end());
+
+      for (uint32_t i = 0; i < members.size(); i++) {
+        members[i] = m_scratchOrder[i].second;
+      }
+    }
+
+    XXH64_hash_t membershipHash = kEmptyHash;
+    XXH64_hash_t contentHash = kEmptyHash;
+    bool contentUpdated = false;
+    bucket.m_bounds.invalidate();
+
+    for (uint32_t index : members) {
+      const Member& member = m_members[index];
+      if (member.worldBounds.isValid()) {
+        bucket.m_bounds.unionWith(member.worldBounds);
+      }
+      const XXH64_hash_t membership[] = { member.instanceId, member.layoutHash };
+      membershipHash = XXH64(membership, sizeof(membership), membershipHash);
+      contentHash = XXH64(&member.contentHash, sizeof(member.contentHash), contentHash);
+      contentUpdated |= member.contentUpdated;
+    }
+
+    m_stats.boundsSurfaceArea += getSurfaceArea(bucket.m_bounds);
+
+    if (bucket.m_isNew || membershipHash != bucket.m_membershipHash) {
+      bucket.m_action = Action::Build;
+      m_stats.built++;
+    } else if (contentUpdated || contentHash != bucket.m_contentHash) {
+      bucket.m_action = Action::Refit;
+      m_stats.refit++;
+    } else {
+      bucket.m_action = Action::Reuse;
+      m_stats.reused++;
+    }
+
+    bucket.m_isNew = false;
+    bucket.m_membershipHash = membershipHash;
+    bucket.m_contentHash = contentHash;
+
+    // Remember the member order for the next frame, unless it is unchanged
+    if (!sameSequence) {
+      bucket.m_memberIds.resize(members.size());
+      bucket.m_sortedMemberIds.resize(members.size());
+
+      for (uint32_t i = 0; i < members.size(); i++) {
+        bucket.m_memberIds[i] = m_members[members[i]].instanceId;
+        bucket.m_sortedMemberIds[i] = { bucket.m_memberIds[i], i };
+      }
+
+      std::sort(bucket.m_sortedMemberIds.begin(), bucket.m_sortedMemberIds.end());
+    }
+  }
+
+  struct SpatialEntry {
+    XXH64_hash_t compatibilityKey;
+    uint64_t mortonCode;
+    uint64_t instanceId;
+    uint32_t member;
+
+    bool operator<(const SpatialEntry& other) const {
+      if (compatibilityKey != other.compatibilityKey) {
+        return compatibilityKey < other.compatibilityKey;
+      }
+      if (mortonCode != other.mortonCode) {
+        return mortonCode < other.mortonCode;
+      }
+      return instanceId < other.instanceId;
+    }
+  };
+
+  std::vector<Member> m_members;
+  std::vector<Bucket> m_buckets;
+  fast_unordered_cache<uint32_t> m_bucketIndices;  // Bucket key to index in m_buckets
+  SpatialSettings m_spatialSettings;
+  Stats m_stats;
+
+  // Scratch space for restoring member order, kept to avoid reallocations
+  std::vector<std::pair<uint64_t, uint32_t>> m_scratchIds;
+  std::vector<std::pair<uint32_t, uint32_t>> m_scratchOrder;
+  std::vector<SpatialEntry> m_scratchSpatial;
+};
+
+}
@@ -42,20 +42,65 @@ namespace dxvk {
 
   void CameraManager::onFrameEnd() {
     m_lastSetCameraType = CameraType::Unknown;
-    m_decompositionCache.clear();
+
+    const uint32_t numLookups = m_cameraCacheHits + m_cameraCacheMisses;
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxCameraCacheHitRate, numLookups > 0 ? (100ull * m_cameraCacheHits) / numLookups : 0);
+
+    m_cameraCacheHits = 0;
+    m_cameraCacheMisses = 0;
+    clearCameraCache();
   }
 
   CameraType::Enum CameraManager::processCameraData(const DrawCallState& input) {
+    const DrawCallTransforms& transforms = input.getTransformData();
+
     // If theres no real camera data here - bail
-    if (isIdentityExact(input.getTransformData().viewToProjection)) {
+    if (isIdentityExact(transforms.viewToProjection)) {
       return input.testCategoryFlags(InstanceCategories::Sky) ? CameraType::Sky : CameraType::Unknown;
     }
 
+    CameraClassificationKey key;
+    key.viewToProjection = transforms.viewToProjection;
+    key.worldToView = transforms.worldToView;
+    key.maxZ = input.maxZ;
+    key.drawFlags = (input.testCategoryFlags(InstanceCategories::Sky) ? kSkyDraw : 0) |
+                    (input.isDrawingToRaytracedRenderTarget ? kRaytracedRenderTargetDraw : 0);
+
+    CameraClassification* entry = findCameraClassification(key);
+    const bool isCached = entry != nullptr;
+    if (!isCached) {
+      entry = &addCameraClassification(key);
+      resolveCameraType(input, *entry);
+    }
+
+    // D3D9Rtx builds objectToView as worldToView * objectToWorld, so the two can only match with an identity view
+    if (entry->checkFusedWorldView &&
+        transforms.objectToView == transforms.objectToWorld && !isIdentityExact(transforms.objectToView)) {
+      return input.testCategoryFlags(InstanceCategories::Sky) ? CameraType::Sky : CameraType::Unknown;
+    }
+
+    if (!entry->isCameraAccepted) {
+      return entry->cameraType;
+    }
+
+    const CameraType::Enum cameraType = entry->cameraType;
+
+    // Cameras only take the first update of a frame, which an earlier draw with the same key has done already
+    if (!isCached) {
+      updateCamera(input, *entry);
+    }
+
+    m_lastSetCameraType = cameraType;
+
+    return cameraType;
+  }
+
+  void CameraManager::resolveCameraType(const DrawCallState& input, CameraClassification& entry) {
+    const CameraType::Enum rejectedCameraType = input.testCategoryFlags(InstanceCategories::Sky) ? CameraType::Sky : CameraType::Unknown;
+
     switch (RtxOptions::fusedWorldViewMode()) {
     case FusedWorldViewMode::None:
-      if (input.getTransformData().objectToView == input.getTransformData().objectToWorld && !isIdentityExact(input.getTransformData().objectToView)) {
-        return input.testCategoryFlags(InstanceCategories::Sky) ? CameraType::Sky : CameraType::Unknown;
-      }
+      entry.checkFusedWorldView = isIdentityExact(entry.key.worldToView);
       break;
     case FusedWorldViewMode::View:
       if (Logger::logLevel() >= LogLevel::Warn) {
@@ -74,22 +119,22 @@ namespace dxvk {
     }
 
     // Get camera params
-    DecomposeProjectionParams decomposeProjectionParams = getOrDecomposeProjection(input.getTransformData().viewToProjection);
+    DecomposeProjectionParams& decomposeProjectionParams = entry.params;
+    decomposeProjection(entry.key.viewToProjection, decomposeProjectionParams);
 
-    // Filter invalid cameras, extreme shearing
-    static auto isFovValid = [](float fovA) {
-      return fovA >= kFovToleranceRadians;
-    };
     static auto areFovsClose = [](float fovA, const RtCamera& cameraB) {
       return std::abs(fovA - cameraB.getFov()) < kFovToleranceRadians;
     };
 
-    if (std::abs(decomposeProjectionParams.shearX) > 0.01f || !isFovValid(decomposeProjectionParams.fov)) {
+    // Filter invalid cameras, extreme shearing
+    const bool isValid = !(std::abs(decomposeProjectionParams.shearX) > 0.01f) && decomposeProjectionParams.fov >= kFovToleranceRadians;
+    if (!isValid) {
       ONCE(Logger::warn("[RTX] CameraManager: rejected an invalid camera"));
-      return input.getCategoryFlags().test(InstanceCategories::Sky) ? CameraType::Sky : CameraType::Unknown;
+      entry.cameraType = rejectedCameraType;
+      entry.isCameraAccepted = false;
+      return;
     }
 
-
     auto isViewModel = [this](float fov, float maxZ, uint32_t frameId) {
       if (RtxOptions::ViewModel::enable()) {
         // Note: max Z check is the top-priority
@@ -124,6 +169,15 @@ namespace dxvk {
       }
     }
 
+    entry.cameraType = cameraType;
+    entry.isCameraAccepted = true;
+  }
+
+  void CameraManager::updateCamera(const DrawCallState& input, const CameraClassification& entry) {
+    const uint32_t frameId = m_device->getCurrentFrameId();
+    const CameraType::Enum cameraType = entry.cameraType;
+    const DecomposeProjectionParams& decomposeProjectionParams = entry.params;
+
     auto& camera = getCamera(cameraType);
     auto cameraSequence = RtCameraSequence::getInstance();
     bool shouldUpdateMainCamera = cameraType == CameraType::Main && camera.getLastUpdateFrame() != frameId;
@@ -165,9 +219,11 @@ namespace dxvk {
     if (isCameraCut && cameraType == CameraType::Main) {
       m_lastCameraCutFrameId = m_device->getCurrentFrameId();
     }
-    m_lastSetCameraType = cameraType;
 
-    return cameraType;
+    // Draws classified before the main camera was set compared their FOV against no main camera
+    if (shouldUpdateMainCamera) {
+      clearCameraCache();
+    }
   }
 
   bool CameraManager::isCameraCutThisFrame() const {
@@ -177,10 +233,15 @@ namespace dxvk {
   void CameraManager::processExternalCamera(CameraType::Enum type,
                                             const Matrix4& worldToView,
                                             const Matrix4& viewToProjection) {
-    DecomposeProjectionParams decomposeProjectionParams = getOrDecomposeProjection(viewToProjection);
+    // External cameras are set at most a few times per frame, so they are not cached
+    DecomposeProjectionParams decomposeProjectionParams;
+    decomposeProjection(viewToProjection, decomposeProjectionParams);
+
+    const uint32_t frameId = m_device->getCurrentFrameId();
+    const bool isFirstMainCameraUpdate = type == CameraType::Main && !getCamera(type).isValid(frameId);
 
     getCamera(type).update(
-      m_device->getCurrentFrameId(),
+      frameId,
       worldToView,
       viewToProjection,
       decomposeProjectionParams.fov,
@@ -188,18 +249,57 @@ namespace dxvk {
       decomposeProjectionParams.nearPlane,
       decomposeProjectionParams.farPlane,
       decomposeProjectionParams.isLHS);
+
+    // Draws classified before the main camera was set compared their FOV against no main camera
+    if (isFirstMainCameraUpdate) {
+      clearCameraCache();
+    }
   }
 
-    DecomposeProjectionParams CameraManager::getOrDecomposeProjection(const Matrix4& viewToProjection) {
-      XXH64_hash_t projectionHash = XXH64(&viewToProjection, sizeof(viewToProjection), 0);
-      auto iter = m_decompositionCache.find(projectionHash);
-      if (iter != m_decompositionCache.end()) {
-        return iter->second;
+  CameraManager::CameraClassification* CameraManager::findCameraClassification(const CameraClassificationKey& key) {
+    // Compare the raw bits so that lookups are exact, draws usually repeat the key of the previous draw
+    auto matches = [&key](const CameraClassification& entry) {
+      return memcmp(&entry.key, &key, sizeof(CameraClassificationKey)) == 0;
+    };
+
+    if (m_cameraCacheSize > 0 && matches(m_cameraCache[m_cameraCacheLastHit])) {
+      m_cameraCacheHits++;
+      return &m_cameraCache[m_cameraCacheLastHit];
+    }
+
+    for (uint32_t i = 0; i < m_cameraCacheSize; i++) {
+      if (matches(m_cameraCache[i])) {
+        m_cameraCacheHits++;
+        m_cameraCacheLastHit = i;
+        return &m_cameraCache[i];
       }
+    }
+
+    m_cameraCacheMisses++;
+    return nullptr;
+  }
 
-      DecomposeProjectionParams decomposeProjectionParams;
-      decomposeProjection(viewToProjection, decomposeProjectionParams);
-      m_decompositionCache.emplace(projectionHash, decomposeProjectionParams);
-      return decomposeProjectionParams;
+  CameraManager::CameraClassification& CameraManager::addCameraClassification(const CameraClassificationKey& key) {
+    // Fill free entries first, then replace entries in round robin order
+    uint32_t index;
+    if (m_cameraCacheSize < kCameraCacheSize) {
+      index = m_cameraCacheSize++;
+    } else {
+      index = m_cameraCacheNextEviction;
+      m_cameraCacheNextEviction = (m_cameraCacheNextEviction + 1) % kCameraCacheSize;
     }
+
+    CameraClassification& entry = m_cameraCache[index];
+    entry = CameraClassification {};
+    entry.key = key;
+
+    m_cameraCacheLastHit = index;
+    return entry;
+  }
+
+  void CameraManager::clearCameraCache() {
+    m_cameraCacheSize = 0;
+    m_cameraCacheLastHit = 0;
+    m_cameraCacheNextEviction = 0;
+  }
 }  // namespace dxvk
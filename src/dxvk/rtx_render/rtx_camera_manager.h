@@ -82,9 +82,46 @@ namespace dxvk {
     std::array<RtCamera, CameraType::Count> m_cameras;
     CameraType::Enum m_lastSetCameraType = CameraType::Unknown;
     uint32_t m_lastCameraCutFrameId = -1;
-    fast_unordered_cache<DecomposeProjectionParams> m_decompositionCache;
 
-    DecomposeProjectionParams getOrDecomposeProjection(const Matrix4& viewToProjection);
+    // Everything processCameraData decides for a draw depends only on the key below while a frame
+    // is recorded: options change between frames, and cameras take the first update of a frame.
+    // Games issue thousands of draws per frame with only a handful of different keys.
+    struct CameraClassificationKey {
+      Matrix4 viewToProjection;
+      Matrix4 worldToView;
+      float maxZ;
+      uint32_t drawFlags;
+    };
+
+    static_assert(sizeof(CameraClassificationKey) == 2 * sizeof(Matrix4) + 2 * sizeof(uint32_t), "Keys are compared bytewise and must not contain padding");
+
+    static constexpr uint32_t kSkyDraw = 1 << 0;
+    static constexpr uint32_t kRaytracedRenderTargetDraw = 1 << 1;
+
+    struct CameraClassification {
+      CameraClassificationKey key;
+      DecomposeProjectionParams params;
+      CameraType::Enum cameraType = CameraType::Unknown;
+      // Draws with this key update the camera of cameraType, rather than being rejected
+      bool isCameraAccepted = false;
+      // The view is identity so the draw may have its view fused into the world transform,
+      // that still has to be checked per draw
+      bool checkFusedWorldView = false;
+    };
+
+    static constexpr uint32_t kCameraCacheSize = 8;
+    std::array<CameraClassification, kCameraCacheSize> m_cameraCache;
+    uint32_t m_cameraCacheSize = 0;
+    uint32_t m_cameraCacheLastHit = 0;
+    uint32_t m_cameraCacheNextEviction = 0;
+    uint32_t m_cameraCacheHits = 0;
+    uint32_t m_cameraCacheMisses = 0;
+
+    CameraClassification* findCameraClassification(const CameraClassificationKey& key);
+    CameraClassification& addCameraClassification(const CameraClassificationKey& key);
+    void resolveCameraType(const DrawCallState& input, CameraClassification& entry);
+    void updateCamera(const DrawCallState& input, const CameraClassification& entry);
+    void clearCameraCache();
 
     RTX_OPTION("rtx", bool, rayPortalEnabled, false, "Enables ray portal support. Note this requires portal texture hashes to be set for the ray portal geometries in rtx.rayPortalModelTextureHashes.");
   };
@@ -46,6 +46,10 @@ DrawCallCache::DrawCallCache(DxvkDevice* device) : CommonDeviceObject(device) {
 }
 DrawCallCache::~DrawCallCache() {}
 
+uint32_t DrawCallCache::getCurrentFrameId() const {
+  return m_pFrameIdOverride != nullptr ? *m_pFrameIdOverride : m_device->getCurrentFrameId();
+}
+
 DrawCallCache::CacheState DrawCallCache::get(const DrawCallState& drawCall, BlasEntry** out) {
   // First, find the right bucket:
   const XXH64_hash_t hash = drawCall.getGeometryData().getHashForRule<rules::TopologicalHash>();
@@ -62,7 +66,7 @@ DrawCallCache::CacheState DrawCallCache::get(const DrawCallState& drawCall, Blas
     // Only 1 element
     BlasEntry& entry = range.first->second;
 
-    const bool updatedThisFrame = entry.frameLastTouched == m_device->getCurrentFrameId();
+    const bool updatedThisFrame = entry.frameLastTouched == getCurrentFrameId();
     const bool vertexDataMatches = entry.input.getGeometryData().getHashForRule<rules::VertexDataHash>() == drawCall.getGeometryData().getHashForRule<rules::VertexDataHash>();
     const bool boneHashesMatch = entry.input.getSkinningState().boneHash == drawCall.getSkinningState().boneHash;
     const bool materialHashesMatch = entry.input.getMaterialData().getHash() == drawCall.getMaterialData().getHash();
@@ -93,7 +97,7 @@ DrawCallCache::CacheState DrawCallCache::get(const DrawCallState& drawCall, Blas
       *out = &blas;
       return CacheState::kExisted;
     }
-    if (blas.frameLastTouched == m_device->getCurrentFrameId()) {
+    if (blas.frameLastTouched == getCurrentFrameId()) {
       continue;
     }
     // TODO these heuristics could use more refinement.
@@ -130,7 +134,7 @@ DrawCallCache::CacheState DrawCallCache::get(const DrawCallState& drawCall, Blas
 BlasEntry* DrawCallCache::allocateEntry(XXH64_hash_t hash, const DrawCallState& drawCall) {
   auto iter = m_entries.emplace(hash, drawCall);
   BlasEntry* result = &iter->second;
-  result->frameCreated = m_device->getCurrentFrameId();
+  result->frameCreated = getCurrentFrameId();
   return result;
 }
 
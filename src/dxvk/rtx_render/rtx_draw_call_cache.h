@@ -68,8 +68,14 @@ public:
     }
   }
 
+  // Reads the frame index from pFrameId instead of the device, so that scene ingest can be replayed without a device (i.e. in benchmarks)
+  void overrideFrameIdSource(const uint32_t* pFrameId) { m_pFrameIdOverride = pFrameId; }
+
 private:
   MultimapType m_entries;
+  const uint32_t* m_pFrameIdOverride = nullptr;
+
+  uint32_t getCurrentFrameId() const;
 
   BlasEntry* allocateEntry(XXH64_hash_t hash, const DrawCallState& drawCall);
 };
@@ -0,0 +1,206 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cassert>
+#include <cstring>
+
+#include "rtx_draw_call_trace.h"
+#include "rtx_types.h"
+
+#include "../../util/log/log.h"
+#include "../../util/util_string.h"
+
+namespace dxvk {
+
+  namespace {
+    struct FileHeader {
+      char magic[4] = { 'R', 'D', 'C', 'T' };
+      uint32_t formatVersion = 1;
+      uint32_t recordSize = sizeof(DrawCallTraceRecord);
+      uint32_t reserved = 0;
+    };
+
+    struct FrameHeader {
+      uint32_t numRecords;
+      uint32_t reserved;
+      XXH64_hash_t checksum;  // Of the frame's records
+    };
+
+    // Sanity limit for parsing, far above the number of draw calls of any frame
+    constexpr uint32_t kMaxRecordsPerFrame = 1 << 24;
+
+    void append(std::vector<uint8_t>& file, const void* pData, size_t size) {
+      if (size == 0) {
+        return;
+      }
+
+      const size_t offset = file.size();
+      file.resize(offset + size);
+      std::memcpy(file.data() + offset, pData, size);
+    }
+  }
+
+  void DrawCallTrace::addFrame(const DrawCallTraceRecord* pRecords, uint32_t numRecords) {
+    m_frameOffsets.push_back(static_cast<uint32_t>(m_records.size()));
+    m_records.insert(m_records.end(), pRecords, pRecords + numRecords);
+  }
+
+  bool DrawCallTrace::load(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+      Logger::err(str::format("DrawCallTrace: failed to open ", filePath));
+      return false;
+    }
+
+    std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+    if (!file || !deserialize(data.data(), data.size(), *this)) {
+      Logger::err(str::format("DrawCallTrace: ", filePath, " is not a valid draw call trace"));
+      return false;
+    }
+
+    return true;
+  }
+
+  void DrawCallTrace::serializeHeader(std::vector<uint8_t>& file) {
+    const FileHeader header;
+    append(file, &header, sizeof(header));
+  }
+
+  void DrawCallTrace::serializeFrame(const DrawCallTraceRecord* pRecords, uint32_t numRecords, std::vector<uint8_t>& file) {
+    FrameHeader header;
+    header.numRecords = numRecords;
+    header.reserved = 0;
+    header.checksum = XXH3_64bits(pRecords, numRecords * sizeof(DrawCallTraceRecord));
+
+    append(file, &header, sizeof(header));
+    append(file, pRecords, numRecords * sizeof(DrawCallTraceRecord));
+  }
+
+  bool DrawCallTrace::deserialize(const uint8_t* pFile, size_t fileSize, DrawCallTrace& trace) {
+    trace = DrawCallTrace();
+
+    const FileHeader expectedHeader;
+    FileHeader header;
+    if (fileSize < sizeof(header)) {
+      return false;
+    }
+
+    std::memcpy(&header, pFile, sizeof(header));
+    if (std::memcmp(header.magic, expectedHeader.magic, sizeof(header.magic)) != 0 ||
+        header.formatVersion != expectedHeader.formatVersion ||
+        header.recordSize != expectedHeader.recordSize) {
+      return false;
+    }
+
+    size_t offset = sizeof(header);
+
+    while (fileSize - offset >= sizeof(FrameHeader)) {
+      FrameHeader frameHeader;
+      std::memcpy(&frameHeader, pFile + offset, sizeof(frameHeader));
+
+      if (frameHeader.numRecords > kMaxRecordsPerFrame) {
+        return false;
+      }
+
+      const size_t recordsSize = frameHeader.numRecords * sizeof(DrawCallTraceRecord);
+      if (fileSize - offset - sizeof(frameHeader) < recordsSize) {
+        // The process recording the trace was terminated while writing this frame
+        break;
+      }
+
+      const uint8_t* pRecords = pFile + offset + sizeof(frameHeader);
+      if (XXH3_64bits(pRecords, recordsSize) != frameHeader.checksum) {
+        return false;
+      }
+
+      trace.m_frameOffsets.push_back(static_cast<uint32_t>(trace.m_records.size()));
+      trace.m_records.insert(trace.m_records.end(),
+                             reinterpret_cast<const DrawCallTraceRecord*>(pRecords),
+                             reinterpret_cast<const DrawCallTraceRecord*>(pRecords + recordsSize));
+
+      offset += sizeof(frameHeader) + recordsSize;
+    }
+
+    return true;
+  }
+
+  void DrawCallTrace::restoreDrawCallState(const DrawCallTraceRecord& record, const std::vector<Matrix4>* pInstancesToObject, DrawCallState& drawCall) {
+    RasterGeometry& geometryData = drawCall.geometryData;
+    for (uint32_t i = 0; i < uint32_t(HashComponents::Count); i++) {
+      geometryData.hashes[static_cast<HashComponents>(i)] = record.geometryHashes[i];
+    }
+    geometryData.hashes.precombine();
+    geometryData.boundingBox = AxisAlignedBoundingBox { record.boundingBoxMin, record.boundingBoxMax };
+    geometryData.vertexCount = record.vertexCount;
+    geometryData.indexCount = record.indexCount;
+
+    drawCall.materialData.setHashOverride(record.materialHash);
+
+    DrawCallTransforms& transforms = drawCall.transformData;
+    transforms.objectToWorld = record.objectToWorld;
+    transforms.objectToView = record.objectToView;
+    transforms.instancesToObject = record.numInstances > 0 ? pInstancesToObject : nullptr;
+    assert(record.numInstances == 0 || (pInstancesToObject != nullptr && pInstancesToObject->size() == record.numInstances));
+
+    drawCall.skinningData.numBones = record.numBones;
+    drawCall.categories = CategoryFlags(record.categoryFlags);
+    drawCall.cameraType = static_cast<CameraType::Enum>(record.cameraType);
+  }
+
+  DrawCallTraceWriter::DrawCallTraceWriter(std::string filePath, uint32_t maxFrames)
+    : m_filePath(std::move(filePath))
+    , m_file(m_filePath, std::ios::binary | std::ios::trunc)
+    , m_maxFrames(maxFrames) {
+    if (!m_file.is_open()) {
+      Logger::err(str::format("DrawCallTrace: failed to create ", m_filePath));
+      return;
+    }
+
+    Logger::info(str::format("DrawCallTrace: recording draw calls to ", m_filePath));
+
+    DrawCallTrace::serializeHeader(m_buffer);
+    m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+  }
+
+  void DrawCallTraceWriter::endFrame() {
+    if (!isRecording()) {
+      m_frameRecords.clear();
+      return;
+    }
+
+    m_buffer.clear();
+    DrawCallTrace::serializeFrame(m_frameRecords.data(), static_cast<uint32_t>(m_frameRecords.size()), m_buffer);
+    m_frameRecords.clear();
+
+    // Note: flushed every frame, so that the trace is usable when the game is terminated rather than shut down
+    m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+    m_file.flush();
+
+    m_numFrames++;
+    if (!isRecording()) {
+      Logger::info(str::format("DrawCallTrace: recorded ", m_numFrames, " frames to ", m_filePath));
+    }
+  }
+
+}
@@ -0,0 +1,123 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "rtx_hashing.h"
+#include "../../util/util_matrix.h"
+#include "../../util/util_vector.h"
+
+namespace dxvk {
+
+  struct DrawCallState;
+
+  // Draw call as seen by the CPU side of the scene pipeline (BLAS lookup, instance matching and acceleration
+  // structure planning), i.e. without any of its buffers. Recorded by SceneManager for every submitted draw call.
+  struct DrawCallTraceRecord {
+    XXH64_hash_t geometryHashes[uint32_t(HashComponents::Count)];
+    XXH64_hash_t materialHash;
+    Matrix4 objectToWorld;
+    Matrix4 objectToView;
+    Vector3 boundingBoxMin;  // Object space
+    Vector3 boundingBoxMax;
+    uint32_t categoryFlags;
+    uint32_t cameraType;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t numBones;
+    uint32_t numInstances;   // Number of point instancer transforms, 0 when not instanced
+  };
+
+  static_assert(std::is_trivially_copyable_v<DrawCallTraceRecord>);
+
+  // Draw call records of consecutive frames, in submission order
+  class DrawCallTrace {
+  public:
+    void addFrame(const DrawCallTraceRecord* pRecords, uint32_t numRecords);
+
+    uint32_t getFrameCount() const {
+      return static_cast<uint32_t>(m_frameOffsets.size());
+    }
+
+    const DrawCallTraceRecord* getFrameRecords(uint32_t frame, uint32_t& numRecords) const {
+      const uint32_t end = frame + 1 < getFrameCount() ? m_frameOffsets[frame + 1] : static_cast<uint32_t>(m_records.size());
+      numRecords = end - m_frameOffsets[frame];
+      return m_records.data() + m_frameOffsets[frame];
+    }
+
+    size_t getRecordCount() const {
+      return m_records.size();
+    }
+
+    bool load(const std::string& filePath);
+
+    // File contents, exposed for testing. A file is a header followed by frames, so that it can be written as frames complete.
+    static void serializeHeader(std::vector<uint8_t>& file);
+    static void serializeFrame(const DrawCallTraceRecord* pRecords, uint32_t numRecords, std::vector<uint8_t>& file);
+
+    // Fails if the data is damaged or from a different format version. A trailing partially written frame is ignored.
+    static bool deserialize(const uint8_t* pFile, size_t fileSize, DrawCallTrace& trace);
+
+    // Restores the recorded state of a draw call, so that a trace can be replayed through the scene managers. Buffers are not recorded
+    // and neither are point instancer transforms, instanced draw calls use pInstancesToObject which must hold numInstances transforms.
+    static void restoreDrawCallState(const DrawCallTraceRecord& record, const std::vector<Matrix4>* pInstancesToObject, DrawCallState& drawCall);
+
+  private:
+    std::vector<DrawCallTraceRecord> m_records;
+    std::vector<uint32_t> m_frameOffsets;
+  };
+
+  // Streams draw call records to a trace file, one frame at a time
+  class DrawCallTraceWriter {
+  public:
+    DrawCallTraceWriter(std::string filePath, uint32_t maxFrames);
+
+    const std::string& getFilePath() const {
+      return m_filePath;
+    }
+
+    // Returns false once the file failed to open or the frame limit was reached
+    bool isRecording() const {
+      return m_file.is_open() && (m_maxFrames == 0 || m_numFrames < m_maxFrames);
+    }
+
+    void record(const DrawCallTraceRecord& record) {
+      m_frameRecords.push_back(record);
+    }
+
+    void endFrame();
+
+  private:
+    std::string m_filePath;
+    std::ofstream m_file;
+    uint32_t m_maxFrames;
+    uint32_t m_numFrames = 0;
+    std::vector<DrawCallTraceRecord> m_frameRecords;
+    std::vector<uint8_t> m_buffer;
+  };
+
+}
@@ -0,0 +1,103 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <tuple>
+#include <vector>
+
+namespace dxvk {
+
+// Pool of vectors holding per-frame scratch data of one type. Vectors handed out by acquire() are cleared, not freed,
+// when the pool is reset, so once a pool has seen the sizes of a workload the following frames reuse its allocations.
+// Users should acquire their vectors in the same order every frame, so that each one gets back the capacity it needed before.
+template<typename T>
+class FrameScratchPool {
+public:
+  // Returns an empty vector, valid until the pool is reset
+  std::vector<T>& acquire() {
+    if (m_numAcquired == m_entries.size()) {
+      // Note: a deque does not move its elements when growing, so previously acquired vectors stay valid
+      m_entries.emplace_back();
+    }
+
+    return m_entries[m_numAcquired++].vector;
+  }
+
+  // Returns all vectors to the pool. Returns how many of them were created or had to grow since the last reset.
+  uint32_t reset() {
+    uint32_t numGrowths = 0;
+
+    for (uint32_t i = 0; i < m_numAcquired; i++) {
+      Entry& entry = m_entries[i];
+
+      if (entry.isNew || entry.vector.capacity() != entry.lastCapacity) {
+        entry.isNew = false;
+        entry.lastCapacity = entry.vector.capacity();
+        numGrowths++;
+      }
+
+      entry.vector.clear();
+    }
+
+    m_numAcquired = 0;
+    return numGrowths;
+  }
+
+private:
+  struct Entry {
+    std::vector<T> vector;
+    size_t lastCapacity = 0;
+    bool isNew = true;
+  };
+
+  std::deque<Entry> m_entries;
+  uint32_t m_numAcquired = 0;
+};
+
+// Frame scoped scratch memory, with one pool per listed type
+template<typename... Types>
+class FrameScratchArena {
+public:
+  template<typename T>
+  std::vector<T>& acquire() {
+    return std::get<FrameScratchPool<T>>(m_pools).acquire();
+  }
+
+  // Invalidates all vectors acquired since the last reset, to be called once per frame
+  void reset() {
+    m_numGrowths = std::apply([](auto&... pools) { return (pools.reset() + ... + 0u); }, m_pools);
+  }
+
+  // Returns how many vectors were created or reallocated during the frame before the last reset,
+  // which is zero once the workload reached a steady state
+  uint32_t getGrowthCount() const {
+    return m_numGrowths;
+  }
+
+private:
+  std::tuple<FrameScratchPool<Types>...> m_pools;
+  uint32_t m_numGrowths = 0;
+};
+
+}
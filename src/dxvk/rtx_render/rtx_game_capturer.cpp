@@ -106,6 +106,24 @@ namespace dxvk {
       const std::string bakedSkyProbeSuffix("_T_SkyProbe" + lss::ext::dds);
       return captureName + bakedSkyProbeSuffix;
     }
+
+    // Appends a sample to a time sampled track, in place of its last sample if the reducer drops it
+    template<typename Sample, typename T, typename Reproduces>
+    static void appendReducedSample(KeyframeReducer<T>* pReducer,
+                                    std::vector<Sample>& samples,
+                                    Sample sample,
+                                    T Sample::* value,
+                                    const Reproduces& reproduces) {
+      if (pReducer != nullptr && samples.size() >= 2) {
+        const Sample& key = samples[samples.size() - 2];
+        Sample& tail = samples.back();
+        if (pReducer->dropTail(key.time, key.*value, tail.time, tail.*value, sample.time, sample.*value, reproduces)) {
+          tail = std::move(sample);
+          return;
+        }
+      }
+      samples.push_back(std::move(sample));
+    }
   }
 
   // For capture tests, we cannot include the config data because it may contain paths/settings which are respective to the users PC.
@@ -436,10 +454,34 @@ namespace dxvk {
             xform[0][0] = -1.0;
           }
         }
-        instance.lssData.xforms.push_back({ m_pCap->currentFrameNum, matrix4ToGfMatrix4d(pRtInstance->getTransform()) * xform });
+        // Transform ops are interpolated component wise by USD, skeleton joints by translation, rotation and scale
+        const XformTolerance& tolerance = m_options.xformTolerance;
+        const auto xformReproduced = [&tolerance](const pxr::GfMatrix4d& a, const pxr::GfMatrix4d& b, double t, const pxr::GfMatrix4d& sample) {
+          return isXformWithinTolerance(lerpXform(a, b, t), sample, tolerance);
+        };
+        const auto boneXformsReproduced = [&tolerance](const pxr::VtMatrix4dArray& a, const pxr::VtMatrix4dArray& b, double t, const pxr::VtMatrix4dArray& sample) {
+          if (a.size() != sample.size() || b.size() != sample.size()) {
+            return false;
+          }
+          for (size_t idx = 0; idx < sample.size(); ++idx) {
+            if (!isXformWithinTolerance(slerpXform(a[idx], b[idx], t), sample[idx], tolerance)) {
+              return false;
+            }
+          }
+          return true;
+        };
+        appendReducedSample(m_options.bReduceKeyframes ? &instance.xformReducer : nullptr,
+                            instance.lssData.xforms,
+                            lss::SampledXform { m_pCap->currentFrameNum, matrix4ToGfMatrix4d(pRtInstance->getTransform()) * xform },
+                            &lss::SampledXform::xform,
+                            xformReproduced);
         const SkinningData& skinData = pRtInstance->getBlas()->input.getSkinningState();
         if (skinData.numBones > 0) {
-          instance.lssData.boneXForms.push_back({ m_pCap->currentFrameNum, matrix4VecToGfMatrix4dVec(skinData.pBoneMatrices) });
+          appendReducedSample(m_options.bReduceKeyframes ? &instance.boneXformReducer : nullptr,
+                              instance.lssData.boneXForms,
+                              lss::SampledBoneXform { m_pCap->currentFrameNum, matrix4VecToGfMatrix4dVec(skinData.pBoneMatrices) },
+                              &lss::SampledBoneXform::xforms,
+                              boneXformsReproduced);
         }
       }
       instance.lssData.finalTime = m_pCap->currentFrameNum;
@@ -610,7 +652,8 @@ namespace dxvk {
                                           const float currentFrameNum,
                                           std::shared_ptr<Mesh> pMesh) {
                                             
-    AssetExporter::BufferCallback captureMeshPositionsAsync = [this, ctx, numVertices, inputPositionBuffer, currentFrameNum, pMesh](Rc<DxvkBuffer> posBuf) {
+    const bool bReduceKeyframes = m_options.bReduceKeyframes;
+    AssetExporter::BufferCallback captureMeshPositionsAsync = [this, ctx, numVertices, inputPositionBuffer, currentFrameNum, pMesh, bReduceKeyframes](Rc<DxvkBuffer> posBuf) {
       // Prep helper vars
       constexpr size_t positionSubElementSize = sizeof(float);
       const size_t positionStride = inputPositionBuffer.stride() / positionSubElementSize;
@@ -643,7 +686,7 @@ namespace dxvk {
         return (a - b).GetLengthSq() > captureMeshPositionDeltaSq;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.positionBufs, positions, currentFrameNum, positionsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.positionBufs, bReduceKeyframes ? &pMesh->positionReducer : nullptr, positions, currentFrameNum, positionsDifferentEnough);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, inputPositionBuffer, captureMeshPositionsAsync);
@@ -656,7 +699,8 @@ namespace dxvk {
                                         const float currentFrameNum,
                                         std::shared_ptr<Mesh> pMesh) {
                                           
-    AssetExporter::BufferCallback captureMeshNormalsAsync = [ctx, numVertices, inputNormalBuffer, currentFrameNum, pMesh](Rc<DxvkBuffer> norBuf) {
+    const bool bReduceKeyframes = m_options.bReduceKeyframes;
+    AssetExporter::BufferCallback captureMeshNormalsAsync = [ctx, numVertices, inputNormalBuffer, currentFrameNum, pMesh, bReduceKeyframes](Rc<DxvkBuffer> norBuf) {
       assert(inputNormalBuffer.vertexFormat() == VK_FORMAT_R32G32B32_SFLOAT);
       // Prep helper vars
       constexpr size_t normalSubElementSize = sizeof(float);
@@ -682,7 +726,7 @@ namespace dxvk {
         return (a - b).GetLengthSq() > captureMeshNormalDeltaSq;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.normalBufs, normals, currentFrameNum, normalsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.normalBufs, bReduceKeyframes ? &pMesh->normalReducer : nullptr, normals, currentFrameNum, normalsDifferentEnough);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, inputNormalBuffer, captureMeshNormalsAsync);
@@ -743,7 +787,7 @@ namespace dxvk {
         return a != b;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.idxBufs, indices, currentFrameNum, differentIndices);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.idxBufs, nullptr, indices, currentFrameNum, differentIndices);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.indexBuffer, captureMeshIndicesAsync);
@@ -754,7 +798,8 @@ namespace dxvk {
                                           const float currentFrameNum,
                                           std::shared_ptr<Mesh> pMesh) {
 
-    AssetExporter::BufferCallback captureMeshTexCoordsAsync = [ctx, geomData, currentFrameNum, pMesh](Rc<DxvkBuffer> texBuf) {
+    const bool bReduceKeyframes = m_options.bReduceKeyframes;
+    AssetExporter::BufferCallback captureMeshTexCoordsAsync = [ctx, geomData, currentFrameNum, pMesh, bReduceKeyframes](Rc<DxvkBuffer> texBuf) {
       assert(geomData.texcoordBuffer.vertexFormat() == VK_FORMAT_R32G32_SFLOAT ||
              geomData.texcoordBuffer.vertexFormat() == VK_FORMAT_R32G32B32_SFLOAT);
       // Prep helper vars
@@ -783,7 +828,7 @@ namespace dxvk {
         return (a - b).GetLengthSq() > captureMeshTexcoordDeltaSq;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.texcoordBufs, texcoords, currentFrameNum, differentIndices);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.texcoordBufs, bReduceKeyframes ? &pMesh->texcoordReducer : nullptr, texcoords, currentFrameNum, differentIndices);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.texcoordBuffer, captureMeshTexCoordsAsync);
@@ -794,7 +839,8 @@ namespace dxvk {
                                       const float currentFrameNum,
                                       std::shared_ptr<Mesh> pMesh) {
 
-    AssetExporter::BufferCallback captureMeshColorAsync = [ctx, geomData, currentFrameNum, pMesh](Rc<DxvkBuffer> colBuf) {
+    const bool bReduceKeyframes = m_options.bReduceKeyframes;
+    AssetExporter::BufferCallback captureMeshColorAsync = [ctx, geomData, currentFrameNum, pMesh, bReduceKeyframes](Rc<DxvkBuffer> colBuf) {
       assert(geomData.color0Buffer.vertexFormat() == VK_FORMAT_B8G8R8A8_UNORM);
       // Prep helper vars
       const size_t numVertices = geomData.vertexCount;
@@ -824,7 +870,7 @@ namespace dxvk {
         return (a - b).GetLengthSq() > captureMeshColorDeltaSq;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.colorBufs, colors, currentFrameNum, colorsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.colorBufs, bReduceKeyframes ? &pMesh->colorReducer : nullptr, colors, currentFrameNum, colorsDifferentEnough);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.color0Buffer, captureMeshColorAsync);
@@ -834,7 +880,8 @@ namespace dxvk {
                                          const RasterGeometry& geomData,
                                          const float currentFrameNum,
                                          std::shared_ptr<Mesh> pMesh) {
-    AssetExporter::BufferCallback captureMeshBlendWeightsAsync = [ctx, geomData, currentFrameNum, pMesh](Rc<DxvkBuffer> inBuf) {
+    const bool bReduceKeyframes = m_options.bReduceKeyframes;
+    AssetExporter::BufferCallback captureMeshBlendWeightsAsync = [ctx, geomData, currentFrameNum, pMesh, bReduceKeyframes](Rc<DxvkBuffer> inBuf) {
       // Prep helper vars
       const size_t numVertices = geomData.vertexCount;
       const size_t bonesPerVertex = pMesh->lssData.bonesPerVertex;
@@ -874,7 +921,7 @@ namespace dxvk {
         return std::abs(a - b) > delta;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendWeightBufs, targetBuffer, currentFrameNum, weightsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendWeightBufs, bReduceKeyframes ? &pMesh->blendWeightReducer : nullptr, targetBuffer, currentFrameNum, weightsDifferentEnough);
     };
     AssetExporter::BufferCallback captureMeshBlendIndicesAsync = [ctx, geomData, currentFrameNum, pMesh](Rc<DxvkBuffer> inBuf) {
       assert(geomData.blendIndicesBuffer.vertexFormat() == VK_FORMAT_R8G8B8A8_USCALED);
@@ -903,7 +950,7 @@ namespace dxvk {
         return a != b;
       };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendIndicesBufs, targetBuffer, currentFrameNum, weightsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendIndicesBufs, nullptr, targetBuffer, currentFrameNum, weightsDifferentEnough);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.blendWeightBuffer, captureMeshBlendWeightsAsync);
@@ -916,6 +963,7 @@ namespace dxvk {
   template <typename T, typename CompareTReturnBool>
   static void GameCapturer::evalNewBufferAndCache(std::shared_ptr<Mesh> pMesh,
                                                   std::map<float, pxr::VtArray<T>>& bufferCache,
+                                                  KeyframeReducer<pxr::VtArray<T>>* pReducer,
                                                   pxr::VtArray<T>& newBuffer,
                                                   const float currentFrameNum,
                                                   CompareTReturnBool compareT) {
@@ -939,6 +987,28 @@ namespace dxvk {
     }
     // Cache VtArray if there is a large enough delta
     if (bSufficientlyDifferent) {
+      // Drop the last cached buffer if interpolating from the one before it to the new buffer reproduces it,
+      // within the same delta as above
+      if (pReducer != nullptr && bufferCache.size() >= 2) {
+        const auto tail = std::prev(bufferCache.end());
+        const auto key = std::prev(tail);
+        const auto reproduces = [&compareT](const pxr::VtArray<T>& a, const pxr::VtArray<T>& b, double t, const pxr::VtArray<T>& sample) {
+          if (a.size() != sample.size() || b.size() != sample.size()) {
+            return false;
+          }
+          const float tf = static_cast<float>(t);
+          for (size_t idx = 0; idx < sample.size(); ++idx) {
+            const T interpolated = a[idx] + (b[idx] - a[idx]) * tf;
+            if (compareT(interpolated, sample[idx])) {
+              return false;
+            }
+          }
+          return true;
+        };
+        if (pReducer->dropTail(key->first, key->second, tail->first, tail->second, currentFrameNum, newBuffer, reproduces)) {
+          bufferCache.erase(tail);
+        }
+      }
       bufferCache[currentFrameNum] = std::move(newBuffer);
     }
     pMesh->meshSync.numOutstanding--;
@@ -998,7 +1068,7 @@ namespace dxvk {
                 static_cast<float>(m_options.fps)).detach();
   }
 
-  lss::Export GameCapturer::prepExport(const Capture& cap,
+  lss::Export GameCapturer::prepExport(Capture& cap,
                                              const float framesPerSecond) {
     lss::Export exportPrep;
     prepExportMetaData(cap, framesPerSecond, exportPrep);
@@ -1081,13 +1151,16 @@ namespace dxvk {
     }
   }
 
-  void GameCapturer::prepExportInstances(const Capture& cap, lss::Export& exportPrep) {
+  void GameCapturer::prepExportInstances(Capture& cap, lss::Export& exportPrep) {
     for (auto& [hash, instance] : cap.instances) {
       if (instance.meshHash == 0) {
         continue;
       }
       auto& exportInstance = exportPrep.instances[hash];
-      exportInstance = instance.lssData;
+      // Hand the samples over rather than copying them, the capture is discarded after export
+      exportInstance = std::move(instance.lssData);
+      instance.xformReducer.reset();
+      instance.boneXformReducer.reset();
 
       assert(cap.meshes.count(instance.meshHash) > 0);
       exportInstance.meshId = instance.meshHash;
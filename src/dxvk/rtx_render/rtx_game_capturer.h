@@ -73,6 +73,7 @@
 
 #include "rtx_game_capturer_utils.h"
 #include "rtx_options.h"
+#include "rtx_keyframe_reducer.h"
 
 #include "../../lssusd/game_exporter_types.h"
 #include "../../util/rc/util_rc_ptr.h"
@@ -114,6 +115,15 @@ public:
                 "to all have identity xform matrices, enabling will attempt to correct this and\n"
                 "improve stage + mesh viewability in tools.\n"
                 "Hashes are unaffected.");
+  RTX_OPTION("rtx.capture", bool, enableKeyframeReduction, true,
+                "Drops the transform and mesh buffer samples of a multi-frame capture which interpolating between the samples\n"
+                "kept around them reproduces. Transforms are held to rtx.capture.keyframeTranslationTolerance and\n"
+                "rtx.capture.keyframeBasisTolerance, mesh buffers to the rtx.captureMesh*Delta options.");
+  RTX_OPTION("rtx.capture", float, keyframeTranslationTolerance, 0.01f,
+                "Max distance, in game units, between the translation of a dropped transform sample and the interpolated one.");
+  RTX_OPTION("rtx.capture", float, keyframeBasisTolerance, 0.005f,
+                "Max distance between the basis vectors of a dropped transform sample and the interpolated ones, relative to their length.\n"
+                "Roughly the rotation error in radians.");
 
   GameCapturer(DxvkDevice* const pDevice, SceneManager& sceneManager, AssetExporter& exporter);
   ~GameCapturer();
@@ -164,6 +174,10 @@ private:
   GameCapturer(const GameCapturer& other) = delete;
   GameCapturer(const GameCapturer&& other) = delete;
   
+  // Dropped samples held per track for keyframe reduction, see KeyframeReducer
+  static constexpr size_t kMaxDroppedXforms = 32;
+  static constexpr size_t kMaxDroppedBuffers = 16;
+
   using Xform = Matrix4;
   struct SampledXform {
     float time;
@@ -189,6 +203,12 @@ private:
     XXH64_hash_t     matHash;
     MeshSync         meshSync;
     AtomicOriginCalc originCalc;
+    // Keyframe reduction of the interpolated buffers, guarded by meshSync.mutex
+    KeyframeReducer<lss::Buf<lss::Pos>>         positionReducer { kMaxDroppedBuffers };
+    KeyframeReducer<lss::Buf<lss::Norm>>        normalReducer { kMaxDroppedBuffers };
+    KeyframeReducer<lss::Buf<lss::Texcoord>>    texcoordReducer { kMaxDroppedBuffers };
+    KeyframeReducer<lss::Buf<lss::Color>>       colorReducer { kMaxDroppedBuffers };
+    KeyframeReducer<lss::Buf<lss::BlendWeight>> blendWeightReducer { kMaxDroppedBuffers };
   };
 
   struct Instance {
@@ -196,6 +216,8 @@ private:
     XXH64_hash_t  meshHash = 0;
     XXH64_hash_t  matHash = 0;
     size_t        meshInstNum = 0;
+    KeyframeReducer<pxr::GfMatrix4d>      xformReducer { kMaxDroppedXforms };
+    KeyframeReducer<pxr::VtMatrix4dArray> boneXformReducer { kMaxDroppedXforms };
   };
 
   void trigger(const Rc<DxvkContext> ctx);
@@ -251,12 +273,13 @@ private:
   template <typename T, typename CompareTReturnBool>
   static void evalNewBufferAndCache(std::shared_ptr<Mesh> pMesh,
                                     std::map<float,pxr::VtArray<T>>& bufferCache,
+                                    KeyframeReducer<pxr::VtArray<T>>* pReducer,
                                     pxr::VtArray<T>& newBuffer,
                                     const float currentCaptureTime,
                                     CompareTReturnBool compareT);
   void exportUsd(const Rc<DxvkContext> ctx);
   struct Capture;
-  static lss::Export prepExport(const Capture& cap,
+  static lss::Export prepExport(Capture& cap,
                                 const float framesPerSecond);
   static void prepExportMetaData(const Capture& cap,
                                  const float framesPerSecond,
@@ -265,7 +288,7 @@ private:
                                   lss::Export& exportPrep);
   static void prepExportMeshes(const Capture& cap,
                                lss::Export& exportPrep);
-  static void prepExportInstances(const Capture& cap,
+  static void prepExportInstances(Capture& cap,
                                   lss::Export& exportPrep);
   static void prepExportLights(const Capture& cap,
                                lss::Export& exportPrep);
@@ -292,6 +315,9 @@ private:
     float dTexcoord;
     float dColor;
     float dBlendweight;
+    //   Keyframe reduction
+    bool bReduceKeyframes;
+    XformTolerance xformTolerance;
   } m_options;
 
   static Options getOptions() {
@@ -305,7 +331,9 @@ private:
              RtxOptions::captureMeshNormalDelta(),
              RtxOptions::captureMeshTexcoordDelta(),
              RtxOptions::captureMeshColorDelta(),
-             RtxOptions::captureMeshBlendWeightDelta() };
+             RtxOptions::captureMeshBlendWeightDelta(),
+             enableKeyframeReduction(),
+             { keyframeTranslationTolerance(), keyframeBasisTolerance() } };
   }
 
   // State
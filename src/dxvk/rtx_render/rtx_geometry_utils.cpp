@@ -76,6 +76,7 @@ namespace dxvk {
         STRUCTURED_BUFFER(BINDING_BLEND_INDICES_INPUT)
         RW_STRUCTURED_BUFFER(BINDING_NORMAL_OUTPUT)
         STRUCTURED_BUFFER(BINDING_NORMAL_INPUT)
+        STRUCTURED_BUFFER(BINDING_BONE_PALETTE_INPUT)
       END_PARAMETER()
     };
 
@@ -253,6 +254,12 @@ namespace dxvk {
       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
 
+    m_pSkinningPaletteData = std::make_unique<RtxStagingDataAlloc>(
+      device,
+      "RtxStagingDataAlloc: Skinning Bone Palettes",
+      (VkMemoryPropertyFlagBits) (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT),
+      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
     m_skinningContext = device->createContext();
   }
 
@@ -261,6 +268,8 @@ namespace dxvk {
   void RtxGeometryUtils::onDestroy() {
     m_pCbData = nullptr;
     m_pSmoothNormalsHashData = nullptr;
+    m_pSkinningPaletteData = nullptr;
+    m_skinningJobs.clear();
     m_skinningContext = nullptr;
   }
 
@@ -272,17 +281,15 @@ namespace dxvk {
       ctx->beginRecording(ctx->getDevice()->createCommandList());
     }
 
-    ScopedGpuProfileZone(ctx, "performSkinning");
-
     const auto normalVertexFormat = drawCallState.getGeometryData().normalBuffer.vertexFormat();
+    const SkinningData& skinningData = drawCallState.getSkinningState();
 
     SkinningArgs params {};
 
     // Note: VK_FORMAT_R32_UINT assumed to be 32 bit spherical octahedral normals.
     assert(normalVertexFormat == VK_FORMAT_R32G32B32_SFLOAT || normalVertexFormat == VK_FORMAT_R32G32B32A32_SFLOAT || normalVertexFormat == VK_FORMAT_R32_UINT);
     assert(drawCallState.getGeometryData().blendWeightBuffer.defined());
-
-    memcpy(&params.bones[0], &drawCallState.getSkinningState().pBoneMatrices[0], sizeof(Matrix4) * drawCallState.getSkinningState().numBones);
+    assert(skinningData.numBones > 0 && skinningData.pBoneMatrices.size() >= skinningData.numBones);
 
     params.dstPositionStride = geo.positionBuffer.stride();
     params.dstPositionOffset = geo.positionBuffer.offsetFromSlice();
@@ -303,6 +310,8 @@ namespace dxvk {
     params.useIndices = drawCallState.getGeometryData().blendIndicesBuffer.defined() ? 1 : 0;
     params.numBones = drawCallState.getGeometryData().numBonesPerVertex;
     params.useOctahedralNormals = normalVertexFormat == VK_FORMAT_R32_UINT ? 1 : 0;
+    params.minBoneIndex = skinningData.minBoneIndex;
+    params.maxBoneIndex = skinningData.numBones - 1;
 
     // If we don't have a mappable vertex buffer then we need to do this on the GPU
     bool mustUseGPU = drawCallState.getGeometryData().positionBuffer.mapPtr() == nullptr;
@@ -319,31 +328,26 @@ namespace dxvk {
     const bool useCPU = params.numVertices <= kNumVerticesToProcessOnCPU && !pendingGpuWrite && !mustUseGPU;
 
     if (!useCPU) {
-      // Setting alignment to device limit minUniformBufferOffsetAlignment because the offset value should be its multiple.
-      // See https://vulkan.lunarg.com/doc/view/1.2.189.2/windows/1.2-extensions/vkspec.html#VUID-VkWriteDescriptorSet-descriptorType-00327
-      const auto& devInfo = ctx->getDevice()->properties().core.properties;
-      VkDeviceSize alignment = devInfo.limits.minUniformBufferOffsetAlignment;
-
-      DxvkBufferSlice cb = m_pCbData->alloc(alignment, sizeof(SkinningArgs));
-      memcpy(cb.mapPtr(0), &params, sizeof(SkinningArgs));
-      ctx->getCommandList()->trackResource<DxvkAccess::Write>(cb.buffer());
-
-      ctx->bindResourceBuffer(BINDING_SKINNING_CONSTANTS, cb);
-      ctx->bindResourceBuffer(BINDING_POSITION_OUTPUT, geo.positionBuffer);
-      ctx->bindResourceBuffer(BINDING_POSITION_INPUT, drawCallState.getGeometryData().positionBuffer);
-      ctx->bindResourceBuffer(BINDING_NORMAL_OUTPUT, geo.normalBuffer);
-      ctx->bindResourceBuffer(BINDING_NORMAL_INPUT, drawCallState.getGeometryData().normalBuffer);
-      ctx->bindResourceBuffer(BINDING_BLEND_WEIGHT_INPUT, drawCallState.getGeometryData().blendWeightBuffer);
-
-      if (drawCallState.getGeometryData().blendIndicesBuffer.defined())
-        ctx->bindResourceBuffer(BINDING_BLEND_INDICES_INPUT, drawCallState.getGeometryData().blendIndicesBuffer);
-
-      ctx->bindShader(VK_SHADER_STAGE_COMPUTE_BIT, SkinningShader::getShader());
-
-      const VkExtent3D workgroups = util::computeBlockCount(VkExtent3D { params.numVertices, 1, 1 }, VkExtent3D { 128, 1, 1 });
-      ctx->dispatch(workgroups.width, workgroups.height, workgroups.depth);
-      ctx->getCommandList()->trackResource<DxvkAccess::Read>(cb.buffer());
+      // Queue the job, palettes shared with other jobs of the batch are only uploaded once
+      params.bonePaletteOffset = m_skinningJobs.addPalette(skinningData.pBoneMatrices.data(), skinningData.numBones,
+                                                           skinningData.minBoneIndex, skinningData.boneHash);
+
+      SkinningJob job;
+      job.args = params;
+      job.positionOutput = geo.positionBuffer;
+      job.normalOutput = geo.normalBuffer;
+      job.positionInput = drawCallState.getGeometryData().positionBuffer;
+      job.normalInput = drawCallState.getGeometryData().normalBuffer;
+      job.blendWeightInput = drawCallState.getGeometryData().blendWeightBuffer;
+      job.blendIndicesInput = drawCallState.getGeometryData().blendIndicesBuffer;
+
+      m_skinningJobs.addJob(std::move(job));
     } else {
+      // Results are written right away, so a queued job writing the same geometry must be recorded before
+      if (hasQueuedSkinningJob(geo.positionBuffer)) {
+        recordSkinningJobs();
+      }
+
       const float* srcPosition = reinterpret_cast<float*>(drawCallState.getGeometryData().positionBuffer.mapPtr(0));
       const float* srcNormal = reinterpret_cast<float*>(drawCallState.getGeometryData().normalBuffer.mapPtr(0));
       const float* srcBlendWeight = reinterpret_cast<float*>(drawCallState.getGeometryData().blendWeightBuffer.mapPtr(0));
@@ -355,11 +359,14 @@ namespace dxvk {
       params.dstNormalStride = 0;
       params.dstNormalOffset = 0;
 
+      // ...reading bones straight from the draw call's palette
+      params.bonePaletteOffset = 0;
+
       float dstPosition[3];
       float dstNormal[3];
 
       for (uint32_t idx = 0; idx < params.numVertices; idx++) {
-        skinning(idx, &dstPosition[0], &dstNormal[0], srcPosition, srcBlendWeight, srcBlendIndices, srcNormal, params);
+        skinning(idx, &dstPosition[0], &dstNormal[0], srcPosition, srcBlendWeight, srcBlendIndices, srcNormal, skinningData.pBoneMatrices.data(), params);
 
         ctx->writeToBuffer(geo.positionBuffer.buffer(), geo.positionBuffer.offsetFromSlice() + idx * geo.positionBuffer.stride(), sizeof(dstPosition), &dstPosition[0]);
         ctx->writeToBuffer(geo.normalBuffer.buffer(), geo.normalBuffer.offsetFromSlice() + idx * geo.normalBuffer.stride(), sizeof(dstNormal), &dstNormal[0]);
@@ -368,6 +375,84 @@ namespace dxvk {
     ++m_skinningCommands;
   }
 
+  bool RtxGeometryUtils::hasQueuedSkinningJob(const DxvkBufferSlice& positionOutput) const {
+    for (const SkinningJob& job : m_skinningJobs.getJobs()) {
+      if (job.positionOutput.matches(positionOutput)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void RtxGeometryUtils::recordSkinningJobs() {
+    if (m_skinningJobs.empty()) {
+      return;
+    }
+
+    const Rc<DxvkContext>& ctx = m_skinningContext;
+    assert(ctx->getCommandList() != nullptr);
+
+    ScopedGpuProfileZone(ctx, "performSkinning");
+
+    const auto& limits = ctx->getDevice()->properties().core.properties.limits;
+    const std::vector<SkinningJob>& jobs = m_skinningJobs.getJobs();
+    const std::vector<Matrix4>& bones = m_skinningJobs.getBones();
+
+    // All palettes of the batch go into a single buffer bound once for all dispatches
+    DxvkBufferSlice palette = m_pSkinningPaletteData->alloc(limits.minStorageBufferOffsetAlignment, sizeof(Matrix4) * bones.size());
+    memcpy(palette.mapPtr(0), bones.data(), sizeof(Matrix4) * bones.size());
+    ctx->getCommandList()->trackResource<DxvkAccess::Read>(palette.buffer());
+
+    // Same for the arguments, each job binds its own range of the allocation.
+    // Setting alignment to device limit minUniformBufferOffsetAlignment because the offset value should be its multiple.
+    // See https://vulkan.lunarg.com/doc/view/1.2.189.2/windows/1.2-extensions/vkspec.html#VUID-VkWriteDescriptorSet-descriptorType-00327
+    const VkDeviceSize alignment = limits.minUniformBufferOffsetAlignment;
+    const VkDeviceSize argsStride = align(sizeof(SkinningArgs), alignment);
+
+    DxvkBufferSlice cb = m_pCbData->alloc(alignment, argsStride * jobs.size());
+    ctx->getCommandList()->trackResource<DxvkAccess::Write>(cb.buffer());
+
+    ctx->bindShader(VK_SHADER_STAGE_COMPUTE_BIT, SkinningShader::getShader());
+    ctx->bindResourceBuffer(BINDING_BONE_PALETTE_INPUT, palette);
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+      const SkinningJob& job = jobs[i];
+
+      memcpy(cb.mapPtr(argsStride * i), &job.args, sizeof(SkinningArgs));
+
+      ctx->bindResourceBuffer(BINDING_SKINNING_CONSTANTS, cb.subSlice(argsStride * i, sizeof(SkinningArgs)));
+      ctx->bindResourceBuffer(BINDING_POSITION_OUTPUT, job.positionOutput);
+      ctx->bindResourceBuffer(BINDING_POSITION_INPUT, job.positionInput);
+      ctx->bindResourceBuffer(BINDING_NORMAL_OUTPUT, job.normalOutput);
+      ctx->bindResourceBuffer(BINDING_NORMAL_INPUT, job.normalInput);
+      ctx->bindResourceBuffer(BINDING_BLEND_WEIGHT_INPUT, job.blendWeightInput);
+
+      if (job.blendIndicesInput.defined())
+        ctx->bindResourceBuffer(BINDING_BLEND_INDICES_INPUT, job.blendIndicesInput);
+
+      const VkExtent3D workgroups = util::computeBlockCount(VkExtent3D { job.args.numVertices, 1, 1 }, VkExtent3D { 128, 1, 1 });
+      ctx->dispatch(workgroups.width, workgroups.height, workgroups.depth);
+    }
+
+    ctx->getCommandList()->trackResource<DxvkAccess::Read>(cb.buffer());
+
+    // A frame can flush several batches
+    const uint32_t frameId = m_device->getCurrentFrameId();
+    if (m_skinningStatsFrameId != frameId) {
+      m_skinningStatsFrameId = frameId;
+      m_skinningFrameStats = {};
+    }
+
+    const auto& batchStats = m_skinningJobs.getStats();
+    m_skinningFrameStats.numJobs += batchStats.numJobs;
+    m_skinningFrameStats.numPalettes += batchStats.numPalettes;
+
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxSkinningJobs, m_skinningFrameStats.numJobs);
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxSkinningPalettes, m_skinningFrameStats.numPalettes);
+
+    m_skinningJobs.clear();
+  }
+
   void RtxGeometryUtils::dispatchViewModelCorrection(
     Rc<DxvkContext> ctx,
     const RaytraceGeometry& geo,
@@ -28,11 +28,11 @@
 #include "../util/util_matrix.h"
 #include "rtx/pass/gen_tri_list_index_buffer_indices.h"
 #include "rtx/pass/terrain_baking/decode_and_add_opacity_binding_indices.h"
+#include "rtx/pass/gpu_skinning_binding_indices.h"
 #include "rtx_types.h"
 #include "rtx_common_object.h"
 #include "rtx_staging.h"
-
-struct SkinningArgs;
+#include "rtx_skinning_batch.h"
 
 namespace dxvk {
 
@@ -49,9 +49,25 @@ namespace dxvk {
   class RtxGeometryUtils : public CommonDeviceObject {
     std::unique_ptr<RtxStagingDataAlloc> m_pCbData;
     std::unique_ptr<RtxStagingDataAlloc> m_pSmoothNormalsHashData;
+    std::unique_ptr<RtxStagingDataAlloc> m_pSkinningPaletteData;
     Rc<DxvkContext> m_skinningContext;
     uint32_t m_skinningCommands = 0;
 
+    struct SkinningJob {
+      SkinningArgs args;
+      DxvkBufferSlice positionOutput;
+      DxvkBufferSlice normalOutput;
+      DxvkBufferSlice positionInput;
+      DxvkBufferSlice normalInput;
+      DxvkBufferSlice blendWeightInput;
+      DxvkBufferSlice blendIndicesInput;
+    };
+
+    // GPU skinning jobs not recorded yet, see recordSkinningJobs
+    SkinningBatch<SkinningJob> m_skinningJobs;
+    SkinningBatch<SkinningJob>::Stats m_skinningFrameStats;
+    uint32_t m_skinningStatsFrameId = kInvalidFrameIndex;
+
   public:
     explicit RtxGeometryUtils(DxvkDevice* pDevice);
     ~RtxGeometryUtils();
@@ -69,7 +85,9 @@ namespace dxvk {
     }
 
     /**
-     * \brief Execute a compute shader to perform skinning
+     * \brief Perform skinning, either right away on the CPU for small meshes, or
+     * by queuing a compute job. Compute jobs are recorded in batches sharing their
+     * bone palettes when the skinning command list is flushed.
      */
     void dispatchSkinning(const DrawCallState& drawCallState, const RaytraceGeometry& geo);
 
@@ -199,12 +217,22 @@ namespace dxvk {
       RaytraceGeometry& geo);
 
     inline void flushCommandList() {
+      recordSkinningJobs();
+
       if (m_skinningContext->getCommandList() != nullptr && m_skinningCommands > 0) {
         m_skinningContext->flushCommandList();
       }
     }
 
   private:
+    /**
+     * \brief Uploads the bone palettes and arguments of the queued skinning
+     * jobs in one go and records their dispatches
+     */
+    void recordSkinningJobs();
+
+    bool hasQueuedSkinningJob(const DxvkBufferSlice& positionOutput) const;
+
     static uint32_t calculateNumMicroTrianglesToBake(const BakeOpacityMicromapState& bakeState, const BakeOpacityMicromapDesc& desc, const uint32_t allowedNumMicroTriangleAlignment, const float bakingWeightScale, uint32_t& availableBakingBudget);
   };
 }
@@ -0,0 +1,131 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "rtx_constants.h"
+#include "vulkan/vulkan_core.h"
+#include "../shaders/rtx/pass/common_binding_indices.h"
+
+namespace dxvk {
+
+// Per-frame state of the instances tracked by InstanceManager, stored as parallel arrays indexed by an
+// instance's slot (its index in the manager's instance vector). Garbage collection, surface index bookkeeping
+// and the TLAS instance merge read the GC state, surface indices and VK instance descriptors (transform, mask,
+// flags, custom index) from these dense arrays rather than from the RtInstance objects, which are large heap
+// allocations. Those passes still dereference an RtInstance for its cold data (hidden state, BLAS, billboards).
+// Slots are kept dense the same way the instance vector is: removing a slot moves the last one into its place.
+// References into the arrays are invalidated by add().
+class InstanceHotState {
+public:
+  enum Flags : uint8_t {
+    MarkedForGC   = 1 << 0,
+    UnlinkedForGC = 1 << 1,
+    InsideFrustum = 1 << 2,
+  };
+
+  uint32_t size() const { return static_cast<uint32_t>(m_frameLastUpdated.size()); }
+
+  // Returns the slot of the new entry, which is always the last one
+  uint32_t add() {
+    m_frameLastUpdated.push_back(kInvalidFrameIndex);
+    m_flags.push_back(InsideFrustum);
+    m_surfaceIndices.push_back(SURFACE_INDEX_INVALID);
+    m_previousSurfaceIndices.push_back(SURFACE_INDEX_INVALID);
+    m_vkInstances.push_back(VkAccelerationStructureInstanceKHR {});
+    return size() - 1;
+  }
+
+  // Removes a slot by moving the last slot into it
+  void removeSwap(uint32_t slot) {
+    const uint32_t last = size() - 1;
+    if (slot != last) {
+      m_frameLastUpdated[slot] = m_frameLastUpdated[last];
+      m_flags[slot] = m_flags[last];
+      m_surfaceIndices[slot] = m_surfaceIndices[last];
+      m_previousSurfaceIndices[slot] = m_previousSurfaceIndices[last];
+      m_vkInstances[slot] = m_vkInstances[last];
+    }
+
+    m_frameLastUpdated.pop_back();
+    m_flags.pop_back();
+    m_surfaceIndices.pop_back();
+    m_previousSurfaceIndices.pop_back();
+    m_vkInstances.pop_back();
+  }
+
+  void clear() {
+    m_frameLastUpdated.clear();
+    m_flags.clear();
+    m_surfaceIndices.clear();
+    m_previousSurfaceIndices.clear();
+    m_vkInstances.clear();
+  }
+
+  uint32_t getFrameLastUpdated(uint32_t slot) const { return m_frameLastUpdated[slot]; }
+  void setFrameLastUpdated(uint32_t slot, uint32_t frameIndex) { m_frameLastUpdated[slot] = frameIndex; }
+
+  bool hasFlag(uint32_t slot, Flags flag) const { return (m_flags[slot] & flag) != 0; }
+  void setFlag(uint32_t slot, Flags flag, bool value) {
+    m_flags[slot] = value ? (m_flags[slot] | flag) : (m_flags[slot] & ~flag);
+  }
+
+  uint32_t getSurfaceIndex(uint32_t slot) const { return m_surfaceIndices[slot]; }
+  void setSurfaceIndex(uint32_t slot, uint32_t surfaceIndex) { m_surfaceIndices[slot] = surfaceIndex; }
+
+  uint32_t getPreviousSurfaceIndex(uint32_t slot) const { return m_previousSurfaceIndices[slot]; }
+  void setPreviousSurfaceIndex(uint32_t slot, uint32_t surfaceIndex) { m_previousSurfaceIndices[slot] = surfaceIndex; }
+
+  const VkAccelerationStructureInstanceKHR& getVkInstance(uint32_t slot) const { return m_vkInstances[slot]; }
+  VkAccelerationStructureInstanceKHR& getVkInstance(uint32_t slot) { return m_vkInstances[slot]; }
+
+  void resetSurfaceIndices() {
+    std::fill(m_surfaceIndices.begin(), m_surfaceIndices.end(), SURFACE_INDEX_INVALID);
+  }
+
+  // Appends the slots of entries which are due for garbage collection, in descending order so they can be
+  // swap removed in sequence without invalidating the remaining ones. An entry is due once it was explicitly
+  // marked, or once it has not been updated for numFramesToKeep frames and isCollectable(slot) agrees.
+  // isCollectable is only invoked for stale entries, so it may look at cold per-instance data.
+  template<typename IsCollectable>
+  void findExpired(uint32_t currentFrame, uint32_t numFramesToKeep, IsCollectable isCollectable, std::vector<uint32_t>& expiredSlots) const {
+    for (uint32_t slot = size(); slot-- > 0;) {
+      const bool isStale = m_frameLastUpdated[slot] + numFramesToKeep <= currentFrame;
+
+      if ((m_flags[slot] & MarkedForGC) || (isStale && isCollectable(slot))) {
+        expiredSlots.push_back(slot);
+      }
+    }
+  }
+
+private:
+  std::vector<uint32_t> m_frameLastUpdated;
+  std::vector<uint8_t> m_flags;
+  std::vector<uint32_t> m_surfaceIndices;          // Material surface index for reordered surfaces by AccelManager
+  std::vector<uint32_t> m_previousSurfaceIndices;
+  std::vector<VkAccelerationStructureInstanceKHR> m_vkInstances;  // Merged into the TLAS instance arrays by AccelManager
+};
+
+}
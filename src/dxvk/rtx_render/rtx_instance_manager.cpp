@@ -99,17 +99,17 @@ namespace dxvk {
     return flags;
   }
 
-  RtInstance::RtInstance(const uint64_t id, uint32_t instanceVectorId)
+  RtInstance::RtInstance(const uint64_t id, InstanceHotState& hotState, uint32_t instanceVectorId)
     : m_id(id)
     , m_instanceVectorId(instanceVectorId)
-    , m_surfaceIndex(SURFACE_INDEX_INVALID)
-    , m_previousSurfaceIndex(SURFACE_INDEX_INVALID) { }
+    , m_hotState(&hotState) { }
 
   // Makes a copy of an instance
   RtInstance::RtInstance(const RtInstance& src, uint64_t id, uint32_t instanceVectorId)
     : surface(src.surface)
     , m_id(id)
     , m_instanceVectorId(instanceVectorId)
+    , m_hotState(src.m_hotState)
     , m_seenCameraTypes(src.m_seenCameraTypes)
     , m_materialType(src.m_materialType)
     , m_albedoOpacityTextureIndex(src.m_albedoOpacityTextureIndex)
@@ -118,8 +118,6 @@ namespace dxvk {
     , m_secondarySamplerIndex(src.m_secondarySamplerIndex)
     , m_isAnimated(src.m_isAnimated)
     , m_opacityMicromapInstanceData(src.m_opacityMicromapInstanceData)
-    , m_surfaceIndex(src.m_surfaceIndex)
-    , m_previousSurfaceIndex(src.m_previousSurfaceIndex)
     , m_isHidden(src.m_isHidden)
     , m_isPlayerModel(src.m_isPlayerModel)
     , m_isWorldSpaceUI(src.m_isWorldSpaceUI)
@@ -130,17 +128,18 @@ namespace dxvk {
     , m_materialDataHash(src.m_materialDataHash)
     , m_texcoordHash(src.m_texcoordHash)
     , m_indexHash(src.m_indexHash)
-    , m_vkInstance(src.m_vkInstance)
     , m_geometryFlags(src.m_geometryFlags)
     , m_firstBillboard(src.m_firstBillboard)
     , m_billboardCount(src.m_billboardCount)
     , m_categoryFlags(src.m_categoryFlags) {
+    // The instance manager allocates the copy's hot state slot with default values, only surface indices and the VK instance carry over
+    setSurfaceIndex(src.getSurfaceIndex());
+    setPreviousSurfaceIndex(src.getPreviousSurfaceIndex());
+    getVkInstance() = src.getVkInstance();
+
     // Members for which state carry over is intentionally skipped
     /*
-       m_isMarkedForGC
-       m_isUnlinkedForGC
-       m_isInsideFrustum
-       m_frameLastUpdated
+       Hot state other than the surface indices (GC and frustum flags, frame last updated)
        m_frameCreated
        m_isCreatedByRenderer
        m_spatialCacheHash
@@ -158,7 +157,7 @@ namespace dxvk {
   namespace {
     template<int RtInstanceSize> struct CheckRtInstanceSize {
       // The second line of the build error should contain the new size of RtInstance in the template argument, i.e. `dxvk::CheckRtInstanceSize<newSize>`
-      static_assert(RtInstanceSize == 768, "RtInstance size has changed.  Fix the copy constructor above this message, then update the expected size.");
+      static_assert(RtInstanceSize == 696, "RtInstance size has changed.  Fix the copy constructor above this message, then update the expected size.");
     };
     CheckRtInstanceSize<sizeof(RtInstance)> _rtInstanceSizeTest;
   }
@@ -172,7 +171,7 @@ namespace dxvk {
     // The D3D matrix on input, needs to be transposed before feeding to the VK API (left/right handed conversion)
     // NOTE: VkTransformMatrixKHR is 4x3 matrix, and Matrix4 is 4x4
     const auto t = transpose(surface.objectToWorld);
-    memcpy(&m_vkInstance.transform, &t, sizeof(VkTransformMatrixKHR));
+    memcpy(&getVkInstance().transform, &t, sizeof(VkTransformMatrixKHR));
 
     if (!m_isCreatedByRenderer) {
       // NOTE: This code would cache instances based on predicted position instead of current position, but in testing it fails too frequently
@@ -198,7 +197,7 @@ namespace dxvk {
     // The D3D matrix on input, needs to be transposed before feeding to the VK API (left/right handed conversion)
     // NOTE: VkTransformMatrixKHR is 4x3 matrix, and Matrix4 is 4x4
     const auto t = transpose(surface.objectToWorld);
-    memcpy(&m_vkInstance.transform, &t, sizeof(VkTransformMatrixKHR));
+    memcpy(&getVkInstance().transform, &t, sizeof(VkTransformMatrixKHR));
     
     return false; // freshly teleported instances are always treated as still.
   }
@@ -261,10 +260,10 @@ namespace dxvk {
   // instance's per frame state is reset as well
   // Returns true if this is the first update this frame
   bool RtInstance::setFrameLastUpdated(const uint32_t frameIndex) {
-    if (m_frameLastUpdated != frameIndex) {
+    if (getFrameLastUpdated() != frameIndex) {
       m_seenCameraTypes.clear();
 
-      m_frameLastUpdated = frameIndex;
+      m_hotState->setFrameLastUpdated(m_instanceVectorId, frameIndex);
 
       return true;
     }
@@ -273,19 +272,19 @@ namespace dxvk {
   }
 
   void RtInstance::markForGarbageCollection() const {
-    m_isMarkedForGC = true;
+    m_hotState->setFlag(m_instanceVectorId, InstanceHotState::MarkedForGC, true);
   }
 
   void RtInstance::markAsUnlinkedFromBlasEntryForGarbageCollection() const {
-    m_isUnlinkedForGC = true;
+    m_hotState->setFlag(m_instanceVectorId, InstanceHotState::UnlinkedForGC, true);
   }
 
   void RtInstance::markAsInsideFrustum() const {
-    m_isInsideFrustum = true;
+    m_hotState->setFlag(m_instanceVectorId, InstanceHotState::InsideFrustum, true);
   }
 
   void RtInstance::markAsOutsideFrustum() const {
-    m_isInsideFrustum = false;
+    m_hotState->setFlag(m_instanceVectorId, InstanceHotState::InsideFrustum, false);
   }
 
   bool RtInstance::registerCamera(CameraType::Enum cameraType, uint32_t frameIndex) {
@@ -302,11 +301,11 @@ namespace dxvk {
   }
 
   void RtInstance::setCustomIndexBit(uint32_t oneBitMask, bool value) {
-    m_vkInstance.instanceCustomIndex = setBit(m_vkInstance.instanceCustomIndex, value, oneBitMask);
+    getVkInstance().instanceCustomIndex = setBit(getVkInstance().instanceCustomIndex, value, oneBitMask);
   }
 
   bool RtInstance::getCustomIndexBit(uint32_t oneBitMask) const {
-    return m_vkInstance.instanceCustomIndex & oneBitMask;
+    return getVkInstance().instanceCustomIndex & oneBitMask;
   }
 
   bool RtInstance::isOpaque() const {
@@ -318,15 +317,15 @@ namespace dxvk {
   }
 
   bool RtInstance::isViewModelNonReference() const {
-    return m_vkInstance.mask != 0 && isViewModel();
+    return getVkInstance().mask != 0 && isViewModel();
   }
 
   bool RtInstance::isViewModelReference() const { 
-    return m_vkInstance.mask == 0 && isViewModel();
+    return getVkInstance().mask == 0 && isViewModel();
     }
 
   bool RtInstance::isViewModelVirtual() const {
-    return m_vkInstance.mask & OBJECT_MASK_VIEWMODEL_VIRTUAL;
+    return getVkInstance().mask & OBJECT_MASK_VIEWMODEL_VIRTUAL;
   }
 
   void RtInstance::printDebugInfo() const {
@@ -336,7 +335,7 @@ namespace dxvk {
       "ID: ", m_id, "\n",
       "Vector Index: ", m_instanceVectorId, "\n",
       "Frame Created: ", m_frameCreated, "\n",
-      "Frame Last Updated: ", m_frameLastUpdated, "\n",
+      "Frame Last Updated: ", getFrameLastUpdated(), "\n",
       "Frame Age: ", getFrameAge(), "\n",
       "\n",
       "=== Transform Info ===\n",
@@ -376,10 +375,10 @@ namespace dxvk {
       "Spatial Cache Hash: 0x", std::hex, m_spatialCacheHash, std::dec, "\n",
       "\n",
       "=== Vulkan Instance Info ===\n",
-      "VK Instance Mask: ", m_vkInstance.mask, "\n",
-      "VK Instance Flags: ", m_vkInstance.flags, "\n",
-      "VK Instance Custom Index: ", m_vkInstance.instanceCustomIndex, "\n",
-      "VK Instance SBT Record Offset: ", m_vkInstance.instanceShaderBindingTableRecordOffset, "\n",
+      "VK Instance Mask: ", getVkInstance().mask, "\n",
+      "VK Instance Flags: ", getVkInstance().flags, "\n",
+      "VK Instance Custom Index: ", getVkInstance().instanceCustomIndex, "\n",
+      "VK Instance SBT Record Offset: ", getVkInstance().instanceShaderBindingTableRecordOffset, "\n",
       "\n",
       "=== Material Info ===\n",
       "Material Type: ", static_cast<int>(m_materialType), "\n",
@@ -389,8 +388,8 @@ namespace dxvk {
       "Secondary Sampler Index: ", m_secondarySamplerIndex, "\n",
       "\n",
       "=== Surface Info ===\n",
-      "Surface Index: ", m_surfaceIndex, "\n",
-      "Previous Surface Index: ", m_previousSurfaceIndex, "\n",
+      "Surface Index: ", getSurfaceIndex(), "\n",
+      "Previous Surface Index: ", getPreviousSurfaceIndex(), "\n",
       "\n",
       "=== Billboard Info ===\n",
       "First Billboard Index: ", m_firstBillboard, "\n",
@@ -410,9 +409,9 @@ namespace dxvk {
       "Is Front Face Flipped: ", isFrontFaceFlipped ? "true" : "false", "\n",
       "\n",
       "=== Garbage Collection Flags ===\n",
-      "Is Marked For GC: ", m_isMarkedForGC ? "true" : "false", "\n",
-      "Is Unlinked For GC: ", m_isUnlinkedForGC ? "true" : "false", "\n",
-      "Is Inside Frustum: ", m_isInsideFrustum ? "true" : "false", "\n",
+      "Is Marked For GC: ", m_hotState->hasFlag(m_instanceVectorId, InstanceHotState::MarkedForGC) ? "true" : "false", "\n",
+      "Is Unlinked For GC: ", isUnlinkedForGC() ? "true" : "false", "\n",
+      "Is Inside Frustum: ", isInsideFrustum() ? "true" : "false", "\n",
       "\n",
       "=== View Model Flags ===\n",
       "Is View Model: ", isViewModel() ? "true" : "false", "\n",
@@ -465,6 +464,10 @@ namespace dxvk {
   InstanceManager::~InstanceManager() {
   }
 
+  uint32_t InstanceManager::getCurrentFrameId() const {
+    return m_pFrameIdOverride != nullptr ? *m_pFrameIdOverride : m_device->getCurrentFrameId();
+  }
+
   void InstanceManager::removeEventHandler(void* eventHandlerOwnerAddress) {
     for (auto eventIter = m_eventHandlers.begin(); eventIter != m_eventHandlers.end(); eventIter++) {
       if (eventIter->eventHandlerOwnerAddress == eventHandlerOwnerAddress) {
@@ -481,6 +484,7 @@ namespace dxvk {
     }
 
     m_instances.clear();
+    m_hotState.clear();
     m_viewModelCandidates.clear();
     m_playerModelInstances.clear();
   }  
@@ -490,7 +494,7 @@ namespace dxvk {
     const uint32_t numFramesToKeepInstances = RtxOptions::numFramesToKeepInstances();
     
     // Remove instances past their lifetime or marked for GC explicitly
-    const uint32_t currentFrame = m_device->getCurrentFrameId();
+    const uint32_t currentFrame = getCurrentFrameId();
 
     // Need to release all instances when ViewModel enablement changes
     // This is a big hammer but it's fine, it's a debugging feature
@@ -501,36 +505,41 @@ namespace dxvk {
     }
 
     const bool forceGarbageCollection = (m_instances.size() >= RtxOptions::AntiCulling::Object::numObjectsToKeep());
-    for (uint32_t i = 0; i < m_instances.size();) {
-      // Must take a ref here since we'll be swapping
-      RtInstance*& pInstance = m_instances[i];
-      assert(pInstance != nullptr);
-
-      const bool enableGarbageCollection =
-        !RtxOptions::AntiCulling::isObjectAntiCullingEnabled() || // It's always True if anti-culling is disabled
-        (pInstance->m_isInsideFrustum) ||
-        (pInstance->getBlas()->input.getSkinningState().numBones > 0) ||
-        (pInstance->m_isAnimated) ||
-        (pInstance->m_isPlayerModel);
-
-      if (((forceGarbageCollection || enableGarbageCollection) &&
-           pInstance->m_frameLastUpdated + numFramesToKeepInstances <= currentFrame) ||
-          pInstance->m_isMarkedForGC) {
-        // Note: Pop and swap for performance, index not incremented to process swapped instance on next iteration
-        removeInstance(pInstance);
+    const bool isAntiCullingEnabled = RtxOptions::AntiCulling::isObjectAntiCullingEnabled();
+
+    // Only called for instances past their lifetime, so the cold instance data is rarely touched
+    auto isCollectable = [&](uint32_t slot) {
+      if (forceGarbageCollection || !isAntiCullingEnabled || m_hotState.hasFlag(slot, InstanceHotState::InsideFrustum)) {
+        return true;
+      }
 
-        // NOTE: pInstance is now the (previously) last element
-        std::swap(pInstance, m_instances.back());
+      // Anti-culling keeps instances outside of the frustum alive, unless they change from frame to frame
+      const RtInstance& instance = *m_instances[slot];
+      return instance.getBlas()->input.getSkinningState().numBones > 0 || instance.m_isAnimated || instance.m_isPlayerModel;
+    };
+
+    // Removing an instance may mark other instances for GC (i.e. prims of its replacement), keep going until none are left
+    while (true) {
+      m_expiredInstanceSlots.clear();
+      m_hotState.findExpired(currentFrame, numFramesToKeepInstances, isCollectable, m_expiredInstanceSlots);
+
+      if (m_expiredInstanceSlots.empty()) {
+        break;
+      }
 
-        m_instances[i]->m_instanceVectorId = i;
+      // Note: Slots are in descending order, so swapping in the last instance never moves one that is yet to be removed
+      for (const uint32_t slot : m_expiredInstanceSlots) {
+        RtInstance* pInstance = m_instances[slot];
 
-        delete m_instances.back();
+        removeInstance(pInstance);
 
-        // Remove the last element
+        m_instances[slot] = m_instances.back();
+        m_instances[slot]->m_instanceVectorId = slot;
         m_instances.pop_back();
-        continue;
+        m_hotState.removeSwap(slot);
+
+        delete pInstance;
       }
-      ++i;
     }
   }
 
@@ -788,7 +797,7 @@ namespace dxvk {
 
     RtInstance* result = nullptr;
 
-    const uint32_t currentFrameIdx = m_device->getCurrentFrameId();
+    const uint32_t currentFrameIdx = getCurrentFrameId();
     const Vector3 worldPosition = blas.input.getGeometryData().boundingBox.getTransformedCentroid(firstInstanceObjectToWorld);
     
     const float uniqueObjectDistanceSqr = RtxOptions::getUniqueObjectDistanceSqr();
@@ -812,7 +821,7 @@ namespace dxvk {
           // - has already been updated this frame
           // - doesn't use the same material
           // - is a sub prim of a replacement instance
-          return instance->m_frameLastUpdated != currentFrameIdx && instance->m_materialHash == material.getHash() && !instance->m_primInstanceOwner.isSubPrim();
+          return instance->getFrameLastUpdated() != currentFrameIdx && instance->m_materialHash == material.getHash() && !instance->m_primInstanceOwner.isSubPrim();
         }
       ));
       if (nearestDistSqr == 0.0f && result != nullptr) {
@@ -826,50 +835,25 @@ namespace dxvk {
     if (nearestDistSqr > 0.0f &&
         cameraType == CameraType::ViewModel && 
         RtxOptions::useRayPortalVirtualInstanceMatching() ) {
-      const Matrix4* teleportMatrix = nullptr;
-      for (const RtInstance* instance : blas.getLinkedInstances()) {
-        if (instance->m_frameLastUpdated != currentFrameIdx - 1 || 
-            instance->m_materialHash != material.getHash()) {
-          continue;
-        }
-        
-        // Compare against virtual position of a predicted instance's position in the current frame
-        const Vector3& prevPrevInstanceWorldPosition = instance->getPrevWorldPosition();
-        const Vector3& prevInstanceWorldPosition = instance->getWorldPosition();
-        const Vector3 predictedInstanceWorldPosition = prevInstanceWorldPosition +
-          (prevInstanceWorldPosition - prevPrevInstanceWorldPosition);
-      
-        // Check all portal pairs
-        for (auto& rayPortalPair : rayPortalManager.getRayPortalPairInfos()) {
-          if (rayPortalPair.has_value()) {
-            for (uint32_t i = 0; i < 2; i++) {
-              const auto& rayPortal = rayPortalPair->pairInfos[i];
-
-              const Vector3 virtualPredictedInstanceWorldPosition =
-                rayPortalManager.getVirtualPosition(predictedInstanceWorldPosition, rayPortal.portalToOpposingPortalDirection);
-
-              // Distance of the object from the predicted virtual position of an instance
-              const float virtualDistSqr = lengthSqr(virtualPredictedInstanceWorldPosition - worldPosition);
-
-              // Is the instance is similar, and within range?  We already know the BLAS is shared, due to the for loop
-              if (virtualDistSqr <= uniqueObjectDistanceSqr && virtualDistSqr < nearestDistSqr) {
-                nearestDistSqr = virtualDistSqr;
-                result = const_cast<RtInstance*>(instance);
-                teleportMatrix = &rayPortal.portalToOpposingPortalDirection;
-                if (virtualDistSqr == 0.0f) {
-                  // Not going to find anything closer.
-                  break;
-                }
-              }
-            }
-          }
-        }
+      if (m_portalVirtualInstanceIndexFrameId != currentFrameIdx) {
+        buildPortalVirtualInstanceIndex(rayPortalManager);
       }
-      
+
+      // Compare against the virtual positions of instances' predicted positions in the current frame
+      float virtualDistSqr;
+      uint32_t portal;
+      const RtInstance* virtualMatch = m_portalVirtualInstanceIndex.findNearest(worldPosition, uniqueObjectDistanceSqr,
+        [&] (const RtInstance* instance) {
+          // Only instances linked to this BLAS which were last updated in the previous frame are candidates
+          return instance->getBlas() == &blas && !instance->isUnlinkedForGC() &&
+                 instance->getFrameLastUpdated() == currentFrameIdx - 1 && instance->m_materialHash == material.getHash();
+        }, virtualDistSqr, portal);
+
       // If the match was against a virtual equivalent of the instance from previous frame, 
       // update the instance's transform to that of the virtual one
-      if (teleportMatrix) {
-        result->teleportWithHistory(*teleportMatrix);
+      if (virtualMatch != nullptr && virtualDistSqr < nearestDistSqr) {
+        result = const_cast<RtInstance*>(virtualMatch);
+        result->teleportWithHistory(m_portalVirtualInstanceIndex.getPortalTransform(portal));
       }
     }
 
@@ -877,11 +861,57 @@ namespace dxvk {
     return result; 
   }
 
+  void InstanceManager::buildPortalVirtualInstanceIndex(const RayPortalManager& rayPortalManager) {
+    ScopedCpuProfileZone();
+    const uint32_t currentFrameIdx = getCurrentFrameId();
+
+    // Note: the cells are as large as the ones of BLAS spatial maps, so that a query covers the unique object distance
+    m_portalVirtualInstanceIndex.reset(RtxOptions::uniqueObjectDistance() * 2.f);
+    m_portalVirtualInstanceIndexFrameId = currentFrameIdx;
+
+    static_assert(maxRayPortalCount == 2);
+    for (auto& rayPortalPair : rayPortalManager.getRayPortalPairInfos()) {
+      if (rayPortalPair.has_value()) {
+        for (uint32_t i = 0; i < 2; i++) {
+          m_portalVirtualInstanceIndex.addPortal(rayPortalPair->pairInfos[i].portalToOpposingPortalDirection);
+        }
+      }
+    }
+
+    if (m_portalVirtualInstanceIndex.getPortalCount() == 0) {
+      return;
+    }
+
+    for (uint32_t slot = 0; slot < m_hotState.size(); slot++) {
+      // Instances updated this frame can't be matched anymore, and ones updated in the previous frame have not been updated yet,
+      // so their predicted positions don't change for the rest of the frame
+      if (m_hotState.getFrameLastUpdated(slot) != currentFrameIdx - 1) {
+        continue;
+      }
+
+      const RtInstance* instance = m_instances[slot];
+
+      // Renderer created instances are never linked to a BLAS
+      if (instance->m_isCreatedByRenderer || instance->getBlas() == nullptr || instance->isUnlinkedForGC()) {
+        continue;
+      }
+
+      const Vector3& prevPrevInstanceWorldPosition = instance->getPrevWorldPosition();
+      const Vector3 prevInstanceWorldPosition = instance->getWorldPosition();
+      const Vector3 predictedInstanceWorldPosition = prevInstanceWorldPosition +
+        (prevInstanceWorldPosition - prevPrevInstanceWorldPosition);
+
+      m_portalVirtualInstanceIndex.add(instance, predictedInstanceWorldPosition);
+    }
+
+    m_portalVirtualInstanceIndex.build();
+  }
+
   RtInstance* InstanceManager::addInstance(BlasEntry& blas) {
-    const uint32_t currentFrameIdx = m_device->getCurrentFrameId();
+    const uint32_t currentFrameIdx = getCurrentFrameId();
 
-    const uint32_t instanceIdx = m_instances.size();
-    RtInstance* newInst = new RtInstance(m_nextInstanceId++, instanceIdx);
+    const uint32_t instanceIdx = m_hotState.add();
+    RtInstance* newInst = new RtInstance(m_nextInstanceId++, m_hotState, instanceIdx);
     m_instances.push_back(newInst);
 
     RtInstance* currentInstance = m_instances[instanceIdx];
@@ -890,10 +920,10 @@ namespace dxvk {
     
     // Set Instance Vulkan AS Instance information
     {
-      currentInstance->m_vkInstance.mask = 0;
-      currentInstance->m_vkInstance.flags = 0;
-      currentInstance->m_vkInstance.instanceCustomIndex = 0;
-      currentInstance->m_vkInstance.instanceShaderBindingTableRecordOffset = 0;
+      currentInstance->getVkInstance().mask = 0;
+      currentInstance->getVkInstance().flags = 0;
+      currentInstance->getVkInstance().instanceCustomIndex = 0;
+      currentInstance->getVkInstance().instanceShaderBindingTableRecordOffset = 0;
       currentInstance->setBlas(blas);
     }
 
@@ -904,7 +934,7 @@ namespace dxvk {
       event.onInstanceAddedCallback(*currentInstance);
 
     // onInstanceAddedCallback will link current instance to the BLAS
-    currentInstance->m_isUnlinkedForGC = false;
+    m_hotState.setFlag(instanceIdx, InstanceHotState::UnlinkedForGC, false);
 
     return currentInstance;
   }
@@ -914,7 +944,7 @@ namespace dxvk {
   // a valid unique instance ID. In that case, set generateValidID to false to avoid overflowing the ID value
   RtInstance* InstanceManager::createInstanceCopy(const RtInstance& reference, bool generateValidID) {
 
-    const uint32_t instanceIdx = m_instances.size();
+    const uint32_t instanceIdx = m_hotState.add();
 
     uint64_t id = generateValidID ? m_nextInstanceId++ : kInvalidInstanceId;
     RtInstance* newInstance = new RtInstance(reference, id, instanceIdx);
@@ -966,7 +996,7 @@ namespace dxvk {
     return false;
   }
 
-  void InstanceManager::bindMaterial(RtInstance& instance, const RtSurfaceMaterial& material) {
+  void InstanceManager::bindMaterial(RtInstance& instance, const RtSurfaceMaterial& material, uint32_t surfaceMaterialIndex) {
     if (material.getType() == RtSurfaceMaterialType::Opaque) {
       instance.m_albedoOpacityTextureIndex = material.getOpaqueSurfaceMaterial().getAlbedoOpacityTextureIndex();
       instance.m_samplerIndex = material.getOpaqueSurfaceMaterial().getSamplerIndex();
@@ -977,11 +1007,12 @@ namespace dxvk {
       instance.m_secondarySamplerIndex = material.getRayPortalSurfaceMaterial().getSamplerIndex2();
     }
 
-    instance.m_vkInstance.instanceCustomIndex = (instance.m_vkInstance.instanceCustomIndex & ~(surfaceMaterialTypeMask << CUSTOM_INDEX_MATERIAL_TYPE_BIT));
-    instance.m_vkInstance.instanceCustomIndex |= ((uint32_t)material.getType() << CUSTOM_INDEX_MATERIAL_TYPE_BIT);
+    instance.getVkInstance().instanceCustomIndex = (instance.getVkInstance().instanceCustomIndex & ~(surfaceMaterialTypeMask << CUSTOM_INDEX_MATERIAL_TYPE_BIT));
+    instance.getVkInstance().instanceCustomIndex |= ((uint32_t)material.getType() << CUSTOM_INDEX_MATERIAL_TYPE_BIT);
 
-    // Fetch the material from the cache
-    m_pResourceCache->find(material, instance.surface.surfaceMaterialIndex);
+    // Index of the material in the resource cache, as returned when the material was tracked
+    assert(&m_pResourceCache->get(surfaceMaterialIndex) == &material);
+    instance.surface.surfaceMaterialIndex = surfaceMaterialIndex;
   }
 
   // Updates the state of the instance with the draw call inputs
@@ -996,7 +1027,7 @@ namespace dxvk {
     currentInstance.surface.instancesToObject = drawCall.getTransformData().instancesToObject;
 
     // setFrameLastUpdated() must be called first as it resets instance's state on a first call in a frame
-    const bool isFirstUpdateThisFrame = currentInstance.setFrameLastUpdated(m_device->getCurrentFrameId());
+    const bool isFirstUpdateThisFrame = currentInstance.setFrameLastUpdated(getCurrentFrameId());
 
     // These can change in the Runtime UI so need to check during update
     currentInstance.m_isHidden = currentInstance.testCategoryFlags(InstanceCategories::Hidden);
@@ -1010,7 +1041,7 @@ namespace dxvk {
     }
 
     // Register camera
-    bool isNewCameraSet = currentInstance.registerCamera(drawCall.cameraType, m_device->getCurrentFrameId());
+    bool isNewCameraSet = currentInstance.registerCamera(drawCall.cameraType, getCurrentFrameId());
 
     const bool overridePreviousCameraUpdate = isNewCameraSet &&
       (drawCall.cameraType == CameraType::Main ||
@@ -1064,7 +1095,7 @@ namespace dxvk {
         // Note: Skip the spritesheet adjustment logic in the surface interaction when using Ray Portal materials as this logic
         // is done later in the Surface Material Interaction (and doing it in both places will just double up the animation).
         currentInstance.surface.skipSurfaceInteractionSpritesheetAdjustment = (currentInstance.m_materialType == MaterialDataType::RayPortal);
-        currentInstance.surface.isInsideFrustum = RtxOptions::AntiCulling::isObjectAntiCullingEnabled() ? currentInstance.m_isInsideFrustum : true;
+        currentInstance.surface.isInsideFrustum = RtxOptions::AntiCulling::isObjectAntiCullingEnabled() ? currentInstance.isInsideFrustum() : true;
 
         currentInstance.surface.blendModeState = drawCall.getMaterialData().blendMode;
 
@@ -1137,7 +1168,7 @@ namespace dxvk {
                                    || currentInstance.testCategoryFlags(InstanceCategories::WorldUI);
 
         hasPreviousPositions = blas.modifiedGeometryData.previousPositionBuffer.defined() && !isMotionUnstable;
-        const bool isFirstUpdateAfterCreation = currentInstance.isCreatedThisFrame(m_device->getCurrentFrameId()) && isFirstUpdateThisFrame;
+        const bool isFirstUpdateAfterCreation = currentInstance.isCreatedThisFrame(getCurrentFrameId()) && isFirstUpdateThisFrame;
 
         // Note: objectToView is aliased on updates, since findSimilarInstance() doesn't discern it
         Matrix4 objectToWorld = drawCall.getTransformData().objectToWorld;
@@ -1173,13 +1204,13 @@ namespace dxvk {
     }
 
     // We only have 1 hit shader.
-    currentInstance.m_vkInstance.instanceShaderBindingTableRecordOffset = 0;
+    currentInstance.getVkInstance().instanceShaderBindingTableRecordOffset = 0;
 
     // Update instance flags.
     // Note: this should happen on instance updates and not creation because the same geometry can be drawn
     // with different flags, and the instance manager can match an old instance of a geometry to a new one with different draw mode.
-    currentInstance.m_vkInstance.flags = determineInstanceFlags(drawCall, currentInstance.surface);
-    currentInstance.isFrontFaceFlipped = (currentInstance.m_vkInstance.flags & VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR) != 0;
+    currentInstance.getVkInstance().flags = determineInstanceFlags(drawCall, currentInstance.surface);
+    currentInstance.isFrontFaceFlipped = (currentInstance.getVkInstance().flags & VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR) != 0;
 
     // Apply the decal sort index for this instance so we can approximate order correctness on the GPU in AHS
     if (currentInstance.surface.alphaState.isDecal) {
@@ -1210,7 +1241,7 @@ namespace dxvk {
       // Unordered resolve only accumulates via any-hits and ignores opaque hits, therefore force 
       // the opaque hits resolve via OMMs to be turned into any-hits.
       // Note: this has unexpected effect even with OMM off and results in minor visual changes in Portal MF A DLSS test
-      currentInstance.m_vkInstance.flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
+      currentInstance.getVkInstance().flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
     } else if (currentInstance.isOpaque() && !currentInstance.surface.alphaState.isFullyOpaque && currentInstance.surface.alphaState.isBlendingDisabled) {
       // Alpha-tested geometry goes to the primary TLAS as non-opaque geometry with potential duplicate hits.
       currentInstance.m_geometryFlags = 0;
@@ -1218,7 +1249,7 @@ namespace dxvk {
       // Alpha-blended geometry goes to the primary TLAS as non-opaque geometry with no duplicate hits.
       currentInstance.m_geometryFlags = VK_GEOMETRY_NO_DUPLICATE_ANY_HIT_INVOCATION_BIT_KHR;
       // Treat all non-transparent hits as any-hits
-      currentInstance.m_vkInstance.flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
+      currentInstance.getVkInstance().flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
     } else if (currentInstance.m_materialType == MaterialDataType::Translucent) {
       // Translucent (e.g. glass) geometry goes to the primary TLAS as non-opaque geometry with no duplicate hits.
       currentInstance.m_geometryFlags = VK_GEOMETRY_NO_DUPLICATE_ANY_HIT_INVOCATION_BIT_KHR;
@@ -1230,7 +1261,7 @@ namespace dxvk {
       // To handle cases when the same *static* object is used both with and without clip planes,
       // use the force bit to avoid BLAS confusion (because the geometry flags are baked into BLAS).
       currentInstance.m_geometryFlags = VK_GEOMETRY_OPAQUE_BIT_KHR;
-      currentInstance.m_vkInstance.flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
+      currentInstance.getVkInstance().flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
     } else {
       // All other fully opaques go to the primary TLAS as opaque.
       currentInstance.m_geometryFlags = VK_GEOMETRY_OPAQUE_BIT_KHR;
@@ -1238,12 +1269,12 @@ namespace dxvk {
     
     // Enable backface culling for Portals to avoid additional hits to the back of Portals
     if (currentInstance.m_materialType == MaterialDataType::RayPortal) {
-      currentInstance.m_vkInstance.flags &= ~VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+      currentInstance.getVkInstance().flags &= ~VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
     }
 
     // Update mask
     {
-      uint mask = isFirstUpdateThisFrame ? 0 : currentInstance.m_vkInstance.mask;
+      uint mask = isFirstUpdateThisFrame ? 0 : currentInstance.getVkInstance().mask;
 
       if (currentInstance.m_isPlayerModel && drawCall.cameraType != CameraType::ViewModel) {
         mask |= OBJECT_MASK_PLAYER_MODEL;
@@ -1277,7 +1308,7 @@ namespace dxvk {
       if (currentInstance.m_isHidden)
         mask = 0;
 
-      currentInstance.m_vkInstance.mask = mask;
+      currentInstance.getVkInstance().mask = mask;
     }
     // This flag translates to a flip of VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR when the instance
     // is a separate BLAS instance, and to nothing if it's a part of a merged BLAS.
@@ -1320,6 +1351,9 @@ namespace dxvk {
   }
 
   void InstanceManager::removeInstance(RtInstance* instance) {
+    // The portal virtual instance index may reference the instance, rebuild it on next use
+    m_portalVirtualInstanceIndexFrameId = kInvalidFrameIndex;
+
     // Always clean up replacement instance references, even for renderer-created instances
     // to avoid use-after-free bugs in ReplacementInstance.prims
     instance->getPrimInstanceOwner().setReplacementInstance(nullptr, ReplacementInstance::kInvalidReplacementIndex, instance, PrimInstance::Type::Instance);
@@ -1350,10 +1384,10 @@ namespace dxvk {
 
     RtInstance* viewModelInstance = createInstanceCopy(reference, needValidGlobalInstanceId);
 
-    const uint32_t frameId = m_device->getCurrentFrameId();
+    const uint32_t frameId = getCurrentFrameId();
     viewModelInstance->setFrameCreated(frameId);
     viewModelInstance->setFrameLastUpdated(frameId);
-    viewModelInstance->m_vkInstance.mask = OBJECT_MASK_VIEWMODEL;
+    viewModelInstance->getVkInstance().mask = OBJECT_MASK_VIEWMODEL;
     viewModelInstance->setCustomIndexBit(CUSTOM_INDEX_IS_VIEW_MODEL, true);
 
     // View model instances are recreated every frame
@@ -1414,7 +1448,7 @@ namespace dxvk {
     // If the first person player model is enabled, hide the view model.
     if (RtxOptions::PlayerModel::enableInPrimarySpace()) {
       for (auto* candidateInstance : m_viewModelCandidates) {
-        candidateInstance->m_vkInstance.mask = 0;
+        candidateInstance->getVkInstance().mask = 0;
       }
       return;
     }
@@ -1460,7 +1494,7 @@ namespace dxvk {
         continue;
 
       // Hide the reference instance since we'll create a separate instance for the view model 
-      candidateInstance->m_vkInstance.mask = 0;
+      candidateInstance->getVkInstance().mask = 0;
 
       // Tag the instance as ViewModel so it can be checked for it being a reference view model instance
       candidateInstance->setCustomIndexBit(CUSTOM_INDEX_IS_VIEW_MODEL, true);
@@ -1676,7 +1710,7 @@ namespace dxvk {
     const SingleRayPortalDirectionInfo* farPortalInfo = nullptr;
     detectIfPlayerModelIsVirtual(cameraManager, rayPortalManager, playerModelPosition, &playerModelIsVirtual, &nearPortalInfo, &farPortalInfo);
         
-    const uint32_t frameId = m_device->getCurrentFrameId();
+    const uint32_t frameId = getCurrentFrameId();
 
     // Set up the math to offset the player model backwards if it's to be shown in primary space
     float backwardOffset = RtxOptions::PlayerModel::backwardOffset();
@@ -1763,13 +1797,13 @@ namespace dxvk {
         }
 
         // Hide the geometric instances but keep them in the list so that surface data is generated for them.
-        originalInstance->m_vkInstance.mask = 0;
-        clonedInstance->m_vkInstance.mask = 0;
+        originalInstance->getVkInstance().mask = 0;
+        clonedInstance->getVkInstance().mask = 0;
       }
       else {
         // Update the instance masks of both instances
-        originalInstance->m_vkInstance.mask = originalInstanceMask;
-        clonedInstance->m_vkInstance.mask = clonedInstanceMask;
+        originalInstance->getVkInstance().mask = originalInstanceMask;
+        clonedInstance->getVkInstance().mask = clonedInstanceMask;
       }
       
       // Update cloned instance transforms given the reference and the portal transform
@@ -1783,13 +1817,13 @@ namespace dxvk {
       clonedInstance->surface.clipPlane = Vector4(farPortalInfo->entryPortalInfo.planeNormal,
         -dot(farPortalInfo->entryPortalInfo.planeNormal, farPortalInfo->entryPortalInfo.centroid));
       // Use the FORCE_NO_OPAQUE flag to enable any-hit processing in the visiblity rays for this clipped instance.
-      clonedInstance->m_vkInstance.flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
+      clonedInstance->getVkInstance().flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
 
       // Same clip plane logic for the original instance, only using the near portal.
       originalInstance->surface.isClipPlaneEnabled = true;
       originalInstance->surface.clipPlane = Vector4(nearPortalInfo->entryPortalInfo.planeNormal,
         -dot(nearPortalInfo->entryPortalInfo.planeNormal, nearPortalInfo->entryPortalInfo.centroid));
-      originalInstance->m_vkInstance.flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
+      originalInstance->getVkInstance().flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
     }
   }
 
@@ -1845,7 +1879,7 @@ namespace dxvk {
 
     const SingleRayPortalDirectionInfo& closestPortalInfo = rayPortalManager.getRayPortalPairInfos()[0]->pairInfos[m_virtualInstancePortalIndex];
     
-    const uint32_t frameId = m_device->getCurrentFrameId();
+    const uint32_t frameId = getCurrentFrameId();
 
     // Create virtual instances for view model instances that are close to portals
     for (RtInstance* referenceInstance : viewModelReferenceInstances) {
@@ -1866,7 +1900,7 @@ namespace dxvk {
       // Virtual instances are to be visible only in their corresponding portal spaces
       static_assert(maxRayPortalCount == 2);
       // View model virtual instance
-      virtualInstance->m_vkInstance.mask = OBJECT_MASK_VIEWMODEL_VIRTUAL;
+      virtualInstance->getVkInstance().mask = OBJECT_MASK_VIEWMODEL_VIRTUAL;
     
       // Update virtual instance transforms given the reference and the portal transform
       {
@@ -1880,8 +1914,7 @@ namespace dxvk {
   }
 
   void InstanceManager::resetSurfaceIndices() {
-    for (auto instance : m_instances)
-      instance->m_surfaceIndex = SURFACE_INDEX_INVALID;
+    m_hotState.resetSurfaceIndices();
   }
 
   inline bool isFpSpecial(float x) {
@@ -27,6 +27,8 @@
 #include <unordered_map>
 #include "../util/rc/util_rc_ptr.h"
 #include "rtx_types.h"
+#include "rtx_instance_hot_state.h"
+#include "rtx_portal_position_index.h"
 #include "../util/util_vector.h"
 #include "../util/util_matrix.h"
 #include "rtx_camera_manager.h"
@@ -46,13 +48,13 @@ public:
   RtSurface surface;
 
   RtInstance() = delete;
-  RtInstance(const uint64_t id, uint32_t instanceVectorId);
+  RtInstance(const uint64_t id, InstanceHotState& hotState, uint32_t instanceVectorId);
   RtInstance(const RtInstance& src, uint64_t id, uint32_t instanceVectorId);
 
   uint64_t getId() const { return m_id; }
   uint32_t getVectorIdx() const { return m_instanceVectorId; }
-  const VkAccelerationStructureInstanceKHR& getVkInstance() const { return m_vkInstance; }
-  VkAccelerationStructureInstanceKHR& getVkInstance() { return m_vkInstance; }
+  const VkAccelerationStructureInstanceKHR& getVkInstance() const { return m_hotState->getVkInstance(m_instanceVectorId); }
+  VkAccelerationStructureInstanceKHR& getVkInstance() { return m_hotState->getVkInstance(m_instanceVectorId); }
   bool isObjectToWorldMirrored() const { return m_isObjectToWorldMirrored; }
 
   BlasEntry* getBlas() const { return m_linkedBlas; }
@@ -61,13 +63,16 @@ public:
   const XXH64_hash_t& getTexcoordHash() const { return m_texcoordHash; }
   const XXH64_hash_t& getIndexHash() const { return m_indexHash; }
   const XXH64_hash_t calculateAntiCullingHash() const;
-  Matrix4 getTransform() const { return transpose(dxvk::Matrix4(m_vkInstance.transform)); }
+  Matrix4 getTransform() const { return transpose(dxvk::Matrix4(getVkInstance().transform)); }
   const Matrix4& getPrevTransform() const { return surface.prevObjectToWorld; }
-  Vector3 getWorldPosition() const { return Vector3{ m_vkInstance.transform.matrix[0][3], m_vkInstance.transform.matrix[1][3], m_vkInstance.transform.matrix[2][3] }; }
+  Vector3 getWorldPosition() const {
+    const VkTransformMatrixKHR& transform = getVkInstance().transform;
+    return Vector3{ transform.matrix[0][3], transform.matrix[1][3], transform.matrix[2][3] };
+  }
   const Vector3& getPrevWorldPosition() const { return surface.prevObjectToWorld.data[3].xyz(); }
 
   void removeFromSpatialCache() {
-    if (m_isCreatedByRenderer || !m_linkedBlas || m_isUnlinkedForGC || m_spatialCacheHash == kEmptyHash) {
+    if (m_isCreatedByRenderer || !m_linkedBlas || isUnlinkedForGC() || m_spatialCacheHash == kEmptyHash) {
       return;
     }
     m_linkedBlas->getSpatialMap().erase(m_spatialCacheHash);
@@ -93,8 +98,8 @@ public:
   void setFrameCreated(const uint32_t frameIndex);
   // Returns if this is the first occurence in a given frame
   bool setFrameLastUpdated(const uint32_t frameIndex);
-  uint32_t getFrameLastUpdated() const { return m_frameLastUpdated; } 
-  uint32_t getFrameAge() const { return m_frameLastUpdated - m_frameCreated; }
+  uint32_t getFrameLastUpdated() const { return m_hotState->getFrameLastUpdated(m_instanceVectorId); }
+  uint32_t getFrameAge() const { return getFrameLastUpdated() - m_frameCreated; }
   // Signal this object should be collected on the next GC pass
   void markForGarbageCollection() const;
   void markAsUnlinkedFromBlasEntryForGarbageCollection() const;
@@ -123,16 +128,16 @@ public:
     return m_isAnimated;
   }
   void setSurfaceIndex(uint32_t surfaceIndex) {
-    m_surfaceIndex = surfaceIndex;
+    m_hotState->setSurfaceIndex(m_instanceVectorId, surfaceIndex);
   }
   uint32_t getSurfaceIndex() const {
-    return m_surfaceIndex;
+    return m_hotState->getSurfaceIndex(m_instanceVectorId);
   }
   void setPreviousSurfaceIndex(uint32_t surfaceIndex) {
-    m_previousSurfaceIndex = surfaceIndex;
+    m_hotState->setPreviousSurfaceIndex(m_instanceVectorId, surfaceIndex);
   }
   uint32_t getPreviousSurfaceIndex() const {
-    return m_previousSurfaceIndex;
+    return m_hotState->getPreviousSurfaceIndex(m_instanceVectorId);
   }
   OpacityMicromapInstanceData& getOpacityMicromapInstanceData() { return m_opacityMicromapInstanceData; }
   const OpacityMicromapInstanceData& getOpacityMicromapInstanceData() const { return m_opacityMicromapInstanceData; }
@@ -152,7 +157,7 @@ uint32_t getFirstBillboardIndex() const { return m_firstBillboard; }
   bool isViewModelVirtual() const;
   bool isSubsurface() const { return m_isSubsurface; }
 
-  bool isUnlinkedForGC() const { return m_isUnlinkedForGC; }
+  bool isUnlinkedForGC() const { return m_hotState->hasFlag(m_instanceVectorId, InstanceHotState::UnlinkedForGC); }
 
   PrimInstanceOwner& getPrimInstanceOwner() { return m_primInstanceOwner; }
   
@@ -167,19 +172,17 @@ private:
     return surface.objectToWorld;
   }
   void onTransformChanged();
+  bool isInsideFrustum() const { return m_hotState->hasFlag(m_instanceVectorId, InstanceHotState::InsideFrustum); }
   friend class InstanceManager;
 
   // Unique ID of the RtInstance.
   // Sentinel value UINT64_MAX indicates that such RtInstance is a "virtual" instance, and is ignored by some features,
   // most notably the GameCapturer
   const uint64_t m_id;
-  mutable uint32_t m_instanceVectorId; // Index within instance vector in instance manager
-
-  mutable bool m_isMarkedForGC = false;
-  mutable bool m_isUnlinkedForGC = false;
-  mutable bool m_isInsideFrustum = true;
-  mutable uint32_t m_frameLastUpdated = kInvalidFrameIndex;
+  mutable uint32_t m_instanceVectorId; // Index within instance vector in instance manager, also the slot of the instance's hot state
   mutable uint32_t m_frameCreated = kInvalidFrameIndex;
+  // Per-frame state (frame last updated, GC and frustum flags, surface indices, VK instance) lives in the instance manager's dense arrays
+  InstanceHotState* m_hotState;
 
   std::vector<CameraType::Enum> m_seenCameraTypes;  // Camera types with which the instance has been originally rendered with
 
@@ -197,9 +200,6 @@ private:
   // Stored in instance object to avoid indirection of looking it up for an instance
   OpacityMicromapInstanceData m_opacityMicromapInstanceData;
 
-  uint32_t m_surfaceIndex;        // Material surface index for reordered surfaces by AccelManager
-  uint32_t m_previousSurfaceIndex;
-
   bool m_isHidden = false;
   bool m_isPlayerModel = false;
   bool m_isWorldSpaceUI = false;
@@ -212,7 +212,6 @@ private:
   XXH64_hash_t m_materialDataHash = kEmptyHash;
   XXH64_hash_t m_texcoordHash = kEmptyHash;
   XXH64_hash_t m_indexHash = kEmptyHash;
-  VkAccelerationStructureInstanceKHR m_vkInstance;
   VkGeometryFlagsKHR m_geometryFlags = 0;
   uint32_t m_firstBillboard = 0;
   uint32_t m_billboardCount = 0;
@@ -280,6 +279,10 @@ public:
   // Return a list of instances currently active in the scene
   const std::vector<RtInstance*>& getInstanceTable() const { return m_instances; }
 
+  // Per-frame state of the instances, indexed by RtInstance::getVectorIdx()
+  const InstanceHotState& getHotState() const { return m_hotState; }
+  InstanceHotState& getHotState() { return m_hotState; }
+
   // Returns the active number of instances in scene
   const uint32_t getActiveCount() const { return m_instances.size(); }
   
@@ -303,8 +306,8 @@ public:
     const CameraManager& cameraManager, const RayPortalManager& rayPortalManager,
     BlasEntry& blas, const DrawCallState& drawCall, MaterialData& materialData, RtInstance* existingInstance);
 
-  // Binds a raytracing material to the specified instance.
-  void bindMaterial(RtInstance& instance, const RtSurfaceMaterial& material);
+  // Binds a raytracing material to the specified instance, surfaceMaterialIndex is the material's index in the resource cache.
+  void bindMaterial(RtInstance& instance, const RtSurfaceMaterial& material, uint32_t surfaceMaterialIndex);
 
   // Creates a copy of a reference instance and adds it to the instance pool
   // Temporary single frame instances generated every frame should disable valid id generation to avoid overflowing it
@@ -328,14 +331,20 @@ public:
   void resetSurfaceIndices();
 
   const std::vector<IntersectionBillboard>& getBillboards() const { return m_billboards; }
+
+  // Reads the frame index from pFrameId instead of the device, so that scene ingest can be replayed without a device (i.e. in benchmarks)
+  void overrideFrameIdSource(const uint32_t* pFrameId) { m_pFrameIdOverride = pFrameId; }
   
 private:
   ResourceCache* m_pResourceCache;
+  const uint32_t* m_pFrameIdOverride = nullptr;
 
   // Start at 1 to avoid using 0 - makes it easier to detect a 0 initialized RtInstance (which is invalid)
   uint64_t m_nextInstanceId = 1;
 
   std::vector<RtInstance*> m_instances; 
+  InstanceHotState m_hotState;  // Parallel to m_instances
+  std::vector<uint32_t> m_expiredInstanceSlots;  // Persistent to avoid reallocations in garbageCollection()
   std::vector<RtInstance*> m_viewModelCandidates;
   std::vector<RtInstance*> m_playerModelInstances;
   std::vector<IntersectionBillboard> m_billboards;
@@ -349,14 +358,24 @@ private:
   // Negative values mean there is no portal that's close enough to the camera.
   int m_virtualInstancePortalIndex = 0;    
 
+  // Predicted positions of last frame's instances as seen through each portal direction, used to match ViewModel draw calls
+  // against the virtual counterparts of instances in findSimilarInstance(). Built on first use in a frame.
+  static constexpr uint32_t kMaxPortalDirections = 2;  // Both directions of the single supported portal pair
+  PortalPositionIndex<RtInstance, kMaxPortalDirections> m_portalVirtualInstanceIndex;
+  uint32_t m_portalVirtualInstanceIndexFrameId = kInvalidFrameIndex;
+
   std::vector<InstanceEventHandler> m_eventHandlers;
 
+  uint32_t getCurrentFrameId() const;
+
   // Handles the case of when two (or more) identical geometries+textures draw calls have been submitted in a single frame (typically used for two-pass rendering in FF)
   void mergeInstanceHeuristics(RtInstance& instanceToModify, const DrawCallState& drawCall, const RtSurface::AlphaState& alphaState) const;
 
   // Finds the "closest" matching instance to a set of inputs, returns a pointer (can be null if not found) to closest instance
   RtInstance* findSimilarInstance(BlasEntry& blas, const MaterialData& material, const Matrix4& firstInstanceObjectToWorld, CameraType::Enum cameraType, const RayPortalManager& rayPortalManager);
 
+  void buildPortalVirtualInstanceIndex(const RayPortalManager& rayPortalManager);
+
   RtInstance* addInstance(BlasEntry& blas);
   void processInstanceBuffers(const BlasEntry& blas, RtInstance& currentInstance) const;
 
@@ -94,6 +94,16 @@ static inline bool sphereIntersectsFrustum(
   return frustum.CheckSphere(float3(center.x, center.y, center.z), radius);
 }
 
+// Copies the planes of a frustum, i.e. for testing batches of view space boxes with dxvk::BoundingBoxBatch
+static inline void getFrustumPlanes(
+  cFrustum& frustum,                            // The frustum to read the planes from
+  dxvk::Vector4 (&planes)[PLANES_NUM]) {        // The planes, (normal, offset) with the inside in the positive half-space
+  for (uint32_t planeIdx = 0; planeIdx < PLANES_NUM; ++planeIdx) {
+    const float4& plane = frustum.GetPlane(planeIdx);
+    planes[planeIdx] = dxvk::Vector4(plane.x, plane.y, plane.z, plane.w);
+  }
+}
+
 // Fast BoundingBox-Frustum intersection check
 static inline bool boundingBoxIntersectsFrustum(
   cFrustum& frustum,                   // The frustum check for intersection
@@ -0,0 +1,275 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace dxvk {
+  /**
+   * \brief Online keyframe reduction of a time sampled value
+   *
+   * Samples are appended in time order to a track whose last sample is tentative. When a new sample arrives the
+   * tail is dropped if interpolating between the last key and the new sample reproduces it, and every sample dropped
+   * since that key. Dropped samples are only kept for that test, at most maxDropped of them: a key is forced at
+   * least every maxDropped + 1 samples, which bounds the memory held for a track.
+   */
+  template<typename T>
+  class KeyframeReducer {
+  public:
+    explicit KeyframeReducer(size_t maxDropped)
+      : m_maxDropped(maxDropped) { }
+
+    /**
+     * \brief Decides whether the tail of a track is dropped for a new sample
+     *
+     * \param [in] reproduces Callable (const T& a, const T& b, double t, const T& sample) returning true if
+     *   interpolating from a to b at t in [0, 1] is within tolerance of the sample
+     * \returns True if the tail was dropped, to be replaced by the new sample. Otherwise the tail became a key
+     *   and the new sample is to be appended.
+     */
+    template<typename Reproduces>
+    bool dropTail(double keyTime, const T& key,
+                  double tailTime, T tail,
+                  double nextTime, const T& next,
+                  const Reproduces& reproduces) {
+      if (keyTime >= tailTime || tailTime >= nextTime || m_dropped.size() >= m_maxDropped) {
+        m_dropped.clear();
+        return false;
+      }
+
+      const double span = nextTime - keyTime;
+      const auto isReproduced = [&](double time, const T& sample) {
+        return reproduces(key, next, (time - keyTime) / span, sample);
+      };
+
+      if (!isReproduced(tailTime, tail)) {
+        m_dropped.clear();
+        return false;
+      }
+
+      for (const auto& [time, sample] : m_dropped) {
+        if (!isReproduced(time, sample)) {
+          m_dropped.clear();
+          return false;
+        }
+      }
+
+      m_dropped.emplace_back(tailTime, std::move(tail));
+      return true;
+    }
+
+    void reset() {
+      m_dropped.clear();
+    }
+
+    size_t numDropped() const {
+      return m_dropped.size();
+    }
+
+  private:
+    size_t m_maxDropped;
+    std::vector<std::pair<double, T>> m_dropped;
+  };
+
+  /**
+   * \brief Tolerances of a transform reproduced by interpolation
+   *
+   * Transforms are 4x4 affine matrices indexed [row][column] with the basis vectors in rows 0-2 and the
+   * translation in row 3, the layout shared by Matrix4 and pxr::GfMatrix4d.
+   */
+  struct XformTolerance {
+    double translation;  // Distance between the translations
+    double basis;        // Distance between each basis vector, relative to its length
+  };
+
+  template<typename M>
+  bool isXformWithinTolerance(const M& a, const M& b, const XformTolerance& tolerance) {
+    const auto distanceSq = [&](int row) {
+      double sum = 0.0;
+      for (int col = 0; col < 3; col++) {
+        const double d = static_cast<double>(a[row][col]) - static_cast<double>(b[row][col]);
+        sum += d * d;
+      }
+      return sum;
+    };
+
+    if (distanceSq(3) > tolerance.translation * tolerance.translation) {
+      return false;
+    }
+
+    for (int row = 0; row < 3; row++) {
+      double lengthSq = 0.0;
+      for (int col = 0; col < 3; col++) {
+        lengthSq += static_cast<double>(b[row][col]) * static_cast<double>(b[row][col]);
+      }
+
+      const double maxDistance = tolerance.basis * std::max(std::sqrt(lengthSq), 1e-6);
+      if (distanceSq(row) > maxDistance * maxDistance) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Component wise interpolation, how USD interpolates time sampled transform ops
+  template<typename M>
+  M lerpXform(const M& a, const M& b, double t) {
+    M result = a;
+    for (int row = 0; row < 4; row++) {
+      for (int col = 0; col < 4; col++) {
+        const double va = static_cast<double>(a[row][col]);
+        const double vb = static_cast<double>(b[row][col]);
+        result[row][col] = va + (vb - va) * t;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * \brief Interpolation of the translation, rotation and scale of transforms
+   *
+   * How UsdSkel interpolates the joint transforms of an animation: translation and scale are interpolated
+   * linearly, rotation along the shortest arc. Mirroring transforms keep the mirror of a.
+   */
+  template<typename M>
+  M slerpXform(const M& a, const M& b, double t) {
+    struct Components {
+      double translation[3];
+      double scale[3];
+      double rotation[4];  // x, y, z, w
+    };
+
+    const auto decompose = [](const M& m) {
+      Components c;
+      double basis[3][3];
+      for (int row = 0; row < 3; row++) {
+        c.translation[row] = static_cast<double>(m[3][row]);
+
+        double lengthSq = 0.0;
+        for (int col = 0; col < 3; col++) {
+          basis[row][col] = static_cast<double>(m[row][col]);
+          lengthSq += basis[row][col] * basis[row][col];
+        }
+
+        c.scale[row] = std::sqrt(lengthSq);
+        for (int col = 0; col < 3; col++) {
+          basis[row][col] = c.scale[row] > 0.0 ? basis[row][col] / c.scale[row] : (row == col ? 1.0 : 0.0);
+        }
+      }
+
+      const double det =
+        basis[0][0] * (basis[1][1] * basis[2][2] - basis[1][2] * basis[2][1]) -
+        basis[0][1] * (basis[1][0] * basis[2][2] - basis[1][2] * basis[2][0]) +
+        basis[0][2] * (basis[1][0] * basis[2][1] - basis[1][1] * basis[2][0]);
+      if (det < 0.0) {
+        c.scale[0] = -c.scale[0];
+        for (int col = 0; col < 3; col++) {
+          basis[0][col] = -basis[0][col];
+        }
+      }
+
+      double* q = c.rotation;
+      const double trace = basis[0][0] + basis[1][1] + basis[2][2];
+      if (trace > 0.0) {
+        const double s = std::sqrt(trace + 1.0) * 2.0;
+        q[3] = 0.25 * s;
+        q[0] = (basis[2][1] - basis[1][2]) / s;
+        q[1] = (basis[0][2] - basis[2][0]) / s;
+        q[2] = (basis[1][0] - basis[0][1]) / s;
+      } else if (basis[0][0] > basis[1][1] && basis[0][0] > basis[2][2]) {
+        const double s = std::sqrt(1.0 + basis[0][0] - basis[1][1] - basis[2][2]) * 2.0;
+        q[3] = (basis[2][1] - basis[1][2]) / s;
+        q[0] = 0.25 * s;
+        q[1] = (basis[0][1] + basis[1][0]) / s;
+        q[2] = (basis[0][2] + basis[2][0]) / s;
+      } else if (basis[1][1] > basis[2][2]) {
+        const double s = std::sqrt(1.0 + basis[1][1] - basis[0][0] - basis[2][2]) * 2.0;
+        q[3] = (basis[0][2] - basis[2][0]) / s;
+        q[0] = (basis[0][1] + basis[1][0]) / s;
+        q[1] = 0.25 * s;
+        q[2] = (basis[1][2] + basis[2][1]) / s;
+      } else {
+        const double s = std::sqrt(1.0 + basis[2][2] - basis[0][0] - basis[1][1]) * 2.0;
+        q[3] = (basis[1][0] - basis[0][1]) / s;
+        q[0] = (basis[0][2] + basis[2][0]) / s;
+        q[1] = (basis[1][2] + basis[2][1]) / s;
+        q[2] = 0.25 * s;
+      }
+
+      return c;
+    };
+
+    const Components ca = decompose(a);
+    Components cb = decompose(b);
+
+    double cosAngle = 0.0;
+    for (int i = 0; i < 4; i++) {
+      cosAngle += ca.rotation[i] * cb.rotation[i];
+    }
+    if (cosAngle < 0.0) {
+      cosAngle = -cosAngle;
+      for (int i = 0; i < 4; i++) {
+        cb.rotation[i] = -cb.rotation[i];
+      }
+    }
+
+    // Normalized linear interpolation is accurate enough for nearly parallel rotations
+    double wa = 1.0 - t;
+    double wb = t;
+    if (cosAngle < 0.9995) {
+      const double angle = std::acos(cosAngle);
+      const double sinAngle = std::sin(angle);
+      wa = std::sin((1.0 - t) * angle) / sinAngle;
+      wb = std::sin(t * angle) / sinAngle;
+    }
+
+    double q[4];
+    double lengthSq = 0.0;
+    for (int i = 0; i < 4; i++) {
+      q[i] = ca.rotation[i] * wa + cb.rotation[i] * wb;
+      lengthSq += q[i] * q[i];
+    }
+    const double invLength = 1.0 / std::sqrt(lengthSq);
+    const double x = q[0] * invLength, y = q[1] * invLength, z = q[2] * invLength, w = q[3] * invLength;
+
+    const double rotation[3][3] = {
+      { 1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y - z * w),       2.0 * (x * z + y * w) },
+      { 2.0 * (x * y + z * w),       1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z - x * w) },
+      { 2.0 * (x * z - y * w),       2.0 * (y * z + x * w),       1.0 - 2.0 * (x * x + y * y) }
+    };
+
+    M result = lerpXform(a, b, t);
+    for (int row = 0; row < 3; row++) {
+      const double scale = ca.scale[row] + (std::copysign(cb.scale[row], ca.scale[row]) - ca.scale[row]) * t;
+      for (int col = 0; col < 3; col++) {
+        result[row][col] = rotation[row][col] * scale;
+      }
+      result[3][row] = ca.translation[row] + (cb.translation[row] - ca.translation[row]) * t;
+    }
+    return result;
+  }
+}
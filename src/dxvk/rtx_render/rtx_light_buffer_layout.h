@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace dxvk {
+
+struct LightRange {
+  uint32_t offset;
+  uint32_t count;
+};
+
+// Lays out the active lights of a frame in the light buffer. The shaders expect the lights of each type in one
+// contiguous range, so collected lights are sorted by type with a counting sort (i.e. a single digit radix sort, there
+// are only a handful of types). The sort is stable: lights keep their collection order within their type's range, so
+// a light set that doesn't change from frame to frame keeps its buffer indices.
+// The few fields the layout needs are stored as parallel arrays, the caller refers to its own light objects through
+// the source index given when collecting them.
+template<uint32_t NumTypes>
+class LightBufferLayout {
+public:
+  void clear() {
+    m_sources.clear();
+    m_types.clear();
+    m_previousBufferIndices.clear();
+    m_order.clear();
+    m_ranges.fill(LightRange {});
+  }
+
+  uint32_t size() const {
+    return static_cast<uint32_t>(m_sources.size());
+  }
+
+  void add(uint32_t source, uint32_t type, uint16_t previousBufferIdx) {
+    assert(type < NumTypes);
+    m_sources.push_back(source);
+    m_types.push_back(static_cast<uint8_t>(type));
+    m_previousBufferIndices.push_back(previousBufferIdx);
+  }
+
+  // Assigns buffer indices to the collected lights
+  void build() {
+    m_ranges.fill(LightRange {});
+    for (uint8_t type : m_types) {
+      ++m_ranges[type].count;
+    }
+
+    uint32_t offset = 0;
+    std::array<uint32_t, NumTypes> next;
+    for (uint32_t type = 0; type < NumTypes; ++type) {
+      m_ranges[type].offset = offset;
+      next[type] = offset;
+      offset += m_ranges[type].count;
+    }
+
+    m_order.resize(size());
+    for (uint32_t i = 0; i < size(); ++i) {
+      m_order[next[m_types[i]]++] = i;
+    }
+  }
+
+  const std::array<LightRange, NumTypes>& getRanges() const {
+    return m_ranges;
+  }
+
+  // Source of the light placed at a buffer index
+  uint32_t getSource(uint32_t bufferIdx) const {
+    return m_sources[m_order[bufferIdx]];
+  }
+
+  uint16_t getPreviousBufferIdx(uint32_t bufferIdx) const {
+    return m_previousBufferIndices[m_order[bufferIdx]];
+  }
+
+  // Writes the mapping RTXDI uses to follow lights across frames, size() + previousCount entries. Entry i holds the
+  // previous buffer index of the light now at index i, entry size() + p the current index of the light previously at
+  // index p. Lights which are new, or gone, are mapped to newLightIdx.
+  void writeMapping(uint16_t* pMapping, uint32_t previousCount, uint16_t newLightIdx) const {
+    std::fill(pMapping, pMapping + size() + previousCount, newLightIdx);
+
+    for (uint32_t bufferIdx = 0; bufferIdx < size(); ++bufferIdx) {
+      const uint16_t previousBufferIdx = getPreviousBufferIdx(bufferIdx);
+      pMapping[bufferIdx] = previousBufferIdx;
+
+      if (previousBufferIdx != newLightIdx) {
+        assert(previousBufferIdx < previousCount);
+        pMapping[size() + previousBufferIdx] = static_cast<uint16_t>(bufferIdx);
+      }
+    }
+  }
+
+private:
+  std::vector<uint32_t> m_sources;
+  std::vector<uint8_t> m_types;
+  std::vector<uint16_t> m_previousBufferIndices;
+  // Collection index of the light at each buffer index
+  std::vector<uint32_t> m_order;
+  std::array<LightRange, NumTypes> m_ranges {};
+};
+
+}
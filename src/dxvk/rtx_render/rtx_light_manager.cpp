@@ -22,6 +22,7 @@
 #include <vector>
 #include <cmath>
 #include <cassert>
+#include <ppl.h>
 
 #include "rtx_light_manager.h"
 #include "rtx_context.h"
@@ -337,6 +338,7 @@ namespace dxvk {
     m_currentActiveLightCount = 0;
 
     std::swap(m_lightBuffer, m_previousLightBuffer);
+    std::swap(m_lightBufferHash, m_previousLightBufferHash);
 
     // Linearize the light list
     // Note: This is done rather than just iterating over the light list twice mostly so that the fallback light
@@ -367,38 +369,28 @@ namespace dxvk {
      }
     }
 
-    // Count the active light of each type
+    // Collect the active lights and arrange the ranges of each type sequentially in the buffer
 
-    m_lightTypeRanges.fill(LightRange {});
-    for (auto&& linearizedLight : m_linearizedLights) {
-      const RtLight& light = *linearizedLight;
-
-      if (light.getColorAndIntensity().w <= 0) {
-        continue;
-      }
-
-      ++m_lightTypeRanges[static_cast<uint32_t>(light.getType())].count;
-      ++m_currentActiveLightCount;
+    m_lightBufferLayout.clear();
+    for (uint32_t i = 0; i < m_linearizedLights.size(); ++i) {
+      RtLight& light = *m_linearizedLights[i];
 
       // Note: Highest light index reserved for the invalid index sentinel.
-      if (m_currentActiveLightCount == LIGHT_INDEX_INVALID) {
-        ONCE(Logger::info(str::format("[RTX-Compatibility-Info] Raytracing support more than 65535 lights currently, skipping some lights for now.")));
-        break;
-      }
-    }
-
-    // Arrange the ligth ranges of each types sequentially in the buffer, reset the counts
+      if (light.getColorAndIntensity().w > 0 && m_lightBufferLayout.size() < LIGHT_INDEX_INVALID) {
+        m_lightBufferLayout.add(i, static_cast<uint32_t>(light.getType()), static_cast<uint16_t>(light.getBufferIdx()));
+      } else {
+        if (light.getColorAndIntensity().w > 0) {
+          ONCE(Logger::info(str::format("[RTX-Compatibility-Info] Raytracing support more than 65535 lights currently, skipping some lights for now.")));
+        }
 
-    uint offset = 0;
-    for (uint lightType = 0; lightType < lightTypeCount; ++lightType) {
-      LightRange& range = m_lightTypeRanges[lightType];
-      range.offset = offset;
-      offset += range.count;
-      range.count = 0;
+        // This light is either disabled or didn't fit into the buffer, so set its buffer index to invalid.
+        light.setBufferIdx(kNewLightIdx);
+      }
     }
 
-    assert(offset == m_currentActiveLightCount);
-    uint32_t lightsWritten = 0;
+    m_lightBufferLayout.build();
+    m_lightTypeRanges = m_lightBufferLayout.getRanges();
+    m_currentActiveLightCount = m_lightBufferLayout.size();
 
     const size_t lightsGPUSize = m_currentActiveLightCount * kLightGPUSize;
     const uint32_t lightMappingBufferEntries = m_currentActiveLightCount + previousLightActiveCount;
@@ -409,44 +401,14 @@ namespace dxvk {
     // is not an issue and the buffers are allowed to keep whatever capacity they have allocated between calls for the sake of performance.
 
     m_lightsGPUData.resize(lightsGPUSize);
-    memset(m_lightsGPUData.data(), 0xff, sizeof(char)* m_lightsGPUData.size());
     m_lightMappingData.resize(lightMappingBufferEntries);
 
-    // Clear all slots to new light
-    memset(m_lightMappingData.data(), kNewLightIdx, sizeof(uint16_t) * m_lightMappingData.size());
-
-    // Write the light data into the previously allocated ranges
-    for (auto&& linearizedLight : m_linearizedLights) {
-      RtLight& light = *linearizedLight;
+    // RTXDI needs a mapping from previous light idx to current (to deal with light list reordering),
+    // and also a mapping from current light idx to previous (for unbiased resampling)
+    m_lightBufferLayout.writeMapping(m_lightMappingData.data(), previousLightActiveCount, kNewLightIdx);
 
-      if (light.getColorAndIntensity().w > 0 && lightsWritten < m_currentActiveLightCount) {
-        // Find the buffer location for this light
-        LightRange& range = m_lightTypeRanges[static_cast<uint32_t>(light.getType())];
-        uint32_t newBufferIdx = range.offset + range.count;
-        ++range.count;
-
-        // RTXDI needs a mapping from previous light idx to current (to deal with light list reordering)
-        if (light.getBufferIdx() != kNewLightIdx)
-          m_lightMappingData[m_currentActiveLightCount + light.getBufferIdx()] = (uint16_t)newBufferIdx;
-
-        // Also a mapping from current light idx to previous (for unbiased resampling)
-        m_lightMappingData[newBufferIdx] = light.getBufferIdx();
-
-        // Prepare data for GPU
-        size_t dataOffset = newBufferIdx * kLightGPUSize;
-        assert(dataOffset < lightsGPUSize);
-        light.writeGPUData(m_lightsGPUData.data(), dataOffset);
-
-        // Update the position in buffer for next frame
-        light.setBufferIdx(newBufferIdx);
-
-        // Guard against overflowing the light buffer, in case the light counting loop above terminated early
-        ++lightsWritten;
-      } else {
-        // This light is either disabled or didn't fit into the buffer, so set its buffer index to invalid.
-        light.setBufferIdx(kNewLightIdx);
-      }
-    }
+    // Prepare data for GPU, and update the position in buffer of each light for next frame
+    writeLightsGPUData();
 
     // Allocate the light buffer and copy its contents from host to device memory
     DxvkBufferCreateInfo info;
@@ -461,19 +423,39 @@ namespace dxvk {
     // fine swapping back and forth from that point onwards.
     if (info.size > 0 && (m_lightBuffer == nullptr || info.size > m_lightBuffer->info().size)) {
       m_lightBuffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::RTXBuffer, "Light Buffer");
+      m_lightBufferHash = kEmptyHash;
     }
 
     info.size = align(lightMappingBufferEntries * sizeof(uint16_t), kBufferAlignment);
     if (info.size > 0 && (m_lightMappingBuffer == nullptr || info.size > m_lightMappingBuffer->info().size)) {
       m_lightMappingBuffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::RTXBuffer, "Light Mapping Buffer");
+      m_lightMappingBufferHash = kEmptyHash;
     }
-    
+
+    // Skip uploads when the buffers already hold the same data, which is the common case for scenes with a static light set.
+    // Note: The light count is part of the hashes since the buffers may hold data past the range in use.
     if (!m_lightsGPUData.empty()) {
-      ctx->writeToBuffer(m_lightBuffer, 0, m_lightsGPUData.size(), m_lightsGPUData.data());
+      XXH64_hash_t lightsHash = XXH64(m_lightsGPUDataChunkHashes.data(), m_lightsGPUDataChunkHashes.size() * sizeof(XXH64_hash_t), m_currentActiveLightCount);
+      if (lightsHash == kEmptyHash) {
+        lightsHash = 1;
+      }
+
+      if (lightsHash != m_lightBufferHash) {
+        ctx->writeToBuffer(m_lightBuffer, 0, m_lightsGPUData.size(), m_lightsGPUData.data());
+        m_lightBufferHash = lightsHash;
+      }
     }
 
     if (!m_lightMappingData.empty()) {
-      ctx->writeToBuffer(m_lightMappingBuffer, 0, m_lightMappingData.size() * sizeof(uint16_t), m_lightMappingData.data());
+      XXH64_hash_t mappingHash = XXH3_64bits_withSeed(m_lightMappingData.data(), m_lightMappingData.size() * sizeof(uint16_t), m_currentActiveLightCount);
+      if (mappingHash == kEmptyHash) {
+        mappingHash = 1;
+      }
+
+      if (mappingHash != m_lightMappingBufferHash) {
+        ctx->writeToBuffer(m_lightMappingBuffer, 0, m_lightMappingData.size() * sizeof(uint16_t), m_lightMappingData.data());
+        m_lightMappingBufferHash = mappingHash;
+      }
     }
 
     // If there are no lights with >0 intensity, then clear the list...
@@ -501,6 +483,46 @@ namespace dxvk {
     m_externalActiveLightList.clear();
   }
 
+  void LightManager::writeLightsGPUData() {
+    ScopedCpuProfileZone();
+    // Lights are serialized in chunks, which are spread over worker threads once there are enough of them.
+    // Each chunk is hashed right after being written, while still in cache, to detect unchanged light data.
+    static constexpr uint32_t kLightsPerChunk = 1024;
+
+    const uint32_t numChunks = (m_currentActiveLightCount + kLightsPerChunk - 1) / kLightsPerChunk;
+    m_lightsGPUDataChunkHashes.resize(numChunks);
+
+    auto writeChunk = [this](uint32_t chunk) {
+      const uint32_t begin = chunk * kLightsPerChunk;
+      const uint32_t end = std::min(begin + kLightsPerChunk, m_currentActiveLightCount);
+      unsigned char* pChunkData = m_lightsGPUData.data() + begin * kLightGPUSize;
+
+      // Note: Padding is only written in debug builds, clear it so that the hashes only depend on the light data
+      memset(pChunkData, 0xff, (end - begin) * kLightGPUSize);
+
+      for (uint32_t bufferIdx = begin; bufferIdx < end; ++bufferIdx) {
+        const RtLight& light = *m_linearizedLights[m_lightBufferLayout.getSource(bufferIdx)];
+
+        size_t dataOffset = bufferIdx * kLightGPUSize;
+        light.writeGPUData(m_lightsGPUData.data(), dataOffset);
+
+        // Update the position in buffer for next frame
+        light.setBufferIdx(bufferIdx);
+      }
+
+      m_lightsGPUDataChunkHashes[chunk] = XXH3_64bits(pChunkData, (end - begin) * kLightGPUSize);
+    };
+
+    // It's only worth the effort if theres at least 3 threads saturated
+    if (numChunks > 3) {
+      concurrency::parallel_for<uint32_t>(0, numChunks, writeChunk);
+    } else {
+      for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+        writeChunk(chunk);
+      }
+    }
+  }
+
   static const float kNotSimilar = -1.f;
   float LightManager::isSimilar(const RtLight& a, const RtLight& b, float distanceThreshold) {
     static const float kCosAngleSimilarityThreshold = cos(5.f * kPi / 180.f);
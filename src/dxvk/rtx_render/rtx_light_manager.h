@@ -29,6 +29,7 @@
 #include "rtx/utility/shader_types.h"
 #include "rtx/concept/light/light_types.h"
 #include "rtx_lights.h"
+#include "rtx_light_buffer_layout.h"
 #include "rtx_camera_manager.h"
 #include "rtx_common_object.h"
 #include "rtx/pass/common_binding_indices.h"
@@ -42,11 +43,6 @@ namespace dxvk {
 class DxvkContext;
 class DxvkDevice;
 
-struct LightRange {
-  uint32_t offset;
-  uint32_t count;
-};
-
 struct LightManager : public CommonDeviceObject {
 public:
   enum class FallbackLightMode : int {
@@ -136,8 +132,18 @@ private:
   // of the memory behind these buffers between each call (at the cost of slightly more persistent
   // memory usage, but these buffers are fairly small at only 4 MiB or so max with 2^16 lights present).
   std::vector<RtLight*> m_linearizedLights{};
+  LightBufferLayout<lightTypeCount> m_lightBufferLayout;
   std::vector<unsigned char> m_lightsGPUData{};
   std::vector<uint16_t> m_lightMappingData{};
+  std::vector<XXH64_hash_t> m_lightsGPUDataChunkHashes{};
+
+  // Hashes of the data last uploaded to each buffer, used to skip uploading unchanged data.
+  // Note: The light buffers are swapped every frame, so the light buffer hash is the one from two frames ago.
+  XXH64_hash_t m_lightBufferHash = kEmptyHash;
+  XXH64_hash_t m_previousLightBufferHash = kEmptyHash;
+  XXH64_hash_t m_lightMappingBufferHash = kEmptyHash;
+
+  void writeLightsGPUData();
 
   // Mutex to prevent the debugging UI from accessing the light data after it's been deleted.
   mutable std::mutex m_lightUIMutex;
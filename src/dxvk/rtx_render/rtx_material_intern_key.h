@@ -0,0 +1,70 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+
+#include "rtx_constants.h"
+#include "vulkan/vulkan_core.h"
+
+namespace dxvk {
+  /**
+   * \brief Key of a draw call material resolved by SceneManager::determineMaterialData
+   *
+   * Made of everything the resolution reads. Game textures are identified by the view they are bound
+   * through as well as by their image: D3D9 binds the sRGB or the linear view of a texture depending on
+   * D3DSAMP_SRGBTEXTURE, which the game sampler does not record, and views may cover different mips.
+   */
+  struct MaterialInternKey {
+    struct TextureView {
+      XXH64_hash_t imageHash = kEmptyHash;
+      size_t viewKey = 0;  // TextureRef unique key, derived from the view handle for game textures
+      VkFormat format = VK_FORMAT_UNDEFINED;
+      uint32_t minLevel = 0;
+      uint32_t numLevels = 0;
+      uint32_t minLayer = 0;
+      uint32_t numLayers = 0;
+    };
+
+    TextureView textures[2];
+    const void* sampler = nullptr;
+    const void* replacementMaterial = nullptr;
+    XXH64_hash_t replacementMaterialHash = kEmptyHash;
+
+    XXH64_hash_t getHash() const {
+      // Hashed member by member, padding bytes are not initialized
+      uint64_t values[2 * 5 + 3];
+      uint32_t count = 0;
+      for (const TextureView& view : textures) {
+        values[count++] = view.imageHash;
+        values[count++] = view.viewKey;
+        values[count++] = static_cast<uint64_t>(view.format);
+        values[count++] = (static_cast<uint64_t>(view.minLevel) << 32) | view.numLevels;
+        values[count++] = (static_cast<uint64_t>(view.minLayer) << 32) | view.numLayers;
+      }
+      values[count++] = reinterpret_cast<uintptr_t>(sampler);
+      values[count++] = reinterpret_cast<uintptr_t>(replacementMaterial);
+      values[count++] = replacementMaterialHash;
+      return XXH3_64bits(values, sizeof(values));
+    }
+  };
+}
@@ -0,0 +1,260 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace dxvk {
+
+// Indexed binary max-heap of texture mip demands, used by RtxTextureManager to decide which streamed textures
+// keep their sampled mips when the texture budget is exceeded. Entries are addressed by a dense id (the sampler
+// feedback stamp) so that a texture whose feedback changed is re-keyed in O(log n) rather than the whole set being
+// re-sorted, and the total size of all demands is kept up to date so that frames under budget skip the order entirely.
+// Priorities are compared as stored, so they must not depend on the current frame for the order to stay valid.
+// Equal priorities are ordered by id, lowest first.
+class MipDemandHeap {
+public:
+  struct Demand {
+    double priority;
+    size_t bytes;
+  };
+
+  uint32_t size() const { return static_cast<uint32_t>(m_entries.size()); }
+  bool empty() const { return m_entries.empty(); }
+
+  // Sum of the bytes of all demands
+  size_t getTotalBytes() const { return m_totalBytes; }
+
+  bool contains(uint32_t id) const {
+    return id < m_positions.size() && m_positions[id] != kInvalidPosition;
+  }
+
+  const Demand& get(uint32_t id) const {
+    return m_entries[m_positions[id]].demand;
+  }
+
+  // Id of the highest priority demand
+  uint32_t top() const {
+    return m_entries.front().id;
+  }
+
+  // Adds a demand, or changes it if the id is already present
+  void update(uint32_t id, const Demand& demand) {
+    if (id >= m_positions.size()) {
+      m_positions.resize(id + 1, kInvalidPosition);
+    }
+
+    uint32_t position = m_positions[id];
+    if (position == kInvalidPosition) {
+      position = size();
+      m_entries.push_back({ demand, id });
+      m_positions[id] = position;
+    } else {
+      m_totalBytes -= m_entries[position].demand.bytes;
+      m_entries[position].demand = demand;
+    }
+
+    m_totalBytes += demand.bytes;
+    siftDown(siftUp(position));
+  }
+
+  void remove(uint32_t id) {
+    if (!contains(id)) {
+      return;
+    }
+
+    const uint32_t position = m_positions[id];
+    m_totalBytes -= m_entries[position].demand.bytes;
+    m_positions[id] = kInvalidPosition;
+
+    const uint32_t last = size() - 1;
+    if (position != last) {
+      m_entries[position] = m_entries[last];
+      m_positions[m_entries[position].id] = position;
+      m_entries.pop_back();
+      siftDown(siftUp(position));
+    } else {
+      m_entries.pop_back();
+    }
+  }
+
+  void clear() {
+    m_entries.clear();
+    m_positions.clear();
+    m_totalBytes = 0;
+  }
+
+  // Visits the demands from the highest priority down, for as long as visitor(id, demand) returns true.
+  // The heap is not modified: visiting k demands costs O(k log k), independent of the size of the heap.
+  template<typename Visitor>
+  void visitInOrder(Visitor visitor) const {
+    // Frontier of the visit, a heap of the entries whose parents were all visited
+    auto isLower = [](const Entry& a, const Entry& b) { return isHigher(b, a); };
+
+    m_frontier.clear();
+    if (!m_entries.empty()) {
+      m_frontier.push_back(m_entries.front());
+    }
+
+    while (!m_frontier.empty()) {
+      std::pop_heap(m_frontier.begin(), m_frontier.end(), isLower);
+      const Entry entry = m_frontier.back();
+      m_frontier.pop_back();
+
+      if (!visitor(entry.id, entry.demand)) {
+        return;
+      }
+
+      const uint32_t position = m_positions[entry.id];
+      for (uint32_t child = 2 * position + 1; child <= 2 * position + 2 && child < size(); child++) {
+        m_frontier.push_back(m_entries[child]);
+        std::push_heap(m_frontier.begin(), m_frontier.end(), isLower);
+      }
+    }
+  }
+
+  // Goes through the demands in priority order and fits each into what is left of budgetBytes if it can,
+  // invoking onFit(id, demand) for the demands which fit and onDemote(id, demand) for the others. Returns the bytes used.
+  // Only the demands up to the first one which does not fit are visited in order: as the remaining budget only
+  // shrinks from there, the demands after it which are larger than the remaining budget can never fit, and are
+  // demoted without sorting them. The result is the same as a greedy fit of the fully sorted demands.
+  template<typename OnFit, typename OnDemote>
+  size_t fitBudget(size_t budgetBytes, OnFit onFit, OnDemote onDemote) const {
+    size_t usedBytes = 0;
+    const Entry* pFirstMiss = nullptr;
+
+    visitInOrder([&](uint32_t id, const Demand& demand) {
+      if (usedBytes + demand.bytes <= budgetBytes) {
+        usedBytes += demand.bytes;
+        onFit(id, demand);
+        return true;
+      }
+
+      pFirstMiss = &m_entries[m_positions[id]];
+      return false;
+    });
+
+    if (pFirstMiss == nullptr) {
+      return usedBytes;
+    }
+
+    // The demands after the first miss which may still fit, in order
+    m_candidates.clear();
+    for (const Entry& entry : m_entries) {
+      if (isHigher(entry, *pFirstMiss)) {
+        continue;
+      }
+
+      if (usedBytes + entry.demand.bytes <= budgetBytes) {
+        m_candidates.push_back(entry);
+      } else {
+        onDemote(entry.id, entry.demand);
+      }
+    }
+
+    std::sort(m_candidates.begin(), m_candidates.end(), isHigher);
+
+    for (const Entry& entry : m_candidates) {
+      if (usedBytes + entry.demand.bytes <= budgetBytes) {
+        usedBytes += entry.demand.bytes;
+        onFit(entry.id, entry.demand);
+      } else {
+        onDemote(entry.id, entry.demand);
+      }
+    }
+
+    return usedBytes;
+  }
+
+private:
+  static constexpr uint32_t kInvalidPosition = UINT32_MAX;
+
+  struct Entry {
+    Demand demand;
+    uint32_t id;
+  };
+
+  static bool isHigher(const Entry& a, const Entry& b) {
+    if (a.demand.priority != b.demand.priority) {
+      return a.demand.priority > b.demand.priority;
+    }
+    return a.id < b.id;
+  }
+
+  void place(uint32_t position, const Entry& entry) {
+    m_entries[position] = entry;
+    m_positions[entry.id] = position;
+  }
+
+  uint32_t siftUp(uint32_t position) {
+    const Entry entry = m_entries[position];
+
+    while (position > 0) {
+      const uint32_t parent = (position - 1) / 2;
+      if (!isHigher(entry, m_entries[parent])) {
+        break;
+      }
+      place(position, m_entries[parent]);
+      position = parent;
+    }
+
+    place(position, entry);
+    return position;
+  }
+
+  uint32_t siftDown(uint32_t position) {
+    const Entry entry = m_entries[position];
+
+    for (;;) {
+      uint32_t highest = position;
+      const Entry* pHighest = &entry;
+
+      for (uint32_t child = 2 * position + 1; child <= 2 * position + 2 && child < size(); child++) {
+        if (isHigher(m_entries[child], *pHighest)) {
+          highest = child;
+          pHighest = &m_entries[child];
+        }
+      }
+
+      if (highest == position) {
+        break;
+      }
+
+      place(position, m_entries[highest]);
+      position = highest;
+    }
+
+    place(position, entry);
+    return position;
+  }
+
+  std::vector<Entry> m_entries;
+  std::vector<uint32_t> m_positions;  // Position of each id in m_entries, kInvalidPosition when absent
+  size_t m_totalBytes = 0;
+  mutable std::vector<Entry> m_frontier;
+  mutable std::vector<Entry> m_candidates;
+};
+
+}
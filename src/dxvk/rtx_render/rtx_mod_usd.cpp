@@ -32,6 +32,7 @@
 #include "rtx_utils.h"
 #include "rtx_asset_data_manager.h"
 #include "rtx_texture_manager.h"
+#include "rtx_replacement_mesh_cache.h"
 
 #include "../../lssusd/usd_include_begin.h"
 #include <pxr/base/gf/matrix4f.h>
@@ -71,6 +72,7 @@
 
 #include "rtx_lights_data.h"
 #include <filesystem>
+#include <fstream>
 #include <algorithm>
 
 namespace fs = std::filesystem;
@@ -112,6 +114,7 @@ private:
   MaterialData* processMaterial(Args& args, const pxr::UsdPrim& matPrim);
   MaterialData* processMaterialUser(Args& args, const pxr::UsdPrim& prim);
   bool processMesh(const pxr::UsdPrim& prim, Args& args);
+  XXH64_hash_t getMeshCacheKey(const pxr::UsdPrim& prim);
   void processPrim(Args& args, const pxr::UsdPrim& prim);
   void processPointInstancer(Args& args, const pxr::UsdPrim& prim);
   std::optional<RtxParticleSystemDesc> processParticleSystem(Args& args, const pxr::UsdPrim& prim);
@@ -135,6 +138,11 @@ private:
 
   Watchdog<1000> m_usdChangeWatchdog;
 
+  // Processed meshes from previous loads, null when the cache is disabled
+  std::unique_ptr<ReplacementMeshCache> m_meshCache;
+  // Content hashes of the layers seen during the current load, by real path
+  std::unordered_map<std::string, XXH64_hash_t> m_layerContentHashes;
+
   void addReplacementsSync(dxvk::Rc<dxvk::DxvkCommandList> cmdList, XXH64_hash_t hash, std::vector<AssetReplacement>& replacementVec);
   std::unordered_map<dxvk::DxvkCommandList*, std::thread> m_cmdListSyncThreads;
   // Asset replacement vector and hash to add when command list execution is complete
@@ -177,6 +185,25 @@ XXH64_hash_t getStrongestOpinionatedPathHash(const pxr::UsdPrim& prim) {
   return XXH3_64bits(name.c_str(), name.size());
 }
 
+// Hash of a file's contents, 0 if it can't be read
+XXH64_hash_t hashFileContents(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return 0;
+  }
+
+  XXH3_state_t state;
+  XXH3_64bits_reset(&state);
+
+  std::vector<char> chunk(1 << 20);
+  while (file) {
+    file.read(chunk.data(), chunk.size());
+    XXH3_64bits_update(&state, chunk.data(), static_cast<size_t>(file.gcount()));
+  }
+
+  return file.eof() ? XXH3_64bits_digest(&state) : 0;
+}
+
 XXH64_hash_t getNamedHash(const std::string& name, const char* prefix, const size_t len) {
   if (name.compare(0, len, prefix) == 0) {
     // is a mesh replacement.
@@ -1137,6 +1164,14 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
   m_fileModificationTime = fs::last_write_time(fs::path(m_openedFilePath));
   pxr::UsdGeomXformCache xformCache;
 
+  // Layers are rehashed on every load since this is also how changes are picked up on hot reload
+  m_layerContentHashes.clear();
+  m_meshCache.reset();
+  if (RtxOptions::enableReplacementMeshCache()) {
+    const std::string cachePath = RtxOptions::replacementMeshCachePath();
+    m_meshCache = std::make_unique<ReplacementMeshCache>(cachePath.empty() ? ReplacementMeshCache::getDefaultDirectory() : cachePath);
+  }
+
   pxr::VtDictionary layerData = stage->GetRootLayer()->GetCustomLayerData();
   if (layerData.empty()) {
     m_owner.m_status = "Layer Data Missing";
@@ -1261,6 +1296,15 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
     }
   }
 
+  if (m_meshCache) {
+    Logger::info(str::format("Replacement mesh cache: ", m_meshCache->getHitCount(), " meshes loaded from cache, ", m_meshCache->getMissCount(), " processed"));
+
+    const uint32_t maxSizeMiB = RtxOptions::replacementMeshCacheMaxSizeMiB();
+    if (maxSizeMiB > 0) {
+      m_meshCache->prune(uint64_t(maxSizeMiB) << 20);
+    }
+  }
+
   // flush entire cache, kinda a sledgehammer
   context->emitMemoryBarrier(0,
     VK_PIPELINE_STAGE_TRANSFER_BIT,
@@ -1484,27 +1528,119 @@ void UsdMod::Impl::addReplacementsSync(dxvk::Rc<dxvk::DxvkCommandList> cmdList,
   }
 }
 
+XXH64_hash_t UsdMod::Impl::getMeshCacheKey(const pxr::UsdPrim& prim) {
+  // The processed mesh depends on the prim and its geometry subsets, so on every layer holding an opinion about
+  // any of them. Layers which don't exist on disk (anonymous or session layers) can't be hashed, don't cache those.
+  std::vector<pxr::UsdPrim> prims = { prim };
+  for (const pxr::UsdPrim& child : prim.GetChildren()) {
+    prims.push_back(child);
+  }
+
+  const std::string primPath = prim.GetPath().GetString();
+  const uint32_t limitedBonesPerVertex = RtxOptions::limitedBonesPerVertex();
+
+  // Meshes processed by other builds may differ, even from unchanged layers
+  XXH3_state_t state;
+  XXH3_64bits_reset_withSeed(&state, ReplacementMeshCache::getVersionStamp());
+  XXH3_64bits_update(&state, primPath.data(), primPath.size());
+  XXH3_64bits_update(&state, &limitedBonesPerVertex, sizeof(limitedBonesPerVertex));
+
+  for (const pxr::UsdPrim& contributingPrim : prims) {
+    for (const auto& spec : contributingPrim.GetPrimStack()) {
+      const pxr::SdfLayerHandle layer = spec->GetLayer();
+      const std::string& layerPath = layer->GetRealPath();
+      if (layerPath.empty() || layer->IsDirty()) {
+        return kEmptyHash;
+      }
+
+      auto iter = m_layerContentHashes.find(layerPath);
+      if (iter == m_layerContentHashes.end()) {
+        iter = m_layerContentHashes.emplace(layerPath, hashFileContents(layerPath)).first;
+      }
+
+      if (iter->second == 0) {
+        return kEmptyHash;
+      }
+
+      XXH3_64bits_update(&state, &iter->second, sizeof(iter->second));
+    }
+  }
+
+  return XXH3_64bits_digest(&state);
+}
+
 bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args) {
   MeshReplacement replacement;
   RasterGeometry& geometryData = replacement.data;
 
+  // The processed mesh comes either from the mesh cache or from the importer, meshData points into one of them
+  ReplacementMeshData meshData;
+  std::vector<pxr::UsdPrim> subMeshPrims;
+  std::unique_ptr<ReplacementMeshCache::Entry> cachedMesh;
   std::unique_ptr<lss::UsdMeshImporter> processedMesh;
 
-  try {
-    processedMesh = std::make_unique<lss::UsdMeshImporter>(prim, RtxOptions::limitedBonesPerVertex());
+  const XXH64_hash_t meshCacheKey = m_meshCache ? getMeshCacheKey(prim) : kEmptyHash;
+
+  if (meshCacheKey != kEmptyHash) {
+    cachedMesh = m_meshCache->lookup(meshCacheKey);
+
+    if (cachedMesh) {
+      meshData = cachedMesh->data();
+
+      for (const ReplacementMeshData::SubMesh& subMesh : meshData.subMeshes) {
+        pxr::UsdPrim subMeshPrim = prim.GetStage()->GetPrimAtPath(pxr::SdfPath(subMesh.primPath));
+        if (!subMeshPrim.IsValid()) {
+          cachedMesh.reset();
+          break;
+        }
+        subMeshPrims.push_back(subMeshPrim);
+      }
+    }
   }
-  catch (DxvkError e) {
-    Logger::err(e.message());
-    return false;
+
+  if (!cachedMesh) {
+    try {
+      processedMesh = std::make_unique<lss::UsdMeshImporter>(prim, RtxOptions::limitedBonesPerVertex());
+    }
+    catch (DxvkError e) {
+      Logger::err(e.message());
+      return false;
+    }
+
+    meshData = ReplacementMeshData();
+    meshData.numVertices = processedMesh->GetNumVertices();
+    meshData.vertexStride = static_cast<uint32_t>(processedMesh->GetVertexStride());
+    meshData.numBonesPerVertex = static_cast<uint32_t>(processedMesh->GetNumBonesPerVertex());
+    meshData.doubleSidedState = processedMesh->GetDoubleSidedState();
+    meshData.isRightHanded = processedMesh->IsRightHanded();
+    meshData.boundingBox = processedMesh->GetBoundingBox();
+    meshData.pVertexData = processedMesh->GetVertexData().data();
+
+    for (const auto& element : processedMesh->GetVertexDecl()) {
+      meshData.vertexDecl.push_back({ element.attribute, static_cast<uint32_t>(element.offset), static_cast<uint32_t>(element.size) });
+    }
+
+    subMeshPrims.clear();
+    for (const lss::UsdMeshImporter::SubMesh& submesh : processedMesh->GetSubMeshes()) {
+      ReplacementMeshData::SubMesh& subMesh = meshData.subMeshes.emplace_back();
+      subMesh.primPath = submesh.prim.GetPath().GetString();
+      subMesh.pIndices = submesh.indexBuffer.data();
+      subMesh.numIndices = static_cast<uint32_t>(submesh.GetNumIndices());
+      subMeshPrims.push_back(submesh.prim);
+    }
   }
 
-  geometryData.vertexCount = processedMesh->GetNumVertices();
+  geometryData.vertexCount = meshData.numVertices;
 
-  if (processedMesh->GetNumVertices() == 0) {
+  if (meshData.numVertices == 0) {
     throw DxvkError(str::format("Warning: No vertices on this mesh after processing, id=.", prim.GetName()));
   }
 
-  const size_t vertexDataSize = processedMesh->GetNumVertices() * processedMesh->GetVertexStride();
+  if (processedMesh && meshCacheKey != kEmptyHash) {
+    m_meshCache->store(meshCacheKey, meshData);
+  }
+
+  const size_t vertexDataSize = size_t(meshData.numVertices) * meshData.vertexStride;
 
   // Allocate the instance buffer and copy its contents from host to device memory
   DxvkBufferCreateInfo info;
@@ -1515,7 +1651,7 @@ bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args) {
 
   // Check if the mesh has weights
   bool isDynamicMesh = false;
-  for (const auto& element : processedMesh->GetVertexDecl()) {
+  for (const auto& element : meshData.vertexDecl) {
     isDynamicMesh |= element.attribute == lss::UsdMeshImporter::BlendWeights;
     if (isDynamicMesh)
       break;
@@ -1524,7 +1660,7 @@ bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args) {
   // Buffer contains:
   // |---POSITIONS---|---NORMALS---|---UVS---| ... (VERTEX DATA INTERLEAVED)
   Rc<DxvkBuffer> vertexBuffer_staging = args.context->getDevice()->createBuffer(info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, DxvkMemoryStats::Category::RTXReplacementGeometry, "Mesh Staging Buffer");
-  memcpy(vertexBuffer_staging->mapPtr(0), processedMesh->GetVertexData().data(), vertexDataSize);
+  memcpy(vertexBuffer_staging->mapPtr(0), meshData.pVertexData, vertexDataSize);
 
   // Dynamic meshes should have their vertex data in device memory, static meshes should reside in host memory and allow geometry streaming to handle host/device memory management
   Rc<DxvkBuffer> vertexBuffer;
@@ -1540,28 +1676,28 @@ bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args) {
 
   const DxvkBufferSlice& vertexSlice = DxvkBufferSlice(vertexBuffer);
 
-  for (const auto& element : processedMesh->GetVertexDecl()) {
+  for (const auto& element : meshData.vertexDecl) {
     switch (element.attribute) {
     case lss::UsdMeshImporter::VertexPositions:
-      geometryData.positionBuffer = RasterBuffer(vertexSlice, element.offset, processedMesh->GetVertexStride(), VK_FORMAT_R32G32B32_SFLOAT);
+      geometryData.positionBuffer = RasterBuffer(vertexSlice, element.offset, meshData.vertexStride, VK_FORMAT_R32G32B32_SFLOAT);
       break;
     case lss::UsdMeshImporter::Normals:
-      geometryData.normalBuffer = RasterBuffer(vertexSlice, element.offset, processedMesh->GetVertexStride(), VK_FORMAT_R32_UINT);
+      geometryData.normalBuffer = RasterBuffer(vertexSlice, element.offset, meshData.vertexStride, VK_FORMAT_R32_UINT);
       break;
     case lss::UsdMeshImporter::Texcoords:
-      geometryData.texcoordBuffer = RasterBuffer(vertexSlice, element.offset, processedMesh->GetVertexStride(), VK_FORMAT_R32G32_SFLOAT);
+      geometryData.texcoordBuffer = RasterBuffer(vertexSlice, element.offset, meshData.vertexStride, VK_FORMAT_R32G32_SFLOAT);
       geometryData.hashes[HashComponents::VertexTexcoord] = getNextGeomHash();
       break;
     case lss::UsdMeshImporter::Colors:
-      geometryData.color0Buffer = RasterBuffer(vertexSlice, element.offset, processedMesh->GetVertexStride(), VK_FORMAT_B8G8R8A8_UNORM);
+      geometryData.color0Buffer = RasterBuffer(vertexSlice, element.offset, meshData.vertexStride, VK_FORMAT_B8G8R8A8_UNORM);
       break;
     case lss::UsdMeshImporter::BlendWeights:
-      geometryData.blendWeightBuffer = RasterBuffer(vertexSlice, element.offset, processedMesh->GetVertexStride(), VK_FORMAT_R32_SFLOAT);
+      geometryData.blendWeightBuffer = RasterBuffer(vertexSlice, element.offset, meshData.vertexStride, VK_FORMAT_R32_SFLOAT);
       // Note: only want to set this when there are actually weights, as it triggers the replacement to be skinned.
-      geometryData.numBonesPerVertex = processedMesh->GetNumBonesPerVertex(); // TODO: Implement this in UsdMesh
+      geometryData.numBonesPerVertex = meshData.numBonesPerVertex; // TODO: Implement this in UsdMesh
       break;
     case lss::UsdMeshImporter::BlendIndices:
-      geometryData.blendIndicesBuffer = RasterBuffer(vertexSlice, element.offset, processedMesh->GetVertexStride(), VK_FORMAT_R8G8B8A8_USCALED);
+      geometryData.blendIndicesBuffer = RasterBuffer(vertexSlice, element.offset, meshData.vertexStride, VK_FORMAT_R8G8B8A8_USCALED);
       break;
     default:
       assert(false && "Invalid vertex attribute in UsdMod::Impl::processMesh");
@@ -1570,44 +1706,46 @@ bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args) {
   }
 
   geometryData.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-  if (processedMesh->GetDoubleSidedState() != lss::UsdMeshImporter::Inherit) {
-    const VkCullModeFlagBits singleSidedCullMode = processedMesh->IsRightHanded() ? VK_CULL_MODE_BACK_BIT : VK_CULL_MODE_FRONT_BIT;
-    geometryData.cullMode = processedMesh->GetDoubleSidedState() == lss::UsdMeshImporter::IsDoubleSided ? VK_CULL_MODE_NONE : singleSidedCullMode;
+  if (meshData.doubleSidedState != lss::UsdMeshImporter::Inherit) {
+    const VkCullModeFlagBits singleSidedCullMode = meshData.isRightHanded ? VK_CULL_MODE_BACK_BIT : VK_CULL_MODE_FRONT_BIT;
+    geometryData.cullMode = meshData.doubleSidedState == lss::UsdMeshImporter::IsDoubleSided ? VK_CULL_MODE_NONE : singleSidedCullMode;
     geometryData.forceCullBit = true; // Overrule the instance face culling rules
   } else {
     // In this case we use the face culling set from the application for this mesh
     geometryData.cullMode = VK_CULL_MODE_NONE;
   }
 
-  geometryData.frontFace = processedMesh->IsRightHanded() ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+  geometryData.frontFace = meshData.isRightHanded ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+  geometryData.boundingBox = meshData.boundingBox;
 
-  // Get bounding box from the USD mesh importer
-  geometryData.boundingBox = processedMesh->GetBoundingBox();
+  for (size_t i = 0; i < meshData.subMeshes.size(); i++) {
+    const ReplacementMeshData::SubMesh& submesh = meshData.subMeshes[i];
+    const pxr::UsdPrim& submeshPrim = subMeshPrims[i];
 
-  for (const lss::UsdMeshImporter::SubMesh& submesh : processedMesh->GetSubMeshes()) {
-    if (submesh.GetNumIndices() == 0) {
-      Logger::err(str::format("Prim: ", submesh.prim.GetPath().GetString(), ", does not have indices, this is currently a requirement."));
+    if (submesh.numIndices == 0) {
+      Logger::err(str::format("Prim: ", submesh.primPath, ", does not have indices, this is currently a requirement."));
       continue;
     }
 
-    XXH64_hash_t usdOriginHash = getStrongestOpinionatedPathHash(submesh.prim);
+    XXH64_hash_t usdOriginHash = getStrongestOpinionatedPathHash(submeshPrim);
     MeshReplacement* childGeometryData;
     if (!m_owner.m_replacements->getObject(usdOriginHash, childGeometryData)) {
       MeshReplacement& newReplacement = m_owner.m_replacements->storeObject(usdOriginHash, MeshReplacement(replacement));
       RasterGeometry& newGeomData = newReplacement.data;
 
-      const size_t indexDataSize = submesh.GetNumIndices() * sizeof(uint32_t);
+      const size_t indexDataSize = submesh.numIndices * sizeof(uint32_t);
       info.size = dxvk::align(indexDataSize, CACHE_LINE_SIZE);
 
       // Buffer contains: indices
       Rc<DxvkBuffer> indexBuffer_staging = args.context->getDevice()->createBuffer(info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, DxvkMemoryStats::Category::RTXReplacementGeometry, "Mesh index buffer staging");
-      memcpy(indexBuffer_staging->mapPtr(0), submesh.indexBuffer.data(), indexDataSize);
+      memcpy(indexBuffer_staging->mapPtr(0), submesh.pIndices, indexDataSize);
       Rc<DxvkBuffer> indexBuffer;
       if (isDynamicMesh) {
         indexBuffer = args.context->getDevice()->createBuffer(
           info,
           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-          DxvkMemoryStats::Category::RTXReplacementGeometry, submesh.prim.GetName().GetString().c_str());
+          DxvkMemoryStats::Category::RTXReplacementGeometry, submeshPrim.GetName().GetString().c_str());
         args.context->copyBuffer(indexBuffer, 0, indexBuffer_staging, 0, indexDataSize);
       } else {
         indexBuffer = indexBuffer_staging;
@@ -1615,7 +1753,7 @@ bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args) {
 
       const DxvkBufferSlice& indexSlice = DxvkBufferSlice(indexBuffer);
       newGeomData.indexBuffer = RasterBuffer(indexSlice, 0, sizeof(uint32_t), VK_INDEX_TYPE_UINT32);
-      newGeomData.indexCount = submesh.GetNumIndices();
+      newGeomData.indexCount = submesh.numIndices;
       // Set these as hashed so that the geometryData acts like it's static.
       newGeomData.hashes[HashComponents::Indices] = newGeomData.hashes[HashComponents::VertexPosition] = getNextGeomHash();
       newGeomData.hashes.precombine();
@@ -454,6 +454,10 @@ namespace dxvk {
 
     RTX_OPTION("rtx", uint32_t, minPrimsInDynamicBLAS, 1000, "The minimum number of triangles required to promote a mesh to it's own BLAS, otherwise it lands in the merged BLAS with multiple other meshes.");
     RTX_OPTION("rtx", uint32_t, maxPrimsInMergedBLAS, 50000, "The maximum number of triangles for a mesh that can be in the merged BLAS.  ");
+    RTX_OPTION("rtx", bool, enableSpatialBlasBucketing, false, "Groups the meshes going into merged BLASes by their location rather than only by their instance properties.\n"
+               "Compatible meshes are ordered along a Morton curve of their world space bounds and split into merged BLASes of limited size, which reduces the overlap between merged BLASes and so the cost of ray traversal.");
+    RTX_OPTION("rtx", float, spatialBlasBucketMaxExtent, 2000.f, "The maximum size of a merged BLAS along any axis in world units, when spatial BLAS bucketing is enabled.");
+    RTX_OPTION("rtx", uint32_t, spatialBlasBucketMaxPrims, 200000, "The maximum number of triangles in a merged BLAS when spatial BLAS bucketing is enabled, 0 for no limit.");
     RTX_OPTION_FLAG("rtx", bool, forceMergeAllMeshes, false, RtxOptionFlags::NoSave, "Force merges all meshes into as few BLAS as possible.  This is generally not desirable for performance, but can be a useful debugging tool.");
     RTX_OPTION_FLAG("rtx", bool, minimizeBlasMerging, false, RtxOptionFlags::NoSave, "Minimize BLAS merging to the minimum possible, this option tries to give all meshes their own BLAS.  This is generally not desirable forperformance, but can be a useful debugging tool.");
 
@@ -1094,6 +1098,15 @@ namespace dxvk {
                "Only relevant when force high resolution replacement textures is disabled and adaptive resolution replacement textures is enabled. See asset estimated size parameter for more information.\n");
     RTX_OPTION("rtx", uint, limitedBonesPerVertex, 4,
                "Limit the number of bone influences per vertex for replacement geometry.  D3D9 games were limited to 4, which is the default.  In rare instances you may want to increase this based on your preference for replaced assets.  This config only takes affect when set on startup via the rtx.conf.");
+    RTX_OPTION("rtx", bool, enableReplacementMeshCache, true,
+               "Enables or disables the on-disk cache of processed replacement meshes.\n"
+               "Meshes whose USD layers are unchanged since they were cached are loaded from the cache rather than being processed again, which speeds up loading of mods.");
+    RTX_OPTION("rtx", std::string, replacementMeshCachePath, "",
+               "Directory of the on-disk cache of processed replacement meshes.\n"
+               "When empty, the cache is placed in the directory set by DXVK_STATE_CACHE_PATH (or the working directory) in a directory named after the executable.");
+    RTX_OPTION("rtx", uint, replacementMeshCacheMaxSizeMiB, 4096,
+               "Maximum size in mebibytes of the on-disk cache of processed replacement meshes.\n"
+               "Once a mod is loaded, the least recently used meshes are deleted from the cache until it fits. 0 disables the limit.");
 
     struct TextureManager {
       RTX_OPTION("rtx.texturemanager", int, budgetPercentageOfAvailableVram, 50,
@@ -1164,6 +1177,11 @@ namespace dxvk {
                "Playback rate marked in the USD stage.\n"
                "Will eventually determine frequency with which game state is captured and written. Currently every frame -- even those at higher frame rates -- are recorded.");
     //   Mesh
+    RTX_OPTION("rtx", std::string, drawCallTracePath, "",
+               "When set, every draw call submitted to the scene is recorded to this file, frame by frame, for replay by the scene ingest benchmark (tests/rtx/benchmark).\n"
+               "Only what the CPU side of the scene pipeline looks at is recorded: geometry and material hashes, transforms, categories and bounding boxes.\n"
+               "A trace is recorded once per path, set a different path to record another one.");
+    RTX_OPTION("rtx", uint32_t, drawCallTraceMaxFrames, 600, "Maximum number of frames recorded to rtx.drawCallTracePath, 0 records until the path is cleared.");
     RTX_OPTION("rtx", float, captureMeshPositionDelta, 0.3f, "Inter-frame position min delta warrants new time sample.");
     RTX_OPTION("rtx", float, captureMeshNormalDelta, 0.3f, "Inter-frame normal min delta warrants new time sample.");
     RTX_OPTION("rtx", float, captureMeshTexcoordDelta, 0.3f, "Inter-frame texcoord min delta warrants new time sample.");
@@ -0,0 +1,165 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../../util/util_matrix.h"
+#include "../../util/util_vector.h"
+
+namespace dxvk {
+
+// Spatial index of positions as seen through ray portals, i.e. transformed by each portal's transform to its opposing portal.
+// Every position is transformed once per portal when added, and the virtual positions are kept in one sorted uniform grid
+// per portal, so that finding the nearest virtual position is a lookup in a few cells rather than a pass over every candidate.
+// Meant to be rebuilt once per frame: reset, add the portals and positions, then build before querying.
+template<typename T, uint32_t MaxPortals>
+class PortalPositionIndex {
+public:
+  // The cell size should be at least twice the largest query distance, a query then only visits 2x2x2 cells per portal
+  void reset(float cellSize) {
+    assert(cellSize > 0.f);
+    m_cellSize = cellSize;
+    m_numPortals = 0;
+    m_numPositions = 0;
+    m_entries.clear();
+  }
+
+  // Returns the index of the portal, which is passed back by findNearest()
+  uint32_t addPortal(const Matrix4& portalToOpposingPortal) {
+    assert(m_numPortals < MaxPortals && m_entries.empty());
+    m_portalTransforms[m_numPortals] = portalToOpposingPortal;
+    return m_numPortals++;
+  }
+
+  void add(const T* data, const Vector3& position) {
+    for (uint32_t portal = 0; portal < m_numPortals; portal++) {
+      const Vector3 virtualPosition = (m_portalTransforms[portal] * Vector4(position.x, position.y, position.z, 1.f)).xyz();
+      const uint32_t order = static_cast<uint32_t>(m_entries.size());
+      m_entries.push_back(Entry { portal, getCell(virtualPosition), virtualPosition, order, data });
+    }
+    m_numPositions++;
+  }
+
+  void build() {
+    std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) { return isLess(a.portal, a.cell, b.portal, b.cell); });
+  }
+
+  // Returns the data with the virtual position nearest to `position` through any portal, which passes `filter` and is at most
+  // `sqrt(maxDistSqr)` units away. Ties are resolved in favor of the first added position, then the first added portal.
+  template<typename Filter>
+  const T* findNearest(const Vector3& position, float maxDistSqr, Filter filter, float& nearestDistSqr, uint32_t& nearestPortal) const {
+    assert(maxDistSqr <= (m_cellSize * 0.5f) * (m_cellSize * 0.5f));
+
+    // Note: same cell selection as SpatialMap::getNearestData(), the 2x2x2 cells around the position cover the query radius
+    const Vector3 cellPosition = position / m_cellSize - Vector3(0.5f, 0.5f, 0.5f);
+    const Vector3i floorPos(int(std::floor(cellPosition.x)), int(std::floor(cellPosition.y)), int(std::floor(cellPosition.z)));
+
+    const T* nearestData = nullptr;
+    uint32_t nearestOrder = UINT32_MAX;
+    nearestDistSqr = FLT_MAX;
+
+    for (uint32_t portal = 0; portal < m_numPortals; portal++) {
+      for (uint32_t offset = 0; offset < 8; offset++) {
+        const Vector3i cell = floorPos + Vector3i(int(offset & 1), int((offset >> 1) & 1), int((offset >> 2) & 1));
+
+        auto iter = std::lower_bound(m_entries.begin(), m_entries.end(), cell, [portal](const Entry& entry, const Vector3i& cell) {
+          return isLess(entry.portal, entry.cell, portal, cell);
+        });
+
+        for (; iter != m_entries.end() && iter->portal == portal && iter->cell == cell; ++iter) {
+          const float distSqr = lengthSqr(iter->virtualPosition - position);
+
+          if (distSqr > maxDistSqr || distSqr > nearestDistSqr) {
+            continue;
+          }
+
+          if (distSqr == nearestDistSqr && iter->order > nearestOrder) {
+            continue;
+          }
+
+          if (filter(iter->data)) {
+            nearestData = iter->data;
+            nearestDistSqr = distSqr;
+            nearestPortal = portal;
+            nearestOrder = iter->order;
+          }
+        }
+      }
+    }
+
+    return nearestData;
+  }
+
+  const Matrix4& getPortalTransform(uint32_t portal) const {
+    assert(portal < m_numPortals);
+    return m_portalTransforms[portal];
+  }
+
+  uint32_t getPortalCount() const {
+    return m_numPortals;
+  }
+
+  uint32_t size() const {
+    return m_numPositions;
+  }
+
+private:
+  struct Entry {
+    uint32_t portal;
+    Vector3i cell;
+    Vector3 virtualPosition;
+    uint32_t order;  // Order of addition, i.e. by position first and then by portal
+    const T* data;
+  };
+
+  static bool isLess(uint32_t portalA, const Vector3i& cellA, uint32_t portalB, const Vector3i& cellB) {
+    if (portalA != portalB) {
+      return portalA < portalB;
+    }
+    if (cellA.x != cellB.x) {
+      return cellA.x < cellB.x;
+    }
+    if (cellA.y != cellB.y) {
+      return cellA.y < cellB.y;
+    }
+    return cellA.z < cellB.z;
+  }
+
+  Vector3i getCell(const Vector3& position) const {
+    const Vector3 scaledPos = position / m_cellSize;
+    return Vector3i(int(std::floor(scaledPos.x)), int(std::floor(scaledPos.y)), int(std::floor(scaledPos.z)));
+  }
+
+  float m_cellSize = 1.f;
+  Matrix4 m_portalTransforms[MaxPortals];
+  uint32_t m_numPortals = 0;
+  uint32_t m_numPositions = 0;
+  std::vector<Entry> m_entries;
+};
+
+}
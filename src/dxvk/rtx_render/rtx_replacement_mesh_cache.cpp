@@ -0,0 +1,410 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <windows.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <version.h>
+
+#include "rtx_replacement_mesh_cache.h"
+
+#include "../../util/log/log.h"
+#include "../../util/util_env.h"
+#include "../../util/util_string.h"
+#include "../../util/util_math.h"
+#include "../../util/util_once.h"
+
+namespace dxvk {
+
+  namespace {
+    struct FileHeader {
+      char magic[4] = { 'R', 'M', 'S', 'H' };
+      uint32_t formatVersion = 1;
+      XXH64_hash_t key = 0;
+      XXH64_hash_t checksum = 0;  // Of everything following the header
+      uint64_t payloadSize = 0;
+    };
+
+    static_assert(sizeof(FileHeader) == 32);
+
+    struct MeshHeader {
+      uint32_t numVertices;
+      uint32_t vertexStride;
+      uint32_t numBonesPerVertex;
+      uint32_t doubleSidedState;
+      uint32_t isRightHanded;
+      uint32_t numVertexElements;
+      uint32_t numSubMeshes;
+      uint32_t reserved;
+      Vector3 boundingBoxMin;
+      Vector3 boundingBoxMax;
+    };
+
+    // Blobs start at this alignment relative to the start of the file, which is page aligned when mapped
+    constexpr size_t kBlobAlignment = 16;
+
+    // Sanity limit for parsing, a single replacement mesh is far below this
+    constexpr uint32_t kMaxSubMeshes = 1 << 16;
+
+    class PayloadReader {
+    public:
+      PayloadReader(const uint8_t* pData, size_t size)
+        : m_pData(pData), m_size(size) { }
+
+      template<typename T>
+      bool read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const uint8_t* p = skip(sizeof(T));
+        if (p == nullptr) {
+          return false;
+        }
+        std::memcpy(&value, p, sizeof(T));
+        return true;
+      }
+
+      // Returns a pointer to size bytes at the current offset, or null if the data is too short
+      const uint8_t* skip(size_t size) {
+        if (size > m_size - m_offset) {
+          return nullptr;
+        }
+        const uint8_t* p = m_pData + m_offset;
+        m_offset += size;
+        return p;
+      }
+
+      const uint8_t* skipAligned(size_t size) {
+        const size_t aligned = align(m_offset, kBlobAlignment);
+        if (aligned > m_size) {
+          return nullptr;
+        }
+        m_offset = aligned;
+        return skip(size);
+      }
+
+    private:
+      const uint8_t* m_pData;
+      size_t m_size;
+      size_t m_offset = 0;
+    };
+
+    void append(std::vector<uint8_t>& file, const void* pData, size_t size) {
+      const size_t offset = file.size();
+      file.resize(offset + size);
+      std::memcpy(file.data() + offset, pData, size);
+    }
+
+    void appendAligned(std::vector<uint8_t>& file, const void* pData, size_t size) {
+      file.resize(align(file.size(), kBlobAlignment));
+      append(file, pData, size);
+    }
+  }
+
+  ReplacementMeshCache::Entry::~Entry() {
+    if (m_hFile) {
+      UnmapViewOfFile(m_pBase);
+      CloseHandle(m_hMapping);
+      CloseHandle(m_hFile);
+    }
+  }
+
+  ReplacementMeshCache::ReplacementMeshCache(std::string directory)
+    : m_directory(std::move(directory)) {
+    if (!m_directory.empty() && m_directory.back() != '/' && m_directory.back() != '\\') {
+      m_directory += '/';
+    }
+  }
+
+  std::unique_ptr<ReplacementMeshCache::Entry> ReplacementMeshCache::lookup(XXH64_hash_t key) {
+    const std::string filePath = getFilePath(key);
+
+    HANDLE hFile = CreateFile(filePath.c_str(),
+                              GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+      ++m_missCount;
+      return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart < sizeof(FileHeader)) {
+      CloseHandle(hFile);
+      ++m_missCount;
+      return nullptr;
+    }
+
+    HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (hMapping == NULL) {
+      ONCE(Logger::warn(str::format("CreateFileMapping fail (error=", GetLastError(), "): ", filePath)));
+      CloseHandle(hFile);
+      ++m_missCount;
+      return nullptr;
+    }
+
+    LPVOID lpBaseAddress = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (lpBaseAddress == NULL) {
+      ONCE(Logger::warn(str::format("MapViewOfFile fail (error=", GetLastError(), "): ", filePath)));
+      CloseHandle(hMapping);
+      CloseHandle(hFile);
+      ++m_missCount;
+      return nullptr;
+    }
+
+    std::unique_ptr<Entry> entry(new Entry());
+    entry->m_hFile = hFile;
+    entry->m_hMapping = hMapping;
+    entry->m_pBase = static_cast<const uint8_t*>(lpBaseAddress);
+
+    if (!deserialize(key, entry->m_pBase, static_cast<size_t>(fileSize.QuadPart), entry->m_data)) {
+      Logger::warn(str::format("Discarding damaged replacement mesh cache file: ", filePath));
+      ++m_missCount;
+      return nullptr;
+    }
+
+    // Mark the file as used for pruning
+    std::error_code ec;
+    std::filesystem::last_write_time(filePath, std::filesystem::file_time_type::clock::now(), ec);
+
+    ++m_hitCount;
+    return entry;
+  }
+
+  void ReplacementMeshCache::store(XXH64_hash_t key, const ReplacementMeshData& mesh) {
+    if (!m_directoryCreated) {
+      std::error_code ec;
+      std::filesystem::create_directories(m_directory, ec);
+      if (ec) {
+        ONCE(Logger::warn(str::format("Failed to create replacement mesh cache directory: ", m_directory)));
+        return;
+      }
+      m_directoryCreated = true;
+    }
+
+    std::vector<uint8_t> file;
+    serialize(key, mesh, file);
+
+    const std::string filePath = getFilePath(key);
+    const std::string tempPath = filePath + ".tmp";
+
+    {
+      std::ofstream stream(str::tows(tempPath.c_str()).c_str(), std::ios_base::binary | std::ios_base::trunc);
+      stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+
+      if (!stream) {
+        ONCE(Logger::warn(str::format("Failed to write replacement mesh cache file: ", tempPath)));
+        return;
+      }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, filePath, ec);
+    if (ec) {
+      std::filesystem::remove(tempPath, ec);
+    }
+  }
+
+  void ReplacementMeshCache::prune(uint64_t maxSize) {
+    struct CacheFile {
+      std::filesystem::path path;
+      std::filesystem::file_time_type lastUsed;
+      uint64_t size;
+    };
+
+    std::vector<CacheFile> files;
+    uint64_t totalSize = 0;
+
+    std::error_code ec;
+    for (const auto& dirEntry : std::filesystem::directory_iterator(m_directory, ec)) {
+      if (dirEntry.path().extension() != ".rtxmesh") {
+        continue;
+      }
+
+      CacheFile file { dirEntry.path(), dirEntry.last_write_time(ec), dirEntry.file_size(ec) };
+      if (!ec) {
+        totalSize += file.size;
+        files.push_back(std::move(file));
+      }
+    }
+
+    if (totalSize <= maxSize) {
+      return;
+    }
+
+    std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) {
+      return a.lastUsed < b.lastUsed;
+    });
+
+    uint32_t numRemoved = 0;
+    for (const CacheFile& file : files) {
+      if (totalSize <= maxSize) {
+        break;
+      }
+
+      // Files mapped by another process can't be removed, they are used anyway
+      if (std::filesystem::remove(file.path, ec)) {
+        totalSize -= file.size;
+        numRemoved++;
+      }
+    }
+
+    Logger::info(str::format("Replacement mesh cache: removed ", numRemoved, " least recently used meshes, ", totalSize >> 20, " MiB remaining"));
+  }
+
+  std::string ReplacementMeshCache::getDefaultDirectory() {
+    std::string path = env::getEnvVar("DXVK_STATE_CACHE_PATH");
+
+    if (!path.empty() && *path.rbegin() != '/') {
+      path += '/';
+    }
+
+    return path + env::getExeBaseName() + ".rtx-mesh-cache/";
+  }
+
+  uint64_t ReplacementMeshCache::getVersionStamp() {
+    // Bump when the mesh importer or the processing of its output changes without a version change, e.g. in local builds
+    constexpr uint32_t kMeshProcessingRevision = 1;
+    return XXH64(&kMeshProcessingRevision, sizeof(kMeshProcessingRevision), XXH3_64bits(DXVK_VERSION, sizeof(DXVK_VERSION)));
+  }
+
+  std::string ReplacementMeshCache::getFilePath(XXH64_hash_t key) const {
+    return str::format(m_directory, std::hex, key, ".rtxmesh");
+  }
+
+  void ReplacementMeshCache::serialize(XXH64_hash_t key, const ReplacementMeshData& mesh, std::vector<uint8_t>& file) {
+    file.clear();
+    file.resize(sizeof(FileHeader));
+
+    MeshHeader meshHeader = {};
+    meshHeader.numVertices = mesh.numVertices;
+    meshHeader.vertexStride = mesh.vertexStride;
+    meshHeader.numBonesPerVertex = mesh.numBonesPerVertex;
+    meshHeader.doubleSidedState = mesh.doubleSidedState;
+    meshHeader.isRightHanded = mesh.isRightHanded ? 1 : 0;
+    meshHeader.numVertexElements = static_cast<uint32_t>(mesh.vertexDecl.size());
+    meshHeader.numSubMeshes = static_cast<uint32_t>(mesh.subMeshes.size());
+    meshHeader.boundingBoxMin = mesh.boundingBox.minPos;
+    meshHeader.boundingBoxMax = mesh.boundingBox.maxPos;
+    append(file, &meshHeader, sizeof(meshHeader));
+
+    append(file, mesh.vertexDecl.data(), mesh.vertexDecl.size() * sizeof(ReplacementMeshData::VertexElement));
+
+    for (const ReplacementMeshData::SubMesh& subMesh : mesh.subMeshes) {
+      const uint32_t pathLength = static_cast<uint32_t>(subMesh.primPath.size());
+      append(file, &pathLength, sizeof(pathLength));
+      append(file, subMesh.primPath.data(), pathLength);
+      append(file, &subMesh.numIndices, sizeof(subMesh.numIndices));
+    }
+
+    appendAligned(file, mesh.pVertexData, size_t(mesh.numVertices) * mesh.vertexStride);
+
+    for (const ReplacementMeshData::SubMesh& subMesh : mesh.subMeshes) {
+      appendAligned(file, subMesh.pIndices, subMesh.numIndices * sizeof(uint32_t));
+    }
+
+    FileHeader header;
+    header.key = key;
+    header.payloadSize = file.size() - sizeof(FileHeader);
+    header.checksum = XXH3_64bits(file.data() + sizeof(FileHeader), header.payloadSize);
+    std::memcpy(file.data(), &header, sizeof(header));
+  }
+
+  bool ReplacementMeshCache::deserialize(XXH64_hash_t key, const uint8_t* pFile, size_t fileSize, ReplacementMeshData& mesh) {
+    const FileHeader expected;
+    FileHeader header;
+
+    if (fileSize < sizeof(FileHeader)) {
+      return false;
+    }
+
+    std::memcpy(&header, pFile, sizeof(header));
+
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+        header.formatVersion != expected.formatVersion ||
+        header.key != key ||
+        header.payloadSize != fileSize - sizeof(FileHeader)) {
+      return false;
+    }
+
+    // The blobs are read anyway to upload them, so validating the whole file costs little on top
+    if (XXH3_64bits(pFile + sizeof(FileHeader), header.payloadSize) != header.checksum) {
+      return false;
+    }
+
+    // Offsets are relative to the start of the file to keep blob alignment intact
+    PayloadReader reader(pFile, fileSize);
+    reader.skip(sizeof(FileHeader));
+
+    MeshHeader meshHeader;
+    if (!reader.read(meshHeader) || meshHeader.numSubMeshes > kMaxSubMeshes) {
+      return false;
+    }
+
+    mesh.numVertices = meshHeader.numVertices;
+    mesh.vertexStride = meshHeader.vertexStride;
+    mesh.numBonesPerVertex = meshHeader.numBonesPerVertex;
+    mesh.doubleSidedState = meshHeader.doubleSidedState;
+    mesh.isRightHanded = meshHeader.isRightHanded != 0;
+    mesh.boundingBox.minPos = meshHeader.boundingBoxMin;
+    mesh.boundingBox.maxPos = meshHeader.boundingBoxMax;
+
+    const size_t vertexDeclSize = size_t(meshHeader.numVertexElements) * sizeof(ReplacementMeshData::VertexElement);
+    const uint8_t* pVertexDecl = reader.skip(vertexDeclSize);
+    if (pVertexDecl == nullptr) {
+      return false;
+    }
+
+    mesh.vertexDecl.resize(meshHeader.numVertexElements);
+    std::memcpy(mesh.vertexDecl.data(), pVertexDecl, vertexDeclSize);
+
+    mesh.subMeshes.resize(meshHeader.numSubMeshes);
+    for (ReplacementMeshData::SubMesh& subMesh : mesh.subMeshes) {
+      uint32_t pathLength = 0;
+      if (!reader.read(pathLength)) {
+        return false;
+      }
+
+      const uint8_t* pPath = reader.skip(pathLength);
+      if (pPath == nullptr || !reader.read(subMesh.numIndices)) {
+        return false;
+      }
+
+      subMesh.primPath.assign(reinterpret_cast<const char*>(pPath), pathLength);
+    }
+
+    mesh.pVertexData = reader.skipAligned(size_t(meshHeader.numVertices) * meshHeader.vertexStride);
+    if (mesh.pVertexData == nullptr) {
+      return false;
+    }
+
+    for (ReplacementMeshData::SubMesh& subMesh : mesh.subMeshes) {
+      subMesh.pIndices = reinterpret_cast<const uint32_t*>(reader.skipAligned(size_t(subMesh.numIndices) * sizeof(uint32_t)));
+      if (subMesh.pIndices == nullptr) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+}
@@ -0,0 +1,134 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../util/util_bounding_box.h"
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+  // Replacement mesh in the form UsdMod turns into geometry buffers, i.e. the output of the USD mesh importer.
+  // Blobs are not owned: they point into the importer's buffers when storing and into the mapped file on lookup.
+  struct ReplacementMeshData {
+    struct VertexElement {
+      uint32_t attribute;  // lss::UsdMeshImporter::Attributes
+      uint32_t offset;
+      uint32_t size;
+    };
+
+    struct SubMesh {
+      std::string primPath;
+      const uint32_t* pIndices = nullptr;
+      uint32_t numIndices = 0;
+    };
+
+    uint32_t numVertices = 0;
+    uint32_t vertexStride = 0;
+    uint32_t numBonesPerVertex = 0;
+    uint32_t doubleSidedState = 0;  // lss::UsdMeshImporter::DoubleSidedState
+    bool isRightHanded = true;
+    AxisAlignedBoundingBox boundingBox;
+
+    std::vector<VertexElement> vertexDecl;
+    const void* pVertexData = nullptr;  // numVertices * vertexStride bytes of interleaved vertices
+    std::vector<SubMesh> subMeshes;
+  };
+
+  // Persistent cache of processed replacement meshes, one file per mesh prim. Keys are computed by the caller
+  // from everything the processed mesh depends on (i.e. the contents of the layers defining the prim and its path,
+  // and the version stamp of the importer), so entries are never invalidated explicitly: stale files are simply
+  // never looked up again, until prune() deletes them.
+  // Files are memory mapped on lookup so that their blobs can be copied straight into upload buffers.
+  class ReplacementMeshCache {
+  public:
+    // Mapped cache file, the data it describes is valid as long as the entry is alive
+    class Entry {
+    public:
+      ~Entry();
+
+      const ReplacementMeshData& data() const {
+        return m_data;
+      }
+
+    private:
+      friend class ReplacementMeshCache;
+
+      Entry() = default;
+      Entry(const Entry&) = delete;
+      Entry& operator=(const Entry&) = delete;
+
+      void* m_hFile = nullptr;
+      void* m_hMapping = nullptr;
+      const uint8_t* m_pBase = nullptr;
+      ReplacementMeshData m_data;
+    };
+
+    explicit ReplacementMeshCache(std::string directory);
+
+    // Returns null when the mesh is not cached or its file is damaged
+    std::unique_ptr<Entry> lookup(XXH64_hash_t key);
+
+    // Writes a mesh to the cache. Files are written under a temporary name and renamed once complete,
+    // so that a process interrupted while storing never leaves a partial entry behind.
+    void store(XXH64_hash_t key, const ReplacementMeshData& mesh);
+
+    // Deletes the least recently used files until the cache is at most maxSize bytes.
+    // Files are used when they are stored or found by a lookup.
+    void prune(uint64_t maxSize);
+
+    uint32_t getHitCount() const {
+      return m_hitCount.load();
+    }
+
+    uint32_t getMissCount() const {
+      return m_missCount.load();
+    }
+
+    // Default location of the cache, next to the DXVK state cache
+    static std::string getDefaultDirectory();
+
+    // Stamp of the build, to be mixed into keys so that meshes processed by other builds miss
+    static uint64_t getVersionStamp();
+
+    // File contents for a mesh, exposed for testing
+    static void serialize(XXH64_hash_t key, const ReplacementMeshData& mesh, std::vector<uint8_t>& file);
+
+    // Parses file contents, the blobs of the returned mesh point into the file data.
+    // Fails if the data is damaged, from a different format version or stored under a different key.
+    static bool deserialize(XXH64_hash_t key, const uint8_t* pFile, size_t fileSize, ReplacementMeshData& mesh);
+
+  private:
+    std::string getFilePath(XXH64_hash_t key) const;
+
+    std::string m_directory;
+    bool m_directoryCreated = false;
+    std::atomic<uint32_t> m_hitCount = 0;
+    std::atomic<uint32_t> m_missCount = 0;
+  };
+
+}
@@ -41,8 +41,10 @@
 #include "vulkan/vulkan_core.h"
 
 #include "rtx_game_capturer.h"
+#include "rtx_draw_call_trace.h"
 #include "rtx_matrix_helpers.h"
 #include "rtx_intersection_test.h"
+#include "rtx_material_intern_key.h"
 
 #include "dxvk_scoped_annotation.h"
 #include "rtx_lights_data.h"
@@ -185,6 +187,9 @@ namespace dxvk {
     m_bufferCache.clear();
     m_surfaceMaterialCache.clear();
     m_preCreationSurfaceMaterialMap.clear();
+    m_materialInternTable.clear();
+    m_packedSurfaceMaterials.clear();
+    m_packedSurfaceMaterialHashes.clear();
     m_surfaceMaterialExtensionCache.clear();
     m_volumeMaterialCache.clear();
     
@@ -231,6 +236,47 @@ namespace dxvk {
       fast_unordered_cache<const RtInstance*> outsideFrustumInstancesCache;
 
       auto& entries = m_drawCallCache.getEntries();
+
+      const bool useFrustumTest = !getCamera().isCameraCut() && m_isAntiCullingSupported;
+      const bool useBatchedFrustumTest = useFrustumTest && RtxOptions::needsMeshBoundingBox() &&
+                                         !RtxOptions::AntiCulling::Object::enableHighPrecisionAntiCulling();
+
+      // The fast bounding box test runs on batches of instances ahead of the loop below, which consumes the results in the same order
+      m_antiCullingIsInsideFrustum.clear();
+      uint32_t batchedResultIndex = 0;
+      if (useBatchedFrustumTest) {
+        Vector4 frustumPlanes[PLANES_NUM];
+        getFrustumPlanes(getCamera().getFrustum(), frustumPlanes);
+
+        BoundingBoxBatch batch;
+        auto testBatch = [&]() {
+          const uint32_t insideMask = batch.intersectPlanes(frustumPlanes, PLANES_NUM);
+          for (uint32_t i = 0; i < batch.size(); i++) {
+            m_antiCullingIsInsideFrustum.push_back((insideMask & (1u << i)) != 0);
+          }
+          batch.clear();
+        };
+
+        const Matrix4& worldToView = getCamera().getWorldToView(false);
+        for (const auto& entry : entries) {
+          for (const RtInstance* instance : entry.second.getLinkedInstances()) {
+            const Matrix4 objectToView = worldToView * instance->getTransform();
+            const AxisAlignedBoundingBox& boundingBox = instance->getBlas()->input.getGeometryData().boundingBox;
+
+            if (boundingBox.isValid()) {
+              batch.add(boundingBox.transform(objectToView));
+            } else {
+              // Unbounded, so that instances without bounds are always kept
+              batch.add(Vector3(-FLT_MAX), Vector3(FLT_MAX));
+            }
+            if (batch.full()) {
+              testBatch();
+            }
+          }
+        }
+        testBatch();
+      }
+
       for (auto iter = entries.begin(); iter != entries.end();) {
         bool isAllInstancesInCurrentBlasInsideFrustum = true;
         for (const RtInstance* instance : iter->second.getLinkedInstances()) {
@@ -240,19 +286,17 @@ namespace dxvk {
           // Check for camera cut. Anti-Culling should NOT be enabled during a camera cut.
           // In some cases, we can't reliably detect a camera cut (e.g., when the game doesn't set up the View Matrix),
           // so we must disable Anti-Culling to prevent visual corruption.
-          if (!getCamera().isCameraCut() && m_isAntiCullingSupported) {
-            if (RtxOptions::needsMeshBoundingBox()) {
+          if (useFrustumTest) {
+            if (useBatchedFrustumTest) {
+              isInsideFrustum = m_antiCullingIsInsideFrustum[batchedResultIndex++] != 0;
+            } else if (RtxOptions::needsMeshBoundingBox()) {
               const AxisAlignedBoundingBox& boundingBox = instance->getBlas()->input.getGeometryData().boundingBox;
-              if (RtxOptions::AntiCulling::Object::enableHighPrecisionAntiCulling()) {
-                isInsideFrustum = boundingBoxIntersectsFrustumSAT(
-                  getCamera(),
-                  boundingBox.minPos,
-                  boundingBox.maxPos,
-                  objectToView,
-                  RtxOptions::AntiCulling::Object::enableInfinityFarFrustum());
-              } else {
-                isInsideFrustum = boundingBoxIntersectsFrustum(getCamera().getFrustum(), boundingBox.minPos, boundingBox.maxPos, objectToView);
-              }
+              isInsideFrustum = boundingBoxIntersectsFrustumSAT(
+                getCamera(),
+                boundingBox.minPos,
+                boundingBox.maxPos,
+                objectToView,
+                RtxOptions::AntiCulling::Object::enableInfinityFarFrustum());
             }
             else {
               // Fallback to check object center under view space
@@ -306,6 +350,8 @@ namespace dxvk {
           ++iter;
         }
       }
+
+      assert(batchedResultIndex == batchedIsInsideFrustum.size());
     }
 
     // Perform GC on the other managers
@@ -503,6 +549,8 @@ namespace dxvk {
       m_enqueueDelayedClear = false;
     }
 
+    updateDrawCallTrace();
+
     m_cameraManager.onFrameEnd();
     m_instanceManager.onFrameEnd();
     m_previousFrameSceneAvailable = raytracedThisFrame && RtxOptions::enablePreviousTLAS();
@@ -538,6 +586,7 @@ namespace dxvk {
 
     // Not currently safe to cache these across frames (due to texture indices and rtx options potentially changing)
     m_preCreationSurfaceMaterialMap.clear();
+    m_materialInternTable.clear();
 
     m_thinOpaqueMaterialExist = false;
     m_sssMaterialExist = false;
@@ -560,11 +609,58 @@ namespace dxvk {
     m_fogStates.clear();
   }
 
+  void SceneManager::recordDrawCallTrace(const DrawCallState& input) {
+    const RasterGeometry& geometryData = input.getGeometryData();
+    const DrawCallTransforms& transforms = input.getTransformData();
+
+    DrawCallTraceRecord record {};
+    for (uint32_t i = 0; i < uint32_t(HashComponents::Count); i++) {
+      record.geometryHashes[i] = geometryData.hashes[static_cast<HashComponents>(i)];
+    }
+    record.materialHash = input.getMaterialData().getHash();
+    record.objectToWorld = transforms.objectToWorld;
+    record.objectToView = transforms.objectToView;
+    record.boundingBoxMin = geometryData.boundingBox.minPos;
+    record.boundingBoxMax = geometryData.boundingBox.maxPos;
+    record.categoryFlags = input.getCategoryFlags().raw();
+    record.cameraType = static_cast<uint32_t>(input.cameraType);
+    record.vertexCount = geometryData.vertexCount;
+    record.indexCount = geometryData.indexCount;
+    record.numBones = input.getSkinningState().numBones;
+    record.numInstances = transforms.instancesToObject != nullptr ? static_cast<uint32_t>(transforms.instancesToObject->size()) : 0;
+
+    m_drawCallTraceWriter->record(record);
+  }
+
+  void SceneManager::updateDrawCallTrace() {
+    const std::string& tracePath = RtxOptions::drawCallTracePath();
+
+    if (m_drawCallTraceWriter != nullptr) {
+      m_drawCallTraceWriter->endFrame();
+
+      // Stop when the option is cleared or changed, or once the frame limit is reached
+      if (m_drawCallTraceWriter->getFilePath() != tracePath || !m_drawCallTraceWriter->isRecording()) {
+        m_drawCallTraceWriter = nullptr;
+      }
+    }
+
+    if (m_drawCallTraceWriter == nullptr && !tracePath.empty() && tracePath != m_lastDrawCallTracePath) {
+      m_drawCallTraceWriter = std::make_unique<DrawCallTraceWriter>(tracePath, RtxOptions::drawCallTraceMaxFrames());
+    }
+
+    // Note: a trace is only recorded once per path, so that a finished trace is not overwritten on the following frame
+    m_lastDrawCallTracePath = tracePath;
+  }
+
   std::unordered_set<XXH64_hash_t> uniqueHashes;
 
 
   void SceneManager::submitDrawState(Rc<DxvkContext> ctx, const DrawCallState& input, const MaterialData* overrideMaterialData) {
     ScopedCpuProfileZone();
+    if (m_drawCallTraceWriter != nullptr) {
+      recordDrawCallTrace(input);
+    }
+
     if (m_bufferCache.getTotalCount() >= kBufferCacheLimit && m_bufferCache.getActiveCount() >= kBufferCacheLimit) {
       ONCE(Logger::info("[RTX-Compatibility-Info] This application is pushing more unique buffers than is currently supported - some objects may not raytrace."));
       return;
@@ -639,45 +735,74 @@ namespace dxvk {
     }
   }
 
-  MaterialData SceneManager::determineMaterialData(const MaterialData* overrideMaterialData, const DrawCallState& input) {
+  const MaterialData& SceneManager::determineMaterialData(const MaterialData* overrideMaterialData, const DrawCallState& input) {
     // First see if we have an explicit override
     if (overrideMaterialData != nullptr) {
       return *overrideMaterialData;
     } 
 
+    const LegacyMaterialData& legacyMaterialData = input.getMaterialData();
+
     // test if any direct material replacements exist
-    MaterialData* pReplacementMaterial = m_pReplacer->getReplacementMaterial(input.getMaterialData().getHash());
-    if (pReplacementMaterial != nullptr) {
-      // Make a copy - dont modify the replacement data.
-      MaterialData renderMaterialData = *pReplacementMaterial;
-      // merge in the input material from game
-      renderMaterialData.mergeLegacyMaterial(input.getMaterialData());
-      return renderMaterialData;
-    }
+    const MaterialData* pReplacementMaterial = m_pReplacer->getReplacementMaterial(legacyMaterialData.getHash());
 
     // Detect meshes that would have unstable hashes due to the vertex hash using vertex data from a shared vertex buffer.
     // TODO: Once the vertex hash only uses vertices referenced by the index buffer, this should be removed.
     const bool highlightUnsafeAnchor = RtxOptions::useHighlightUnsafeAnchorMode() && input.getGeometryData().indexBuffer.defined() && input.getGeometryData().vertexCount > input.getGeometryData().indexCount;
-    if (highlightUnsafeAnchor) {
+    if (pReplacementMaterial == nullptr && highlightUnsafeAnchor) {
       const static MaterialData sHighlightMaterialData(OpaqueMaterialData(TextureRef(), TextureRef(), TextureRef(), TextureRef(), TextureRef(), TextureRef(), TextureRef(), TextureRef(), TextureRef(), TextureRef(), TextureRef(), TextureRef(),
                                                                           0.f, 1.f, Vector3(0.2f, 0.2f, 0.2f), 1.0f, 0.1f, 0.1f, Vector3(0.46f, 0.26f, 0.31f), true, 1, 1, 0, false, false, 200.f, true, false, BlendType::kAlpha, false, AlphaTestType::kAlways, 0, 0.0f, 0.0f, Vector3(), 0.0f, Vector3(), 0.0f, false, Vector3(), 0.0f, 0.0f,
                                                                           lss::Mdl::Filter::Nearest, lss::Mdl::WrapMode::Repeat, lss::Mdl::WrapMode::Repeat));
       return sHighlightMaterialData;
     }
 
-    // Check if a Ray Portal override is needed
-    size_t rayPortalTextureIndex;
-    if (RtxOptions::getRayPortalTextureIndex(input.getMaterialData().getHash(), rayPortalTextureIndex)) {
-      assert(rayPortalTextureIndex < maxRayPortalCount);
-      assert(rayPortalTextureIndex < std::numeric_limits<uint8_t>::max());
+    // The remaining conversions only depend on the game's textures and the views they are bound through, the game's
+    // sampler, the replacement material and on options, which are fixed for the frame the interned materials live in.
+    auto describeView = [](const TextureRef& texture) {
+      MaterialInternKey::TextureView view;
+      view.imageHash = texture.getImageHash();
+      view.viewKey = texture.isValid() ? texture.getUniqueKey() : 0;
+      if (const DxvkImageView* imageView = texture.getImageView()) {
+        const DxvkImageViewCreateInfo& info = imageView->info();
+        view.format = info.format;
+        view.minLevel = info.minLevel;
+        view.numLevels = info.numLevels;
+        view.minLayer = info.minLayer;
+        view.numLayers = info.numLayers;
+      }
+      return view;
+    };
 
-      MaterialData renderMaterialData = input.getMaterialData().as<RayPortalMaterialData>();
-      renderMaterialData.getRayPortalMaterialData().setRayPortalIndex(rayPortalTextureIndex);
-      return renderMaterialData;
-    }
+    MaterialInternKey internKey;
+    internKey.textures[0] = describeView(legacyMaterialData.getColorTexture());
+    internKey.textures[1] = describeView(legacyMaterialData.getColorTexture2());
+    internKey.sampler = legacyMaterialData.getSampler().ptr();
+    internKey.replacementMaterial = pReplacementMaterial;
+    internKey.replacementMaterialHash = pReplacementMaterial != nullptr ? pReplacementMaterial->getHash() : kEmptyHash;
+
+    return m_materialInternTable.findOrInsert(internKey.getHash(), [&]() -> MaterialData {
+      if (pReplacementMaterial != nullptr) {
+        // Make a copy - dont modify the replacement data.
+        MaterialData renderMaterialData = *pReplacementMaterial;
+        // merge in the input material from game
+        renderMaterialData.mergeLegacyMaterial(legacyMaterialData);
+        return renderMaterialData;
+      }
+
+      // Check if a Ray Portal override is needed
+      size_t rayPortalTextureIndex;
+      if (RtxOptions::getRayPortalTextureIndex(legacyMaterialData.getHash(), rayPortalTextureIndex)) {
+        assert(rayPortalTextureIndex < maxRayPortalCount);
+        assert(rayPortalTextureIndex < std::numeric_limits<uint8_t>::max());
+
+        MaterialData renderMaterialData = legacyMaterialData.as<RayPortalMaterialData>();
+        renderMaterialData.getRayPortalMaterialData().setRayPortalIndex(rayPortalTextureIndex);
+        return renderMaterialData;
+      }
 
-    // Standard legacy material conversion
-    return input.getMaterialData().as<OpaqueMaterialData>();
+      // Standard legacy material conversion
+      return legacyMaterialData.as<OpaqueMaterialData>();
+    });
   }
 
   void SceneManager::createEffectLight(Rc<DxvkContext> ctx, const DrawCallState& input, const RtInstance* instance) {
@@ -963,10 +1088,11 @@ namespace dxvk {
     }
 
     // Create and bind the RT material
-    const RtSurfaceMaterial& surfaceMaterial = createSurfaceMaterial(material, drawCall);
+    uint32_t surfaceMaterialIndex;
+    const RtSurfaceMaterial& surfaceMaterial = createSurfaceMaterial(material, drawCall, &surfaceMaterialIndex);
 
     if(isFirstUpdateThisFrame) {
-      m_instanceManager.bindMaterial(instance, surfaceMaterial);
+      m_instanceManager.bindMaterial(instance, surfaceMaterial, surfaceMaterialIndex);
     }
 
     // Update portal
@@ -1376,6 +1502,30 @@ namespace dxvk {
     return m_surfaceMaterialCache.at(index);
   }
 
+  const unsigned char* SceneManager::getPackedSurfaceMaterial(uint32_t indexInCache) {
+    // The encoding of opaque materials depends on the displacement factor, repack everything when it changes
+    if (getDisplacementFactor() != m_packedSurfaceMaterialDisplacementFactor) {
+      std::fill(m_packedSurfaceMaterialHashes.begin(), m_packedSurfaceMaterialHashes.end(), kEmptyHash);
+      m_packedSurfaceMaterialDisplacementFactor = getDisplacementFactor();
+    }
+
+    if (indexInCache >= m_packedSurfaceMaterialHashes.size()) {
+      m_packedSurfaceMaterialHashes.resize(m_surfaceMaterialCache.getTotalCount(), kEmptyHash);
+      m_packedSurfaceMaterials.resize(m_packedSurfaceMaterialHashes.size() * kSurfaceMaterialGPUSize);
+    }
+
+    unsigned char* pPacked = m_packedSurfaceMaterials.data() + indexInCache * kSurfaceMaterialGPUSize;
+
+    const RtSurfaceMaterial& surfaceMaterial = m_surfaceMaterialCache.at(indexInCache);
+    if (m_packedSurfaceMaterialHashes[indexInCache] != surfaceMaterial.getHash()) {
+      std::size_t offset = 0;
+      surfaceMaterial.writeGPUData(pPacked, offset, SURFACE_INDEX_INVALID);
+      m_packedSurfaceMaterialHashes[indexInCache] = surfaceMaterial.getHash();
+    }
+
+    return pPacked;
+  }
+
   std::optional<XXH64_hash_t> SceneManager::findLegacyTextureHashByObjectPickingValue(uint32_t objectPickingValue) {
     std::lock_guard lock { m_drawCallMeta.mutex };
 
@@ -1651,7 +1801,13 @@ namespace dxvk {
             dataOffset += kSurfaceMaterialGPUSize;
           } else {
             auto&& surfaceMaterial = m_surfaceMaterialCache.getObjectTable()[surf.surfaceMaterialIndex];
-            surfaceMaterial.writeGPUData(surfaceMaterialsGPUData.data(), dataOffset, surfaceIndex);
+            if (surfaceMaterial.getType() == RtSurfaceMaterialType::Translucent) {
+              // Translucent materials encode the index of the surface they're used by
+              surfaceMaterial.writeGPUData(surfaceMaterialsGPUData.data(), dataOffset, surfaceIndex);
+            } else {
+              memcpy(surfaceMaterialsGPUData.data() + dataOffset, getPackedSurfaceMaterial(surf.surfaceMaterialIndex), kSurfaceMaterialGPUSize);
+              dataOffset += kSurfaceMaterialGPUSize;
+            }
           }
           surfaceIndex++;
         }
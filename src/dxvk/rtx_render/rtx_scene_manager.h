@@ -50,6 +50,7 @@
 #include "rtx_mod_manager.h"
 #include "graph/rtx_graph_manager.h"
 #include "rtx_particle_system.h"
+#include "../../util/util_intern_table.h"
 #include <d3d9types.h>
 
 namespace dxvk 
@@ -60,6 +61,7 @@ struct AssetReplacement;
 struct AssetReplacer;
 class OpacityMicromapManager;
 class TerrainBaker;
+class DrawCallTraceWriter;
 
 // The resource cache can be *searched* by other users
 class ResourceCache {
@@ -80,6 +82,12 @@ protected:
   SparseUniqueCache<RtSurfaceMaterial, SurfaceMaterialHashFn> m_surfaceMaterialExtensionCache;
   fast_unordered_cache<uint32_t> m_preCreationSurfaceMaterialMap;
 
+  // GPU encoding of the surface materials, by index in m_surfaceMaterialCache. Materials are packed on first upload
+  // and repacked only when the material in a slot or the options affecting the encoding change.
+  std::vector<unsigned char> m_packedSurfaceMaterials;
+  std::vector<XXH64_hash_t> m_packedSurfaceMaterialHashes;
+  float m_packedSurfaceMaterialDisplacementFactor = 0.f;
+
   struct VolumeMaterialHashFn {
     size_t operator() (const RtVolumeMaterial& mat) const {
       return (size_t)mat.getHash();
@@ -264,6 +272,9 @@ private:
                                                  const DrawCallState& drawCallState,
                                                  uint32_t* out_indexInCache = nullptr);
 
+  // Returns the GPU encoding of a surface material in the cache, packing it if needed
+  const unsigned char* getPackedSurfaceMaterial(uint32_t indexInCache);
+
   // Updates ref counts for new buffers
   void updateBufferCache(RaytraceGeometry& newGeoData);
 
@@ -293,7 +304,9 @@ private:
   // Print all RtInstances for debugging
   void printAllRtInstances();
   
-  MaterialData determineMaterialData(const MaterialData* overrideMaterialData, const DrawCallState& input);
+  // Resolves the render material of a draw call. The result is interned for the rest of the frame, so identical
+  // game materials are only converted (or merged with their replacement) once.
+  const MaterialData& determineMaterialData(const MaterialData* overrideMaterialData, const DrawCallState& input);
   
   uint32_t m_beginUsdExportFrameNum = -1;
   bool m_enqueueDelayedClear = false;
@@ -316,8 +329,17 @@ private:
 
   std::unique_ptr<AssetReplacer> m_pReplacer;
 
+  // Render materials resolved this frame, keyed by the inputs of determineMaterialData
+  InternTable<MaterialData> m_materialInternTable;
+
   std::unique_ptr<TerrainBaker> m_terrainBaker;
 
+  // Records submitted draw calls for the scene ingest benchmark while rtx.drawCallTracePath is set
+  std::unique_ptr<DrawCallTraceWriter> m_drawCallTraceWriter;
+  std::string m_lastDrawCallTracePath;
+  void recordDrawCallTrace(const DrawCallState& input);
+  void updateDrawCallTrace();
+
   FogState m_fog;
   fast_unordered_cache<FogState> m_fogStates;
   uint32_t m_startInMediumMaterialIndex = SURFACE_INDEX_INVALID;
@@ -354,6 +376,8 @@ private:
   bool m_sssMaterialExist = false;
 
   bool m_isAntiCullingSupported = true;
+  // Results of the batched anti-culling frustum test in garbageCollection, one per linked instance, reused across frames
+  std::vector<uint8_t> m_antiCullingIsInsideFrustum;
 
   // Replacement material hash tracking for current frame (hash -> count)
   std::unordered_map<XXH64_hash_t, uint32_t> m_currentFrameReplacementMaterialHashes;
@@ -0,0 +1,113 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../../util/util_fast_cache.h"
+#include "../../util/util_matrix.h"
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+// Skinning jobs recorded over a frame, batched so that the bone palettes they use are packed into one buffer.
+// Draw calls of the same skinned mesh (a character drawn in several passes, or split into submeshes) usually share
+// a palette, so palettes are deduplicated by their hash and only uploaded once per batch.
+// Job is whatever the caller needs to record the job later, the batch only stores it.
+template<typename Job>
+class SkinningBatch {
+public:
+  struct Stats {
+    uint32_t numJobs = 0;
+    uint32_t numPalettes = 0;           // Unique palettes packed
+    uint32_t numBonesPacked = 0;
+    uint32_t numBonesDeduplicated = 0;  // Bones of palettes that were already packed, i.e. not uploaded again
+  };
+
+  // Packs a palette unless an identical one is already in the batch. Bone i of the palette is found at index
+  // paletteOffset + i of the packed bones, where paletteOffset is the returned value.
+  // Bones below minBoneIndex are not referenced by any vertex, and are neither hashed (see SkinningData::computeHash)
+  // nor packed. The returned offset thus wraps around for palettes packed at the very start of the batch, which is
+  // fine as long as bone indices are added to it with unsigned 32 bit arithmetic like the skinning shader does.
+  uint32_t addPalette(const Matrix4* pBones, uint32_t numBones, uint32_t minBoneIndex, XXH64_hash_t boneHash) {
+    const uint32_t numUsedBones = numBones - minBoneIndex;
+    const XXH64_hash_t key = getPaletteKey(numBones, minBoneIndex, boneHash);
+
+    auto iter = m_paletteOffsets.find(key);
+    if (iter != m_paletteOffsets.end()) {
+      m_stats.numBonesDeduplicated += numUsedBones;
+      return iter->second;
+    }
+
+    const uint32_t paletteOffset = static_cast<uint32_t>(m_bones.size()) - minBoneIndex;
+    m_bones.insert(m_bones.end(), pBones + minBoneIndex, pBones + numBones);
+    m_paletteOffsets.emplace(key, paletteOffset);
+
+    m_stats.numPalettes++;
+    m_stats.numBonesPacked += numUsedBones;
+    return paletteOffset;
+  }
+
+  void addJob(Job&& job) {
+    m_jobs.emplace_back(std::move(job));
+    m_stats.numJobs++;
+  }
+
+  bool empty() const {
+    return m_jobs.empty();
+  }
+
+  const std::vector<Job>& getJobs() const {
+    return m_jobs;
+  }
+
+  const std::vector<Matrix4>& getBones() const {
+    return m_bones;
+  }
+
+  const Stats& getStats() const {
+    return m_stats;
+  }
+
+  // Empties the batch once its jobs were recorded, keeping the allocations around for the next one
+  void clear() {
+    m_jobs.clear();
+    m_bones.clear();
+    m_paletteOffsets.clear();
+    m_stats = Stats {};
+  }
+
+private:
+  static XXH64_hash_t getPaletteKey(uint32_t numBones, uint32_t minBoneIndex, XXH64_hash_t boneHash) {
+    // The bone hash only covers the used range of the palette, so the range is part of the key
+    const uint32_t range[] = { numBones, minBoneIndex };
+    return XXH64(range, sizeof(range), boneHash);
+  }
+
+  std::vector<Job> m_jobs;
+  std::vector<Matrix4> m_bones;
+  fast_unordered_cache<uint32_t> m_paletteOffsets;
+  Stats m_stats;
+};
+
+}
@@ -353,6 +353,37 @@ namespace dxvk {
     }
     D3D9SharedPS prevSharedState = *static_cast<D3D9SharedPS*>(rtState.psSharedStateCB->mapPtr(0));
 
+    const Matrix4& world = drawCallState.usesVertexShader ? prevCB.programmablePipeline.normalTransform : prevCB.fixedFunction.World;
+
+    // Only bake the tiles that are not valid or whose inputs changed
+    if (m_bakingParams.isToroidal) {
+      Vector2 boundsMin, boundsMax;
+      calculateScenePlaneBounds(drawCallState, boundsMin, boundsMax);
+
+      m_tileRegionsToBake.clear();
+      m_tileTracker.addDraw(calculateDrawHash(drawCallState, replacementMaterial, world, prevSharedState), boundsMin, boundsMax, m_tileRegionsToBake);
+
+      if (m_tileRegionsToBake.empty()) {
+        // Everything this draw call covers has been baked already, keep the baked textures alive
+        for (uint32_t i = 0; i < ReplacementMaterialTextureType::Count; i++) {
+          if (m_materialTextures[i].texture.isValid() && m_materialTextures[i].isBaked()) {
+            m_materialTextures[i].markAsBaked();
+          }
+        }
+
+        const bool isBaked = getTerrainTexture(ReplacementMaterialTextureType::AlbedoOpacity).view != nullptr;
+
+        if (isBaked) {
+          updateMaterialData(ctx);
+        } else {
+          // The textures have been released in the meantime, bake everything again
+          m_tileTracker.invalidate();
+        }
+
+        return isBaked;
+      }
+    }
+
     const float2 float2CascadeLevelResolution = float2 {
       static_cast<float>(m_bakingParams.cascadeLevelResolution.width),
       static_cast<float>(m_bakingParams.cascadeLevelResolution.height)
@@ -506,36 +537,10 @@ namespace dxvk {
         m_materialTextures[textureType].markAsBaked();
       }
 
-      const Matrix4& world = drawCallState.usesVertexShader ? prevCB.programmablePipeline.normalTransform : prevCB.fixedFunction.World;
       Matrix4 worldSceneView = m_bakingParams.sceneView * world;
 
-      // Render into all cascade levels. 
-      // The levels are tiled left to right top to bottom in the combined render target texture
-      for (uint32_t iCascade = 0; iCascade < m_bakingParams.numCascades; iCascade++) {
-
-        Vector2i cascade2DIndex;
-        cascade2DIndex.y = iCascade / m_bakingParams.cascadeMapSize.x;
-        cascade2DIndex.x = iCascade - cascade2DIndex.y * m_bakingParams.cascadeMapSize.x;
-
-        // Set viewport which maps clip space <-1, 1> to screen space <0, resolution>.
-        // Accounts for inverted y coordinate in Vulkan
-        VkViewport viewport {
-          cascade2DIndex.x * float2CascadeLevelResolution.x,
-          (cascade2DIndex.y + 1) * float2CascadeLevelResolution.y,
-          float2CascadeLevelResolution.x,
-          -float2CascadeLevelResolution.y,
-          0.f, 1.f
-        };
-
-        VkOffset2D cascadeOffset = VkOffset2D {
-          static_cast<int>(cascade2DIndex.x * m_bakingParams.cascadeLevelResolution.width),
-          static_cast<int>(cascade2DIndex.y * m_bakingParams.cascadeLevelResolution.height) };
-
-        // Set scissor window which clips the screen space
-        VkRect2D scissor = { cascadeOffset, m_bakingParams.cascadeLevelResolution };
-
-        ctx->setViewports(1, &viewport, &scissor);
-
+      // Renders the draw call with the given ortho projection into the currently set viewport
+      auto drawWithProjection = [&](const Matrix4& orthoProjection) {
         // Account for the difference in UV density between the input terrain material and the baked terrain.
         // This part is just pre-multiplying the "multiply by output uv density".  The input UV density is accounted for in `postprocessTextureReadForTerrainBaking`
         float cascadeUvDensity = Material::Properties::displaceInFactor() / std::max(m_bakingParams.cascadeMapResolution.width, m_bakingParams.cascadeMapResolution.height);
@@ -557,7 +562,7 @@ namespace dxvk {
         if (drawCallState.usesVertexShader) {
           D3D9RtxVertexCaptureData& cbData = ctx->allocAndMapVertexCaptureConstantBuffer();
           cbData = prevCB.programmablePipeline;
-          cbData.customWorldToProjection = m_bakingParams.bakingCameraOrthoProjection[iCascade] * worldSceneView;
+          cbData.customWorldToProjection = orthoProjection * worldSceneView;
         } 
         else { // Fixed function path
           D3D9FixedFunctionVS& cbData = ctx->allocAndMapFixedFunctionVSConstantBuffer();
@@ -566,7 +571,7 @@ namespace dxvk {
           cbData.InverseView = m_bakingParams.inverseSceneView;
           cbData.View = m_bakingParams.sceneView;
           cbData.WorldView = worldSceneView;
-          cbData.Projection = m_bakingParams.bakingCameraOrthoProjection[iCascade];
+          cbData.Projection = orthoProjection;
 
           // Disable lighting
           for (auto& light : cbData.Lights) {
@@ -581,6 +586,81 @@ namespace dxvk {
         } else {
           ctx->DxvkContext::drawIndexed(drawParams.indexCount, drawParams.instanceCount, drawParams.firstIndex, drawParams.vertexOffset, 0);
         }
+      };
+
+      if (m_bakingParams.isToroidal) {
+        // Render into the tiles to bake. Each region is a contiguous block of tiles within a cascade level
+        const uint32_t tilesPerAxis = m_tileTracker.getTilesPerAxis();
+        const float2 tileResolution = float2 {
+          float2CascadeLevelResolution.x / tilesPerAxis,
+          float2CascadeLevelResolution.y / tilesPerAxis
+        };
+
+        for (const TerrainTileTracker::Region& region : m_tileRegionsToBake) {
+          Vector2i cascade2DIndex;
+          cascade2DIndex.y = region.level / m_bakingParams.cascadeMapSize.x;
+          cascade2DIndex.x = region.level - cascade2DIndex.y * m_bakingParams.cascadeMapSize.x;
+
+          // Cell rows go top to bottom while world tile rows go bottom to top, so flip the viewport as for the whole level
+          VkViewport viewport {
+            cascade2DIndex.x * float2CascadeLevelResolution.x + region.cellMin.x * tileResolution.x,
+            cascade2DIndex.y * float2CascadeLevelResolution.y + (region.cellMin.y + region.cellExtent.y) * tileResolution.y,
+            region.cellExtent.x * tileResolution.x,
+            -region.cellExtent.y * tileResolution.y,
+            0.f, 1.f
+          };
+
+          VkRect2D scissor {
+            VkOffset2D {
+              static_cast<int>(viewport.x),
+              static_cast<int>(viewport.y + viewport.height) },
+            VkExtent2D {
+              static_cast<uint32_t>(viewport.width),
+              static_cast<uint32_t>(-viewport.height) }
+          };
+
+          ctx->setViewports(1, &viewport, &scissor);
+
+          const float tileSize = m_bakingParams.levelTileSizes[region.level];
+
+          Matrix4 orthoProjection;
+          reinterpret_cast<float4x4*>(&orthoProjection)->SetupByOrthoProjection(
+            region.worldTileMin.x * tileSize, region.worldTileMax.x * tileSize,
+            region.worldTileMin.y * tileSize, region.worldTileMax.y * tileSize,
+            m_bakingParams.zNear, m_bakingParams.zFar);
+
+          drawWithProjection(orthoProjection);
+        }
+      } else {
+        // Render into all cascade levels. 
+        // The levels are tiled left to right top to bottom in the combined render target texture
+        for (uint32_t iCascade = 0; iCascade < m_bakingParams.numCascades; iCascade++) {
+
+          Vector2i cascade2DIndex;
+          cascade2DIndex.y = iCascade / m_bakingParams.cascadeMapSize.x;
+          cascade2DIndex.x = iCascade - cascade2DIndex.y * m_bakingParams.cascadeMapSize.x;
+
+          // Set viewport which maps clip space <-1, 1> to screen space <0, resolution>.
+          // Accounts for inverted y coordinate in Vulkan
+          VkViewport viewport {
+            cascade2DIndex.x * float2CascadeLevelResolution.x,
+            (cascade2DIndex.y + 1) * float2CascadeLevelResolution.y,
+            float2CascadeLevelResolution.x,
+            -float2CascadeLevelResolution.y,
+            0.f, 1.f
+          };
+
+          VkOffset2D cascadeOffset = VkOffset2D {
+            static_cast<int>(cascade2DIndex.x * m_bakingParams.cascadeLevelResolution.width),
+            static_cast<int>(cascade2DIndex.y * m_bakingParams.cascadeLevelResolution.height) };
+
+          // Set scissor window which clips the screen space
+          VkRect2D scissor = { cascadeOffset, m_bakingParams.cascadeLevelResolution };
+
+          ctx->setViewports(1, &viewport, &scissor);
+
+          drawWithProjection(m_bakingParams.bakingCameraOrthoProjection[iCascade]);
+        }
       }
 
       if (textureType == ReplacementMaterialTextureType::AlbedoOpacity) {
@@ -721,6 +801,9 @@ namespace dxvk {
         ctx, "baked terrain texture", resolution, getTextureFormat(textureType), VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, getClearColor(textureType), getMipLevels(textureType, resolution));
 
       m_needsMaterialDataUpdate = true;
+
+      // Previously baked tiles are gone
+      m_tileTracker.invalidate();
     }
 
     return texture;
@@ -754,6 +837,12 @@ namespace dxvk {
     }
     args.lastCascadeScale = m_bakingParams.lastCascadeScale;
 
+    args.isToroidal = m_bakingParams.isToroidal;
+    args.cameraTexcoord = m_bakingParams.isToroidal
+      ? float2 { m_bakingParams.cameraTexcoord.x, m_bakingParams.cameraTexcoord.y }
+      : float2 { 0.5f, 0.5f };
+    args.cascadeCoverageScale = m_bakingParams.isToroidal ? m_bakingParams.cascadeCoverageScale : 1.f;
+
     return args;
   }
 
@@ -812,6 +901,8 @@ namespace dxvk {
         RemixGui::DragInt("Max Cascade Levels", &cascadeMap.maxLevelsObject(), 1.f, 1, 16);
         RemixGui::DragInt("Texture Resolution Per Cascade Level", &cascadeMap.levelResolutionObject(), 8.f, 1, 32 * 1024);
         RemixGui::Checkbox("Expand Last Cascade Level", &cascadeMap.expandLastCascadeObject());
+        RemixGui::Checkbox("Incremental Baking", &cascadeMap.incrementalBakingObject());
+        RemixGui::DragInt("Tiles Per Cascade Level Axis", &cascadeMap.tilesPerLevelAxisObject(), 2.f, 2, TerrainTileTracker::kMaxTilesPerAxis);
 
         if (RemixGui::CollapsingHeader("Statistics")) {
           ImGui::Indent();
@@ -819,6 +910,11 @@ namespace dxvk {
           ImGui::Text("Cascade Levels: %u", m_bakingParams.numCascades);
           ImGui::Text("Cascade Level Resolution: %u, %u", m_bakingParams.cascadeLevelResolution.width, m_bakingParams.cascadeLevelResolution.height);
           ImGui::Text("Cascade Map Resolution: %u, %u", m_bakingParams.cascadeMapResolution.width, m_bakingParams.cascadeMapResolution.height);
+
+          if (m_bakingParams.isToroidal) {
+            ImGui::Text("Tiles Re-baked: %u", m_tileTracker.getStatistics().numTilesRebaked);
+            ImGui::Text("Tiles Reused: %u", m_tileTracker.getStatistics().numTilesReused);
+          }
         
           ImGui::Unindent();
         }
@@ -855,6 +951,8 @@ namespace dxvk {
 
     m_hasInitializedMaterialDataThisFrame = false;
 
+    m_tileTracker.endFrame();
+
     for (BakedTexture& texture : m_materialTextures) {
       texture.onFrameEnd(ctx);
     }
@@ -881,8 +979,10 @@ namespace dxvk {
 
   void TerrainBaker::prepareSceneData(Rc<RtxContext> ctx) {
     if (TerrainBaker::needsTerrainBaking()) {
-      // update the height mipmap
-      if (m_materialTextures[ReplacementMaterialTextureType::Height].texture.isValid()) {
+      // update the height mipmap, unless no tiles have been re-baked in the frame
+      const bool heightMapChanged = !m_bakingParams.isToroidal || m_tileTracker.getStatistics().numTilesRebaked > 0;
+
+      if (heightMapChanged && m_materialTextures[ReplacementMaterialTextureType::Height].texture.isValid()) {
         ScopedGpuProfileZone(ctx, "Terrain Height Mip Map");
         RtxMipmap::updateMipmap(ctx, m_materialTextures[ReplacementMaterialTextureType::Height].texture, MipmapMethod::Maximum);
       }
@@ -947,16 +1047,130 @@ namespace dxvk {
     ctx->clearColorImage(texture.image, getClearColor(textureType), subRange);
   }
 
+  Vector2 TerrainBaker::toScenePlane(const Vector3& worldPosition) {
+    // Matches the xy axes of the baking scene view
+    return Vector2(dot(SceneManager::calculateSceneRight(), worldPosition), dot(SceneManager::getSceneForward(), worldPosition));
+  }
+
+  void TerrainBaker::calculateScenePlaneBounds(const DrawCallState& drawCallState, Vector2& boundsMin, Vector2& boundsMax) {
+    const AxisAlignedBoundingBox& aabb = drawCallState.getGeometryData().boundingBox;
+
+    // Conservatively cover everything if the bounds are not known
+    if (!aabb.isValid()) {
+      boundsMin = Vector2(-FLT_MAX);
+      boundsMax = Vector2(FLT_MAX);
+      return;
+    }
+
+    const Matrix4& objectToWorld = drawCallState.getTransformData().objectToWorld;
+
+    boundsMin = Vector2(FLT_MAX);
+    boundsMax = Vector2(-FLT_MAX);
+
+    for (uint32_t i = 0; i < 8; i++) {
+      const Vector3 corner(
+        (i & 1) ? aabb.maxPos.x : aabb.minPos.x,
+        (i & 2) ? aabb.maxPos.y : aabb.minPos.y,
+        (i & 4) ? aabb.maxPos.z : aabb.minPos.z);
+
+      const Vector2 position = toScenePlane((objectToWorld * Vector4(corner, 1.f)).xyz());
+
+      boundsMin = Vector2(std::min(boundsMin.x, position.x), std::min(boundsMin.y, position.y));
+      boundsMax = Vector2(std::max(boundsMax.x, position.x), std::max(boundsMax.y, position.y));
+    }
+  }
+
+  XXH64_hash_t TerrainBaker::calculateDrawHash(const DrawCallState& drawCallState,
+                                                const OpaqueMaterialData* replacementMaterial,
+                                                const Matrix4& world,
+                                                const D3D9SharedPS& sharedState) {
+    // Camera dependent state is not hashed since baking replaces the view and projection
+    XXH64_hash_t hash = drawCallState.getHash(RtxOptions::geometryAssetHashRule());
+    hash = XXH3_64bits_withSeed(&world, sizeof(world), hash);
+    hash = XXH3_64bits_withSeed(&sharedState.Stages[0], sizeof(sharedState.Stages), hash);
+
+    if (replacementMaterial != nullptr) {
+      const XXH64_hash_t replacementMaterialHash = replacementMaterial->getHash();
+      hash = XXH3_64bits_withSeed(&replacementMaterialHash, sizeof(replacementMaterialHash), hash);
+    }
+
+    return hash;
+  }
+
+  XXH64_hash_t TerrainBaker::calculateBakingSettingsHash() const {
+    // Settings that change the baked output of every tile
+    const float settings[] = {
+      static_cast<float>(m_bakingParams.cascadeLevelResolution.width),
+      static_cast<float>(m_bakingParams.cascadeLevelResolution.height),
+      static_cast<float>(m_bakingParams.cascadeMapSize.x),
+      static_cast<float>(m_bakingParams.cascadeMapSize.y),
+      static_cast<float>(m_bakingParams.cascadeMapResolution.width),
+      static_cast<float>(m_bakingParams.cascadeMapResolution.height),
+      m_prevFrameMaxDisplaceIn,
+      m_prevFrameMaxDisplaceOut,
+      Material::Properties::displaceInFactor(),
+      static_cast<float>(Material::bakeReplacementMaterials()),
+      static_cast<float>(Material::bakeSecondaryPBRTextures()),
+      static_cast<float>(Material::replacementSupportInPS()),
+      static_cast<float>(Material::maxResolutionToUseForReplacementMaterials())
+    };
+
+    return XXH3_64bits(settings, sizeof(settings));
+  }
+
+  void TerrainBaker::clearTilesToBake(Rc<DxvkContext> ctx) {
+    m_tileTracker.getRegionsToBake(m_tileRegionsToBake);
+
+    if (m_tileRegionsToBake.empty()) {
+      return;
+    }
+
+    const uint32_t tilesPerAxis = m_tileTracker.getTilesPerAxis();
+    const VkExtent2D tileResolution = {
+      m_bakingParams.cascadeLevelResolution.width / tilesPerAxis,
+      m_bakingParams.cascadeLevelResolution.height / tilesPerAxis
+    };
+
+    for (uint32_t i = 0; i < ReplacementMaterialTextureType::Count; i++) {
+      const RtxMipmap::Resource& texture = m_materialTextures[i].texture;
+
+      if (!texture.isValid()) {
+        continue;
+      }
+
+      const Rc<DxvkImageView>& textureView = texture.views.empty() ? texture.view : texture.views[0];
+
+      VkClearValue clearValue = {};
+      clearValue.color = getClearColor(static_cast<ReplacementMaterialTextureType::Enum>(i));
+
+      for (const TerrainTileTracker::Region& region : m_tileRegionsToBake) {
+        const uint32_t cascadeY = region.level / m_bakingParams.cascadeMapSize.x;
+        const uint32_t cascadeX = region.level - cascadeY * m_bakingParams.cascadeMapSize.x;
+
+        const VkOffset3D offset = {
+          static_cast<int32_t>(cascadeX * m_bakingParams.cascadeLevelResolution.width + region.cellMin.x * tileResolution.width),
+          static_cast<int32_t>(cascadeY * m_bakingParams.cascadeLevelResolution.height + region.cellMin.y * tileResolution.height),
+          0
+        };
+
+        const VkExtent3D extent = {
+          region.cellExtent.x * tileResolution.width,
+          region.cellExtent.y * tileResolution.height,
+          1
+        };
+
+        ctx->clearImageView(textureView, offset, extent, VK_IMAGE_ASPECT_COLOR_BIT, clearValue);
+      }
+    }
+  }
+
   TerrainBaker::AxisAlignedBoundingBoxLink::AxisAlignedBoundingBoxLink(const DrawCallState& drawCallState)
     : aabbObjectSpace(drawCallState.getGeometryData().boundingBox)
     , objectToWorld(drawCallState.getTransformData().objectToWorld) {
   }
 
   AxisAlignedBoundingBox TerrainBaker::AxisAlignedBoundingBoxLink::calculateAABBInWorldSpace() {
-    AxisAlignedBoundingBox aabb;
-    aabb.minPos = (objectToWorld * Vector4(aabbObjectSpace.minPos, 1.f)).xyz();
-    aabb.maxPos = (objectToWorld * Vector4(aabbObjectSpace.maxPos, 1.f)).xyz();
-    return aabb;
+    return aabbObjectSpace.transform(objectToWorld);
   }
 
   bool TerrainBaker::needsTerrainBaking() {
@@ -973,8 +1187,15 @@ namespace dxvk {
     updateTextureFormat(dxvkCtxState);
     calculateBakingParameters(ctx, dxvkCtxState);
 
-    // Clear terrain textures
-    if (clearTerrainBeforeBaking() && !debugDisableBaking()) {
+    if (m_bakingParams.isToroidal) {
+      m_tileTracker.beginFrame(m_bakingParams.tilesPerLevelAxis, m_bakingParams.levelTileSizes, m_bakingParams.cameraScenePlanePosition, calculateBakingSettingsHash());
+
+      // Tiles being re-baked are cleared, the rest keeps the data baked in previous frames
+      if (!debugDisableBaking()) {
+        clearTilesToBake(ctx);
+      }
+    } else if (clearTerrainBeforeBaking() && !debugDisableBaking()) {
+      // Clear terrain textures
       for (uint32_t i = 0; i < ReplacementMaterialTextureType::Count; i++) {
         if (m_materialTextures[i].texture.isValid()) {
           clearMaterialTexture(ctx, static_cast<ReplacementMaterialTextureType::Enum>(i));
@@ -1003,6 +1224,13 @@ namespace dxvk {
 
     m_bakingParams.cascadeLevelResolution = VkExtent2D { cascadeMap.levelResolution(), cascadeMap.levelResolution() };
 
+    // Tiles must cover whole texels
+    if (m_bakingParams.isToroidal) {
+      const uint32_t tiles = m_bakingParams.tilesPerLevelAxis;
+      const uint32_t levelResolution = std::max(tiles, cascadeMap.levelResolution() / tiles * tiles);
+      m_bakingParams.cascadeLevelResolution = VkExtent2D { levelResolution, levelResolution };
+    }
+
     // Calculate cascade map resolution
     m_bakingParams.cascadeMapResolution.width = m_bakingParams.cascadeMapSize.x * m_bakingParams.cascadeLevelResolution.width;
     m_bakingParams.cascadeMapResolution.height = m_bakingParams.cascadeMapSize.y * m_bakingParams.cascadeLevelResolution.height;
@@ -1018,6 +1246,12 @@ namespace dxvk {
       m_bakingParams.cascadeLevelResolution.width = static_cast<uint32_t>(floor(downscale.x * m_bakingParams.cascadeMapResolution.width) / m_bakingParams.cascadeMapSize.x);
       m_bakingParams.cascadeLevelResolution.height = static_cast<uint32_t>(floor(downscale.y * m_bakingParams.cascadeMapResolution.height) / m_bakingParams.cascadeMapSize.y);
 
+      if (m_bakingParams.isToroidal) {
+        const uint32_t tiles = m_bakingParams.tilesPerLevelAxis;
+        m_bakingParams.cascadeLevelResolution.width = m_bakingParams.cascadeLevelResolution.width / tiles * tiles;
+        m_bakingParams.cascadeLevelResolution.height = m_bakingParams.cascadeLevelResolution.height / tiles * tiles;
+      }
+
       m_bakingParams.cascadeMapResolution.width = m_bakingParams.cascadeLevelResolution.width * m_bakingParams.cascadeMapSize.x;
       m_bakingParams.cascadeMapResolution.height = m_bakingParams.cascadeLevelResolution.height * m_bakingParams.cascadeMapSize.y;
 
@@ -1034,6 +1268,13 @@ namespace dxvk {
     const float metersToWorldUnitScale = RtxOptions::getMeterToWorldUnitScale();
 
     m_bakingParams.frameIndex = currentFrameIndex;
+    // Tiles baked before incremental baking was last disabled have been overwritten since
+    if (cascadeMap.incrementalBaking() && !m_bakingParams.isToroidal) {
+      m_tileTracker.invalidate();
+    }
+
+    m_bakingParams.isToroidal = cascadeMap.incrementalBaking();
+    m_bakingParams.tilesPerLevelAxis = std::clamp(cascadeMap.tilesPerLevelAxis() & ~1u, 2u, TerrainTileTracker::kMaxTilesPerAxis);
 
     const bool terrainBBOXIsValid = m_bakedTerrainBBOX.isValid();
     const float epsilon = 0.01f;      // Epsilon to ensure distances are greater or equal
@@ -1053,6 +1294,8 @@ namespace dxvk {
     // Offset by 1.f in case terrainHeight is zero (i.e. it's planar)
     const float zNear = 0.01f;
     const float zFar = (terrainHeight + 1.f) * (1 + epsilon) + zNear;
+    m_bakingParams.zNear = zNear;
+    m_bakingParams.zFar = zFar;
 
     // Compute the relative half width of the cascade map around the camera
     float cascadeMapHalfWidth = metersToWorldUnitScale * cascadeMap.defaultHalfWidth();
@@ -1076,6 +1319,20 @@ namespace dxvk {
                  std::max(std::abs(cameraRelativeTerrainBBOX.maxPos.y), std::abs(cameraRelativeTerrainBBOX.minPos.y)));
     }
 
+    if (m_bakingParams.isToroidal) {
+      // Snapped cascade levels are off-center by up to half a tile, expand coverage to account for it
+      const float tiles = static_cast<float>(m_bakingParams.tilesPerLevelAxis);
+      m_bakingParams.cascadeCoverageScale = tiles / (tiles - 1.f);
+      cascadeMapHalfWidth *= m_bakingParams.cascadeCoverageScale;
+
+      // Resizing the last cascade re-bakes it fully, so keep it stable while the camera moves around
+      if (m_lastCascadeHalfWidth < cascadeMapHalfWidth || m_lastCascadeHalfWidth > 2.f * cascadeMapHalfWidth) {
+        m_lastCascadeHalfWidth = 1.25f * cascadeMapHalfWidth;
+      }
+
+      cascadeMapHalfWidth = m_lastCascadeHalfWidth;
+    }
+
     // Construct a scene oriented view
     Matrix4 sceneView;
     {
@@ -1090,9 +1347,10 @@ namespace dxvk {
         ? camera.getPosition() + (cameraRelativeTerrainHeight * (1 + epsilon) + zNear) * up
         : camera.getPosition() + (cameraRelativeTerrainHeight * (1 - epsilon) - zNear) * up;
 
+      // Incrementally baked cascade levels are anchored to the world, so only the height follows the camera
       const Vector3 translation = Vector3(
-        dot(right, -bakingCameraPosition),
-        dot(forward, -bakingCameraPosition),
+        m_bakingParams.isToroidal ? 0.f : dot(right, -bakingCameraPosition),
+        m_bakingParams.isToroidal ? 0.f : dot(forward, -bakingCameraPosition),
         dot(up, -bakingCameraPosition));
 
       sceneView[0] = Vector4(right.x, forward.x, up.x, 0.f);
@@ -1119,6 +1377,8 @@ namespace dxvk {
     m_bakingParams.cascadeMapSize.y = static_cast<uint32_t>(ceilf(static_cast<float>(m_bakingParams.numCascades) / m_bakingParams.cascadeMapSize.x));
 
     m_bakingParams.bakingCameraOrthoProjection.resize(m_bakingParams.numCascades);
+    m_bakingParams.levelTileSizes.resize(m_bakingParams.numCascades);
+    m_bakingParams.cameraScenePlanePosition = toScenePlane(camera.getPosition());
 
     // Calculate cascade map resolution
     calculateCascadeMapResolution(ctx->getDevice());
@@ -1169,7 +1429,22 @@ namespace dxvk {
       float4x4& newProjection = *reinterpret_cast<float4x4*>(&m_bakingParams.bakingCameraOrthoProjection[iCascade]);
       newProjection.SetupByOrthoProjection(-halfWidth, halfWidth, -halfWidth, halfWidth, zNear, zFar);
 
-      if (iCascade == 0) {
+      m_bakingParams.levelTileSizes[iCascade] = 2 * halfWidth / m_bakingParams.tilesPerLevelAxis;
+
+      if (m_bakingParams.isToroidal) {
+        // Projections are set up per baked region instead.
+        // Texture space of the first cascade is anchored to the world with y flipped for Vulkan, levels wrap around every <0, 1>
+        if (iCascade == 0) {
+          const float rcpWidth = 1.f / (2 * halfWidth);
+          const Matrix4 worldAnchoredScale = Matrix4(Vector4(rcpWidth, 0, 0, 0),
+                                                     Vector4(0, -rcpWidth, 0, 0),
+                                                     Vector4(0, 0, 1, 0),
+                                                     Vector4(0, 0, 0, 1));
+
+          m_bakingParams.viewToCascade0TextureSpace = worldAnchoredScale * sceneView * camera.getViewToWorld();
+          m_bakingParams.cameraTexcoord = Vector2(m_bakingParams.cameraScenePlanePosition.x * rcpWidth, -m_bakingParams.cameraScenePlanePosition.y * rcpWidth);
+        }
+      } else if (iCascade == 0) {
         // Convert from clip space <-1, 1> to <0, 1> and flip y coordinate for Vulkan
         const Matrix4 textureOffset = Matrix4(Vector4(.5f, 0, 0, 0),
                                               Vector4(0, -.5f, 0, 0),
@@ -25,6 +25,7 @@
 #include "rtx_geometry_utils.h"
 #include "rtx_resources.h"
 #include "rtx_mipmap.h"
+#include "rtx_terrain_tile_tracker.h"
 
 namespace dxvk {
 
@@ -135,6 +136,13 @@ namespace dxvk {
                  "Expands the last cascade's footprint to cover the whole cascade map.\n"
                  "This ensures whole terrain surface has valid baked texture data to sample from\n"
                  "even if there isn't enough cascades generated (due to the current settings or limitations).");
+      RTX_OPTION("rtx.terrainBaker.cascadeMap", bool, incrementalBaking, false,
+                 "[Experimental] Splits cascade levels into tiles anchored to the world and only re-bakes tiles that scrolled into view or whose terrain draws changed.\n"
+                 "Cascade levels are addressed toroidally, so camera movement does not invalidate tiles that stay in view.\n"
+                 "Changes to terrain draws are detected at the end of a frame and show up in the baked textures a frame later.");
+      RTX_OPTION_ARGS("rtx.terrainBaker.cascadeMap", uint32_t, tilesPerLevelAxis, 8, "Number of tiles along each axis of a cascade level when incremental baking is enabled. Rounded down to an even number.",
+                      args.minValue = 2,
+                      args.maxValue = TerrainTileTracker::kMaxTilesPerAxis);
     } cascadeMap;
     
     // RTX OPTIONS
@@ -154,6 +162,14 @@ namespace dxvk {
       float zFar;
       float lastCascadeScale; // Scale applied on last cascade's size to expand it to cover the whole cascade map span
       uint32_t frameIndex = kInvalidFrameIndex;  // Frame index for which the parameters have been calculated
+
+      // Incremental baking
+      bool isToroidal = false;            // Cascade levels are anchored to the world and wrap around
+      uint32_t tilesPerLevelAxis = 1;
+      std::vector<float> levelTileSizes;  // Tile size of each cascade level [scene units]
+      Vector2 cameraScenePlanePosition;
+      Vector2 cameraTexcoord;             // Camera position in the 1st cascade's texture space
+      float cascadeCoverageScale = 1.f;   // Accounts for the camera being off-center in snapped cascade levels
     };
     bool gatherAndPreprocessReplacementTextures(Rc<RtxContext> ctx, const DrawCallState& drawCallState, OpaqueMaterialData* replacementMaterial, std::vector<RtxGeometryUtils::TextureConversionInfo>& replacementTextures);
     void updateMaterialData(Rc<RtxContext> ctx);
@@ -167,6 +183,11 @@ namespace dxvk {
     void clearMaterialTexture(Rc<DxvkContext> ctx, ReplacementMaterialTextureType::Enum textureType);
     static bool isPSReplacementSupportEnabled(const DrawCallState& drawCallState);
     VkClearColorValue getClearColor(ReplacementMaterialTextureType::Enum textureType);
+    static Vector2 toScenePlane(const Vector3& worldPosition);
+    static void calculateScenePlaneBounds(const DrawCallState& drawCallState, Vector2& boundsMin, Vector2& boundsMax);
+    static XXH64_hash_t calculateDrawHash(const DrawCallState& drawCallState, const OpaqueMaterialData* replacementMaterial, const Matrix4& world, const D3D9SharedPS& sharedState);
+    XXH64_hash_t calculateBakingSettingsHash() const;
+    void clearTilesToBake(Rc<DxvkContext> ctx);
 
     BakingParameters m_bakingParams;
 
@@ -254,6 +275,13 @@ namespace dxvk {
 
     BakedTexture m_materialTextures[ReplacementMaterialTextureType::Count];
 
+    TerrainTileTracker m_tileTracker;
+    std::vector<TerrainTileTracker::Region> m_tileRegionsToBake;
+
+    // Last cascade's half width when incremental baking is enabled. 
+    // Only updated when the terrain outgrows it or becomes much smaller, as any change re-bakes the whole level.
+    float m_lastCascadeHalfWidth = 0.f;
+
     Rc<DxvkSampler> m_terrainSampler;
   };
 }
\ No newline at end of file
@@ -0,0 +1,320 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../util/util_vector.h"
+#include "../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+  // Tracks which tiles of the terrain baker's cascade map need to be re-baked.
+  // Every cascade level is a window of N x N tiles centered around the camera, snapped to the level's tile grid.
+  // Tiles are addressed toroidally: a world tile always lands in the same cell of the level, so moving the window
+  // only requires baking the tiles that scroll in. Tiles are also re-baked when the draws overlapping them change,
+  // which is detected by hashing the inputs of all draws overlapping a tile in submission order.
+  // Changed inputs are only known once all draws of a frame have been seen, so such tiles are re-baked a frame later.
+  //
+  // Coordinates are in the baker's scene plane: x along the scene's right axis, y along its forward axis.
+  // Cells are laid out with y flipped, matching the flipped viewport used for baking.
+  class TerrainTileTracker {
+  public:
+    static constexpr uint32_t kMaxTilesPerAxis = 32;
+
+    // A rectangle of tiles of a cascade level that is contiguous both in the world and in the cascade map
+    struct Region {
+      uint32_t level;
+      Vector2i cellMin;       // In tiles, relative to the level's area in the cascade map
+      Vector2i cellExtent;
+      Vector2i worldTileMin;  // Inclusive
+      Vector2i worldTileMax;  // Exclusive
+    };
+
+    struct Statistics {
+      uint32_t numTilesRebaked = 0;  // Known when a frame begins
+      uint32_t numTilesReused = 0;   // Known when a frame ends
+    };
+
+    // Starts a frame. Changing the tile count, the number of levels or the settings hash invalidates all tiles,
+    // changing a level's tile size invalidates that level.
+    void beginFrame(uint32_t tilesPerAxis, const std::vector<float>& levelTileSizes, const Vector2& center, XXH64_hash_t settingsHash) {
+      tilesPerAxis = std::clamp(tilesPerAxis & ~1u, 2u, kMaxTilesPerAxis);
+
+      if (tilesPerAxis != m_tilesPerAxis || settingsHash != m_settingsHash || levelTileSizes.size() != m_levels.size()) {
+        m_tilesPerAxis = tilesPerAxis;
+        m_settingsHash = settingsHash;
+        m_levels.assign(levelTileSizes.size(), Level());
+      }
+
+      m_statistics = Statistics();
+      m_isInFrame = true;
+
+      const int32_t halfTiles = static_cast<int32_t>(m_tilesPerAxis / 2);
+
+      for (uint32_t iLevel = 0; iLevel < m_levels.size(); iLevel++) {
+        Level& level = m_levels[iLevel];
+
+        if (level.tileSize != levelTileSizes[iLevel]) {
+          level.tileSize = levelTileSizes[iLevel];
+          level.tiles.assign(m_tilesPerAxis * m_tilesPerAxis, Tile());
+        }
+
+        const Vector2i centerTile(
+          static_cast<int32_t>(std::lround(center.x / level.tileSize)),
+          static_cast<int32_t>(std::lround(center.y / level.tileSize)));
+
+        level.windowMin = centerTile - Vector2i(halfTiles, halfTiles);
+
+        for (uint32_t y = 0; y < m_tilesPerAxis; y++) {
+          for (uint32_t x = 0; x < m_tilesPerAxis; x++) {
+            const Vector2i worldTile = level.windowMin + Vector2i(x, y);
+            Tile& tile = getTile(level, worldTile);
+
+            tile.isBaking = !tile.isValid || tile.needsRebake || tile.worldTile != worldTile;
+            tile.needsRebake = false;
+            m_statistics.numTilesRebaked += tile.isBaking ? 1 : 0;
+            tile.worldTile = worldTile;
+            tile.frameHash = kEmptyTileHash;
+          }
+        }
+      }
+    }
+
+    // Records a draw overlapping the given scene plane bounds and returns the regions it needs to be baked into
+    void addDraw(XXH64_hash_t drawHash, const Vector2& boundsMin, const Vector2& boundsMax, std::vector<Region>& regionsToBake) {
+      regionsToBake.clear();
+
+      for (uint32_t iLevel = 0; iLevel < m_levels.size(); iLevel++) {
+        Level& level = m_levels[iLevel];
+
+        // Clamp in float space first as far away draws may not fit into integer tile indices
+        const Vector2 windowMin = toPosition(level.windowMin, level.tileSize);
+        const Vector2 windowMax = toPosition(level.windowMin + Vector2i(m_tilesPerAxis), level.tileSize);
+
+        if (boundsMax.x < windowMin.x || boundsMax.y < windowMin.y ||
+            boundsMin.x >= windowMax.x || boundsMin.y >= windowMax.y) {
+          continue;
+        }
+
+        // Inner bound kept half a tile away from the window's edge so that it rounds down to the last tile
+        const Vector2 innerMax = windowMax - Vector2(0.5f * level.tileSize);
+        const Vector2i tileMin = toTile(Vector2(std::max(boundsMin.x, windowMin.x), std::max(boundsMin.y, windowMin.y)), level.tileSize);
+        const Vector2i tileMax = toTile(Vector2(std::min(boundsMax.x, innerMax.x), std::min(boundsMax.y, innerMax.y)), level.tileSize);
+
+        m_cellMask.assign(m_tilesPerAxis * m_tilesPerAxis, false);
+        bool hasTilesToBake = false;
+
+        for (int32_t y = tileMin.y; y <= tileMax.y; y++) {
+          for (int32_t x = tileMin.x; x <= tileMax.x; x++) {
+            const Vector2i worldTile(x, y);
+            Tile& tile = getTile(level, worldTile);
+
+            // Blending is order dependent, so is the hash
+            tile.frameHash = XXH3_64bits_withSeed(&drawHash, sizeof(drawHash), tile.frameHash);
+
+            if (tile.isBaking) {
+              const Vector2i cell = worldTileToCell(worldTile, m_tilesPerAxis);
+              m_cellMask[cell.y * m_tilesPerAxis + cell.x] = true;
+              hasTilesToBake = true;
+            }
+          }
+        }
+
+        if (hasTilesToBake) {
+          appendRegions(iLevel, regionsToBake);
+        }
+      }
+    }
+
+    // Returns regions covering all tiles that are re-baked this frame
+    void getRegionsToBake(std::vector<Region>& regionsToBake) {
+      regionsToBake.clear();
+
+      for (uint32_t iLevel = 0; iLevel < m_levels.size(); iLevel++) {
+        const Level& level = m_levels[iLevel];
+
+        m_cellMask.assign(m_tilesPerAxis * m_tilesPerAxis, false);
+
+        for (uint32_t iCell = 0; iCell < level.tiles.size(); iCell++) {
+          m_cellMask[iCell] = level.tiles[iCell].isBaking;
+        }
+
+        appendRegions(iLevel, regionsToBake);
+      }
+    }
+
+    // Ends a frame. Tiles whose inputs differ from when they were baked are scheduled for re-baking.
+    void endFrame() {
+      if (!m_isInFrame) {
+        return;
+      }
+
+      for (Level& level : m_levels) {
+        for (Tile& tile : level.tiles) {
+          if (tile.isBaking) {
+            tile.bakedHash = tile.frameHash;
+            tile.isValid = !m_invalidateAtFrameEnd;
+            tile.isBaking = false;
+          } else {
+            tile.needsRebake = tile.frameHash != tile.bakedHash;
+            tile.isValid = tile.isValid && !m_invalidateAtFrameEnd;
+            m_statistics.numTilesReused++;
+          }
+        }
+      }
+
+      m_invalidateAtFrameEnd = false;
+      m_isInFrame = false;
+    }
+
+    // Discards all baked tiles, i.e. when the baked textures have been recreated.
+    // Takes effect on the next frame since draws of the current frame may have already been skipped.
+    void invalidate() {
+      if (m_isInFrame) {
+        m_invalidateAtFrameEnd = true;
+      } else {
+        for (Level& level : m_levels) {
+          for (Tile& tile : level.tiles) {
+            tile.isValid = false;
+          }
+        }
+      }
+    }
+
+    // Center of a level's window in the scene plane
+    Vector2 getWindowCenter(uint32_t level) const {
+      const Level& l = m_levels[level];
+      return toPosition(l.windowMin + Vector2i(m_tilesPerAxis / 2), l.tileSize);
+    }
+
+    uint32_t getTilesPerAxis() const {
+      return m_tilesPerAxis;
+    }
+
+    const Statistics& getStatistics() const {
+      return m_statistics;
+    }
+
+    static Vector2i worldTileToCell(const Vector2i& worldTile, uint32_t tilesPerAxis) {
+      const int32_t n = static_cast<int32_t>(tilesPerAxis);
+      auto wrap = [n](int32_t v) { return ((v % n) + n) % n; };
+
+      // Y is flipped, the world tile above a tile is stored in the cell row above
+      return Vector2i(wrap(worldTile.x), wrap(-worldTile.y - 1));
+    }
+
+  private:
+    static constexpr XXH64_hash_t kEmptyTileHash = 0;
+
+    struct Tile {
+      Vector2i worldTile = Vector2i(0, 0);
+      XXH64_hash_t bakedHash = kEmptyTileHash;  // Input hash the tile was baked with
+      XXH64_hash_t frameHash = kEmptyTileHash;  // Input hash accumulated this frame
+      bool isValid = false;      // Holds baked data of worldTile
+      bool needsRebake = false;  // Inputs changed since the tile was baked
+      bool isBaking = false;     // Re-baked this frame
+    };
+
+    struct Level {
+      float tileSize = 0.f;
+      Vector2i windowMin = Vector2i(0, 0);
+      std::vector<Tile> tiles;  // Indexed by cell
+    };
+
+    static Vector2i toTile(const Vector2& position, float tileSize) {
+      return Vector2i(
+        static_cast<int32_t>(std::floor(position.x / tileSize)),
+        static_cast<int32_t>(std::floor(position.y / tileSize)));
+    }
+
+    static Vector2 toPosition(const Vector2i& tile, float tileSize) {
+      return Vector2(static_cast<float>(tile.x) * tileSize, static_cast<float>(tile.y) * tileSize);
+    }
+
+    Tile& getTile(Level& level, const Vector2i& worldTile) {
+      const Vector2i cell = worldTileToCell(worldTile, m_tilesPerAxis);
+      return level.tiles[cell.y * m_tilesPerAxis + cell.x];
+    }
+
+    // Greedily merges masked cells into rectangles that do not cross the toroidal seam
+    void appendRegions(uint32_t iLevel, std::vector<Region>& regions) {
+      const Level& level = m_levels[iLevel];
+      const uint32_t n = m_tilesPerAxis;
+
+      auto worldTileOf = [&](uint32_t x, uint32_t y) { return level.tiles[y * n + x].worldTile; };
+      auto isAvailable = [&](uint32_t x, uint32_t y) { return m_cellMask[y * n + x]; };
+
+      for (uint32_t y = 0; y < n; y++) {
+        for (uint32_t x = 0; x < n; x++) {
+          if (!isAvailable(x, y)) {
+            continue;
+          }
+
+          const Vector2i origin = worldTileOf(x, y);
+
+          uint32_t width = 1;
+          while (x + width < n && isAvailable(x + width, y) &&
+                 worldTileOf(x + width, y).x == origin.x + static_cast<int32_t>(width)) {
+            width++;
+          }
+
+          uint32_t height = 1;
+          while (y + height < n && worldTileOf(x, y + height).y == origin.y - static_cast<int32_t>(height)) {
+            bool isRowAvailable = true;
+            for (uint32_t i = 0; i < width && isRowAvailable; i++) {
+              isRowAvailable = isAvailable(x + i, y + height);
+            }
+
+            if (!isRowAvailable) {
+              break;
+            }
+            height++;
+          }
+
+          for (uint32_t j = 0; j < height; j++) {
+            for (uint32_t i = 0; i < width; i++) {
+              m_cellMask[(y + j) * n + x + i] = false;
+            }
+          }
+
+          Region& region = regions.emplace_back();
+          region.level = iLevel;
+          region.cellMin = Vector2i(x, y);
+          region.cellExtent = Vector2i(width, height);
+          region.worldTileMin = Vector2i(origin.x, origin.y - static_cast<int32_t>(height) + 1);
+          region.worldTileMax = Vector2i(origin.x + static_cast<int32_t>(width), origin.y + 1);
+        }
+      }
+    }
+
+    uint32_t m_tilesPerAxis = 0;
+    XXH64_hash_t m_settingsHash = 0;
+    std::vector<Level> m_levels;
+    std::vector<bool> m_cellMask;
+    Statistics m_statistics;
+    bool m_isInFrame = false;
+    bool m_invalidateAtFrameEnd = false;
+  };
+}
@@ -0,0 +1,187 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_texture_hasher.h"
+
+#include "../dxvk_buffer.h"
+#include "../dxvk_scoped_annotation.h"
+#include "../../util/util_env.h"
+#include "../../util/util_likely.h"
+
+namespace dxvk {
+
+  namespace {
+    XXH64_hash_t hashChunk(const uint8_t* pData, size_t size, TextureHashMethod method, uint32_t chunk) {
+      switch (method) {
+      case TextureHashMethod::Xxh64:
+        return XXH64(pData, size, 0);
+      case TextureHashMethod::Tree: {
+        const size_t offset = chunk * TextureHasher::kChunkSize;
+        return XXH3_64bits(pData + offset, std::min(TextureHasher::kChunkSize, size - offset));
+      }
+      default:
+        return XXH3_64bits(pData, size);
+      }
+    }
+
+    XXH64_hash_t combineChunkHashes(const XXH64_hash_t* pChunkHashes, uint32_t numChunks, size_t size) {
+      // Note: a single chunk is hashed as a whole, so small textures keep the legacy hash with any method
+      if (numChunks == 1) {
+        return pChunkHashes[0];
+      }
+
+      return XXH3_64bits_withSeed(pChunkHashes, numChunks * sizeof(XXH64_hash_t), size);
+    }
+  }
+
+  PendingTextureHash::PendingTextureHash(const void* pData, size_t size, TextureHashMethod method, DxvkBuffer* pSource)
+    : m_pData(static_cast<const uint8_t*>(pData))
+    , m_size(size)
+    , m_method(method)
+    , m_source(pSource)
+    , m_numChunks(TextureHasher::getNumChunks(size, method))
+    , m_chunkHashes(m_numChunks)
+    , m_numPendingChunks(m_numChunks) {
+  }
+
+  PendingTextureHash::~PendingTextureHash() {
+  }
+
+  XXH64_hash_t PendingTextureHash::get() {
+    if (likely(isReady())) {
+      return m_hash;
+    }
+
+    ScopedCpuProfileZone();
+
+    process();
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this] { return isReady(); });
+    return m_hash;
+  }
+
+  void PendingTextureHash::process() {
+    uint32_t chunk;
+    while ((chunk = m_nextChunk.fetch_add(1)) < m_numChunks) {
+      m_chunkHashes[chunk] = hashChunk(m_pData, m_size, m_method, chunk);
+
+      if (m_numPendingChunks.fetch_sub(1) == 1) {
+        finish();
+      }
+    }
+  }
+
+  void PendingTextureHash::finish() {
+    m_hash = combineChunkHashes(m_chunkHashes.data(), m_numChunks, m_size);
+
+    // The data isn't read anymore
+    m_source = nullptr;
+    m_chunkHashes = std::vector<XXH64_hash_t>();
+
+    {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_ready.store(true, std::memory_order_release);
+    }
+    m_cond.notify_all();
+  }
+
+  TextureHasher::TextureHasher(uint32_t numThreads) {
+    for (uint32_t i = 0; i < numThreads; i++) {
+      m_threads.push_back(std::make_unique<dxvk::thread>([this] { threadFunc(); }));
+    }
+  }
+
+  TextureHasher::~TextureHasher() {
+    {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_stopped = true;
+    }
+    m_cond.notify_all();
+
+    for (auto& thread : m_threads) {
+      thread->join();
+    }
+  }
+
+  Rc<PendingTextureHash> TextureHasher::schedule(const void* pData, size_t size, TextureHashMethod method, DxvkBuffer* pSource) {
+    Rc<PendingTextureHash> pendingHash = new PendingTextureHash(pData, size, method, pSource);
+
+    if (m_threads.empty()) {
+      pendingHash->process();
+      return pendingHash;
+    }
+
+    const size_t numQueued = std::min<size_t>(pendingHash->m_numChunks, m_threads.size());
+    {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      for (size_t i = 0; i < numQueued; i++) {
+        m_queue.push_back(pendingHash);
+      }
+    }
+
+    if (numQueued == 1) {
+      m_cond.notify_one();
+    } else {
+      m_cond.notify_all();
+    }
+
+    return pendingHash;
+  }
+
+  XXH64_hash_t TextureHasher::hash(const void* pData, size_t size, TextureHashMethod method) {
+    const uint32_t numChunks = getNumChunks(size, method);
+    if (numChunks == 1) {
+      return hashChunk(static_cast<const uint8_t*>(pData), size, method, 0);
+    }
+
+    std::vector<XXH64_hash_t> chunkHashes(numChunks);
+    for (uint32_t chunk = 0; chunk < numChunks; chunk++) {
+      chunkHashes[chunk] = hashChunk(static_cast<const uint8_t*>(pData), size, method, chunk);
+    }
+
+    return combineChunkHashes(chunkHashes.data(), numChunks, size);
+  }
+
+  void TextureHasher::threadFunc() {
+    env::setThreadName("rtx-texture-hasher");
+
+    while (true) {
+      Rc<PendingTextureHash> pendingHash;
+
+      {
+        std::unique_lock<dxvk::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this] { return m_stopped || !m_queue.empty(); });
+
+        // Note: the queue is drained before stopping, so that every pending hash completes and releases its source
+        if (m_queue.empty()) {
+          return;
+        }
+
+        pendingHash = std::move(m_queue.front());
+        m_queue.pop_front();
+      }
+
+      pendingHash->process();
+    }
+  }
+
+}
@@ -0,0 +1,126 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "../../util/rc/util_rc.h"
+#include "../../util/rc/util_rc_ptr.h"
+#include "../../util/thread.h"
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+  class DxvkBuffer;
+
+  enum class TextureHashMethod : uint8_t {
+    // XXH3 of the whole data, the hash game textures are identified by
+    Xxh3,
+    // XXH64 of the whole data, see rtx.useObsoleteHashOnTextureUpload
+    Xxh64,
+    // XXH3 of the data when it fits in a single chunk (matching Xxh3), otherwise XXH3 of the XXH3 hashes of each
+    // chunk seeded with the data size. Chunks are hashed in parallel.
+    Tree,
+  };
+
+  // Content hash of a texture, computed by the TextureHasher worker threads
+  class PendingTextureHash : public RcObject {
+  public:
+    ~PendingTextureHash();
+
+    bool isReady() const {
+      return m_ready.load(std::memory_order_acquire);
+    }
+
+    // Returns the hash, computing the chunks no worker picked up yet on the calling thread and waiting for the others
+    XXH64_hash_t get();
+
+  private:
+    friend class TextureHasher;
+
+    PendingTextureHash(const void* pData, size_t size, TextureHashMethod method, DxvkBuffer* pSource);
+
+    // Hashes chunks until every chunk was picked up
+    void process();
+    void finish();
+
+    const uint8_t* m_pData;
+    size_t m_size;
+    TextureHashMethod m_method;
+    // Keeps the data alive until it is hashed
+    Rc<DxvkBuffer> m_source;
+
+    uint32_t m_numChunks;
+    std::vector<XXH64_hash_t> m_chunkHashes;
+    std::atomic<uint32_t> m_nextChunk = { 0 };
+    std::atomic<uint32_t> m_numPendingChunks;
+
+    XXH64_hash_t m_hash = 0;
+    std::atomic<bool> m_ready = { false };
+    dxvk::mutex m_mutex;
+    dxvk::condition_variable m_cond;
+  };
+
+  // Hashes texture contents on worker threads, so that textures created in bulk (i.e. during level loads) don't stall
+  // the thread creating them. Consumers wait for a hash on first use through PendingTextureHash::get.
+  // Only the Tree method splits a texture into chunks: the Xxh3 and Xxh64 hashes game textures are identified by
+  // can't be computed in parts, so with them each texture is hashed whole by a single worker, however large.
+  class TextureHasher {
+  public:
+    static constexpr size_t kChunkSize = 256 * 1024;
+
+    explicit TextureHasher(uint32_t numThreads);
+    ~TextureHasher();
+
+    TextureHasher(const TextureHasher&) = delete;
+    TextureHasher& operator=(const TextureHasher&) = delete;
+
+    // Schedules the hash of [pData, pData + size). The data must not change until the hash is ready, pSource is
+    // kept alive until then when given.
+    Rc<PendingTextureHash> schedule(const void* pData, size_t size, TextureHashMethod method, DxvkBuffer* pSource = nullptr);
+
+    // Computes the same hash as schedule() on the calling thread
+    static XXH64_hash_t hash(const void* pData, size_t size, TextureHashMethod method);
+
+    static uint32_t getNumChunks(size_t size, TextureHashMethod method) {
+      // Note: empty data still has a single (empty) chunk
+      return method == TextureHashMethod::Tree ? std::max(static_cast<uint32_t>((size + kChunkSize - 1) / kChunkSize), 1u) : 1;
+    }
+
+  private:
+    void threadFunc();
+
+    // Hashes scheduled with more than one chunk are queued once per worker which may help with them
+    std::deque<Rc<PendingTextureHash>> m_queue;
+    dxvk::mutex m_mutex;
+    dxvk::condition_variable m_cond;
+    bool m_stopped = false;
+
+    std::vector<std::unique_ptr<dxvk::thread>> m_threads;
+  };
+
+}
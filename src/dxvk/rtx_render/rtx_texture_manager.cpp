@@ -786,17 +786,25 @@ namespace dxvk {
   };
 
   namespace {
-    float calcResolutionAndHistoryWeightForTexture(const FeedbackAccum& x, const uint32_t& curframe) {
-      uint32_t framediff = (curframe >= x.frame) ? curframe - x.frame : 0;
-      float fr_weight = 1.F / (1.F + framediff);
+    // Number of frames after which the priority of a texture's mip demand halves, if it is not sampled at that mip count again
+    constexpr double kMipDemandHalfLifeFrames = 8.0;
 
-      // need relative mip count? divide by asset_mipcount?
-      float mip_weight = float(std::min(x.mipcount, MAX_MIPS)) / float(MAX_MIPS);
+    // Priority of a texture for the texture budget: its accumulated mip count, decayed by the frames since that
+    // mip count was last seen. The decay is exponential so that the order of two textures does not change while
+    // neither is sampled, which lets the priorities live in a heap instead of being re-sorted every frame.
+    // In log2 space and relative to frame 0, i.e. log2((1 + mipcount) * 2^((frame - curframe) / halfLife)) + curframe / halfLife.
+    double calcMipDemandPriority(const FeedbackAccum& x) {
+      return std::log2(1.0 + std::min(x.mipcount, MAX_MIPS)) + x.frame / kMipDemandHalfLifeFrames;
+    }
+
+    // Frames during which a texture remains prioritized by sampler feedback after it was last used with it
+    constexpr uint32_t kSamplerFeedbackWindowFrames = 2;
 
-      assert(fr_weight >= 0 && fr_weight <= 1);
-      assert(mip_weight >= 0 && mip_weight <= 1);
+    // Bound on the texture uses queued between two garbage collections, which only run on ray traced frames
+    constexpr size_t kMaxQueuedTextureUses = 4 * size_t(SAMPLER_FEEDBACK_MAX_TEXTURE_COUNT);
 
-      return (2.0f * mip_weight) + (1.0f * fr_weight);
+    bool hasRequestedMipsResident(const ManagedTexture& tex) {
+      return tex.m_state == ManagedTexture::State::kVidMem && tex.hasUploadedMips(tex.m_requestedMips, true);
     }
   } // unnamed namespace
 
@@ -933,10 +941,28 @@ namespace dxvk {
     }
 
     const auto curframe = m_device->getCurrentFrameId();
+    const uint16_t stamp = tex->m_samplerFeedbackStamp;
+
+    if (tex->m_frameLastUsed != curframe && stamp != SAMPLER_FEEDBACK_INVALID) {
+      // Garbage collection re-evaluates a texture once it falls out of the usage windows, and when it comes back
+      if (m_usageExpiry.size() < kMaxQueuedTextureUses) {
+        m_samplerFeedbackExpiry.emplace_back(curframe, stamp);
+        m_usageExpiry.emplace_back(curframe, stamp);
+      } else {
+        m_rebuildStreamingStates = true;
+      }
+
+      if (tex->m_frameLastUsed == UINT32_MAX || curframe - tex->m_frameLastUsed > 1) {
+        markStreamingStateDirty(stamp);
+      }
+    }
     tex->m_frameLastUsed = curframe;
 
     // If async is not allowed, schedule immediately on this thread, and never demote
     if (!async || RtxOptions::TextureManager::neverDowngradeTextures()) {
+      if (tex->m_canDemote && stamp != SAMPLER_FEEDBACK_INVALID) {
+        markStreamingStateDirty(stamp);
+      }
       tex->m_canDemote = false;
       tex->requestMips(MAX_MIPS);
       scheduleTextureLoad(tex, false);
@@ -952,6 +978,9 @@ namespace dxvk {
       // i.e. if N frames has passed for a texture that was not used in a scene, then remove it from VRAM.
       return;
     }
+    if (tex->m_frameLastUsedForSamplerFeedback == UINT32_MAX || curframe - tex->m_frameLastUsedForSamplerFeedback >= kSamplerFeedbackWindowFrames) {
+      markStreamingStateDirty(stamp);
+    }
     tex->m_frameLastUsedForSamplerFeedback = curframe;
   }
 
@@ -1056,6 +1085,9 @@ namespace dxvk {
       // replace information about the file
       tex->m_assetData = newAssetData;
       tex->requestMips(0);
+      if (tex->m_samplerFeedbackStamp != SAMPLER_FEEDBACK_INVALID) {
+        markStreamingStateDirty(tex->m_samplerFeedbackStamp, true);
+      }
       constexpr bool forceUnload = true; // do not check current mip count
       scheduleTextureLoad(tex, false, forceUnload );
 
@@ -1201,9 +1233,10 @@ namespace dxvk {
 
 #define FRAMES_TO_DETAIN 60
 
-  void SamplerFeedback::accumulateMipCounts(uint32_t len, uint32_t curframe, bool canReset) {
+  void SamplerFeedback::accumulateMipCounts(uint32_t len, uint32_t curframe, bool canReset, std::vector<uint16_t>& changedStamps) {
     for (uint32_t stamp = 0; stamp < len; stamp++) {
       FeedbackAccum& accum = m_accumulatedMipcount[stamp];
+      const FeedbackAccum previous = accum;
 
       const auto new_mipcount = m_noisyMipcount[stamp];
 
@@ -1223,6 +1256,43 @@ namespace dxvk {
           accum.mipcount = (uint8_t)std::clamp(accum.avgMipcount, 0.f, float(MAX_MIPS));
         }
       }
+
+      if (accum.mipcount != previous.mipcount || accum.frame != previous.frame) {
+        changedStamps.push_back(uint16_t(stamp));
+      }
+    }
+  }
+
+  void RtxTextureManager::markStreamingStateDirty(uint16_t stamp, bool resetGrant) {
+    // Textures which are not tracked yet are evaluated when garbage collection first sees them
+    if (stamp >= m_streamingStates.size()) {
+      return;
+    }
+
+    StreamingState& state = m_streamingStates[stamp];
+    if (resetGrant) {
+      state.grantedMips = StreamingState::kNoGrant;
+    }
+
+    if (!state.isDirty) {
+      state.isDirty = true;
+      m_dirtyStamps.push_back(stamp);
+    }
+  }
+
+  void RtxTextureManager::grantMips(uint16_t stamp, uint8_t mipCount) {
+    StreamingState& state = m_streamingStates[stamp];
+    if (state.grantedMips == mipCount) {
+      return;
+    }
+
+    state.grantedMips = mipCount;
+    state.pTexture->requestMips(mipCount);
+    scheduleTextureLoad(state.pTexture, true);
+
+    if (!state.isPendingLoad && !hasRequestedMipsResident(*state.pTexture)) {
+      state.isPendingLoad = true;
+      m_pendingLoadStamps.push_back(stamp);
     }
   }
 
@@ -1233,89 +1303,174 @@ namespace dxvk {
     const auto numFramesToKeepMaterialTextures = RtxOptions::numFramesToKeepMaterialTextures();
 
     uint32_t sfTextureCount = m_sf.fetchNoisyMipCounts(gpuAccessedMips);
-    m_sf.accumulateMipCounts(sfTextureCount, curframe, m_wasTextureBudgetPressure);
+    m_changedFeedbackStamps.clear();
+    m_sf.accumulateMipCounts(sfTextureCount, curframe, m_wasTextureBudgetPressure, m_changedFeedbackStamps);
     m_wasTextureBudgetPressure = false;
 
-    
-    static auto prioritylist = std::vector<ManagedTexture*>{};
-    static auto checkonlyframes = std::vector<ManagedTexture*>{};
+    // Streaming decisions are only re-evaluated for the textures whose inputs changed: new textures, textures
+    // coming into or falling out of use, textures whose accumulated feedback changed and textures whose mips
+    // were changed elsewhere. Everything else keeps what it was granted.
     {
-      prioritylist.clear();
-      checkonlyframes.clear();
       auto ls = std::unique_lock{ m_sf.m_idToTexture_mutex };
-      for (const auto& tex : m_sf.m_idToTexture) {
-        assert(tex != nullptr);
-        if (tex != nullptr && tex->m_canDemote) {
-          if ((tex->m_frameLastUsedForSamplerFeedback != UINT32_MAX) && (curframe - tex->m_frameLastUsedForSamplerFeedback < 2)) {
-            assert(tex->m_samplerFeedbackStamp != SAMPLER_FEEDBACK_INVALID);
-            prioritylist.push_back(tex.ptr());
-          } else {
-            checkonlyframes.push_back(tex.ptr());
-          }
+
+      const uint32_t textureCount = uint32_t(m_sf.m_idToTexture.size());
+      for (uint32_t stamp = uint32_t(m_streamingStates.size()); stamp < textureCount; stamp++) {
+        m_streamingStates.emplace_back().pTexture = m_sf.m_idToTexture[stamp].ptr();
+        markStreamingStateDirty(uint16_t(stamp));
+      }
+    }
+
+    if (numFramesToKeepMaterialTextures != m_trackedFramesToKeep || RtxOptions::lowMemoryGpu() != m_trackedLowMemoryGpu) {
+      m_trackedFramesToKeep = numFramesToKeepMaterialTextures;
+      m_trackedLowMemoryGpu = RtxOptions::lowMemoryGpu();
+      m_rebuildStreamingStates = true;
+    }
+
+    if (m_rebuildStreamingStates) {
+      // Re-evaluate everything, and re-queue the uses which are still inside of their windows
+      m_rebuildStreamingStates = false;
+      m_samplerFeedbackExpiry.clear();
+      m_usageExpiry.clear();
+
+      for (uint32_t stamp = 0; stamp < m_streamingStates.size(); stamp++) {
+        const ManagedTexture* tex = m_streamingStates[stamp].pTexture;
+        markStreamingStateDirty(uint16_t(stamp));
+
+        if (tex->m_frameLastUsedForSamplerFeedback != UINT32_MAX && tex->m_frameLastUsedForSamplerFeedback + kSamplerFeedbackWindowFrames > curframe) {
+          m_samplerFeedbackExpiry.emplace_back(tex->m_frameLastUsedForSamplerFeedback, uint16_t(stamp));
+        }
+        if (tex->m_frameLastUsed != UINT32_MAX && tex->m_frameLastUsed + numFramesToKeepMaterialTextures >= curframe) {
+          m_usageExpiry.emplace_back(tex->m_frameLastUsed, uint16_t(stamp));
         }
       }
+
+      std::sort(m_samplerFeedbackExpiry.begin(), m_samplerFeedbackExpiry.end());
+      std::sort(m_usageExpiry.begin(), m_usageExpiry.end());
     }
 
+    for (uint16_t stamp : m_changedFeedbackStamps) {
+      markStreamingStateDirty(stamp);
+    }
 
-    // For no-sampler-feedback textures, don't use the prioritization and budgeting (for now),
-    // as we can't predict how draw call textures (sky, terrain, etc) are used
-    for (ManagedTexture* tex : checkonlyframes) {
-      assert(tex && tex->m_canDemote);
-      tex->requestMips(
-        (tex->m_frameLastUsed != UINT32_MAX) && (curframe - tex->m_frameLastUsed <= numFramesToKeepMaterialTextures)
-        ? MAX_MIPS
-        : 0);
-      scheduleTextureLoad(tex, true);
+    // Uses are queued in frame order, a texture used again since is queued again
+    while (!m_samplerFeedbackExpiry.empty() && m_samplerFeedbackExpiry.front().first + kSamplerFeedbackWindowFrames <= curframe) {
+      const auto [frame, stamp] = m_samplerFeedbackExpiry.front();
+      m_samplerFeedbackExpiry.pop_front();
+
+      if (stamp < m_streamingStates.size() && m_streamingStates[stamp].pTexture->m_frameLastUsedForSamplerFeedback == frame) {
+        markStreamingStateDirty(stamp);
+      }
     }
 
-    
-    // For sampler-feedback textures, make a list, so that the low priority textures are at the end.
-    // If full list doesn't fit into the budget, demote the low priority ones.
-    {
-      auto l_sort = [curframe, this](const ManagedTexture* a, const ManagedTexture* b) {
-        assert(a && b);
-        float weightA = calcResolutionAndHistoryWeightForTexture(m_sf.m_accumulatedMipcount[a->m_samplerFeedbackStamp], curframe);
-        float weightB = calcResolutionAndHistoryWeightForTexture(m_sf.m_accumulatedMipcount[b->m_samplerFeedbackStamp], curframe);
+    while (!m_usageExpiry.empty() && m_usageExpiry.front().first + numFramesToKeepMaterialTextures < curframe) {
+      const auto [frame, stamp] = m_usageExpiry.front();
+      m_usageExpiry.pop_front();
 
-        if (std::abs(weightA - weightB) < 0.00001f) {
-          return (a->m_samplerFeedbackStamp < b->m_samplerFeedbackStamp); // stable fallback, if too similar
-        }
-        return weightA > weightB;
-      };
-      std::sort(prioritylist.begin(), prioritylist.end(), l_sort);
+      if (stamp < m_streamingStates.size() && m_streamingStates[stamp].pTexture->m_frameLastUsed == frame) {
+        markStreamingStateDirty(stamp);
+      }
     }
+
+    // A load requested while a texture is in flight is dropped, so keep scheduling textures until their grant is resident
     {
-      const size_t budgetBytes = calcTextureMemoryBudgetBytes(m_device);
-      size_t       usedBytes   = 0;
-      for (ManagedTexture* tex : prioritylist) {
-        assert(tex && tex->m_canDemote && tex->m_samplerFeedbackStamp != SAMPLER_FEEDBACK_INVALID);
-        // for low memory GPUs we should do our best to not blow through all memory, lower the highest quality mip level
-        // need to account for textures that dont have more than 1 mip level here too.
-        const uint32_t allmipcount = tex->m_assetData->info().mipLevels - ((RtxOptions::lowMemoryGpu() && tex->m_assetData->info().mipLevels > 0) ? 1u : 0u);
-
-        uint32_t mipc = m_sf.m_accumulatedMipcount[tex->m_samplerFeedbackStamp].mipcount;
-        mipc = std::min(mipc, allmipcount);
-
-        // TODO: potential bottleneck
-        size_t byteSize = calcSizeForAsset(*tex->m_assetData, allmipcount - mipc, allmipcount);
-
-        if (usedBytes + byteSize <= budgetBytes) {
-          usedBytes += byteSize;
-          tex->requestMips(mipc);
+      size_t numPending = 0;
+      for (uint16_t stamp : m_pendingLoadStamps) {
+        StreamingState& state = m_streamingStates[stamp];
+        scheduleTextureLoad(state.pTexture, true);
+
+        if (hasRequestedMipsResident(*state.pTexture)) {
+          state.isPendingLoad = false;
         } else {
-          // doesn't fit => demote
-          tex->requestMips(0);
-          m_wasTextureBudgetPressure = true;
+          m_pendingLoadStamps[numPending++] = stamp;
         }
+      }
+      m_pendingLoadStamps.resize(numPending);
+    }
 
-        scheduleTextureLoad(tex, true);
+    m_updatedDemandStamps.clear();
+
+    for (uint16_t stamp : m_dirtyStamps) {
+      StreamingState& state = m_streamingStates[stamp];
+      state.isDirty = false;
+
+      ManagedTexture* tex = state.pTexture;
+      assert(tex != nullptr);
+      if (tex == nullptr || !tex->m_canDemote) {
+        m_mipDemandHeap.remove(stamp);
+        continue;
       }
-      assert(usedBytes <= budgetBytes);
 
-      // for debug report
-      g_streamedTextures_budgetBytes = budgetBytes;
-      g_streamedTextures_usedBytes   = usedBytes;
+      const bool isPrioritized = (tex->m_frameLastUsedForSamplerFeedback != UINT32_MAX) &&
+                                 (curframe - tex->m_frameLastUsedForSamplerFeedback < kSamplerFeedbackWindowFrames);
+
+      if (!isPrioritized) {
+        // For no-sampler-feedback textures, don't use the prioritization and budgeting (for now),
+        // as we can't predict how draw call textures (sky, terrain, etc) are used
+        m_mipDemandHeap.remove(stamp);
+        grantMips(stamp,
+          (tex->m_frameLastUsed != UINT32_MAX) && (curframe - tex->m_frameLastUsed <= numFramesToKeepMaterialTextures)
+          ? MAX_MIPS
+          : uint8_t(0));
+        continue;
+      }
+
+      assert(tex->m_samplerFeedbackStamp == stamp);
+      const FeedbackAccum& accum = m_sf.m_accumulatedMipcount[stamp];
+
+      // for low memory GPUs we should do our best to not blow through all memory, lower the highest quality mip level
+      // need to account for textures that dont have more than 1 mip level here too.
+      const uint32_t allmipcount = tex->m_assetData->info().mipLevels - ((RtxOptions::lowMemoryGpu() && tex->m_assetData->info().mipLevels > 0) ? 1u : 0u);
+      const uint8_t mipc = uint8_t(std::min<uint32_t>(accum.mipcount, allmipcount));
+
+      MipDemandHeap::Demand demand;
+      demand.priority = calcMipDemandPriority(accum);
+      demand.bytes = (m_mipDemandHeap.contains(stamp) && state.demandedMips == mipc)
+        ? m_mipDemandHeap.get(stamp).bytes
+        : calcSizeForAsset(*tex->m_assetData, allmipcount - mipc, allmipcount);
+
+      state.demandedMips = mipc;
+      m_mipDemandHeap.update(stamp, demand);
+      m_updatedDemandStamps.push_back(stamp);
     }
+    m_dirtyStamps.clear();
+
+    // For sampler-feedback textures, grant every demand when they all fit into the budget.
+    // If they don't, keep the high priority demands which fit and demote the others.
+    const size_t budgetBytes = calcTextureMemoryBudgetBytes(m_device);
+    size_t       usedBytes   = 0;
+
+    if (m_mipDemandHeap.getTotalBytes() <= budgetBytes) {
+      usedBytes = m_mipDemandHeap.getTotalBytes();
+
+      for (uint16_t stamp : m_demotedStamps) {
+        if (m_mipDemandHeap.contains(stamp)) {
+          grantMips(stamp, m_streamingStates[stamp].demandedMips);
+        }
+      }
+      m_demotedStamps.clear();
+
+      for (uint16_t stamp : m_updatedDemandStamps) {
+        grantMips(stamp, m_streamingStates[stamp].demandedMips);
+      }
+    } else {
+      m_demotedStamps.clear();
+
+      usedBytes = m_mipDemandHeap.fitBudget(budgetBytes,
+        [this](uint32_t stamp, const MipDemandHeap::Demand&) {
+          grantMips(uint16_t(stamp), m_streamingStates[stamp].demandedMips);
+        },
+        [this](uint32_t stamp, const MipDemandHeap::Demand&) {
+          // doesn't fit => demote
+          grantMips(uint16_t(stamp), 0);
+          m_demotedStamps.push_back(uint16_t(stamp));
+        });
+      m_wasTextureBudgetPressure = true;
+    }
+    assert(usedBytes <= budgetBytes);
+
+    // for debug report
+    g_streamedTextures_budgetBytes = budgetBytes;
+    g_streamedTextures_usedBytes   = usedBytes;
   }
 
   void RtxTextureManager::manageBudgetWithPriority() {
@@ -1335,6 +1490,7 @@ namespace dxvk {
       if (currentMips > 0) {
         const size_t oldSize = calcSizeForAsset(*tex->m_assetData, allmipcount - currentMips, allmipcount);
         tex->requestMips(0);
+        markStreamingStateDirty(tex->m_samplerFeedbackStamp, true);
         scheduleTextureLoad(tex, false);
         currentUsage -= oldSize;
         m_wasTextureBudgetPressure = true;
@@ -22,12 +22,14 @@
 
 #pragma once
 
+#include <deque>
 #include <mutex>
 #include <queue>
 
 #include "../../util/thread.h"
 #include "../../util/rc/util_rc_ptr.h"
 #include "../../util/sync/sync_signal.h"
+#include "rtx_mip_demand_heap.h"
 #include "rtx_sparse_unique_cache.h"
 #include "rtx_common_object.h"
 
@@ -53,7 +55,8 @@ namespace dxvk {
 
     bool associate(uint16_t stampWithList, uint16_t stampToAdd);
     uint32_t fetchNoisyMipCounts(const uint32_t* src_gpubuf);
-    void accumulateMipCounts(uint32_t len, uint32_t curframe, bool canReset);
+    // Appends the stamps whose accumulated mip count or its frame changed to changedStamps
+    void accumulateMipCounts(uint32_t len, uint32_t curframe, bool canReset, std::vector<uint16_t>& changedStamps);
   };
 
   class RtxTextureManager : public CommonDeviceObject {
@@ -143,6 +146,10 @@ namespace dxvk {
   private:
     void scheduleTextureLoad(const Rc<ManagedTexture>& texture, bool async, bool forceUnload = false);
 
+    // Texture budget management only re-evaluates the streamed textures whose inputs changed, see garbageCollection()
+    void markStreamingStateDirty(uint16_t stamp, bool resetGrant = false);
+    void grantMips(uint16_t stamp, uint8_t mipCount);
+
   private:
     struct TextureHashFn {
       size_t operator() (const TextureRef& tex) const {
@@ -165,6 +172,30 @@ namespace dxvk {
     SamplerFeedback m_sf = {};
     bool m_wasTextureBudgetPressure = false;
 
+    // Per sampler feedback stamp state of the texture budget management
+    struct StreamingState {
+      static constexpr uint8_t kNoGrant = UINT8_MAX;
+
+      ManagedTexture* pTexture = nullptr;  // Owned by m_sf.m_idToTexture, which never releases its textures
+      uint8_t demandedMips = 0;            // Mip count asked for by the accumulated sampler feedback
+      uint8_t grantedMips = kNoGrant;      // Mip count last requested by garbageCollection()
+      bool isDirty = false;
+      bool isPendingLoad = false;
+    };
+
+    std::vector<StreamingState> m_streamingStates;
+    MipDemandHeap m_mipDemandHeap;                      // Textures streamed by sampler feedback, by priority
+    std::vector<uint16_t> m_dirtyStamps;                // Textures to re-evaluate in the next garbageCollection()
+    std::vector<uint16_t> m_updatedDemandStamps;
+    std::vector<uint16_t> m_changedFeedbackStamps;
+    std::vector<uint16_t> m_demotedStamps;              // Textures demoted to fit the budget, granted their demand once it fits again
+    std::vector<uint16_t> m_pendingLoadStamps;          // Textures whose granted mips are not resident yet
+    std::deque<std::pair<uint32_t, uint16_t>> m_samplerFeedbackExpiry;  // Frame and stamp of texture uses, in order, to detect
+    std::deque<std::pair<uint32_t, uint16_t>> m_usageExpiry;            // textures falling out of the feedback and usage windows
+    uint32_t m_trackedFramesToKeep = UINT32_MAX;
+    bool m_trackedLowMemoryGpu = false;
+    bool m_rebuildStreamingStates = false;
+
     RTX_OPTION("rtx.texturemanager", bool, showProgress, false, "Show texture loading progress in the HUD.");
 
     struct RcManagedTextureHash {
@@ -254,6 +254,9 @@ namespace dxvk {
 
   bool DrawCallState::finalizePendingFutures(const RtCamera* pLastCamera) {
     ScopedCpuProfileZone();
+    // Vertex data captured on the CPU must be complete before anything reads the geometry buffers
+    finalizeVertexCapture();
+
     // Geometry hashes are vital, and cannot be disabled, so its important we get valid data (hence the return type)
     const bool valid = finalizeGeometryHashes();
     if (valid) {
@@ -293,6 +296,11 @@ namespace dxvk {
     return true;
   }
 
+  void DrawCallState::finalizeVertexCapture() {
+    if (geometryData.futureVertexCapture.valid())
+      geometryData.futureVertexCapture.get();
+  }
+
   void DrawCallState::finalizeGeometryBoundingBox() {
     if (geometryData.futureBoundingBox.valid())
       geometryData.boundingBox = geometryData.futureBoundingBox.get();
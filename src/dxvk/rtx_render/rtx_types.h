@@ -266,6 +266,9 @@ struct RasterGeometry {
   AxisAlignedBoundingBox boundingBox;
   Future<AxisAlignedBoundingBox> futureBoundingBox;
 
+  // Pending CPU vertex capture writing into positionBuffer (and friends)
+  Future<void> futureVertexCapture;
+
   remixapi_MaterialHandle externalMaterial = nullptr;
 
   template<uint32_t rule>
@@ -679,7 +682,9 @@ private:
   friend class TerrainBaker;
   friend struct RemixAPIPrivateAccessor;
   friend class RtxParticleSystemManager;
+  friend class DrawCallTrace;
 
+  void finalizeVertexCapture();
   bool finalizeGeometryHashes();
   void finalizeGeometryBoundingBox();
   void finalizeSkinningData(const RtCamera* pLastCamera);
@@ -30,13 +30,12 @@
 #define BINDING_BLEND_INDICES_INPUT   4
 #define BINDING_NORMAL_OUTPUT         5
 #define BINDING_NORMAL_INPUT          6
+#define BINDING_BONE_PALETTE_INPUT    7
 
 /**
 * \brief Args required to perform skinning
 */
 struct SkinningArgs {
-  mat4 bones[256]; // 256 is the max bone count in DX (swvp)
-
   uint dstPositionOffset;
   uint dstPositionStride;
   uint srcPositionOffset;
@@ -56,4 +55,12 @@ struct SkinningArgs {
   uint useIndices;
   uint numBones;
   uint useOctahedralNormals;
+
+  // Offset of the draw call's palette in the bone palette buffer, shared by the skinning jobs of a frame.
+  // Added to bone indices with wrapping unsigned arithmetic, see SkinningBatch::addPalette.
+  uint bonePaletteOffset;
+  // Range of the bones in the draw call's palette, blend indices are clamped to it
+  uint minBoneIndex;
+  uint maxBoneIndex;
+  uint pad0;
 };
\ No newline at end of file
@@ -56,6 +56,10 @@ struct TerrainArgs {
   uint maxCascadeLevel;
   float lastCascadeScale;
   float displaceIn;
+  uint isToroidal;         // Cascade levels are anchored to the world and wrap around (incremental baking)
+
+  float2 cameraTexcoord;   // Camera position in the 1st cascade's texture space
+  float cascadeCoverageScale;
   uint pad0;
 };
 
@@ -56,6 +56,11 @@ uint4 get(ReadByteBuffer buf, uint index) {
 }
 #endif
 
+// Blend indices outside of the draw call's palette would read the bones packed next to it, i.e. another draw call's
+uint getBoneIndex(uint blendIndex, ConstBuffer(SkinningArgs) cb) {
+  return cb.bonePaletteOffset + min(max(blendIndex, cb.minBoneIndex), cb.maxBoneIndex);
+}
+
 void skinning(const uint32_t idx,
               WriteBuffer(float) dstPosition,
               WriteBuffer(float) dstNormal,
@@ -63,6 +68,7 @@ void skinning(const uint32_t idx,
               ReadBuffer(float) srcBlendWeight,
               ReadByteBuffer srcBlendIndices,
               ReadBuffer(float) srcNormal,
+              ReadBuffer(Matrix4) bonePalette,
               ConstBuffer(SkinningArgs) cb) {
   const uint32_t baseWeightsOffset = (cb.blendWeightOffset + idx * cb.blendWeightStride) / 4;
 
@@ -102,7 +108,7 @@ void skinning(const uint32_t idx,
       for (uint i = 0; i < 4 && i + j < cb.numBones; ++i) {
         float blendWeight = i + j == cb.numBones - 1 ? lastWeight : srcBlendWeight[baseWeightsOffset + i + j];
         if (blendWeight > 0) {
-          Matrix4 bone = toMatrix4(cb.bones[blendIndices[i]]);
+          Matrix4 bone = toMatrix4(bonePalette[getBoneIndex(blendIndices[i], cb)]);
           positionOut += mul(bone, position) * blendWeight;
           normalOut += mul(bone, normal) * blendWeight;
         }
@@ -112,14 +118,14 @@ void skinning(const uint32_t idx,
     for (uint i = 0; i < cb.numBones - 1; ++i) {
       float blendWeight = srcBlendWeight[baseWeightsOffset + i];
       if (blendWeight > 0.f) {
-        Matrix4 bone = toMatrix4(cb.bones[i]);
+        Matrix4 bone = toMatrix4(bonePalette[cb.bonePaletteOffset + i]);
         positionOut += mul(bone, position) * blendWeight;
         normalOut += mul(bone, normal) * blendWeight;
       }
     }
     // Unwrap the last bone, since blendWeights only contains numBones - 1 weights
     if (lastWeight > 0.f) {
-      Matrix4 bone = toMatrix4(cb.bones[cb.numBones - 1]);
+      Matrix4 bone = toMatrix4(bonePalette[cb.bonePaletteOffset + cb.numBones - 1]);
       positionOut += mul(bone, position) * lastWeight;
       normalOut += mul(bone, normal) * lastWeight;
     }
@@ -63,6 +63,17 @@ namespace dxvk {
   }
 
     
+  // NV-DXVK start: shader disk cache
+  SpirvCompressedBuffer::SpirvCompressedBuffer(
+          uint32_t                size,
+          std::vector<uint64_t>&& mask,
+          std::vector<uint64_t>&& code)
+  : m_size(size), m_mask(std::move(mask)), m_code(std::move(code)) {
+
+  }
+  // NV-DXVK end
+
+
   SpirvCompressedBuffer::~SpirvCompressedBuffer() {
 
   }
@@ -41,6 +41,13 @@ namespace dxvk {
 
     SpirvCompressedBuffer(
       const SpirvCodeBuffer&  code);
+
+    // NV-DXVK start: shader disk cache
+    SpirvCompressedBuffer(
+            uint32_t                size,
+            std::vector<uint64_t>&& mask,
+            std::vector<uint64_t>&& code);
+    // NV-DXVK end
     
     ~SpirvCompressedBuffer();
     
@@ -50,6 +57,16 @@ namespace dxvk {
       return m_code;
     }
 
+    // NV-DXVK start: shader disk cache
+    uint32_t getSize() const {
+      return m_size;
+    }
+
+    const std::vector<uint64_t>& getMask() const {
+      return m_mask;
+    }
+    // NV-DXVK end
+
   private:
 
     uint32_t              m_size;
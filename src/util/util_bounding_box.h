@@ -21,6 +21,10 @@
 */
 #pragma once
 
+#include <cassert>
+#include <cfloat>
+
+#include "util_fastops.h"
 #include "util_matrix.h"
 #include "util_vector.h"
 #include "xxHash/xxhash.h"
@@ -64,6 +68,35 @@ struct AxisAlignedBoundingBox {
     return XXH3_64bits(this, sizeof(AxisAlignedBoundingBox));
   }
 
+  // Bounds of the 8 transformed corners, computed from the center and the extents rather than by transforming every corner
+  AxisAlignedBoundingBox transform(const Matrix4& matrix) const {
+    if (!isValid()) {
+      return *this;
+    }
+
+    const Vector3 center = getCentroid();
+    const Vector3 extents = (maxPos - minPos) * 0.5f;
+
+    Vector3 transformedCenter = matrix[3].xyz();
+    Vector3 transformedExtents{ 0.f };
+    for (uint32_t column = 0; column < 3; column++) {
+      transformedCenter += matrix[column].xyz() * center[column];
+      transformedExtents += abs(matrix[column].xyz()) * extents[column];
+    }
+
+    return AxisAlignedBoundingBox{ transformedCenter - transformedExtents, transformedCenter + transformedExtents };
+  }
+
+  // Bounds of count float3 positions which are stride bytes apart, i.e. the positions of a vertex buffer.
+  // Vectorized, see fast::findMinMaxFloat3.
+  static AxisAlignedBoundingBox fromPositions(const void* pPositions, uint32_t count, size_t stride) {
+    AxisAlignedBoundingBox result;
+    if (count > 0) {
+      fast::findMinMaxFloat3(count, pPositions, stride, result.minPos.data, result.maxPos.data);
+    }
+    return result;
+  }
+
   float getVolume(const Matrix4& transform, float minimumThickness = 0.001f) const {
     const Vector3 minPosWorld = (transform * dxvk::Vector4(minPos, 1.0f)).xyz();
     const Vector3 maxPosWorld = (transform * dxvk::Vector4(maxPos, 1.0f)).xyz();
@@ -74,4 +107,56 @@ struct AxisAlignedBoundingBox {
     return size.x * size.y * size.z;
   }
 };
+
+// Batch of up to kSize boxes stored in SoA layout, for testing them against a set of planes at once
+// (i.e. view space frustum culling of many objects).
+struct BoundingBoxBatch {
+  static constexpr uint32_t kSize = 8;
+
+  void clear() {
+    m_count = 0;
+  }
+
+  bool empty() const {
+    return m_count == 0;
+  }
+
+  bool full() const {
+    return m_count == kSize;
+  }
+
+  uint32_t size() const {
+    return m_count;
+  }
+
+  // Returns the index of the box in the batch
+  uint32_t add(const Vector3& minPos, const Vector3& maxPos) {
+    assert(!full());
+    for (uint32_t c = 0; c < 3; c++) {
+      m_bounds[c][m_count] = minPos[c];
+      m_bounds[3 + c][m_count] = maxPos[c];
+    }
+    return m_count++;
+  }
+
+  uint32_t add(const AxisAlignedBoundingBox& box) {
+    return add(box.minPos, box.maxPos);
+  }
+
+  // Returns a mask with bit i set when box i is not entirely outside of any of the planes.
+  // Points p with dot(plane.xyz, p) + plane.w >= 0 are inside of a plane.
+  uint32_t intersectPlanes(const Vector4* pPlanes, uint32_t planeCount) const {
+    if (empty()) {
+      return 0;
+    }
+
+    const uint32_t mask = fast::boxesIntersectPlanes8(pPlanes[0].data, planeCount, m_bounds[0]);
+    return mask & ((1u << m_count) - 1);
+  }
+
+private:
+  // Min x, y, z followed by max x, y, z. Slots past m_count hold stale data, their result bits are discarded.
+  float m_bounds[6][kSize] = {};
+  uint32_t m_count = 0;
+};
 }  // namespace dxvk
@@ -20,6 +20,7 @@
 * DEALINGS IN THE SOFTWARE.
 */
 #include <smmintrin.h>
+#include <float.h>
 #include <math.h>
 #include <intrin.h>
 #include "util_math.h"
@@ -678,6 +679,204 @@ namespace fast {
   }
 
 
+  void findMinMaxFloat3_slow(const uint32_t count, const void* data, const size_t stride, float minOut[3], float maxOut[3]) {
+    const uint8_t* pData = static_cast<const uint8_t*>(data);
+
+    for (uint32_t c = 0; c < 3; c++) {
+      minOut[c] = FLT_MAX;
+      maxOut[c] = -FLT_MAX;
+    }
+
+    for (uint32_t i = 0; i < count; i++, pData += stride) {
+      const float* pPosition = reinterpret_cast<const float*>(pData);
+      for (uint32_t c = 0; c < 3; c++) {
+        minOut[c] = std::min(minOut[c], pPosition[c]);
+        maxOut[c] = std::max(maxOut[c], pPosition[c]);
+      }
+    }
+  }
+
+  // Loads x, y, z into the low lanes without reading past the end of the position, w is 0
+  __forceinline __m128 loadFloat3_SSE(const uint8_t* pData) {
+    const __m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(pData)));
+    const __m128 z = _mm_load_ss(reinterpret_cast<const float*>(pData + 8));
+    return _mm_movelh_ps(xy, z);
+  }
+
+  __forceinline void storeFloat3_SSE(const __m128& value, float out[3]) {
+    alignas(16) float values[4];
+    _mm_store_ps(values, value);
+    out[0] = values[0];
+    out[1] = values[1];
+    out[2] = values[2];
+  }
+
+  void findMinMaxFloat3_SSE(const uint32_t count, const void* data, const size_t stride, float minOut[3], float maxOut[3]) {
+    const uint8_t* pData = static_cast<const uint8_t*>(data);
+
+    // Two independent accumulator pairs to hide the latency of min/max
+    __m128 min0 = _mm_set_ps1(FLT_MAX);
+    __m128 max0 = _mm_set_ps1(-FLT_MAX);
+    __m128 min1 = min0;
+    __m128 max1 = max0;
+
+    uint32_t i = 0;
+    for (; i + 2 <= count; i += 2, pData += 2 * stride) {
+      const __m128 p0 = loadFloat3_SSE(pData);
+      const __m128 p1 = loadFloat3_SSE(pData + stride);
+      min0 = _mm_min_ps(min0, p0);
+      max0 = _mm_max_ps(max0, p0);
+      min1 = _mm_min_ps(min1, p1);
+      max1 = _mm_max_ps(max1, p1);
+    }
+
+    if (i < count) {
+      const __m128 p0 = loadFloat3_SSE(pData);
+      min0 = _mm_min_ps(min0, p0);
+      max0 = _mm_max_ps(max0, p0);
+    }
+
+    storeFloat3_SSE(_mm_min_ps(min0, min1), minOut);
+    storeFloat3_SSE(_mm_max_ps(max0, max1), maxOut);
+  }
+
+  void findMinMaxFloat3_AVX2(const uint32_t count, const void* data, const size_t stride, float minOut[3], float maxOut[3]) {
+    const uint8_t* pData = static_cast<const uint8_t*>(data);
+
+    // Each register holds two positions, one per 128-bit lane
+    __m256 min0 = _mm256_set1_ps(FLT_MAX);
+    __m256 max0 = _mm256_set1_ps(-FLT_MAX);
+    __m256 min1 = min0;
+    __m256 max1 = max0;
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4, pData += 4 * stride) {
+      const __m256 p01 = _mm256_insertf128_ps(_mm256_castps128_ps256(loadFloat3_SSE(pData)), loadFloat3_SSE(pData + stride), 1);
+      const __m256 p23 = _mm256_insertf128_ps(_mm256_castps128_ps256(loadFloat3_SSE(pData + 2 * stride)), loadFloat3_SSE(pData + 3 * stride), 1);
+      min0 = _mm256_min_ps(min0, p01);
+      max0 = _mm256_max_ps(max0, p01);
+      min1 = _mm256_min_ps(min1, p23);
+      max1 = _mm256_max_ps(max1, p23);
+    }
+
+    min0 = _mm256_min_ps(min0, min1);
+    max0 = _mm256_max_ps(max0, max1);
+    __m128 min = _mm_min_ps(_mm256_castps256_ps128(min0), _mm256_extractf128_ps(min0, 1));
+    __m128 max = _mm_max_ps(_mm256_castps256_ps128(max0), _mm256_extractf128_ps(max0, 1));
+
+    // Process the remainder (if count not aligned to 4)
+    for (; i < count; i++, pData += stride) {
+      const __m128 p = loadFloat3_SSE(pData);
+      min = _mm_min_ps(min, p);
+      max = _mm_max_ps(max, p);
+    }
+
+    storeFloat3_SSE(min, minOut);
+    storeFloat3_SSE(max, maxOut);
+  }
+
+  void findMinMaxFloat3(const uint32_t count, const void* data, const size_t stride, float minOut[3], float maxOut[3]) {
+    const bool useSSE = SSE_ENABLE && count >= 8;
+
+    if (useSSE) {
+      switch (g_simdSupportLevel) {
+      case SIMD::AVX512:
+      case SIMD::AVX2:
+        findMinMaxFloat3_AVX2(count, data, stride, minOut, maxOut);
+        break;
+      case SIMD::SSE4_1:
+      case SIMD::SSE3:
+      case SIMD::SSE2:
+        findMinMaxFloat3_SSE(count, data, stride, minOut, maxOut);
+        break;
+      default:
+        throw;
+      }
+    } else {
+      findMinMaxFloat3_slow(count, data, stride, minOut, maxOut);
+    }
+  }
+
+  // Plane distance of the box corner furthest along the plane normal, the box is outside of the plane when it's negative.
+  // Evaluated as ((nx * x + ny * y) + nz * z) + w in all variants so that they produce identical results.
+  uint32_t boxesIntersectPlanes8_slow(const float* planes, const uint32_t planeCount, const float* boxBounds) {
+    uint32_t result = 0;
+
+    for (uint32_t box = 0; box < 8; box++) {
+      bool inside = true;
+      for (uint32_t p = 0; p < planeCount && inside; p++) {
+        const float* plane = planes + p * 4;
+        float distance = 0.f;
+        for (uint32_t c = 0; c < 3; c++) {
+          const float* bounds = boxBounds + (plane[c] >= 0.f ? 3 + c : c) * 8;
+          distance += plane[c] * bounds[box];
+        }
+        inside = distance + plane[3] >= 0.f;
+      }
+      result |= inside ? (1u << box) : 0u;
+    }
+
+    return result;
+  }
+
+  uint32_t boxesIntersectPlanes8_SSE(const float* planes, const uint32_t planeCount, const float* boxBounds) {
+    const __m128 zero = _mm_setzero_ps();
+    __m128 inside0 = _mm_cmpeq_ps(zero, zero);
+    __m128 inside1 = inside0;
+
+    for (uint32_t p = 0; p < planeCount; p++) {
+      const float* plane = planes + p * 4;
+      __m128 distance0 = zero;
+      __m128 distance1 = zero;
+      for (uint32_t c = 0; c < 3; c++) {
+        const float* bounds = boxBounds + (plane[c] >= 0.f ? 3 + c : c) * 8;
+        const __m128 n = _mm_set_ps1(plane[c]);
+        distance0 = _mm_add_ps(distance0, _mm_mul_ps(n, _mm_loadu_ps(bounds)));
+        distance1 = _mm_add_ps(distance1, _mm_mul_ps(n, _mm_loadu_ps(bounds + 4)));
+      }
+      const __m128 w = _mm_set_ps1(plane[3]);
+      inside0 = _mm_and_ps(inside0, _mm_cmpge_ps(_mm_add_ps(distance0, w), zero));
+      inside1 = _mm_and_ps(inside1, _mm_cmpge_ps(_mm_add_ps(distance1, w), zero));
+    }
+
+    return _mm_movemask_ps(inside0) | (_mm_movemask_ps(inside1) << 4);
+  }
+
+  uint32_t boxesIntersectPlanes8_AVX2(const float* planes, const uint32_t planeCount, const float* boxBounds) {
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+
+    for (uint32_t p = 0; p < planeCount; p++) {
+      const float* plane = planes + p * 4;
+      __m256 distance = zero;
+      for (uint32_t c = 0; c < 3; c++) {
+        const float* bounds = boxBounds + (plane[c] >= 0.f ? 3 + c : c) * 8;
+        distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane[c]), _mm256_loadu_ps(bounds)));
+      }
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, _mm256_set1_ps(plane[3])), zero, _CMP_GE_OQ));
+    }
+
+    return _mm256_movemask_ps(inside);
+  }
+
+  uint32_t boxesIntersectPlanes8(const float* planes, const uint32_t planeCount, const float* boxBounds) {
+    if (SSE_ENABLE) {
+      switch (g_simdSupportLevel) {
+      case SIMD::AVX512:
+      case SIMD::AVX2:
+        return boxesIntersectPlanes8_AVX2(planes, planeCount, boxBounds);
+      case SIMD::SSE4_1:
+      case SIMD::SSE3:
+      case SIMD::SSE2:
+        return boxesIntersectPlanes8_SSE(planes, planeCount, boxBounds);
+      default:
+        throw;
+      }
+    }
+
+    return boxesIntersectPlanes8_slow(planes, planeCount, boxBounds);
+  }
+
   template<typename T>
   __forceinline void copySubtract_slow(T* dstData, const T* srcData, const uint32_t count, const T value, const bool ignoreSentinel, const T sentinelValue) {
     if (ignoreSentinel) {
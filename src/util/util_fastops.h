@@ -21,6 +21,7 @@
 */
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace fast {
@@ -54,6 +55,28 @@ namespace fast {
   template<typename T>
   void findMinMax(const uint32_t count, const T* data, uint32_t& minOut, uint32_t& maxOut, const bool sentinelIgnore = false, const T sentinelValue = 0);
 
+  /**
+    * \brief Finds the per component minimum and maximum of an array of strided float3 values
+    *
+    * count: number of values
+    * data: pointer to the first value, i.e. the positions of a vertex buffer
+    * stride: distance between consecutive values in bytes
+    * minOut: minimum x, y and z, FLT_MAX when count is 0
+    * maxOut: maximum x, y and z, -FLT_MAX when count is 0
+    */
+  void findMinMaxFloat3(const uint32_t count, const void* data, const size_t stride, float minOut[3], float maxOut[3]);
+
+  /**
+    * \brief Tests 8 axis aligned boxes against a set of planes
+    *
+    * planes: planeCount planes as (nx, ny, nz, w), points p with dot(n, p) + w >= 0 are inside of a plane
+    * planeCount: number of planes
+    * boxBounds: boxes in SoA layout, 6 arrays of 8 floats: min x, min y, min z, max x, max y, max z
+    *
+    * Returns a mask with bit i set when box i is not entirely outside of any of the planes.
+    */
+  uint32_t boxesIntersectPlanes8(const float* planes, const uint32_t planeCount, const float* boxBounds);
+
   /**
     * \brief Performs the following operation on an array of unsigned integers, (D[i] = S[i] - V)
     *
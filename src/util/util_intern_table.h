@@ -0,0 +1,180 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "xxHash/xxhash.h"
+
+namespace dxvk {
+  /**
+    * \brief Hash table of immutable records, keyed by a 64 bit hash.
+    *        A single thread (the owner) inserts records, while any number
+    *        of threads may look them up concurrently without taking a lock.
+    *        Records are never modified or moved once inserted, so pointers
+    *        to them stay valid until the table is cleared.
+    *
+    *        Lookups probe an open addressed slot array. The owner publishes
+    *        a slot by storing its record before its key, so a reader seeing
+    *        a key always sees the record. When the table grows, the owner
+    *        publishes a new slot array and retires the old one, which stays
+    *        readable until clear(); a reader racing the growth may miss a
+    *        record inserted in the meantime, which is reported as not found.
+    *
+    *        clear() must not run concurrently with lookups, i.e. it should be
+    *        called at a point where worker threads are known to be idle such
+    *        as the end of a frame.
+    *  T: Type of the records
+    */
+  template<typename T>
+  class InternTable {
+  public:
+    explicit InternTable(uint32_t initialCapacity = 1024) {
+      uint32_t capacity = 16;
+      while (capacity < initialCapacity) {
+        capacity *= 2;
+      }
+
+      m_initialCapacity = capacity;
+      publish(std::make_unique<Slots>(capacity));
+    }
+
+    InternTable(const InternTable&) = delete;
+    InternTable& operator=(const InternTable&) = delete;
+
+    /**
+      * \brief Looks up a record, may be called from any thread
+      * \returns The record, or null if none was inserted for the key yet
+      */
+    const T* find(XXH64_hash_t key) const {
+      key = remapKey(key);
+
+      const Slots* pSlots = m_slots.load(std::memory_order_acquire);
+      for (uint32_t i = static_cast<uint32_t>(key) & pSlots->mask;; i = (i + 1) & pSlots->mask) {
+        const XXH64_hash_t slotKey = pSlots->slots[i].key.load(std::memory_order_acquire);
+        if (slotKey == key) {
+          return pSlots->slots[i].pRecord.load(std::memory_order_relaxed);
+        }
+        if (slotKey == kEmptyKey) {
+          return nullptr;
+        }
+      }
+    }
+
+    /**
+      * \brief Looks up a record, and creates it when missing. Owner thread only.
+      * \param [in] create Returns the T to insert, only invoked on a miss
+      */
+    template<typename Create>
+    const T& findOrInsert(XXH64_hash_t key, Create&& create) {
+      if (const T* pRecord = find(key)) {
+        return *pRecord;
+      }
+
+      m_records.emplace_back(create());
+      const T* pRecord = &m_records.back();
+      m_recordKeys.push_back(key);
+
+      Slots* pSlots = m_slotStorage.back().get();
+      if ((m_records.size() + 1) * 2 > pSlots->mask + 1) {
+        // Keep the load factor at or below 1/2 so probe sequences stay short
+        auto newSlots = std::make_unique<Slots>((pSlots->mask + 1) * 2);
+        for (size_t i = 0; i < m_records.size(); i++) {
+          insertSlot(*newSlots, remapKey(m_recordKeys[i]), &m_records[i]);
+        }
+        publish(std::move(newSlots));
+      } else {
+        insertSlot(*pSlots, remapKey(key), pRecord);
+      }
+
+      return *pRecord;
+    }
+
+    /**
+      * \brief Removes all records. Must not run concurrently with lookups.
+      */
+    void clear() {
+      m_slotStorage.clear();
+      m_records.clear();
+      m_recordKeys.clear();
+      publish(std::make_unique<Slots>(m_initialCapacity));
+    }
+
+    size_t size() const {
+      return m_records.size();
+    }
+
+    uint32_t capacity() const {
+      return m_slots.load(std::memory_order_relaxed)->mask + 1;
+    }
+
+  private:
+    // Key 0 marks empty slots, a record hashed to 0 is stored under another key instead
+    static constexpr XXH64_hash_t kEmptyKey = 0;
+    static constexpr XXH64_hash_t kRemappedEmptyKey = 0x9e3779b97f4a7c15ull;
+
+    struct Slot {
+      std::atomic<XXH64_hash_t> key { kEmptyKey };
+      std::atomic<const T*> pRecord { nullptr };
+    };
+
+    struct Slots {
+      explicit Slots(uint32_t capacity)
+        : slots(new Slot[capacity]), mask(capacity - 1) {
+        assert((capacity & mask) == 0 && "Capacity must be a power of two.");
+      }
+
+      std::unique_ptr<Slot[]> slots;
+      uint32_t mask;
+    };
+
+    static XXH64_hash_t remapKey(XXH64_hash_t key) {
+      return key == kEmptyKey ? kRemappedEmptyKey : key;
+    }
+
+    static void insertSlot(Slots& slots, XXH64_hash_t key, const T* pRecord) {
+      uint32_t i = static_cast<uint32_t>(key) & slots.mask;
+      while (slots.slots[i].key.load(std::memory_order_relaxed) != kEmptyKey) {
+        i = (i + 1) & slots.mask;
+      }
+
+      slots.slots[i].pRecord.store(pRecord, std::memory_order_relaxed);
+      slots.slots[i].key.store(key, std::memory_order_release);
+    }
+
+    void publish(std::unique_ptr<Slots>&& slots) {
+      m_slots.store(slots.get(), std::memory_order_release);
+      m_slotStorage.push_back(std::move(slots));
+    }
+
+    std::atomic<const Slots*> m_slots { nullptr };
+    // The current slot array is the last one, retired ones are kept alive for readers still probing them
+    std::vector<std::unique_ptr<Slots>> m_slotStorage;
+    std::deque<T> m_records;
+    std::vector<XXH64_hash_t> m_recordKeys;
+    uint32_t m_initialCapacity;
+  };
+}
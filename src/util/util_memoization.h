@@ -1,75 +1,460 @@
-#include <map>
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "util_fast_cache.h"
+#include "xxHash/xxhash.h"
 
 namespace dxvk {
-  template<typename T>
+  /**
+   * \brief Caches results computed from byte ranges of a CPU visible buffer
+   *
+   * Used for the index data of D3D9 index buffers. Cached ranges are kept in an interval tree, so a request
+   * may be served from a larger cached range containing it. Each cached range also keeps a summary (and a hash)
+   * of its part of every 4KB page it touches: a request partially covered by cached ranges only has to summarize
+   * the pages which are not, and writes to the buffer don't drop the ranges they touch - those are re-verified
+   * against the page hashes on their next use, so data re-uploaded unchanged (i.e. after a DISCARD lock) keeps
+   * its results.
+   *
+   * Hashing and inserting a range only pays off if it is requested again before it is overwritten. Buffers written
+   * as a ring with offsets drifting from lap to lap (DISCARD only once the buffer is full) never reuse anything, so
+   * once kMaxUnusedDrops ranges in a row were dropped without ever having been used, the cached ranges are dropped
+   * and ranges are only inserted on their second request. The first hit goes back to inserting every range.
+   *
+   * Expected use, for a request [start, start + size) of the buffer data at pBuffer:
+   *   1. find() for a cached range containing the request, done if it matches exactly.
+   *   2. summarizePages() for the page summaries of the request, to compute or derive its result.
+   *   3. insert() the computed result with those summaries.
+   */
+  template<typename T, typename PageSummary>
   class MemoryRegionMemoizer {
-  private:
-    struct Range {
-      size_t start = 0;
-      size_t end = 0;
-      Range() = default;
-      Range(size_t s, size_t e) : start(s), end(e) { }
+  public:
+    static constexpr size_t kPageSize = 4096;
+
+    struct Page {
+      XXH64_hash_t hash;
+      PageSummary summary;
+    };
+
+    struct Entry {
+      size_t start;
+      size_t end;
+      T result;
+      // Parts of [start, end) in each page the range touches, in order
+      std::vector<Page> pages;
+    };
 
-      bool contains(size_t point) const {
-        return start <= point && point < end;
+    /**
+     * \brief Finds the smallest cached range containing [start, start + size)
+     *
+     * Ranges touched by a write since their last use are verified against the
+     * current buffer data first, and dropped if it changed.
+     * \returns The entry, or null if no valid cached range contains the request
+     */
+    const Entry* find(const uint8_t* pBuffer, size_t start, size_t size) {
+      if (size == 0) {
+        return nullptr;
       }
 
-      bool overlaps(const Range& other) const {
-        return (start <= other.start && other.start < end) ||
-          (start < other.end&& other.end <= end) ||
-          (other.start <= start && end <= other.end);
+      m_scratch.clear();
+      collectContaining(m_root, start, start + size, m_scratch);
+
+      std::sort(m_scratch.begin(), m_scratch.end(), [this](uint32_t a, uint32_t b) {
+        return rangeSize(a) < rangeSize(b);
+      });
+
+      for (uint32_t node : m_scratch) {
+        if (verify(pBuffer, node)) {
+          markUsed(node);
+          return &m_nodes[node].entry;
+        }
       }
-    };
 
-    template<typename U>
-    struct CacheEntry {
-      Range range = {};
-      U result;
-      CacheEntry() = default;
-      CacheEntry(Range r, U res) : range(r), result(std::move(res)) { }
-    };
+      return nullptr;
+    }
 
-    std::map<size_t, CacheEntry<T>> cache;
+    /**
+     * \brief Summarizes each page touched by [start, start + size)
+     *
+     * Full pages are taken from the valid cached ranges containing them, the
+     * others are summarized with summarize(const uint8_t* pData, size_t size).
+     */
+    template<typename Summarize>
+    void summarizePages(const uint8_t* pBuffer, size_t start, size_t size, Summarize&& summarize, std::vector<PageSummary>& pages) {
+      pages.clear();
 
-  public:
-    template<typename Func>
-    T memoize(size_t start, size_t size, Func&& func) {
-      const Range currentRange(start, start + size);
+      if (size == 0) {
+        return;
+      }
+
+      const size_t end = start + size;
+
+      // Ranges overlapping the request, in start order
+      m_scratch.clear();
+      collectOverlapping(m_root, start, end, m_scratch);
+
+      const Entry* pSource = nullptr;
+      uint32_t sourceNode = kNil;
+
+      for (size_t page = start / kPageSize; page * kPageSize < end; page++) {
+        const size_t pageStart = std::max(start, page * kPageSize);
+        const size_t pageEnd = std::min(end, (page + 1) * kPageSize);
+
+        if (pageEnd - pageStart == kPageSize) {
+          if (pSource == nullptr || pSource->end < pageEnd) {
+            pSource = nullptr;
+
+            for (uint32_t node : m_scratch) {
+              const Entry& entry = m_nodes[node].entry;
+              if (entry.start > pageStart) {
+                break;
+              }
+
+              // Note: ranges failing verification are erased, which empties their range
+              if (entry.end >= pageEnd && verify(pBuffer, node)) {
+                pSource = &entry;
+                sourceNode = node;
+                break;
+              }
+            }
+          }
+
+          if (pSource != nullptr) {
+            markUsed(sourceNode);
+            pages.push_back(pSource->pages[page - pSource->start / kPageSize].summary);
+            continue;
+          }
+        }
+
+        pages.push_back(summarize(pBuffer + pageStart, pageEnd - pageStart));
+      }
+    }
+
+    /**
+     * \brief Caches the result computed for [start, start + size)
+     *
+     * Cached ranges overlapping it are dropped, unless they contain it and are
+     * still valid (they keep serving the other requests they contain).
+     * While insertion is deferred, a range requested for the first time is not cached: the returned entry then
+     * only holds the result, until the next call.
+     * \param [in] pages Page summaries as returned by summarizePages()
+     */
+    const Entry& insert(const uint8_t* pBuffer, size_t start, size_t size, T result, const std::vector<PageSummary>& pages) {
+      const size_t end = start + size;
+
+      if (m_deferInsertion && m_dropRanges) {
+        // None of them was used, and most won't be verified again before being overwritten
+        dropRanges();
+      }
 
-      auto it = cache.find(start);
-      if (it != cache.end() && it->second.range.start == currentRange.start && it->second.range.end == currentRange.end) {
-        // Exact match found, return cached result
-        return it->second.result;
+      if (m_deferInsertion && isFirstRequest(start, end)) {
+        m_uncachedEntry.start = start;
+        m_uncachedEntry.end = end;
+        m_uncachedEntry.result = std::move(result);
+        return m_uncachedEntry;
       }
 
-      // No exact match, invalidate all overlapping ranges
-      invalidate(currentRange.start, currentRange.end);
+      m_scratch.clear();
+      collectOverlapping(m_root, start, end, m_scratch);
 
-      // If we didn't find a usable cached result, compute and store the result
-      T result = std::invoke(func, start, size);
-      cache[start] = CacheEntry<T>(currentRange, result);
-      return result;
+      for (uint32_t node : m_scratch) {
+        const Entry& entry = m_nodes[node].entry;
+        const bool contains = entry.start <= start && end <= entry.end;
+
+        if (!contains || m_nodes[node].verifiedGeneration != m_generation) {
+          eraseNode(node);
+        }
+      }
+
+      const uint32_t node = allocateNode();
+      Node& newNode = m_nodes[node];
+      newNode.entry.start = start;
+      newNode.entry.end = end;
+      newNode.entry.result = std::move(result);
+      newNode.verifiedGeneration = m_generation;
+      newNode.used = false;
+
+      newNode.entry.pages.clear();
+      for (size_t page = start / kPageSize, i = 0; page * kPageSize < end; page++, i++) {
+        const size_t pageStart = std::max(start, page * kPageSize);
+        const size_t pageEnd = std::min(end, (page + 1) * kPageSize);
+
+        newNode.entry.pages.push_back({ XXH3_64bits(pBuffer + pageStart, pageEnd - pageStart), pages[i] });
+      }
+
+      insertNode(node);
+
+      return newNode.entry;
     }
 
+    /**
+     * \brief Marks the cached ranges overlapping [start, start + size) for re-verification
+     *
+     * To be called before the range of the buffer is written.
+     */
     void invalidate(size_t start, size_t size) {
-      Range invalidRange(start, start + size);
-
-      // Find the first range overlapping range in cache
-      auto it = cache.lower_bound(start);
-      if (it != cache.begin()) --it;
-
-      // Erase overlapping ranges
-      while (it != cache.end() && it->second.range.start < invalidRange.end) {
-        if (it->second.range.overlaps(invalidRange)) {
-          it = cache.erase(it);
-        } else {
-          ++it;
-        }
+      m_scratch.clear();
+      collectOverlapping(m_root, start, start + size, m_scratch);
+
+      for (uint32_t node : m_scratch) {
+        m_nodes[node].verifiedGeneration = kUnverified;
       }
     }
 
     void invalidateAll() {
-      cache.clear();
+      m_generation++;
+    }
+
+    void clear() {
+      dropRanges();
+      m_uncachedEntry = Entry();
+      m_numUnusedDrops = 0;
+      m_deferInsertion = false;
+      m_requestedRanges.clear();
+    }
+
+    size_t size() const {
+      return m_count;
+    }
+
+    bool isInsertionDeferred() const {
+      return m_deferInsertion;
+    }
+
+  private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+    static constexpr uint32_t kUnverified = 0;
+
+    // Ranges dropped in a row without having been used before insertion is deferred
+    static constexpr uint32_t kMaxUnusedDrops = 64;
+    // Bounds the first requests remembered while insertion is deferred
+    static constexpr size_t kMaxRequestedRanges = 4096;
+
+    // Treap ordered by range start (then node index), augmented with the max range end of each subtree
+    struct Node {
+      Entry entry;
+      size_t maxEnd;
+      uint32_t left;
+      uint32_t right;
+      uint32_t priority;
+      uint32_t verifiedGeneration;
+      bool used;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_freeNodes;
+    std::vector<uint32_t> m_scratch;
+    uint32_t m_root = kNil;
+    size_t m_count = 0;
+    uint32_t m_generation = 1;
+    uint32_t m_seed = 0x9E3779B9;
+
+    Entry m_uncachedEntry;
+    uint32_t m_numUnusedDrops = 0;
+    bool m_deferInsertion = false;
+    bool m_dropRanges = false;
+    // Ranges requested once while insertion is deferred
+    fast_unordered_set m_requestedRanges;
+
+    size_t rangeSize(uint32_t node) const {
+      return m_nodes[node].entry.end - m_nodes[node].entry.start;
+    }
+
+    void markUsed(uint32_t node) {
+      m_nodes[node].used = true;
+      m_numUnusedDrops = 0;
+
+      if (m_deferInsertion) {
+        m_deferInsertion = false;
+        m_requestedRanges.clear();
+      }
+    }
+
+    void dropRanges() {
+      m_nodes.clear();
+      m_freeNodes.clear();
+      m_root = kNil;
+      m_count = 0;
+      m_dropRanges = false;
+    }
+
+    bool isFirstRequest(size_t start, size_t end) {
+      if (m_requestedRanges.size() >= kMaxRequestedRanges) {
+        m_requestedRanges.clear();
+      }
+
+      const size_t range[] = { start, end };
+      return m_requestedRanges.insert(XXH3_64bits(range, sizeof(range))).second;
+    }
+
+    bool verify(const uint8_t* pBuffer, uint32_t node) {
+      Node& n = m_nodes[node];
+      if (n.verifiedGeneration == m_generation) {
+        return true;
+      }
+
+      const Entry& entry = n.entry;
+      for (size_t page = entry.start / kPageSize, i = 0; page * kPageSize < entry.end; page++, i++) {
+        const size_t pageStart = std::max(entry.start, page * kPageSize);
+        const size_t pageEnd = std::min(entry.end, (page + 1) * kPageSize);
+
+        if (XXH3_64bits(pBuffer + pageStart, pageEnd - pageStart) != entry.pages[i].hash) {
+          eraseNode(node);
+          return false;
+        }
+      }
+
+      n.verifiedGeneration = m_generation;
+      return true;
+    }
+
+    uint32_t allocateNode() {
+      uint32_t node;
+      if (!m_freeNodes.empty()) {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+      } else {
+        node = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+      }
+
+      // xorshift32
+      m_seed ^= m_seed << 13;
+      m_seed ^= m_seed >> 17;
+      m_seed ^= m_seed << 5;
+
+      Node& n = m_nodes[node];
+      n.left = kNil;
+      n.right = kNil;
+      n.priority = m_seed;
+      return node;
+    }
+
+    bool isBefore(uint32_t a, uint32_t b) const {
+      const size_t startA = m_nodes[a].entry.start;
+      const size_t startB = m_nodes[b].entry.start;
+      return startA < startB || (startA == startB && a < b);
+    }
+
+    void update(uint32_t node) {
+      Node& n = m_nodes[node];
+      n.maxEnd = n.entry.end;
+      if (n.left != kNil) {
+        n.maxEnd = std::max(n.maxEnd, m_nodes[n.left].maxEnd);
+      }
+      if (n.right != kNil) {
+        n.maxEnd = std::max(n.maxEnd, m_nodes[n.right].maxEnd);
+      }
+    }
+
+    // Splits the tree into the nodes before key and the others
+    void split(uint32_t tree, uint32_t key, uint32_t& left, uint32_t& right) {
+      if (tree == kNil) {
+        left = right = kNil;
+      } else if (isBefore(tree, key)) {
+        split(m_nodes[tree].right, key, m_nodes[tree].right, right);
+        left = tree;
+        update(tree);
+      } else {
+        split(m_nodes[tree].left, key, left, m_nodes[tree].left);
+        right = tree;
+        update(tree);
+      }
+    }
+
+    uint32_t merge(uint32_t left, uint32_t right) {
+      if (left == kNil) {
+        return right;
+      }
+      if (right == kNil) {
+        return left;
+      }
+
+      if (m_nodes[left].priority > m_nodes[right].priority) {
+        m_nodes[left].right = merge(m_nodes[left].right, right);
+        update(left);
+        return left;
+      }
+
+      m_nodes[right].left = merge(left, m_nodes[right].left);
+      update(right);
+      return right;
+    }
+
+    void insertNode(uint32_t node) {
+      update(node);
+
+      uint32_t left, right;
+      split(m_root, node, left, right);
+      m_root = merge(merge(left, node), right);
+      m_count++;
+    }
+
+    uint32_t eraseFrom(uint32_t tree, uint32_t node) {
+      if (tree == node) {
+        return merge(m_nodes[node].left, m_nodes[node].right);
+      }
+
+      if (isBefore(node, tree)) {
+        m_nodes[tree].left = eraseFrom(m_nodes[tree].left, node);
+      } else {
+        m_nodes[tree].right = eraseFrom(m_nodes[tree].right, node);
+      }
+
+      update(tree);
+      return tree;
+    }
+
+    void eraseNode(uint32_t node) {
+      m_root = eraseFrom(m_root, node);
+      m_count--;
+
+      if (!m_nodes[node].used && ++m_numUnusedDrops >= kMaxUnusedDrops && !m_deferInsertion) {
+        m_deferInsertion = true;
+        m_dropRanges = true;
+      }
+
+      // Release the cached result now rather than when the node is reused, the page storage is kept for reuse
+      Entry& entry = m_nodes[node].entry;
+      entry.start = 0;
+      entry.end = 0;
+      entry.result = T();
+      entry.pages.clear();
+      m_freeNodes.push_back(node);
+    }
+
+    void collectContaining(uint32_t tree, size_t start, size_t end, std::vector<uint32_t>& nodes) const {
+      if (tree == kNil || m_nodes[tree].maxEnd < end) {
+        return;
+      }
+
+      const Node& n = m_nodes[tree];
+      collectContaining(n.left, start, end, nodes);
+
+      if (n.entry.start <= start) {
+        if (n.entry.end >= end) {
+          nodes.push_back(tree);
+        }
+        collectContaining(n.right, start, end, nodes);
+      }
+    }
+
+    void collectOverlapping(uint32_t tree, size_t start, size_t end, std::vector<uint32_t>& nodes) const {
+      if (tree == kNil || m_nodes[tree].maxEnd <= start) {
+        return;
+      }
+
+      const Node& n = m_nodes[tree];
+      collectOverlapping(n.left, start, end, nodes);
+
+      if (n.entry.start < end) {
+        if (n.entry.end > start) {
+          nodes.push_back(tree);
+        }
+        collectOverlapping(n.right, start, end, nodes);
+      }
     }
   };
-}
\ No newline at end of file
+}
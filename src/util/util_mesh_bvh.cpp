@@ -0,0 +1,729 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "util_mesh_bvh.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace dxvk {
+
+  namespace {
+    constexpr uint32_t kNumSahBins = 16;
+    constexpr uint32_t kMaxTraversalDepth = 64;
+    // Leaves are only forced to split above this size when SAH finds no better split
+    constexpr uint32_t kMaxSahLeafTriangles = 16;
+    constexpr float kTriangleEpsilon = 1e-12f;
+
+    struct BuildBounds {
+      Vector3 min = Vector3(FLT_MAX);
+      Vector3 max = Vector3(-FLT_MAX);
+
+      void extend(const Vector3& p) {
+        min = Vector3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+        max = Vector3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+      }
+
+      void extend(const BuildBounds& b) {
+        extend(b.min);
+        extend(b.max);
+      }
+
+      float surfaceArea() const {
+        if (min.x > max.x) {
+          return 0.f;
+        }
+        const Vector3 e = max - min;
+        return 2.f * (e.x * e.y + e.y * e.z + e.z * e.x);
+      }
+    };
+
+    struct BuildTriangle {
+      BuildBounds bounds;
+      Vector3 centroid;
+    };
+
+    // Inverse direction that stays finite so that 0 * inverse doesn't produce NaNs in slab tests
+    float safeInverse(float d) {
+      constexpr float kMinDirection = 1e-20f;
+      return std::abs(d) > kMinDirection ? 1.f / d : std::copysign(1e20f, d);
+    }
+
+    // Returns the entry distance into a box, or FLT_MAX on a miss
+    float intersectBox(const Vector3& origin, const Vector3& invDirection, const Vector3& boundsMin, const Vector3& boundsMax, float tMax) {
+      const float tx1 = (boundsMin.x - origin.x) * invDirection.x, tx2 = (boundsMax.x - origin.x) * invDirection.x;
+      const float ty1 = (boundsMin.y - origin.y) * invDirection.y, ty2 = (boundsMax.y - origin.y) * invDirection.y;
+      const float tz1 = (boundsMin.z - origin.z) * invDirection.z, tz2 = (boundsMax.z - origin.z) * invDirection.z;
+
+      const float tNear = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::max(std::min(tz1, tz2), 0.f));
+      const float tFar = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::min(std::max(tz1, tz2), tMax));
+
+      return tNear <= tFar ? tNear : FLT_MAX;
+    }
+
+    float distanceSqrToBox(const Vector3& p, const Vector3& boundsMin, const Vector3& boundsMax) {
+      const float dx = std::max(std::max(boundsMin.x - p.x, p.x - boundsMax.x), 0.f);
+      const float dy = std::max(std::max(boundsMin.y - p.y, p.y - boundsMax.y), 0.f);
+      const float dz = std::max(std::max(boundsMin.z - p.z, p.z - boundsMax.z), 0.f);
+      return dx * dx + dy * dy + dz * dz;
+    }
+
+    // Closest point on a triangle, Real-Time Collision Detection 5.1.5
+    Vector3 closestPointOnTriangle(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c) {
+      const Vector3 ab = b - a;
+      const Vector3 ac = c - a;
+      const Vector3 ap = p - a;
+
+      const float d1 = dot(ab, ap);
+      const float d2 = dot(ac, ap);
+      if (d1 <= 0.f && d2 <= 0.f) {
+        return a;
+      }
+
+      const Vector3 bp = p - b;
+      const float d3 = dot(ab, bp);
+      const float d4 = dot(ac, bp);
+      if (d3 >= 0.f && d4 <= d3) {
+        return b;
+      }
+
+      const float vc = d1 * d4 - d3 * d2;
+      if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) {
+        return a + ab * (d1 / (d1 - d3));
+      }
+
+      const Vector3 cp = p - c;
+      const float d5 = dot(ab, cp);
+      const float d6 = dot(ac, cp);
+      if (d6 >= 0.f && d5 <= d6) {
+        return c;
+      }
+
+      const float vb = d5 * d2 - d1 * d6;
+      if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) {
+        return a + ac * (d2 / (d2 - d6));
+      }
+
+      const float va = d3 * d6 - d5 * d4;
+      if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+      }
+
+      const float denom = 1.f / (va + vb + vc);
+      return a + ab * (vb * denom) + ac * (vc * denom);
+    }
+  }
+
+  void MeshBvh::build(const Vector3* pPositions, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount) {
+    m_nodes.clear();
+    m_triangles.clear();
+
+    const uint32_t numInputTriangles = (pIndices != nullptr ? indexCount : vertexCount) / 3;
+
+    std::vector<Triangle> triangles;
+    std::vector<BuildTriangle> buildTriangles;
+    triangles.reserve(numInputTriangles);
+    buildTriangles.reserve(numInputTriangles);
+
+    for (uint32_t i = 0; i < numInputTriangles; i++) {
+      uint32_t idx[3] = { 3 * i, 3 * i + 1, 3 * i + 2 };
+
+      if (pIndices != nullptr) {
+        idx[0] = pIndices[idx[0]];
+        idx[1] = pIndices[idx[1]];
+        idx[2] = pIndices[idx[2]];
+      }
+
+      if (idx[0] >= vertexCount || idx[1] >= vertexCount || idx[2] >= vertexCount) {
+        continue;
+      }
+
+      const Vector3& a = pPositions[idx[0]];
+      const Vector3& b = pPositions[idx[1]];
+      const Vector3& c = pPositions[idx[2]];
+
+      // Skip triangles with corrupt positions, they would poison the bounds of every node above them
+      if (!std::isfinite(a.x + a.y + a.z + b.x + b.y + b.z + c.x + c.y + c.z)) {
+        continue;
+      }
+
+      Triangle& triangle = triangles.emplace_back();
+      triangle.v0 = a;
+      triangle.edge1 = b - a;
+      triangle.edge2 = c - a;
+      triangle.id = i;
+
+      BuildTriangle& buildTriangle = buildTriangles.emplace_back();
+      buildTriangle.bounds.extend(a);
+      buildTriangle.bounds.extend(b);
+      buildTriangle.bounds.extend(c);
+      buildTriangle.centroid = (a + b + c) * (1.f / 3.f);
+    }
+
+    if (triangles.empty()) {
+      return;
+    }
+
+    const uint32_t numTriangles = static_cast<uint32_t>(triangles.size());
+
+    std::vector<uint32_t> order(numTriangles);
+    for (uint32_t i = 0; i < numTriangles; i++) {
+      order[i] = i;
+    }
+
+    m_nodes.reserve(2 * numTriangles);
+    m_nodes.emplace_back();
+    m_nodes[0].leftOrFirst = 0;
+    m_nodes[0].triangleCount = numTriangles;
+
+    struct BuildTask {
+      uint32_t node;
+      uint32_t depth;
+    };
+
+    std::vector<BuildTask> tasks;
+    tasks.push_back({ 0, 0 });
+
+    while (!tasks.empty()) {
+      const BuildTask task = tasks.back();
+      tasks.pop_back();
+
+      const uint32_t first = m_nodes[task.node].leftOrFirst;
+      const uint32_t count = m_nodes[task.node].triangleCount;
+
+      BuildBounds nodeBounds;
+      BuildBounds centroidBounds;
+      for (uint32_t i = first; i < first + count; i++) {
+        nodeBounds.extend(buildTriangles[order[i]].bounds);
+        centroidBounds.extend(buildTriangles[order[i]].centroid);
+      }
+
+      m_nodes[task.node].boundsMin = nodeBounds.min;
+      m_nodes[task.node].boundsMax = nodeBounds.max;
+
+      if (count <= kMaxLeafTriangles || task.depth + 1 >= kMaxTraversalDepth) {
+        continue;
+      }
+
+      // Find the cheapest split among binned centroid positions of all axes
+      float bestCost = FLT_MAX;
+      uint32_t bestAxis = 0;
+      uint32_t bestSplit = 0;
+
+      for (uint32_t axis = 0; axis < 3; axis++) {
+        const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        if (extent <= 0.f) {
+          continue;
+        }
+
+        const float binScale = kNumSahBins / extent;
+
+        std::array<BuildBounds, kNumSahBins> binBounds;
+        std::array<uint32_t, kNumSahBins> binCounts {};
+
+        for (uint32_t i = first; i < first + count; i++) {
+          const BuildTriangle& t = buildTriangles[order[i]];
+          const uint32_t bin = std::min(kNumSahBins - 1, static_cast<uint32_t>((t.centroid[axis] - centroidBounds.min[axis]) * binScale));
+          binBounds[bin].extend(t.bounds);
+          binCounts[bin]++;
+        }
+
+        // Sweep from the right to get the cost of the right side of every split
+        std::array<float, kNumSahBins> rightCosts;
+        BuildBounds rightBounds;
+        uint32_t rightCount = 0;
+        for (uint32_t bin = kNumSahBins - 1; bin > 0; bin--) {
+          rightBounds.extend(binBounds[bin]);
+          rightCount += binCounts[bin];
+          rightCosts[bin] = rightCount * rightBounds.surfaceArea();
+        }
+
+        BuildBounds leftBounds;
+        uint32_t leftCount = 0;
+        for (uint32_t split = 1; split < kNumSahBins; split++) {
+          leftBounds.extend(binBounds[split - 1]);
+          leftCount += binCounts[split - 1];
+
+          if (leftCount == 0 || leftCount == count) {
+            continue;
+          }
+
+          const float cost = leftCount * leftBounds.surfaceArea() + rightCosts[split];
+          if (cost < bestCost) {
+            bestCost = cost;
+            bestAxis = axis;
+            bestSplit = split;
+          }
+        }
+      }
+
+      // All centroids coincide, nothing to split
+      if (bestSplit == 0) {
+        continue;
+      }
+
+      const float leafCost = count * nodeBounds.surfaceArea();
+      if (bestCost >= leafCost && count <= kMaxSahLeafTriangles) {
+        continue;
+      }
+
+      const float binScale = kNumSahBins / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+      auto isLeft = [&](uint32_t triangle) {
+        const float centroid = buildTriangles[triangle].centroid[bestAxis];
+        return std::min(kNumSahBins - 1, static_cast<uint32_t>((centroid - centroidBounds.min[bestAxis]) * binScale)) < bestSplit;
+      };
+
+      const uint32_t mid = static_cast<uint32_t>(std::partition(order.begin() + first, order.begin() + first + count, isLeft) - order.begin());
+
+      const uint32_t leftChild = static_cast<uint32_t>(m_nodes.size());
+      m_nodes.emplace_back();
+      m_nodes.emplace_back();
+
+      m_nodes[leftChild].leftOrFirst = first;
+      m_nodes[leftChild].triangleCount = mid - first;
+      m_nodes[leftChild + 1].leftOrFirst = mid;
+      m_nodes[leftChild + 1].triangleCount = first + count - mid;
+
+      m_nodes[task.node].leftOrFirst = leftChild;
+      m_nodes[task.node].triangleCount = 0;
+
+      tasks.push_back({ leftChild, task.depth + 1 });
+      tasks.push_back({ leftChild + 1, task.depth + 1 });
+    }
+
+    // Store triangles in leaf order
+    m_triangles.resize(numTriangles);
+    for (uint32_t i = 0; i < numTriangles; i++) {
+      m_triangles[i] = triangles[order[i]];
+    }
+
+    m_nodes.shrink_to_fit();
+  }
+
+  AxisAlignedBoundingBox MeshBvh::getBoundingBox() const {
+    AxisAlignedBoundingBox aabb;
+
+    if (!m_nodes.empty()) {
+      aabb.minPos = m_nodes[0].boundsMin;
+      aabb.maxPos = m_nodes[0].boundsMax;
+    }
+
+    return aabb;
+  }
+
+  bool MeshBvh::intersect(const Vector3& origin, const Vector3& direction, float tMax, RayHit& hit) const {
+    hit = RayHit();
+    hit.t = tMax;
+
+    if (m_nodes.empty()) {
+      return false;
+    }
+
+    const Vector3 invDirection(safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z));
+
+    if (intersectBox(origin, invDirection, m_nodes[0].boundsMin, m_nodes[0].boundsMax, hit.t) == FLT_MAX) {
+      return false;
+    }
+
+    uint32_t stack[kMaxTraversalDepth];
+    uint32_t stackSize = 0;
+    uint32_t nodeIndex = 0;
+
+    while (true) {
+      const Node& node = m_nodes[nodeIndex];
+
+      if (node.isLeaf()) {
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.triangleCount; i++) {
+          const Triangle& triangle = m_triangles[i];
+
+          // Moller-Trumbore, two-sided
+          const Vector3 p = cross(direction, triangle.edge2);
+          const float det = dot(triangle.edge1, p);
+          if (std::abs(det) < kTriangleEpsilon) {
+            continue;
+          }
+
+          const float invDet = 1.f / det;
+          const Vector3 s = origin - triangle.v0;
+          const float u = dot(s, p) * invDet;
+          if (u < 0.f || u > 1.f) {
+            continue;
+          }
+
+          const Vector3 q = cross(s, triangle.edge1);
+          const float v = dot(direction, q) * invDet;
+          if (v < 0.f || u + v > 1.f) {
+            continue;
+          }
+
+          const float t = dot(triangle.edge2, q) * invDet;
+          if (t > 0.f && t < hit.t) {
+            hit.t = t;
+            hit.u = u;
+            hit.v = v;
+            hit.triangle = triangle.id;
+          }
+        }
+      } else {
+        // Visit the nearer child first, the other one is culled later if a closer hit has been found by then
+        uint32_t near = node.leftOrFirst;
+        uint32_t far = node.leftOrFirst + 1;
+        float tNear = intersectBox(origin, invDirection, m_nodes[near].boundsMin, m_nodes[near].boundsMax, hit.t);
+        float tFar = intersectBox(origin, invDirection, m_nodes[far].boundsMin, m_nodes[far].boundsMax, hit.t);
+
+        if (tFar < tNear) {
+          std::swap(near, far);
+          std::swap(tNear, tFar);
+        }
+
+        if (tNear != FLT_MAX) {
+          if (tFar != FLT_MAX) {
+            stack[stackSize++] = far;
+          }
+          nodeIndex = near;
+          continue;
+        }
+      }
+
+      // Pop the next node that can still contain a closer hit
+      bool found = false;
+      while (stackSize > 0) {
+        nodeIndex = stack[--stackSize];
+        if (intersectBox(origin, invDirection, m_nodes[nodeIndex].boundsMin, m_nodes[nodeIndex].boundsMax, hit.t) != FLT_MAX) {
+          found = true;
+          break;
+        }
+      }
+
+      if (!found) {
+        break;
+      }
+    }
+
+    if (!hit.isHit()) {
+      hit.t = FLT_MAX;
+    }
+
+    return hit.isHit();
+  }
+
+  void MeshBvh::intersect(uint32_t rayCount, const Vector3* pOrigins, const Vector3* pDirections, float tMax, RayHit* pHits) const {
+    for (uint32_t i = 0; i < rayCount; i += kPacketSize) {
+      intersectPacket(pOrigins + i, pDirections + i, std::min(kPacketSize, rayCount - i), tMax, pHits + i);
+    }
+  }
+
+  void MeshBvh::intersectPacket(const Vector3* pOrigins, const Vector3* pDirections, uint32_t count, float tMax, RayHit* pHits) const {
+    // SoA packet, unused lanes get a negative tMax so that they never intersect anything
+    alignas(16) float ox[kPacketSize], oy[kPacketSize], oz[kPacketSize];
+    alignas(16) float dx[kPacketSize], dy[kPacketSize], dz[kPacketSize];
+    alignas(16) float ix[kPacketSize], iy[kPacketSize], iz[kPacketSize];
+    alignas(16) float laneTMax[kPacketSize];
+
+    for (uint32_t lane = 0; lane < kPacketSize; lane++) {
+      const uint32_t src = std::min(lane, count - 1);
+      ox[lane] = pOrigins[src].x;
+      oy[lane] = pOrigins[src].y;
+      oz[lane] = pOrigins[src].z;
+      dx[lane] = pDirections[src].x;
+      dy[lane] = pDirections[src].y;
+      dz[lane] = pDirections[src].z;
+      ix[lane] = safeInverse(dx[lane]);
+      iy[lane] = safeInverse(dy[lane]);
+      iz[lane] = safeInverse(dz[lane]);
+      laneTMax[lane] = lane < count ? tMax : -1.f;
+    }
+
+    const __m128 originX = _mm_load_ps(ox), originY = _mm_load_ps(oy), originZ = _mm_load_ps(oz);
+    const __m128 dirX = _mm_load_ps(dx), dirY = _mm_load_ps(dy), dirZ = _mm_load_ps(dz);
+    const __m128 invX = _mm_load_ps(ix), invY = _mm_load_ps(iy), invZ = _mm_load_ps(iz);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 epsilon = _mm_set1_ps(kTriangleEpsilon);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    __m128 hitT = _mm_load_ps(laneTMax);
+    __m128 hitU = zero;
+    __m128 hitV = zero;
+    __m128i hitId = _mm_set1_epi32(static_cast<int32_t>(kInvalidTriangle));
+
+    // Returns the lane entry distances, lanes missing the box get +inf
+    auto intersectBox4 = [&](const Node& node) {
+      const __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.x), originX), invX);
+      const __m128 tx2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.x), originX), invX);
+      const __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.y), originY), invY);
+      const __m128 ty2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.y), originY), invY);
+      const __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.z), originZ), invZ);
+      const __m128 tz2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.z), originZ), invZ);
+
+      const __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx1, tx2), _mm_min_ps(ty1, ty2)), _mm_max_ps(_mm_min_ps(tz1, tz2), zero));
+      const __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx1, tx2), _mm_max_ps(ty1, ty2)), _mm_min_ps(_mm_max_ps(tz1, tz2), hitT));
+
+      const __m128 isHit = _mm_cmple_ps(tNear, tFar);
+      return _mm_or_ps(_mm_and_ps(isHit, tNear), _mm_andnot_ps(isHit, _mm_set1_ps(INFINITY)));
+    };
+
+    auto minLane = [](__m128 v) {
+      v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+      v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+      return _mm_cvtss_f32(v);
+    };
+
+    uint32_t stack[kMaxTraversalDepth];
+    uint32_t stackSize = 0;
+
+    if (!m_nodes.empty() && minLane(intersectBox4(m_nodes[0])) != INFINITY) {
+      stack[stackSize++] = 0;
+    }
+
+    while (stackSize > 0) {
+      const Node& node = m_nodes[stack[--stackSize]];
+
+      if (node.isLeaf()) {
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.triangleCount; i++) {
+          const Triangle& triangle = m_triangles[i];
+
+          const __m128 e1x = _mm_set1_ps(triangle.edge1.x), e1y = _mm_set1_ps(triangle.edge1.y), e1z = _mm_set1_ps(triangle.edge1.z);
+          const __m128 e2x = _mm_set1_ps(triangle.edge2.x), e2y = _mm_set1_ps(triangle.edge2.y), e2z = _mm_set1_ps(triangle.edge2.z);
+
+          // p = cross(direction, edge2)
+          const __m128 px = _mm_sub_ps(_mm_mul_ps(dirY, e2z), _mm_mul_ps(dirZ, e2y));
+          const __m128 py = _mm_sub_ps(_mm_mul_ps(dirZ, e2x), _mm_mul_ps(dirX, e2z));
+          const __m128 pz = _mm_sub_ps(_mm_mul_ps(dirX, e2y), _mm_mul_ps(dirY, e2x));
+
+          const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+          const __m128 invDet = _mm_div_ps(one, det);
+
+          // s = origin - v0
+          const __m128 sx = _mm_sub_ps(originX, _mm_set1_ps(triangle.v0.x));
+          const __m128 sy = _mm_sub_ps(originY, _mm_set1_ps(triangle.v0.y));
+          const __m128 sz = _mm_sub_ps(originZ, _mm_set1_ps(triangle.v0.z));
+
+          const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+
+          // q = cross(s, edge1)
+          const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+          const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+          const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+          const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dirX, qx), _mm_mul_ps(dirY, qy)), _mm_mul_ps(dirZ, qz)), invDet);
+          const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+          __m128 accept = _mm_cmpge_ps(_mm_and_ps(det, absMask), epsilon);
+          accept = _mm_and_ps(accept, _mm_cmpge_ps(u, zero));
+          accept = _mm_and_ps(accept, _mm_cmpge_ps(v, zero));
+          accept = _mm_and_ps(accept, _mm_cmple_ps(_mm_add_ps(u, v), one));
+          accept = _mm_and_ps(accept, _mm_cmpgt_ps(t, zero));
+          accept = _mm_and_ps(accept, _mm_cmplt_ps(t, hitT));
+
+          if (_mm_movemask_ps(accept) == 0) {
+            continue;
+          }
+
+          hitT = _mm_or_ps(_mm_and_ps(accept, t), _mm_andnot_ps(accept, hitT));
+          hitU = _mm_or_ps(_mm_and_ps(accept, u), _mm_andnot_ps(accept, hitU));
+          hitV = _mm_or_ps(_mm_and_ps(accept, v), _mm_andnot_ps(accept, hitV));
+
+          const __m128i acceptId = _mm_castps_si128(accept);
+          hitId = _mm_or_si128(_mm_and_si128(acceptId, _mm_set1_epi32(static_cast<int32_t>(triangle.id))), _mm_andnot_si128(acceptId, hitId));
+        }
+      } else {
+        const uint32_t left = node.leftOrFirst;
+        const uint32_t right = node.leftOrFirst + 1;
+
+        const __m128 tLeft = intersectBox4(m_nodes[left]);
+        const __m128 tRight = intersectBox4(m_nodes[right]);
+
+        const float nearestLeft = minLane(tLeft);
+        const float nearestRight = minLane(tRight);
+
+        // Push the farther child first so that the nearer one is traversed next
+        if (nearestLeft < nearestRight) {
+          if (nearestRight != INFINITY) {
+            stack[stackSize++] = right;
+          }
+          stack[stackSize++] = left;
+        } else {
+          if (nearestLeft != INFINITY) {
+            stack[stackSize++] = left;
+          }
+          if (nearestRight != INFINITY) {
+            stack[stackSize++] = right;
+          }
+        }
+      }
+    }
+
+    alignas(16) float outT[kPacketSize], outU[kPacketSize], outV[kPacketSize];
+    alignas(16) uint32_t outId[kPacketSize];
+    _mm_store_ps(outT, hitT);
+    _mm_store_ps(outU, hitU);
+    _mm_store_ps(outV, hitV);
+    _mm_store_si128(reinterpret_cast<__m128i*>(outId), hitId);
+
+    for (uint32_t lane = 0; lane < count; lane++) {
+      RayHit& hit = pHits[lane];
+      hit.triangle = outId[lane];
+      hit.t = hit.isHit() ? outT[lane] : FLT_MAX;
+      hit.u = outU[lane];
+      hit.v = outV[lane];
+    }
+  }
+
+  bool MeshBvh::findClosestPoint(const Vector3& point, float maxDistance, ClosestPoint& result) const {
+    result = ClosestPoint();
+
+    if (m_nodes.empty()) {
+      return false;
+    }
+
+    float bestDistanceSqr = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+
+    uint32_t stack[kMaxTraversalDepth];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+      const Node& node = m_nodes[stack[--stackSize]];
+
+      if (distanceSqrToBox(point, node.boundsMin, node.boundsMax) >= bestDistanceSqr) {
+        continue;
+      }
+
+      if (node.isLeaf()) {
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.triangleCount; i++) {
+          const Triangle& triangle = m_triangles[i];
+          const Vector3 closest = closestPointOnTriangle(point, triangle.v0, triangle.v0 + triangle.edge1, triangle.v0 + triangle.edge2);
+          const float distanceSqr = lengthSqr(closest - point);
+
+          if (distanceSqr < bestDistanceSqr) {
+            bestDistanceSqr = distanceSqr;
+            result.position = closest;
+            result.triangle = triangle.id;
+          }
+        }
+      } else {
+        const uint32_t left = node.leftOrFirst;
+        const uint32_t right = node.leftOrFirst + 1;
+        const float dLeft = distanceSqrToBox(point, m_nodes[left].boundsMin, m_nodes[left].boundsMax);
+        const float dRight = distanceSqrToBox(point, m_nodes[right].boundsMin, m_nodes[right].boundsMax);
+
+        // Nearer child on top of the stack
+        if (dLeft < dRight) {
+          stack[stackSize++] = right;
+          stack[stackSize++] = left;
+        } else {
+          stack[stackSize++] = left;
+          stack[stackSize++] = right;
+        }
+      }
+    }
+
+    if (result.triangle == kInvalidTriangle) {
+      return false;
+    }
+
+    result.distance = std::sqrt(bestDistanceSqr);
+    return true;
+  }
+
+  uint32_t MeshBvh::countCrossings(const Vector3& origin, const Vector3& direction) const {
+    const Vector3 invDirection(safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z));
+
+    uint32_t crossings = 0;
+    uint32_t stack[kMaxTraversalDepth];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+      const Node& node = m_nodes[stack[--stackSize]];
+
+      if (intersectBox(origin, invDirection, node.boundsMin, node.boundsMax, FLT_MAX) == FLT_MAX) {
+        continue;
+      }
+
+      if (!node.isLeaf()) {
+        stack[stackSize++] = node.leftOrFirst;
+        stack[stackSize++] = node.leftOrFirst + 1;
+        continue;
+      }
+
+      for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.triangleCount; i++) {
+        const Triangle& triangle = m_triangles[i];
+
+        const Vector3 p = cross(direction, triangle.edge2);
+        const float det = dot(triangle.edge1, p);
+        if (std::abs(det) < kTriangleEpsilon) {
+          continue;
+        }
+
+        const float invDet = 1.f / det;
+        const Vector3 s = origin - triangle.v0;
+        const float u = dot(s, p) * invDet;
+        const Vector3 q = cross(s, triangle.edge1);
+        const float v = dot(direction, q) * invDet;
+
+        if (u >= 0.f && v >= 0.f && u + v <= 1.f && dot(triangle.edge2, q) * invDet > 0.f) {
+          crossings++;
+        }
+      }
+    }
+
+    return crossings;
+  }
+
+  bool MeshBvh::isInside(const Vector3& point) const {
+    if (m_nodes.empty()) {
+      return false;
+    }
+
+    // Quick reject, points outside of the bounds can't be enclosed
+    if (distanceSqrToBox(point, m_nodes[0].boundsMin, m_nodes[0].boundsMax) > 0.f) {
+      return false;
+    }
+
+    // Directions are skewed off the axes so that they are unlikely to graze axis aligned edges
+    static const Vector3 kDirections[3] = {
+      Vector3(0.8017f, 0.5345f, 0.2673f),
+      Vector3(-0.3714f, 0.7428f, -0.5571f),
+      Vector3(0.2182f, -0.4364f, -0.8729f)
+    };
+
+    uint32_t insideVotes = 0;
+    for (const Vector3& direction : kDirections) {
+      insideVotes += countCrossings(point, direction) & 1;
+    }
+
+    return insideVotes >= 2;
+  }
+
+  float MeshBvh::calculateSignedDistance(const Vector3& point) const {
+    ClosestPoint closest;
+    if (!findClosestPoint(point, FLT_MAX, closest)) {
+      return FLT_MAX;
+    }
+
+    return isInside(point) ? -closest.distance : closest.distance;
+  }
+
+}
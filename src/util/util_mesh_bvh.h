@@ -0,0 +1,121 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include "util_bounding_box.h"
+#include "util_vector.h"
+
+namespace dxvk {
+
+  // Bounding volume hierarchy over a triangle mesh for ray and closest point queries on the CPU.
+  // Built with a binned SAH, triangles are stored in leaf order so that leaves are contiguous in memory.
+  // Triangles are two-sided, all queries are in the space of the positions the hierarchy was built from.
+  class MeshBvh {
+  public:
+    static constexpr uint32_t kPacketSize = 4;
+    static constexpr uint32_t kMaxLeafTriangles = 4;
+    static constexpr uint32_t kInvalidTriangle = UINT32_MAX;
+
+    struct RayHit {
+      float t = FLT_MAX;
+      uint32_t triangle = kInvalidTriangle;  // Index of the triangle in the input index list, i.e. first index / 3
+      float u = 0.f;                         // Barycentric weight of the triangle's 2nd vertex
+      float v = 0.f;                         // Barycentric weight of the triangle's 3rd vertex
+
+      bool isHit() const {
+        return triangle != kInvalidTriangle;
+      }
+    };
+
+    struct ClosestPoint {
+      Vector3 position;
+      float distance = FLT_MAX;
+      uint32_t triangle = kInvalidTriangle;
+    };
+
+    // Builds the hierarchy over a triangle list, pIndices can be null for non-indexed triangle lists
+    void build(const Vector3* pPositions, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount);
+
+    bool empty() const {
+      return m_nodes.empty();
+    }
+
+    uint32_t getTriangleCount() const {
+      return static_cast<uint32_t>(m_triangles.size());
+    }
+
+    uint32_t getNodeCount() const {
+      return static_cast<uint32_t>(m_nodes.size());
+    }
+
+    AxisAlignedBoundingBox getBoundingBox() const;
+
+    // Finds the closest hit within (0, tMax). Direction does not need to be normalized, t is in units of its length.
+    bool intersect(const Vector3& origin, const Vector3& direction, float tMax, RayHit& hit) const;
+
+    // Finds the closest hits of a batch of rays, traversing the hierarchy with packets of kPacketSize rays.
+    // Rays sharing a packet should be coherent (i.e. similar origin and direction) for best performance.
+    void intersect(uint32_t rayCount, const Vector3* pOrigins, const Vector3* pDirections, float tMax, RayHit* pHits) const;
+
+    // Finds the closest point on the mesh's surface within maxDistance
+    bool findClosestPoint(const Vector3& point, float maxDistance, ClosestPoint& result) const;
+
+    // Tests whether a point is enclosed by the mesh. Only meaningful for closed meshes, uses a majority vote
+    // of crossing parities along several rays to be robust against rays grazing edges and small holes.
+    bool isInside(const Vector3& point) const;
+
+    // Distance to the closest point on the surface, negative when the point is inside of the mesh.
+    // Returns FLT_MAX for an empty hierarchy.
+    float calculateSignedDistance(const Vector3& point) const;
+
+  private:
+    struct Node {
+      Vector3 boundsMin;
+      uint32_t leftOrFirst;    // Index of the left child (right child follows it) or of the first triangle for leaves
+      Vector3 boundsMax;
+      uint32_t triangleCount;  // 0 for interior nodes
+
+      bool isLeaf() const {
+        return triangleCount > 0;
+      }
+    };
+
+    struct Triangle {
+      Vector3 v0;
+      Vector3 edge1;
+      Vector3 edge2;
+      uint32_t id;
+    };
+
+    void intersectPacket(const Vector3* pOrigins, const Vector3* pDirections, uint32_t count, float tMax, RayHit* pHits) const;
+
+    uint32_t countCrossings(const Vector3& origin, const Vector3& direction) const;
+
+    std::vector<Node> m_nodes;
+    std::vector<Triangle> m_triangles;
+  };
+
+}
@@ -0,0 +1,262 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#include "thread.h"
+#include "util_math.h"
+
+namespace dxvk {
+  /**
+    * \brief Bounded multi-producer single-consumer queue with a blocking pop.
+    *        Implemented as a ring buffer: producers claim slots with a CAS
+    *        on the push position and publish them through a per-slot sequence
+    *        number, so pushing never takes a lock. The consumer parks on a
+    *        condition variable when the queue runs empty, and producers only
+    *        take the lock to wake it if it is actually parked.
+    *
+    *        Backpressure: a producer finding the queue full yields for a
+    *        bounded number of retries, then parks until the consumer pops.
+    *        Parked producers re-check the queue at least every ParkTimeout,
+    *        which bounds the delay of a wake up the consumer misses, since
+    *        the consumer does not fence its check for parked producers.
+    *        tryPush() never waits.
+    *  T: Type of the object, must be default constructible and movable.
+    *  Capacity: Number of elements in the ring buffer, must be a power of two.
+    */
+  template <typename T, uint32_t Capacity>
+  class MpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+    MpscQueue() {
+      for (uint32_t i = 0; i < Capacity; i++) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator = (const MpscQueue&) = delete;
+
+    /**
+      * \brief Pushes an item, may be called from any thread.
+      *        Waits while the queue is full, see the class description.
+      * \returns Position of the item, i.e. the number of items pushed before it.
+      *          Positions reflect the order in which items are popped.
+      */
+    uint64_t push(T&& item) {
+      uint64_t position;
+      uint32_t numFullRetries = 0;
+
+      while (!tryClaim(position)) {
+        // Full, the slot still holds an item from the previous lap
+        if (numFullRetries++ < SpinCount) {
+          dxvk::this_thread::yield();
+        } else {
+          waitForPop(position);
+        }
+      }
+
+      publish(position, std::move(item));
+      return position;
+    }
+
+    /**
+      * \brief Pushes an item if the queue is not full, may be called from any thread.
+      * \param [out] position Position of the item, as returned by push()
+      * \returns false if the queue was full, the item is left untouched then
+      */
+    bool tryPush(T&& item, uint64_t& position) {
+      if (!tryClaim(position)) {
+        return false;
+      }
+
+      publish(position, std::move(item));
+      return true;
+    }
+
+    /**
+      * \brief Pops an item without blocking, consumer thread only.
+      * \returns true if an item was popped
+      */
+    bool tryPop(T& item) {
+      Slot& slot = m_slots[m_popPosition & (Capacity - 1)];
+      if (slot.sequence.load(std::memory_order_acquire) != m_popPosition + 1) {
+        return false;
+      }
+
+      item = std::move(slot.item);
+      slot.sequence.store(m_popPosition + Capacity, std::memory_order_release);
+      m_popPosition++;
+
+      // Unfenced, a parked producer that is missed re-checks after ParkTimeout
+      if (m_producersParked.load(std::memory_order_relaxed) != 0) {
+        { std::unique_lock<dxvk::mutex> lock(m_mutex); }
+        m_condOnPop.notify_all();
+      }
+
+      return true;
+    }
+
+    /**
+      * \brief Pops an item, consumer thread only.
+      *        Parks the thread while the queue is empty.
+      * \returns false if the queue was stopped and no item was available
+      */
+    bool pop(T& item) {
+      while (!tryPop(item)) {
+        // Producers usually push in bursts, so spin briefly before paying for a park and wake up
+        bool hasPending = false;
+        for (uint32_t i = 0; i < SpinCount && !hasPending; i++) {
+          dxvk::this_thread::yield();
+          hasPending = hasItem();
+        }
+
+        if (hasPending) {
+          continue;
+        }
+
+        std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+        m_consumerParked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        m_condOnPush.wait(lock, [this] {
+          return hasItem() || m_stopped.load();
+        });
+
+        m_consumerParked.store(false, std::memory_order_relaxed);
+
+        if (!hasItem()) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    /**
+      * \brief Makes pop() return once the queue is empty.
+      */
+    void stop() {
+      { std::unique_lock<dxvk::mutex> lock(m_mutex);
+        m_stopped.store(true);
+      }
+
+      m_condOnPush.notify_one();
+    }
+
+    /**
+      * \brief Number of items pushed so far, including ones still being published.
+      */
+    uint64_t pushCount() const {
+      return m_pushPosition.load();
+    }
+
+  private:
+    static constexpr uint32_t SpinCount = 64;
+    static constexpr std::chrono::milliseconds ParkTimeout = std::chrono::milliseconds(1);
+
+    // Slots are cache line aligned so that producers publishing to neighbouring slots don't contend
+    struct alignas(CACHE_LINE_SIZE) Slot {
+      std::atomic<uint64_t> sequence;
+      T item;
+    };
+
+    // Claims the slot at the push position, false if the queue is full
+    bool tryClaim(uint64_t& position) {
+      position = m_pushPosition.load(std::memory_order_relaxed);
+
+      while (true) {
+        const Slot& slot = m_slots[position & (Capacity - 1)];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const int64_t diff = int64_t(sequence - position);
+
+        if (diff == 0) {
+          if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+            return true;
+          }
+        } else if (diff < 0) {
+          return false;
+        } else {
+          // Another producer claimed the slot
+          position = m_pushPosition.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    void publish(uint64_t position, T&& item) {
+      Slot& slot = m_slots[position & (Capacity - 1)];
+      slot.item = std::move(item);
+      slot.sequence.store(position + 1, std::memory_order_release);
+
+      // Pairs with the fence in pop(): either we see the consumer parked, or it sees the item.
+      // Only the producer which clears the flag wakes the consumer.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (m_consumerParked.load(std::memory_order_relaxed) && m_consumerParked.exchange(false)) {
+        wakeConsumer();
+      }
+    }
+
+    // Parks a producer until the slot at position is popped from its previous lap, or for at most ParkTimeout
+    void waitForPop(uint64_t position) {
+      const Slot& slot = m_slots[position & (Capacity - 1)];
+
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_producersParked.fetch_add(1);
+
+      m_condOnPop.wait_for(lock, ParkTimeout, [&] {
+        return int64_t(slot.sequence.load(std::memory_order_acquire) - position) >= 0;
+      });
+
+      m_producersParked.fetch_sub(1);
+    }
+
+    bool hasItem() const {
+      return m_slots[m_popPosition & (Capacity - 1)].sequence.load(std::memory_order_acquire) == m_popPosition + 1;
+    }
+
+    void wakeConsumer() {
+      // Taking the lock makes sure the consumer either did not check for items yet, or is already waiting
+      { std::unique_lock<dxvk::mutex> lock(m_mutex); }
+      m_condOnPush.notify_one();
+    }
+
+    std::array<Slot, Capacity> m_slots;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_pushPosition = { 0ull };
+    alignas(CACHE_LINE_SIZE) uint64_t m_popPosition = 0;
+    std::atomic<uint32_t> m_producersParked = { 0u };
+    std::atomic<bool> m_consumerParked = { false };
+    std::atomic<bool> m_stopped = { false };
+
+    dxvk::mutex m_mutex;
+    dxvk::condition_variable m_condOnPush;
+    dxvk::condition_variable m_condOnPop;
+  };
+} //dxvk
@@ -0,0 +1,322 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Compares the index buffer memoization of D3D9Rtx::processIndexBuffer before and after MemoryRegionMemoizer kept
+// its ranges in an interval tree with per page hashes: an exact match cache wiped on every DISCARD lock, versus
+// re-verifying cached ranges and serving sub-ranges from the ranges containing them.
+// Replays synthetic lock patterns of a dynamic 16 bit index buffer, only the CPU side is measured.
+//
+// Usage: bench_index_memoization [draws per frame] [frames]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_memoization.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this benchmark.
+  Logger Logger::s_instance("bench_index_memoization.log");
+}
+
+namespace dxvk {
+  class IndexMemoizationBenchmark {
+  public:
+    enum class Pattern {
+      DiscardPerFrame,   // DISCARD at the start of each frame, NOOVERWRITE locks after it
+      RingWrap,          // DISCARD only when the buffer is full, so offsets drift from frame to frame
+      SubRangeDraws,     // As DiscardPerFrame, each lock drawn in full then in 4 draw calls over parts of it
+    };
+
+    // Share of the draws whose indices change from one frame to the next
+    static constexpr uint32_t kChangedPercent = 10;
+
+    struct Stats {
+      double ms = 0.0;
+      uint32_t numRequests = 0;
+      uint32_t numComputed = 0;
+    };
+
+    IndexMemoizationBenchmark(uint32_t numDraws, uint32_t numFrames)
+      : m_numFrames(numFrames)
+      , m_drawSizes(numDraws)
+      , m_drawBases(numDraws) {
+      std::mt19937 rng(42);
+      size_t frameSize = 0;
+      for (uint32_t draw = 0; draw < numDraws; draw++) {
+        // Mostly small batches (particles, UI, decals) and a few large ones
+        m_drawSizes[draw] = rng() % 8 == 0 ? 1500 + rng() % 15000 : 6 + rng() % 600;
+        m_drawBases[draw] = rng() % 30000;
+        frameSize += m_drawSizes[draw] * sizeof(uint16_t);
+      }
+
+      // Room for about 2.5 frames when wrapping
+      m_bufferSize = frameSize * 5 / 2;
+      m_buffer.resize(m_bufferSize / sizeof(uint16_t) + 1);
+      m_staging.resize(m_buffer.size());
+    }
+
+    Stats runExact(Pattern pattern) {
+      ExactMemoizer memoizer;
+      Stats stats;
+
+      replay(pattern, stats,
+        [&]() { memoizer.invalidateAll(); },
+        [&](size_t start, size_t size) { memoizer.invalidate(start, size); },
+        [&](size_t start, size_t size) {
+          auto it = memoizer.cache.find(start);
+          if (it != memoizer.cache.end() && it->second.end == start + size) {
+            return it->second.result;
+          }
+
+          stats.numComputed++;
+          memoizer.invalidate(start, size);
+
+          const MinMax result = copyIndices(start, size);
+          memoizer.cache[start] = { start + size, result };
+          return result;
+        });
+
+      return stats;
+    }
+
+    Stats runIntervalTree(Pattern pattern) {
+      Memoizer memoizer;
+      Stats stats;
+
+      replay(pattern, stats,
+        [&]() { memoizer.invalidateAll(); },
+        [&](size_t start, size_t size) { memoizer.invalidate(start, size); },
+        [&](size_t start, size_t size) {
+          const uint8_t* pBuffer = reinterpret_cast<const uint8_t*>(m_buffer.data());
+
+          // Same steps as D3D9Rtx::processMemoizedIndexBuffer
+          const Memoizer::Entry* pCached = memoizer.find(pBuffer, start, size);
+          if (pCached != nullptr && pCached->start == start && pCached->end == start + size) {
+            return pCached->result;
+          }
+
+          memoizer.summarizePages(pBuffer, start, size, [](const uint8_t* pData, size_t pageSize) {
+            return findMinMax(reinterpret_cast<const uint16_t*>(pData), pageSize / sizeof(uint16_t));
+          }, m_pages);
+
+          MinMax result { UINT32_MAX, 0 };
+          for (const MinMax& page : m_pages) {
+            result.min = std::min(result.min, page.min);
+            result.max = std::max(result.max, page.max);
+          }
+
+          if (pCached != nullptr && pCached->result.min == result.min) {
+            return result;
+          }
+
+          stats.numComputed++;
+          subtractIndices(start, size, result.min);
+          return memoizer.insert(pBuffer, start, size, result, m_pages).result;
+        });
+
+      return stats;
+    }
+
+  private:
+    struct MinMax {
+      uint32_t min, max;
+    };
+
+    using Memoizer = MemoryRegionMemoizer<MinMax, MinMax>;
+
+    // The previous MemoryRegionMemoizer
+    struct ExactMemoizer {
+      struct Entry {
+        size_t end;
+        MinMax result;
+      };
+
+      std::map<size_t, Entry> cache;
+
+      void invalidate(size_t start, size_t size) {
+        auto it = cache.lower_bound(start);
+        if (it != cache.begin()) {
+          --it;
+        }
+
+        while (it != cache.end() && it->first < start + size) {
+          if (it->second.end > start) {
+            it = cache.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+
+      void invalidateAll() {
+        cache.clear();
+      }
+    };
+
+    static MinMax findMinMax(const uint16_t* pIndices, size_t count) {
+      MinMax result { UINT32_MAX, 0 };
+      for (size_t i = 0; i < count; i++) {
+        result.min = std::min<uint32_t>(result.min, pIndices[i]);
+        result.max = std::max<uint32_t>(result.max, pIndices[i]);
+      }
+      return result;
+    }
+
+    // The work of D3D9Rtx::copyIndices, into a staging copy
+    MinMax copyIndices(size_t start, size_t size) {
+      const MinMax result = findMinMax(m_buffer.data() + start / sizeof(uint16_t), size / sizeof(uint16_t));
+      subtractIndices(start, size, result.min);
+      return result;
+    }
+
+    void subtractIndices(size_t start, size_t size, uint32_t minIndex) {
+      const uint16_t* pSrc = m_buffer.data() + start / sizeof(uint16_t);
+      uint16_t* pDst = m_staging.data() + start / sizeof(uint16_t);
+      for (size_t i = 0; i < size / sizeof(uint16_t); i++) {
+        pDst[i] = static_cast<uint16_t>(pSrc[i] - minIndex);
+      }
+    }
+
+    template<typename Discard, typename Lock, typename Process>
+    void replay(Pattern pattern, Stats& stats, const Discard& discard, const Lock& lock, const Process& process) {
+      // Same index data sequence for both memoizers
+      std::mt19937 rng(7);
+      size_t offset = 0;
+      uint64_t checksum = 0;
+
+      std::vector<bool> changed(m_drawSizes.size(), false);
+
+      for (uint32_t frame = 0; frame < m_numFrames; frame++) {
+        if (pattern != Pattern::RingWrap) {
+          discard();
+          offset = 0;
+        }
+
+        for (uint32_t draw = 0; draw < m_drawSizes.size(); draw++) {
+          const size_t size = m_drawSizes[draw] * sizeof(uint16_t);
+          if (offset + size > m_bufferSize) {
+            discard();
+            offset = 0;
+          } else {
+            lock(offset, size);
+          }
+
+          // A changed draw is changed back on the next frame
+          const bool isChanged = rng() % 100 < kChangedPercent;
+          if (isChanged || changed[draw]) {
+            writeIndices(offset, draw, isChanged ? rng() % 1000 + 1 : 0);
+          } else if (pattern == Pattern::RingWrap || frame == 0) {
+            writeIndices(offset, draw, 0);
+          }
+          changed[draw] = isChanged;
+
+          const auto start = std::chrono::high_resolution_clock::now();
+
+          const MinMax result = process(offset, size);
+          checksum += result.min + result.max;
+          stats.numRequests++;
+
+          if (pattern == Pattern::SubRangeDraws) {
+            const size_t partSize = size / 4 & ~(sizeof(uint16_t) - 1);
+            for (size_t part = 0; part < 4 && partSize > 0; part++) {
+              const MinMax partResult = process(offset + part * partSize, partSize);
+              checksum += partResult.min + partResult.max;
+              stats.numRequests++;
+            }
+          }
+
+          const auto end = std::chrono::high_resolution_clock::now();
+          stats.ms += std::chrono::duration<double, std::milli>(end - start).count();
+
+          offset += size;
+        }
+      }
+
+      stats.ms /= m_numFrames;
+
+      // Keep the work observable
+      if (checksum == uint64_t(-1)) {
+        std::printf("\n");
+      }
+    }
+
+    // Indices of a draw as a game would upload them: quads over a contiguous vertex range
+    void writeIndices(size_t offset, uint32_t draw, uint32_t variation) {
+      uint16_t* pIndices = m_buffer.data() + offset / sizeof(uint16_t);
+      static const uint16_t kQuad[6] = { 0, 1, 2, 2, 1, 3 };
+
+      for (uint32_t i = 0; i < m_drawSizes[draw]; i++) {
+        pIndices[i] = static_cast<uint16_t>(m_drawBases[draw] + variation + (i / 6) * 4 + kQuad[i % 6]);
+      }
+    }
+
+    uint32_t m_numFrames;
+    std::vector<uint32_t> m_drawSizes;
+    std::vector<uint32_t> m_drawBases;
+    size_t m_bufferSize;
+    std::vector<uint16_t> m_buffer;
+    std::vector<uint16_t> m_staging;
+    std::vector<MinMax> m_pages;
+  };
+}
+
+int main(int argc, char* argv[]) {
+  using namespace dxvk;
+
+  try {
+    const uint32_t numDraws = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 2000;
+    const uint32_t numFrames = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 60;
+
+    IndexMemoizationBenchmark benchmark(numDraws, numFrames);
+
+    std::printf("%u draws, %u frames, %u%% of the draws changing per frame\n", numDraws, numFrames,
+                IndexMemoizationBenchmark::kChangedPercent);
+
+    const std::pair<IndexMemoizationBenchmark::Pattern, const char*> patterns[] = {
+      { IndexMemoizationBenchmark::Pattern::DiscardPerFrame, "discard per frame" },
+      { IndexMemoizationBenchmark::Pattern::RingWrap, "ring wrap" },
+      { IndexMemoizationBenchmark::Pattern::SubRangeDraws, "sub-range draws" },
+    };
+
+    for (const auto& [pattern, name] : patterns) {
+      const auto exact = benchmark.runExact(pattern);
+      const auto tree = benchmark.runIntervalTree(pattern);
+
+      std::printf("  %-18s exact match %7.3f ms/frame (%5.1f%% computed), interval tree %7.3f ms/frame (%5.1f%% computed)\n", name,
+                  exact.ms, 100.0 * exact.numComputed / exact.numRequests,
+                  tree.ms, 100.0 * tree.numComputed / tree.numRequests);
+    }
+  }
+  catch (const DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
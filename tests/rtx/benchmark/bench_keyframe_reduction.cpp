@@ -0,0 +1,349 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Compares a multi-frame GameCapturer capture of synthetic animations with and without keyframe reduction:
+// every transform sample appended to its instance, and mesh buffers only cached when they differ from the last
+// cached one, versus dropping the samples interpolation reproduces. Reports the capture time of the samples, the
+// memory they hold at the end of the capture, and the size of the sample data written to the USD layers.
+// Transforms are 4x4 double matrices and buffers float3 arrays, as captured, no USD types are involved. The game
+// runs at 60 fps and is captured with 24 timecodes per second, the GameCapturer default.
+//
+// Usage: bench_keyframe_reduction [instances] [frames]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_matrix.h"
+#include "../../../src/dxvk/rtx_render/rtx_keyframe_reducer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this benchmark.
+  Logger Logger::s_instance("bench_keyframe_reduction.log");
+}
+
+namespace dxvk {
+  class KeyframeReductionBenchmark {
+  public:
+    enum class Animation {
+      Linear,     // Constant velocity, i.e. projectiles and vehicles
+      Spinning,   // Constant angular velocity, i.e. pickups and fans
+      Bobbing,    // Sine translation and rotation
+      Jitter,     // Noise, worst case with nothing to drop
+      Skeleton,   // Joint transforms of a walk cycle, interpolated with slerp
+      Morph,      // Vertex positions of a wave deformation
+    };
+
+    struct Stats {
+      double ms = 0.0;
+      size_t numCaptured = 0;
+      size_t numKept = 0;
+      size_t peakBytes = 0;
+      size_t outputBytes = 0;
+    };
+
+    // Same defaults as GameCapturer
+    static constexpr XformTolerance kTolerance { 0.01, 0.005 };
+    static constexpr float kPositionDelta = 0.3f;
+    static constexpr size_t kMaxDroppedXforms = 32;
+    static constexpr size_t kMaxDroppedBuffers = 16;
+
+    static constexpr uint32_t kJointsPerSkeleton = 32;
+    static constexpr uint32_t kVerticesPerMesh = 2000;
+
+    KeyframeReductionBenchmark(uint32_t numInstances, uint32_t numFrames)
+      : m_numInstances(numInstances)
+      , m_numFrames(numFrames) {
+      std::mt19937 rng(42);
+      std::uniform_real_distribution<double> dist(0.0, 1.0);
+      for (uint32_t i = 0; i < numInstances; i++) {
+        m_phases.push_back(dist(rng) * 6.28);
+        m_speeds.push_back(0.5 + dist(rng));
+      }
+    }
+
+    Stats run(Animation animation, bool reduce) {
+      switch (animation) {
+      case Animation::Skeleton:
+        return runSkeleton(reduce);
+      case Animation::Morph:
+        return runMorph(reduce);
+      default:
+        return runXforms(animation, reduce);
+      }
+    }
+
+  private:
+    struct SampledXform {
+      double time;
+      Matrix4d xform;
+    };
+
+    struct SampledBoneXform {
+      double time;
+      std::shared_ptr<const std::vector<Matrix4d>> xforms;
+    };
+
+    // Shared, as VtArray storage is
+    using Buffer = std::shared_ptr<const std::vector<Vector3>>;
+
+    // Same steps as appendReducedSample in GameCapturer
+    template<typename Sample, typename T, typename Reproduces>
+    static void append(KeyframeReducer<T>* pReducer, std::vector<Sample>& samples, Sample sample, T Sample::* value, const Reproduces& reproduces) {
+      if (pReducer != nullptr && samples.size() >= 2) {
+        const Sample& key = samples[samples.size() - 2];
+        Sample& tail = samples.back();
+        if (pReducer->dropTail(key.time, key.*value, tail.time, tail.*value, sample.time, sample.*value, reproduces)) {
+          tail = std::move(sample);
+          return;
+        }
+      }
+      samples.push_back(std::move(sample));
+    }
+
+    static constexpr double kGameFramesPerSecond = 60.0;
+    static constexpr double kTimeCodesPerSecond = 24.0;
+
+    static double seconds(uint32_t frame) {
+      return frame / kGameFramesPerSecond;
+    }
+
+    static double time(uint32_t frame) {
+      return seconds(frame) * kTimeCodesPerSecond;
+    }
+
+    Matrix4d instanceXform(Animation animation, uint32_t instance, uint32_t frame, std::mt19937& rng) const {
+      const double t = seconds(frame) * m_speeds[instance] + m_phases[instance];
+      const Vector3d origin(instance % 100 * 10.0, instance / 100 * 10.0, 0.0);
+      switch (animation) {
+      case Animation::Linear:
+        return Matrix4d(origin + Vector3d(t * 5.0, 0.0, t));
+      case Animation::Spinning:
+        return rotationZ(t * 2.0, origin);
+      case Animation::Bobbing:
+        return rotationZ(std::sin(t) * 0.5, origin + Vector3d(0.0, 0.0, std::sin(t * 2.0)));
+      default: {
+        std::uniform_real_distribution<double> noise(-0.05, 0.05);
+        return rotationZ(noise(rng), origin + Vector3d(noise(rng), noise(rng), noise(rng)));
+      }
+      }
+    }
+
+    static Matrix4d rotationZ(double angle, const Vector3d& translation) {
+      Matrix4d m(Vector4d(0.0, 0.0, std::sin(angle / 2.0), std::cos(angle / 2.0)), translation);
+      for (int row = 0; row < 3; row++) {
+        m[row][3] = 0.0;
+      }
+      return m;
+    }
+
+    Stats runXforms(Animation animation, bool reduce) {
+      std::vector<std::vector<SampledXform>> tracks(m_numInstances);
+      std::vector<KeyframeReducer<Matrix4d>> reducers(m_numInstances, KeyframeReducer<Matrix4d>(kMaxDroppedXforms));
+      const auto reproduces = [](const Matrix4d& a, const Matrix4d& b, double t, const Matrix4d& sample) {
+        return isXformWithinTolerance(lerpXform(a, b, t), sample, kTolerance);
+      };
+
+      std::mt19937 rng(7);
+      Stats stats;
+      for (uint32_t frame = 0; frame < m_numFrames; frame++) {
+        for (uint32_t instance = 0; instance < m_numInstances; instance++) {
+          const SampledXform sample { time(frame), instanceXform(animation, instance, frame, rng) };
+
+          const auto start = std::chrono::high_resolution_clock::now();
+          append(reduce ? &reducers[instance] : nullptr, tracks[instance], sample, &SampledXform::xform, reproduces);
+          const auto end = std::chrono::high_resolution_clock::now();
+          stats.ms += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+      }
+
+      stats.numCaptured = size_t(m_numInstances) * m_numFrames;
+      for (uint32_t instance = 0; instance < m_numInstances; instance++) {
+        stats.numKept += tracks[instance].size();
+        stats.peakBytes += (tracks[instance].size() + reducers[instance].numDropped()) * sizeof(SampledXform);
+      }
+      stats.outputBytes = stats.numKept * sizeof(Matrix4d);
+      return stats;
+    }
+
+    Stats runSkeleton(bool reduce) {
+      std::vector<std::vector<SampledBoneXform>> tracks(m_numInstances);
+      using BoneXforms = std::shared_ptr<const std::vector<Matrix4d>>;
+      std::vector<KeyframeReducer<BoneXforms>> reducers(m_numInstances, KeyframeReducer<BoneXforms>(kMaxDroppedXforms));
+      const auto reproduces = [](const BoneXforms& a, const BoneXforms& b, double t, const BoneXforms& sample) {
+        for (size_t joint = 0; joint < sample->size(); joint++) {
+          if (!isXformWithinTolerance(slerpXform((*a)[joint], (*b)[joint], t), (*sample)[joint], kTolerance)) {
+            return false;
+          }
+        }
+        return true;
+      };
+
+      Stats stats;
+      for (uint32_t frame = 0; frame < m_numFrames; frame++) {
+        for (uint32_t instance = 0; instance < m_numInstances; instance++) {
+          // Joints swinging back and forth over a one second cycle
+          auto joints = std::make_shared<std::vector<Matrix4d>>(kJointsPerSkeleton);
+          const double t = seconds(frame) * 6.28 + m_phases[instance];
+          for (uint32_t joint = 0; joint < kJointsPerSkeleton; joint++) {
+            (*joints)[joint] = rotationZ(std::sin(t + joint * 0.2) * 0.6, Vector3d(0.0, joint * 0.1, 0.0));
+          }
+
+          const auto start = std::chrono::high_resolution_clock::now();
+          append(reduce ? &reducers[instance] : nullptr, tracks[instance], SampledBoneXform { time(frame), std::move(joints) }, &SampledBoneXform::xforms, reproduces);
+          const auto end = std::chrono::high_resolution_clock::now();
+          stats.ms += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+      }
+
+      const size_t sampleBytes = kJointsPerSkeleton * sizeof(Matrix4d);
+      stats.numCaptured = size_t(m_numInstances) * m_numFrames;
+      for (uint32_t instance = 0; instance < m_numInstances; instance++) {
+        stats.numKept += tracks[instance].size();
+        stats.peakBytes += (tracks[instance].size() + reducers[instance].numDropped()) * sampleBytes;
+      }
+      stats.outputBytes = stats.numKept * sampleBytes;
+      return stats;
+    }
+
+    Stats runMorph(bool reduce) {
+      // Fewer meshes than instances, their buffers are much larger than transforms
+      const uint32_t numMeshes = std::max(m_numInstances / 10, 1u);
+
+      std::vector<std::map<float, Buffer>> bufferCaches(numMeshes);
+      std::vector<KeyframeReducer<Buffer>> reducers(numMeshes, KeyframeReducer<Buffer>(kMaxDroppedBuffers));
+
+      const auto differentEnough = [](const Vector3& a, const Vector3& b) {
+        return lengthSqr(a - b) > kPositionDelta * kPositionDelta;
+      };
+      const auto reproduces = [&differentEnough](const Buffer& a, const Buffer& b, double t, const Buffer& sample) {
+        const float tf = static_cast<float>(t);
+        for (size_t idx = 0; idx < sample->size(); ++idx) {
+          if (differentEnough((*a)[idx] + ((*b)[idx] - (*a)[idx]) * tf, (*sample)[idx])) {
+            return false;
+          }
+        }
+        return true;
+      };
+
+      Stats stats;
+      for (uint32_t frame = 0; frame < m_numFrames; frame++) {
+        for (uint32_t mesh = 0; mesh < numMeshes; mesh++) {
+          // A slow wave over a grid, i.e. water or cloth
+          auto positions = std::make_shared<std::vector<Vector3>>(kVerticesPerMesh);
+          const float t = static_cast<float>(seconds(frame) + m_phases[mesh]);
+          for (uint32_t v = 0; v < kVerticesPerMesh; v++) {
+            const float x = static_cast<float>(v % 50);
+            const float y = static_cast<float>(v / 50);
+            (*positions)[v] = Vector3(x, y, 2.0f * std::sin(t + x * 0.2f));
+          }
+
+          const auto start = std::chrono::high_resolution_clock::now();
+
+          // Same steps as GameCapturer::evalNewBufferAndCache
+          auto& bufferCache = bufferCaches[mesh];
+          bool bSufficientlyDifferent = bufferCache.empty();
+          if (!bSufficientlyDifferent) {
+            const Buffer& prevBuf = (--bufferCache.cend())->second;
+            for (size_t idx = 0; idx < positions->size() && !bSufficientlyDifferent; ++idx) {
+              bSufficientlyDifferent = differentEnough((*positions)[idx], (*prevBuf)[idx]);
+            }
+          }
+          if (bSufficientlyDifferent) {
+            Buffer newBuffer = std::move(positions);
+            if (reduce && bufferCache.size() >= 2) {
+              const auto tail = std::prev(bufferCache.end());
+              const auto key = std::prev(tail);
+              if (reducers[mesh].dropTail(key->first, key->second, tail->first, tail->second, time(frame), newBuffer, reproduces)) {
+                bufferCache.erase(tail);
+              }
+            }
+            bufferCache[static_cast<float>(time(frame))] = std::move(newBuffer);
+          }
+
+          const auto end = std::chrono::high_resolution_clock::now();
+          stats.ms += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+      }
+
+      const size_t sampleBytes = kVerticesPerMesh * sizeof(Vector3);
+      stats.numCaptured = size_t(numMeshes) * m_numFrames;
+      for (uint32_t mesh = 0; mesh < numMeshes; mesh++) {
+        stats.numKept += bufferCaches[mesh].size();
+        stats.peakBytes += (bufferCaches[mesh].size() + reducers[mesh].numDropped()) * sampleBytes;
+      }
+      stats.outputBytes = stats.numKept * sampleBytes;
+      return stats;
+    }
+
+    uint32_t m_numInstances;
+    uint32_t m_numFrames;
+    std::vector<double> m_phases;
+    std::vector<double> m_speeds;
+  };
+}
+
+int main(int argc, char* argv[]) {
+  using namespace dxvk;
+
+  try {
+    const uint32_t numInstances = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 1000;
+    const uint32_t numFrames = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 600;
+
+    KeyframeReductionBenchmark benchmark(numInstances, numFrames);
+
+    std::printf("%u instances, %u frames\n", numInstances, numFrames);
+
+    const std::pair<KeyframeReductionBenchmark::Animation, const char*> animations[] = {
+      { KeyframeReductionBenchmark::Animation::Linear, "linear" },
+      { KeyframeReductionBenchmark::Animation::Spinning, "spinning" },
+      { KeyframeReductionBenchmark::Animation::Bobbing, "bobbing" },
+      { KeyframeReductionBenchmark::Animation::Jitter, "jitter" },
+      { KeyframeReductionBenchmark::Animation::Skeleton, "skeleton" },
+      { KeyframeReductionBenchmark::Animation::Morph, "morph" },
+    };
+
+    for (const auto& [animation, name] : animations) {
+      const auto full = benchmark.run(animation, false);
+      const auto reduced = benchmark.run(animation, true);
+
+      std::printf("  %-9s unreduced %8.2f ms, %8.2f MB held, %8.2f MB written | reduced %8.2f ms, %8.2f MB held, %8.2f MB written (%5.1f%% of %zu samples kept)\n",
+                  name,
+                  full.ms, full.peakBytes / 1048576.0, full.outputBytes / 1048576.0,
+                  reduced.ms, reduced.peakBytes / 1048576.0, reduced.outputBytes / 1048576.0,
+                  100.0 * reduced.numKept / reduced.numCaptured, reduced.numCaptured);
+    }
+  }
+  catch (const DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
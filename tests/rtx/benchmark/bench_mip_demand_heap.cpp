@@ -0,0 +1,231 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Compares the texture budget management of RtxTextureManager::garbageCollection before and after it kept the
+// sampler feedback demands in a MipDemandHeap: re-sorting every streamed texture each frame, versus re-keying the
+// textures whose feedback changed and only walking the order when the budget is exceeded.
+// Textures are synthetic, only the CPU side is measured.
+//
+// Usage: bench_mip_demand_heap [texture count] [frames]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_mip_demand_heap.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this benchmark.
+  Logger Logger::s_instance("bench_mip_demand_heap.log");
+}
+
+namespace dxvk {
+  class MipDemandBenchmark {
+  public:
+    static constexpr uint32_t kMaxMips = 13;
+
+    // Share of the textures whose accumulated feedback changes each frame, and of those only refreshing their frame
+    static constexpr uint32_t kChangedPerMille = 10;
+    static constexpr uint32_t kRefreshedPerMille = 50;
+
+    struct Texture {
+      uint32_t frame;
+      uint8_t mipcount;
+    };
+
+    MipDemandBenchmark(uint32_t numTextures, uint32_t numFrames)
+      : m_numFrames(numFrames)
+      , m_textures(numTextures) {
+      std::mt19937 rng(42);
+      std::uniform_int_distribution<uint32_t> mips(0, kMaxMips);
+
+      for (Texture& texture : m_textures) {
+        texture.frame = 0;
+        texture.mipcount = uint8_t(mips(rng));
+      }
+    }
+
+    // Returns the average milliseconds per frame of the previous and the incremental approach
+    void run(double budgetFraction, double& sortMs, double& heapMs) {
+      size_t totalBytes = 0;
+      for (const Texture& texture : m_textures) {
+        totalBytes += getBytes(texture.mipcount);
+      }
+      const size_t budgetBytes = size_t(double(totalBytes) * budgetFraction);
+
+      sortMs = runFrames([&](const std::vector<uint32_t>&, uint32_t curframe) {
+        return sortAndFit(curframe, budgetBytes);
+      });
+
+      MipDemandHeap heap;
+      for (uint32_t i = 0; i < m_textures.size(); i++) {
+        heap.update(i, getDemand(m_textures[i]));
+      }
+
+      heapMs = runFrames([&](const std::vector<uint32_t>& changed, uint32_t) {
+        for (uint32_t i : changed) {
+          heap.update(i, getDemand(m_textures[i]));
+        }
+        return heapFit(heap, budgetBytes);
+      });
+    }
+
+  private:
+    static size_t getBytes(uint32_t mipcount) {
+      // Square RGBA8 texture with mipcount mips, i.e. the sum of 4^i * 4 bytes
+      return mipcount == 0 ? 0 : ((size_t(1) << (2 * mipcount)) - 1) / 3 * 4;
+    }
+
+    static MipDemandHeap::Demand getDemand(const Texture& texture) {
+      return { std::log2(1.0 + texture.mipcount) + texture.frame / 8.0, getBytes(texture.mipcount) };
+    }
+
+    template<typename Fn>
+    double runFrames(const Fn& fn) {
+      // Same feedback sequence for both approaches
+      std::mt19937 rng(7);
+      std::uniform_int_distribution<uint32_t> perMille(0, 999);
+      std::uniform_int_distribution<uint32_t> mips(0, kMaxMips);
+      std::vector<Texture> textures = m_textures;
+      std::vector<uint32_t> changed;
+
+      double totalMs = 0.0;
+      size_t checksum = 0;
+
+      for (uint32_t frame = 1; frame <= m_numFrames; frame++) {
+        changed.clear();
+        for (uint32_t i = 0; i < textures.size(); i++) {
+          const uint32_t roll = perMille(rng);
+          if (roll < kChangedPerMille) {
+            textures[i].mipcount = uint8_t(mips(rng));
+            textures[i].frame = frame;
+            changed.push_back(i);
+          } else if (roll < kChangedPerMille + kRefreshedPerMille) {
+            textures[i].frame = frame;
+            changed.push_back(i);
+          }
+        }
+
+        std::swap(textures, m_textures);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        checksum += fn(changed, frame);
+        const auto end = std::chrono::high_resolution_clock::now();
+        totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+
+        std::swap(textures, m_textures);
+      }
+
+      // Keep the work observable
+      if (checksum == size_t(-1)) {
+        std::printf("\n");
+      }
+
+      return totalMs / m_numFrames;
+    }
+
+    // The previous approach: sort every texture by a weight which depends on the current frame, then fit greedily
+    size_t sortAndFit(uint32_t curframe, size_t budgetBytes) {
+      auto weight = [curframe](const Texture& x) {
+        const uint32_t framediff = curframe >= x.frame ? curframe - x.frame : 0;
+        return 2.f * float(x.mipcount) / 32.f + 1.f / (1.f + framediff);
+      };
+
+      m_order.resize(m_textures.size());
+      for (uint32_t i = 0; i < m_order.size(); i++) {
+        m_order[i] = i;
+      }
+
+      std::sort(m_order.begin(), m_order.end(), [&](uint32_t a, uint32_t b) {
+        const float weightA = weight(m_textures[a]);
+        const float weightB = weight(m_textures[b]);
+        if (std::abs(weightA - weightB) < 0.00001f) {
+          return a < b;
+        }
+        return weightA > weightB;
+      });
+
+      size_t usedBytes = 0;
+      size_t numDemoted = 0;
+      for (uint32_t i : m_order) {
+        const size_t bytes = getBytes(m_textures[i].mipcount);
+        if (usedBytes + bytes <= budgetBytes) {
+          usedBytes += bytes;
+        } else {
+          numDemoted++;
+        }
+      }
+
+      return usedBytes + numDemoted;
+    }
+
+    static size_t heapFit(const MipDemandHeap& heap, size_t budgetBytes) {
+      if (heap.getTotalBytes() <= budgetBytes) {
+        return heap.getTotalBytes();
+      }
+
+      size_t numDemoted = 0;
+      const size_t usedBytes = heap.fitBudget(budgetBytes,
+        [](uint32_t, const MipDemandHeap::Demand&) { },
+        [&](uint32_t, const MipDemandHeap::Demand&) { numDemoted++; });
+
+      return usedBytes + numDemoted;
+    }
+
+    uint32_t m_numFrames;
+    std::vector<Texture> m_textures;
+    std::vector<uint32_t> m_order;
+  };
+}
+
+int main(int argc, char* argv[]) {
+  using namespace dxvk;
+
+  try {
+    const uint32_t numTextures = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 100000;
+    const uint32_t numFrames = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 60;
+
+    MipDemandBenchmark benchmark(numTextures, numFrames);
+
+    std::printf("%u textures, %u frames, %u%% of the textures changing per frame\n", numTextures, numFrames,
+                (MipDemandBenchmark::kChangedPerMille + MipDemandBenchmark::kRefreshedPerMille) / 10);
+
+    for (const double budgetFraction : { 2.0, 0.6 }) {
+      double sortMs, heapMs;
+      benchmark.run(budgetFraction, sortMs, heapMs);
+
+      std::printf("  %-12s sort %8.3f ms/frame, heap %8.3f ms/frame\n",
+                  budgetFraction >= 1.0 ? "under budget" : "over budget", sortMs, heapMs);
+    }
+  }
+  catch (const DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,450 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Replays a recorded draw call trace (see rtx.drawCallTracePath) through the CPU side of scene ingest: BLAS lookup
+// in the DrawCallCache, instance matching and garbage collection in the InstanceManager and merged BLAS planning
+// in the AccelManager. The managers run without a device: frame indices come from the benchmark, and BLAS entries get
+// stand-in build geometries instead of buffers, so nothing is uploaded or built and the results only depend on the trace.
+// Options are loaded from the working directory like at runtime.
+// Without a trace argument a synthetic one is generated from a fixed seed.
+//
+// Usage: bench_scene_ingest [trace file] [iterations]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_accel_manager.h"
+#include "../../../src/dxvk/rtx_render/rtx_camera_manager.h"
+#include "../../../src/dxvk/rtx_render/rtx_draw_call_cache.h"
+#include "../../../src/dxvk/rtx_render/rtx_draw_call_trace.h"
+#include "../../../src/dxvk/rtx_render/rtx_instance_manager.h"
+#include "../../../src/dxvk/rtx_render/rtx_materials.h"
+#include "../../../src/dxvk/rtx_render/rtx_option_layer.h"
+#include "../../../src/dxvk/rtx_render/rtx_option_manager.h"
+#include "../../../src/dxvk/rtx_render/rtx_ray_portal_manager.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this benchmark.
+  Logger Logger::s_instance("bench_scene_ingest.log");
+}
+
+// Allocation counting, so that regressions in per-frame allocations show up next to the timings
+static std::atomic<uint64_t> s_numAllocations = 0;
+
+void* operator new(size_t size) {
+  s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+namespace dxvk {
+  class SceneIngestBenchmark {
+  public:
+    enum Stage : uint32_t {
+      BlasLookup,
+      InstanceMatching,
+      GarbageCollection,
+      BucketPlanning,
+      StageCount
+    };
+
+    struct Results {
+      double stageMs[StageCount] = {};
+      uint64_t stageAllocations[StageCount] = {};
+      uint64_t numMatched = 0;
+      uint64_t numCreated = 0;
+      uint64_t numCollected = 0;
+      uint64_t numDynamicBlas = 0;  // Instances which got a BLAS of their own instead of going into a merged one
+      XXH64_hash_t checksum = 0;    // Of every match decision, to verify the replay is deterministic
+    };
+
+    explicit SceneIngestBenchmark(const DrawCallTrace& trace)
+      : m_trace(trace) {
+      m_drawCallCache.overrideFrameIdSource(&m_frameId);
+      m_instanceManager.overrideFrameIdSource(&m_frameId);
+
+      // Links instances to their BLAS entries like SceneManager's handlers, which BLAS lookup and merged BLAS planning rely on
+      InstanceEventHandler instanceEvents(this);
+      instanceEvents.onInstanceAddedCallback = [](RtInstance& instance) {
+        instance.getBlas()->linkInstance(&instance);
+      };
+      instanceEvents.onInstanceUpdatedCallback = [](RtInstance&, const DrawCallState&, const MaterialData&, bool, bool, bool) { };
+      instanceEvents.onInstanceDestroyedCallback = [](RtInstance& instance) {
+        if (!instance.isUnlinkedForGC()) {
+          instance.getBlas()->unlinkInstance(&instance);
+        }
+      };
+      m_instanceManager.addEventHandler(instanceEvents);
+    }
+
+    ~SceneIngestBenchmark() {
+      // Instances unlink themselves from the BLAS entries, which must still be alive
+      m_instanceManager.clear();
+    }
+
+    Results run() {
+      Results results;
+
+      for (uint32_t frame = 0; frame < m_trace.getFrameCount(); frame++) {
+        uint32_t numRecords;
+        const DrawCallTraceRecord* pRecords = m_trace.getFrameRecords(frame, numRecords);
+
+        // Frame ids start at 1 so that kInvalidFrameIndex never looks like the previous frame
+        m_frameId = frame + 1;
+
+        if (m_frameDrawCalls.size() < numRecords) {
+          m_frameDrawCalls.resize(numRecords);
+        }
+
+        for (uint32_t i = 0; i < numRecords; i++) {
+          DrawCallTrace::restoreDrawCallState(pRecords[i], getInstancesToObject(pRecords[i].numInstances), m_frameDrawCalls[i]);
+        }
+
+        measure(results, BlasLookup, [&] {
+          m_frameBlases.clear();
+          for (uint32_t i = 0; i < numRecords; i++) {
+            m_frameBlases.push_back(&lookupBlas(m_frameDrawCalls[i], pRecords[i]));
+          }
+        });
+
+        measure(results, InstanceMatching, [&] {
+          const uint32_t numInstancesBefore = m_instanceManager.getActiveCount();
+
+          for (uint32_t i = 0; i < numRecords; i++) {
+            // Note: copied for every draw call like the render material is, the instance manager may modify it
+            MaterialData material = getMaterial(pRecords[i].materialHash);
+            const RtInstance* pInstance = m_instanceManager.processSceneObject(m_cameraManager, m_rayPortalManager, *m_frameBlases[i], m_frameDrawCalls[i], material, nullptr);
+
+            const uint64_t instanceId = pInstance->getId();
+            results.checksum = XXH64(&instanceId, sizeof(instanceId), results.checksum);
+          }
+
+          const uint32_t numCreated = m_instanceManager.getActiveCount() - numInstancesBefore;
+          results.numCreated += numCreated;
+          results.numMatched += numRecords - numCreated;
+        });
+
+        measure(results, GarbageCollection, [&] {
+          const uint32_t numInstancesBefore = m_instanceManager.getActiveCount();
+          m_instanceManager.garbageCollection();
+          results.numCollected += numInstancesBefore - m_instanceManager.getActiveCount();
+        });
+
+        measure(results, BucketPlanning, [&] {
+          planBuckets(results);
+        });
+
+        m_instanceManager.onFrameEnd();
+      }
+
+      return results;
+    }
+
+  private:
+    template<typename Fn>
+    static void measure(Results& results, Stage stage, const Fn& fn) {
+      const uint64_t allocationsBefore = s_numAllocations.load(std::memory_order_relaxed);
+      const auto start = std::chrono::high_resolution_clock::now();
+
+      fn();
+
+      const auto end = std::chrono::high_resolution_clock::now();
+      results.stageMs[stage] += std::chrono::duration<double, std::milli>(end - start).count();
+      results.stageAllocations[stage] += s_numAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+    }
+
+    // Point instancer transforms are not recorded, instanced draw calls share identity transforms
+    const std::vector<Matrix4>* getInstancesToObject(uint32_t numInstances) {
+      if (numInstances == 0) {
+        return nullptr;
+      }
+
+      std::vector<Matrix4>& instancesToObject = m_instancesToObject[numInstances];
+      instancesToObject.resize(numInstances);
+      return &instancesToObject;
+    }
+
+    // Stand-in for the render material: the trace only has the legacy material hash, which the albedo constant
+    // encodes so that distinct materials keep distinct hashes
+    const MaterialData& getMaterial(XXH64_hash_t materialHash) {
+      auto iter = m_materials.find(materialHash);
+      if (iter == m_materials.end()) {
+        constexpr uint32_t kChannelBits = 21;
+        constexpr uint64_t kChannelMask = (1ull << kChannelBits) - 1;
+        auto channel = [&](uint32_t index) {
+          return float((materialHash >> (index * kChannelBits)) & kChannelMask) / float(kChannelMask);
+        };
+
+        OpaqueMaterialData opaqueMaterial = LegacyMaterialData().as<OpaqueMaterialData>();
+        opaqueMaterial.setAlbedoConstant(Vector3(channel(0), channel(1), channel(2)));
+        iter = m_materials.emplace(materialHash, MaterialData(opaqueMaterial)).first;
+      }
+
+      return iter->second;
+    }
+
+    BlasEntry& lookupBlas(const DrawCallState& drawCall, const DrawCallTraceRecord& record) {
+      BlasEntry* pBlas = nullptr;
+
+      if (m_drawCallCache.get(drawCall, &pBlas) == DrawCallCache::CacheState::kNew) {
+        initializeBlas(*pBlas, drawCall, record);
+      } else {
+        // Cache the draw state for the next time, like SceneManager::onSceneObjectUpdated()
+        pBlas->input = drawCall;
+      }
+
+      pBlas->frameLastTouched = m_frameId;
+
+      // Skinned geometry is rewritten every frame
+      if (record.numBones > 0) {
+        pBlas->frameLastUpdated = m_frameId;
+      }
+
+      return *pBlas;
+    }
+
+    // Stand-in for the geometry processing of new scene objects and the build geometry of the BLAS entry: no buffers
+    // are bound, so the primitive count comes from the vertex count, and every entry gets distinct device addresses
+    void initializeBlas(BlasEntry& blas, const DrawCallState& drawCall, const DrawCallTraceRecord& record) {
+      const uint32_t numPrimitives = (record.indexCount > 0 ? record.indexCount : record.vertexCount) / 3;
+
+      RaytraceGeometry& geometryData = blas.modifiedGeometryData;
+      geometryData.hashes = drawCall.getGeometryData().hashes;
+      geometryData.vertexCount = numPrimitives * 3;
+
+      VkAccelerationStructureGeometryKHR geometry {};
+      geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+      geometry.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+      geometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+
+      VkAccelerationStructureGeometryTrianglesDataKHR& triangles = geometry.geometry.triangles;
+      triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+      triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+      triangles.vertexStride = sizeof(Vector3);
+      triangles.maxVertex = record.vertexCount > 0 ? record.vertexCount - 1 : 0;
+      triangles.indexType = record.indexCount > 0 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_NONE_KHR;
+      triangles.vertexData.deviceAddress = m_nextDeviceAddress;
+      triangles.indexData.deviceAddress = record.indexCount > 0 ? m_nextDeviceAddress + record.vertexCount * sizeof(Vector3) : 0;
+      m_nextDeviceAddress += record.vertexCount * sizeof(Vector3) + record.indexCount * sizeof(uint16_t);
+
+      VkAccelerationStructureBuildRangeInfoKHR range {};
+      range.primitiveCount = numPrimitives;
+
+      blas.buildGeometries.assign(1, geometry);
+      blas.buildRanges.assign(1, range);
+    }
+
+    // The instance loop of AccelManager::mergeInstancesIntoBlas() without the builds
+    void planBuckets(Results& results) {
+      m_planner.clearMembers();
+
+      for (const RtInstance* pInstance : m_instanceManager.getInstanceTable()) {
+        if (pInstance->isHidden() || pInstance->getVkInstance().mask == 0) {
+          continue;
+        }
+
+        const BlasEntry& blas = *pInstance->getBlas();
+        if (AccelManager::usesDynamicBlas(blas, *pInstance)) {
+          results.numDynamicBlas++;
+          continue;
+        }
+
+        m_planner.addMember(AccelManager::getBlasBucketMember(blas, *pInstance, m_frameId));
+      }
+
+      AccelManager::planBlasBuckets(m_planner, m_blasPool);
+    }
+
+    const DrawCallTrace& m_trace;
+    uint32_t m_frameId = kInvalidFrameIndex;
+
+    DrawCallCache m_drawCallCache { nullptr };
+    CameraManager m_cameraManager { nullptr };
+    RayPortalManager m_rayPortalManager { nullptr, nullptr };
+    InstanceManager m_instanceManager { nullptr, nullptr };
+    AccelManager::BucketPlanner m_planner;
+    std::vector<Rc<PooledBlas>> m_blasPool;
+
+    std::unordered_map<XXH64_hash_t, MaterialData> m_materials;
+    std::unordered_map<uint32_t, std::vector<Matrix4>> m_instancesToObject;
+    VkDeviceAddress m_nextDeviceAddress = 1 << 16;
+
+    std::vector<DrawCallState> m_frameDrawCalls;
+    std::vector<BlasEntry*> m_frameBlases;
+  };
+
+  // Static world geometry, a share of moving objects and objects popping in and out of view
+  static void generateTrace(DrawCallTrace& trace) {
+    constexpr uint32_t kNumFrames = 120;
+    constexpr uint32_t kNumMeshes = 2000;
+    constexpr uint32_t kNumObjects = 20000;
+
+    struct Object {
+      uint32_t mesh;
+      Vector3 position;
+      Vector3 velocity;
+      uint32_t visiblePeriod;  // Visible every frame when 0
+    };
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coord(-5000.f, 5000.f);
+    std::uniform_real_distribution<float> speed(-20.f, 20.f);
+    std::uniform_int_distribution<uint32_t> mesh(0, kNumMeshes - 1);
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+
+    std::vector<Object> objects(kNumObjects);
+    for (Object& object : objects) {
+      object.mesh = mesh(rng);
+      object.position = Vector3(coord(rng), coord(rng), coord(rng) * 0.1f);
+      object.velocity = percent(rng) < 10 ? Vector3(speed(rng), speed(rng), 0.f) : Vector3(0.f);
+      object.visiblePeriod = percent(rng) < 5 ? 2 + percent(rng) % 8 : 0;
+    }
+
+    std::vector<DrawCallTraceRecord> records;
+    std::vector<uint8_t> file;
+    DrawCallTrace::serializeHeader(file);
+
+    for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+      records.clear();
+
+      for (Object& object : objects) {
+        object.position += object.velocity;
+
+        if (object.visiblePeriod != 0 && (frame / object.visiblePeriod) % 2 == 1) {
+          continue;
+        }
+
+        DrawCallTraceRecord record = {};
+        record.geometryHashes[uint32_t(HashComponents::VertexPosition)] = XXH3_64bits(&object.mesh, sizeof(object.mesh));
+        record.geometryHashes[uint32_t(HashComponents::Indices)] = object.mesh;
+        record.materialHash = object.mesh % 97;
+        record.objectToWorld[3] = Vector4(object.position, 1.f);
+        record.objectToView = record.objectToWorld;
+        record.boundingBoxMin = Vector3(-50.f);
+        record.boundingBoxMax = Vector3(50.f);
+        record.cameraType = CameraType::Main;
+        record.vertexCount = 300 + object.mesh % 1200;
+        record.indexCount = record.vertexCount * 3;
+        records.push_back(record);
+      }
+
+      DrawCallTrace::serializeFrame(records.data(), static_cast<uint32_t>(records.size()), file);
+    }
+
+    // Going through the file format keeps the generated trace identical to a loaded one
+    if (!DrawCallTrace::deserialize(file.data(), file.size(), trace) || trace.getFrameCount() != kNumFrames) {
+      throw DxvkError("Generated trace failed to round trip");
+    }
+  }
+
+  static void printResults(const char* name, const SceneIngestBenchmark::Results& results, uint32_t numIterations, uint32_t numFrames) {
+    static const char* kStageNames[] = { "blas lookup", "instance matching", "garbage collection", "bucket planning" };
+
+    std::printf("%s, %u iterations of %u frames\n", name, numIterations, numFrames);
+
+    for (uint32_t stage = 0; stage < SceneIngestBenchmark::StageCount; stage++) {
+      std::printf("  %-20s %9.3f ms/frame %10.1f allocations/frame\n", kStageNames[stage],
+                  results.stageMs[stage] / (numIterations * numFrames),
+                  double(results.stageAllocations[stage]) / (numIterations * numFrames));
+    }
+
+    std::printf("  matched %llu, created %llu, collected %llu, dynamic blas %llu, checksum %016llx\n",
+                (unsigned long long) results.numMatched / numIterations, (unsigned long long) results.numCreated / numIterations,
+                (unsigned long long) results.numCollected / numIterations, (unsigned long long) results.numDynamicBlas / numIterations,
+                (unsigned long long) results.checksum);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  using namespace dxvk;
+
+  try {
+    // Options are read by the managers, resolve them from the system layers like the runtime does
+    RtxOptionLayer::initializeSystemLayers();
+    RtxOptionImpl::setInitialized(true);
+    RtxOptionManager::applyPendingValues(nullptr, false);
+
+    DrawCallTrace trace;
+    std::string name = "synthetic trace";
+
+    if (argc > 1) {
+      name = argv[1];
+      if (!trace.load(name)) {
+        throw DxvkError(str::format("Failed to load draw call trace ", name));
+      }
+    } else {
+      generateTrace(trace);
+    }
+
+    const uint32_t numIterations = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 5;
+
+    // Every iteration starts from an empty scene, the first frame ingests the whole trace's initial scene
+    SceneIngestBenchmark::Results total;
+    XXH64_hash_t checksum = 0;
+
+    for (uint32_t iteration = 0; iteration < numIterations; iteration++) {
+      SceneIngestBenchmark benchmark(trace);
+      const SceneIngestBenchmark::Results results = benchmark.run();
+
+      if (iteration > 0 && results.checksum != checksum) {
+        throw DxvkError("Replay is not deterministic");
+      }
+      checksum = results.checksum;
+
+      for (uint32_t stage = 0; stage < SceneIngestBenchmark::StageCount; stage++) {
+        total.stageMs[stage] += results.stageMs[stage];
+        total.stageAllocations[stage] += results.stageAllocations[stage];
+      }
+      total.numMatched += results.numMatched;
+      total.numCreated += results.numCreated;
+      total.numCollected += results.numCollected;
+      total.numDynamicBlas += results.numDynamicBlas;
+      total.checksum = results.checksum;
+    }
+
+    printResults(name.c_str(), total, numIterations, trace.getFrameCount());
+  }
+  catch (const DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,299 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_blas_bucket_planner.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_blas_bucket_planner.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testSteadyState();
+      testContentChanges();
+      testTableReordering();
+      testMembershipChanges();
+      testBucketRemoval();
+      testMortonCode();
+      testSpatialLimits();
+      testSpatialDeterminism();
+    }
+
+  private:
+    struct BucketData {
+      uint32_t buildCount = 0;
+    };
+
+    using Planner = BlasBucketPlanner<BucketData>;
+
+    struct Instance {
+      uint64_t id;
+      XXH64_hash_t compatibilityKey;
+      XXH64_hash_t layoutHash = 1;
+      XXH64_hash_t contentHash = 1;
+      bool contentUpdated = false;
+      Vector3 position = Vector3(0.f);
+      uint32_t primitiveCount = 100;
+    };
+
+    static void plan(Planner& planner, const std::vector<Instance>& instances, uint32_t* pRemovedCount = nullptr) {
+      planner.clearMembers();
+      for (const Instance& instance : instances) {
+        const AxisAlignedBoundingBox bounds { instance.position - Vector3(1.f), instance.position + Vector3(1.f) };
+        planner.addMember({ instance.id, instance.compatibilityKey, instance.layoutHash, instance.contentHash, instance.contentUpdated,
+                            bounds, instance.primitiveCount });
+      }
+
+      planner.plan([pRemovedCount](BucketData&) {
+        if (pRemovedCount) {
+          (*pRemovedCount)++;
+        }
+      });
+
+      for (uint32_t i = 0; i < planner.getBucketCount(); i++) {
+        if (planner.getBucket(i).getAction() == Planner::Action::Build) {
+          planner.getBucket(i).data.buildCount++;
+        }
+      }
+    }
+
+    static const Planner::Bucket& findBucket(const Planner& planner, XXH64_hash_t compatibilityKey) {
+      for (uint32_t i = 0; i < planner.getBucketCount(); i++) {
+        if (planner.getBucket(i).getCompatibilityKey() == compatibilityKey) {
+          return planner.getBucket(i);
+        }
+      }
+
+      throw DxvkError("Bucket not found");
+    }
+
+    static std::vector<uint64_t> getMemberIds(const Planner& planner, const Planner::Bucket& bucket) {
+      std::vector<uint64_t> ids;
+      for (uint32_t member : bucket.getMembers()) {
+        ids.push_back(planner.getMember(member).instanceId);
+      }
+      return ids;
+    }
+
+    static bool statsEqual(const Planner::Stats& stats, uint32_t built, uint32_t refit, uint32_t reused) {
+      return stats.built == built && stats.refit == refit && stats.reused == reused;
+    }
+
+    void testSteadyState() {
+      Planner planner;
+      std::vector<Instance> instances = { { 1, 10 }, { 2, 20 }, { 3, 10 }, { 4, 30 }, { 5, 20 } };
+
+      plan(planner, instances);
+      expect(planner.getBucketCount() == 3, "Expected one bucket per compatibility key");
+      expect(statsEqual(planner.getStats(), 3, 0, 0), "All buckets should be built on the first frame");
+      expect(getMemberIds(planner, findBucket(planner, 10)) == std::vector<uint64_t>{ 1, 3 }, "Unexpected bucket members");
+
+      for (uint32_t frame = 0; frame < 3; frame++) {
+        plan(planner, instances);
+        expect(statsEqual(planner.getStats(), 0, 0, 3), "Unchanged buckets should be reused");
+      }
+
+      expect(findBucket(planner, 10).data.buildCount == 1, "Bucket data should persist across frames");
+    }
+
+    void testContentChanges() {
+      Planner planner;
+      std::vector<Instance> instances = { { 1, 10 }, { 2, 20 }, { 3, 10 }, { 4, 30 } };
+      plan(planner, instances);
+
+      // Moved instance
+      instances[2].contentHash = 2;
+      plan(planner, instances);
+      expect(statsEqual(planner.getStats(), 0, 1, 2), "A moved instance should only refit its bucket");
+      expect(findBucket(planner, 10).getAction() == Planner::Action::Refit, "Wrong bucket refit");
+
+      // Geometry rewritten in place, with otherwise identical inputs
+      instances[1].contentUpdated = true;
+      plan(planner, instances);
+      expect(statsEqual(planner.getStats(), 0, 1, 2), "Updated geometry should refit its bucket");
+      expect(findBucket(planner, 20).getAction() == Planner::Action::Refit, "Wrong bucket refit");
+      instances[1].contentUpdated = false;
+
+      // Layout change, e.g. a different primitive count
+      instances[3].layoutHash = 2;
+      plan(planner, instances);
+      expect(statsEqual(planner.getStats(), 1, 0, 2), "A layout change should rebuild its bucket");
+      expect(findBucket(planner, 30).getAction() == Planner::Action::Build, "Wrong bucket rebuilt");
+
+      planner.forceBuild(planner.getBucket(0));
+      planner.forceBuild(planner.getBucket(1));
+      planner.forceBuild(planner.getBucket(2));
+      expect(statsEqual(planner.getStats(), 3, 0, 0), "Forced builds should be reflected in the stats");
+    }
+
+    void testTableReordering() {
+      Planner planner;
+      std::vector<Instance> instances = { { 1, 10 }, { 2, 10 }, { 3, 10 }, { 4, 20 } };
+      plan(planner, instances);
+
+      // Same members in a different instance table order
+      std::vector<Instance> reordered = { instances[3], instances[2], instances[0], instances[1] };
+      plan(planner, reordered);
+      expect(statsEqual(planner.getStats(), 0, 0, 2), "Reordering the instance table should not change the buckets");
+      expect(getMemberIds(planner, findBucket(planner, 10)) == std::vector<uint64_t>{ 1, 2, 3 }, "Geometry order should be kept");
+    }
+
+    void testMembershipChanges() {
+      Planner planner;
+      std::vector<Instance> instances = { { 1, 10 }, { 2, 10 }, { 3, 10 }, { 4, 20 } };
+      plan(planner, instances);
+
+      // Swap removal of instance 1 moves the last instance into its place, and a new instance is added
+      std::vector<Instance> changed = { instances[3], instances[1], instances[2], { 5, 10 } };
+      std::swap(changed[0], changed[3]);
+      plan(planner, changed);
+      expect(statsEqual(planner.getStats(), 1, 0, 1), "Only the bucket which changed members should be rebuilt");
+      expect(getMemberIds(planner, findBucket(planner, 10)) == std::vector<uint64_t>{ 2, 3, 5 }, "Remaining members should keep their order");
+
+      plan(planner, changed);
+      expect(statsEqual(planner.getStats(), 0, 0, 2), "Buckets should be reused once membership is stable");
+      expect(findBucket(planner, 10).data.buildCount == 2, "Unexpected number of builds");
+    }
+
+    void testBucketRemoval() {
+      Planner planner;
+      std::vector<Instance> instances = { { 1, 10 }, { 2, 20 }, { 3, 30 } };
+      plan(planner, instances);
+
+      uint32_t removedCount = 0;
+      plan(planner, { { 3, 30 } }, &removedCount);
+      expect(removedCount == 2 && planner.getBucketCount() == 1, "Empty buckets should be removed");
+      expect(statsEqual(planner.getStats(), 0, 0, 1), "The remaining bucket should be reused");
+
+      plan(planner, { { 3, 30 }, { 1, 10 } });
+      expect(planner.getBucketCount() == 2 && findBucket(planner, 10).getAction() == Planner::Action::Build, "Recreated bucket should be built");
+
+      removedCount = 0;
+      planner.clear([&removedCount](BucketData&) { removedCount++; });
+      expect(removedCount == 2 && planner.getBucketCount() == 0, "Clear should remove all buckets");
+    }
+
+    void testMortonCode() {
+      expect(Planner::getMortonCode(1, 0, 0) == 1 && Planner::getMortonCode(0, 1, 0) == 2 && Planner::getMortonCode(0, 0, 1) == 4,
+             "Morton code should interleave x, y and z");
+      expect(Planner::getMortonCode(3, 3, 3) == 63, "Unexpected Morton code");
+      expect(Planner::getMortonCode(0x1fffff, 0x1fffff, 0x1fffff) == (1ull << 63) - 1, "Morton code should use 21 bits per axis");
+    }
+
+    // Instances on a 16x16 grid, 100 units apart, in a shuffled table order
+    static std::vector<Instance> createGrid(uint32_t seed) {
+      std::vector<Instance> instances;
+      for (uint32_t y = 0; y < 16; y++) {
+        for (uint32_t x = 0; x < 16; x++) {
+          Instance instance { y * 16 + x, x % 2 == 0 ? 10u : 20u };
+          instance.position = Vector3(x * 100.f, y * 100.f, 0.f);
+          instances.push_back(instance);
+        }
+      }
+
+      std::shuffle(instances.begin(), instances.end(), std::mt19937(seed));
+      return instances;
+    }
+
+    void testSpatialLimits() {
+      const std::vector<Instance> instances = createGrid(1);
+
+      Planner planner;
+      plan(planner, instances);
+      expect(planner.getBucketCount() == 2, "Expected one bucket per compatibility key without spatial bucketing");
+      const double unboundedArea = planner.getStats().boundsSurfaceArea;
+
+      Planner::SpatialSettings settings;
+      settings.enable = true;
+      settings.maxExtent = 350.f;
+      settings.maxPrimitives = 800;
+      planner.setSpatialSettings(settings);
+      plan(planner, instances);
+
+      expect(planner.getBucketCount() > 2, "Spatial bucketing should split the buckets");
+      expect(planner.getStats().boundsSurfaceArea < unboundedArea * 0.5, "Spatial buckets should overlap much less");
+
+      for (uint32_t i = 0; i < planner.getBucketCount(); i++) {
+        const Planner::Bucket& bucket = planner.getBucket(i);
+        const Vector3 size = bucket.getBounds().maxPos - bucket.getBounds().minPos;
+        expect(std::max({ size.x, size.y, size.z }) <= settings.maxExtent, "Bucket exceeds the maximum extent");
+        expect(bucket.getMembers().size() * 100 <= settings.maxPrimitives, "Bucket exceeds the maximum primitive count");
+
+        for (uint32_t member : bucket.getMembers()) {
+          expect(planner.getMember(member).compatibilityKey == bucket.getCompatibilityKey(), "Incompatible instances in a bucket");
+        }
+      }
+
+      plan(planner, instances);
+      expect(statsEqual(planner.getStats(), 0, 0, planner.getBucketCount()), "Spatial buckets should be reused");
+    }
+
+    void testSpatialDeterminism() {
+      Planner::SpatialSettings settings;
+      settings.enable = true;
+      settings.maxExtent = 350.f;
+
+      auto getGrouping = [&settings](const std::vector<Instance>& instances) {
+        Planner planner;
+        planner.setSpatialSettings(settings);
+        plan(planner, instances);
+
+        std::vector<std::vector<uint64_t>> grouping;
+        for (uint32_t i = 0; i < planner.getBucketCount(); i++) {
+          std::vector<uint64_t> ids = getMemberIds(planner, planner.getBucket(i));
+          std::sort(ids.begin(), ids.end());
+          grouping.push_back(ids);
+        }
+        std::sort(grouping.begin(), grouping.end());
+        return grouping;
+      };
+
+      expect(getGrouping(createGrid(1)) == getGrouping(createGrid(2)), "Grouping should not depend on the instance table order");
+
+      // Instances moving within a bucket keep the grouping stable
+      Planner planner;
+      planner.setSpatialSettings(settings);
+      std::vector<Instance> instances = createGrid(3);
+      plan(planner, instances);
+
+      for (Instance& instance : instances) {
+        if (instance.id == 17) {
+          instance.position.x += 10.f;
+          instance.contentHash = 2;
+        }
+      }
+      plan(planner, instances);
+      expect(planner.getStats().built == 0 && planner.getStats().refit == 1, "A small move should only refit its bucket");
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cstring>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_draw_call_trace.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_draw_call_trace.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testRoundTrip();
+      testTruncatedFrame();
+      testDamagedFile();
+    }
+
+  private:
+    static std::vector<DrawCallTraceRecord> createRecords(uint32_t count, uint32_t seed) {
+      std::vector<DrawCallTraceRecord> records(count);
+      for (uint32_t i = 0; i < count; i++) {
+        DrawCallTraceRecord& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+        record.geometryHashes[uint32_t(HashComponents::VertexPosition)] = seed * 1000 + i;
+        record.materialHash = seed;
+        record.objectToWorld[3] = Vector4(float(i), float(seed), 0.f, 1.f);
+        record.vertexCount = i;
+      }
+      return records;
+    }
+
+    static std::vector<uint8_t> createFile(const std::vector<std::vector<DrawCallTraceRecord>>& frames) {
+      std::vector<uint8_t> file;
+      DrawCallTrace::serializeHeader(file);
+      for (const auto& records : frames) {
+        DrawCallTrace::serializeFrame(records.data(), static_cast<uint32_t>(records.size()), file);
+      }
+      return file;
+    }
+
+    void testRoundTrip() {
+      const std::vector<std::vector<DrawCallTraceRecord>> frames = { createRecords(3, 1), createRecords(0, 2), createRecords(5, 3) };
+      const std::vector<uint8_t> file = createFile(frames);
+
+      DrawCallTrace trace;
+      expect(DrawCallTrace::deserialize(file.data(), file.size(), trace), "Valid trace failed to deserialize");
+      expect(trace.getFrameCount() == frames.size(), "Frame count mismatch");
+      expect(trace.getRecordCount() == 8, "Record count mismatch");
+
+      for (uint32_t frame = 0; frame < frames.size(); frame++) {
+        uint32_t numRecords;
+        const DrawCallTraceRecord* pRecords = trace.getFrameRecords(frame, numRecords);
+        expect(numRecords == frames[frame].size(), "Frame record count mismatch");
+        expect(numRecords == 0 || std::memcmp(pRecords, frames[frame].data(), numRecords * sizeof(DrawCallTraceRecord)) == 0, "Record contents mismatch");
+      }
+    }
+
+    void testTruncatedFrame() {
+      // A recording process terminated mid frame leaves a partial frame behind, the complete frames remain usable
+      std::vector<uint8_t> file = createFile({ createRecords(4, 1), createRecords(4, 2) });
+      file.resize(file.size() - sizeof(DrawCallTraceRecord) / 2);
+
+      DrawCallTrace trace;
+      expect(DrawCallTrace::deserialize(file.data(), file.size(), trace), "Truncated trace failed to deserialize");
+      expect(trace.getFrameCount() == 1, "Partial frame was not ignored");
+    }
+
+    void testDamagedFile() {
+      const std::vector<uint8_t> file = createFile({ createRecords(4, 1) });
+      DrawCallTrace trace;
+
+      std::vector<uint8_t> damaged = file;
+      damaged.back() ^= 0xff;
+      expect(!DrawCallTrace::deserialize(damaged.data(), damaged.size(), trace), "Damaged record accepted");
+      expect(trace.getFrameCount() == 0, "Rejected trace was not cleared");
+
+      damaged = file;
+      damaged[0] = 'X';
+      expect(!DrawCallTrace::deserialize(damaged.data(), damaged.size(), trace), "Wrong magic accepted");
+
+      expect(!DrawCallTrace::deserialize(file.data(), 8, trace), "Truncated header accepted");
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
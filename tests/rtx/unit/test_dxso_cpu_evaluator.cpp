@@ -0,0 +1,644 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cfloat>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include "../../test_utils.h"
+#include "../../../src/dxso/dxso_cpu_evaluator.h"
+#include "../../../src/dxso/dxso_cpu_fixture.h"
+#include "../../../src/util/util_env.h"
+#include "../../../src/util/util_timer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_dxso_cpu_evaluator.log");
+}
+
+namespace dxvk {
+
+  // Minimal DXSO token writer, enough to hand-assemble test shaders
+  class DxsoAssembler {
+  public:
+    static constexpr uint32_t SwzXYZW = 0xE4;
+    static constexpr uint32_t SwzX    = 0x00;
+    static constexpr uint32_t SwzY    = 0x55;
+    static constexpr uint32_t SwzZ    = 0xAA;
+    static constexpr uint32_t SwzW    = 0xFF;
+
+    DxsoAssembler(uint32_t major, uint32_t minor) : m_major(major) {
+      m_tokens.push_back(0xFFFE0000u | (major << 8) | minor);
+    }
+
+    static uint32_t reg(DxsoRegisterType type, uint32_t num) {
+      const uint32_t t = uint32_t(type);
+      return 0x80000000u | ((t & 0x7) << 28) | ((t & 0x18) << 8) | num;
+    }
+
+    static uint32_t dst(DxsoRegisterType type, uint32_t num, uint32_t mask = 0xf, bool saturate = false) {
+      return reg(type, num) | (mask << 16) | (saturate ? (1u << 20) : 0u);
+    }
+
+    static uint32_t src(DxsoRegisterType type, uint32_t num, uint32_t swizzle = SwzXYZW,
+                        DxsoRegModifier modifier = DxsoRegModifier::None) {
+      return reg(type, num) | (swizzle << 16) | (uint32_t(modifier) << 24);
+    }
+
+    static uint32_t relative(uint32_t token) {
+      return token | (1u << 13);
+    }
+
+    void op(DxsoOpcode opcode, std::initializer_list<uint32_t> args) {
+      const uint32_t length = m_major >= 2 ? uint32_t(args.size()) << 24 : 0u;
+      m_tokens.push_back(uint32_t(opcode) | length);
+      m_tokens.insert(m_tokens.end(), args.begin(), args.end());
+    }
+
+    void dcl(DxsoUsage usage, uint32_t usageIndex, uint32_t dstToken) {
+      op(DxsoOpcode::Dcl, { 0x80000000u | uint32_t(usage) | (usageIndex << 16), dstToken });
+    }
+
+    void def(uint32_t num, float x, float y, float z, float w) {
+      const float values[4] = { x, y, z, w };
+      uint32_t bits[4];
+      std::memcpy(bits, values, sizeof(bits));
+      op(DxsoOpcode::Def, { dst(DxsoRegisterType::Const, num), bits[0], bits[1], bits[2], bits[3] });
+    }
+
+    const uint32_t* finish() {
+      m_tokens.push_back(0x0000FFFFu);
+      return m_tokens.data();
+    }
+
+  private:
+    uint32_t              m_major;
+    std::vector<uint32_t> m_tokens;
+  };
+
+  using R = DxsoRegisterType;
+  using A = DxsoAssembler;
+
+  class TestApp {
+  public:
+    static float dot3(const Vector4& a, const Vector4& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    static float dot4(const Vector4& a, const Vector4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+    static void expectNear(const Vector4& actual, const Vector4& expected, float tolerance, const char* what, uint32_t vertex) {
+      for (uint32_t c = 0; c < 4; c++) {
+        if (actual[c] == expected[c])
+          continue;
+
+        const float scale = std::max(1.0f, std::abs(expected[c]));
+        if (!(std::abs(actual[c] - expected[c]) <= tolerance * scale)) {
+          throw DxvkError(str::format("Mismatch in ", what, " for vertex ", vertex, " component ", c,
+                                      ": expected ", expected[c], " got ", actual[c]));
+        }
+      }
+    }
+
+    static void expectNear(const Vector3& actual, const Vector3& expected, float tolerance, const char* what, uint32_t vertex) {
+      expectNear(Vector4(actual, 0.0f), Vector4(expected, 0.0f), tolerance, what, vertex);
+    }
+
+    struct TransformVertex {
+      float    position[3];
+      float    normal[3];
+      uint32_t color;
+      float    texcoord[2];
+    };
+
+    void run() {
+      testTransform();
+      testSkinning();
+      testArithmetic();
+      testStrictMultiply();
+      testUnsupported();
+      testCaptureVertices();
+      testFixtureSerialization();
+      testRecordedFixtures();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    std::mt19937 m_rng { 1234 };
+
+    float random(float lo, float hi) {
+      return std::uniform_real_distribution<float>(lo, hi)(m_rng);
+    }
+
+    void testTransform() {
+      A a(1, 1);
+      a.dcl(DxsoUsage::Position, 0, A::dst(R::Input, 0));
+      a.dcl(DxsoUsage::Normal,   0, A::dst(R::Input, 1));
+      a.dcl(DxsoUsage::Color,    0, A::dst(R::Input, 2));
+      a.dcl(DxsoUsage::Texcoord, 0, A::dst(R::Input, 3));
+      a.def(8, 0.0f, 0.0f, 0.0f, 0.0f);
+      a.op(DxsoOpcode::M4x4, { A::dst(R::RasterizerOut, RasterOutPosition), A::src(R::Input, 0), A::src(R::Const, 0) });
+      a.op(DxsoOpcode::M3x3, { A::dst(R::Temp, 0, 0x7), A::src(R::Input, 1), A::src(R::Const, 4) });
+      a.op(DxsoOpcode::Dp3,  { A::dst(R::Temp, 1, 0x1), A::src(R::Temp, 0), A::src(R::Temp, 0) });
+      a.op(DxsoOpcode::Rsq,  { A::dst(R::Temp, 1, 0x1), A::src(R::Temp, 1, A::SwzX) });
+      a.op(DxsoOpcode::Mul,  { A::dst(R::Temp, 0, 0x7), A::src(R::Temp, 0), A::src(R::Temp, 1, A::SwzX) });
+      a.op(DxsoOpcode::Dp3,  { A::dst(R::Temp, 2, 0x1), A::src(R::Temp, 0), A::src(R::Const, 7, A::SwzXYZW, DxsoRegModifier::Neg) });
+      a.op(DxsoOpcode::Max,  { A::dst(R::Temp, 2, 0x1), A::src(R::Temp, 2, A::SwzX), A::src(R::Const, 8, A::SwzX) });
+      a.op(DxsoOpcode::Mul,  { A::dst(R::AttributeOut, 0, 0xf, true), A::src(R::Input, 2), A::src(R::Temp, 2, A::SwzX) });
+      a.op(DxsoOpcode::Mov,  { A::dst(R::TexcoordOut, 0, 0x3), A::src(R::Input, 3) });
+
+      auto shader = DxsoCpuShader::create(a.finish(), DxsoCpuShaderOptions());
+      if (shader == nullptr)
+        throw DxvkError("Transform shader was rejected");
+
+      // c0-c3 world-view-projection rows, c4-c6 normal matrix rows,
+      // c7 light direction, c8 is shadowed by the def above.
+      std::vector<Vector4> constants(9);
+      for (uint32_t i = 0; i < 7; i++)
+        constants[i] = Vector4(random(-2.0f, 2.0f), random(-2.0f, 2.0f), random(-2.0f, 2.0f), random(-2.0f, 2.0f));
+      constants[7] = Vector4(0.3f, -0.8f, 0.52f, 0.0f);
+      constants[8] = Vector4(100.0f);
+
+      // Odd count to exercise the partial tail batch
+      const uint32_t vertexCount = 1023;
+      std::vector<TransformVertex> vertices(vertexCount);
+      for (auto& v : vertices) {
+        for (float& p : v.position) p = random(-10.0f, 10.0f);
+        for (float& n : v.normal)   n = random(-1.0f, 1.0f);
+        v.color = m_rng();
+        v.texcoord[0] = random(0.0f, 1.0f);
+        v.texcoord[1] = random(0.0f, 1.0f);
+      }
+
+      const uint8_t* base = reinterpret_cast<const uint8_t*>(vertices.data());
+      std::vector<DxsoCpuInputStream> inputs;
+      for (const DxsoSemantic& semantic : shader->inputs()) {
+        DxsoCpuInputStream stream;
+        stream.stride = sizeof(TransformVertex);
+        switch (semantic.usage) {
+          case DxsoUsage::Position: stream.data = base + offsetof(TransformVertex, position); stream.format = DxsoCpuInputFormat::Float3; break;
+          case DxsoUsage::Normal:   stream.data = base + offsetof(TransformVertex, normal);   stream.format = DxsoCpuInputFormat::Float3; break;
+          case DxsoUsage::Color:    stream.data = base + offsetof(TransformVertex, color);    stream.format = DxsoCpuInputFormat::Color;  break;
+          case DxsoUsage::Texcoord: stream.data = base + offsetof(TransformVertex, texcoord); stream.format = DxsoCpuInputFormat::Float2; break;
+          default: throw DxvkError("Unexpected input semantic");
+        }
+        inputs.push_back(stream);
+      }
+
+      std::vector<Vector4> position(vertexCount), color(vertexCount), texcoord(vertexCount), normal(vertexCount);
+      DxsoCpuOutputStream outputs[4];
+      outputs[0].semantic = { DxsoUsage::Position, 0 }; outputs[0].data = position.data();
+      outputs[1].semantic = { DxsoUsage::Color, 0 };    outputs[1].data = color.data();
+      outputs[2].semantic = { DxsoUsage::Texcoord, 0 }; outputs[2].data = texcoord.data();
+      outputs[3].semantic = { DxsoUsage::Normal, 0 };   outputs[3].data = normal.data(); outputs[3].fromInput = true;
+
+      shader->evaluate(vertexCount, inputs.data(), constants.data(), uint32_t(constants.size()), outputs, 4);
+
+      for (uint32_t i = 0; i < vertexCount; i++) {
+        const TransformVertex& v = vertices[i];
+        const Vector4 pos(v.position[0], v.position[1], v.position[2], 1.0f);
+        const Vector4 nrm(v.normal[0], v.normal[1], v.normal[2], 1.0f);
+        const Vector4 col(float((v.color >> 16) & 0xff) / 255.0f, float((v.color >> 8) & 0xff) / 255.0f,
+                          float(v.color & 0xff) / 255.0f, float(v.color >> 24) / 255.0f);
+
+        Vector4 expectedPosition(dot4(pos, constants[0]), dot4(pos, constants[1]), dot4(pos, constants[2]), dot4(pos, constants[3]));
+
+        Vector4 n(dot3(nrm, constants[4]), dot3(nrm, constants[5]), dot3(nrm, constants[6]), 0.0f);
+        const float scale = 1.0f / std::sqrt(dot3(n, n));
+        n = n * scale;
+
+        const float diffuse = std::max(-dot3(n, constants[7]), 0.0f);
+        Vector4 expectedColor;
+        for (uint32_t c = 0; c < 4; c++)
+          expectedColor[c] = std::min(std::max(col[c] * diffuse, 0.0f), 1.0f);
+
+        expectNear(position[i], expectedPosition, 1e-5f, "transform position", i);
+        expectNear(color[i], expectedColor, 1e-5f, "transform color", i);
+        expectNear(texcoord[i], Vector4(v.texcoord[0], v.texcoord[1], 0.0f, 0.0f), 0.0f, "transform texcoord", i);
+        expectNear(normal[i], nrm, 0.0f, "pass-through normal", i);
+      }
+
+      std::cout << "Running: 1M vertices through vs_1_1 transform --> ";
+      {
+        Timer time;
+        for (uint32_t i = 0; i < 1024; i++)
+          shader->evaluate(vertexCount, inputs.data(), constants.data(), uint32_t(constants.size()), outputs, 3);
+      }
+    }
+
+    struct SkinnedVertex {
+      float   position[3];
+      uint8_t indices[4];
+      float   weights[2];
+    };
+
+    void testSkinning() {
+      // vs_2_0, two bones addressed through a0, 3 rows per bone from c16
+      A a(2, 0);
+      a.dcl(DxsoUsage::Position,     0, A::dst(R::Input, 0));
+      a.dcl(DxsoUsage::BlendIndices, 0, A::dst(R::Input, 1));
+      a.dcl(DxsoUsage::BlendWeight,  0, A::dst(R::Input, 2));
+      a.def(12, 3.0f, 0.0f, 0.0f, 1.0f);
+      a.op(DxsoOpcode::Mul,  { A::dst(R::Temp, 0, 0x3), A::src(R::Input, 1), A::src(R::Const, 12, A::SwzX) });
+      a.op(DxsoOpcode::Mova, { A::dst(R::Addr, 0, 0x3), A::src(R::Temp, 0) });
+      for (uint32_t bone = 0; bone < 2; bone++) {
+        const uint32_t swz = bone == 0 ? A::SwzX : A::SwzY;
+        for (uint32_t row = 0; row < 3; row++) {
+          a.op(DxsoOpcode::Dp4, { A::dst(R::Temp, 1 + bone, 1u << row), A::src(R::Input, 0),
+                                  A::relative(A::src(R::Const, 16 + row)), A::reg(R::Addr, 0) | (swz << 16) });
+        }
+      }
+      a.op(DxsoOpcode::Mul, { A::dst(R::Temp, 3, 0x7), A::src(R::Temp, 1), A::src(R::Input, 2, A::SwzX) });
+      a.op(DxsoOpcode::Mad, { A::dst(R::Temp, 3, 0x7), A::src(R::Temp, 2), A::src(R::Input, 2, A::SwzY), A::src(R::Temp, 3) });
+      a.op(DxsoOpcode::Mov, { A::dst(R::Temp, 3, 0x8), A::src(R::Const, 12, A::SwzW) });
+      a.op(DxsoOpcode::M4x4, { A::dst(R::RasterizerOut, RasterOutPosition), A::src(R::Temp, 3), A::src(R::Const, 0) });
+
+      auto shader = DxsoCpuShader::create(a.finish(), DxsoCpuShaderOptions());
+      if (shader == nullptr)
+        throw DxvkError("Skinning shader was rejected");
+
+      if (shader->maxConstantIndex() != UINT32_MAX)
+        throw DxvkError("Relative constant access not reported");
+
+      const uint32_t boneCount = 20;
+      std::vector<Vector4> constants(16 + boneCount * 3);
+      for (auto& c : constants)
+        c = Vector4(random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f));
+
+      const uint32_t vertexCount = 777;
+      std::vector<SkinnedVertex> vertices(vertexCount);
+      for (auto& v : vertices) {
+        for (float& p : v.position) p = random(-5.0f, 5.0f);
+        v.indices[0] = uint8_t(m_rng() % boneCount);
+        v.indices[1] = uint8_t(m_rng() % boneCount);
+        // Out of range bone index must read zeros
+        v.indices[2] = v.indices[3] = 255;
+        v.weights[0] = random(0.0f, 1.0f);
+        v.weights[1] = 1.0f - v.weights[0];
+      }
+      vertices[5].indices[1] = 200;
+
+      const uint8_t* base = reinterpret_cast<const uint8_t*>(vertices.data());
+      DxsoCpuInputStream inputs[3];
+      inputs[0] = { base + offsetof(SkinnedVertex, position), sizeof(SkinnedVertex), DxsoCpuInputFormat::Float3 };
+      inputs[1] = { base + offsetof(SkinnedVertex, indices),  sizeof(SkinnedVertex), DxsoCpuInputFormat::UByte4 };
+      inputs[2] = { base + offsetof(SkinnedVertex, weights),  sizeof(SkinnedVertex), DxsoCpuInputFormat::Float2 };
+
+      std::vector<Vector4> position(vertexCount);
+      DxsoCpuOutputStream output;
+      output.data = position.data();
+
+      shader->evaluate(vertexCount, inputs, constants.data(), uint32_t(constants.size()), &output, 1);
+
+      auto boneRow = [&] (uint32_t index, uint32_t row) {
+        const uint32_t c = 16 + index * 3 + row;
+        return c < constants.size() ? constants[c] : Vector4(0.0f);
+      };
+
+      for (uint32_t i = 0; i < vertexCount; i++) {
+        const SkinnedVertex& v = vertices[i];
+        const Vector4 pos(v.position[0], v.position[1], v.position[2], 1.0f);
+
+        Vector4 skinned(0.0f, 0.0f, 0.0f, 1.0f);
+        for (uint32_t row = 0; row < 3; row++) {
+          skinned[row] = dot4(pos, boneRow(v.indices[0], row)) * v.weights[0]
+                       + dot4(pos, boneRow(v.indices[1], row)) * v.weights[1];
+        }
+
+        const Vector4 expected(dot4(skinned, constants[0]), dot4(skinned, constants[1]),
+                               dot4(skinned, constants[2]), dot4(skinned, constants[3]));
+        expectNear(position[i], expected, 1e-5f, "skinned position", i);
+      }
+    }
+
+    void testArithmetic() {
+      // vs_3_0 with declared outputs, one op family per output register
+      A a(3, 0);
+      a.dcl(DxsoUsage::Position, 0, A::dst(R::Input, 0));
+      a.dcl(DxsoUsage::Texcoord, 0, A::dst(R::Input, 1));
+      a.dcl(DxsoUsage::Position, 0, A::dst(R::Output, 0));
+      for (uint32_t i = 0; i < 5; i++)
+        a.dcl(DxsoUsage::Texcoord, i, A::dst(R::Output, 1 + i));
+      a.def(0, 0.5f, 2.0f, -1.5f, 0.0f);
+
+      // o0 = v0
+      a.op(DxsoOpcode::Mov,    { A::dst(R::Output, 0), A::src(R::Input, 0) });
+      // o1 = sincos(v0.x).xy, exp(v0.y), log(v0.z)
+      a.op(DxsoOpcode::SinCos, { A::dst(R::Output, 1, 0x3), A::src(R::Input, 0, A::SwzX) });
+      a.op(DxsoOpcode::Exp,    { A::dst(R::Output, 1, 0x4), A::src(R::Input, 0, A::SwzY) });
+      a.op(DxsoOpcode::Log,    { A::dst(R::Output, 1, 0x8), A::src(R::Input, 0, A::SwzZ) });
+      // o2 = lit(v1)
+      a.op(DxsoOpcode::Lit,    { A::dst(R::Output, 2), A::src(R::Input, 1) });
+      // o3 = frc(v0).x, pow(|v0.y|, c0.y), slt(v0.z, v1.z), sge(v0.w, v1.w)
+      a.op(DxsoOpcode::Frc,    { A::dst(R::Output, 3, 0x1), A::src(R::Input, 0) });
+      a.op(DxsoOpcode::Pow,    { A::dst(R::Output, 3, 0x2), A::src(R::Input, 0, A::SwzY), A::src(R::Const, 0, A::SwzY) });
+      a.op(DxsoOpcode::Slt,    { A::dst(R::Output, 3, 0x4), A::src(R::Input, 0), A::src(R::Input, 1) });
+      a.op(DxsoOpcode::Sge,    { A::dst(R::Output, 3, 0x8), A::src(R::Input, 0), A::src(R::Input, 1) });
+      // o4.xyz = crs(nrm(v0), v1), o4.w = sgn(v0.x)
+      a.op(DxsoOpcode::Nrm,    { A::dst(R::Temp, 0, 0x7), A::src(R::Input, 0) });
+      a.op(DxsoOpcode::Crs,    { A::dst(R::Output, 4, 0x7), A::src(R::Temp, 0), A::src(R::Input, 1) });
+      a.op(DxsoOpcode::Sgn,    { A::dst(R::Output, 4, 0x8), A::src(R::Input, 0, A::SwzX) });
+      // o5 = lrp(c0.x, |v0|, -v1), dst is checked separately via o5.w
+      a.op(DxsoOpcode::Lrp,    { A::dst(R::Output, 5, 0x7), A::src(R::Const, 0, A::SwzX), A::src(R::Input, 0, A::SwzXYZW, DxsoRegModifier::Abs),
+                                 A::src(R::Input, 1, A::SwzXYZW, DxsoRegModifier::Neg) });
+      a.op(DxsoOpcode::Min,    { A::dst(R::Output, 5, 0x8), A::src(R::Input, 0, A::SwzW), A::src(R::Input, 1, A::SwzW) });
+
+      auto shader = DxsoCpuShader::create(a.finish(), DxsoCpuShaderOptions());
+      if (shader == nullptr)
+        throw DxvkError("Arithmetic shader was rejected");
+
+      const uint32_t vertexCount = 257;
+      std::vector<Vector4> v0(vertexCount), v1(vertexCount);
+      for (uint32_t i = 0; i < vertexCount; i++) {
+        v0[i] = Vector4(random(-4.0f, 4.0f), random(-4.0f, 4.0f), random(-4.0f, 4.0f), random(-4.0f, 4.0f));
+        v1[i] = Vector4(random(-4.0f, 4.0f), random(-4.0f, 4.0f), random(-4.0f, 4.0f), random(-4.0f, 4.0f));
+      }
+
+      DxsoCpuInputStream inputs[2];
+      inputs[0] = { reinterpret_cast<const uint8_t*>(v0.data()), sizeof(Vector4), DxsoCpuInputFormat::Float4 };
+      inputs[1] = { reinterpret_cast<const uint8_t*>(v1.data()), sizeof(Vector4), DxsoCpuInputFormat::Float4 };
+
+      std::vector<Vector4> results[6];
+      DxsoCpuOutputStream outputs[6];
+      for (uint32_t i = 0; i < 6; i++) {
+        results[i].resize(vertexCount);
+        outputs[i].semantic = i == 0 ? DxsoSemantic{ DxsoUsage::Position, 0 } : DxsoSemantic{ DxsoUsage::Texcoord, i - 1 };
+        outputs[i].data = results[i].data();
+      }
+
+      shader->evaluate(vertexCount, inputs, nullptr, 0, outputs, 6);
+
+      for (uint32_t i = 0; i < vertexCount; i++) {
+        const Vector4& a0 = v0[i];
+        const Vector4& a1 = v1[i];
+
+        expectNear(results[0][i], a0, 0.0f, "mov", i);
+
+        expectNear(results[1][i], Vector4(std::cos(a0.x), std::sin(a0.x), std::exp2(a0.y), std::log2(std::abs(a0.z))), 1e-5f, "sincos/exp/log", i);
+
+        const float litZ = (a1.x >= 0.0f && a1.y >= 0.0f)
+          ? std::pow(std::max(a1.y, 0.0f), std::min(std::max(a1.w, -127.9961f), 127.9961f)) : 0.0f;
+        expectNear(results[2][i], Vector4(1.0f, std::max(a1.x, 0.0f), litZ, 1.0f), 1e-5f, "lit", i);
+
+        expectNear(results[3][i], Vector4(a0.x - std::floor(a0.x), std::pow(std::abs(a0.y), 2.0f),
+                                          a0.z < a1.z ? 1.0f : 0.0f, a0.w >= a1.w ? 1.0f : 0.0f), 1e-5f, "frc/pow/slt/sge", i);
+
+        const float rsq = 1.0f / std::sqrt(dot3(a0, a0));
+        const Vector4 n = a0 * rsq;
+        const Vector4 cross(n.y * a1.z - n.z * a1.y, n.z * a1.x - n.x * a1.z, n.x * a1.y - n.y * a1.x,
+                            float((a0.x > 0.0f) - (a0.x < 0.0f)));
+        expectNear(results[4][i], cross, 1e-5f, "nrm/crs/sgn", i);
+
+        Vector4 lerp;
+        for (uint32_t c = 0; c < 3; c++)
+          lerp[c] = -a1[c] + 0.5f * (std::abs(a0[c]) + a1[c]);
+        lerp.w = std::min(a0.w, a1.w);
+        expectNear(results[5][i], lerp, 1e-5f, "lrp/min", i);
+      }
+    }
+
+    void testStrictMultiply() {
+      A a(2, 0);
+      a.dcl(DxsoUsage::Position, 0, A::dst(R::Input, 0));
+      a.op(DxsoOpcode::Mul, { A::dst(R::RasterizerOut, RasterOutPosition), A::src(R::Input, 0), A::src(R::Const, 0) });
+
+      Vector4 constants[1] = { Vector4(INFINITY, 2.0f, 0.0f, INFINITY) };
+      Vector4 input(0.0f, 3.0f, INFINITY, 1.0f);
+      Vector4 result;
+
+      DxsoCpuInputStream stream = { reinterpret_cast<const uint8_t*>(&input), sizeof(Vector4), DxsoCpuInputFormat::Float4 };
+      DxsoCpuOutputStream output;
+      output.data = &result;
+
+      DxsoCpuShaderOptions options;
+      options.mulZeroIsZero = true;
+
+      auto strict = DxsoCpuShader::create(a.finish(), options);
+      strict->evaluate(1, &stream, constants, 1, &output, 1);
+      expectNear(result, Vector4(0.0f, 6.0f, 0.0f, INFINITY), 0.0f, "strict mul", 0);
+    }
+
+    void testUnsupported() {
+      // Flow control is left to the GPU
+      A a(3, 0);
+      a.dcl(DxsoUsage::Position, 0, A::dst(R::Input, 0));
+      a.dcl(DxsoUsage::Position, 0, A::dst(R::Output, 0));
+      a.op(DxsoOpcode::If, { A::src(R::ConstBool, 0) });
+      a.op(DxsoOpcode::Mov, { A::dst(R::Output, 0), A::src(R::Input, 0) });
+      a.op(DxsoOpcode::EndIf, { });
+
+      if (DxsoCpuShader::create(a.finish(), DxsoCpuShaderOptions()) != nullptr)
+        throw DxvkError("Shader with flow control was accepted");
+    }
+
+    static void assembleCaptureShader(A& a) {
+      // vs_2_0 with all the attributes vertex capture looks at
+      a.dcl(DxsoUsage::Position, 0, A::dst(R::Input, 0));
+      a.dcl(DxsoUsage::Normal,   0, A::dst(R::Input, 1));
+      a.dcl(DxsoUsage::Texcoord, 0, A::dst(R::Input, 2));
+      a.dcl(DxsoUsage::Color,    0, A::dst(R::Input, 3));
+      a.op(DxsoOpcode::M4x4, { A::dst(R::RasterizerOut, RasterOutPosition), A::src(R::Input, 0), A::src(R::Const, 0) });
+      a.op(DxsoOpcode::Mov,  { A::dst(R::TexcoordOut, 0, 0x3), A::src(R::Input, 2) });
+      a.op(DxsoOpcode::Mov,  { A::dst(R::AttributeOut, 0), A::src(R::Input, 3) });
+    }
+
+    static void makeCaptureFixture(std::mt19937& rng, uint32_t vertexCount, DxsoVertexCaptureFixture& fixture) {
+      A a(2, 0);
+      assembleCaptureShader(a);
+      const uint32_t* pTokens = a.finish();
+      const uint32_t* pEnd = pTokens;
+      while (*pEnd != 0x0000FFFFu)
+        pEnd++;
+
+      const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(pTokens);
+      fixture.bytecode.assign(pBytes, reinterpret_cast<const uint8_t*>(pEnd + 1));
+
+      auto random = [&rng] (float lo, float hi) {
+        return std::uniform_real_distribution<float>(lo, hi)(rng);
+      };
+
+      // Interleaved float3 position, float3 normal, float2 texcoord, D3DCOLOR
+      const uint32_t stride = 36;
+      fixture.inputs = { { 0, stride, DxsoCpuInputFormat::Float3 }, { 12, stride, DxsoCpuInputFormat::Float3 },
+                         { 24, stride, DxsoCpuInputFormat::Float2 }, { 32, stride, DxsoCpuInputFormat::Color } };
+      fixture.vertexData.resize(stride * vertexCount);
+      for (uint32_t i = 0; i < vertexCount; i++) {
+        float values[8];
+        for (float& value : values)
+          value = random(-4.0f, 4.0f);
+        const uint32_t color = rng();
+
+        std::memcpy(&fixture.vertexData[i * stride], values, sizeof(values));
+        std::memcpy(&fixture.vertexData[i * stride + 32], &color, sizeof(color));
+      }
+
+      fixture.constants.resize(4);
+      for (Vector4& c : fixture.constants)
+        c = Vector4(random(-2.0f, 2.0f), random(-2.0f, 2.0f), random(-2.0f, 2.0f), random(-2.0f, 2.0f));
+
+      // m4x4 dots the position with each constant, so the constants are the rows of the projection
+      fixture.transforms.invProj = inverse(transpose(Matrix4(fixture.constants[0], fixture.constants[1], fixture.constants[2], fixture.constants[3])));
+      fixture.transforms.viewToWorld = Matrix4(Vector4(1.0f, 0.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, 1.0f, 0.0f),
+                                               Vector4(0.0f, 1.0f, 0.0f, 0.0f), Vector4(3.0f, -2.0f, 1.0f, 1.0f));
+      fixture.transforms.worldToObject = Matrix4(Vector4(2.0f, 0.0f, 0.0f, 0.0f), Vector4(0.0f, 2.0f, 0.0f, 0.0f),
+                                                 Vector4(0.0f, 0.0f, 2.0f, 0.0f), Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+      fixture.transforms.normalTransform = Matrix4(Vector4(0.0f, 1.0f, 0.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 0.0f),
+                                                   Vector4(0.0f, 0.0f, 1.0f, 0.0f), Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+
+      fixture.capturedVertices.resize(vertexCount);
+    }
+
+    static void captureFixture(const DxsoVertexCaptureFixture& fixture, std::vector<CapturedVertex>& vertices) {
+      auto shader = DxsoCpuShader::create(fixture.bytecode.data(), fixture.options);
+      if (shader == nullptr)
+        throw DxvkError("Fixture shader was rejected");
+
+      std::vector<DxsoCpuInputStream> streams;
+      if (!fixture.getInputStreams(streams) || streams.size() != shader->inputs().size())
+        throw DxvkError("Fixture inputs don't match the shader");
+
+      vertices.resize(fixture.vertexCount());
+      shader->captureVertices(fixture.vertexCount(), streams.data(), fixture.constants.data(), uint32_t(fixture.constants.size()),
+                              fixture.transforms, vertices.data());
+    }
+
+    void testCaptureVertices() {
+      DxsoVertexCaptureFixture fixture;
+      makeCaptureFixture(m_rng, 100, fixture);
+
+      std::vector<CapturedVertex> vertices;
+      captureFixture(fixture, vertices);
+
+      const D3D9RtxVertexCaptureData& transforms = fixture.transforms;
+      const std::vector<Vector4>& c = fixture.constants;
+
+      for (uint32_t i = 0; i < fixture.vertexCount(); i++) {
+        float values[8];
+        uint32_t color;
+        std::memcpy(values, &fixture.vertexData[i * 36], sizeof(values));
+        std::memcpy(&color, &fixture.vertexData[i * 36 + 32], sizeof(color));
+
+        const Vector4 position(values[0], values[1], values[2], 1.0f);
+        const Vector4 view = transforms.invProj * Vector4(dot4(position, c[0]), dot4(position, c[1]), dot4(position, c[2]), dot4(position, c[3]));
+        const Vector4 object = transforms.worldToObject * Vector4((transforms.viewToWorld * Vector4(view.xyz(), 1.0f)).xyz(), 1.0f);
+
+        expectNear(vertices[i].position, object.xyz(), 1e-4f, "captured position", i);
+        expectNear(vertices[i].normal0, Vector3(values[4], values[3], values[5]), 0.0f, "captured normal", i);
+        expectNear(Vector4(vertices[i].texcoord0.x, vertices[i].texcoord0.y, 0.0f, 0.0f), Vector4(values[6], values[7], 0.0f, 0.0f), 0.0f, "captured texcoord", i);
+
+        if (vertices[i].color0 != color)
+          throw DxvkError(str::format("Mismatch in captured color for vertex ", i));
+      }
+    }
+
+    void testFixtureSerialization() {
+      DxsoVertexCaptureFixture fixture;
+      makeCaptureFixture(m_rng, 33, fixture);
+      fixture.options.clampInfinities = true;
+      captureFixture(fixture, fixture.capturedVertices);
+
+      std::vector<uint8_t> file;
+      DxsoVertexCaptureFixture::serialize(fixture, file);
+
+      DxsoVertexCaptureFixture loaded;
+      if (!DxsoVertexCaptureFixture::deserialize(file, loaded))
+        throw DxvkError("Fixture failed to deserialize");
+
+      if (loaded.bytecode != fixture.bytecode || loaded.vertexData != fixture.vertexData
+       || !loaded.options.clampInfinities || loaded.options.mulZeroIsZero || loaded.options.strictPow
+       || loaded.inputs.size() != fixture.inputs.size() || loaded.constants.size() != fixture.constants.size()
+       || std::memcmp(&loaded.transforms, &fixture.transforms, sizeof(fixture.transforms)) != 0
+       || loaded.vertexCount() != fixture.vertexCount()
+       || std::memcmp(loaded.capturedVertices.data(), fixture.capturedVertices.data(), fixture.vertexCount() * sizeof(CapturedVertex)) != 0)
+        throw DxvkError("Fixture changed in a serialization round trip");
+
+      std::vector<uint8_t> damaged = file;
+      damaged[damaged.size() / 2] ^= 0x10;
+      if (DxsoVertexCaptureFixture::deserialize(damaged, loaded))
+        throw DxvkError("Damaged fixture was accepted");
+
+      damaged.assign(file.begin(), file.end() - 1);
+      if (DxsoVertexCaptureFixture::deserialize(damaged, loaded))
+        throw DxvkError("Truncated fixture was accepted");
+
+      // Inputs reading past the vertex data
+      DxsoVertexCaptureFixture invalid = fixture;
+      invalid.inputs[0].offset = uint32_t(invalid.vertexData.size());
+      DxsoVertexCaptureFixture::serialize(invalid, file);
+      if (DxsoVertexCaptureFixture::deserialize(file, loaded))
+        throw DxvkError("Fixture with out of range inputs was accepted");
+    }
+
+    void testRecordedFixtures() {
+      // Draw calls vertex captured on the GPU, recorded through rtx.vertexCaptureFixturePath
+      const std::string directory = env::getEnvVar("DXSO_VERTEX_CAPTURE_FIXTURES");
+      std::error_code error;
+
+      std::vector<std::filesystem::path> files;
+      if (!directory.empty()) {
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+          if (entry.path().extension() == ".dxvc")
+            files.push_back(entry.path());
+        }
+      }
+
+      std::cout << "Running: " << files.size() << " recorded vertex capture fixtures\n";
+
+      for (const auto& file : files) {
+        DxsoVertexCaptureFixture fixture;
+        if (!fixture.load(file.string()))
+          throw DxvkError(str::format("Failed to load ", file.string()));
+
+        std::vector<CapturedVertex> vertices;
+        captureFixture(fixture, vertices);
+
+        // GPU transcendentals and FMA contraction don't match the CPU bit for bit
+        const std::string name = file.filename().string();
+        for (uint32_t i = 0; i < fixture.vertexCount(); i++) {
+          const CapturedVertex& expected = fixture.capturedVertices[i];
+          const CapturedVertex& actual = vertices[i];
+
+          uint32_t positionBits;
+          std::memcpy(&positionBits, &expected.position.x, sizeof(positionBits));
+          if (positionBits == DxsoVertexCaptureFixture::UnwrittenPattern)
+            continue;
+
+          expectNear(actual.position, expected.position, 1e-4f, (name + " position").c_str(), i);
+          expectNear(Vector4(actual.texcoord0.x, actual.texcoord0.y, 0.0f, 0.0f),
+                     Vector4(expected.texcoord0.x, expected.texcoord0.y, 0.0f, 0.0f), 1e-4f, (name + " texcoord").c_str(), i);
+
+          uint32_t normalBits;
+          std::memcpy(&normalBits, &expected.normal0.x, sizeof(normalBits));
+          if (normalBits != DxsoVertexCaptureFixture::UnwrittenPattern)
+            expectNear(actual.normal0, expected.normal0, 1e-4f, (name + " normal").c_str(), i);
+
+          for (uint32_t shift = 0; shift < 32; shift += 8) {
+            const int32_t delta = int32_t((actual.color0 >> shift) & 0xff) - int32_t((expected.color0 >> shift) & 0xff);
+            if (std::abs(delta) > 1)
+              throw DxvkError(str::format("Mismatch in ", name, " color for vertex ", i));
+          }
+        }
+      }
+    }
+  };
+}
+
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
@@ -0,0 +1,217 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cstdio>
+#include <fstream>
+#include "../../test_utils.h"
+#include "../../../src/dxso/dxso_shader_cache.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_dxso_shader_cache.log");
+}
+
+namespace dxvk {
+
+  class TestApp {
+  public:
+    static constexpr const char* CachePath = "test_dxso_shader_cache.dxso-cache";
+    static constexpr uint64_t VersionStamp = 0x1234;
+
+    void run() {
+      std::remove(CachePath);
+
+      testRoundTrip();
+      testVersionMismatch();
+      testDamagedTail();
+      testStoredInputs();
+
+      std::remove(CachePath);
+    }
+
+  private:
+
+    static SpirvCodeBuffer makeCode(uint32_t seed) {
+      // Repeating words so the compressed form is not trivial
+      std::vector<uint32_t> words(257);
+
+      for (uint32_t i = 0; i < words.size(); i++)
+        words[i] = (i % 7 == 0) ? seed + i : 0x07230203u;
+
+      return SpirvCodeBuffer(uint32_t(words.size()), words.data());
+    }
+
+    static DxsoCachedModule makeModule(uint32_t seed) {
+      DxsoCachedModule module;
+      module.isgn.elemCount = 2;
+      module.isgn.elems[1].regNumber = seed;
+      module.isgn.elems[1].semantic = { DxsoUsage::Texcoord, 3 };
+      module.osgn.elemCount = 1;
+      module.meta.maxConstIndexF = seed + 1;
+      module.constants.push_back({ 4, { 1.0f, 2.0f, 3.0f, float(seed) } });
+      module.maxDefinedConst = 5;
+      module.usedSamplers = 0x3;
+      module.usedRTs = 0x1;
+
+      DxsoCachedShader shader;
+      shader.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+      shader.slots.push_back({ 7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_IMAGE_VIEW_TYPE_2D, VK_ACCESS_SHADER_READ_BIT });
+      shader.interfaceSlots.inputSlots = 0xf;
+      shader.code = SpirvCompressedBuffer(makeCode(seed));
+
+      // Second permutation left empty, like a missing flat shade variant
+      module.shaders.emplace_back(std::move(shader));
+      module.shaders.emplace_back();
+      return module;
+    }
+
+    static void expectEqual(const SpirvCompressedBuffer& a, const SpirvCompressedBuffer& b) {
+      SpirvCodeBuffer da = a.decompress();
+      SpirvCodeBuffer db = b.decompress();
+
+      if (da.size() != db.size() || std::memcmp(da.data(), db.data(), da.size()))
+        throw DxvkError("Decompressed SPIR-V mismatch");
+    }
+
+    static void expectEqual(const DxsoCachedModule& a, const DxsoCachedModule& b) {
+      if (a.isgn.elemCount != b.isgn.elemCount
+       || a.isgn.elems[1].regNumber != b.isgn.elems[1].regNumber
+       || a.isgn.elems[1].semantic != b.isgn.elems[1].semantic
+       || a.osgn.elemCount != b.osgn.elemCount
+       || a.meta.maxConstIndexF != b.meta.maxConstIndexF
+       || a.constants.size() != b.constants.size()
+       || a.constants[0].float32[3] != b.constants[0].float32[3]
+       || a.maxDefinedConst != b.maxDefinedConst
+       || a.usedSamplers != b.usedSamplers
+       || a.usedRTs != b.usedRTs)
+        throw DxvkError("Module reflection data mismatch");
+
+      if (a.shaders.size() != b.shaders.size() || !b.shaders[0] || b.shaders[1])
+        throw DxvkError("Module permutation mismatch");
+
+      if (a.shaders[0]->stage != b.shaders[0]->stage
+       || a.shaders[0]->slots.size() != b.shaders[0]->slots.size()
+       || a.shaders[0]->slots[0].slot != b.shaders[0]->slots[0].slot
+       || a.shaders[0]->interfaceSlots.inputSlots != b.shaders[0]->interfaceSlots.inputSlots)
+        throw DxvkError("Shader metadata mismatch");
+
+      expectEqual(a.shaders[0]->code, b.shaders[0]->code);
+    }
+
+    void testRoundTrip() {
+      { DxsoShaderCache cache(CachePath, VersionStamp);
+        DxsoCachedModule module;
+
+        if (cache.lookup(1, module))
+          throw DxvkError("Empty cache returned a module");
+
+        cache.insert(1, makeModule(10));
+        cache.insert(2, makeModule(20));
+
+        // Hits are served from memory before anything is on disk
+        if (!cache.lookup(2, module))
+          throw DxvkError("Inserted module not found");
+        expectEqual(makeModule(20), module);
+      }
+
+      DxsoShaderCache cache(CachePath, VersionStamp);
+      DxsoCachedModule module;
+
+      if (!cache.lookup(1, module))
+        throw DxvkError("Module 1 not found after reopening");
+      expectEqual(makeModule(10), module);
+
+      if (!cache.lookup(2, module))
+        throw DxvkError("Module 2 not found after reopening");
+      expectEqual(makeModule(20), module);
+
+      if (cache.lookup(3, module))
+        throw DxvkError("Unknown key returned a module");
+    }
+
+    void testVersionMismatch() {
+      { DxsoShaderCache cache(CachePath, VersionStamp + 1);
+        DxsoCachedModule module;
+
+        if (cache.lookup(1, module))
+          throw DxvkError("Module from an outdated cache was returned");
+
+        cache.insert(3, makeModule(30));
+      }
+
+      // The outdated file was replaced with one holding only the new entry
+      DxsoShaderCache cache(CachePath, VersionStamp + 1);
+      DxsoCachedModule module;
+
+      if (cache.lookup(1, module) || !cache.lookup(3, module))
+        throw DxvkError("Cache file was not rewritten after a version change");
+    }
+
+    void testDamagedTail() {
+      { DxsoShaderCache cache(CachePath, VersionStamp + 1);
+        cache.insert(4, makeModule(40));
+      }
+
+      // Simulate a crash in the middle of appending an entry
+      { std::ofstream file(CachePath, std::ios_base::binary | std::ios_base::app);
+        const char garbage[13] = { };
+        file.write(garbage, sizeof(garbage));
+      }
+
+      DxsoShaderCache cache(CachePath, VersionStamp + 1);
+      DxsoCachedModule module;
+
+      if (!cache.lookup(3, module) || !cache.lookup(4, module))
+        throw DxvkError("Intact entries before a damaged tail were lost");
+      expectEqual(makeModule(40), module);
+    }
+
+    void testStoredInputs() {
+      const std::vector<uint8_t> inputs = { 1, 2, 3, 4, 5 };
+
+      { DxsoShaderCache cache(CachePath, VersionStamp + 2);
+        DxsoCachedModule module = makeModule(50);
+        module.inputs = inputs;
+
+        cache.insert(5, module);
+        cache.insert(6, makeModule(60));
+      }
+
+      DxsoShaderCache cache(CachePath, VersionStamp + 2);
+      auto stored = cache.getStoredInputs();
+
+      // Modules without inputs, i.e. DXSO shaders, are not enumerated
+      if (stored.size() != 1 || stored[0].first != 5 || stored[0].second != inputs)
+        throw DxvkError("Stored inputs mismatch");
+
+      DxsoCachedModule module;
+
+      if (!cache.lookup(5, module) || module.inputs != inputs)
+        throw DxvkError("Inputs were not read back with the module");
+      expectEqual(makeModule(50), module);
+    }
+  };
+}
+
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
@@ -0,0 +1,347 @@
+/*
+* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cstring>
+#include <random>
+#include <vector>
+#include "../../test_utils.h"
+#include "../../../src/util/util_bounding_box.h"
+#include "../../../src/util/util_fastops.h"
+#include "../../../src/util/util_timer.h"
+
+using namespace dxvk;
+
+namespace fast {
+
+  extern void findMinMaxFloat3_slow(const uint32_t count, const void* data, const size_t stride, float minOut[3], float maxOut[3]);
+  extern void findMinMaxFloat3_SSE(const uint32_t count, const void* data, const size_t stride, float minOut[3], float maxOut[3]);
+  extern void findMinMaxFloat3_AVX2(const uint32_t count, const void* data, const size_t stride, float minOut[3], float maxOut[3]);
+
+  extern uint32_t boxesIntersectPlanes8_slow(const float* planes, const uint32_t planeCount, const float* boxBounds);
+  extern uint32_t boxesIntersectPlanes8_SSE(const float* planes, const uint32_t planeCount, const float* boxBounds);
+  extern uint32_t boxesIntersectPlanes8_AVX2(const float* planes, const uint32_t planeCount, const float* boxBounds);
+
+class BoundingBoxTestApp {
+public:
+  static void run() {
+    std::cout << std::endl << "Begin test (strided float3 min/max)" << std::endl;
+    test_minMaxCorrectness();
+    test_minMaxSmoke();
+
+    std::cout << std::endl << "Begin test (box vs planes)" << std::endl;
+    test_planesCorrectness();
+    test_planesSmoke();
+
+    std::cout << std::endl << "Begin test (bounding box helpers)" << std::endl;
+    test_transform();
+    test_batch();
+  }
+
+private:
+  using MinMaxFunc = void(*)(const uint32_t, const void*, const size_t, float[3], float[3]);
+  using PlanesFunc = uint32_t(*)(const float*, const uint32_t, const float*);
+
+  static constexpr uint32_t kNumPlanes = 6;
+
+  static std::vector<uint8_t> generatePositions(std::mt19937& rng, const uint32_t count, const size_t stride) {
+    std::uniform_real_distribution<float> uni(-1000.f, 1000.f);
+    std::vector<uint8_t> data(count * stride);
+    for (uint32_t i = 0; i < count; i++) {
+      float* pPosition = reinterpret_cast<float*>(data.data() + i * stride);
+      pPosition[0] = uni(rng);
+      pPosition[1] = uni(rng);
+      pPosition[2] = uni(rng);
+    }
+    return data;
+  }
+
+  static void checkMinMax(const char* name, MinMaxFunc func, const uint32_t count, const std::vector<uint8_t>& data, const size_t stride) {
+    float min[3], max[3];
+    float min2[3], max2[3];
+    findMinMaxFloat3_slow(count, data.data(), stride, min, max);
+    func(count, data.data(), stride, min2, max2);
+
+    if (memcmp(min, min2, sizeof(min)) != 0 || memcmp(max, max2, sizeof(max)) != 0) {
+      throw dxvk::DxvkError(str::format("Min/Max not matching ", name, " for ", count, " positions with stride ", stride));
+    }
+  }
+
+  static void test_minMaxCorrectness() {
+    std::mt19937 rng(3);
+
+    // Tightly packed positions, padded positions and positions interleaved with other vertex attributes,
+    // with counts around the unrolled loop sizes. The buffers are sized exactly so reading past the last position would be caught by ASAN.
+    for (const size_t stride : { 12, 16, 32 }) {
+      for (const uint32_t count : { 1u, 2u, 3u, 4u, 5u, 7u, 8u, 9u, 15u, 16u, 17u, 1001u }) {
+        std::vector<uint8_t> data = generatePositions(rng, count, stride);
+        data.resize((count - 1) * stride + 12);
+
+        checkMinMax("findMinMaxFloat3_SSE", findMinMaxFloat3_SSE, count, data, stride);
+        if (fast::getSimdSupportLevel() >= SIMD::AVX2) {
+          checkMinMax("findMinMaxFloat3_AVX2", findMinMaxFloat3_AVX2, count, data, stride);
+        }
+        checkMinMax("findMinMaxFloat3", findMinMaxFloat3, count, data, stride);
+      }
+    }
+
+    const Vector3 positions[] = { Vector3(1.f, -2.f, 3.f), Vector3(-4.f, 5.f, -6.f), Vector3(7.f, -8.f, 9.f) };
+    const AxisAlignedBoundingBox box = AxisAlignedBoundingBox::fromPositions(positions, 3, sizeof(Vector3));
+    if (box.minPos != Vector3(-4.f, -8.f, -6.f) || box.maxPos != Vector3(7.f, 5.f, 9.f)) {
+      throw dxvk::DxvkError("AxisAlignedBoundingBox::fromPositions not matching correctness check");
+    }
+
+    if (AxisAlignedBoundingBox::fromPositions(nullptr, 0, sizeof(Vector3)).isValid()) {
+      throw dxvk::DxvkError("Bounding box of no positions must be invalid");
+    }
+
+    std::cout << "Strided float3 min/max fast ops successfully tested for correctness" << std::endl;
+  }
+
+  static void test_minMaxSmoke() {
+    std::mt19937 rng(5);
+    const uint32_t count = 1024 * 1024 + 3;
+    const size_t stride = 32;
+    const std::vector<uint8_t> data = generatePositions(rng, count, stride);
+
+    std::cout << "Running smoke check, number of positions: " << count << std::endl;
+
+    float min[3], max[3];
+    {
+      std::cout << "Running: findMinMaxFloat3_slow --> ";
+      Timer time;
+      findMinMaxFloat3_slow(count, data.data(), stride, min, max);
+    }
+    {
+      std::cout << "Running: findMinMaxFloat3_SSE --> ";
+      Timer time;
+      findMinMaxFloat3_SSE(count, data.data(), stride, min, max);
+    }
+    if (fast::getSimdSupportLevel() >= SIMD::AVX2) {
+      std::cout << "Running: findMinMaxFloat3_AVX2 --> ";
+      Timer time;
+      findMinMaxFloat3_AVX2(count, data.data(), stride, min, max);
+    } else {
+      std::cout << "AVX2 not supported by this processor" << std::endl;
+    }
+
+    checkMinMax("findMinMaxFloat3_SSE", findMinMaxFloat3_SSE, count, data, stride);
+  }
+
+  static void generatePlanes(std::mt19937& rng, float planes[kNumPlanes * 4]) {
+    std::uniform_real_distribution<float> uni(-1.f, 1.f);
+    for (uint32_t i = 0; i < kNumPlanes * 4; i++) {
+      planes[i] = uni(rng);
+    }
+  }
+
+  static void generateBoxes(std::mt19937& rng, float boxBounds[6 * 8]) {
+    std::uniform_real_distribution<float> uni(-2.f, 2.f);
+    for (uint32_t box = 0; box < 8; box++) {
+      for (uint32_t c = 0; c < 3; c++) {
+        const float a = uni(rng);
+        const float b = uni(rng);
+        boxBounds[c * 8 + box] = std::min(a, b);
+        boxBounds[(3 + c) * 8 + box] = std::max(a, b);
+      }
+    }
+  }
+
+  // Reference: a box intersects the planes if for every plane, any of its corners is inside of it
+  static uint32_t intersectPlanesCorners(const float* planes, const uint32_t planeCount, const float* boxBounds) {
+    uint32_t result = 0;
+    for (uint32_t box = 0; box < 8; box++) {
+      bool inside = true;
+      for (uint32_t p = 0; p < planeCount && inside; p++) {
+        const float* plane = planes + p * 4;
+        bool anyCornerInside = false;
+        for (uint32_t corner = 0; corner < 8; corner++) {
+          float distance = 0.f;
+          for (uint32_t c = 0; c < 3; c++) {
+            distance += plane[c] * boxBounds[((corner >> c) & 1 ? 3 + c : c) * 8 + box];
+          }
+          anyCornerInside |= distance + plane[3] >= 0.f;
+        }
+        inside = anyCornerInside;
+      }
+      result |= inside ? (1u << box) : 0u;
+    }
+    return result;
+  }
+
+  static void test_planesCorrectness() {
+    std::mt19937 rng(7);
+    float planes[kNumPlanes * 4];
+    float boxBounds[6 * 8];
+
+    uint32_t numInside = 0;
+    for (uint32_t i = 0; i < 10000; i++) {
+      generatePlanes(rng, planes);
+      generateBoxes(rng, boxBounds);
+
+      const uint32_t expected = intersectPlanesCorners(planes, kNumPlanes, boxBounds);
+      numInside += bit::popcnt(expected);
+
+      if (boxesIntersectPlanes8_slow(planes, kNumPlanes, boxBounds) != expected) {
+        throw dxvk::DxvkError("Box vs planes not matching boxesIntersectPlanes8_slow");
+      }
+      if (boxesIntersectPlanes8_SSE(planes, kNumPlanes, boxBounds) != expected) {
+        throw dxvk::DxvkError("Box vs planes not matching boxesIntersectPlanes8_SSE");
+      }
+      if (fast::getSimdSupportLevel() >= SIMD::AVX2 && boxesIntersectPlanes8_AVX2(planes, kNumPlanes, boxBounds) != expected) {
+        throw dxvk::DxvkError("Box vs planes not matching boxesIntersectPlanes8_AVX2");
+      }
+    }
+
+    // Make sure both outcomes were exercised
+    if (numInside == 0 || numInside == 10000 * 8) {
+      throw dxvk::DxvkError("Box vs planes test data is degenerate");
+    }
+
+    std::cout << "Box vs planes fast ops successfully tested for correctness" << std::endl;
+  }
+
+  static void test_planesSmoke() {
+    std::mt19937 rng(11);
+    const uint32_t numBatches = 100000 / 8;
+
+    float planes[kNumPlanes * 4];
+    generatePlanes(rng, planes);
+    std::vector<float> boxBounds(numBatches * 6 * 8);
+    for (uint32_t i = 0; i < numBatches; i++) {
+      generateBoxes(rng, &boxBounds[i * 6 * 8]);
+    }
+
+    std::cout << "Running smoke check, number of boxes: " << numBatches * 8 << std::endl;
+
+    auto execute = [&](const char* name, PlanesFunc func) {
+      uint32_t numInside = 0;
+      {
+        std::cout << "Running: " << name << " --> ";
+        Timer time;
+        for (uint32_t i = 0; i < numBatches; i++) {
+          numInside += bit::popcnt(func(planes, kNumPlanes, &boxBounds[i * 6 * 8]));
+        }
+      }
+      return numInside;
+    };
+
+    const uint32_t numInside = execute("corners (8 per box)", intersectPlanesCorners);
+    if (execute("boxesIntersectPlanes8_slow", boxesIntersectPlanes8_slow) != numInside ||
+        execute("boxesIntersectPlanes8_SSE", boxesIntersectPlanes8_SSE) != numInside) {
+      throw dxvk::DxvkError("Box vs planes smoke test results not matching");
+    }
+    if (fast::getSimdSupportLevel() >= SIMD::AVX2) {
+      if (execute("boxesIntersectPlanes8_AVX2", boxesIntersectPlanes8_AVX2) != numInside) {
+        throw dxvk::DxvkError("Box vs planes smoke test results not matching");
+      }
+    } else {
+      std::cout << "AVX2 not supported by this processor" << std::endl;
+    }
+  }
+
+  static void test_transform() {
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<float> uni(-10.f, 10.f);
+
+    for (uint32_t i = 0; i < 1000; i++) {
+      Matrix4 transform;
+      for (uint32_t column = 0; column < 3; column++) {
+        transform[column] = Vector4(uni(rng), uni(rng), uni(rng), 0.f);
+      }
+      transform[3] = Vector4(uni(rng), uni(rng), uni(rng), 1.f);
+
+      AxisAlignedBoundingBox box;
+      box.minPos = Vector3(uni(rng), uni(rng), uni(rng));
+      box.maxPos = box.minPos + abs(Vector3(uni(rng), uni(rng), uni(rng)));
+
+      // Reference: bounds of all 8 transformed corners
+      AxisAlignedBoundingBox expected;
+      for (uint32_t corner = 0; corner < 8; corner++) {
+        const Vector3 position((corner & 1) ? box.maxPos.x : box.minPos.x, (corner & 2) ? box.maxPos.y : box.minPos.y, (corner & 4) ? box.maxPos.z : box.minPos.z);
+        const Vector3 transformed = (transform * Vector4(position, 1.f)).xyz();
+        expected.unionWith(AxisAlignedBoundingBox{ transformed, transformed });
+      }
+
+      const AxisAlignedBoundingBox result = box.transform(transform);
+      const float tolerance = 1e-3f * (1.f + length(expected.maxPos - expected.minPos));
+      for (uint32_t c = 0; c < 3; c++) {
+        if (std::abs(result.minPos[c] - expected.minPos[c]) > tolerance || std::abs(result.maxPos[c] - expected.maxPos[c]) > tolerance) {
+          throw dxvk::DxvkError("AxisAlignedBoundingBox::transform not matching the transformed corners");
+        }
+      }
+    }
+
+    AxisAlignedBoundingBox invalid;
+    if (invalid.transform(Matrix4()).isValid()) {
+      throw dxvk::DxvkError("Transforming an invalid bounding box must keep it invalid");
+    }
+
+    std::cout << "AxisAlignedBoundingBox::transform successfully tested for correctness" << std::endl;
+  }
+
+  static void test_batch() {
+    // Unit cube in front of the origin, only the positive half-space of x counts as inside
+    const Vector4 planes[] = { Vector4(1.f, 0.f, 0.f, 0.f) };
+
+    BoundingBoxBatch batch;
+    if (batch.intersectPlanes(planes, 1) != 0) {
+      throw dxvk::DxvkError("Empty batch must not report any boxes");
+    }
+
+    batch.add(Vector3(1.f), Vector3(2.f));                    // Inside
+    batch.add(Vector3(-2.f), Vector3(-1.f));                  // Outside
+    batch.add(Vector3(-1.f), Vector3(1.f));                   // Straddling
+    batch.add(Vector3(-1.f, 0.f, 0.f), Vector3(0.f, 1.f, 1.f)); // Touching
+
+    if (batch.intersectPlanes(planes, 1) != 0b1101) {
+      throw dxvk::DxvkError("Partial batch results not matching");
+    }
+
+    while (!batch.full()) {
+      batch.add(Vector3(1.f), Vector3(2.f));
+    }
+    if (batch.intersectPlanes(planes, 1) != 0b11111101) {
+      throw dxvk::DxvkError("Full batch results not matching");
+    }
+
+    // Stale slots past the count of a refilled batch must not be reported
+    batch.clear();
+    batch.add(Vector3(-2.f), Vector3(-1.f));
+    if (batch.intersectPlanes(planes, 1) != 0) {
+      throw dxvk::DxvkError("Refilled batch results not matching");
+    }
+
+    std::cout << "BoundingBoxBatch successfully tested for correctness" << std::endl;
+  }
+};
+}
+
+int main() {
+  try {
+    fast::BoundingBoxTestApp::run();
+  }
+  catch (const dxvk::DxvkError& e) {
+    std::cerr << e.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
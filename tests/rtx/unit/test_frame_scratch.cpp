@@ -0,0 +1,169 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_frame_scratch.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_frame_scratch.log");
+}
+
+// Counts the heap allocations made by this process, to check that steady frames don't allocate
+static std::atomic<uint64_t> s_numAllocations = 0;
+
+void* operator new(size_t size) {
+  s_numAllocations++;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testSteadyStateAllocations();
+      testGrowth();
+      testReset();
+    }
+
+  private:
+    struct Transform {
+      float matrix[3][4];
+    };
+
+    struct BuildInfo {
+      uint32_t geometryCount;
+      const void* pGeometries;
+    };
+
+    using Arena = FrameScratchArena<Transform, BuildInfo, const BuildInfo*, uint32_t>;
+
+    // Uses the arena the way AccelManager does over a frame with the given number of instances
+    static void simulateFrame(Arena& arena, uint32_t numInstances) {
+      arena.reset();
+
+      auto& transforms = arena.acquire<Transform>();
+      transforms.reserve(numInstances);
+
+      auto& buildInfos = arena.acquire<BuildInfo>();
+      auto& buildRanges = arena.acquire<const BuildInfo*>();
+      buildInfos.reserve(numInstances);
+      buildRanges.reserve(numInstances);
+
+      for (uint32_t i = 0; i < numInstances; i++) {
+        transforms.push_back(Transform {});
+
+        if (i % 3 == 0) {
+          buildInfos.push_back(BuildInfo { i, nullptr });
+          buildRanges.push_back(&buildInfos.back());
+        }
+      }
+
+      // Several vectors of one type are used in the same frame
+      auto& surfaceMapping = arena.acquire<uint32_t>();
+      auto& materialSurfaces = arena.acquire<uint32_t>();
+      for (uint32_t i = 0; i < numInstances; i++) {
+        surfaceMapping.push_back(i);
+        if (i % 2 == 0) {
+          materialSurfaces.push_back(i);
+        }
+      }
+
+      expect(transforms.size() == numInstances, "Unexpected scratch contents");
+      expect(surfaceMapping.size() == numInstances, "Unexpected scratch contents");
+    }
+
+    void testSteadyStateAllocations() {
+      Arena arena;
+
+      // The first frames populate the pools
+      simulateFrame(arena, 5000);
+      simulateFrame(arena, 5000);
+      expect(arena.getGrowthCount() > 0, "The first frame should have allocated the scratch vectors");
+
+      const uint64_t numAllocations = s_numAllocations.load();
+
+      for (uint32_t frame = 0; frame < 100; frame++) {
+        // Smaller frames fit into the existing allocations too
+        simulateFrame(arena, frame % 2 == 0 ? 5000 : 1000);
+        expect(arena.getGrowthCount() == 0, "Steady frames should not grow the scratch vectors");
+      }
+
+      expect(s_numAllocations.load() == numAllocations, "Steady frames should not allocate memory");
+    }
+
+    void testGrowth() {
+      Arena arena;
+      simulateFrame(arena, 100);
+      simulateFrame(arena, 100);
+      simulateFrame(arena, 100);
+      expect(arena.getGrowthCount() == 0, "Steady frames should not grow the scratch vectors");
+
+      // A larger frame is reported on the following reset
+      simulateFrame(arena, 10000);
+      simulateFrame(arena, 100);
+      expect(arena.getGrowthCount() > 0, "Growth of the scratch vectors should be reported");
+
+      simulateFrame(arena, 10000);
+      expect(arena.getGrowthCount() == 0, "The scratch vectors should keep their capacity");
+    }
+
+    void testReset() {
+      Arena arena;
+
+      auto& first = arena.acquire<uint32_t>();
+      first.assign(64, 1);
+
+      // Acquiring more vectors does not invalidate the previous ones
+      for (uint32_t i = 0; i < 1000; i++) {
+        arena.acquire<uint32_t>().push_back(i);
+      }
+      expect(first.size() == 64 && first[63] == 1, "Acquired vectors should stay valid until the arena is reset");
+
+      arena.reset();
+
+      // Vectors are handed out in the same order, empty but with their previous capacity
+      auto& reacquired = arena.acquire<uint32_t>();
+      expect(&reacquired == &first, "Vectors should be handed out in the same order after a reset");
+      expect(reacquired.empty() && reacquired.capacity() >= 64, "Reset vectors should be empty and keep their allocation");
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
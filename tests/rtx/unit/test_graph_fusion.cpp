@@ -0,0 +1,247 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <memory>
+#include <random>
+#include "../../test_utils.h"
+#include "../../../src/util/util_timer.h"
+#include "../../../src/dxvk/rtx_render/graph/rtx_graph_types.h"
+#include "../../../src/dxvk/rtx_render/graph/rtx_graph_batch.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_graph_fusion.log");
+}
+
+namespace dxvk {
+  // Builds a deep chain of math components, with a stateful Counter in the middle of it,
+  // and checks that fused updates produce exactly the same values as unfused ones.
+  class TestApp {
+  public:
+    void run() {
+      testMatchesUnfused();
+      benchmark();
+    }
+
+  private:
+    static constexpr size_t kNumStates = 64;
+
+    struct Graph {
+      RtGraphTopology topology;
+      std::vector<std::unique_ptr<RtGraphState>> states;
+      std::vector<std::unique_ptr<GraphInstance>> instances;
+      size_t numPureComponents = 0;
+    };
+
+    static const RtComponentSpec* getSpec(const char* name, const std::unordered_map<std::string, RtComponentPropertyType>& types = {}) {
+      const std::string fullName = RtComponentPropertySpec::kUsdNamePrefix + name;
+      for (const RtComponentSpec* spec : getAllComponentSpecVariants(XXH3_64bits(fullName.c_str(), fullName.size()))) {
+        bool matches = true;
+        for (const auto& [propertyName, type] : types) {
+          auto iter = spec->resolvedTypes.find(propertyName);
+          matches = matches && iter != spec->resolvedTypes.end() && iter->second == type;
+        }
+        if (matches) {
+          return spec;
+        }
+      }
+      throw DxvkError(str::format("Component not found: ", name));
+    }
+
+    // Adds a component with new properties for all unconnected inputs and outputs, returns the index of the named output
+    static size_t addComponent(RtGraphTopology& topology, std::vector<RtComponentPropertyValue>& defaults, const RtComponentSpec* spec,
+                               const std::unordered_map<std::string, size_t>& connections, const char* output) {
+      std::vector<size_t> indices;
+      size_t outputIndex = SIZE_MAX;
+
+      for (const RtComponentPropertySpec& property : spec->properties) {
+        auto iter = connections.find(property.name);
+        if (iter != connections.end()) {
+          indices.push_back(iter->second);
+          continue;
+        }
+
+        indices.push_back(topology.propertyTypes.size());
+        topology.propertyTypes.push_back(property.type);
+        defaults.push_back(property.defaultValue);
+
+        if (property.name == output) {
+          outputIndex = indices.back();
+        }
+      }
+
+      topology.componentSpecs.push_back(spec);
+      topology.propertyIndices.push_back(std::move(indices));
+      return outputIndex;
+    }
+
+    static void buildGraph(Graph& graph, uint32_t depth) {
+      const auto kFloats = std::unordered_map<std::string, RtComponentPropertyType> {
+        { "a", RtComponentPropertyType::Float }, { "b", RtComponentPropertyType::Float }
+      };
+      const RtComponentSpec* multiply = getSpec("Multiply", kFloats);
+      const RtComponentSpec* add = getSpec("Add", kFloats);
+      const RtComponentSpec* subtract = getSpec("Subtract", kFloats);
+      const RtComponentSpec* clamp = getSpec("Clamp", { { "value", RtComponentPropertyType::Float } });
+      const RtComponentSpec* counter = getSpec("Counter");
+
+      RtGraphTopology& topology = graph.topology;
+      std::vector<RtComponentPropertyValue> defaults;
+
+      // Chain input
+      size_t value = topology.propertyTypes.size();
+      topology.propertyTypes.push_back(RtComponentPropertyType::Float);
+      defaults.push_back(0.f);
+
+      // Properties that are randomized per state: the chain input and the constant operands
+      std::vector<size_t> randomized { value };
+
+      for (uint32_t i = 0; i < depth; i++) {
+        if (i == depth / 2) {
+          value = addComponent(topology, defaults, counter, { { "incrementValue", value } }, "value");
+          // Always increment
+          std::get<uint32_t>(defaults[topology.propertyIndices.back()[0]]) = true;
+          continue;
+        }
+
+        const size_t operand = topology.propertyTypes.size();
+        switch (i % 4) {
+        case 0: value = addComponent(topology, defaults, multiply, { { "a", value } }, "product"); break;
+        case 1: value = addComponent(topology, defaults, add, { { "a", value } }, "sum"); break;
+        case 2: value = addComponent(topology, defaults, subtract, { { "a", value } }, "difference"); break;
+        case 3: value = addComponent(topology, defaults, clamp, { { "value", value } }, "result"); break;
+        }
+
+        if (i % 4 != 3) {
+          randomized.push_back(operand);
+        } else {
+          std::get<float>(defaults[operand]) = -1000.f;
+          std::get<float>(defaults[operand + 1]) = 1000.f;
+        }
+        graph.numPureComponents++;
+      }
+
+      topology.graphHash = depth;
+
+      std::mt19937 rng(depth);
+      std::uniform_real_distribution<float> distribution(0.5f, 1.5f);
+      for (size_t s = 0; s < kNumStates; s++) {
+        graph.states.push_back(std::make_unique<RtGraphState>(RtGraphState { topology, defaults, "/graph" }));
+        for (size_t index : randomized) {
+          graph.states.back()->values[index] = distribution(rng);
+        }
+      }
+    }
+
+    static void addInstances(Graph& graph, RtGraphBatch& batch, size_t numInstances) {
+      batch.increaseReserve(numInstances);
+      for (size_t i = 0; i < numInstances; i++) {
+        const RtGraphState& state = *graph.states[i % kNumStates];
+        graph.instances.push_back(std::make_unique<GraphInstance>(nullptr, graph.topology.graphHash, 0, graph.instances.size(), state));
+        if (!batch.addInstance(nullptr, state, graph.instances.back().get())) {
+          throw DxvkError("Failed to add graph instance");
+        }
+      }
+    }
+
+    void testMatchesUnfused() {
+      constexpr uint32_t kDepth = 24;
+      // Not a multiple of the block size, to have a partial block
+      constexpr size_t kNumInstances = RtGraphBatch::kFusedBlockSize * 5 + 17;
+
+      Graph graph;
+      buildGraph(graph, kDepth);
+
+      RtGraphBatch unfused;
+      unfused.Initialize(graph.topology, false);
+      RtGraphBatch fused;
+      fused.Initialize(graph.topology, true);
+
+      if (unfused.getNumFusedComponents() != 0 || fused.getNumFusedComponents() != graph.numPureComponents) {
+        throw DxvkError(str::format("Unexpected fused component count: ", fused.getNumFusedComponents(), " expected ", graph.numPureComponents));
+      }
+
+      addInstances(graph, unfused, kNumInstances);
+      addInstances(graph, fused, kNumInstances);
+
+      for (uint32_t frame = 0; frame < 4; frame++) {
+        unfused.update(nullptr);
+        fused.update(nullptr);
+
+        for (size_t p = 0; p < graph.topology.propertyTypes.size(); p++) {
+          if (unfused.getProperties()[p] != fused.getProperties()[p]) {
+            throw DxvkError(str::format("Fused property ", p, " differs from unfused in frame ", frame));
+          }
+        }
+      }
+
+      // Removing instances swaps the last one into place, blocks must still cover everything
+      for (size_t i = 0; i < 3; i++) {
+        unfused.removeInstance(graph.instances[i].get());
+        fused.removeInstance(graph.instances[kNumInstances + i].get());
+      }
+      unfused.update(nullptr);
+      fused.update(nullptr);
+      for (size_t p = 0; p < graph.topology.propertyTypes.size(); p++) {
+        if (unfused.getProperties()[p] != fused.getProperties()[p]) {
+          throw DxvkError(str::format("Fused property ", p, " differs from unfused after removing instances"));
+        }
+      }
+    }
+
+    void benchmark() {
+      constexpr size_t kNumInstances = 100000;
+      constexpr uint32_t kNumFrames = 10;
+
+      for (uint32_t depth : { 8u, 32u }) {
+        Graph graph;
+        buildGraph(graph, depth);
+
+        RtGraphBatch unfused;
+        unfused.Initialize(graph.topology, false);
+        RtGraphBatch fused;
+        fused.Initialize(graph.topology, true);
+        addInstances(graph, unfused, kNumInstances);
+        addInstances(graph, fused, kNumInstances);
+
+        {
+          std::cout << "Running: unfused depth " << depth << ", " << kNumInstances << " instances, " << kNumFrames << " frames --> ";
+          Timer time;
+          for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+            unfused.update(nullptr);
+          }
+        }
+        {
+          std::cout << "Running: fused depth " << depth << ", " << kNumInstances << " instances, " << kNumFrames << " frames --> ";
+          Timer time;
+          for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+            fused.update(nullptr);
+          }
+        }
+      }
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
@@ -0,0 +1,277 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <memory>
+#include <random>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_instance_hot_state.h"
+#include "../../../src/util/util_timer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_instance_hot_state.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testAddAndRemove();
+      testFindExpired();
+      benchmarkGarbageCollectionScan();
+      benchmarkInstanceMerge();
+    }
+
+  private:
+    static constexpr uint32_t kNumFramesToKeep = 4;
+
+    // Stand-in for RtInstance with the per-frame state stored inline, as it was before the hot/cold split.
+    // Sized like an RtInstance so that every instance visited costs its own cache lines.
+    struct ColdInstance {
+      uint32_t frameLastUpdated = kInvalidFrameIndex;
+      bool isMarkedForGC = false;
+      bool isInsideFrustum = true;
+      uint32_t surfaceIndex = SURFACE_INDEX_INVALID;
+      VkAccelerationStructureInstanceKHR vkInstance {};
+      uint8_t otherData[680];
+    };
+
+    void testAddAndRemove() {
+      InstanceHotState hotState;
+
+      for (uint32_t i = 0; i < 4; i++) {
+        expect(hotState.add() == i, "Slots must be allocated densely");
+        expect(hotState.getFrameLastUpdated(i) == kInvalidFrameIndex, "New slot must not be updated yet");
+        expect(hotState.hasFlag(i, InstanceHotState::InsideFrustum), "New slot must be inside the frustum");
+        expect(!hotState.hasFlag(i, InstanceHotState::MarkedForGC), "New slot must not be marked for GC");
+        expect(hotState.getSurfaceIndex(i) == SURFACE_INDEX_INVALID, "New slot must have an invalid surface index");
+        hotState.setFrameLastUpdated(i, 100 + i);
+        hotState.setSurfaceIndex(i, i);
+        hotState.setPreviousSurfaceIndex(i, 10 + i);
+        hotState.getVkInstance(i).mask = 1 + i;
+        hotState.getVkInstance(i).transform.matrix[0][3] = float(i);
+      }
+
+      hotState.setFlag(3, InstanceHotState::UnlinkedForGC, true);
+      hotState.setFlag(3, InstanceHotState::InsideFrustum, false);
+
+      // Last slot moves into the removed one
+      hotState.removeSwap(1);
+      expect(hotState.size() == 3, "Removal must shrink the arrays");
+      expect(hotState.getFrameLastUpdated(1) == 103, "Last slot must move into the removed slot");
+      expect(hotState.getSurfaceIndex(1) == 3 && hotState.getPreviousSurfaceIndex(1) == 13, "Surface indices must move with the slot");
+      expect(hotState.hasFlag(1, InstanceHotState::UnlinkedForGC) && !hotState.hasFlag(1, InstanceHotState::InsideFrustum), "Flags must move with the slot");
+      expect(hotState.getVkInstance(1).mask == 4 && hotState.getVkInstance(1).transform.matrix[0][3] == 3.f, "VK instance must move with the slot");
+
+      // Removing the last slot leaves the others untouched
+      hotState.removeSwap(2);
+      expect(hotState.size() == 2 && hotState.getFrameLastUpdated(0) == 100 && hotState.getFrameLastUpdated(1) == 103, "Removing the last slot must not move any slot");
+
+      hotState.resetSurfaceIndices();
+      expect(hotState.getSurfaceIndex(0) == SURFACE_INDEX_INVALID && hotState.getSurfaceIndex(1) == SURFACE_INDEX_INVALID, "Surface indices must be reset");
+      expect(hotState.getPreviousSurfaceIndex(1) == 13, "Previous surface indices must be retained");
+    }
+
+    void testFindExpired() {
+      static constexpr uint32_t kNumSlots = 1000;
+      static constexpr uint32_t kCurrentFrame = 100;
+
+      std::mt19937 generator(7);
+      InstanceHotState hotState;
+      std::vector<bool> keepAlive(kNumSlots);
+
+      for (uint32_t i = 0; i < kNumSlots; i++) {
+        hotState.add();
+        hotState.setFrameLastUpdated(i, kCurrentFrame - generator() % (2 * kNumFramesToKeep));
+        hotState.setFlag(i, InstanceHotState::MarkedForGC, generator() % 16 == 0);
+        keepAlive[i] = generator() % 4 == 0;
+      }
+
+      std::vector<uint32_t> expiredSlots;
+      uint32_t numCollectableCalls = 0;
+      hotState.findExpired(kCurrentFrame, kNumFramesToKeep, [&](uint32_t slot) {
+        numCollectableCalls++;
+        return !keepAlive[slot];
+      }, expiredSlots);
+
+      // Reference evaluation of the expiration rule
+      std::vector<uint32_t> expectedSlots;
+      uint32_t numStale = 0;
+      for (uint32_t i = kNumSlots; i-- > 0;) {
+        const bool isStale = hotState.getFrameLastUpdated(i) + kNumFramesToKeep <= kCurrentFrame;
+        numStale += isStale ? 1 : 0;
+
+        if (hotState.hasFlag(i, InstanceHotState::MarkedForGC) || (isStale && !keepAlive[i])) {
+          expectedSlots.push_back(i);
+        }
+      }
+
+      expect(expiredSlots == expectedSlots, "Expired slots must match the reference, in descending order");
+      expect(numCollectableCalls <= numStale, "Only stale slots may query the cold data");
+
+      // Removing in the returned order must leave exactly the live slots behind
+      std::vector<uint32_t> ids(kNumSlots);
+      for (uint32_t i = 0; i < kNumSlots; i++) {
+        ids[i] = i;
+      }
+
+      for (const uint32_t slot : expiredSlots) {
+        ids[slot] = ids.back();
+        ids.pop_back();
+        hotState.removeSwap(slot);
+      }
+
+      expect(hotState.size() == ids.size() && ids.size() == kNumSlots - expectedSlots.size(), "Removal must leave the live slots");
+      for (uint32_t i = 0; i < ids.size(); i++) {
+        const uint32_t id = ids[i];
+        expect(std::find(expectedSlots.begin(), expectedSlots.end(), id) == expectedSlots.end(), "Expired slot survived the removal");
+        expect(!hotState.hasFlag(i, InstanceHotState::MarkedForGC), "Marked slot survived the removal");
+      }
+    }
+
+    void benchmarkGarbageCollectionScan() {
+      static constexpr uint32_t kNumInstances = 50000;
+      static constexpr uint32_t kNumFrames = 100;
+      static constexpr uint32_t kCurrentFrame = 1000;
+
+      std::mt19937 generator(11);
+
+      // Heap allocated in shuffled order, as instances come and go over the lifetime of a scene
+      std::vector<std::unique_ptr<ColdInstance>> storage(kNumInstances);
+      for (auto& instance : storage) {
+        instance = std::make_unique<ColdInstance>();
+      }
+      std::vector<ColdInstance*> coldInstances(kNumInstances);
+      for (uint32_t i = 0; i < kNumInstances; i++) {
+        coldInstances[i] = storage[i].get();
+      }
+      std::shuffle(coldInstances.begin(), coldInstances.end(), generator);
+
+      InstanceHotState hotState;
+      for (uint32_t i = 0; i < kNumInstances; i++) {
+        // Most instances are drawn every frame, a few are past their lifetime
+        const uint32_t frameLastUpdated = kCurrentFrame - (i % 64 == 0 ? kNumFramesToKeep : 0);
+        hotState.add();
+        hotState.setFrameLastUpdated(i, frameLastUpdated);
+        coldInstances[i]->frameLastUpdated = frameLastUpdated;
+      }
+
+      uint32_t numExpiredCold = 0;
+      {
+        std::cout << "Running: " << kNumFrames << " GC scans over " << kNumInstances << " inline instances --> ";
+        Timer time;
+        for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+          for (const ColdInstance* instance : coldInstances) {
+            if ((instance->isInsideFrustum && instance->frameLastUpdated + kNumFramesToKeep <= kCurrentFrame) || instance->isMarkedForGC) {
+              numExpiredCold++;
+            }
+          }
+        }
+      }
+
+      uint32_t numExpiredHot = 0;
+      std::vector<uint32_t> expiredSlots;
+      {
+        std::cout << "Running: " << kNumFrames << " GC scans over " << kNumInstances << " hot state slots --> ";
+        Timer time;
+        for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+          expiredSlots.clear();
+          hotState.findExpired(kCurrentFrame, kNumFramesToKeep, [&](uint32_t slot) {
+            return hotState.hasFlag(slot, InstanceHotState::InsideFrustum);
+          }, expiredSlots);
+          numExpiredHot += static_cast<uint32_t>(expiredSlots.size());
+        }
+      }
+
+      expect(numExpiredCold == numExpiredHot, "Both layouts must expire the same instances");
+    }
+
+    // The reads of AccelManager::mergeInstancesIntoBlas: skip masked out instances, gather the transforms of the others
+    void benchmarkInstanceMerge() {
+      static constexpr uint32_t kNumInstances = 50000;
+      static constexpr uint32_t kNumFrames = 100;
+
+      std::mt19937 generator(13);
+
+      std::vector<std::unique_ptr<ColdInstance>> storage(kNumInstances);
+      for (auto& instance : storage) {
+        instance = std::make_unique<ColdInstance>();
+      }
+      std::vector<ColdInstance*> coldInstances(kNumInstances);
+      for (uint32_t i = 0; i < kNumInstances; i++) {
+        coldInstances[i] = storage[i].get();
+      }
+      std::shuffle(coldInstances.begin(), coldInstances.end(), generator);
+
+      InstanceHotState hotState;
+      for (uint32_t i = 0; i < kNumInstances; i++) {
+        VkAccelerationStructureInstanceKHR vkInstance {};
+        vkInstance.mask = i % 8 == 0 ? 0 : 0xff;
+        vkInstance.transform.matrix[0][3] = float(i);
+        hotState.add();
+        hotState.getVkInstance(i) = vkInstance;
+        coldInstances[i]->vkInstance = vkInstance;
+      }
+
+      std::vector<VkTransformMatrixKHR> transforms;
+      transforms.reserve(kNumInstances);
+
+      double sumCold = 0.0;
+      {
+        std::cout << "Running: " << kNumFrames << " instance merges over " << kNumInstances << " inline instances --> ";
+        Timer time;
+        for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+          transforms.clear();
+          for (const ColdInstance* instance : coldInstances) {
+            if (instance->vkInstance.mask != 0) {
+              transforms.push_back(instance->vkInstance.transform);
+            }
+          }
+          sumCold += transforms.back().matrix[0][3];
+        }
+      }
+
+      double sumHot = 0.0;
+      {
+        std::cout << "Running: " << kNumFrames << " instance merges over " << kNumInstances << " hot state slots --> ";
+        Timer time;
+        for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+          transforms.clear();
+          for (uint32_t slot = 0; slot < hotState.size(); slot++) {
+            const VkAccelerationStructureInstanceKHR& vkInstance = hotState.getVkInstance(slot);
+            if (vkInstance.mask != 0) {
+              transforms.push_back(vkInstance.transform);
+            }
+          }
+          sumHot += transforms.back().matrix[0][3];
+        }
+      }
+
+      expect(transforms.size() == kNumInstances - kNumInstances / 8, "Masked out instances must be skipped");
+      expect(sumHot == double(kNumFrames) * (kNumInstances - 1) && sumCold != 0.0, "Both layouts must gather the transforms");
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
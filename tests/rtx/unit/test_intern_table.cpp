@@ -0,0 +1,286 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_intern_table.h"
+#include "../../../src/util/util_timer.h"
+#include "../../../src/dxvk/rtx_render/rtx_material_intern_key.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_intern_table.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testInsertAndFind();
+      testConcurrentReaders();
+      testMaterialKeyViews();
+      benchmarkLookups();
+    }
+
+  private:
+    // Stand-in for an interned material, the key is derived from the contents so readers can validate what they find
+    struct Record {
+      XXH64_hash_t key;
+      uint32_t payload[15];
+
+      explicit Record(XXH64_hash_t key_) : key(key_) {
+        for (uint32_t i = 0; i < 15; i++) {
+          payload[i] = static_cast<uint32_t>(key_) + i;
+        }
+      }
+
+      bool isValid() const {
+        for (uint32_t i = 0; i < 15; i++) {
+          if (payload[i] != static_cast<uint32_t>(key) + i) {
+            return false;
+          }
+        }
+        return true;
+      }
+    };
+
+    static std::vector<XXH64_hash_t> generateKeys(uint32_t count, uint32_t seed) {
+      std::mt19937_64 rng(seed);
+      std::vector<XXH64_hash_t> keys(count);
+      for (auto& key : keys) {
+        key = rng();
+      }
+      return keys;
+    }
+
+    void testInsertAndFind() {
+      InternTable<Record> table(16);
+      const std::vector<XXH64_hash_t> keys = generateKeys(1000, 1);
+
+      uint32_t numCreated = 0;
+      std::vector<const Record*> records;
+      for (XXH64_hash_t key : keys) {
+        expect(table.find(key) == nullptr, "Key must not be found before it was inserted");
+        records.push_back(&table.findOrInsert(key, [&]() { numCreated++; return Record(key); }));
+      }
+
+      expect(numCreated == keys.size(), "Every new key must create its record once");
+      expect(table.size() == keys.size(), "Table size must match the number of inserted keys");
+      expect(table.capacity() >= 2 * table.size(), "Table must grow to keep the load factor at or below 1/2");
+
+      // Records must not move while the table grows, and inserting an existing key must not create a record
+      for (size_t i = 0; i < keys.size(); i++) {
+        expect(table.find(keys[i]) == records[i], "Found record must be the inserted one");
+        expect(&table.findOrInsert(keys[i], [&]() { numCreated++; return Record(0); }) == records[i], "Existing key must return its record");
+        expect(records[i]->key == keys[i] && records[i]->isValid(), "Record contents must be intact");
+      }
+      expect(numCreated == keys.size(), "Existing keys must not create records");
+
+      // The key used to mark empty slots must be usable like any other
+      table.findOrInsert(0, []() { return Record(0); });
+      expect(table.find(0) != nullptr && table.find(0)->key == 0, "Key 0 must be supported");
+
+      table.clear();
+      expect(table.size() == 0, "Cleared table must be empty");
+      for (XXH64_hash_t key : keys) {
+        expect(table.find(key) == nullptr, "Cleared table must not find old keys");
+      }
+      expect(table.find(0) == nullptr, "Cleared table must not find key 0");
+
+      std::cout << "InternTable insert and find tests passed" << std::endl;
+    }
+
+    // The same game image sampled through its linear and its sRGB view must resolve to different materials
+    void testMaterialKeyViews() {
+      static constexpr XXH64_hash_t kImageHash = 0x1234567890abcdefull;
+      static constexpr uint32_t kNumMips = 10;
+
+      auto makeKey = [](size_t viewKey, VkFormat format, uint32_t minLevel) {
+        MaterialInternKey key;
+        key.textures[0].imageHash = kImageHash;
+        key.textures[0].viewKey = viewKey;
+        key.textures[0].format = format;
+        key.textures[0].minLevel = minLevel;
+        key.textures[0].numLevels = kNumMips - minLevel;
+        key.textures[0].numLayers = 1;
+        key.sampler = reinterpret_cast<const void*>(uintptr_t(0x1000));
+        return key;
+      };
+
+      const MaterialInternKey linearKey = makeKey(1, VK_FORMAT_R8G8B8A8_UNORM, 0);
+      const MaterialInternKey srgbKey = makeKey(2, VK_FORMAT_R8G8B8A8_SRGB, 0);
+
+      expect(linearKey.getHash() == makeKey(1, VK_FORMAT_R8G8B8A8_UNORM, 0).getHash(), "The same view must produce the same key");
+      expect(linearKey.getHash() != srgbKey.getHash(), "The linear and sRGB views of an image must produce different keys");
+      expect(linearKey.getHash() != makeKey(1, VK_FORMAT_R8G8B8A8_SRGB, 0).getHash(), "The view format must be part of the key");
+      expect(linearKey.getHash() != makeKey(1, VK_FORMAT_R8G8B8A8_UNORM, 2).getHash(), "The mip range of the view must be part of the key");
+
+      // Interned the way SceneManager does, each view must get its own record
+      InternTable<Record> table(16);
+      const Record& linearRecord = table.findOrInsert(linearKey.getHash(), [&]() { return Record(1); });
+      const Record& srgbRecord = table.findOrInsert(srgbKey.getHash(), [&]() { return Record(2); });
+      expect(table.size() == 2 && &linearRecord != &srgbRecord, "Each view must intern its own material");
+      expect(table.findOrInsert(linearKey.getHash(), [&]() { return Record(3); }).key == 1, "The linear view must find its material");
+      expect(table.findOrInsert(srgbKey.getHash(), [&]() { return Record(4); }).key == 2, "The sRGB view must find its material");
+
+      std::cout << "Material key view tests passed" << std::endl;
+    }
+
+    void testConcurrentReaders() {
+      const uint32_t kNumReaders = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+      const std::vector<XXH64_hash_t> keys = generateKeys(1 << 16, 2);
+
+      InternTable<Record> table(16);
+      std::atomic<uint32_t> numPublished { 0 };
+      std::atomic<bool> done { false };
+      std::atomic<uint32_t> numErrors { 0 };
+      std::atomic<uint64_t> numHits { 0 };
+
+      // Readers probe keys the writer may be inserting at the same time. Keys published before a lookup started
+      // can only be missed while the table grows, every record found must be complete.
+      std::vector<std::thread> readers;
+      for (uint32_t r = 0; r < kNumReaders; r++) {
+        readers.emplace_back([&, r]() {
+          std::mt19937 rng(r);
+          uint64_t hits = 0;
+          while (!done.load(std::memory_order_acquire)) {
+            const uint32_t published = numPublished.load(std::memory_order_acquire);
+            const XXH64_hash_t key = keys[rng() % keys.size()];
+            if (const Record* pRecord = table.find(key)) {
+              if (pRecord->key != key || !pRecord->isValid()) {
+                numErrors++;
+              }
+              hits++;
+            }
+            if (published > 0) {
+              const XXH64_hash_t publishedKey = keys[rng() % published];
+              const Record* pRecord = table.find(publishedKey);
+              if (pRecord != nullptr && (pRecord->key != publishedKey || !pRecord->isValid())) {
+                numErrors++;
+              }
+            }
+          }
+          numHits += hits;
+        });
+      }
+
+      for (uint32_t i = 0; i < keys.size(); i++) {
+        table.findOrInsert(keys[i], [&]() { return Record(keys[i]); });
+        numPublished.store(i + 1, std::memory_order_release);
+      }
+
+      // Once the writer is done every key must be found by every reader
+      std::atomic<uint32_t> numMissing { 0 };
+      std::vector<std::thread> verifiers;
+      for (uint32_t r = 0; r < kNumReaders; r++) {
+        verifiers.emplace_back([&]() {
+          for (XXH64_hash_t key : keys) {
+            if (table.find(key) == nullptr) {
+              numMissing++;
+            }
+          }
+        });
+      }
+      for (auto& verifier : verifiers) {
+        verifier.join();
+      }
+
+      done.store(true, std::memory_order_release);
+      for (auto& reader : readers) {
+        reader.join();
+      }
+
+      expect(numErrors == 0, "Readers must never observe partially published records");
+      expect(numMissing == 0, "All records must be found after the writer finished");
+
+      std::cout << "InternTable concurrent reader tests passed (" << kNumReaders << " readers, " << numHits.load() << " hits)" << std::endl;
+    }
+
+    void benchmarkLookups() {
+      const uint32_t kNumKeys = 4096;
+      const uint32_t kNumLookups = 1 << 22;
+      const uint32_t kNumThreads = 4;
+      const std::vector<XXH64_hash_t> keys = generateKeys(kNumKeys, 3);
+
+      // Draw calls reference a small number of materials many times each
+      std::vector<XXH64_hash_t> lookups(kNumLookups);
+      std::mt19937 rng(4);
+      for (auto& lookup : lookups) {
+        lookup = keys[rng() % kNumKeys];
+      }
+
+      InternTable<Record> table;
+      std::unordered_map<XXH64_hash_t, Record> map;
+      std::mutex mapMutex;
+      for (XXH64_hash_t key : keys) {
+        table.findOrInsert(key, [&]() { return Record(key); });
+        map.emplace(key, Record(key));
+      }
+
+      auto runThreads = [&](auto&& lookup) {
+        std::atomic<uint64_t> checksum { 0 };
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < kNumThreads; t++) {
+          threads.emplace_back([&, t]() {
+            uint64_t sum = 0;
+            for (uint32_t i = t; i < kNumLookups; i += kNumThreads) {
+              sum += lookup(lookups[i])->payload[0];
+            }
+            checksum += sum;
+          });
+        }
+        for (auto& thread : threads) {
+          thread.join();
+        }
+        return checksum.load();
+      };
+
+      uint64_t checksumMap, checksumTable;
+      {
+        std::cout << "Running: " << kNumLookups << " lookups from " << kNumThreads << " threads, mutex + unordered_map --> ";
+        Timer time;
+        checksumMap = runThreads([&](XXH64_hash_t key) {
+          std::lock_guard<std::mutex> lock(mapMutex);
+          return &map.find(key)->second;
+        });
+      }
+      {
+        std::cout << "Running: " << kNumLookups << " lookups from " << kNumThreads << " threads, InternTable --> ";
+        Timer time;
+        checksumTable = runThreads([&](XXH64_hash_t key) {
+          return table.find(key);
+        });
+      }
+
+      expect(checksumMap == checksumTable, "Both lookups must find the same records");
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
@@ -0,0 +1,212 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cmath>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_matrix.h"
+#include "../../../src/dxvk/rtx_render/rtx_keyframe_reducer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_keyframe_reducer.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testLinearTranslation();
+      testConstantRotation();
+      testMaxDropped();
+      testNonIncreasingTimes();
+      testSlerpEndpoints();
+      testReproducedCurve();
+    }
+
+  private:
+    struct Sample {
+      double time;
+      Matrix4d xform;
+    };
+
+    using Track = std::vector<Sample>;
+
+    static constexpr XformTolerance kTolerance { 1e-3, 1e-3 };
+
+    // Same steps as GameCapturer appending an instance transform
+    template<typename Interpolate>
+    static void append(KeyframeReducer<Matrix4d>& reducer, Track& track, const Sample& sample, const Interpolate& interpolate) {
+      const auto reproduces = [&](const Matrix4d& a, const Matrix4d& b, double t, const Matrix4d& s) {
+        return isXformWithinTolerance(interpolate(a, b, t), s, kTolerance);
+      };
+
+      if (track.size() >= 2) {
+        const Sample& key = track[track.size() - 2];
+        Sample& tail = track.back();
+        if (reducer.dropTail(key.time, key.xform, tail.time, tail.xform, sample.time, sample.xform, reproduces)) {
+          tail = sample;
+          return;
+        }
+      }
+      track.push_back(sample);
+    }
+
+    static Matrix4d rotationZ(double angle, const Vector3d& translation = Vector3d(0.0), double scale = 1.0) {
+      Matrix4d m(Vector4d(0.0, 0.0, std::sin(angle / 2.0), std::cos(angle / 2.0)), translation);
+      for (int row = 0; row < 3; row++) {
+        m[row] *= scale;
+        m[row][3] = 0.0;
+      }
+      return m;
+    }
+
+    // Interpolates a reduced track at time, the way USD plays it back
+    template<typename Interpolate>
+    static Matrix4d evaluate(const Track& track, double time, const Interpolate& interpolate) {
+      if (time <= track.front().time) {
+        return track.front().xform;
+      }
+      for (size_t i = 1; i < track.size(); i++) {
+        if (time <= track[i].time) {
+          const double t = (time - track[i - 1].time) / (track[i].time - track[i - 1].time);
+          return interpolate(track[i - 1].xform, track[i].xform, t);
+        }
+      }
+      return track.back().xform;
+    }
+
+    static Matrix4d lerp(const Matrix4d& a, const Matrix4d& b, double t) {
+      return lerpXform(a, b, t);
+    }
+
+    static Matrix4d slerp(const Matrix4d& a, const Matrix4d& b, double t) {
+      return slerpXform(a, b, t);
+    }
+
+    void testLinearTranslation() {
+      KeyframeReducer<Matrix4d> reducer(1000);
+      Track track;
+      for (int frame = 0; frame < 100; frame++) {
+        append(reducer, track, { double(frame), Matrix4d(Vector3d(frame * 0.5, 2.0, -frame * 0.25)) }, lerp);
+      }
+
+      expect(track.size() == 2, "Linear motion must reduce to its end points");
+      expect(track.front().time == 0.0 && track.back().time == 99.0, "End points must be kept");
+
+      // A stop is a corner of the motion, and must be kept
+      for (int frame = 100; frame < 150; frame++) {
+        append(reducer, track, { double(frame), Matrix4d(Vector3d(99 * 0.5, 2.0, -99 * 0.25)) }, lerp);
+      }
+      expect(track.size() == 3 && track[1].time == 99.0, "The stop of the motion must be kept");
+    }
+
+    void testConstantRotation() {
+      constexpr double kAngularVelocity = 0.02;
+
+      KeyframeReducer<Matrix4d> slerpReducer(1000);
+      KeyframeReducer<Matrix4d> lerpReducer(1000);
+      Track slerpTrack;
+      Track lerpTrack;
+      for (int frame = 0; frame < 60; frame++) {
+        const Sample sample { double(frame), rotationZ(frame * kAngularVelocity, Vector3d(1.0, 2.0, 3.0), 2.0) };
+        append(slerpReducer, slerpTrack, sample, slerp);
+        append(lerpReducer, lerpTrack, sample, lerp);
+      }
+
+      expect(slerpTrack.size() == 2, "Constant rotation must reduce to its end points with slerp");
+      expect(lerpTrack.size() > 2 && lerpTrack.size() < 60, "Component wise interpolation only reproduces short arcs of a rotation");
+    }
+
+    void testMaxDropped() {
+      KeyframeReducer<Matrix4d> reducer(4);
+      Track track;
+      for (int frame = 0; frame < 21; frame++) {
+        append(reducer, track, { double(frame), Matrix4d(Vector3d(double(frame))) }, lerp);
+      }
+
+      // A key every 5 samples
+      expect(track.size() == 5, "Keys must be forced every maxDropped + 1 samples");
+      for (size_t i = 0; i < track.size() - 1; i++) {
+        expect(track[i].time == double(i * 5), "Forced keys must be evenly spaced");
+      }
+
+      KeyframeReducer<Matrix4d> disabled(0);
+      Track fullTrack;
+      for (int frame = 0; frame < 10; frame++) {
+        append(disabled, fullTrack, { double(frame), Matrix4d() }, lerp);
+      }
+      expect(fullTrack.size() == 10, "No sample may be dropped with maxDropped 0");
+    }
+
+    void testNonIncreasingTimes() {
+      KeyframeReducer<Matrix4d> reducer(1000);
+      Track track;
+      append(reducer, track, { 0.0, Matrix4d() }, lerp);
+      append(reducer, track, { 1.0, Matrix4d() }, lerp);
+      append(reducer, track, { 1.0, Matrix4d() }, lerp);
+      expect(track.size() == 3, "A sample at the time of the tail must not replace it");
+      expect(reducer.numDropped() == 0, "Keeping the tail must reset the dropped samples");
+    }
+
+    void testSlerpEndpoints() {
+      const Matrix4d a = rotationZ(0.3, Vector3d(1.0, 0.0, 0.0), 0.5);
+      Matrix4d b = rotationZ(2.5, Vector3d(0.0, 4.0, 0.0), 3.0);
+
+      expect(isXformWithinTolerance(slerpXform(a, b, 0.0), a, { 1e-9, 1e-9 }), "slerpXform at 0 must return a");
+      expect(isXformWithinTolerance(slerpXform(a, b, 1.0), b, { 1e-9, 1e-9 }), "slerpXform at 1 must return b");
+
+      const Matrix4d half = slerpXform(a, b, 0.5);
+      expect(isXformWithinTolerance(half, rotationZ(1.4, Vector3d(0.5, 2.0, 0.0), 1.75), { 1e-9, 1e-9 }),
+             "slerpXform must interpolate the angle, translation and scale");
+
+      // Mirrored on both ends
+      Matrix4d mirroredA = a;
+      mirroredA[0] *= -1.0;
+      b[0] *= -1.0;
+      expect(isXformWithinTolerance(slerpXform(mirroredA, b, 1.0), b, { 1e-9, 1e-9 }), "slerpXform must keep mirroring");
+    }
+
+    void testReproducedCurve() {
+      // Every captured sample must be within tolerance of the reduced track
+      KeyframeReducer<Matrix4d> reducer(64);
+      Track track;
+      std::vector<Sample> samples;
+      for (int frame = 0; frame < 500; frame++) {
+        const double time = frame * 0.7;
+        const Sample sample { time, rotationZ(std::sin(time * 0.02), Vector3d(std::cos(time * 0.01) * 10.0, time * 0.1, 0.0)) };
+        samples.push_back(sample);
+        append(reducer, track, sample, slerp);
+      }
+
+      expect(track.size() < samples.size() / 4, "A smooth curve must drop most of its samples");
+      for (const Sample& sample : samples) {
+        expect(isXformWithinTolerance(evaluate(track, sample.time, slerp), sample.xform, kTolerance),
+               "A dropped sample must be reproduced by the reduced track");
+      }
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
@@ -0,0 +1,168 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_light_buffer_layout.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_light_buffer_layout.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testTypeRanges();
+      testStableOrder();
+      testMapping();
+      testSteadyState();
+    }
+
+  private:
+    static constexpr uint32_t kNumTypes = 5;
+    static constexpr uint16_t kNewLightIdx = 0xFFFF;
+
+    using Layout = LightBufferLayout<kNumTypes>;
+
+    struct Light {
+      uint32_t type;
+      uint16_t bufferIdx = kNewLightIdx;
+    };
+
+    // Lays out a frame the way LightManager does, and returns the mapping
+    static std::vector<uint16_t> layoutFrame(Layout& layout, std::vector<Light>& lights, uint32_t previousCount) {
+      layout.clear();
+      for (uint32_t i = 0; i < lights.size(); i++) {
+        layout.add(i, lights[i].type, lights[i].bufferIdx);
+      }
+      layout.build();
+
+      std::vector<uint16_t> mapping(layout.size() + previousCount);
+      layout.writeMapping(mapping.data(), previousCount, kNewLightIdx);
+
+      for (uint32_t bufferIdx = 0; bufferIdx < layout.size(); bufferIdx++) {
+        lights[layout.getSource(bufferIdx)].bufferIdx = static_cast<uint16_t>(bufferIdx);
+      }
+      return mapping;
+    }
+
+    static std::vector<Light> createLights(uint32_t count) {
+      std::vector<Light> lights;
+      for (uint32_t i = 0; i < count; i++) {
+        lights.push_back(Light { (i * 7) % kNumTypes });
+      }
+      return lights;
+    }
+
+    void testTypeRanges() {
+      Layout layout;
+      std::vector<Light> lights = createLights(1000);
+      layoutFrame(layout, lights, 0);
+
+      uint32_t offset = 0;
+      for (uint32_t type = 0; type < kNumTypes; type++) {
+        const LightRange& range = layout.getRanges()[type];
+        expect(range.offset == offset, "Type ranges should be contiguous and in type order");
+        expect(range.count == 200, "Unexpected light count in a type range");
+        offset += range.count;
+
+        for (uint32_t bufferIdx = range.offset; bufferIdx < range.offset + range.count; bufferIdx++) {
+          expect(lights[layout.getSource(bufferIdx)].type == type, "A light was placed outside of its type range");
+        }
+      }
+    }
+
+    void testStableOrder() {
+      // Lights keep their collection order within their type
+      Layout layout;
+      std::vector<Light> lights = createLights(100);
+      layoutFrame(layout, lights, 0);
+
+      for (uint32_t bufferIdx = 1; bufferIdx < layout.size(); bufferIdx++) {
+        const uint32_t previous = layout.getSource(bufferIdx - 1);
+        const uint32_t current = layout.getSource(bufferIdx);
+        if (lights[previous].type == lights[current].type) {
+          expect(previous < current, "Lights of a type should keep their collection order");
+        }
+      }
+    }
+
+    void testMapping() {
+      Layout layout;
+      std::vector<Light> lights = createLights(50);
+      layoutFrame(layout, lights, 0);
+      const uint32_t previousCount = layout.size();
+
+      // Remove a few lights and add new ones
+      std::vector<Light> previousLights = lights;
+      lights.erase(lights.begin() + 10);
+      lights.erase(lights.begin() + 20);
+      lights.push_back(Light { 0 });
+      lights.push_back(Light { 3 });
+
+      std::vector<Light> currentLights = lights;
+      const std::vector<uint16_t> mapping = layoutFrame(layout, lights, previousCount);
+      const uint32_t currentCount = layout.size();
+
+      expect(mapping.size() == currentCount + previousCount, "Unexpected mapping size");
+
+      for (uint32_t i = 0; i < lights.size(); i++) {
+        const uint16_t previousIdx = currentLights[i].bufferIdx;
+        const uint16_t currentIdx = lights[i].bufferIdx;
+
+        expect(mapping[currentIdx] == previousIdx, "Current to previous mapping mismatch");
+        if (previousIdx != kNewLightIdx) {
+          expect(mapping[currentCount + previousIdx] == currentIdx, "Previous to current mapping mismatch");
+        }
+      }
+
+      // The buffer slots of the removed lights map to nothing
+      expect(mapping[currentCount + previousLights[10].bufferIdx] == kNewLightIdx, "A removed light should not be mapped");
+      expect(mapping[currentCount + previousLights[21].bufferIdx] == kNewLightIdx, "A removed light should not be mapped");
+    }
+
+    void testSteadyState() {
+      // An unchanged light set keeps its buffer indices, so its buffer contents and mapping don't change either
+      Layout layout;
+      std::vector<Light> lights = createLights(300);
+      layoutFrame(layout, lights, 0);
+
+      const std::vector<Light> firstFrame = lights;
+      const std::vector<uint16_t> mapping = layoutFrame(layout, lights, layout.size());
+
+      for (uint32_t i = 0; i < lights.size(); i++) {
+        expect(lights[i].bufferIdx == firstFrame[i].bufferIdx, "Buffer indices should be stable");
+      }
+
+      expect(layoutFrame(layout, lights, layout.size()) == mapping, "The mapping should be stable");
+      for (uint32_t i = 0; i < layout.size(); i++) {
+        expect(mapping[i] == i && mapping[layout.size() + i] == i, "The mapping should be the identity");
+      }
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
@@ -0,0 +1,311 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_memoization.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_memoization.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testContainingRange();
+      testCachedPageSummaries();
+      testRevalidation();
+      testOverlappingInsert();
+      testRingBufferReplay();
+      testDeferredInsertion();
+    }
+
+  private:
+    struct MinMax {
+      uint32_t min, max;
+    };
+
+    // Stands in for the rebased index copy: the start of the range the indices were copied from, and their min
+    struct Result {
+      size_t start;
+      uint32_t min;
+    };
+
+    using Memoizer = MemoryRegionMemoizer<Result, MinMax>;
+    static constexpr size_t kPageSize = Memoizer::kPageSize;
+
+    struct Processed {
+      MinMax range;
+      bool cached;   // Exact cached range
+      bool reused;   // Slice of a larger cached range
+    };
+
+    std::vector<MinMax> m_pages;
+    uint32_t m_numSummarized = 0;
+
+    static MinMax findMinMax(const std::vector<uint16_t>& buffer, size_t start, size_t size) {
+      MinMax range { UINT32_MAX, 0 };
+      for (size_t i = start / 2; i < (start + size) / 2; i++) {
+        range.min = std::min<uint32_t>(range.min, buffer[i]);
+        range.max = std::max<uint32_t>(range.max, buffer[i]);
+      }
+      return range;
+    }
+
+    // Mirrors D3D9Rtx::processMemoizedIndexBuffer for 16 bit indices
+    Processed process(Memoizer& memoizer, const std::vector<uint16_t>& buffer, size_t start, size_t size) {
+      const uint8_t* pBuffer = reinterpret_cast<const uint8_t*>(buffer.data());
+
+      const Memoizer::Entry* pCached = memoizer.find(pBuffer, start, size);
+      if (pCached != nullptr && pCached->start == start && pCached->end == start + size) {
+        return { findMinMax(buffer, start, size), true, false };
+      }
+
+      memoizer.summarizePages(pBuffer, start, size, [this](const uint8_t* pData, size_t pageSize) {
+        m_numSummarized++;
+
+        MinMax range { UINT32_MAX, 0 };
+        for (size_t i = 0; i < pageSize / 2; i++) {
+          const uint16_t index = reinterpret_cast<const uint16_t*>(pData)[i];
+          range.min = std::min<uint32_t>(range.min, index);
+          range.max = std::max<uint32_t>(range.max, index);
+        }
+        return range;
+      }, m_pages);
+
+      MinMax range { UINT32_MAX, 0 };
+      for (const MinMax& page : m_pages) {
+        range.min = std::min(range.min, page.min);
+        range.max = std::max(range.max, page.max);
+      }
+
+      if (pCached != nullptr && pCached->result.min == range.min) {
+        return { range, false, true };
+      }
+
+      memoizer.insert(pBuffer, start, size, Result { start, range.min }, m_pages);
+      return { range, false, false };
+    }
+
+    void expectProcessed(Memoizer& memoizer, const std::vector<uint16_t>& buffer, size_t start, size_t size,
+                         bool cached, bool reused, const char* message) {
+      const Processed processed = process(memoizer, buffer, start, size);
+      const MinMax expected = findMinMax(buffer, start, size);
+
+      expect(processed.range.min == expected.min && processed.range.max == expected.max, "Min/max differ from the buffer data");
+      expect(processed.cached == cached && processed.reused == reused, message);
+    }
+
+    static std::vector<uint16_t> makeBuffer(size_t numIndices, uint32_t seed) {
+      std::mt19937 rng(seed);
+      std::vector<uint16_t> buffer(numIndices);
+      for (uint16_t& index : buffer) {
+        index = static_cast<uint16_t>(rng() % 60000 + 100);
+      }
+      return buffer;
+    }
+
+    void testContainingRange() {
+      Memoizer memoizer;
+      std::vector<uint16_t> buffer = makeBuffer(8192, 1);
+
+      // A sub-range whose min is the one of the larger range reuses its copy
+      buffer[1000] = 1;
+      expectProcessed(memoizer, buffer, 0, 8192, false, false, "First request must be computed");
+      expectProcessed(memoizer, buffer, 0, 8192, true, false, "Exact request must hit");
+      expectProcessed(memoizer, buffer, 1900, 600, false, true, "Sub-range with the same min must reuse the larger range");
+
+      // Otherwise it is cached on its own, and the larger range keeps serving other requests
+      expectProcessed(memoizer, buffer, 4000, 600, false, false, "Sub-range with a different min must be computed");
+      expectProcessed(memoizer, buffer, 4000, 600, true, false, "Computed sub-range must hit");
+      expectProcessed(memoizer, buffer, 0, 8192, true, false, "Larger range must still hit");
+      expect(memoizer.size() == 2, "Larger range and sub-range must both be cached");
+
+      // The smallest containing range is preferred
+      const uint8_t* pBuffer = reinterpret_cast<const uint8_t*>(buffer.data());
+      const Memoizer::Entry* pEntry = memoizer.find(pBuffer, 4100, 100);
+      expect(pEntry != nullptr && pEntry->start == 4000, "Smallest containing range must be found");
+      expect(memoizer.find(pBuffer, 8000, 1000) == nullptr, "Range extending past the cached ones must miss");
+    }
+
+    void testCachedPageSummaries() {
+      Memoizer memoizer;
+      std::vector<uint16_t> buffer = makeBuffer(4 * kPageSize / 2, 2);
+
+      // Pages 0-2 cached, a request over pages 1-3 only summarizes page 3 and its partial first page
+      expectProcessed(memoizer, buffer, 0, 3 * kPageSize, false, false, "First request must be computed");
+
+      m_numSummarized = 0;
+      expectProcessed(memoizer, buffer, kPageSize + 100, 3 * kPageSize - 100, false, false, "Overlapping request must be computed");
+      expect(m_numSummarized == 2, "Pages of cached ranges must not be summarized again");
+    }
+
+    void testRevalidation() {
+      Memoizer memoizer;
+      std::vector<uint16_t> buffer = makeBuffer(4 * kPageSize / 2, 3);
+
+      expectProcessed(memoizer, buffer, 0, kPageSize, false, false, "First request must be computed");
+      expectProcessed(memoizer, buffer, 2 * kPageSize, kPageSize, false, false, "First request must be computed");
+
+      // DISCARD with the same data uploaded again
+      memoizer.invalidateAll();
+      expectProcessed(memoizer, buffer, 0, kPageSize, true, false, "Unchanged data must keep its cached result");
+
+      // DISCARD with different data: only the changed range is dropped
+      memoizer.invalidateAll();
+      buffer[2 * kPageSize / 2 + 10]++;
+      expectProcessed(memoizer, buffer, 2 * kPageSize, kPageSize, false, false, "Changed data must be computed again");
+      expectProcessed(memoizer, buffer, 0, kPageSize, true, false, "Unchanged data must keep its cached result");
+
+      // Partial write
+      memoizer.invalidate(100, 2);
+      buffer[50]++;
+      expectProcessed(memoizer, buffer, 0, kPageSize, false, false, "Written range must be computed again");
+      expectProcessed(memoizer, buffer, 2 * kPageSize, kPageSize, true, false, "Ranges not written must still hit");
+
+      // Lock of the whole buffer leaving the data unchanged
+      memoizer.invalidate(0, 4 * kPageSize);
+      expectProcessed(memoizer, buffer, 0, kPageSize, true, false, "Unchanged data must keep its cached result");
+    }
+
+    void testOverlappingInsert() {
+      Memoizer memoizer;
+      std::vector<uint16_t> buffer = makeBuffer(4096, 4);
+
+      expectProcessed(memoizer, buffer, 0, 1000, false, false, "First request must be computed");
+      expectProcessed(memoizer, buffer, 2000, 1000, false, false, "First request must be computed");
+
+      // Overlaps both cached ranges without being contained: both are replaced
+      expectProcessed(memoizer, buffer, 500, 2000, false, false, "Overlapping request must be computed");
+      expect(memoizer.size() == 1, "Overlapped ranges must be dropped");
+
+      const uint8_t* pBuffer = reinterpret_cast<const uint8_t*>(buffer.data());
+      expect(memoizer.find(pBuffer, 0, 1000) == nullptr, "Overlapped range must be dropped");
+      expect(memoizer.find(pBuffer, 2000, 1000) == nullptr, "Overlapped range must be dropped");
+
+      memoizer.clear();
+      expect(memoizer.size() == 0 && memoizer.find(pBuffer, 500, 2000) == nullptr, "Clear must drop every range");
+    }
+
+    // Dynamic index buffer written as a ring: NOOVERWRITE locks at increasing offsets, DISCARD at the start of each
+    // frame. Most draws upload the same indices each frame, some change.
+    void testRingBufferReplay() {
+      constexpr size_t kBufferSize = 512 * 1024;
+      constexpr uint32_t kNumFrames = 20;
+      constexpr uint32_t kNumDraws = 150;
+
+      std::mt19937 rng(5);
+      std::vector<uint16_t> drawSizes(kNumDraws);
+      std::vector<uint16_t> drawBases(kNumDraws);
+      for (uint32_t draw = 0; draw < kNumDraws; draw++) {
+        drawSizes[draw] = static_cast<uint16_t>(rng() % 600 + 6);
+        drawBases[draw] = static_cast<uint16_t>(rng() % 1000);
+      }
+
+      Memoizer memoizer;
+      std::vector<uint16_t> buffer(kBufferSize / 2, 0);
+      uint32_t numHits = 0;
+
+      for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+        memoizer.invalidateAll();
+        size_t offset = 0;
+
+        for (uint32_t draw = 0; draw < kNumDraws; draw++) {
+          const size_t size = drawSizes[draw] * sizeof(uint16_t);
+          memoizer.invalidate(offset, size);
+
+          const bool changed = rng() % 10 == 0;
+          for (size_t i = 0; i < drawSizes[draw]; i++) {
+            buffer[offset / 2 + i] = static_cast<uint16_t>(drawBases[draw] + (i * 7) % 300 + (changed ? rng() % 50 : 0));
+          }
+
+          // The indices are drawn in full, then their first half again (i.e. a second pass)
+          const size_t halfSize = size / 2 & ~size_t(1);
+          for (const size_t drawSize : { size, halfSize }) {
+            const Processed processed = process(memoizer, buffer, offset, drawSize);
+            const MinMax expected = findMinMax(buffer, offset, drawSize);
+
+            expect(processed.range.min == expected.min && processed.range.max == expected.max, "Min/max differ from the buffer data");
+            expect(frame > 0 || !processed.cached, "Nothing can be cached on the first frame");
+            numHits += processed.cached || processed.reused ? 1 : 0;
+          }
+
+          offset += size;
+        }
+      }
+
+      // Every draw is at the same offset each frame, but a memoizer wiped on DISCARD would only hit on second passes
+      // reusing the min of the full draw. Roughly 90% of the draws are unchanged from one frame to the next.
+      expect(numHits > kNumDraws * 2 * (kNumFrames - 1) * 7 / 10, "Ring buffer replay must reuse cached results across DISCARDs");
+    }
+
+    // Ring written with offsets drifting from lap to lap: nothing is ever reused, so ranges stop being cached until
+    // a request comes again
+    void testDeferredInsertion() {
+      constexpr size_t kBufferSize = 64 * 1024;
+
+      std::mt19937 rng(6);
+      Memoizer memoizer;
+      std::vector<uint16_t> buffer(kBufferSize / 2, 0);
+
+      for (uint32_t lap = 0; lap < 4; lap++) {
+        memoizer.invalidateAll();
+
+        for (size_t offset = lap * 6, draw = 0; ; draw++) {
+          const size_t size = (100 + draw % 13 * 10) * sizeof(uint16_t);
+          if (offset + size > kBufferSize) {
+            break;
+          }
+
+          memoizer.invalidate(offset, size);
+          for (size_t i = offset / 2; i < (offset + size) / 2; i++) {
+            buffer[i] = static_cast<uint16_t>(rng() % 60000);
+          }
+
+          expectProcessed(memoizer, buffer, offset, size, false, false, "Drifting ring requests can't be reused");
+          offset += size;
+        }
+      }
+
+      expect(memoizer.isInsertionDeferred(), "Insertion must be deferred once cached ranges keep going unused");
+      expect(memoizer.size() == 0, "Unused ranges must be dropped once insertion is deferred");
+
+      // A request coming again is cached on its second occurrence, and its first hit resumes caching every range
+      expectProcessed(memoizer, buffer, 1000, 400, false, false, "First request must be computed");
+      expect(memoizer.size() == 0, "First request must not be cached while insertion is deferred");
+      expectProcessed(memoizer, buffer, 1000, 400, false, false, "Second request must be computed");
+      expectProcessed(memoizer, buffer, 1000, 400, true, false, "Third request must hit");
+      expect(!memoizer.isInsertionDeferred(), "A hit must resume caching every range");
+
+      expectProcessed(memoizer, buffer, 3000, 400, false, false, "First request must be computed");
+      expectProcessed(memoizer, buffer, 3000, 400, true, false, "Second request must hit once caching resumed");
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
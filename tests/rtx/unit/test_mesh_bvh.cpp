@@ -0,0 +1,400 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <random>
+#include "../../test_utils.h"
+#include "../../../src/util/util_mesh_bvh.h"
+#include "../../../src/util/util_timer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_mesh_bvh.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    static constexpr uint32_t kNumTriangles = 20000;
+    static constexpr uint32_t kNumRays = 20000;
+    static constexpr uint32_t kNumPoints = 2000;
+
+    void run() {
+      testEmpty();
+      testRandomMeshIntersection();
+      testClosestPoint();
+      testInsideOutside();
+      benchmark();
+    }
+
+  private:
+    struct Mesh {
+      std::vector<Vector3> positions;
+      std::vector<uint32_t> indices;
+    };
+
+    struct Ray {
+      Vector3 origin;
+      Vector3 direction;
+    };
+
+    static constexpr float kPi = 3.14159265358979f;
+
+    std::mt19937 m_rng { 1234 };
+
+    float random(float min, float max) {
+      return std::uniform_real_distribution<float>(min, max)(m_rng);
+    }
+
+    Vector3 randomPoint(float extent) {
+      return Vector3(random(-extent, extent), random(-extent, extent), random(-extent, extent));
+    }
+
+    // Soup of small triangles scattered inside of <-10, 10>^3
+    Mesh makeRandomMesh(uint32_t numTriangles) {
+      Mesh mesh;
+      for (uint32_t i = 0; i < numTriangles; i++) {
+        const Vector3 center = randomPoint(10.f);
+        for (uint32_t v = 0; v < 3; v++) {
+          mesh.indices.push_back(static_cast<uint32_t>(mesh.positions.size()));
+          mesh.positions.push_back(center + randomPoint(0.5f));
+        }
+      }
+      return mesh;
+    }
+
+    // Closed UV sphere
+    static Mesh makeSphere(float radius, uint32_t rings, uint32_t segments) {
+      Mesh mesh;
+      for (uint32_t r = 0; r <= rings; r++) {
+        const float theta = kPi * r / rings;
+        for (uint32_t s = 0; s <= segments; s++) {
+          const float phi = 2.f * kPi * s / segments;
+          mesh.positions.push_back(Vector3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)) * radius);
+        }
+      }
+
+      for (uint32_t r = 0; r < rings; r++) {
+        for (uint32_t s = 0; s < segments; s++) {
+          const uint32_t i0 = r * (segments + 1) + s;
+          const uint32_t i1 = i0 + segments + 1;
+          mesh.indices.insert(mesh.indices.end(), { i0, i1, i0 + 1, i0 + 1, i1, i1 + 1 });
+        }
+      }
+      return mesh;
+    }
+
+    // Rays from a shell around the mesh aimed at random points inside of it
+    std::vector<Ray> makeRays(uint32_t count) {
+      std::vector<Ray> rays(count);
+      for (Ray& ray : rays) {
+        ray.origin = normalize(randomPoint(1.f)) * 30.f;
+        ray.direction = normalize(randomPoint(8.f) - ray.origin);
+      }
+      return rays;
+    }
+
+    static MeshBvh buildBvh(const Mesh& mesh) {
+      MeshBvh bvh;
+      bvh.build(mesh.positions.data(), static_cast<uint32_t>(mesh.positions.size()), mesh.indices.data(), static_cast<uint32_t>(mesh.indices.size()));
+      return bvh;
+    }
+
+    // Two-sided Moller-Trumbore, returns the barycentric margin to the closest edge through edgeMargin
+    static bool intersectTriangle(const Ray& ray, const Vector3& a, const Vector3& b, const Vector3& c, float& t, float& edgeMargin) {
+      const Vector3 e1 = b - a;
+      const Vector3 e2 = c - a;
+      const Vector3 p = cross(ray.direction, e2);
+      const float det = dot(e1, p);
+      if (std::abs(det) < 1e-12f) {
+        return false;
+      }
+
+      const float invDet = 1.f / det;
+      const Vector3 s = ray.origin - a;
+      const float u = dot(s, p) * invDet;
+      const Vector3 q = cross(s, e1);
+      const float v = dot(ray.direction, q) * invDet;
+      t = dot(e2, q) * invDet;
+      edgeMargin = std::min(std::min(u, v), 1.f - u - v);
+
+      return edgeMargin >= 0.f && t > 0.f;
+    }
+
+    static MeshBvh::RayHit bruteForceIntersect(const Mesh& mesh, const Ray& ray, float& edgeMargin) {
+      MeshBvh::RayHit hit;
+      edgeMargin = FLT_MAX;
+      for (uint32_t i = 0; i < mesh.indices.size() / 3; i++) {
+        float t, margin;
+        if (intersectTriangle(ray, mesh.positions[mesh.indices[i * 3]], mesh.positions[mesh.indices[i * 3 + 1]], mesh.positions[mesh.indices[i * 3 + 2]], t, margin) && t < hit.t) {
+          hit.t = t;
+          hit.triangle = i;
+          edgeMargin = margin;
+        }
+      }
+      return hit;
+    }
+
+    static float bruteForceDistance(const Mesh& mesh, const Vector3& point) {
+      // Sample the triangles densely enough for a tight upper bound, the BVH result is checked against it from both sides
+      float minDistance = FLT_MAX;
+      for (uint32_t i = 0; i < mesh.indices.size() / 3; i++) {
+        const Vector3& a = mesh.positions[mesh.indices[i * 3]];
+        const Vector3& b = mesh.positions[mesh.indices[i * 3 + 1]];
+        const Vector3& c = mesh.positions[mesh.indices[i * 3 + 2]];
+        constexpr uint32_t kSteps = 16;
+        for (uint32_t s = 0; s <= kSteps; s++) {
+          for (uint32_t r = 0; r <= kSteps - s; r++) {
+            const Vector3 p = a + (b - a) * (float(s) / kSteps) + (c - a) * (float(r) / kSteps);
+            minDistance = std::min(minDistance, length(p - point));
+          }
+        }
+      }
+      return minDistance;
+    }
+
+    static void checkHit(const MeshBvh::RayHit& hit, const MeshBvh::RayHit& expected, float edgeMargin, const char* what) {
+      // Rays grazing an edge may legitimately resolve either way
+      constexpr float kEdgeTolerance = 1e-4f;
+
+      if (hit.isHit() != expected.isHit()) {
+        if (edgeMargin > kEdgeTolerance) {
+          throw DxvkError(str::format(what, ": hit mismatch"));
+        }
+        return;
+      }
+
+      if (hit.isHit() && std::abs(hit.t - expected.t) > 1e-4f * std::max(1.f, expected.t)) {
+        throw DxvkError(str::format(what, ": hit distance mismatch, expected ", expected.t, " got ", hit.t));
+      }
+    }
+
+    void testEmpty() {
+      MeshBvh bvh;
+      bvh.build(nullptr, 0, nullptr, 0);
+
+      MeshBvh::RayHit hit;
+      if (!bvh.empty() || bvh.intersect(Vector3(0.f), Vector3(0.f, 0.f, 1.f), FLT_MAX, hit) || hit.isHit()) {
+        throw DxvkError("Empty BVH must not report hits");
+      }
+      if (bvh.calculateSignedDistance(Vector3(0.f)) != FLT_MAX) {
+        throw DxvkError("Empty BVH must report FLT_MAX distance");
+      }
+
+      // Degenerate triangles only
+      const Vector3 positions[] = { Vector3(0.f), Vector3(1.f), Vector3(2.f) };
+      bvh.build(positions, 3, nullptr, 3);
+      if (bvh.intersect(Vector3(0.f, 0.f, -1.f), Vector3(0.f, 0.f, 1.f), FLT_MAX, hit)) {
+        throw DxvkError("Degenerate triangles must not be hit");
+      }
+    }
+
+    void testRandomMeshIntersection() {
+      const Mesh mesh = makeRandomMesh(2000);
+      const MeshBvh bvh = buildBvh(mesh);
+      const std::vector<Ray> rays = makeRays(2000);
+
+      std::vector<Vector3> origins, directions;
+      for (const Ray& ray : rays) {
+        origins.push_back(ray.origin);
+        directions.push_back(ray.direction);
+      }
+
+      // Odd count to exercise a partial packet
+      const uint32_t packetRayCount = static_cast<uint32_t>(rays.size()) - 1;
+      std::vector<MeshBvh::RayHit> packetHits(packetRayCount);
+      bvh.intersect(packetRayCount, origins.data(), directions.data(), FLT_MAX, packetHits.data());
+
+      uint32_t numHits = 0;
+      for (uint32_t i = 0; i < rays.size(); i++) {
+        float edgeMargin;
+        const MeshBvh::RayHit expected = bruteForceIntersect(mesh, rays[i], edgeMargin);
+
+        MeshBvh::RayHit hit;
+        bvh.intersect(rays[i].origin, rays[i].direction, FLT_MAX, hit);
+        checkHit(hit, expected, edgeMargin, "Single ray");
+
+        if (i < packetRayCount) {
+          checkHit(packetHits[i], expected, edgeMargin, "Packet ray");
+        }
+
+        numHits += expected.isHit() ? 1 : 0;
+      }
+
+      if (numHits == 0 || numHits == rays.size()) {
+        throw DxvkError("Test rays must contain both hits and misses");
+      }
+
+      // tMax must clip hits
+      MeshBvh::RayHit hit;
+      const Ray& ray = rays[0];
+      bvh.intersect(ray.origin, ray.direction, FLT_MAX, hit);
+      if (hit.isHit()) {
+        MeshBvh::RayHit clipped;
+        if (bvh.intersect(ray.origin, ray.direction, hit.t * 0.5f, clipped)) {
+          throw DxvkError("Hits beyond tMax must be rejected");
+        }
+      }
+    }
+
+    void testClosestPoint() {
+      const Mesh mesh = makeRandomMesh(200);
+      const MeshBvh bvh = buildBvh(mesh);
+
+      for (uint32_t i = 0; i < 200; i++) {
+        const Vector3 point = randomPoint(12.f);
+        const float expected = bruteForceDistance(mesh, point);
+
+        MeshBvh::ClosestPoint closest;
+        if (!bvh.findClosestPoint(point, FLT_MAX, closest)) {
+          throw DxvkError("Closest point query must succeed with an unbounded distance");
+        }
+
+        // The sampled reference overestimates by at most the sample spacing
+        if (closest.distance > expected + 1e-4f || closest.distance < expected - 0.1f) {
+          throw DxvkError(str::format("Closest point distance mismatch, expected ~", expected, " got ", closest.distance));
+        }
+        if (std::abs(length(closest.position - point) - closest.distance) > 1e-4f) {
+          throw DxvkError("Closest point position must be at the reported distance");
+        }
+
+        if (bvh.findClosestPoint(point, closest.distance * 0.5f, closest)) {
+          throw DxvkError("Closest point beyond maxDistance must be rejected");
+        }
+      }
+    }
+
+    void testInsideOutside() {
+      constexpr float kRadius = 5.f;
+      const Mesh mesh = makeSphere(kRadius, 32, 64);
+      const MeshBvh bvh = buildBvh(mesh);
+
+      for (uint32_t i = 0; i < 1000; i++) {
+        const Vector3 point = randomPoint(8.f);
+        const float radius = length(point);
+
+        // Skip points too close to the tessellated surface
+        if (std::abs(radius - kRadius) < 0.1f) {
+          continue;
+        }
+
+        const bool expectedInside = radius < kRadius;
+        if (bvh.isInside(point) != expectedInside) {
+          throw DxvkError("Inside test mismatch");
+        }
+
+        const float signedDistance = bvh.calculateSignedDistance(point);
+        if ((signedDistance < 0.f) != expectedInside || std::abs(std::abs(signedDistance) - std::abs(radius - kRadius)) > 0.05f) {
+          throw DxvkError(str::format("Signed distance mismatch, expected ~", radius - kRadius, " got ", signedDistance));
+        }
+      }
+    }
+
+    void benchmark() {
+      const Mesh mesh = makeRandomMesh(kNumTriangles);
+      const std::vector<Ray> rays = makeRays(kNumRays);
+
+      std::vector<Vector3> origins, directions;
+      for (const Ray& ray : rays) {
+        origins.push_back(ray.origin);
+        directions.push_back(ray.direction);
+      }
+
+      MeshBvh bvh;
+      {
+        std::cout << "Running: build " << kNumTriangles << " triangles --> ";
+        Timer time;
+        bvh.build(mesh.positions.data(), static_cast<uint32_t>(mesh.positions.size()), mesh.indices.data(), static_cast<uint32_t>(mesh.indices.size()));
+      }
+
+      uint32_t bruteForceHits = 0;
+      {
+        // Brute force is too slow to run for all rays
+        constexpr uint32_t kNumBruteForceRays = kNumRays / 100;
+        std::cout << "Running: brute force " << kNumBruteForceRays << " rays --> ";
+        Timer time;
+        for (uint32_t i = 0; i < kNumBruteForceRays; i++) {
+          float edgeMargin;
+          bruteForceHits += bruteForceIntersect(mesh, rays[i], edgeMargin).isHit() ? 1 : 0;
+        }
+      }
+
+      uint32_t singleHits = 0;
+      {
+        std::cout << "Running: single ray traversal " << kNumRays << " rays --> ";
+        Timer time;
+        for (const Ray& ray : rays) {
+          MeshBvh::RayHit hit;
+          singleHits += bvh.intersect(ray.origin, ray.direction, FLT_MAX, hit) ? 1 : 0;
+        }
+      }
+
+      std::vector<MeshBvh::RayHit> hits(kNumRays);
+      {
+        std::cout << "Running: packet traversal " << kNumRays << " rays --> ";
+        Timer time;
+        bvh.intersect(kNumRays, origins.data(), directions.data(), FLT_MAX, hits.data());
+      }
+
+      // Camera-like rays are coherent within a packet
+      std::vector<Vector3> coherentOrigins(kNumRays, Vector3(0.f, 0.f, -30.f));
+      std::vector<Vector3> coherentDirections(kNumRays);
+      constexpr uint32_t kGridSize = 100;
+      for (uint32_t i = 0; i < kNumRays; i++) {
+        const float x = float(i % kGridSize) / kGridSize - 0.5f;
+        const float y = float(i / kGridSize % kGridSize) / kGridSize - 0.5f;
+        coherentDirections[i] = normalize(Vector3(x, y, 1.f));
+      }
+
+      uint32_t coherentHits = 0;
+      {
+        std::cout << "Running: single ray traversal " << kNumRays << " coherent rays --> ";
+        Timer time;
+        for (uint32_t i = 0; i < kNumRays; i++) {
+          MeshBvh::RayHit hit;
+          coherentHits += bvh.intersect(coherentOrigins[i], coherentDirections[i], FLT_MAX, hit) ? 1 : 0;
+        }
+      }
+
+      {
+        std::cout << "Running: packet traversal " << kNumRays << " coherent rays --> ";
+        Timer time;
+        bvh.intersect(kNumRays, coherentOrigins.data(), coherentDirections.data(), FLT_MAX, hits.data());
+      }
+
+      float distanceSum = 0.f;
+      {
+        std::cout << "Running: closest point " << kNumPoints << " points --> ";
+        Timer time;
+        for (uint32_t i = 0; i < kNumPoints; i++) {
+          MeshBvh::ClosestPoint closest;
+          bvh.findClosestPoint(origins[i] * 0.5f, FLT_MAX, closest);
+          distanceSum += closest.distance;
+        }
+      }
+
+      std::cout << "Hits: " << bruteForceHits << " / " << singleHits << " / " << coherentHits << ", mean distance: " << distanceSum / kNumPoints << std::endl;
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
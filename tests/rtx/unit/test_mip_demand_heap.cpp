@@ -0,0 +1,190 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_mip_demand_heap.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_mip_demand_heap.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testMatchesReference();
+      testTieBreaking();
+      testPartialVisit();
+      testFitBudget();
+    }
+
+  private:
+    struct Reference {
+      bool present = false;
+      MipDemandHeap::Demand demand;
+    };
+
+    static std::vector<uint32_t> getVisitOrder(const MipDemandHeap& heap) {
+      std::vector<uint32_t> order;
+      heap.visitInOrder([&](uint32_t id, const MipDemandHeap::Demand&) {
+        order.push_back(id);
+        return true;
+      });
+      return order;
+    }
+
+    static void validate(const MipDemandHeap& heap, const std::vector<Reference>& reference) {
+      std::vector<uint32_t> expectedOrder;
+      size_t expectedBytes = 0;
+
+      for (uint32_t id = 0; id < reference.size(); id++) {
+        expect(heap.contains(id) == reference[id].present, "Membership mismatch");
+        if (reference[id].present) {
+          expectedOrder.push_back(id);
+          expectedBytes += reference[id].demand.bytes;
+          expect(heap.get(id).bytes == reference[id].demand.bytes, "Demand mismatch");
+        }
+      }
+
+      std::sort(expectedOrder.begin(), expectedOrder.end(), [&](uint32_t a, uint32_t b) {
+        if (reference[a].demand.priority != reference[b].demand.priority) {
+          return reference[a].demand.priority > reference[b].demand.priority;
+        }
+        return a < b;
+      });
+
+      expect(heap.size() == expectedOrder.size(), "Size mismatch");
+      expect(heap.getTotalBytes() == expectedBytes, "Total bytes mismatch");
+      expect(getVisitOrder(heap) == expectedOrder, "Visit order mismatch");
+      expect(heap.empty() || heap.top() == expectedOrder.front(), "Top mismatch");
+    }
+
+    void testMatchesReference() {
+      constexpr uint32_t kNumIds = 300;
+
+      std::mt19937 rng(3);
+      std::uniform_int_distribution<uint32_t> id(0, kNumIds - 1);
+      std::uniform_int_distribution<uint32_t> priority(0, 40);  // Coarse, so that ties are common
+      std::uniform_int_distribution<uint32_t> bytes(0, 1 << 20);
+      std::uniform_int_distribution<uint32_t> action(0, 9);
+
+      MipDemandHeap heap;
+      std::vector<Reference> reference(kNumIds);
+
+      for (uint32_t step = 0; step < 5000; step++) {
+        const uint32_t i = id(rng);
+
+        if (action(rng) < 3) {
+          heap.remove(i);
+          reference[i].present = false;
+        } else {
+          const MipDemandHeap::Demand demand { priority(rng) * 0.25, bytes(rng) };
+          heap.update(i, demand);
+          reference[i].present = true;
+          reference[i].demand = demand;
+        }
+
+        if (step % 97 == 0) {
+          validate(heap, reference);
+        }
+      }
+
+      validate(heap, reference);
+
+      heap.clear();
+      expect(heap.empty() && heap.getTotalBytes() == 0 && !heap.contains(0), "Clear failed");
+    }
+
+    void testTieBreaking() {
+      MipDemandHeap heap;
+      for (uint32_t id : { 5u, 2u, 9u, 0u }) {
+        heap.update(id, { 1.0, 10 });
+      }
+      heap.update(7, { 2.0, 10 });
+
+      expect(getVisitOrder(heap) == std::vector<uint32_t> { 7, 0, 2, 5, 9 }, "Equal priorities must be ordered by id");
+    }
+
+    void testPartialVisit() {
+      MipDemandHeap heap;
+      for (uint32_t id = 0; id < 100; id++) {
+        heap.update(id, { double(id), 1 });
+      }
+
+      std::vector<uint32_t> visited;
+      heap.visitInOrder([&](uint32_t id, const MipDemandHeap::Demand&) {
+        visited.push_back(id);
+        return visited.size() < 3;
+      });
+
+      expect(visited == std::vector<uint32_t> { 99, 98, 97 }, "Visit must stop when the visitor returns false");
+      expect(heap.size() == 100, "Visiting must not modify the heap");
+    }
+
+    void testFitBudget() {
+      std::mt19937 rng(11);
+      std::uniform_int_distribution<uint32_t> priority(0, 20);
+      std::uniform_int_distribution<uint32_t> bytes(0, 1000);
+
+      MipDemandHeap heap;
+      std::vector<MipDemandHeap::Demand> demands(500);
+      size_t totalBytes = 0;
+      for (uint32_t id = 0; id < demands.size(); id++) {
+        // Some empty demands, which fit in any case
+        demands[id] = { double(priority(rng)), id % 7 == 0 ? 0 : bytes(rng) };
+        heap.update(id, demands[id]);
+        totalBytes += demands[id].bytes;
+      }
+
+      for (const size_t budgetBytes : { size_t(0), size_t(1000), totalBytes / 3, totalBytes - 1, totalBytes }) {
+        // Reference: greedy fit of all demands in order
+        std::vector<bool> expectedFit(demands.size(), false);
+        size_t expectedBytes = 0;
+        heap.visitInOrder([&](uint32_t id, const MipDemandHeap::Demand& demand) {
+          if (expectedBytes + demand.bytes <= budgetBytes) {
+            expectedBytes += demand.bytes;
+            expectedFit[id] = true;
+          }
+          return true;
+        });
+
+        std::vector<uint32_t> numCalls(demands.size(), 0);
+        std::vector<bool> fit(demands.size(), false);
+        const size_t usedBytes = heap.fitBudget(budgetBytes,
+          [&](uint32_t id, const MipDemandHeap::Demand&) { numCalls[id]++; fit[id] = true; },
+          [&](uint32_t id, const MipDemandHeap::Demand&) { numCalls[id]++; });
+
+        expect(usedBytes == expectedBytes, "Used bytes differ from a greedy fit");
+        expect(fit == expectedFit, "Fitted demands differ from a greedy fit");
+        expect(std::all_of(numCalls.begin(), numCalls.end(), [](uint32_t n) { return n == 1; }), "Every demand must be either fitted or demoted once");
+      }
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
@@ -0,0 +1,264 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_mpsc_queue.h"
+#include "../../../src/util/util_timer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_mpsc_queue.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testSingleThreaded();
+      testOrdering();
+      testStop();
+      testFullQueue();
+      benchmarkThroughput();
+    }
+
+  private:
+    static constexpr uint32_t kCapacity = 1024;
+
+    void testSingleThreaded() {
+      MpscQueue<uint64_t, 4> queue;
+      uint64_t item = 0;
+
+      expect(!queue.tryPop(item), "New queue should be empty");
+
+      // Wrap around the ring a few times
+      for (uint64_t i = 0; i < 10; i++) {
+        expect(queue.push(i * 2) == i * 2, "Positions should count pushed items");
+        expect(queue.push(i * 2 + 1) == i * 2 + 1, "Positions should count pushed items");
+        expect(queue.tryPop(item) && item == i * 2, "Items should be popped in order");
+        expect(queue.pop(item) && item == i * 2 + 1, "Items should be popped in order");
+        expect(!queue.tryPop(item), "Queue should be empty");
+      }
+
+      expect(queue.pushCount() == 20, "Unexpected push count");
+    }
+
+    // Several producers push into a small queue, so that they run into the full queue as well as the parked consumer
+    void testOrdering() {
+      constexpr uint32_t kNumProducers = 4;
+      constexpr uint32_t kNumItemsPerProducer = 100000;
+      constexpr uint32_t kNumItems = kNumProducers * kNumItemsPerProducer;
+
+      MpscQueue<uint64_t, 64> queue;
+      std::vector<uint64_t> positions(kNumItems);
+
+      std::vector<std::thread> producers;
+      for (uint32_t p = 0; p < kNumProducers; p++) {
+        producers.emplace_back([&, p]() {
+          for (uint32_t i = 0; i < kNumItemsPerProducer; i++) {
+            const uint64_t item = (uint64_t(p) << 32) | i;
+            positions[p * kNumItemsPerProducer + i] = queue.push(uint64_t(item));
+          }
+        });
+      }
+
+      std::vector<uint32_t> nextItem(kNumProducers, 0);
+      std::vector<uint64_t> popOrder(kNumItems);
+      bool inOrder = true;
+
+      for (uint32_t n = 0; n < kNumItems; n++) {
+        uint64_t item;
+        expect(queue.pop(item), "Pop should only fail after stop");
+
+        const uint32_t p = uint32_t(item >> 32);
+        const uint32_t i = uint32_t(item);
+        inOrder &= p < kNumProducers && nextItem[p] == i;
+        nextItem[p] = i + 1;
+        popOrder[n] = item;
+      }
+
+      for (auto& producer : producers) {
+        producer.join();
+      }
+
+      expect(inOrder, "Items of a producer should be popped in the order they were pushed");
+
+      // Positions returned by push() must match the pop order, this is what sequence numbers rely on
+      bool positionsMatch = true;
+      for (uint32_t n = 0; n < kNumItems; n++) {
+        const uint64_t item = popOrder[n];
+        positionsMatch &= positions[(item >> 32) * kNumItemsPerProducer + uint32_t(item)] == n;
+      }
+      expect(positionsMatch, "Push positions should match the pop order");
+
+      uint64_t item;
+      expect(!queue.tryPop(item) && queue.pushCount() == kNumItems, "All items should have been popped");
+    }
+
+    void testStop() {
+      MpscQueue<uint64_t, 4> queue;
+      std::atomic<bool> popped = { false };
+      std::atomic<bool> stopped = { false };
+
+      std::thread consumer([&]() {
+        uint64_t item;
+        popped = queue.pop(item) && item == 42;
+        stopped = !queue.pop(item);
+      });
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      queue.push(42);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      queue.stop();
+      consumer.join();
+
+      expect(popped && stopped, "A parked consumer should be woken by pushes and stop()");
+    }
+
+    // Producers running into a full queue must park until the consumer pops, and tryPush must not wait
+    void testFullQueue() {
+      MpscQueue<uint64_t, 4> queue;
+      uint64_t position = 0;
+
+      for (uint64_t i = 0; i < 4; i++) {
+        expect(queue.tryPush(uint64_t(i), position) && position == i, "tryPush should succeed while there is space");
+      }
+      expect(!queue.tryPush(4, position), "tryPush should fail on a full queue");
+
+      constexpr uint32_t kNumProducers = 3;
+      constexpr auto kConsumerDelay = std::chrono::milliseconds(50);
+
+      std::atomic<uint32_t> numPushed = { 0 };
+      std::vector<std::thread> producers;
+      for (uint32_t p = 0; p < kNumProducers; p++) {
+        producers.emplace_back([&, p]() {
+          queue.push(100 + p);
+          numPushed++;
+        });
+      }
+
+      // Long enough for the producers to exhaust their retries and park
+      std::this_thread::sleep_for(kConsumerDelay);
+      expect(numPushed == 0, "Producers should wait while the queue is full");
+
+      uint64_t item;
+      for (uint64_t i = 0; i < 4; i++) {
+        expect(queue.pop(item) && item == i, "Items pushed before the queue was full should be popped first");
+      }
+
+      uint32_t producerMask = 0;
+      for (uint32_t p = 0; p < kNumProducers; p++) {
+        expect(queue.pop(item) && item >= 100 && item < 100 + kNumProducers, "Waiting producers should push once there is space");
+        producerMask |= 1u << (item - 100);
+      }
+
+      for (auto& producer : producers) {
+        producer.join();
+      }
+
+      expect(numPushed == kNumProducers && producerMask == (1u << kNumProducers) - 1, "Every waiting producer should have pushed");
+      expect(!queue.tryPop(item) && queue.pushCount() == 4 + kNumProducers, "All items should have been popped");
+    }
+
+    // Queue used before MpscQueue, as the CS thread used it
+    class LockedQueue {
+    public:
+      uint64_t push(uint64_t item) {
+        uint64_t position;
+        { std::unique_lock<dxvk::mutex> lock(m_mutex);
+          position = m_pushCount++;
+          m_items.push(item);
+        }
+        m_condOnAdd.notify_one();
+        return position;
+      }
+
+      bool pop(uint64_t& item) {
+        std::unique_lock<dxvk::mutex> lock(m_mutex);
+        m_condOnAdd.wait(lock, [this] { return !m_items.empty(); });
+        item = m_items.front();
+        m_items.pop();
+        return true;
+      }
+
+    private:
+      dxvk::mutex m_mutex;
+      dxvk::condition_variable m_condOnAdd;
+      std::queue<uint64_t> m_items;
+      uint64_t m_pushCount = 0;
+    };
+
+    template<typename Queue>
+    static uint64_t runProducersAndConsumer(Queue& queue, uint32_t numProducers, uint32_t numItemsPerProducer) {
+      std::vector<std::thread> producers;
+      for (uint32_t p = 0; p < numProducers; p++) {
+        producers.emplace_back([&queue, numItemsPerProducer]() {
+          for (uint32_t i = 0; i < numItemsPerProducer; i++) {
+            queue.push(uint64_t(i));
+          }
+        });
+      }
+
+      uint64_t checksum = 0;
+      for (uint32_t n = 0; n < numProducers * numItemsPerProducer; n++) {
+        uint64_t item;
+        queue.pop(item);
+        checksum += item;
+      }
+
+      for (auto& producer : producers) {
+        producer.join();
+      }
+
+      return checksum;
+    }
+
+    void benchmarkThroughput() {
+      constexpr uint32_t kNumItemsPerProducer = 1000000;
+
+      for (uint32_t numProducers : { 1u, 2u, 4u }) {
+        uint64_t checksumLocked, checksumMpsc;
+        {
+          LockedQueue queue;
+          std::cout << "Running: " << numProducers << " x " << kNumItemsPerProducer << " chunks, mutex + std::queue --> ";
+          Timer time;
+          checksumLocked = runProducersAndConsumer(queue, numProducers, kNumItemsPerProducer);
+        }
+        {
+          auto queue = std::make_unique<MpscQueue<uint64_t, kCapacity>>();
+          std::cout << "Running: " << numProducers << " x " << kNumItemsPerProducer << " chunks, MpscQueue --> ";
+          Timer time;
+          checksumMpsc = runProducersAndConsumer(*queue, numProducers, kNumItemsPerProducer);
+        }
+
+        expect(checksumLocked == checksumMpsc, "Both queues must deliver the same items");
+      }
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
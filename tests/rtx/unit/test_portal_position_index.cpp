@@ -0,0 +1,181 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_portal_position_index.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_portal_position_index.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testMatchesBruteForce();
+      testTieBreaking();
+      testNoPortals();
+    }
+
+  private:
+    struct Instance {
+      Vector3 predictedPosition;
+      uint32_t materialHash;
+    };
+
+    using Index = PortalPositionIndex<Instance, 2>;
+
+    static constexpr float kMaxDistance = 10.f;
+
+    static Matrix4 createPortalTransform(float angle, const Vector3& translation) {
+      Matrix4 transform;
+      transform[0] = Vector4(std::cos(angle), std::sin(angle), 0.f, 0.f);
+      transform[1] = Vector4(-std::sin(angle), std::cos(angle), 0.f, 0.f);
+      transform[2] = Vector4(0.f, 0.f, 1.f, 0.f);
+      transform[3] = Vector4(translation, 1.f);
+      return transform;
+    }
+
+    static Vector3 transformPosition(const Matrix4& transform, const Vector3& position) {
+      return (transform * Vector4(position.x, position.y, position.z, 1.f)).xyz();
+    }
+
+    void testMatchesBruteForce() {
+      std::mt19937 rng(7);
+      std::uniform_real_distribution<float> coord(-500.f, 500.f);
+      std::uniform_int_distribution<uint32_t> material(0, 3);
+
+      const Matrix4 portals[] = {
+        createPortalTransform(0.5f, Vector3(100.f, -40.f, 20.f)),
+        createPortalTransform(-2.f, Vector3(-300.f, 250.f, -10.f))
+      };
+
+      std::vector<Instance> instances(5000);
+      for (Instance& instance : instances) {
+        instance.predictedPosition = Vector3(coord(rng), coord(rng), coord(rng) * 0.1f);
+        instance.materialHash = material(rng);
+      }
+
+      Index index;
+      index.reset(kMaxDistance * 2.f);
+      for (const Matrix4& portal : portals) {
+        index.addPortal(portal);
+      }
+      for (const Instance& instance : instances) {
+        index.add(&instance, instance.predictedPosition);
+      }
+      index.build();
+
+      expect(index.size() == instances.size() && index.getPortalCount() == 2, "Unexpected index size");
+
+      uint32_t numMatches = 0;
+      for (uint32_t query = 0; query < 2000; query++) {
+        // Query near the virtual positions of the instances, as well as random positions
+        Vector3 position(coord(rng), coord(rng), coord(rng) * 0.1f);
+        if (query % 2 == 0) {
+          const Instance& instance = instances[query % instances.size()];
+          position = transformPosition(portals[query % 4 / 2], instance.predictedPosition) + Vector3(coord(rng), coord(rng), coord(rng)) * 0.01f;
+        }
+
+        const uint32_t queryMaterial = material(rng);
+        auto filter = [&](const Instance* instance) { return instance->materialHash == queryMaterial; };
+
+        // The loop the index replaces: every candidate through every portal
+        const Instance* expected = nullptr;
+        uint32_t expectedPortal = 0;
+        float expectedDistSqr = FLT_MAX;
+        for (const Instance& instance : instances) {
+          if (!filter(&instance)) {
+            continue;
+          }
+          for (uint32_t portal = 0; portal < 2; portal++) {
+            const float distSqr = lengthSqr(transformPosition(portals[portal], instance.predictedPosition) - position);
+            if (distSqr <= kMaxDistance * kMaxDistance && distSqr < expectedDistSqr) {
+              expectedDistSqr = distSqr;
+              expected = &instance;
+              expectedPortal = portal;
+            }
+          }
+        }
+
+        float distSqr;
+        uint32_t portal = UINT32_MAX;
+        const Instance* result = index.findNearest(position, kMaxDistance * kMaxDistance, filter, distSqr, portal);
+
+        expect(result == expected, "The index should find the same instance as a search over all instances");
+        if (result != nullptr) {
+          expect(portal == expectedPortal && distSqr == expectedDistSqr, "The index should find the same portal as a search over all instances");
+          numMatches++;
+        }
+      }
+
+      expect(numMatches > 100, "The test should have produced matches");
+    }
+
+    void testTieBreaking() {
+      // Two instances at the same position, matched through both portals at the same distance
+      const Matrix4 identity;
+      Instance instances[2] = { { Vector3(1.f, 2.f, 3.f), 0 }, { Vector3(1.f, 2.f, 3.f), 0 } };
+
+      Index index;
+      index.reset(kMaxDistance * 2.f);
+      index.addPortal(identity);
+      index.addPortal(identity);
+      index.add(&instances[0], instances[0].predictedPosition);
+      index.add(&instances[1], instances[1].predictedPosition);
+      index.build();
+
+      float distSqr;
+      uint32_t portal;
+      const Instance* result = index.findNearest(Vector3(1.f, 2.f, 4.f), kMaxDistance * kMaxDistance, [](const Instance*) { return true; }, distSqr, portal);
+      expect(result == &instances[0] && portal == 0, "Ties should resolve to the first added instance and portal");
+
+      result = index.findNearest(Vector3(1.f, 2.f, 4.f), kMaxDistance * kMaxDistance, [&](const Instance* instance) { return instance != &instances[0]; }, distSqr, portal);
+      expect(result == &instances[1] && distSqr == 1.f, "Filtered instances should be skipped");
+
+      result = index.findNearest(Vector3(1.f, 2.f, 3.f + kMaxDistance * 1.5f), kMaxDistance * kMaxDistance, [](const Instance*) { return true; }, distSqr, portal);
+      expect(result == nullptr, "Instances beyond the maximum distance should not be found");
+    }
+
+    void testNoPortals() {
+      Instance instance { Vector3(0.f), 0 };
+
+      Index index;
+      index.reset(kMaxDistance * 2.f);
+      index.add(&instance, instance.predictedPosition);
+      index.build();
+
+      float distSqr;
+      uint32_t portal;
+      expect(index.findNearest(Vector3(0.f), kMaxDistance * kMaxDistance, [](const Instance*) { return true; }, distSqr, portal) == nullptr,
+             "Nothing should be found without portals");
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
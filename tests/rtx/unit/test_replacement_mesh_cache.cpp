@@ -0,0 +1,225 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_replacement_mesh_cache.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_replacement_mesh_cache.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      buildMesh();
+
+      testRoundTrip();
+      testRejectsDamagedFiles();
+      testStoreAndLookup();
+      testPrune();
+    }
+
+  private:
+    void buildMesh() {
+      constexpr uint32_t kNumVertices = 1000;
+      constexpr uint32_t kStride = 9 * sizeof(float);
+
+      m_vertices.resize(kNumVertices * kStride / sizeof(float));
+      for (size_t i = 0; i < m_vertices.size(); i++) {
+        m_vertices[i] = static_cast<float>(i) * 0.5f;
+      }
+
+      m_indices[0].resize(3 * 600);
+      m_indices[1].resize(3 * 7);
+      for (auto& indices : m_indices) {
+        for (size_t i = 0; i < indices.size(); i++) {
+          indices[i] = static_cast<uint32_t>((i * 7919) % kNumVertices);
+        }
+      }
+
+      m_mesh.numVertices = kNumVertices;
+      m_mesh.vertexStride = kStride;
+      m_mesh.numBonesPerVertex = 0;
+      m_mesh.doubleSidedState = 2;
+      m_mesh.isRightHanded = false;
+      m_mesh.boundingBox.minPos = Vector3(-1.f, -2.f, -3.f);
+      m_mesh.boundingBox.maxPos = Vector3(1.f, 2.f, 3.f);
+      m_mesh.vertexDecl = { { 0, 0, 12 }, { 1, 12, 4 }, { 2, 16, 8 }, { 3, 24, 4 }, { 4, 28, 8 } };
+      m_mesh.pVertexData = m_vertices.data();
+      m_mesh.subMeshes.resize(2);
+      m_mesh.subMeshes[0].primPath = "/RootNode/meshes/mesh_0123456789ABCDEF/mesh";
+      m_mesh.subMeshes[1].primPath = "/RootNode/meshes/mesh_0123456789ABCDEF/mesh/GeomSubset_1";
+
+      for (size_t i = 0; i < m_mesh.subMeshes.size(); i++) {
+        m_mesh.subMeshes[i].pIndices = m_indices[i].data();
+        m_mesh.subMeshes[i].numIndices = static_cast<uint32_t>(m_indices[i].size());
+      }
+    }
+
+    void expectEqual(const ReplacementMeshData& mesh) const {
+      expect(mesh.numVertices == m_mesh.numVertices, "Vertex count mismatch");
+      expect(mesh.vertexStride == m_mesh.vertexStride, "Vertex stride mismatch");
+      expect(mesh.numBonesPerVertex == m_mesh.numBonesPerVertex, "Bone count mismatch");
+      expect(mesh.doubleSidedState == m_mesh.doubleSidedState, "Double sided state mismatch");
+      expect(mesh.isRightHanded == m_mesh.isRightHanded, "Handedness mismatch");
+      expect(mesh.boundingBox.minPos == m_mesh.boundingBox.minPos && mesh.boundingBox.maxPos == m_mesh.boundingBox.maxPos, "Bounding box mismatch");
+
+      expect(mesh.vertexDecl.size() == m_mesh.vertexDecl.size(), "Vertex declaration size mismatch");
+      for (size_t i = 0; i < mesh.vertexDecl.size(); i++) {
+        expect(mesh.vertexDecl[i].attribute == m_mesh.vertexDecl[i].attribute &&
+               mesh.vertexDecl[i].offset == m_mesh.vertexDecl[i].offset &&
+               mesh.vertexDecl[i].size == m_mesh.vertexDecl[i].size, "Vertex element mismatch");
+      }
+
+      expect(reinterpret_cast<uintptr_t>(mesh.pVertexData) % 16 == 0, "Vertex data is not aligned");
+      expect(std::memcmp(mesh.pVertexData, m_mesh.pVertexData, size_t(m_mesh.numVertices) * m_mesh.vertexStride) == 0, "Vertex data mismatch");
+
+      expect(mesh.subMeshes.size() == m_mesh.subMeshes.size(), "Sub mesh count mismatch");
+      for (size_t i = 0; i < mesh.subMeshes.size(); i++) {
+        const auto& subMesh = mesh.subMeshes[i];
+        expect(subMesh.primPath == m_mesh.subMeshes[i].primPath, "Sub mesh path mismatch");
+        expect(subMesh.numIndices == m_mesh.subMeshes[i].numIndices, "Index count mismatch");
+        expect(reinterpret_cast<uintptr_t>(subMesh.pIndices) % 16 == 0, "Index data is not aligned");
+        expect(std::memcmp(subMesh.pIndices, m_mesh.subMeshes[i].pIndices, subMesh.numIndices * sizeof(uint32_t)) == 0, "Index data mismatch");
+      }
+    }
+
+    // Copies file contents into 16 byte aligned storage, as a mapped file would be
+    static std::vector<uint64_t> toAlignedStorage(const std::vector<uint8_t>& file) {
+      std::vector<uint64_t> storage((file.size() + 7) / 8 + 1);
+      std::memcpy(storage.data(), file.data(), file.size());
+      return storage;
+    }
+
+    void testRoundTrip() {
+      std::vector<uint8_t> file;
+      ReplacementMeshCache::serialize(kKey, m_mesh, file);
+
+      auto storage = toAlignedStorage(file);
+      ReplacementMeshData mesh;
+      expect(ReplacementMeshCache::deserialize(kKey, reinterpret_cast<const uint8_t*>(storage.data()), file.size(), mesh), "Failed to parse serialized mesh");
+      expectEqual(mesh);
+    }
+
+    void testRejectsDamagedFiles() {
+      std::vector<uint8_t> file;
+      ReplacementMeshCache::serialize(kKey, m_mesh, file);
+
+      ReplacementMeshData mesh;
+      expect(!ReplacementMeshCache::deserialize(kKey + 1, file.data(), file.size(), mesh), "Accepted a file stored under a different key");
+      expect(!ReplacementMeshCache::deserialize(kKey, file.data(), file.size() - 1, mesh), "Accepted a truncated file");
+      expect(!ReplacementMeshCache::deserialize(kKey, file.data(), 7, mesh), "Accepted a file shorter than its header");
+
+      for (size_t offset : { size_t(0), size_t(40), file.size() / 2, file.size() - 1 }) {
+        std::vector<uint8_t> damaged = file;
+        damaged[offset] ^= 0x5a;
+        expect(!ReplacementMeshCache::deserialize(kKey, damaged.data(), damaged.size(), mesh), "Accepted a damaged file");
+      }
+    }
+
+    void testStoreAndLookup() {
+      const std::filesystem::path directory = std::filesystem::temp_directory_path() / "test_replacement_mesh_cache";
+      std::filesystem::remove_all(directory);
+
+      {
+        ReplacementMeshCache cache(directory.string());
+        expect(cache.lookup(kKey) == nullptr, "Found a mesh in an empty cache");
+
+        cache.store(kKey, m_mesh);
+
+        auto entry = cache.lookup(kKey);
+        expect(entry != nullptr, "Stored mesh was not found");
+        expectEqual(entry->data());
+
+        expect(cache.lookup(kKey + 1) == nullptr, "Found a mesh that was never stored");
+        expect(cache.getHitCount() == 1 && cache.getMissCount() == 2, "Unexpected hit and miss counts");
+      }
+
+      // A new cache instance, as on the next launch
+      {
+        ReplacementMeshCache cache(directory.string());
+        auto entry = cache.lookup(kKey);
+        expect(entry != nullptr, "Stored mesh was not found after reopening the cache");
+        expectEqual(entry->data());
+      }
+
+      std::filesystem::remove_all(directory);
+    }
+
+    void testPrune() {
+      const std::filesystem::path directory = std::filesystem::temp_directory_path() / "test_replacement_mesh_cache_prune";
+      std::filesystem::remove_all(directory);
+
+      ReplacementMeshCache cache(directory.string());
+      const auto now = std::filesystem::file_time_type::clock::now();
+      for (XXH64_hash_t i = 0; i < 4; i++) {
+        cache.store(kKey + i, m_mesh);
+      }
+
+      // Stored oldest first, in key order
+      std::vector<std::filesystem::path> files;
+      uint64_t fileSize = 0;
+      for (const auto& dirEntry : std::filesystem::directory_iterator(directory)) {
+        files.push_back(dirEntry.path());
+        fileSize = dirEntry.file_size();
+      }
+      std::sort(files.begin(), files.end());
+      expect(files.size() == 4, "Every stored mesh must have its file");
+      for (XXH64_hash_t i = 0; i < 4; i++) {
+        std::filesystem::last_write_time(files[i], now - std::chrono::hours(4 - i));
+      }
+
+      cache.prune(4 * fileSize);
+      expect(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()) == 4,
+             "A cache within its size must not be pruned");
+
+      // A hit makes the oldest file the most recently used one
+      expect(cache.lookup(kKey) != nullptr, "Stored mesh was not found");
+
+      cache.prune(2 * fileSize);
+      expect(cache.lookup(kKey) != nullptr, "The most recently used mesh must be kept");
+      expect(cache.lookup(kKey + 3) != nullptr, "The most recently stored mesh must be kept");
+      expect(cache.lookup(kKey + 1) == nullptr && cache.lookup(kKey + 2) == nullptr, "The least recently used meshes must be removed");
+
+      expect(ReplacementMeshCache::getVersionStamp() == ReplacementMeshCache::getVersionStamp(), "The version stamp must be stable");
+
+      std::filesystem::remove_all(directory);
+    }
+
+    static constexpr XXH64_hash_t kKey = 0x0123456789abcdefull;
+
+    std::vector<float> m_vertices;
+    std::vector<uint32_t> m_indices[2];
+    ReplacementMeshData m_mesh;
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
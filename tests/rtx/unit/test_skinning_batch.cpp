@@ -0,0 +1,194 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_skinning_batch.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_skinning_batch.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testDeduplication();
+      testPaletteRanges();
+      testPaletteOffsets();
+      testFrame();
+      testClear();
+    }
+
+  private:
+    struct Job {
+      uint32_t bonePaletteOffset;
+    };
+
+    using Batch = SkinningBatch<Job>;
+
+    struct Palette {
+      std::vector<Matrix4> bones;
+      uint32_t minBoneIndex = 0;
+      XXH64_hash_t boneHash = 0;
+
+      uint32_t numBones() const {
+        return static_cast<uint32_t>(bones.size());
+      }
+    };
+
+    // Bones are told apart by their translation
+    static Palette createPalette(uint32_t numBones, uint32_t minBoneIndex, float seed) {
+      Palette palette;
+      palette.minBoneIndex = minBoneIndex;
+      palette.bones.resize(numBones);
+      for (uint32_t i = 0; i < numBones; i++) {
+        palette.bones[i][3] = Vector4(seed, static_cast<float>(i), 0.f, 1.f);
+      }
+      // Same as SkinningData::computeHash
+      palette.boneHash = XXH3_64bits(&palette.bones[minBoneIndex], (numBones - minBoneIndex) * sizeof(Matrix4));
+      return palette;
+    }
+
+    static uint32_t add(Batch& batch, const Palette& palette) {
+      const uint32_t offset = batch.addPalette(palette.bones.data(), palette.numBones(), palette.minBoneIndex, palette.boneHash);
+      batch.addJob(Job { offset });
+      return offset;
+    }
+
+    // Checks that every used bone of the palette is found where the skinning shader will look for it
+    static bool isPacked(const Batch& batch, const Palette& palette, uint32_t offset) {
+      const std::vector<Matrix4>& packed = batch.getBones();
+      for (uint32_t i = palette.minBoneIndex; i < palette.numBones(); i++) {
+        const uint32_t index = offset + i;
+        if (index >= packed.size() || packed[index] != palette.bones[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void testDeduplication() {
+      Batch batch;
+      const Palette a = createPalette(32, 0, 1.f);
+      const Palette b = createPalette(32, 0, 2.f);
+
+      const uint32_t offsetA0 = add(batch, a);
+      const uint32_t offsetB = add(batch, b);
+      const uint32_t offsetA1 = add(batch, a);
+
+      expect(offsetA0 == offsetA1, "Identical palettes should share their packed bones");
+      expect(offsetA0 != offsetB, "Different palettes should not be shared");
+      expect(batch.getBones().size() == 64, "Each unique palette should be packed once");
+      expect(isPacked(batch, a, offsetA0) && isPacked(batch, b, offsetB), "Packed palettes should match their source");
+
+      const Batch::Stats& stats = batch.getStats();
+      expect(stats.numJobs == 3 && stats.numPalettes == 2, "Unexpected job or palette count");
+      expect(stats.numBonesPacked == 64 && stats.numBonesDeduplicated == 32, "Unexpected bone counts");
+    }
+
+    void testPaletteRanges() {
+      // The bone hash only covers the used bones, so palettes hashing the same but used differently are not shared
+      Batch batch;
+      Palette a = createPalette(16, 4, 1.f);
+      Palette b = a;
+      b.bones.resize(20);
+      b.bones[16] = b.bones[17] = b.bones[18] = b.bones[19] = Matrix4();
+
+      const uint32_t offsetA = add(batch, a);
+      const uint32_t offsetB = add(batch, b);
+
+      expect(offsetA != offsetB, "Palettes with different bone counts should not be shared");
+      expect(isPacked(batch, a, offsetA) && isPacked(batch, b, offsetB), "Packed palettes should match their source");
+    }
+
+    void testPaletteOffsets() {
+      // Unused bones below the minimum index are not packed, the offset of the first palette wraps around
+      Batch batch;
+      const Palette a = createPalette(40, 20, 1.f);
+      const Palette b = createPalette(8, 2, 2.f);
+
+      const uint32_t offsetA = add(batch, a);
+      const uint32_t offsetB = add(batch, b);
+
+      expect(batch.getBones().size() == 26, "Only used bones should be packed");
+      expect(offsetA + a.minBoneIndex == 0, "The first used bone should be packed first");
+      expect(offsetB + b.minBoneIndex == 20, "Palettes should be packed back to back");
+      expect(isPacked(batch, a, offsetA) && isPacked(batch, b, offsetB), "Packed palettes should match their source");
+    }
+
+    void testFrame() {
+      // Characters drawn in several passes, each split into submeshes sharing the character's palette
+      const uint32_t kNumCharacters = 8;
+      const uint32_t kNumPasses = 3;
+      const uint32_t kNumSubmeshes = 4;
+      const uint32_t kNumBones = 60;
+
+      std::vector<Palette> palettes;
+      for (uint32_t i = 0; i < kNumCharacters; i++) {
+        palettes.push_back(createPalette(kNumBones, 0, static_cast<float>(i)));
+      }
+
+      Batch batch;
+      std::vector<uint32_t> offsets(kNumCharacters);
+      for (uint32_t pass = 0; pass < kNumPasses; pass++) {
+        for (uint32_t i = 0; i < kNumCharacters; i++) {
+          for (uint32_t submesh = 0; submesh < kNumSubmeshes; submesh++) {
+            offsets[i] = add(batch, palettes[i]);
+          }
+        }
+      }
+
+      const Batch::Stats& stats = batch.getStats();
+      expect(stats.numJobs == kNumCharacters * kNumPasses * kNumSubmeshes, "Every draw should add a job");
+      expect(stats.numPalettes == kNumCharacters, "Each character's palette should be packed once");
+      expect(batch.getBones().size() == kNumCharacters * kNumBones, "Each character's bones should be packed once");
+
+      for (uint32_t i = 0; i < kNumCharacters; i++) {
+        expect(isPacked(batch, palettes[i], offsets[i]), "Packed palettes should match their source");
+      }
+
+      // Jobs are kept in submission order
+      const std::vector<Job>& jobs = batch.getJobs();
+      expect(jobs.front().bonePaletteOffset == offsets[0] && jobs.back().bonePaletteOffset == offsets[kNumCharacters - 1], "Jobs should keep their order");
+    }
+
+    void testClear() {
+      Batch batch;
+      const Palette a = createPalette(16, 0, 1.f);
+      add(batch, a);
+      batch.clear();
+
+      expect(batch.empty() && batch.getBones().empty(), "Clearing should drop jobs and bones");
+      expect(batch.getStats().numJobs == 0 && batch.getStats().numPalettes == 0, "Clearing should reset the stats");
+
+      // Palettes of a previous batch are not referenced anymore
+      const uint32_t offset = add(batch, a);
+      expect(offset == 0 && batch.getStats().numPalettes == 1, "Palettes should be packed again after clearing");
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
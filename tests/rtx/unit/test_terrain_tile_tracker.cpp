@@ -0,0 +1,196 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_terrain_tile_tracker.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_terrain_tile_tracker.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    static constexpr uint32_t kTiles = 4;
+    static constexpr uint32_t kNumTiles = kTiles * kTiles;
+    static constexpr float kTileSize = 10.f;
+
+    void run() {
+      testFirstFrameBakesEverything();
+      testStaticSceneIsReused();
+      testChangedDrawRebakesOverlappedTiles();
+      testScrollingBakesNewTilesOnly();
+      testRegionsDoNotCrossSeam();
+      testSettingsAndInvalidation();
+    }
+
+  private:
+    struct Draw {
+      XXH64_hash_t hash;
+      Vector2 boundsMin;
+      Vector2 boundsMax;
+    };
+
+    // Full window of a single level centered at the origin is <-20, 20>
+    static std::vector<Draw> makeScene() {
+      return {
+        { 1, Vector2(-20.f, -20.f), Vector2(20.f, 20.f) },  // Covers everything
+        { 2, Vector2(1.f, 1.f), Vector2(5.f, 5.f) },        // Tile (0, 0)
+        { 3, Vector2(-15.f, 5.f), Vector2(-5.f, 15.f) },    // Tiles (-2..-1, 0..1)
+      };
+    }
+
+    static uint32_t countTiles(const std::vector<TerrainTileTracker::Region>& regions) {
+      uint32_t count = 0;
+      for (const auto& region : regions) {
+        count += region.cellExtent.x * region.cellExtent.y;
+      }
+      return count;
+    }
+
+    static uint32_t runFrame(TerrainTileTracker& tracker, const std::vector<Draw>& draws, const Vector2& center = Vector2(0.f),
+                             XXH64_hash_t settingsHash = 0, std::vector<float> tileSizes = { kTileSize }) {
+      tracker.beginFrame(kTiles, tileSizes, center, settingsHash);
+
+      std::vector<TerrainTileTracker::Region> regions;
+      tracker.getRegionsToBake(regions);
+      const uint32_t numTilesToBake = countTiles(regions);
+
+      for (const Draw& draw : draws) {
+        tracker.addDraw(draw.hash, draw.boundsMin, draw.boundsMax, regions);
+      }
+
+      tracker.endFrame();
+
+      if (tracker.getStatistics().numTilesRebaked != numTilesToBake) {
+        throw DxvkError(str::format("Re-baked tile count ", tracker.getStatistics().numTilesRebaked, " does not match the regions to bake ", numTilesToBake));
+      }
+
+      return numTilesToBake;
+    }
+
+    void testFirstFrameBakesEverything() {
+      TerrainTileTracker tracker;
+      expect(runFrame(tracker, makeScene()) == kNumTiles, "First frame must bake all tiles");
+      expect(tracker.getStatistics().numTilesReused == 0, "First frame must not reuse tiles");
+    }
+
+    void testStaticSceneIsReused() {
+      TerrainTileTracker tracker;
+      runFrame(tracker, makeScene());
+
+      for (uint32_t i = 0; i < 3; i++) {
+        expect(runFrame(tracker, makeScene()) == 0, "Static scene must not re-bake");
+        expect(tracker.getStatistics().numTilesReused == kNumTiles, "Static scene must reuse all tiles");
+      }
+
+      // Small camera movement within half a tile does not scroll the window
+      expect(runFrame(tracker, makeScene(), Vector2(4.f, -4.f)) == 0, "Sub-tile camera movement must not re-bake");
+    }
+
+    void testChangedDrawRebakesOverlappedTiles() {
+      TerrainTileTracker tracker;
+      runFrame(tracker, makeScene());
+
+      std::vector<Draw> changed = makeScene();
+      changed[2].hash = 4;
+
+      // Detected at the end of the frame the change happens in, re-baked on the next one
+      expect(runFrame(tracker, changed) == 0, "Changes must be re-baked a frame later");
+      expect(runFrame(tracker, changed) == 4, "Only tiles overlapped by the changed draw must be re-baked");
+      expect(runFrame(tracker, changed) == 0, "Re-baked tiles must be reused afterwards");
+
+      // Draw order matters for blending
+      std::swap(changed[0], changed[1]);
+      runFrame(tracker, changed);
+      expect(runFrame(tracker, changed) == 1, "Reordered draws must re-bake the tiles they share");
+
+      // Removing a draw
+      changed.pop_back();
+      runFrame(tracker, changed);
+      expect(runFrame(tracker, changed) == 4, "Tiles of a removed draw must be re-baked");
+    }
+
+    void testScrollingBakesNewTilesOnly() {
+      TerrainTileTracker tracker;
+      runFrame(tracker, makeScene());
+
+      // One tile to the right scrolls in one column
+      expect(runFrame(tracker, makeScene(), Vector2(kTileSize, 0.f)) == kTiles, "Scrolling by a tile must bake one column");
+      expect(runFrame(tracker, makeScene(), Vector2(kTileSize, 0.f)) == 0, "Scrolled window must be reused");
+
+      // Diagonal move scrolls in a row and a column
+      expect(runFrame(tracker, makeScene(), Vector2(2 * kTileSize, kTileSize)) == 2 * kTiles - 1, "Diagonal scroll must bake a row and a column");
+
+      // Moving back brings back cells that now hold other world tiles
+      expect(runFrame(tracker, makeScene(), Vector2(0.f, 0.f)) == 10, "Scrolling back must re-bake overwritten tiles");
+
+      // Window centers follow the tile grid
+      const Vector2 center = tracker.getWindowCenter(0);
+      expect(center.x == 0.f && center.y == 0.f, "Window center must be snapped to the tile grid");
+    }
+
+    void testRegionsDoNotCrossSeam() {
+      TerrainTileTracker tracker;
+      tracker.beginFrame(kTiles, { kTileSize }, Vector2(kTileSize, -kTileSize), 0);
+
+      std::vector<TerrainTileTracker::Region> regions;
+      tracker.addDraw(1, Vector2(-1000.f), Vector2(1000.f), regions);
+
+      // Window is world tiles <-1, 2> x <-3, 0>. Both axes wrap inside the level, so the window maps to 4 rectangles.
+      expect(regions.size() == 4, "Fully dirty window must merge into one rectangle per toroidal quadrant");
+      expect(countTiles(regions) == kNumTiles, "Regions must cover the whole window");
+
+      for (const auto& region : regions) {
+        const Vector2i worldExtent = region.worldTileMax - region.worldTileMin;
+        expect(worldExtent == region.cellExtent, "Region world and cell extents must match");
+
+        // Corner tiles must map to the region's corner cells
+        const Vector2i topLeftWorldTile(region.worldTileMin.x, region.worldTileMax.y - 1);
+        expect(TerrainTileTracker::worldTileToCell(topLeftWorldTile, kTiles) == region.cellMin, "Region must start at its top left world tile");
+        expect(region.cellMin.x + region.cellExtent.x <= static_cast<int32_t>(kTiles) &&
+               region.cellMin.y + region.cellExtent.y <= static_cast<int32_t>(kTiles), "Region must stay within the level");
+      }
+
+      tracker.endFrame();
+    }
+
+    void testSettingsAndInvalidation() {
+      TerrainTileTracker tracker;
+      runFrame(tracker, makeScene());
+
+      expect(runFrame(tracker, makeScene(), Vector2(0.f), 1) == kNumTiles, "Settings change must re-bake everything");
+      expect(runFrame(tracker, makeScene(), Vector2(0.f), 1, { kTileSize, 2 * kTileSize }) == 2 * kNumTiles, "Level count change must re-bake everything");
+      expect(runFrame(tracker, makeScene(), Vector2(0.f), 1, { kTileSize, 3 * kTileSize }) == kNumTiles, "Tile size change must re-bake its level");
+
+      // Invalidation mid frame applies to the next frame
+      tracker.beginFrame(kTiles, { kTileSize, 3 * kTileSize }, Vector2(0.f), 1);
+      tracker.invalidate();
+      tracker.endFrame();
+      expect(runFrame(tracker, makeScene(), Vector2(0.f), 1, { kTileSize, 3 * kTileSize }) == 2 * kNumTiles, "Invalidation must re-bake everything");
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
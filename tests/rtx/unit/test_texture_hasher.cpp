@@ -0,0 +1,171 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_texture_hasher.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_texture_hasher.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testLegacyHashes();
+      testTreeHash();
+      testWorkerThreadCounts();
+      testWaitWithoutWorkers();
+      testConcurrentConsumers();
+    }
+
+  private:
+    static constexpr size_t kChunkSize = TextureHasher::kChunkSize;
+
+    static std::vector<uint8_t> makeData(size_t size, uint32_t seed) {
+      std::mt19937 rng(seed);
+      std::vector<uint8_t> data(size);
+      for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+      }
+      return data;
+    }
+
+    void testLegacyHashes() {
+      for (size_t size : { size_t(0), size_t(1), size_t(4096), kChunkSize, kChunkSize + 1, 5 * kChunkSize / 2 }) {
+        const std::vector<uint8_t> data = makeData(size, 1);
+
+        expect(TextureHasher::hash(data.data(), size, TextureHashMethod::Xxh3) == XXH3_64bits(data.data(), size),
+               "Xxh3 must match the legacy texture hash");
+        expect(TextureHasher::hash(data.data(), size, TextureHashMethod::Xxh64) == XXH64(data.data(), size, 0),
+               "Xxh64 must match the obsolete texture hash");
+      }
+
+      const std::vector<uint8_t> data = makeData(kChunkSize, 2);
+      expect(TextureHasher::hash(data.data(), data.size(), TextureHashMethod::Tree) == XXH3_64bits(data.data(), data.size()),
+             "Tree hash of a single chunk must match the legacy texture hash");
+      expect(TextureHasher::hash(data.data(), 100, TextureHashMethod::Tree) == XXH3_64bits(data.data(), 100),
+             "Tree hash of a single chunk must match the legacy texture hash");
+    }
+
+    void testTreeHash() {
+      std::vector<uint8_t> data = makeData(4 * kChunkSize + 100, 3);
+      const XXH64_hash_t hash = TextureHasher::hash(data.data(), data.size(), TextureHashMethod::Tree);
+
+      expect(hash == TextureHasher::hash(data.data(), data.size(), TextureHashMethod::Tree), "Tree hash must be deterministic");
+      expect(hash != TextureHasher::hash(data.data(), data.size() - 1, TextureHashMethod::Tree), "Tree hash must depend on the size");
+
+      for (size_t offset : { size_t(0), kChunkSize - 1, 2 * kChunkSize, data.size() - 1 }) {
+        data[offset] ^= 1;
+        expect(hash != TextureHasher::hash(data.data(), data.size(), TextureHashMethod::Tree), "Tree hash must depend on every chunk");
+        data[offset] ^= 1;
+      }
+
+      // Chunks must not be interchangeable
+      std::vector<uint8_t> swapped = data;
+      std::swap_ranges(swapped.begin(), swapped.begin() + kChunkSize, swapped.begin() + kChunkSize);
+      expect(hash != TextureHasher::hash(swapped.data(), swapped.size(), TextureHashMethod::Tree), "Tree hash must depend on the chunk order");
+    }
+
+    void testWorkerThreadCounts() {
+      std::vector<std::vector<uint8_t>> textures;
+      for (size_t size : { size_t(0), size_t(64), kChunkSize, 3 * kChunkSize + 7, 16 * kChunkSize }) {
+        textures.push_back(makeData(size, static_cast<uint32_t>(size)));
+      }
+
+      for (uint32_t numThreads : { 0u, 1u, 4u }) {
+        TextureHasher hasher(numThreads);
+
+        for (TextureHashMethod method : { TextureHashMethod::Xxh3, TextureHashMethod::Xxh64, TextureHashMethod::Tree }) {
+          std::vector<Rc<PendingTextureHash>> pendingHashes;
+          for (const auto& data : textures) {
+            pendingHashes.push_back(hasher.schedule(data.data(), data.size(), method));
+          }
+
+          for (size_t i = 0; i < textures.size(); i++) {
+            expect(pendingHashes[i]->get() == TextureHasher::hash(textures[i].data(), textures[i].size(), method),
+                   "Scheduled hash must match the synchronous hash");
+            expect(pendingHashes[i]->isReady(), "Hash must be ready once returned");
+          }
+        }
+      }
+    }
+
+    void testWaitWithoutWorkers() {
+      const std::vector<uint8_t> data = makeData(8 * kChunkSize, 4);
+
+      // Hashes complete on schedule without workers
+      TextureHasher hasher(0);
+      Rc<PendingTextureHash> pendingHash = hasher.schedule(data.data(), data.size(), TextureHashMethod::Tree);
+      expect(pendingHash->isReady(), "Hash must be computed inline without workers");
+      expect(pendingHash->get() == TextureHasher::hash(data.data(), data.size(), TextureHashMethod::Tree), "Inline hash must match");
+    }
+
+    void testConcurrentConsumers() {
+      const std::vector<uint8_t> data = makeData(32 * kChunkSize + 13, 5);
+      const XXH64_hash_t expected = TextureHasher::hash(data.data(), data.size(), TextureHashMethod::Tree);
+
+      TextureHasher hasher(4);
+
+      for (uint32_t iteration = 0; iteration < 20; iteration++) {
+        Rc<PendingTextureHash> pendingHash = hasher.schedule(data.data(), data.size(), TextureHashMethod::Tree);
+
+        // Consumers waiting on the hash help the workers with the remaining chunks
+        std::vector<XXH64_hash_t> results(4);
+        std::vector<std::thread> consumers;
+        for (uint32_t i = 0; i < results.size(); i++) {
+          consumers.emplace_back([&, i] { results[i] = pendingHash->get(); });
+        }
+        for (auto& consumer : consumers) {
+          consumer.join();
+        }
+
+        for (XXH64_hash_t result : results) {
+          expect(result == expected, "Every consumer must get the complete hash");
+        }
+      }
+
+      // Hashes still pending when the hasher is destroyed must complete
+      std::vector<Rc<PendingTextureHash>> pendingHashes;
+      {
+        TextureHasher shortLivedHasher(2);
+        for (uint32_t i = 0; i < 8; i++) {
+          pendingHashes.push_back(shortLivedHasher.schedule(data.data(), data.size(), TextureHashMethod::Tree));
+        }
+      }
+
+      for (const auto& pendingHash : pendingHashes) {
+        expect(pendingHash->isReady(), "Hashes must complete before the hasher is destroyed");
+        expect(pendingHash->get() == expected, "Hash completed at shutdown must match");
+      }
+    }
+  };
+}
+
+int main() {
+  return dxvk::runTestApp<dxvk::TestApp>();
+}
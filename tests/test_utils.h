@@ -15,3 +15,26 @@
 #include "../src/util/util_enum.h"
 #include "../src/util/util_error.h"
 #include "../src/util/util_string.h"
+
+namespace dxvk {
+  inline void expect(bool condition, const char* message) {
+    if (!condition) {
+      throw DxvkError(message);
+    }
+  }
+
+  // Runs a TestApp, reporting the failure of a test before rethrowing it
+  template<typename TestApp>
+  int runTestApp() {
+    try {
+      TestApp testApp;
+      testApp.run();
+    }
+    catch (const DxvkError& error) {
+      std::cerr << error.message() << std::endl;
+      throw;
+    }
+
+    return 0;
+  }
+}